@@ -37,9 +37,8 @@ public:
 	//! @param radiantDelta The radiant delta in rad.
 	//! @param pidx Population index.
 	//! @param colors Meteor color.
-	//! @param bolideTexture Bolide texture.
 	MeteorObj(const StelCore*, int speed, const float& radiantAlpha, const float& radiantDelta,
-		  const float& pidx, QList<Meteor::ColorPair> colors, const StelTextureSP& bolideTexture);
+		  const float& pidx, QList<Meteor::ColorPair> colors);
 	virtual ~MeteorObj();
 };
 
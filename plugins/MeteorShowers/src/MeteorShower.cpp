@@ -19,7 +19,6 @@
 
 #include <QtMath>
 
-#include "LandscapeMgr.hpp"
 #include "MeteorShower.hpp"
 #include "MeteorShowers.hpp"
 #include "SporadicMeteorMgr.hpp"
@@ -196,8 +195,6 @@ MeteorShower::MeteorShower(MeteorShowersMgr* mgr, const QVariantMap& map)
 
 MeteorShower::~MeteorShower()
 {
-	qDeleteAll(m_activeMeteors);
-	m_activeMeteors.clear();
 	m_colors.clear();
 }
 
@@ -221,7 +218,7 @@ bool MeteorShower::enabled() const
 	}
 }
 
-void MeteorShower::update(StelCore* core, double deltaTime)
+void MeteorShower::update(StelCore* core, double deltaTime, MeteorPool& meteors)
 {
 	if (m_status == INVALID)
 	{
@@ -265,17 +262,6 @@ void MeteorShower::update(StelCore* core, double deltaTime)
 		m_radiantDelta += m_driftDelta * daysToPeak;
 	}
 
-	// step through and update all active meteors
-	foreach (MeteorObj* m, m_activeMeteors)
-	{
-		if (!m->update(deltaTime))
-		{
-			//important to delete when no longer active
-			delete m;
-			m_activeMeteors.removeOne(m);
-		}
-	}
-
 	// paused | forward | backward ?
 	// don't create new meteors
 	if(!core->getRealTimeSpeed())
@@ -303,16 +289,8 @@ void MeteorShower::update(StelCore* core, double deltaTime)
 		float prob = (float) qrand() / (float) RAND_MAX;
 		if (prob < rate)
 		{
-			MeteorObj *m = new MeteorObj(core, m_speed, m_radiantAlpha, m_radiantDelta,
-						     m_pidx, m_colors, m_mgr->getBolideTexture());
-			if (m->isAlive())
-			{
-				m_activeMeteors.append(m);
-			}
-			else
-			{
-				delete m;
-			}
+			MeteorObj m(core, m_speed, m_radiantAlpha, m_radiantDelta, m_pidx, m_colors);
+			meteors.add(m);
 		}
 	}
 }
@@ -324,7 +302,6 @@ void MeteorShower::draw(StelCore* core)
 		return;
 	}
 	drawRadiant(core);
-	drawMeteors(core);
 }
 
 void MeteorShower::drawRadiant(StelCore *core)
@@ -375,27 +352,6 @@ void MeteorShower::drawRadiant(StelCore *core)
 	}
 }
 
-void MeteorShower::drawMeteors(StelCore *core)
-{
-	if (!core->getSkyDrawer()->getFlagHasAtmosphere())
-	{
-		return;
-	}
-
-	LandscapeMgr* landmgr = GETSTELMODULE(LandscapeMgr);
-	if (landmgr->getFlagAtmosphere() && landmgr->getLuminance() > 5.f)
-	{
-		return;
-	}
-
-	// step through and draw all active meteors
-	StelPainter painter(core->getProjection(StelCore::FrameAltAz));
-	foreach (MeteorObj* m, m_activeMeteors)
-	{
-		m->draw(core, painter);
-	}
-}
-
 MeteorShower::Activity MeteorShower::hasGenericShower(QDate date, bool &found) const
 {
 	int year = date.year();
@@ -21,6 +21,7 @@
 #define _METEORSHOWER_HPP_
 
 #include "MeteorObj.hpp"
+#include "MeteorPool.hpp"
 #include "MeteorShowersMgr.hpp"
 #include "StelFader.hpp"
 #include "StelObject.hpp"
@@ -66,11 +67,12 @@ public:
 	//! Destructor
 	~MeteorShower();
 
-	//! Update
+	//! Update the status and the radiant, and create new meteors
 	//! @param deltaTime the time increment in seconds since the last call.
-	void update(StelCore *core, double deltaTime);
+	//! @param meteors the pool which receives the new meteors.
+	void update(StelCore *core, double deltaTime, MeteorPool& meteors);
 
-	//! Draw
+	//! Draw the radiant. The meteors are drawn by their pool.
 	void draw(StelCore *core);
 
 	//! Checks if we have generic data for a given date
@@ -150,14 +152,9 @@ private:
 	double m_radiantDelta;             //! Current Dec. for radiant of meteor shower
 	Activity m_activity;               //! Current activity
 
-	QList<MeteorObj*> m_activeMeteors; //! List with all the active meteors
-
 	//! Draws the radiant
 	void drawRadiant(StelCore* core);
 
-	//! Draws all active meteors
-	void drawMeteors(StelCore* core);
-
 	//! Calculates the ZHR using normal distribution
 	//! @param current julian day
 	int calculateZHR(const double& currentJD);
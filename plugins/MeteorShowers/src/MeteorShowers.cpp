@@ -19,6 +19,7 @@
 
 #include <QtMath>
 
+#include "LandscapeMgr.hpp"
 #include "MeteorShowers.hpp"
 #include "StelApp.hpp"
 #include "StelModuleMgr.hpp"
@@ -40,9 +41,13 @@ MeteorShowers::~MeteorShowers()
 void MeteorShowers::update(double deltaTime)
 {
 	StelCore* core = StelApp::getInstance().getCore();
+
+	// update all active meteors, removing the dead ones
+	m_meteors.update(core, deltaTime);
+
 	foreach (const MeteorShowerP& ms, m_meteorShowers)
 	{
-		ms->update(core, deltaTime);
+		ms->update(core, deltaTime, m_meteors);
 	}
 }
 
@@ -53,12 +58,32 @@ void MeteorShowers::draw(StelCore* core)
 		ms->draw(core);
 	}
 
+	drawMeteors(core);
+
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 	{
 		drawPointer(core);
 	}
 }
 
+void MeteorShowers::drawMeteors(StelCore* core)
+{
+	if (!core->getSkyDrawer()->getFlagHasAtmosphere())
+	{
+		return;
+	}
+
+	LandscapeMgr* landmgr = GETSTELMODULE(LandscapeMgr);
+	if (landmgr->getFlagAtmosphere() && landmgr->getLuminance() > 5.f)
+	{
+		return;
+	}
+
+	// draw the meteors of all the showers at once
+	StelPainter painter(core->getProjection(StelCore::FrameAltAz));
+	m_meteors.draw(core, painter, m_mgr->getBolideTexture());
+}
+
 void MeteorShowers::drawPointer(StelCore* core)
 {
 	const QList<StelObjectP> newSelected = GETSTELMODULE(StelObjectMgr)->getSelectedObject("MeteorShower");
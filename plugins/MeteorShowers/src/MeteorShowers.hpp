@@ -84,6 +84,10 @@ public:
 private:
 	MeteorShowersMgr* m_mgr;
 	QList<MeteorShowerP> m_meteorShowers;
+	MeteorPool m_meteors; //! The active meteors of all the showers
+
+	//! Draw all active meteors
+	void drawMeteors(StelCore* core);
 
 	//! Draw pointer
 	void drawPointer(StelCore* core);
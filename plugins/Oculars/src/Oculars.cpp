@@ -129,6 +129,7 @@ Oculars::Oculars():
 	guiPanelEnabled(false),
 	flagDecimalDegrees(false),
 	flagSemiTransparency(false),
+	flagMaskOutsideCCD(false),
 	flagHideGridsLines(false),
 	flagGridLinesDisplayedMain(true),
 	flagConstellationLines(true),
@@ -234,6 +235,8 @@ bool Oculars::configureGui(bool show)
 
 void Oculars::deinit()
 {
+	StelApp::getInstance().getCore()->setViewportClip(StelProjector::ViewportClip());
+
 	// update the ini file.
 	settings->remove("ccd");
 	settings->remove("ocular");
@@ -299,6 +302,11 @@ void Oculars::deinit()
 	disconnect(&StelApp::getInstance(), SIGNAL(languageChanged()), this, SLOT(retranslateGui()));
 }
 
+void Oculars::update(double)
+{
+	updateViewportClip();
+}
+
 //! Draw any parts on the screen which are for our module
 void Oculars::draw(StelCore* core)
 {
@@ -396,12 +404,7 @@ void Oculars::handleMouseClicks(class QMouseEvent* event)
 		float mx = event->x()*ppx-wh; // point 0 in center of the screen, axis X directed to right
 		float my = event->y()*ppx-hh; // point 0 in center of the screen, axis Y directed to bottom
 
-		double inner = 0.5 * params.viewportFovDiameter * ppx;
-		// See if we need to scale the mask
-		if (useMaxEyepieceAngle && oculars[selectedOcularIndex]->appearentFOV() > 0.0 && !oculars[selectedOcularIndex]->isBinoculars())
-		{
-			inner = oculars[selectedOcularIndex]->appearentFOV() * inner / maxEyepieceAngle;
-		}
+		double inner = getOcularMaskRadius(params) * ppx;
 
 		if (mx*mx+my*my>inner*inner) // click outside ocular circle? Gobble event.
 		{
@@ -686,6 +689,7 @@ void Oculars::init()
 		setFlagInitFovUsage(settings->value("use_initial_fov", false).toBool());
 		setFlagInitDirectionUsage(settings->value("use_initial_direction", false).toBool());
 		setFlagUseSemiTransparency(settings->value("use_semi_transparency", false).toBool());
+		setFlagMaskOutsideCCD(settings->value("mask_outside_ccd_frame", false).toBool());
 		setFlagHideGridsLines(settings->value("hide_grids_and_lines", true).toBool());
 		setFlagAutosetMountForCCD(settings->value("use_mount_autoset", false).toBool());
 		setFlagShowResolutionCriterions(settings->value("show_resolution_criterions", false).toBool());
@@ -1564,31 +1568,22 @@ void Oculars::paintCCDBounds()
 			float width = params.viewportXywh[aspectIndex] * ccdXRatio * params.devicePixelsPerPixel;
 			float height = params.viewportXywh[aspectIndex] * ccdYRatio * params.devicePixelsPerPixel;
 
-			double polarAngle = 0;
-			// if the telescope is Equatorial derotate the field
-			if (telescope->isEquatorial())
-			{
-				Vec3d CPos;
-				Vec2f cpos = projector->getViewportCenter();
-				projector->unProject(cpos[0], cpos[1], CPos);
-				Vec3d CPrel(CPos);
-				CPrel[2]*=0.2;
-				Vec3d crel;
-				projector->project(CPrel, crel);
-				polarAngle = atan2(cpos[1] - crel[1], cpos[0] - crel[0]) * (-180.0)/M_PI; // convert to degrees
-				if (CPos[2] > 0) polarAngle += 90.0;
-				else polarAngle -= 90.0;
-			}
+			const double polarAngle = getCCDPolarAngle(projector, telescope);
 
 			if (getFlagAutosetMountForCCD())
 			{
 				StelPropertyMgr* propMgr=StelApp::getInstance().getStelPropertyManager();
 				propMgr->setStelPropertyValue("actionSwitch_Equatorial_Mount", telescope->isEquatorial());
-				polarAngle = 0;
 			}
 
 			if (width > 0.0 && height > 0.0)
 			{
+				if (flagMaskOutsideCCD)
+				{
+					paintCCDMask(painter, centerScreen, width, height, -(ccd->chipRotAngle() + polarAngle));
+					painter.setColor(0.77f, 0.14f, 0.16f, 1.0f);
+				}
+
 				QPoint a, b;
 				QTransform transform = QTransform().translate(centerScreen[0], centerScreen[1]).rotate(-(ccd->chipRotAngle() + polarAngle));
 				// bottom line
@@ -1701,6 +1696,110 @@ void Oculars::paintCCDBounds()
 
 }
 
+void Oculars::paintCCDMask(StelPainter& painter, const Vec2i& centerScreen, float width, float height, double angle)
+{
+	const StelProjector::StelProjectorParams params = StelApp::getInstance().getCore()->getCurrentStelProjectorParams();
+	const float outer = (params.viewportXywh[2] + params.viewportXywh[3]) * params.devicePixelsPerPixel;
+	const QTransform transform = QTransform().translate(centerScreen[0], centerScreen[1]).rotate(angle);
+
+	// A strip between the corners of the frame and the corners of a square larger than the viewport
+	static const float corners[5][2] = {{-1.f, -1.f}, {1.f, -1.f}, {1.f, 1.f}, {-1.f, 1.f}, {-1.f, -1.f}};
+	GLfloat vertices[10][3];
+	for (int i=0; i<5; i++)
+	{
+		const QPointF o = transform.map(QPointF(corners[i][0]*outer, corners[i][1]*outer));
+		const QPointF in = transform.map(QPointF(corners[i][0]*width/2.f, corners[i][1]*height/2.f));
+		vertices[i*2][0] = o.x();
+		vertices[i*2][1] = o.y();
+		vertices[i*2][2] = 0.f;
+		vertices[i*2+1][0] = in.x();
+		vertices[i*2+1][1] = in.y();
+		vertices[i*2+1][2] = 0.f;
+	}
+
+	painter.setBlending(true);
+	painter.setColor(0.f, 0.f, 0.f, getFlagUseSemiTransparency() ? 0.85f : 1.f);
+	painter.enableClientStates(true);
+	painter.setVertexPointer(3, GL_FLOAT, vertices);
+	painter.drawFromArray(StelPainter::TriangleStrip, 10, 0, false);
+	painter.enableClientStates(false);
+}
+
+bool Oculars::getCCDFrame(const StelCore* core, float& width, float& height, double& angle) const
+{
+	if (selectedCCDIndex < 0 || selectedCCDIndex >= ccds.count() || selectedTelescopeIndex < 0 || selectedTelescopeIndex >= telescopes.count())
+		return false;
+	CCD *ccd = ccds[selectedCCDIndex];
+	Telescope *telescope = telescopes[selectedTelescopeIndex];
+	Lens *lens = selectedLensIndex >=0  ? lenses[selectedLensIndex] : Q_NULLPTR;
+	const StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
+
+	// Same computation as in paintCCDBounds(), in viewport pixels
+	const int aspectIndex = params.viewportXywh[2] > params.viewportXywh[3] ? 3 : 2;
+	width = params.viewportXywh[aspectIndex] * ccd->getActualFOVx(telescope, lens) / params.fov;
+	height = params.viewportXywh[aspectIndex] * ccd->getActualFOVy(telescope, lens) / params.fov;
+	angle = -(ccd->chipRotAngle() + getCCDPolarAngle(core->getProjection(StelCore::FrameEquinoxEqu), telescope));
+	return width > 0.f && height > 0.f;
+}
+
+double Oculars::getCCDPolarAngle(const StelProjectorP& projector, const Telescope* telescope) const
+{
+	// if the telescope is Equatorial derotate the field, unless the mount is set up for it.
+	if (!telescope->isEquatorial() || getFlagAutosetMountForCCD())
+		return 0.;
+
+	Vec3d CPos;
+	Vec2f cpos = projector->getViewportCenter();
+	projector->unProject(cpos[0], cpos[1], CPos);
+	Vec3d CPrel(CPos);
+	CPrel[2]*=0.2;
+	Vec3d crel;
+	projector->project(CPrel, crel);
+	double polarAngle = atan2(cpos[1] - crel[1], cpos[0] - crel[0]) * (-180.0)/M_PI; // convert to degrees
+	if (CPos[2] > 0) polarAngle += 90.0;
+	else polarAngle -= 90.0;
+	return polarAngle;
+}
+
+double Oculars::getOcularMaskRadius(const StelProjector::StelProjectorParams& params) const
+{
+	double radius = 0.5 * params.viewportFovDiameter;
+	// See if we need to scale the mask
+	if (useMaxEyepieceAngle && oculars[selectedOcularIndex]->appearentFOV() > 0.0 && !oculars[selectedOcularIndex]->isBinoculars())
+	{
+		radius = oculars[selectedOcularIndex]->appearentFOV() * radius / maxEyepieceAngle;
+	}
+	return radius;
+}
+
+void Oculars::updateViewportClip()
+{
+	StelCore *core = StelApp::getInstance().getCore();
+	StelProjector::ViewportClip clip;
+	// The objects outside of the footprint are not drawn at all, so it must be hidden by an opaque mask.
+	if (ready && !flagShowTelrad && !getFlagUseSemiTransparency())
+	{
+		if (flagShowOculars)
+		{
+			if (selectedOcularIndex > -1 && selectedOcularIndex < oculars.count())
+			{
+				clip.shape = StelProjector::ViewportClip::ClipDisk;
+				clip.width = clip.height = 2. * getOcularMaskRadius(core->getCurrentStelProjectorParams());
+			}
+		}
+		else if (flagShowCCD && flagMaskOutsideCCD)
+		{
+			double angle;
+			if (getCCDFrame(core, clip.width, clip.height, angle))
+			{
+				clip.shape = StelProjector::ViewportClip::ClipRectangle;
+				clip.angle = angle;
+			}
+		}
+	}
+	core->setViewportClip(clip);
+}
+
 void Oculars::paintCrosshairs()
 {
 	StelCore *core = StelApp::getInstance().getCore();
@@ -1709,13 +1808,7 @@ void Oculars::paintCrosshairs()
 	// Center of screen
 	Vec2i centerScreen(projector->getViewportPosX()+projector->getViewportWidth()/2,
 			   projector->getViewportPosY()+projector->getViewportHeight()/2);
-	float length = 0.5 * params.viewportFovDiameter;
-	// See if we need to scale the length
-	if (useMaxEyepieceAngle && oculars[selectedOcularIndex]->appearentFOV() > 0.0 && !oculars[selectedOcularIndex]->isBinoculars())
-	{
-		length = oculars[selectedOcularIndex]->appearentFOV() * length / maxEyepieceAngle;
-	}
-	length *= params.devicePixelsPerPixel;
+	float length = getOcularMaskRadius(params) * params.devicePixelsPerPixel;
 	// Draw the lines
 	StelPainter painter(projector);
 	painter.setColor(0.77f, 0.14f, 0.16f, 1.f);
@@ -1750,12 +1843,7 @@ void Oculars::paintOcularMask(const StelCore *core)
 	StelPainter painter(prj);
 	StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
 
-	double inner = 0.5 * params.viewportFovDiameter * params.devicePixelsPerPixel;
-	// See if we need to scale the mask
-	if (useMaxEyepieceAngle && oculars[selectedOcularIndex]->appearentFOV() > 0.0 && !oculars[selectedOcularIndex]->isBinoculars())
-	{
-		inner = oculars[selectedOcularIndex]->appearentFOV() * inner / maxEyepieceAngle;
-	}
+	double inner = getOcularMaskRadius(params) * params.devicePixelsPerPixel;
 
 	painter.setBlending(true);
 
@@ -2428,6 +2516,18 @@ bool Oculars::getFlagUseSemiTransparency() const
 	return flagSemiTransparency;
 }
 
+void Oculars::setFlagMaskOutsideCCD(const bool b)
+{
+	flagMaskOutsideCCD = b;
+	settings->setValue("mask_outside_ccd_frame", b);
+	settings->sync();
+}
+
+bool Oculars::getFlagMaskOutsideCCD() const
+{
+	return flagMaskOutsideCCD;
+}
+
 void Oculars::setFlagShowResolutionCriterions(const bool b)
 {
 	flagShowResolutionCriterions = b;
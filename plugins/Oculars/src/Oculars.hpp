@@ -25,6 +25,7 @@
 #include "Ocular.hpp"
 #include "OcularDialog.hpp"
 #include "StelModule.hpp"
+#include "StelProjector.hpp"
 #include "StelTexture.hpp"
 #include "Telescope.hpp"
 #include "VecMath.hpp"
@@ -45,6 +46,7 @@ QT_END_NAMESPACE
 
 class StelButton;
 class StelAction;
+class StelPainter;
 
 /*! @defgroup oculars Oculars Plug-in
 @{
@@ -104,7 +106,8 @@ public:
 	//! while flagShowOculars or flagShowCCD == true.
 	virtual void handleKeys(class QKeyEvent* event);
 	virtual void handleMouseClicks(class QMouseEvent* event);
-	virtual void update(double) {;}
+	//! Publishes the visible footprint of the ocular or sensor to StelCore, see updateViewportClip().
+	virtual void update(double deltaTime);
 	double ccdRotationAngle() const;
 
 	QString getDimensionsString(double fovX, double fovY) const;
@@ -167,6 +170,10 @@ public slots:
 	void setFlagUseSemiTransparency(const bool b);
 	bool getFlagUseSemiTransparency(void) const;
 
+	//! Mask the sky outside of the sensor frame in CCD mode.
+	void setFlagMaskOutsideCCD(const bool b);
+	bool getFlagMaskOutsideCCD(void) const;
+
 	void setFlagShowResolutionCriterions(const bool b);
 	bool getFlagShowResolutionCriterions(void) const;
 
@@ -203,6 +210,15 @@ private:
 
 	//! Reneders the CCD bounding box on-screen.  A telescope must be selected, or this call does nothing.
 	void paintCCDBounds();
+	//! Paint the mask around the sensor frame, of the given size and rotation around the center of the viewport.
+	void paintCCDMask(StelPainter& painter, const Vec2i& centerScreen, float width, float height, double angle);
+	//! Compute the sensor frame of the selected CCD in viewport pixels, and its rotation in degrees.
+	//! @return false if no frame is shown.
+	bool getCCDFrame(const StelCore* core, float& width, float& height, double& angle) const;
+	//! The angle of the celestial pole at the center of the screen, used to derotate the sensor frame of equatorial telescopes.
+	double getCCDPolarAngle(const StelProjectorP& projector, const Telescope* telescope) const;
+	//! Radius in viewport pixels of the field visible through the selected ocular.
+	double getOcularMaskRadius(const StelProjector::StelProjectorParams& params) const;
 	//! Renders crosshairs into the viewport.
 	void paintCrosshairs();
 	//! Paint the mask into the viewport.
@@ -210,6 +226,10 @@ private:
 	//! Renders the three Telrad circles, but only if not in ocular mode.
 	void paintTelrad();
 
+	//! Tell StelCore which part of the viewport is not masked, so that the sky modules skip the rest.
+	//! The footprint is only published when the mask around it is opaque.
+	void updateViewportClip();
+
 	//! Paints the text about the current object selections to the upper right hand of the screen.
 	//! Should only be called from a 'ready' state; currently from the draw() method.
 	void paintText(const StelCore * core);
@@ -288,6 +308,7 @@ private:
 	bool guiPanelEnabled;
 	bool flagDecimalDegrees;
 	bool flagSemiTransparency;
+	bool flagMaskOutsideCCD;
 	bool flagHideGridsLines;
 	bool flagGridLinesDisplayedMain; //!< keep track of gridline display while possibly suppressing their display.
 	bool flagConstellationLines;
@@ -25,6 +25,7 @@
 #include "SkyGui.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelModuleMgr.hpp"
+#include "StelMainView.hpp"
 #include "StelFileMgr.hpp"
 #include "StelGui.hpp"
 #include "StelGuiItems.hpp"
@@ -104,6 +105,11 @@ void PointerCoordinates::init()
 	setFlagShowConstellation(flagShowConstellation);
 }
 
+bool PointerCoordinates::needsRedraw() const
+{
+	return isEnabled() && StelMainView::getInstance().getMousePos()!=lastMousePos;
+}
+
 void PointerCoordinates::deinit()
 {
 	//
@@ -114,6 +120,8 @@ void PointerCoordinates::draw(StelCore *core)
 	if (!isEnabled())
 		return;
 
+	lastMousePos = StelMainView::getInstance().getMousePos();
+
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000, StelCore::RefractionAuto);
 	StelPainter sPainter(prj);
 	sPainter.setColor(textColor[0], textColor[1], textColor[2], 1.f);
@@ -26,6 +26,7 @@
 #include <QFont>
 #include <QString>
 #include <QPair>
+#include <QPoint>
 
 class QPixmap;
 class StelButton;
@@ -91,6 +92,8 @@ public:
 	virtual void deinit();
 	virtual void update(double) {;}
 	virtual void draw(StelCore *core);
+	//! The coordinates follow the mouse cursor, which moves without changing the sky.
+	virtual bool needsRedraw() const;
 	virtual double getCallOrder(StelModuleActionName actionName) const;
 	virtual bool configureGui(bool show);
 
@@ -202,6 +205,8 @@ private:
 	bool flagShowConstellation;
 	Vec3f textColor;
 	Vec3d coordinatesPoint;
+	//! Position of the mouse cursor during the last draw
+	QPoint lastMousePos;
 	int fontSize;
 	StelButton* toolbarButton;
 	QPair<int, int> customPosition;
@@ -41,8 +41,10 @@ void LocationSearchService::mainLocationManagerUpdated()
 {
 	//this is run in the main thread
 	locMgrMutex.lock();
-	//copy the contents of the location manager
-	locMgr.setLocations(StelApp::getInstance().getLocationMgr().getAll());
+	//share the location database of the main location manager and copy its user locations
+	locMgr.copyLocationsFrom(StelApp::getInstance().getLocationMgr());
+	//the IDs are listed again by the next search
+	locationIDs.clear();
 	locMgrMutex.unlock();
 }
 
@@ -61,17 +63,19 @@ void LocationSearchService::get(const QByteArray& operation, const APIParameters
 
 		//the filtering in the app is provided by QSortFilterProxyModel in the view
 		//we dont have that luxury, but we make sure the filtering happens in the separate HTTP thread
+		//only the IDs are needed, the locations are not decoded
 		locMgrMutex.lock();
-		LocationMap allItems = locMgr.getAllMap();
+		if(locationIDs.isEmpty())
+			locationIDs = locMgr.getAllIDs();
+		const QStringList list = locationIDs;
 		locMgrMutex.unlock();
 
 		QJsonArray results;
-		const QList<QString>& list = allItems.keys();
 
 		//use a regexp in wildcard mode, the app does the same
 		QRegExp exp(term,Qt::CaseInsensitive, QRegExp::Wildcard);
 
-		for(QList<QString>::const_iterator it = list.begin();it!=list.end();++it)
+		for(QStringList::const_iterator it = list.begin();it!=list.end();++it)
 		{
 			if(it->contains(exp))
 				results.append(*it);
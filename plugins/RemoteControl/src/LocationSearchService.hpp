@@ -47,7 +47,10 @@ private slots:
 	void mainLocationManagerUpdated();
 private:
 	//the location mgr is actually copied to be used in HTTP threads without blocking the main app
+	//the base locations are not decoded for that, it maps the same location database
 	StelLocationMgr locMgr;
+	//the IDs of all locations, listed when they are first searched
+	QStringList locationIDs;
 	QMutex locMgrMutex;
 };
 
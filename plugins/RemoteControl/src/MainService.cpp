@@ -514,6 +514,9 @@ void MainService::updateMovement(double x, double y, bool xUpdated, bool yUpdate
 	qint64 curTime = QDateTime::currentMSecsSinceEpoch();
 	//qDebug()<<"updateMove"<<x<<y<<(curTime-lastMoveUpdateTime);
 	lastMoveUpdateTime = curTime;
+
+	//update() is only called while the view is drawn
+	StelApp::getInstance().requestRedraw();
 }
 
 void MainService::updateView(double az, double alt, bool azUpdated, bool altUpdated)
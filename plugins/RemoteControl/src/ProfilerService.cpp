@@ -0,0 +1,93 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "ProfilerService.hpp"
+
+#include "StelApp.hpp"
+#include "StelProfiler.hpp"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+ProfilerService::ProfilerService(QObject *parent) : AbstractAPIService(parent)
+{
+	profiler = StelApp::getInstance().getProfiler();
+}
+
+void ProfilerService::get(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response)
+{
+	Q_UNUSED(parameters);
+
+	if (operation=="stats")
+	{
+		QJsonObject obj;
+		obj.insert("enabled", profiler->getEnabled());
+		obj.insert("tracing", profiler->isTracing());
+		obj.insert("windowSize", profiler->getWindowSize());
+		obj.insert("zones", QJsonObject::fromVariantMap(profiler->getStatistics()));
+		response.writeJSON(QJsonDocument(obj));
+	}
+	else if (operation=="trace")
+	{
+		//the last recorded trace, in Chrome trace event format
+		response.setHeader("Content-Type","application/json; charset=utf-8");
+		response.setData(profiler->getTraceJson());
+	}
+	else
+	{
+		response.writeRequestError("unsupported operation. GET: stats,trace");
+	}
+}
+
+void ProfilerService::post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response)
+{
+	Q_UNUSED(data);
+
+	if (operation=="enable")
+	{
+		QByteArray val = parameters.value("enabled");
+		if(val.isEmpty())
+		{
+			response.writeRequestError("need parameter: enabled");
+			return;
+		}
+		profiler->setEnabled(val=="true" || val=="1");
+		response.setData("ok");
+	}
+	else if (operation=="reset")
+	{
+		profiler->reset();
+		response.setData("ok");
+	}
+	else if (operation=="starttrace")
+	{
+		profiler->startTrace();
+		response.setData("ok");
+	}
+	else if (operation=="stoptrace")
+	{
+		profiler->stopTrace();
+		response.setHeader("Content-Type","application/json; charset=utf-8");
+		response.setData(profiler->getTraceJson());
+	}
+	else
+	{
+		response.writeRequestError("unsupported operation. POST: enable,reset,starttrace,stoptrace");
+	}
+}
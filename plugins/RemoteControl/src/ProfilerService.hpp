@@ -0,0 +1,48 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef PROFILERSERVICE_HPP_
+#define PROFILERSERVICE_HPP_
+
+#include "AbstractAPIService.hpp"
+
+class StelProfiler;
+
+//! @ingroup remoteControl
+//! Provides access to the frame profiler (timings of the modules, traces).
+//!
+//! @see \ref rcProfilerService
+class ProfilerService : public AbstractAPIService
+{
+	Q_OBJECT
+public:
+	ProfilerService(QObject* parent = Q_NULLPTR);
+
+	virtual QLatin1String getPath() const Q_DECL_OVERRIDE { return QLatin1String("profiler"); }
+	//! @brief Implements the HTTP GET operations
+	//! @see \ref rcProfilerServiceGET
+	virtual void get(const QByteArray& operation,const APIParameters& parameters, APIServiceResponse& response) Q_DECL_OVERRIDE;
+	//! @brief Implements the HTTP POST operations
+	//! @see \ref rcProfilerServicePOST
+	virtual void post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response) Q_DECL_OVERRIDE;
+private:
+	StelProfiler* profiler;
+};
+
+#endif
@@ -26,6 +26,7 @@
 #include "LocationSearchService.hpp"
 #include "MainService.hpp"
 #include "ObjectService.hpp"
+#include "ProfilerService.hpp"
 #include "ScriptService.hpp"
 #include "SimbadService.hpp"
 #include "StelActionService.hpp"
@@ -101,6 +102,7 @@ RequestHandler::RequestHandler(const StaticFileControllerSettings& settings, QOb
 	apiController->registerService(new LocationService(apiController));
 	apiController->registerService(new LocationSearchService(apiController));
 	apiController->registerService(new ViewService(apiController));
+	apiController->registerService(new ProfilerService(apiController));
 
 	connect(&StelApp::getInstance().getModuleMgr(), SIGNAL(extensionsAdded(QObjectList)), this, SLOT(addExtensionServices(QObjectList)));
 	addExtensionServices(StelApp::getInstance().getModuleMgr().getExtensionList());
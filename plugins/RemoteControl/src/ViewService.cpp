@@ -144,3 +144,33 @@ void ViewService::get(const QByteArray &operation, const APIParameters &paramete
 		response.writeRequestError("unsupported operation. GET: listlandscape,landscapedescription/,listskyculture,skyculturedescription/,listprojection,projectiondescription");
 	}
 }
+
+void ViewService::post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response)
+{
+	Q_UNUSED(data);
+
+	if (operation=="preloadlandscape")
+	{
+		QString id = QString::fromUtf8(parameters.value("id"));
+		if(id.isEmpty())
+		{
+			response.writeRequestError("need parameter: id");
+			return;
+		}
+
+		bool ok = false;
+		QMetaObject::invokeMethod(lsMgr,"preloadLandscape",SERVICE_DEFAULT_INVOKETYPE,
+					  Q_RETURN_ARG(bool,ok),
+					  Q_ARG(QString,id));
+
+		if(ok)
+			response.setData("ok");
+		else
+			response.setData("error: landscape not found, or already loaded");
+	}
+	else
+	{
+		//TODO some sort of service description?
+		response.writeRequestError("unsupported operation. POST: preloadlandscape");
+	}
+}
@@ -40,6 +40,9 @@ public:
 	//! @brief Implements the HTTP GET operations
 	//! @see \ref rcViewServiceGET
 	virtual void get(const QByteArray& operation,const APIParameters& parameters, APIServiceResponse& response) Q_DECL_OVERRIDE;
+	//! @brief Implements the HTTP POST operations
+	//! @see \ref rcViewServicePOST
+	virtual void post(const QByteArray &operation, const APIParameters &parameters, const QByteArray &data, APIServiceResponse &response) Q_DECL_OVERRIDE;
 private:
 	StelCore* core;
 	LandscapeMgr* lsMgr;
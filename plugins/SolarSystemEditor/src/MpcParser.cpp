@@ -0,0 +1,535 @@
+/*
+ * Solar System editor plug-in for Stellarium
+ *
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MpcParser.hpp"
+
+#include <QDate>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QtConcurrent>
+
+#include <cstring>
+
+struct MpcParser::Chunk
+{
+	const char* begin;
+	const char* end;
+	Format format;
+	const Filter* filter;
+	QVector<Elements> elements;
+	Statistics statistics;
+};
+
+namespace
+{
+//! Remove the spaces around a column.
+//! @return false if the column is empty.
+inline bool trim(const char*& column, int& length)
+{
+	while (length>0 && column[0]==' ')
+	{
+		++column;
+		--length;
+	}
+	while (length>0 && column[length-1]==' ')
+		--length;
+	return length>0;
+}
+
+//! Cut a column of a line, which may be shorter than the end of the column.
+inline int columnLength(int lineLength, int start, int length)
+{
+	return qBound(0, lineLength-start, length);
+}
+
+//! Read a column containing only an unsigned integer, and spaces.
+bool readInteger(const char* column, int length, int& value)
+{
+	if (!trim(column, length) || length>9)
+		return false;
+	value = 0;
+	for (int i=0; i<length; ++i)
+	{
+		if (column[i]<'0' || column[i]>'9')
+			return false;
+		value = value*10 + (column[i]-'0');
+	}
+	return true;
+}
+
+//! Read a column containing only a decimal number, and spaces.
+//! The digits are accumulated as an integer and divided once by a power of ten, which is exact for the
+//! at most 11 significant digits of the MPC formats, so that the result is the same as with strtod().
+bool readNumber(const char* column, int length, double& value)
+{
+	static const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+					     1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17};
+	if (!trim(column, length))
+		return false;
+	const char* end = column+length;
+	bool negative = false;
+	if (*column=='-' || *column=='+')
+	{
+		negative = *column=='-';
+		++column;
+	}
+	qint64 mantissa = 0;
+	int digits = 0;
+	int decimals = -1;
+	for (; column<end; ++column)
+	{
+		const char c = *column;
+		if (c>='0' && c<='9')
+		{
+			if (++digits>17)
+				return false;
+			mantissa = mantissa*10 + (c-'0');
+			if (decimals>=0)
+				++decimals;
+		}
+		else if (c=='.' && decimals<0)
+			decimals = 0;
+		else
+			return false;
+	}
+	if (digits==0)
+		return false;
+	value = decimals>0 ? mantissa/powersOfTen[decimals] : (double)mantissa;
+	if (negative)
+		value = -value;
+	return true;
+}
+
+//! Value of a digit of the packed numbers, from 0-9, A-Z and a-z.
+inline int base62Digit(char c)
+{
+	if (c>='0' && c<='9')
+		return c-'0';
+	if (c>='A' && c<='Z')
+		return 10 + c-'A';
+	if (c>='a' && c<='z')
+		return 36 + c-'a';
+	return -1;
+}
+
+//! Read a packed minor planet number.
+//! See http://www.minorplanetcenter.org/iau/info/PackedDes.html
+//! @return 0 if the designation is not a number.
+int readMinorPlanetNumber(const char* designation, int length)
+{
+	int number;
+	if (readInteger(designation, length, number))
+		return number;
+	// A12345 is 112345, a12345 is 362345
+	const int prefix = base62Digit(designation[0]);
+	if (length>1 && prefix>=10 && readInteger(designation+1, length-1, number))
+		return prefix*10000 + number;
+	// ~AZaz is 620000 + the base 62 number
+	if (length==5 && designation[0]=='~')
+	{
+		number = 0;
+		for (int i=1; i<5; ++i)
+		{
+			const int digit = base62Digit(designation[i]);
+			if (digit<0)
+				return 0;
+			number = number*62 + digit;
+		}
+		return 620000 + number;
+	}
+	return 0;
+}
+
+//! Converts an alphanumeric digit as used in MPC packed dates to an integer.
+//! See http://www.minorplanetcenter.org/iau/info/PackedDates.html
+//! Interprets the digits from 1 to 9 normally, and the capital letters
+//! from A to V as numbers between 10 and 31.
+//! \returns -1 if the digit is invalid.
+inline int unpackDayOrMonthNumber(char digit)
+{
+	if (digit>='1' && digit<='9')
+		return digit-'0';
+	if (digit>='A' && digit<='V')
+		return 10 + digit-'A';
+	return -1;
+}
+
+//! Converts an alphanumeric year prefix as used in MPC packed dates.
+//! \returns 0 if the prefix is invalid.
+inline int unpackCentury(char prefix)
+{
+	switch (prefix)
+	{
+		case 'I':
+			return 1800;
+		case 'J':
+			return 1900;
+		case 'K':
+			return 2000;
+		default:
+			return 0;
+	}
+}
+
+inline bool isDigit(char c)
+{
+	return c>='0' && c<='9';
+}
+
+inline bool isUpper(char c)
+{
+	return c>='A' && c<='Z';
+}
+
+//! Julian day of a UTC date and time.
+inline double julianDay(const QDate& date, double dayFraction)
+{
+	return date.toJulianDay() + dayFraction - 0.5;
+}
+}
+
+bool MpcParser::parseLine(const char* line, int length, Format format, Elements& elements)
+{
+	if (format==CometFormat)
+		return parseCometLine(line, length, Q_NULLPTR, elements)==AcceptedLine;
+	return parseMinorPlanetLine(line, length, Q_NULLPTR, elements)==AcceptedLine;
+}
+
+MpcParser::LineStatus MpcParser::parseMinorPlanetLine(const char* line, int length, const Filter* filter, Elements& elements)
+{
+	//The column of the readable designation ends at 194, but is left-aligned
+	if (length<152 || length>202)
+		return InvalidLine;
+
+	if (!readNumber(line+8, 5, elements.absoluteMagnitude)
+	    || !readNumber(line+14, 5, elements.slopeParameter)
+	    || !readNumber(line+26, 9, elements.meanAnomaly)
+	    || !readNumber(line+37, 9, elements.argumentOfPericenter)
+	    || !readNumber(line+48, 9, elements.ascendingNode)
+	    || !readNumber(line+59, 9, elements.inclination)
+	    || !readNumber(line+70, 9, elements.eccentricity)
+	    || !readNumber(line+80, 11, elements.meanMotion)
+	    || !readNumber(line+92, 11, elements.semiMajorAxis))
+		return InvalidLine;
+
+	//Epoch, in packed form (e.g. K107N), at .0 TT, i.e. midnight
+	const char* epoch = line+20;
+	int yearInCentury;
+	if (!readInteger(epoch+1, 2, yearInCentury))
+		return InvalidLine;
+	const int year = unpackCentury(epoch[0]) + yearInCentury;
+	const int month = unpackDayOrMonthNumber(epoch[3]);
+	const int day = unpackDayOrMonthNumber(epoch[4]);
+	if (year<1800 || !QDate::isValid(year, month, day))
+		return InvalidLine;
+	elements.epoch = julianDay(QDate(year, month, day), 0.);
+
+	const double a = elements.semiMajorAxis;
+	// Perihelion distance
+	const double q = (1. - elements.eccentricity)*a;
+	elements.orbitClass = Asteroid;
+	// 2:3 resonance to Neptune [https://en.wikipedia.org/wiki/Plutino]
+	if ((int)a == 39)
+		elements.orbitClass = Plutino;
+	// Classical Kuiper belt objects [https://en.wikipedia.org/wiki/Classical_Kuiper_belt_object]
+	if (a>=40 && a<=50)
+		elements.orbitClass = Cubewano;
+	// Scattered disc objects
+	if (q > 35)
+		elements.orbitClass = ScatteredDiscObject;
+	// Sednoids [https://en.wikipedia.org/wiki/Planet_Nine]
+	if (q > 30 && a > 250)
+		elements.orbitClass = Sednoid;
+	elements.pericenterDistance = q;
+	elements.timeAtPericenter = 0.;
+
+	const char* designation = line;
+	int designationLength = 7;
+	if (!trim(designation, designationLength))
+		return InvalidLine;
+
+	if (filter && !filter->accepts(elements))
+		return FilteredLine;
+
+	//Minor planet number or provisional designation
+	elements.minorPlanetNumber = readMinorPlanetNumber(designation, designationLength);
+	elements.hasReadableName = false;
+	if (elements.minorPlanetNumber)
+		elements.name = QString::number(elements.minorPlanetNumber);
+	else
+	{
+		elements.name = unpackMinorPlanetProvisionalDesignation(designation, designationLength);
+		if (elements.name.isEmpty())
+			return InvalidLine;
+	}
+
+	//In case the longer format is used, extract the human-readable name,
+	//written as "(number) name" for numbered objects
+	const char* readableName = line+166;
+	int readableNameLength = columnLength(length, 166, 28);
+	if (elements.minorPlanetNumber && trim(readableName, readableNameLength))
+	{
+		int i = 0;
+		if (readableName[0]=='(')
+		{
+			for (i=1; i<readableNameLength && isDigit(readableName[i]); ++i) {}
+			if (i>1 && i<readableNameLength && readableName[i]==')')
+			{
+				const int closing = i;
+				for (++i; i<readableNameLength && readableName[i]==' '; ++i) {}
+				if (i==closing+1 || readableNameLength-i<2)
+					i = 0;
+			}
+			else
+				i = 0;
+		}
+		elements.hasReadableName = i>0;
+		//Use the whole string, just in case
+		elements.name = QString::fromUtf8(readableName+i, readableNameLength-i);
+	}
+	return AcceptedLine;
+}
+
+MpcParser::LineStatus MpcParser::parseCometLine(const char* line, int length, const Filter* filter, Elements& elements)
+{
+	//The name starts at column 103
+	if (length<103)
+		return InvalidLine;
+
+	//Periodic comet number, orbit type and provisional designation, e.g. "0141P      d" or "    CK10R010"
+	const char* number = line;
+	int numberLength = 4;
+	int periodicNumber = 0;
+	const bool numbered = trim(number, numberLength);
+	if (numbered && !readInteger(number, numberLength, periodicNumber))
+		return InvalidLine;
+	if (!isUpper(line[4]))
+		return InvalidLine;
+	const char* provisionalDesignation = line+5;
+	int provisionalDesignationLength = 7;
+	if (!trim(provisionalDesignation, provisionalDesignationLength) && !numbered)
+		return InvalidLine;
+
+	//Perihelion passage, TT
+	int year, month;
+	double dayFraction;
+	if (!readInteger(line+14, 4, year) || !readInteger(line+19, 2, month) || !readNumber(line+22, 7, dayFraction))
+		return InvalidLine;
+	const int day = (int) dayFraction;
+	if (!QDate::isValid(year, month, day))
+		return InvalidLine;
+	//Rounded down to the second
+	const int seconds = (int) ((dayFraction - day) * 24 * 60 * 60);
+	elements.timeAtPericenter = julianDay(QDate(year, month, day), seconds/(24.*60.*60.));
+
+	if (!readNumber(line+30, 9, elements.pericenterDistance)
+	    || !readNumber(line+41, 8, elements.eccentricity)
+	    || !readNumber(line+51, 8, elements.argumentOfPericenter)
+	    || !readNumber(line+61, 8, elements.ascendingNode)
+	    || !readNumber(line+71, 8, elements.inclination)
+	    || !readNumber(line+91, 4, elements.absoluteMagnitude)
+	    || !readNumber(line+96, 4, elements.slopeParameter))
+		return InvalidLine;
+	elements.orbitClass = Comet;
+	elements.epoch = 0.;
+	elements.meanAnomaly = 0.;
+	elements.meanMotion = 0.;
+	elements.semiMajorAxis = 0.;
+
+	const char* name = line+102;
+	int nameLength = columnLength(length, 102, 56);
+	if (!trim(name, nameLength))
+		return InvalidLine;
+
+	if (filter && !filter->accepts(elements))
+		return FilteredLine;
+
+	elements.minorPlanetNumber = 0;
+	elements.hasReadableName = false;
+	elements.name = QString::fromUtf8(name, nameLength);
+	//Fragment suffix
+	if (provisionalDesignationLength == 1)
+	{
+		elements.name.append(' ');
+		elements.name.append(QChar(provisionalDesignation[0]).toUpper());
+	}
+	return AcceptedLine;
+}
+
+void MpcParser::parseChunk(Chunk& chunk)
+{
+	Elements elements;
+	const char* line = chunk.begin;
+	while (line<chunk.end)
+	{
+		const char* endOfLine = static_cast<const char*>(std::memchr(line, '\n', chunk.end-line));
+		if (!endOfLine)
+			endOfLine = chunk.end;
+		int length = endOfLine-line;
+		if (length>0 && line[length-1]=='\r')
+			--length;
+		if (length>0)
+		{
+			++chunk.statistics.lineCount;
+			const LineStatus status = chunk.format==CometFormat
+					? parseCometLine(line, length, chunk.filter, elements)
+					: parseMinorPlanetLine(line, length, chunk.filter, elements);
+			if (status==AcceptedLine)
+				chunk.elements.append(elements);
+			else if (status==FilteredLine)
+				++chunk.statistics.filteredCount;
+			else
+				++chunk.statistics.invalidCount;
+		}
+		line = endOfLine+1;
+	}
+}
+
+void MpcParser::parse(const char* data, qint64 size, Format format, const Filter& filter,
+		      QVector<Elements>& elements, Statistics* statistics)
+{
+	// Cut the data after the end of line following each CHUNK_SIZE bytes
+	QVector<Chunk> chunks;
+	const char* end = data+size;
+	const char* begin = data;
+	while (begin<end)
+	{
+		const char* chunkEnd = begin + qMin<qint64>(CHUNK_SIZE, end-begin);
+		if (chunkEnd<end)
+		{
+			const char* endOfLine = static_cast<const char*>(std::memchr(chunkEnd, '\n', end-chunkEnd));
+			chunkEnd = endOfLine ? endOfLine+1 : end;
+		}
+		Chunk chunk;
+		chunk.begin = begin;
+		chunk.end = chunkEnd;
+		chunk.format = format;
+		chunk.filter = &filter;
+		chunks.append(chunk);
+		begin = chunkEnd;
+	}
+
+	if (chunks.size()==1)
+		parseChunk(chunks[0]);
+	else
+		QtConcurrent::blockingMap(chunks, parseChunk);
+
+	int count = elements.size();
+	foreach (const Chunk& chunk, chunks)
+		count += chunk.elements.size();
+	elements.reserve(count);
+	Statistics total;
+	foreach (const Chunk& chunk, chunks)
+	{
+		elements += chunk.elements;
+		total.lineCount += chunk.statistics.lineCount;
+		total.invalidCount += chunk.statistics.invalidCount;
+		total.filteredCount += chunk.statistics.filteredCount;
+	}
+	if (statistics)
+		*statistics = total;
+}
+
+bool MpcParser::parseFile(const QString& filePath, Format format, const Filter& filter,
+			  QVector<Elements>& elements, Statistics* statistics)
+{
+	QFile file(filePath);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "MpcParser: unable to open for reading" << QDir::toNativeSeparators(filePath) << file.errorString();
+		return false;
+	}
+	const qint64 size = file.size();
+	if (size==0)
+	{
+		if (statistics)
+			*statistics = Statistics();
+		return true;
+	}
+	const uchar* data = file.map(0, size);
+	if (data)
+	{
+		parse(reinterpret_cast<const char*>(data), size, format, filter, elements, statistics);
+		file.unmap(const_cast<uchar*>(data));
+	}
+	else
+	{
+		const QByteArray content = file.readAll();
+		parse(content.constData(), content.size(), format, filter, elements, statistics);
+	}
+	return true;
+}
+
+QString MpcParser::getOrbitClassName(OrbitClass orbitClass)
+{
+	switch (orbitClass)
+	{
+		case Plutino:
+			return "plutino";
+		case Cubewano:
+			return "cubewano";
+		case ScatteredDiscObject:
+			return "scattered disc object";
+		case Sednoid:
+			return "sednoid";
+		case Comet:
+			return "comet";
+		case Asteroid:
+		default:
+			return "asteroid";
+	}
+}
+
+QString MpcParser::unpackMinorPlanetProvisionalDesignation(const char* packed, int length)
+{
+	//Survey designations, e.g. PLS2040 is 2040 P-L
+	if (length>3 && packed[2]=='S')
+	{
+		int number;
+		if (!readInteger(packed+3, length-3, number))
+			return QString();
+		if (packed[0]=='P' && packed[1]=='L')
+			return QString("%1 P-L").arg(number);
+		if (packed[0]=='T' && packed[1]>='1' && packed[1]<='3')
+			return QString("%1 T-%2").arg(number).arg(packed[1]);
+		return QString();
+	}
+
+	//K07Tf8A is 2007 TA418
+	if (length!=7)
+		return QString();
+	int yearInCentury;
+	const int century = unpackCentury(packed[0]);
+	if (!century || !readInteger(packed+1, 2, yearInCentury))
+		return QString();
+	const char halfMonthLetter = packed[3];
+	const char secondLetter = packed[6];
+	const int cycleCountPrefix = base62Digit(packed[4]);
+	if (!isUpper(halfMonthLetter) || !isUpper(secondLetter) || cycleCountPrefix<0 || !isDigit(packed[5]))
+		return QString();
+	const int cycleCount = cycleCountPrefix*10 + packed[5]-'0';
+
+	//Assemble the unpacked provisional designation
+	QString result = QString("%1 %2%3").arg(century+yearInCentury).arg(halfMonthLetter).arg(secondLetter);
+	if (cycleCount != 0)
+		result.append(QString::number(cycleCount));
+	return result;
+}
@@ -0,0 +1,157 @@
+/*
+ * Solar System editor plug-in for Stellarium
+ *
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _MPC_PARSER_HPP_
+#define _MPC_PARSER_HPP_
+
+#include <QFlags>
+#include <QString>
+#include <QVector>
+
+/*!
+ \class MpcParser
+ \brief Reads orbital elements in the one-line formats of the Minor Planet Center.
+
+ The formats are described on the MPC website:
+ http://www.minorplanetcenter.org/iau/info/MPOrbitFormat.html
+ http://www.minorplanetcenter.org/iau/info/CometOrbitFormat.html
+
+ The lines are cut into their fixed columns and the numbers are converted
+ directly from the bytes, without regular expressions or temporary strings.
+ A file is memory mapped and split into chunks at line boundaries, which are
+ parsed in parallel. The objects rejected by a Filter are dropped during the
+ parse, so that importing a subset of MPCORB.DAT (~800000 lines) only keeps
+ the selected objects in memory.
+*/
+class MpcParser
+{
+public:
+	enum Format {
+		MinorPlanetFormat, //!< MPCORB.DAT and the other minor planet lists
+		CometFormat //!< CometEls.txt and the other comet lists
+	};
+
+	//! Orbit classes, as used for the "type" key of ssystem_minor.ini.
+	enum OrbitClass {
+		Asteroid = 0x01,
+		Plutino = 0x02, //!< 2:3 resonance with Neptune
+		Cubewano = 0x04, //!< Classical Kuiper belt object
+		ScatteredDiscObject = 0x08,
+		Sednoid = 0x10,
+		Comet = 0x20,
+		AllOrbitClasses = 0x3f
+	};
+	Q_DECLARE_FLAGS(OrbitClasses, OrbitClass)
+
+	//! The orbital elements of one object.
+	//! Angles are in degrees (J2000.0), distances in AU and dates are JD.
+	struct Elements
+	{
+		//! The name, or the unpacked provisional designation if there is none
+		QString name;
+		//! 0 if the object is not numbered
+		int minorPlanetNumber;
+		//! true if the name was read as "(number) name" in the readable designation column
+		bool hasReadableName;
+		OrbitClass orbitClass;
+		double absoluteMagnitude;
+		double slopeParameter;
+		double eccentricity;
+		double argumentOfPericenter;
+		double ascendingNode;
+		double inclination;
+		//! Minor planets only
+		double epoch;
+		double meanAnomaly;
+		double meanMotion; //!< degrees per day
+		double semiMajorAxis;
+		//! Comets only
+		double timeAtPericenter;
+		double pericenterDistance;
+	};
+
+	//! Selects the objects kept while parsing.
+	struct Filter
+	{
+		Filter() : maxAbsoluteMagnitude(99.), orbitClasses(AllOrbitClasses) {}
+		bool accepts(const Elements& elements) const
+		{
+			return elements.absoluteMagnitude<=maxAbsoluteMagnitude && orbitClasses.testFlag(elements.orbitClass);
+		}
+
+		//! Objects fainter than this are dropped. The absolute magnitude of comets is their total magnitude.
+		double maxAbsoluteMagnitude;
+		OrbitClasses orbitClasses;
+	};
+
+	struct Statistics
+	{
+		Statistics() : lineCount(0), invalidCount(0), filteredCount(0) {}
+		//! Number of non empty lines
+		int lineCount;
+		//! Number of lines which are not valid elements, like the header of MPCORB.DAT
+		int invalidCount;
+		//! Number of objects rejected by the filter
+		int filteredCount;
+	};
+
+	//! Parse one line, without its end of line characters.
+	//! @return false if the line is not valid in the given format.
+	static bool parseLine(const char* line, int length, Format format, Elements& elements);
+
+	//! Parse all the lines of a buffer in parallel, keeping their order.
+	//! The accepted objects are appended to elements.
+	static void parse(const char* data, qint64 size, Format format, const Filter& filter,
+			  QVector<Elements>& elements, Statistics* statistics = Q_NULLPTR);
+
+	//! Parse a file, see parse().
+	//! @return false if the file can't be read.
+	static bool parseFile(const QString& filePath, Format format, const Filter& filter,
+			      QVector<Elements>& elements, Statistics* statistics = Q_NULLPTR);
+
+	//! Return the value of the "type" key of ssystem_minor.ini for an orbit class.
+	static QString getOrbitClassName(OrbitClass orbitClass);
+
+	//! Unpacks an MPC packed minor planet provisional designation.
+	//! See http://www.minorplanetcenter.org/iau/info/PackedDes.html
+	//! \returns an empty string if the argument is not a valid packed
+	//! provisional designation.
+	static QString unpackMinorPlanetProvisionalDesignation(const char* packed, int length);
+
+private:
+	enum LineStatus {
+		InvalidLine,
+		FilteredLine,
+		AcceptedLine
+	};
+	struct Chunk;
+	static void parseChunk(Chunk& chunk);
+	//! The numbers are read and the filter is applied before the names, which need memory allocations.
+	//! @param filter may be Q_NULLPTR.
+	static LineStatus parseMinorPlanetLine(const char* line, int length, const Filter* filter, Elements& elements);
+	static LineStatus parseCometLine(const char* line, int length, const Filter* filter, Elements& elements);
+
+	//! Size of the chunks of a file parsed in parallel
+	static const int CHUNK_SIZE = 1 << 20;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(MpcParser::OrbitClasses)
+
+#endif // _MPC_PARSER_HPP_
@@ -24,16 +24,20 @@
 
 #include "StelGui.hpp"
 #include "StelModule.hpp"
+#include "MpcParser.hpp"
 //#include "CAIMainWindow.hpp"
 
 #include <QHash>
 #include <QList>
+#include <QPair>
 #include <QString>
 #include <QVariant>
+#include <QVector>
 
 class SolarSystemManagerWindow;
 class SolarSystem;
 class QSettings;
+class QTextStream;
 
 //! Convenience type for storage of SSO properties in ssystem_minor.ini format.
 //! This is an easy way of storing data in the format used in Stellarium's
@@ -88,11 +92,11 @@ public:
 	//! The MPC's one-line orbital elements format for comets
 	//! is described on their website:
 	//! http://www.minorplanetcenter.org/iau/info/CometOrbitFormat.html
+	//! MpcParser is used internally to parse the line.
 	//! \returns an empty hash if there is an error or the source string is not
 	//! a valid line in MPC format.
 	//! \todo Recognise the long form packed designations (to handle fragments)
 	//! \todo Handle better any unusual symbols in section names (URL encoding?)
-	//! \todo Use column cuts intead of a regular expression?
 	SsoElements readMpcOneLineCometElements(QString oneLineElements) const;
 
 	//! Reads a single minor planet's orbital elements from a string.
@@ -101,6 +105,7 @@ public:
 	//! The MPC's one-line orbital elements format for minor planets
 	//! is described on their website:
 	//! http://www.minorplanetcenter.org/iau/info/MPOrbitFormat.html
+	//! MpcParser is used internally to parse the line.
 	//! \returns an empty hash if there is an error or the source string is not
 	//! a valid line in MPC format.
 	//! \todo Handle better any unusual symbols in section names (URL encoding?)
@@ -124,7 +129,7 @@ public:
 	//! hashes in Stellarium's ssystem.ini format.
 	//! Example source file is the list of observable comets on the MPC's site:
 	//! http://www.minorplanetcenter.org/iau/Ephemerides/Comets/Soft00Cmt.txt
-	//! readMpcOneLineCometElements() is used internally to parse each line.
+	//! The file is parsed in parallel by MpcParser.
 	QList<SsoElements> readMpcOneLineCometElementsFromFile(QString filePath) const;
 
 	//! Reads a list of minor planet orbital elements from a file.
@@ -133,9 +138,23 @@ public:
 	//! a list of hashes in Stellarium's ssystem.ini format.
 	//! Example source file is the list of bright asteroids on the MPC's site:
 	//! http://www.minorplanetcenter.org/iau/Ephemerides/Bright/2010/Soft00Bright.txt
-	//! readMpcOneLineMinorPlanetElements() is used internally to parse each line.
+	//! The file is parsed in parallel by MpcParser.
 	QList<SsoElements> readMpcOneLineMinorPlanetElementsFromFile(QString filePath) const;
 
+	//! Reads a file of orbital elements in one of the MPC one-line formats.
+	//! Only the objects accepted by the filter are converted to hashes.
+	QList<SsoElements> readMpcOneLineElementsFromFile(QString filePath, MpcParser::Format format, const MpcParser::Filter& filter = MpcParser::Filter()) const;
+
+	//! Adds all the objects of a file in MPC's one-line format to the user
+	//! solar system configuration file, and reloads the Solar System.
+	//! Unlike readMpcOneLineMinorPlanetElementsFromFile() followed by
+	//! appendToSolarSystemConfigurationFile(), the objects are kept in the
+	//! compact form of MpcParser until they are written, which allows
+	//! importing the whole MPCORB.DAT.
+	//! \param filter selects the objects by absolute magnitude and orbit class.
+	//! \returns false if the file can't be read or nothing has been added.
+	bool importMpcOneLineElementsFromFile(QString filePath, MpcParser::Format format, const MpcParser::Filter& filter = MpcParser::Filter());
+
 	/*
 	 * GZ identified as DEAD CODE as of 0.16pre. Maybe reactivate as public slot for scripting use?
 	//! Reads a list of Solar System object orbital elements from a file.
@@ -184,6 +203,11 @@ public:
 	//! \todo At least warn when overwriting old entries?
 	bool appendToSolarSystemConfigurationFile(QList<SsoElements>);
 
+	//! Adds new entries read by MpcParser at the end of the user solar system
+	//! configuration file, like appendToSolarSystemConfigurationFile(QList<SsoElements>).
+	//! Each object is converted to SsoElements only when it is written.
+	bool appendToSolarSystemConfigurationFile(const QVector<MpcParser::Elements>& objects);
+
 	//! Flags to control the updateSolarSystemConfigurationFile() function.
 	enum UpdateFlag {
 		UpdateNameAndNumber = 0x01,//!< Update the name and minor planet number, if any.
@@ -277,30 +301,17 @@ private:
 	//! cloneSolarSystemConfigurationFile().
 	//! \returns true if the replacement has been successfull.
 	bool resetSolarSystemConfigurationFile() const;
-
-	//! Converts an alphanumeric digit as used in MPC packed dates to an integer.
-	//! See http://www.minorplanetcenter.org/iau/info/PackedDates.html
-	//! Interprets the digits from 0 to 9 normally, and the capital letters
-	//! from A to V as numbers between 10 and 31.
-	//! \returns -1 if the digit is invalid (0 is also an invalid ordinal number
-	//! for a day or month, so this is not a problem)
-	static int unpackDayOrMonthNumber (QChar digit);
-	//! Converts an alphanumeric year number as used in MPC packed dates to an integer.
-	//! See http://www.minorplanetcenter.org/iau/info/PackedDates.html
-	//! Also used in packed provisional designations, see
-	//! http://www.minorplanetcenter.org/iau/info/PackedDes.html
-	static int unpackYearNumber (QChar prefix, int lastTwoDigits);
-	//! Converts a two-character number used in MPC packed provisional designations.
-	//! See http://www.minorplanetcenter.org/iau/info/PackedDes.html
-	//! This function is used for both asteroid and comet designations.
-	static int unpackAlphanumericNumber (QChar prefix, int lastDigit);
-
-	//TODO: This should be public, perhaps?
-	//! Unpacks an MPC packed minor planet provisional designation.
-	//! See http://www.minorplanetcenter.org/iau/info/PackedDes.html
-	//! \returns an empty string if the argument is not a valid packed
-	//! provisional designation.
-	static QString unpackMinorPlanetProvisionalDesignation(QString packedDesignation);
+	//! Converts the elements read by MpcParser to a hash in ssystem_minor.ini format.
+	//! \returns an empty hash if no section name can be made from the name.
+	static SsoElements convertToSsoElements(const MpcParser::Elements& elements);
+
+	//! Removes the entries of the user solar system configuration file which
+	//! have the same name or section name as the new ones, before they are appended.
+	//! \param identifiers the names and section names of the new entries.
+	bool removeDuplicates(const QList<QPair<QString,QString> >& identifiers);
+	//! Writes an entry of the solar system configuration file. The stream is not flushed.
+	//! \returns false if the entry has no name or section name.
+	static bool writeSsoElements(QTextStream& output, SsoElements object);
 
 	//! Updates a value in a configuration file with a value with the same key in a SsoElements hash.
 	static void updateSsoProperty(QSettings& configuration, SsoElements& properties, QString key);
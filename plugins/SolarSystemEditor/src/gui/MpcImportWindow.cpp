@@ -231,7 +231,13 @@ void MpcImportWindow::acquireObjectData()
 		if (filePath.isEmpty())
 			return;
 
-		QList<SsoElements> objects = readElementsFromFile(importType, filePath);
+		if (ui->checkBoxImportAll->isChecked())
+		{
+			importAllElementsFromFile(filePath);
+			return;
+		}
+
+		QList<SsoElements> objects = readElementsFromFile(importType, filePath, MpcParser::Filter());
 		if (objects.isEmpty())
 			return;
 
@@ -438,6 +444,7 @@ void MpcImportWindow::enableInterface(bool enable)
 
 	ui->frameFile->setEnabled(enable);
 	ui->frameURL->setEnabled(enable);
+	ui->frameImportAll->setEnabled(enable);
 
 	ui->radioButtonFile->setEnabled(enable);
 	ui->radioButtonURL->setEnabled(enable);
@@ -459,20 +466,43 @@ SsoElements MpcImportWindow::readElementsFromString (QString elements)
 	}
 }
 
-QList<SsoElements> MpcImportWindow::readElementsFromFile(ImportType type, QString filePath)
+QList<SsoElements> MpcImportWindow::readElementsFromFile(ImportType type, QString filePath, const MpcParser::Filter& filter)
 {
 	Q_ASSERT(ssoManager);
 
 	switch (type)
 	{
 		case MpcComets:
-			return ssoManager->readMpcOneLineCometElementsFromFile(filePath);
+			return ssoManager->readMpcOneLineElementsFromFile(filePath, MpcParser::CometFormat, filter);
 		case MpcMinorPlanets:
 		default:
-			return ssoManager->readMpcOneLineMinorPlanetElementsFromFile(filePath);
+			return ssoManager->readMpcOneLineElementsFromFile(filePath, MpcParser::MinorPlanetFormat, filter);
 	}
 }
 
+bool MpcImportWindow::importAllElementsFromFile(QString filePath)
+{
+	Q_ASSERT(ssoManager);
+
+	const MpcParser::Format format = (importType == MpcComets) ? MpcParser::CometFormat : MpcParser::MinorPlanetFormat;
+	if (!ssoManager->importMpcOneLineElementsFromFile(filePath, format, getFilter()))
+	{
+		qWarning() << "No objects imported from" << QDir::toNativeSeparators(filePath);
+		return false;
+	}
+
+	resetDialog();
+	emit objectsImported();
+	return true;
+}
+
+MpcParser::Filter MpcImportWindow::getFilter() const
+{
+	MpcParser::Filter filter;
+	filter.maxAbsoluteMagnitude = ui->doubleSpinBoxMaxMagnitude->value();
+	return filter;
+}
+
 void MpcImportWindow::switchImportType(bool)
 {
 	if (ui->radioButtonAsteroids->isChecked())
@@ -637,19 +667,23 @@ void MpcImportWindow::downloadComplete(QNetworkReply *reply)
 	}
 
 	QList<SsoElements> objects;
+	bool importedAll = false;
 	QTemporaryFile file;
 	if (file.open())
 	{
 		file.write(reply->readAll());
 		file.close();
-		objects = readElementsFromFile(importType, file.fileName());
+		if (ui->checkBoxImportAll->isChecked())
+			importedAll = importAllElementsFromFile(file.fileName());
+		else
+			objects = readElementsFromFile(importType, file.fileName(), MpcParser::Filter());
 	}
 	else
 	{
 		qWarning() << "Unable to open a temporary file. Aborting operation.";
 	}
 
-	if (objects.isEmpty())
+	if (objects.isEmpty() && !importedAll)
 	{
 		qWarning() << "No objects found in the file downloaded from"
 		           << reply->url().toString();
@@ -676,6 +710,14 @@ void MpcImportWindow::downloadComplete(QNetworkReply *reply)
 	reply->deleteLater();
 	downloadReply = Q_NULLPTR;
 
+	if (ui->checkBoxImportAll->isChecked())
+	{
+		//The dialog has been reset if the objects have been added
+		if (!importedAll)
+			enableInterface(true);
+		return;
+	}
+
 	//Temporary, until the slot/socket mechanism is ready
 	populateCandidateObjects(objects);
 	ui->stackedWidget->setCurrentIndex(1);
@@ -859,15 +901,15 @@ void MpcImportWindow::readQueryReply(QNetworkReply * reply)
 		QString queryData = ui->lineEditQuery->text().trimmed();
 
 		if (cometDesignation.indexIn(queryData) == 0 || cometProvisionalDesignation.indexIn(queryData) == 0)
-			objects = readElementsFromFile(MpcComets, file.fileName());
+			objects = readElementsFromFile(MpcComets, file.fileName(), MpcParser::Filter());
 		else
-			objects = readElementsFromFile(MpcMinorPlanets, file.fileName());
+			objects = readElementsFromFile(MpcMinorPlanets, file.fileName(), MpcParser::Filter());
 
 		/*
 		//Try to read it as a comet first?
-		objects = readElementsFromFile(MpcComets, file.fileName());
+		objects = readElementsFromFile(MpcComets, file.fileName(), MpcParser::Filter());
 		if (objects.isEmpty())
-			objects = readElementsFromFile(MpcMinorPlanets, file.fileName());
+			objects = readElementsFromFile(MpcMinorPlanets, file.fileName(), MpcParser::Filter());
 		*/
 		//XEphem given wrong data for comets --AW
 		//objects = ssoManager->readXEphemOneLineElementsFromFile(file.fileName());
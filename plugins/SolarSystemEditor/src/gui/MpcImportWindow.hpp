@@ -104,7 +104,14 @@ private:
 	//! wrapper for the single object function to allow multiple formats.
 	SsoElements readElementsFromString(QString elements);
 	//! wrapper for the file function to allow multiple formats
-	QList<SsoElements> readElementsFromFile(ImportType type, QString filePath);
+	QList<SsoElements> readElementsFromFile(ImportType type, QString filePath, const MpcParser::Filter& filter);
+	//! Adds all the objects of the file accepted by the filter of the dialog to the Solar System,
+	//! without listing them, using SolarSystemEditor::importMpcOneLineElementsFromFile().
+	//! 
+eturns false if nothing has been added.
+	bool importAllElementsFromFile(QString filePath);
+	//! Returns the filter set in the dialog for importAllElementsFromFile().
+	MpcParser::Filter getFilter() const;
 
 	void populateBookmarksList();
 	//void populateCandidateObjects();
@@ -28,6 +28,7 @@
 #include "StelUtils.hpp"
 #include "TelescopeControl.hpp"
 #include "TelescopeClient.hpp"
+#include "TelescopeClientThread.hpp"
 #include "TelescopeDialog.hpp"
 #include "SlewDialog.hpp"
 #include "LogFile.hpp"
@@ -90,6 +91,9 @@ StelPluginInfo TelescopeControlStelPluginInterface::getPluginInfo() const
 // Constructor and destructor
 TelescopeControl::TelescopeControl()
 	: toolbarButton(Q_NULLPTR)
+	, clientThread(new TelescopeClientThread(this))
+	, lastDrawTime(0)
+	, lastDrawnCount(0)
 	, useTelescopeServerLogs(false)
 	, useServerExecutables(false)
 	, telescopeDialog(Q_NULLPTR)
@@ -117,6 +121,8 @@ TelescopeControl::~TelescopeControl()
 // init(), update(), draw(),  getCallOrder()
 void TelescopeControl::init()
 {
+	clientThread->start();
+
 	//TODO: I think I've overdone the try/catch...
 	try
 	{
@@ -234,6 +240,7 @@ void TelescopeControl::deinit()
 {
 	//Destroy all clients first in order to avoid displaying a TCP error
 	deleteAllTelescopes();
+	clientThread->stop();
 
 	QHash<int, QProcess*>::const_iterator iterator = telescopeServerProcess.constBegin();
 	while(iterator != telescopeServerProcess.constEnd())
@@ -265,16 +272,34 @@ void TelescopeControl::update(double deltaTime)
 	communicate();
 }
 
+bool TelescopeControl::needsRedraw() const
+{
+	int drawnCount = 0;
+	foreach (const TelescopeClientP& telescope, telescopeClients)
+	{
+		if (telescope->isConnected() && telescope->hasKnownPosition())
+		{
+			if (telescope->positionChangedSince(lastDrawTime))
+				return true;
+			++drawnCount;
+		}
+	}
+	return drawnCount!=lastDrawnCount;
+}
+
 void TelescopeControl::draw(StelCore* core)
 {
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter sPainter(prj);
 	sPainter.setFont(labelFont);
 	reticleTexture->bind();	
+	lastDrawTime = getNow();
+	lastDrawnCount = 0;
 	foreach (const TelescopeClientP& telescope, telescopeClients)
 	{
 		if (telescope->isConnected() && telescope->hasKnownPosition())
 		{
+			++lastDrawnCount;
 			Vec3d XY;
 			if (prj->projectCheck(telescope->getJ2000EquatorialPos(core), XY))
 			{
@@ -447,8 +472,8 @@ void TelescopeControl::communicate(void)
 		QMap<int, TelescopeClientP>::const_iterator telescope = telescopeClients.constBegin();
 		while (telescope != telescopeClients.end())
 		{
-			logAtSlot(telescope.key());//If there's no log, it will be ignored
-			if(telescope.value()->prepareCommunication())
+			//The other clients communicate in clientThread
+			if(telescope.value()->thread() == thread() && telescope.value()->prepareCommunication())
 			{
 				telescope.value()->performCommunication();
 			}
@@ -466,6 +491,8 @@ void TelescopeControl::deleteAllTelescopes()
 	//TODO: I really hope that this won't cause a memory leak...
 	//foreach (TelescopeClient* telescope, telescopeClients)
 	//	delete telescope;
+	foreach (const TelescopeClientP& telescope, telescopeClients)
+		clientThread->removeClient(telescope.data());
 	telescopeClients.clear();
 }
 
@@ -898,7 +925,6 @@ void TelescopeControl::loadTelescopes()
 				else
 				{
 					addLogAtSlot(slot);
-					logAtSlot(slot);
 					if(!startClientAtSlot(slot, connectionType, name, equinox, QString(), 0, delay, internalCircles, deviceModelName, portSerial))
 					{
 						qDebug() << "[TelescopeControl] Unable to create a telescope client at slot" << slot;
@@ -1108,7 +1134,6 @@ bool TelescopeControl::startTelescopeAtSlot(int slot)
 		else
 		{
 			addLogAtSlot(slot);
-			logAtSlot(slot);
 			if (startClientAtSlot(slot, connectionType, name, equinox, QString(), 0, delay, circles, deviceModelName, portSerial))
 			{
 				emit clientConnected(slot, name);
@@ -1298,7 +1323,8 @@ bool TelescopeControl::startClientAtSlot(int slotNumber, ConnectionType connecti
 
 	qDebug() << "connectionType:" << connectionType << " initString:" << initString;
 
-	TelescopeClient* newTelescope = TelescopeClient::create(initString);
+	//The clients communicating with a server or a device do it in their own thread
+	TelescopeClient* newTelescope = clientThread->createClient(initString, telescopeServerLogStreams.value(slotNumber));
 	if (newTelescope)
 	{
 		//Add FOV circles to the client if there are any specified
@@ -1331,6 +1357,11 @@ bool TelescopeControl::stopClientAtSlot(int slotNumber)
 	{
 		GETSTELMODULE(StelObjectMgr)->unSelect();
 	}
+	const TelescopeClientP& telescope = telescopeClients.value(slotNumber);
+	qDebug() << "[TelescopeControl] Latency of" << telescope->getEnglishName()
+		 << "positions:" << telescope->getPositionLatency().toString()
+		 << "gotos:" << telescope->getGotoLatency().toString();
+	clientThread->removeClient(telescope.data());
 	telescopeClients.remove(slotNumber);
 
 	//This is not needed by every client
@@ -1610,12 +1641,6 @@ void TelescopeControl::removeLogAtSlot(int slot)
 	}
 }
 
-void TelescopeControl::logAtSlot(int slot)
-{
-	if(telescopeServerLogStreams.contains(slot))
-		log_file = telescopeServerLogStreams.value(slot);
-}
-
 QStringList TelescopeControl::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords, bool inEnglish) const
 {
 	QStringList result;
@@ -52,6 +52,7 @@ class StelObject;
 class StelPainter;
 class StelProjector;
 class TelescopeClient;
+class TelescopeClientThread;
 class TelescopeDialog;
 class SlewDialog;
 
@@ -80,6 +81,9 @@ public:
 	virtual void init();
 	virtual void deinit();
 	virtual void update(double deltaTime);
+	//! Return true if a telescope position changed since the last draw(), even if the time is paused:
+	//! a new position was received, a goto is in progress or a telescope (dis)connected.
+	virtual bool needsRedraw() const;
 	virtual void draw(StelCore * core);
 	virtual double getCallOrder(StelModuleActionName actionName) const;
 	
@@ -314,6 +318,11 @@ private:
 	
 	//! Contains the initialized telescope client objects representing the telescopes that Stellarium is connected to or attempting to connect to.
 	QMap<int, TelescopeClientP> telescopeClients;
+	//! The thread in which the clients communicate, except the virtual and RTS2 ones
+	TelescopeClientThread* clientThread;
+	//! Time of the last draw() in microseconds (see getNow()), and number of telescopes drawn then, used by needsRedraw()
+	qint64 lastDrawTime;
+	int lastDrawnCount;
 	//! Contains QProcess objects of the currently running telescope server processes that have been launched by Stellarium.
 	QHash<int, QProcess*> telescopeServerProcess;
 	QStringList telescopeServers;
@@ -363,7 +372,6 @@ private:
 	bool restoreDeviceModelsListTo(QString deviceModelsListPath);
 	
 	void addLogAtSlot(int slot);
-	void logAtSlot(int slot);
 	void removeLogAtSlot(int slot);
 	
 	static void translations();
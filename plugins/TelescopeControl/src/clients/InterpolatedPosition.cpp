@@ -25,8 +25,41 @@
 
 #include "InterpolatedPosition.hpp"
 
+#include <atomic>
+
+#ifdef Q_OS_WIN
+	#include <windows.h> // GetSystemTimeAsFileTime()
+#else
+	#include <sys/time.h>
+#endif
+
+//! returns the current system time in microseconds since the Epoch
+//! Prior to revision 6308, it was necessary to put put this method in an
+//! #ifdef block, as duplicate function definition caused errors during static
+//! linking.
+qint64 getNow(void)
+{
+// At the moment this can't be done in a platform-independent way with Qt
+// (QDateTime and QTime don't support microsecond precision)
+	qint64 t;
+	//StelCore *core = StelApp::getInstance().getCore();
+#ifdef Q_OS_WIN
+	FILETIME file_time;
+	GetSystemTimeAsFileTime(&file_time);
+	t = (*((__int64*)(&file_time))/10) - 86400000000LL*134774;
+#else
+	struct timeval tv;
+	gettimeofday(&tv,0);
+	t = tv.tv_sec * 1000000LL + tv.tv_usec;
+#endif
+	// GZ JDfix for 0.14 I am 99.9% sure we no longer need the anti-correction
+	//return t - core->getDeltaT(StelUtils::getJDFromSystem())*1000000; // Delta T anti-correction
+	return t;
+}
+
 InterpolatedPosition::InterpolatedPosition() :
-		end_position(positions+(sizeof(positions)/sizeof(positions[0])))
+		end_position(positions+PositionCount)
+		, sequence(0)
 {
 	reset();
 }
@@ -36,8 +69,36 @@ InterpolatedPosition::~InterpolatedPosition()
 
 }
 
+void InterpolatedPosition::beginWrite()
+{
+	sequence.store(sequence.load()+1);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+void InterpolatedPosition::endWrite()
+{
+	sequence.storeRelease(sequence.load()+1);
+}
+
+int InterpolatedPosition::read(Position* copy) const
+{
+	for (;;)
+	{
+		const int seq = sequence.loadAcquire();
+		if (seq & 1)
+			continue; // add() is being called, it takes no time
+		for (int i=0; i<PositionCount; ++i)
+			copy[i] = positions[i];
+		const int last = position_pointer - positions;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sequence.load()==seq)
+			return last;
+	}
+}
+
 void InterpolatedPosition::reset()
 {
+	beginWrite();
 	for (position_pointer = positions; position_pointer < end_position; position_pointer++)
 	{
 		position_pointer->server_micros = INT64_MAX;
@@ -48,12 +109,14 @@ void InterpolatedPosition::reset()
 		position_pointer->status = 0;
 	}
 	position_pointer = positions;
+	endWrite();
 }
 
 void InterpolatedPosition::add(Vec3d &position, qint64 clientTime, qint64 serverTime, int status)
 {
 	// remember the time and received position so that later we
 	// will know where the telescope is pointing to:
+	beginWrite();
 	position_pointer++;
 	if (position_pointer >= end_position)
 		position_pointer = positions;
@@ -62,20 +125,52 @@ void InterpolatedPosition::add(Vec3d &position, qint64 clientTime, qint64 server
 	position_pointer->server_micros = serverTime;
 	position_pointer->client_micros = clientTime;
 	position_pointer->status = status;
+	endWrite();
+}
+
+bool InterpolatedPosition::isKnown() const
+{
+	Position copy[PositionCount];
+	return copy[read(copy)].client_micros != INT64_MAX;
+}
+
+bool InterpolatedPosition::changesAfter(qint64 time) const
+{
+	Position copy[PositionCount];
+	const Position *const last = copy + read(copy);
+	const Position *const end = copy + PositionCount;
+
+	// get() interpolates between consecutive positions, so it changes after time if any pair
+	// ending after time holds different positions
+	const Position *p = last;
+	for (int i=0; i<PositionCount-1 && p->client_micros != INT64_MAX && p->client_micros > time; ++i)
+	{
+		const Position *pp = (p == copy ? end : p) - 1;
+		// the first position received makes the telescope appear
+		if (pp->client_micros == INT64_MAX || pp->pos != p->pos)
+			return true;
+		p = pp;
+	}
+	return false;
 }
 
 Vec3d InterpolatedPosition::get(qint64 now) const
 {
-	if (position_pointer->client_micros == INT64_MAX)
+	// work on a copy, the positions may be added from another thread
+	Position copy[PositionCount];
+	const Position *const last = copy + read(copy);
+	const Position *const end = copy + PositionCount;
+
+	if (last->client_micros == INT64_MAX)
 	{
 		return Vec3d(0,0,0);
 	}
 
-	const Position *p = position_pointer;
+	const Position *p = last;
 	do
 	{
 		const Position *pp = p;
-		if (pp == positions) pp = end_position;
+		if (pp == copy) pp = end;
 		pp--;
 		if (pp->client_micros == INT64_MAX) break;
 		if (pp->client_micros <= now && now <= p->client_micros)
@@ -93,7 +188,7 @@ Vec3d InterpolatedPosition::get(qint64 now) const
 		}
 		p = pp;
 	}
-	while (p != position_pointer);
+	while (p != last);
 
 	return Vec3d(p->pos);
 }
@@ -33,6 +33,11 @@
 
 #include "VecMath.hpp"
 
+#include <QAtomicInt>
+
+//! Return the current system time in microseconds since the Epoch, the time base of the positions.
+qint64 getNow(void);
+
 //! A telescope's position at a given time.
 //! This structure used to be defined inline in TelescopeTCP.
 struct Position
@@ -43,6 +48,10 @@ struct Position
 	int status;
 };
 
+//! Keeps the last positions received from a telescope, to interpolate where it is pointing to.
+//! One thread, the one communicating with the telescope, may call add() and reset() while others
+//! call get() and isKnown(). The positions are handed over without lock: the writer makes a
+//! sequence number odd while it modifies them, and readers retry their copy when it changed.
 class InterpolatedPosition {
 public:
 	InterpolatedPosition();
@@ -53,12 +62,23 @@ public:
 	Vec3d get(qint64 time) const;
 	//! resets/initializes the array of positions kept for position interpolation
 	void reset();
-	bool isKnown() const {return (position_pointer->client_micros != INT64_MAX);}
+	bool isKnown() const;
+	//! Return true if get() can return a different position for a time after the given one than for that time,
+	//! i.e. if a position which differs from the previous one was received after it.
+	bool changesAfter(qint64 time) const;
 	
 private:
-	Position positions[16];
+	enum {PositionCount = 16};
+	//! Copy the positions consistently and return the index of the last one
+	int read(Position* copy) const;
+	//! Mark the beginning and the end of a modification for the readers
+	void beginWrite();
+	void endWrite();
+
+	Position positions[PositionCount];
 	Position *position_pointer;
 	Position *const end_position;
+	QAtomicInt sequence;
 };
  
  #endif //_INTEPOLATED_POSITION_HPP_
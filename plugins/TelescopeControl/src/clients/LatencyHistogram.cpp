@@ -0,0 +1,94 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "LatencyHistogram.hpp"
+
+#include <QStringList>
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+void LatencyHistogram::record(qint64 micros)
+{
+	buckets[bucketOf(micros)].fetchAndAddRelaxed(1);
+}
+
+void LatencyHistogram::reset()
+{
+	for (int i=0; i<BucketCount; ++i)
+		buckets[i].store(0);
+}
+
+int LatencyHistogram::count() const
+{
+	int n = 0;
+	for (int i=0; i<BucketCount; ++i)
+		n += buckets[i].load();
+	return n;
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+	int counts[BucketCount];
+	int n = 0;
+	for (int i=0; i<BucketCount; ++i)
+	{
+		counts[i] = buckets[i].load();
+		n += counts[i];
+	}
+	if (n==0)
+		return 0;
+
+	const double target = qBound(0., p, 1.)*n;
+	int sum = 0;
+	for (int i=0; i<BucketCount; ++i)
+	{
+		sum += counts[i];
+		if (counts[i]>0 && sum>=target)
+			return bucketLimit(i);
+	}
+	return bucketLimit(BucketCount-1);
+}
+
+QString LatencyHistogram::toString() const
+{
+	const int n = count();
+	if (n==0)
+		return "n=0";
+	QStringList parts;
+	parts << QString("n=%1").arg(n);
+	const double ps[] = {0.5, 0.9, 0.99, 1.};
+	const char* names[] = {"p50", "p90", "p99", "max"};
+	for (int i=0; i<4; ++i)
+	{
+		const qint64 limit = percentile(ps[i]);
+		parts << (limit<10000 ? QString("%1<%2us").arg(names[i]).arg(limit) : QString("%1<%2ms").arg(names[i]).arg(limit/1000));
+	}
+	return parts.join(' ');
+}
+
+int LatencyHistogram::bucketOf(qint64 micros)
+{
+	int bucket = 0;
+	while (bucket<BucketCount-1 && micros>=bucketLimit(bucket))
+		++bucket;
+	return bucket;
+}
@@ -0,0 +1,62 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _LATENCY_HISTOGRAM_HPP_
+#define _LATENCY_HISTOGRAM_HPP_
+
+#include <QAtomicInt>
+#include <QString>
+
+//! @class LatencyHistogram
+//! Counts latencies in power of two buckets of microseconds: bucket 0 holds latencies below 2 us,
+//! bucket k>0 the ones from 2^k to 2^(k+1) us.
+//! record() is lock-free, so the I/O thread of the telescope clients can record while the
+//! main thread reads the statistics.
+class LatencyHistogram
+{
+public:
+	enum {BucketCount = 32};
+
+	LatencyHistogram();
+
+	//! Count one latency. Negative values, e.g. from a server with another clock, are counted as 0.
+	void record(qint64 micros);
+	//! Set all the counts to 0.
+	void reset();
+
+	//! Return the number of recorded latencies.
+	int count() const;
+	//! Return the number of latencies in a bucket.
+	int bucketCount(int bucket) const {return buckets[bucket].load();}
+	//! Return the upper bound in us of the bucket holding the latency below which the fraction
+	//! p of the recorded latencies is, or 0 if nothing was recorded.
+	qint64 percentile(double p) const;
+	//! Return a short summary like "n=120 p50<2ms p90<8ms p99<33ms max<66ms" for the logs.
+	QString toString() const;
+
+	//! Return the bucket in which a latency is counted.
+	static int bucketOf(qint64 micros);
+	//! Return the upper bound in us of a bucket.
+	static qint64 bucketLimit(int bucket) {return Q_INT64_C(2) << bucket;}
+
+private:
+	QAtomicInt buckets[BucketCount];
+};
+
+#endif // _LATENCY_HISTOGRAM_HPP_
@@ -26,6 +26,7 @@
 #ifndef _TELESCOPE_HPP_
 #define _TELESCOPE_HPP_
 
+#include <QAtomicInt>
 #include <QHostAddress>
 #include <QHostInfo>
 #include <QList>
@@ -36,11 +37,11 @@
 #include "StelApp.hpp"
 #include "StelObject.hpp"
 #include "InterpolatedPosition.hpp"
+#include "LatencyHistogram.hpp"
+#include "TelescopeTCPLink.hpp"
 
 class StelCore;
 
-qint64 getNow(void);
-
 enum Equinox {
 	EquinoxJ2000,
 	EquinoxJNow
@@ -82,16 +83,31 @@ public:
 	virtual void telescopeGoto(const Vec3d &j2000Pos, StelObjectP selectObject) = 0;
 	virtual bool isConnected(void) const = 0;
 	virtual bool hasKnownPosition(void) const = 0;
+	//! Return true if getJ2000EquatorialPos() may return a different position than at the given time
+	//! in microseconds (see getNow()), because a new position was received or a goto is in progress.
+	virtual bool positionChangedSince(qint64 time) const {Q_UNUSED(time); return false;}
 	void addOcular(double fov) {if (fov>=0.0) oculars.push_back(fov);}
 	const QList<double> &getOculars(void) const {return oculars;}
 	
 	virtual bool prepareCommunication() {return false;}
 	virtual void performCommunication() {}
+	//! Return true if the communication can run in a TelescopeClientThread.
+	//! The client must then hand over its state to the methods called from the main thread
+	//! (isConnected(), hasKnownPosition(), getJ2000EquatorialPos(), telescopeGoto()) in a thread safe way.
+	virtual bool canCommunicateInThread() const {return false;}
+
+	//! Latency of the position updates, from the time the position was reported by the telescope
+	//! or the server until it was received. Only meaningful if both use the same clock.
+	const LatencyHistogram& getPositionLatency() const {return positionLatency;}
+	//! Latency of the goto commands, from the call of telescopeGoto() until the command was sent.
+	const LatencyHistogram& getGotoLatency() const {return gotoLatency;}
 
 protected:
 	TelescopeClient(const QString &name);
 	QString nameI18n;
 	const QString name;
+	LatencyHistogram positionLatency;
+	LatencyHistogram gotoLatency;
 
 	virtual QString getTelescopeInfoString(const StelCore* core, const InfoStringGroup& flags) const
 	{
@@ -145,6 +161,11 @@ public:
 	{
 		return true;
 	}
+	//! The position moves towards the goto target at each communication
+	bool positionChangedSince(qint64) const
+	{
+		return (XYZ - desired_pos).lengthSquared() > 1e-12;
+	}
 	Vec3d getJ2000EquatorialPos(const StelCore*) const
 	{
 		return XYZ;
@@ -160,57 +181,46 @@ private:
 //! the "Stellarium telescope control protocol" over TCP/IP.
 //! The "Stellarium telescope control protocol" is specified in a separate
 //! document along with the telescope server software.
+//! The communication is done by a TelescopeTCPLink, in the thread of the client.
 class TelescopeTCP : public TelescopeClient
 {
 	Q_OBJECT
 public:
 	TelescopeTCP(const QString &name, const QString &params, Equinox eq = EquinoxJ2000);
-	~TelescopeTCP(void)
-	{
-		hangup();
-	}
 	bool isConnected(void) const
 	{
-		//return (tcpSocket->isValid() && !wait_for_connection_establishment);
-		return (tcpSocket->state() == QAbstractSocket::ConnectedState);
+		return link.isConnected();
 	}
 	
 private:
 	Vec3d getJ2000EquatorialPos(const StelCore* core=Q_NULLPTR) const;
-	bool prepareCommunication();
-	void performCommunication();
+	bool prepareCommunication() {return link.prepareCommunication();}
+	void performCommunication() {link.performCommunication();}
+	bool canCommunicateInThread() const {return true;}
 	void telescopeGoto(const Vec3d &j2000Pos, StelObjectP selectObject);
 	bool isInitialized(void) const
 	{
 		return (!address.isNull());
 	}
-	void performReading(void);
-	void performWriting(void);
 	
 private:
-	void hangup(void);
 	QHostAddress address;
-	unsigned int port;
-	QTcpSocket * tcpSocket;
-	bool wait_for_connection_establishment;
-	qint64 end_of_timeout;
-	char readBuffer[120];
-	char *readBufferEnd;
-	char writeBuffer[120];
-	char *writeBufferEnd;
 	int time_delay;
 
+	//! Positions in the equinox of the server
 	InterpolatedPosition interpolatedPosition;
 	virtual bool hasKnownPosition(void) const
 	{
 		return interpolatedPosition.isKnown();
 	}
+	virtual bool positionChangedSince(qint64 time) const
+	{
+		return interpolatedPosition.changesAfter(time - time_delay);
+	}
 
 	Equinox equinox;
-	
-private slots:
-	void socketConnected(void);
-	void socketFailed(QAbstractSocket::SocketError socketError);
+	//! Declared after the positions and the histograms it uses, and destroyed before them
+	TelescopeTCPLink link;
 };
 
 #endif // _TELESCOPE_HPP_
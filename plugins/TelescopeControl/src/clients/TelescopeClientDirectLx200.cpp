@@ -44,6 +44,12 @@ TelescopeClientDirectLx200::TelescopeClientDirectLx200 (const QString &name, con
 	, last_ra(0)
 	, queue_get_position(true)
 	, next_pos_time(0)
+	, pos_request_time(0)
+	, connected(0)
+	, goto_pending(false)
+	, goto_ra(0)
+	, goto_dec(0)
+	, goto_request_time(0)
 {
 	interpolatedPosition.reset();
 	
@@ -95,6 +101,7 @@ TelescopeClientDirectLx200::TelescopeClientDirectLx200 (const QString &name, con
 	queue_get_position = true;
 	next_pos_time = -0x8000000000000000LL;
 	answers_received = false;
+	connected.store(1);
 }
 
 //! queues a GOTO command
@@ -122,7 +129,8 @@ void TelescopeClientDirectLx200::telescopeGoto(const Vec3d &j2000Pos, StelObject
 		unsigned int ra_int = (unsigned int)floor(0.5 + ra*(((unsigned int)0x80000000)/M_PI));
 		int dec_int = (int)floor(0.5 + dec*(((unsigned int)0x80000000)/M_PI));
 
-		gotoReceived(ra_int, dec_int);
+		QMetaObject::invokeMethod(this, "queueGoto", Qt::QueuedConnection,
+					  Q_ARG(unsigned int, ra_int), Q_ARG(int, dec_int), Q_ARG(qint64, getNow()));
 	}
 	/*
 		else
@@ -137,12 +145,28 @@ void TelescopeClientDirectLx200::gotoReceived(unsigned int ra_int, int dec_int)
 	lx200->sendGoto(ra_int, dec_int);
 }
 
+void TelescopeClientDirectLx200::queueGoto(unsigned int ra_int, int dec_int, qint64 requestTime)
+{
+	// sent by step(), where the log of the connection is set
+	goto_pending = true;
+	goto_ra = ra_int;
+	goto_dec = dec_int;
+	goto_request_time = requestTime;
+}
+
 //! estimates where the telescope is by interpolation in the stored
 //! telescope positions:
-Vec3d TelescopeClientDirectLx200::getJ2000EquatorialPos(const StelCore*) const
+Vec3d TelescopeClientDirectLx200::getJ2000EquatorialPos(const StelCore* core) const
 {
 	const qint64 now = getNow() - time_delay;
-	return interpolatedPosition.get(now);
+	const Vec3d position = interpolatedPosition.get(now);
+	if (equinox == EquinoxJNow)
+	{
+		if (!core)
+			core = StelApp::getInstance().getCore();
+		return core->equinoxEquToJ2000(position, StelCore::RefractionOff);
+	}
+	return position;
 }
 
 bool TelescopeClientDirectLx200::prepareCommunication()
@@ -153,7 +177,8 @@ bool TelescopeClientDirectLx200::prepareCommunication()
 
 void TelescopeClientDirectLx200::performCommunication()
 {
-	step(10000);
+	// Don't wait for data: TelescopeClientThread calls this every few milliseconds
+	step(0);
 }
 
 void TelescopeClientDirectLx200::communicationResetReceived(void)
@@ -210,19 +235,27 @@ void TelescopeClientDirectLx200::decReceived(unsigned int dec_int)
 void TelescopeClientDirectLx200::step(long long int timeout_micros)
 {
 	long long int now = GetNow();
+	if (goto_pending)
+	{
+		gotoReceived(goto_ra, goto_dec);
+		gotoLatency.record(now - goto_request_time);
+		goto_pending = false;
+	}
 	if (queue_get_position && now >= next_pos_time)
 	{
 		lx200->sendCommand(new Lx200CommandGetRa(*this));
 		lx200->sendCommand(new Lx200CommandGetDec(*this));
 		queue_get_position = false;
+		pos_request_time = now;
 		next_pos_time = now + 500000;// 500000;
 	}
 	Server::step(timeout_micros);
+	connected.store(!lx200->isClosed());
 }
 
 bool TelescopeClientDirectLx200::isConnected(void) const
 {
-	return (!lx200->isClosed());//TODO
+	return connected.load();//TODO
 }
 
 bool TelescopeClientDirectLx200::isInitialized(void) const
@@ -239,11 +272,7 @@ void TelescopeClientDirectLx200::sendPosition(unsigned int ra_int, int dec_int,
 	const double dec = dec_int * (M_PI/(unsigned int)0x80000000);
 	const double cdec = cos(dec);
 	Vec3d position(cos(ra)*cdec, sin(ra)*cdec, sin(dec));
-	Vec3d j2000Position = position;
-	if (equinox == EquinoxJNow)
-	{
-		const StelCore* core = StelApp::getInstance().getCore();
-		j2000Position = core->equinoxEquToJ2000(position, StelCore::RefractionOff);
-	}
-	interpolatedPosition.add(j2000Position, getNow(), server_micros, status);
+	// converted to J2000 by getJ2000EquatorialPos() in the main thread
+	interpolatedPosition.add(position, getNow(), server_micros, status);
+	positionLatency.record(server_micros - pos_request_time);
 }
@@ -27,6 +27,7 @@
 #ifndef _TELESCOPE_CLIENT_DIRECT_LX200_
 #define _TELESCOPE_CLIENT_DIRECT_LX200_
 
+#include <QAtomicInt>
 #include <QObject>
 #include <QString>
 
@@ -70,6 +71,7 @@ private:
 	void performCommunication();
 	void telescopeGoto(const Vec3d &j2000Pos, StelObjectP selectObject);
 	bool isInitialized(void) const;
+	bool canCommunicateInThread() const {return true;}
 	
 	//======================================================================
 	// Methods inherited from Server
@@ -81,11 +83,16 @@ private:
 	void hangup(void);
 	int time_delay;
 	
+	//! Positions in the equinox of the telescope
 	InterpolatedPosition interpolatedPosition;
 	virtual bool hasKnownPosition(void) const
 	{
 		return interpolatedPosition.isKnown();
 	}
+	virtual bool positionChangedSince(qint64 time) const
+	{
+		return interpolatedPosition.changesAfter(time - time_delay);
+	}
 
 	Equinox equinox;
 	
@@ -98,6 +105,21 @@ private:
 	unsigned int last_ra;
 	bool queue_get_position;
 	long long int next_pos_time;
+	//! Time at which the current position was asked for
+	long long int pos_request_time;
+
+	//! Whether the connection is open, for the main thread
+	QAtomicInt connected;
+	//! GOTO command to send in the next step()
+	bool goto_pending;
+	unsigned int goto_ra;
+	int goto_dec;
+	qint64 goto_request_time;
+
+private slots:
+	//! Called in the thread of the client by telescopeGoto().
+	//! @param requestTime the time of the telescopeGoto() call in microseconds, see getNow().
+	void queueGoto(unsigned int ra_int, int dec_int, qint64 requestTime);
 };
 
 #endif //_TELESCOPE_CLIENT_DIRECT_LX200_
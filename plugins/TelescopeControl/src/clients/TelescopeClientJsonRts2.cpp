@@ -209,6 +209,11 @@ Vec3d TelescopeClientJsonRts2::getJ2000EquatorialPos(const StelCore*) const
 	return interpolatedPosition.get(now);
 }
 
+bool TelescopeClientJsonRts2::positionChangedSince(qint64 time) const
+{
+	return interpolatedPosition.changesAfter(time - time_delay);
+}
+
 void TelescopeClientJsonRts2::telescopeGoto(const Vec3d &j2000Pos, StelObjectP selectObject)
 {
 	if (!isConnected())
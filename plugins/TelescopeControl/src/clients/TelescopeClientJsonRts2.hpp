@@ -44,6 +44,7 @@ public:
 
 	void telescopeGoto(const Vec3d &j2000Pos, StelObjectP selectObject);
 	bool hasKnownPosition(void) const;
+	bool positionChangedSince(qint64 time) const;
 
 protected:
 	void timerEvent(QTimerEvent *event);
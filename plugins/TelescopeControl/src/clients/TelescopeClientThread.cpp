@@ -0,0 +1,115 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "TelescopeClientThread.hpp"
+#include "TelescopeClient.hpp"
+#include "LogFile.hpp"
+
+#include <QDebug>
+#include <QTimer>
+
+TelescopeClientThread::TelescopeClientThread(QObject* parent)
+	: QThread(parent)
+{
+	setObjectName("TelescopeClientThread");
+}
+
+TelescopeClientThread::~TelescopeClientThread()
+{
+	stop();
+}
+
+TelescopeClient* TelescopeClientThread::createClient(const QString& url, QTextStream* logStream)
+{
+	// The constructors of the clients for serial ports already log
+	QMutexLocker locker(&mutex);
+	log_file = logStream;
+	TelescopeClient* client = TelescopeClient::create(url);
+	if (client && client->canCommunicateInThread() && isRunning())
+	{
+		client->moveToThread(this);
+		Client c = {client, logStream, Q_NULLPTR};
+		clients.append(c);
+	}
+	return client;
+}
+
+void TelescopeClientThread::removeClient(TelescopeClient* client)
+{
+	QMutexLocker locker(&mutex);
+	for (int i=0; i<clients.size(); ++i)
+	{
+		if (clients.at(i).client!=client)
+			continue;
+		if (!isRunning())
+		{
+			qWarning() << "[TelescopeControl] Removing client" << client->getEnglishName() << "after the end of its thread";
+			clients.removeAt(i);
+			return;
+		}
+		// Only this thread can move the client back
+		clients[i].leaveTo = QThread::currentThread();
+		while (client->thread()==this)
+			clientLeft.wait(&mutex);
+		return;
+	}
+}
+
+void TelescopeClientThread::stop()
+{
+	if (!isRunning())
+		return;
+	quit();
+	wait();
+	if (!clients.isEmpty())
+		qWarning() << "[TelescopeControl] The client thread stopped with" << clients.size() << "clients";
+}
+
+void TelescopeClientThread::run()
+{
+	QTimer timer;
+	timer.setInterval(SERVICE_INTERVAL);
+	connect(&timer, &QTimer::timeout, [this]() { serviceClients(); });
+	timer.start();
+	exec();
+}
+
+void TelescopeClientThread::serviceClients()
+{
+	QMutexLocker locker(&mutex);
+	bool left = false;
+	for (int i=clients.size()-1; i>=0; --i)
+	{
+		if (clients.at(i).leaveTo)
+		{
+			clients.at(i).client->moveToThread(clients.at(i).leaveTo);
+			clients.removeAt(i);
+			left = true;
+		}
+	}
+	if (left)
+		clientLeft.wakeAll();
+
+	foreach (const Client& c, clients)
+	{
+		log_file = c.logStream;
+		if (c.client->prepareCommunication())
+			c.client->performCommunication();
+	}
+}
@@ -0,0 +1,82 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TELESCOPE_CLIENT_THREAD_HPP_
+#define _TELESCOPE_CLIENT_THREAD_HPP_
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+class QTextStream;
+class TelescopeClient;
+
+//! @class TelescopeClientThread
+//! Event loop thread in which the telescope clients communicate with their telescopes, so that
+//! position updates and goto commands don't wait for the next frame and a slow serial device can't
+//! stall the rendering.
+//! The clients which support it (TelescopeClient::canCommunicateInThread()) are moved to this thread
+//! when they are created with createClient(). Their sockets are handled here as soon as data arrives,
+//! and their prepareCommunication() and performCommunication() are called every SERVICE_INTERVAL ms
+//! for the connection attempts, timeouts and the polled serial ports.
+//! Other clients stay in the calling thread and must be serviced there.
+class TelescopeClientThread : public QThread
+{
+	Q_OBJECT
+
+public:
+	//! Interval between two calls of performCommunication() of a client in ms
+	static const int SERVICE_INTERVAL = 10;
+
+	TelescopeClientThread(QObject* parent=Q_NULLPTR);
+	~TelescopeClientThread();
+
+	//! Create a client with TelescopeClient::create() and move it to this thread if possible.
+	//! @param logStream the log used by the code of the telescope servers for this client, see log_file.
+	TelescopeClient* createClient(const QString& url, QTextStream* logStream);
+	//! Stop servicing a client and move it back to the calling thread, where it can then be deleted.
+	//! Waits until the client is no more used by this thread.
+	void removeClient(TelescopeClient* client);
+	//! Quit the event loop and wait for the end of the thread. All clients should have been removed.
+	void stop();
+
+protected:
+	virtual void run();
+
+private:
+	struct Client
+	{
+		TelescopeClient* client;
+		QTextStream* logStream;
+		//! Thread to which the client is moved back, set by removeClient()
+		QThread* leaveTo;
+	};
+
+	//! Move back the removed clients and let the others communicate, called every SERVICE_INTERVAL ms
+	void serviceClients();
+
+	//! Protects clients and log_file, which all the server code uses
+	QMutex mutex;
+	QWaitCondition clientLeft;
+	QList<Client> clients;
+};
+
+#endif // _TELESCOPE_CLIENT_THREAD_HPP_
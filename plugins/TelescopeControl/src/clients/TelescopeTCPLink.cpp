@@ -0,0 +1,352 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * Copyright (C) 2006 Johannes Gajdosik
+ * Copyright (C) 2009 Bogdan Marinov
+ *
+ * This module was originally written by Johannes Gajdosik in 2006
+ * as a core module of Stellarium. In 2009 it was significantly extended with
+ * GUI features and later split as an external plug-in module by Bogdan Marinov.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "TelescopeTCPLink.hpp"
+#include "InterpolatedPosition.hpp"
+#include "LatencyHistogram.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include <QDebug>
+
+TelescopeTCPLink::TelescopeTCPLink(const QString& name, InterpolatedPosition& positions,
+				   LatencyHistogram& positionLatency, LatencyHistogram& gotoLatency, QObject* parent)
+	: QObject(parent)
+	, name(name)
+	, interpolatedPosition(positions)
+	, positionLatency(positionLatency)
+	, gotoLatency(gotoLatency)
+	, port(0)
+	, tcpSocket(new QTcpSocket(this))
+	, connected(0)
+	, end_of_timeout(-0x8000000000000000LL)
+{
+	hangup();
+
+	connect(tcpSocket, SIGNAL(connected()), this, SLOT(socketConnected()));
+	connect(tcpSocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(socketFailed(QAbstractSocket::SocketError)));
+	connect(tcpSocket, SIGNAL(readyRead()), this, SLOT(socketReadyRead()));
+}
+
+void TelescopeTCPLink::setServer(const QHostAddress& serverAddress, quint16 serverPort)
+{
+	address = serverAddress;
+	port = serverPort;
+}
+
+void TelescopeTCPLink::hangup(void)
+{
+	if (tcpSocket->isValid())
+	{
+		tcpSocket->abort();// Or maybe tcpSocket->close()?
+	}
+	
+	connected.store(0);
+	readBufferEnd = readBuffer;
+	writeBufferEnd = writeBuffer;
+	wait_for_connection_establishment = false;
+	
+	interpolatedPosition.reset();
+}
+
+//! converts the position to the integers of the protocol and lets the thread
+//! of the link queue the GOTO command
+void TelescopeTCPLink::sendGoto(const Vec3d& position)
+{
+	const double ra_signed = atan2(position[1], position[0]);
+	//Workaround for the discrepancy in precision between Windows/Linux/PPC Macs and Intel Macs:
+	const double ra = (ra_signed >= 0) ? ra_signed : (ra_signed + 2.0 * M_PI);
+	const double dec = atan2(position[2], std::sqrt(position[0]*position[0]+position[1]*position[1]));
+	const unsigned int ra_int = (unsigned int)floor(0.5 + ra*(((unsigned int)0x80000000)/M_PI));
+	const int dec_int = (int)floor(0.5 + dec*(((unsigned int)0x80000000)/M_PI));
+	QMetaObject::invokeMethod(this, "queueGoto", Qt::QueuedConnection,
+				  Q_ARG(unsigned int, ra_int), Q_ARG(int, dec_int), Q_ARG(qint64, getNow()));
+}
+
+//! queues a GOTO command with the specified position to the write buffer
+//! and sends it at once.
+//! For the data format of the command see the
+//! "Stellarium telescope control protocol" text file
+void TelescopeTCPLink::queueGoto(unsigned int ra_int, int dec_int, qint64 requestTime)
+{
+	if (tcpSocket->state() != QAbstractSocket::ConnectedState)
+		return;
+
+	if (writeBufferEnd - writeBuffer + 20 < (int)sizeof(writeBuffer))
+	{
+		// length of packet:
+		*writeBufferEnd++ = 20;
+		*writeBufferEnd++ = 0;
+		// type of packet:
+		*writeBufferEnd++ = 0;
+		*writeBufferEnd++ = 0;
+		// client_micros:
+		qint64 now = getNow();
+		*writeBufferEnd++ = now;
+		now>>=8;
+		*writeBufferEnd++ = now;
+		now>>=8;
+		*writeBufferEnd++ = now;
+		now>>=8;
+		*writeBufferEnd++ = now;
+		now>>=8;
+		*writeBufferEnd++ = now;
+		now>>=8;
+		*writeBufferEnd++ = now;
+		now>>=8;
+		*writeBufferEnd++ = now;
+		now>>=8;
+		*writeBufferEnd++ = now;
+		// ra:
+		*writeBufferEnd++ = ra_int;
+		ra_int>>=8;
+		*writeBufferEnd++ = ra_int;
+		ra_int>>=8;
+		*writeBufferEnd++ = ra_int;
+		ra_int>>=8;
+		*writeBufferEnd++ = ra_int;
+		// dec:
+		*writeBufferEnd++ = dec_int;
+		dec_int>>=8;
+		*writeBufferEnd++ = dec_int;
+		dec_int>>=8;
+		*writeBufferEnd++ = dec_int;
+		dec_int>>=8;
+		*writeBufferEnd++ = dec_int;
+
+		performWriting();
+		gotoLatency.record(getNow() - requestTime);
+	}
+	else
+	{
+		qDebug() << "TelescopeTCP(" << name << ")::queueGoto: "<< "communication is too slow, I will ignore this command";
+	}
+}
+
+void TelescopeTCPLink::performWriting(void)
+{
+	const int to_write = writeBufferEnd - writeBuffer;
+	const int rc = tcpSocket->write(writeBuffer, to_write);
+	if (rc < 0)
+	{
+		//TODO: Better error message. See the Qt documentation.
+		qDebug() << "TelescopeTCP(" << name << ")::performWriting: "
+			<< "write failed: " << tcpSocket->errorString();
+		hangup();
+	}
+	else if (rc > 0)
+	{
+		if (rc >= to_write)
+		{
+			// everything written
+			writeBufferEnd = writeBuffer;
+		}
+		else
+		{
+			// partly written
+			memmove(writeBuffer, writeBuffer + rc, to_write - rc);
+			writeBufferEnd -= rc;
+		}
+	}
+}
+
+//! try to read some data from the telescope server
+void TelescopeTCPLink::performReading(void)
+{
+	const int to_read = readBuffer + sizeof(readBuffer) - readBufferEnd;
+	const int rc = tcpSocket->read(readBufferEnd, to_read);
+	if (rc < 0)
+	{
+		//TODO: Better error warning. See the Qt documentation.
+		qDebug() << "TelescopeTCP(" << name << ")::performReading: " << "read failed: " << tcpSocket->errorString();
+		hangup();
+	}
+	else if (rc == 0)
+	{
+		qDebug() << "TelescopeTCP(" << name << ")::performReading: " << "server has closed the connection";
+		hangup();
+	}
+	else
+	{
+		readBufferEnd += rc;
+		char *p = readBuffer;
+		// parse the data in the read buffer:
+		while (readBufferEnd - p >= 2)
+		{
+			const int size = (int)(((unsigned char)(p[0])) | (((unsigned int)(unsigned char)(p[1])) << 8));
+			if (size > (int)sizeof(readBuffer) || size < 4)
+			{
+				qDebug() << "TelescopeTCP(" << name << ")::performReading: " << "bad packet size: " << size;
+				hangup();
+				return;
+			}
+			if (size > readBufferEnd - p)
+			{
+				// wait for complete packet
+				break;
+			}
+			const int type = (int)(((unsigned char)(p[2])) | (((unsigned int)(unsigned char)(p[3])) << 8));
+			// dispatch:
+			switch (type)
+			{
+				case 0:
+				{
+				// We have received position information.
+				// For the data format of the message see the
+				// "Stellarium telescope control protocol"
+					if (size < 24)
+					{
+						qDebug() << "TelescopeTCP(" << name << ")::performReading: " << "type 0: bad packet size: " << size;
+						hangup();
+						return;
+					}
+					const qint64 server_micros = (qint64)
+						(((quint64)(unsigned char)(p[ 4])) |
+						(((quint64)(unsigned char)(p[ 5])) <<  8) |
+						(((quint64)(unsigned char)(p[ 6])) << 16) |
+						(((quint64)(unsigned char)(p[ 7])) << 24) |
+						(((quint64)(unsigned char)(p[ 8])) << 32) |
+						(((quint64)(unsigned char)(p[ 9])) << 40) |
+						(((quint64)(unsigned char)(p[10])) << 48) |
+						(((quint64)(unsigned char)(p[11])) << 56));
+					const unsigned int ra_int =
+						((unsigned int)(unsigned char)(p[12])) |
+						(((unsigned int)(unsigned char)(p[13])) <<  8) |
+						(((unsigned int)(unsigned char)(p[14])) << 16) |
+						(((unsigned int)(unsigned char)(p[15])) << 24);
+					const int dec_int =
+						(int)(((unsigned int)(unsigned char)(p[16])) |
+						     (((unsigned int)(unsigned char)(p[17])) <<  8) |
+						     (((unsigned int)(unsigned char)(p[18])) << 16) |
+						     (((unsigned int)(unsigned char)(p[19])) << 24));
+					const int status =
+						(int)(((unsigned int)(unsigned char)(p[20])) |
+						     (((unsigned int)(unsigned char)(p[21])) <<  8) |
+						     (((unsigned int)(unsigned char)(p[22])) << 16) |
+						     (((unsigned int)(unsigned char)(p[23])) << 24));
+
+					const double ra  =  ra_int * (M_PI/(unsigned int)0x80000000);
+					const double dec = dec_int * (M_PI/(unsigned int)0x80000000);
+					const double cdec = cos(dec);
+					Vec3d position(cos(ra)*cdec, sin(ra)*cdec, sin(dec));
+					// converted to J2000 by getJ2000EquatorialPos() in the main thread
+					const qint64 now = getNow();
+					interpolatedPosition.add(position, now, server_micros, status);
+					positionLatency.record(now - server_micros);
+				}
+				break;
+				default:
+					qDebug() << "TelescopeTCP(" << name << ")::performReading: " << "ignoring unknown packet, type: " << type;
+				break;
+			}
+			p += size;
+		}
+		if (p >= readBufferEnd)
+		{
+			// everything handled
+			readBufferEnd = readBuffer;
+		}
+		else
+		{
+			// partly handled
+			memmove(readBuffer, p, readBufferEnd - p);
+			readBufferEnd -= (p - readBuffer);
+		}
+	}
+}
+
+//! checks if the socket is connected, tries to connect if it is not
+//@return true if the socket is connected
+bool TelescopeTCPLink::prepareCommunication()
+{
+	connected.store(tcpSocket->state() == QAbstractSocket::ConnectedState);
+	if(tcpSocket->state() == QAbstractSocket::ConnectedState)
+	{
+		if(wait_for_connection_establishment)
+		{
+			wait_for_connection_establishment = false;
+			qDebug() << "TelescopeTCP(" << name << ")::prepareCommunication: Connection established";
+		}
+		return true;
+	}
+	else if(wait_for_connection_establishment)
+	{
+		const qint64 now = getNow();
+		if (now > end_of_timeout)
+		{
+			end_of_timeout = now + 1000000;
+			qDebug() << "TelescopeTCP(" << name << ")::prepareCommunication: Connection attempt timed out";
+			hangup();
+		}
+	}
+	else
+	{
+		const qint64 now = getNow();
+		if (now < end_of_timeout) 
+			return false; //Don't try to reconnect for some time
+		end_of_timeout = now + 5000000;
+		tcpSocket->connectToHost(address, port);
+		wait_for_connection_establishment = true;
+		qDebug() << "TelescopeTCP(" << name << ")::prepareCommunication: Attempting to connect to host" << address.toString() << "at port" << port;
+	}
+	return false;
+}
+
+void TelescopeTCPLink::performCommunication()
+{
+	if (tcpSocket->state() == QAbstractSocket::ConnectedState)
+	{
+		performWriting();
+		
+		if (tcpSocket->bytesAvailable() > 0)
+		{
+			//If performReading() is called when there are no bytes to read,
+			//it closes the connection
+			performReading();
+		}
+	}
+}
+
+void TelescopeTCPLink::socketConnected(void)
+{
+	qDebug() << "TelescopeTCP(" << name <<"): turning off Nagle algorithm.";
+	tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+	connected.store(1);
+}
+
+void TelescopeTCPLink::socketReadyRead(void)
+{
+	//If performReading() is called when there are no bytes to read,
+	//it closes the connection
+	if (tcpSocket->bytesAvailable() > 0)
+		performReading();
+}
+
+//TODO: More informative error messages?
+void TelescopeTCPLink::socketFailed(QAbstractSocket::SocketError)
+{
+	qDebug() << "TelescopeTCP(" << name << "): TCP socket error:\n" << tcpSocket->errorString();
+}
@@ -0,0 +1,103 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * Copyright (C) 2006 Johannes Gajdosik
+ * Copyright (C) 2009 Bogdan Marinov
+ *
+ * This module was originally written by Johannes Gajdosik in 2006
+ * as a core module of Stellarium. In 2009 it was significantly extended with
+ * GUI features and later split as an external plug-in module by Bogdan Marinov.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TELESCOPE_TCP_LINK_HPP_
+#define _TELESCOPE_TCP_LINK_HPP_
+
+#include <QAtomicInt>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <QTcpSocket>
+
+#include "VecMath.hpp"
+
+class InterpolatedPosition;
+class LatencyHistogram;
+
+//! @class TelescopeTCPLink
+//! The connection of a TelescopeTCP to a telescope server, speaking the
+//! "Stellarium telescope control protocol" over TCP/IP.
+//! It lives in the thread of the client: the socket is read as soon as data arrives,
+//! and prepareCommunication() and performCommunication() must be called regularly
+//! for the connection attempts and timeouts. The received positions are stored in
+//! the equinox of the server.
+//! isConnected() and sendGoto() can be called from any thread.
+class TelescopeTCPLink : public QObject
+{
+	Q_OBJECT
+public:
+	//! @param name the name of the telescope, for the logs.
+	//! @param positions where the received positions are added.
+	//! @param positionLatency where the latencies of the received positions are recorded.
+	//! @param gotoLatency where the latencies of the goto commands are recorded.
+	TelescopeTCPLink(const QString& name, InterpolatedPosition& positions,
+			 LatencyHistogram& positionLatency, LatencyHistogram& gotoLatency, QObject* parent=Q_NULLPTR);
+
+	//! Set the address of the server. Must be called before the first prepareCommunication().
+	void setServer(const QHostAddress& address, quint16 port);
+	bool isConnected(void) const {return connected.load();}
+
+	//! Check if the socket is connected, try to connect if it is not.
+	//! @return true if the socket is connected
+	bool prepareCommunication();
+	//! Send what remains of the commands and read what the server sent.
+	void performCommunication();
+	//! Close the connection and forget the positions.
+	void hangup(void);
+
+	//! Let the thread of the link send a GOTO command to the position, given in the equinox of the server.
+	void sendGoto(const Vec3d& position);
+
+private:
+	void performReading(void);
+	void performWriting(void);
+
+	const QString name;
+	InterpolatedPosition& interpolatedPosition;
+	LatencyHistogram& positionLatency;
+	LatencyHistogram& gotoLatency;
+	QHostAddress address;
+	quint16 port;
+	QTcpSocket * tcpSocket;
+	//! Whether tcpSocket is connected, for the other threads
+	QAtomicInt connected;
+	bool wait_for_connection_establishment;
+	qint64 end_of_timeout;
+	char readBuffer[120];
+	char *readBufferEnd;
+	char writeBuffer[120];
+	char *writeBufferEnd;
+
+private slots:
+	void socketConnected(void);
+	void socketFailed(QAbstractSocket::SocketError socketError);
+	void socketReadyRead(void);
+	//! Queue a GOTO command, called in the thread of the link by sendGoto().
+	//! @param requestTime the time of the sendGoto() call in microseconds, see getNow().
+	void queueGoto(unsigned int ra_int, int dec_int, qint64 requestTime);
+};
+
+#endif // _TELESCOPE_TCP_LINK_HPP_
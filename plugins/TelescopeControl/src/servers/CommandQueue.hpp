@@ -0,0 +1,84 @@
+/*
+The stellarium telescope library helps building
+telescope server programs, that can communicate with stellarium
+by means of the stellarium TCP telescope protocol.
+It also contains smaple server classes (dummy, Meade LX200).
+
+Copyright of this file: Stellarium Developers, 2017
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+*/
+
+#ifndef _COMMAND_QUEUE_HPP_
+#define _COMMAND_QUEUE_HPP_
+
+#include <vector>
+using namespace std;
+
+//! First-in first-out queue of the commands waiting to be sent to a telescope.
+//! The queue owns the commands: pop_front() and clear() delete them.
+//! The command pointers are stored in a ring buffer which only grows when it
+//! is full, so that once the queue has reached its working size, queueing and
+//! dequeueing commands doesn't allocate anything besides the commands themselves.
+template<class T>
+class CommandQueue
+{
+public:
+	CommandQueue(void) : ring(8), head(0), count(0) {}
+	~CommandQueue(void) { clear(); }
+	bool empty(void) const {return count == 0;}
+	size_t size(void) const {return count;}
+	T *front(void) const {return ring[head];}
+	void push_back(T *command)
+	{
+		if (count == ring.size())
+			grow();
+		ring[(head + count) & (ring.size() - 1)] = command;
+		count++;
+	}
+	//! Removes and deletes the first command.
+	void pop_front(void)
+	{
+		delete ring[head];
+		head = (head + 1) & (ring.size() - 1);
+		count--;
+	}
+	void clear(void)
+	{
+		while (!empty())
+			pop_front();
+	}
+	
+private:
+	//! Doubles the capacity, keeping it a power of 2.
+	void grow(void)
+	{
+		vector<T*> bigger(2 * ring.size());
+		for (size_t i = 0; i < count; i++)
+			bigger[i] = ring[(head + i) & (ring.size() - 1)];
+		ring.swap(bigger);
+		head = 0;
+	}
+	
+	vector<T*> ring;
+	size_t head;
+	size_t count;
+	
+	// no copying
+	CommandQueue(const CommandQueue&);
+	const CommandQueue &operator=(const CommandQueue&);
+};
+
+#endif //_COMMAND_QUEUE_HPP_
@@ -96,30 +96,24 @@ Connection::Connection(Server &server, SOCKET fd) : Socket(server, fd)
 	server_minus_client_time = 0x7FFFFFFFFFFFFFFFLL;
 }
 
-void Connection::prepareSelectFds(fd_set &read_fds,
-                                  fd_set &write_fds,
-                                  int &fd_max)
+int Connection::prepareEvents(void)
 {
-	if (!IS_INVALID_SOCKET(fd))
-	{
-		if (fd_max < (int)fd)
-			fd_max = (int)fd;
-		if (write_buff_end > write_buff)
-			FD_SET(fd, &write_fds);
-		FD_SET(fd, &read_fds);
-	}
+	if (IS_INVALID_SOCKET(fd))
+		return 0;
+	if (write_buff_end > write_buff)
+		return ReadEvent | WriteEvent;
+	return ReadEvent;
 }
 
-void Connection::handleSelectFds(const fd_set &read_fds,
-                                 const fd_set &write_fds)
+void Connection::handleEvents(int events)
 {
 	if (!IS_INVALID_SOCKET(fd))
 	{
-		if (FD_ISSET(fd, const_cast<fd_set *>(&write_fds)))
+		if (events & WriteEvent)
 		{
 			performWriting();
 		}
-		if (!IS_INVALID_SOCKET(fd) && FD_ISSET(fd, const_cast<fd_set *>(&read_fds)))
+		if (!IS_INVALID_SOCKET(fd) && (events & ReadEvent))
 		{
 			performReading();
 		}
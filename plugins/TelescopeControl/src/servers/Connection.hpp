@@ -42,14 +42,15 @@ protected:
 	void performReading(void);
 	//! Sends the contents of the write buffer over a TCP/IP connection.
 	void performWriting(void);
-	void prepareSelectFds(fd_set &read_fds, fd_set &write_fds, int &fd_max);
+	//! Waits for reading, and for writing if the write buffer is not empty.
+	int prepareEvents(void);
 	
 private:
 	//! Returns true, as by default Connection implements a TCP/IP connection.
 	virtual bool isTcpConnection(void) const {return true;}
 	//! Returns false, as by default Connection implements a TCP/IP connection.
 	virtual bool isAsciiConnection(void) const {return false;}
-	void handleSelectFds(const fd_set &read_fds, const fd_set &write_fds);
+	void handleEvents(int events);
 	//! Parses the read buffer and handles any messages contained within it.
 	//! If the data contains a Stellarium telescope control command,
 	//! dataReceived() calls the appropriate method of Server.
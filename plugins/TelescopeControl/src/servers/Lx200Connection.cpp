@@ -45,11 +45,7 @@ Lx200Connection::Lx200Connection(Server &server, const char *serial_device) : Se
 //! cleans both the read and the write buffers.
 void Lx200Connection::resetCommunication(void)
 {
-	while (!command_list.empty())
-	{
-		delete command_list.front();
-		command_list.pop_front();
-	}
+	command_list.clear();
 	
 	read_buff_end = read_buff;
 	write_buff_end = write_buff;
@@ -219,7 +215,6 @@ void Lx200Connection::dataReceived(const char *&p, const char *read_buff_end)
 			{
 				goto_commands_queued--;
 			}
-			delete command_list.front();
 			command_list.pop_front();
 			read_timeout_endtime = 0x7FFFFFFFFFFFFFFFLL;
 			if (!writeFrontCommandToBuffer())
@@ -228,9 +223,7 @@ void Lx200Connection::dataReceived(const char *&p, const char *read_buff_end)
 	}
 }
 
-void Lx200Connection::prepareSelectFds(fd_set &read_fds,
-                                       fd_set &write_fds,
-                                       int &fd_max)
+int Lx200Connection::prepareEvents(void)
 {
 	// if some telegram is delayed try to queue it now:
 	flushCommandList();
@@ -241,7 +234,7 @@ void Lx200Connection::prepareSelectFds(fd_set &read_fds,
 			// the lazy telescope, propably AutoStar 494
 			// has not sent the full answer
 			#ifdef DEBUG4
-			*log_file << Now() << "Lx200Connection::prepareSelectFds: "
+			*log_file << Now() << "Lx200Connection::prepareEvents: "
 			                      "dequeueing command("
 			                   << *command_list.front()
 			                   << ") because of timeout"
@@ -251,7 +244,6 @@ void Lx200Connection::prepareSelectFds(fd_set &read_fds,
 			{
 				goto_commands_queued--;
 			}
-			delete command_list.front();
 			command_list.pop_front();
 			read_timeout_endtime = 0x7FFFFFFFFFFFFFFFLL;
 		}
@@ -260,7 +252,7 @@ void Lx200Connection::prepareSelectFds(fd_set &read_fds,
 			resetCommunication();
 		}
 	}
-	SerialPort::prepareSelectFds(read_fds, write_fds, fd_max);
+	return SerialPort::prepareEvents();
 }
 
 void Lx200Connection::flushCommandList(void)
@@ -278,7 +270,6 @@ void Lx200Connection::flushCommandList(void)
 				//          << endl;
 				if (command_list.front()->needsNoAnswer())
 				{
-					delete command_list.front();
 					command_list.pop_front();
 					read_timeout_endtime = 0x7FFFFFFFFFFFFFFFLL;
 					if (command_list.empty())
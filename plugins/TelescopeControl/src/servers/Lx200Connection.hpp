@@ -26,9 +26,7 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #define _LX200_CONNECTION_HPP_
 
 #include "SerialPort.hpp"
-
-#include <list>
-using namespace std;
+#include "CommandQueue.hpp"
 
 class Lx200Command;
 
@@ -50,7 +48,8 @@ private:
 	//! Not implemented, as this is not a connection to a client.
 	void sendPosition(unsigned int ra_int, int dec_int, int status) {Q_UNUSED(ra_int); Q_UNUSED(dec_int); Q_UNUSED(status);}
 	void resetCommunication(void);
-	void prepareSelectFds(fd_set &read_fds, fd_set &write_fds, int &fd_max);
+	//! Queues delayed commands and handles read timeouts before waiting.
+	int prepareEvents(void);
 	bool writeFrontCommandToBuffer(void);
 	//! Flushes the command queue, sending commands to the write buffer.
 	//! This method iterates over the queue, writing to the write buffer
@@ -59,7 +58,7 @@ private:
 	void flushCommandList(void);
 	
 private:
-	list<Lx200Command*> command_list;
+	CommandQueue<Lx200Command> command_list;
 	long long int time_between_commands;
 	long long int next_send_time;
 	long long int read_timeout_endtime;
@@ -34,13 +34,14 @@ NexStarConnection::NexStarConnection(Server &server, const char *serial_device)
 {
 }
 
+NexStarConnection::~NexStarConnection(void)
+{
+	resetCommunication();
+}
+
 void NexStarConnection::resetCommunication(void)
 {
-	while (!command_list.empty())
-	{
-		delete command_list.front();
-		command_list.pop_front();
-	}
+	command_list.clear();
 	
 	read_buff_end = read_buff;
 	write_buff_end = write_buff;
@@ -92,7 +93,6 @@ void NexStarConnection::dataReceived(const char *&p,const char *read_buff_end)
 				}
 				break;
 			}
-			delete command_list.front();
 			command_list.pop_front();
 			if (command_list.empty())
 				break;
@@ -124,7 +124,6 @@ void NexStarConnection::sendCommand(NexStarCommand *command)
 				//                   << "::writeCommandToBuffer ok" << endl;
 				if (command_list.front()->needsNoAnswer())
 				{
-					delete command_list.front();
 					command_list.pop_front();
 					if (command_list.empty())
 						break;
@@ -26,9 +26,7 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #define _NEXSTAR_CONNECTION_HPP_
 
 #include "SerialPort.hpp"
-
-#include <list>
-using namespace std;
+#include "CommandQueue.hpp"
 
 class NexStarCommand;
 
@@ -37,7 +35,7 @@ class NexStarConnection : public SerialPort
 {
 public:
 	NexStarConnection(Server &server, const char *serial_device);
-	~NexStarConnection(void) { resetCommunication(); }
+	~NexStarConnection(void);
 	void sendGoto(unsigned int ra_int, int dec_int);
 	void sendCommand(NexStarCommand * command);
 	
@@ -47,7 +45,7 @@ private:
 	void resetCommunication(void);
 	
 private:
-	list<NexStarCommand*> command_list;
+	CommandQueue<NexStarCommand> command_list;
 };
 
 #endif //_NEXSTAR_CONNECTION_HPP_
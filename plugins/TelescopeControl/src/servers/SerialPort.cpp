@@ -190,16 +190,15 @@ int SerialPort::writeNonblocking(const char *buf, int count)
 
 #endif
 
-void SerialPort::prepareSelectFds(fd_set &read_fds,
-                                  fd_set &write_fds,
-                                  int &fd_max)
+int SerialPort::prepareEvents(void)
 {
 #ifdef Q_OS_WIN
 	// handle all IO here
 	if (write_buff_end > write_buff)
 		performWriting();
 	performReading();
+	return 0;
 #else
-	Connection::prepareSelectFds(read_fds, write_fds, fd_max);
+	return Connection::prepareEvents();
 #endif //Q_OS_WIN
 }
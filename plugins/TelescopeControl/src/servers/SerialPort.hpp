@@ -55,7 +55,7 @@ public:
 	}
 	
 protected:
-	void prepareSelectFds(fd_set&, fd_set&, int&);
+	int prepareEvents(void);
 	
 private:
 	//! Returns false, as SerialPort implements a serial port connection.
@@ -67,7 +67,7 @@ private:
 #ifdef Q_OS_WIN
 	int readNonblocking(char *buf, int count);
 	int writeNonblocking(const char *buf, int count);
-	void handleSelectFds(const fd_set&, const fd_set&) {}
+	void handleEvents(int) {}
 	HANDLE handle;
 	DCB dcb_original;
 #else
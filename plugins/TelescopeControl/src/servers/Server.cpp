@@ -27,6 +27,12 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 //#include "Listener.hpp"
 #include "LogFile.hpp"
 
+#ifdef Q_OS_LINUX
+#include <sys/epoll.h>
+#endif
+
+#include <QTextStream>
+
 void Server::SocketList::clear(void)
 {
 	for (const_iterator it(begin()); it != end(); it++)
@@ -36,12 +42,37 @@ void Server::SocketList::clear(void)
 	list<Socket*>::clear();
 }
 
+Server::Server(void)
+{
+	initEventSet();
+}
+
 Server::Server(int)
 {
+	initEventSet();
 	//Socket *listener = new Listener(*this, port);
 	//socket_list.push_back(listener);
 }
 
+Server::~Server(void)
+{
+	if (epoll_fd >= 0)
+		::close(epoll_fd);
+}
+
+void Server::initEventSet(void)
+{
+	epoll_fd = -1;
+#ifdef Q_OS_LINUX
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0)
+	{
+		*log_file << Now() << "Server::initEventSet: epoll_create1 failed: "
+		                   << STRERROR(ERRNO) << ", using select" << endl;
+	}
+#endif
+}
+
 void Server::sendPosition(unsigned int ra_int, int dec_int, int status)
 {
 	for (SocketList::const_iterator it(socket_list.begin());
@@ -54,30 +85,24 @@ void Server::sendPosition(unsigned int ra_int, int dec_int, int status)
 
 void Server::step(long long int timeout_micros)
 {
-	fd_set read_fds, write_fds;
-	FD_ZERO(&read_fds);
-	FD_ZERO(&write_fds);
-	int fd_max = -1;
-	
 	for (SocketList::const_iterator it(socket_list.begin());
 	     it != socket_list.end();
 	     it++)
 	{
-		(*it)->prepareSelectFds(read_fds, write_fds, fd_max);
+		(*it)->wanted_events = (*it)->prepareEvents();
+		if (epoll_fd >= 0)
+			updateEventSet(*it);
 	}
 	
-	struct timeval tv;
 	if (timeout_micros < 0)
 		timeout_micros = 0;
-	tv.tv_sec = timeout_micros / 1000000;
-	tv.tv_usec = timeout_micros % 1000000;
-	const int select_rc = select(fd_max+1, &read_fds, &write_fds, 0, &tv);
-	if (select_rc > 0)
+	const int rc = (epoll_fd >= 0) ? waitEpoll(timeout_micros)
+	                               : waitSelect(timeout_micros);
+	if (rc > 0)
 	{
 		SocketList::iterator it(socket_list.begin());
 		while (it != socket_list.end())
 		{
-			(*it)->handleSelectFds(read_fds, write_fds);
 			if ((*it)->isClosed())
 			{
 				SocketList::iterator tmp(it);
@@ -93,6 +118,137 @@ void Server::step(long long int timeout_micros)
 	}
 }
 
+#ifdef Q_OS_LINUX
+
+void Server::updateEventSet(Socket *s)
+{
+	const SOCKET fd = s->fd;
+	if (fd != s->registered_fd)
+	{
+		// Closing a file descriptor removes it from the epoll set,
+		// so a changed descriptor only has to be added.
+		s->registered_fd = INVALID_SOCKET;
+		if (IS_INVALID_SOCKET(fd))
+			return;
+	}
+	else if (IS_INVALID_SOCKET(fd) || s->wanted_events == s->registered_events)
+	{
+		return;
+	}
+	
+	struct epoll_event ev;
+	ev.events = 0;
+	if (s->wanted_events & Socket::ReadEvent)
+		ev.events |= EPOLLIN;
+	if (s->wanted_events & Socket::WriteEvent)
+		ev.events |= EPOLLOUT;
+	ev.data.ptr = s;
+	int rc;
+	if (s->registered_fd == fd)
+	{
+		rc = epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+	}
+	else
+	{
+		rc = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+		if (rc < 0 && ERRNO == EEXIST)
+			rc = epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+	}
+	if (rc < 0)
+	{
+		*log_file << Now() << "Server::updateEventSet: epoll_ctl failed: "
+		                   << STRERROR(ERRNO) << endl;
+		return;
+	}
+	s->registered_fd = fd;
+	s->registered_events = s->wanted_events;
+}
+
+int Server::waitEpoll(long long int timeout_micros)
+{
+	struct epoll_event events[64];
+	// epoll_wait has a resolution of milliseconds, round up:
+	const int timeout_millis = (int)((timeout_micros + 999) / 1000);
+	const int rc = epoll_wait(epoll_fd, events, 64, timeout_millis);
+	if (rc < 0 && ERRNO != EINTR)
+	{
+		*log_file << Now() << "Server::waitEpoll: epoll_wait failed: "
+		                   << STRERROR(ERRNO) << endl;
+	}
+	for (int i = 0; i < rc; i++)
+	{
+		Socket *s = static_cast<Socket*>(events[i].data.ptr);
+		int handled = 0;
+		if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+			handled |= Socket::ReadEvent;
+		if (events[i].events & (EPOLLOUT | EPOLLERR))
+			handled |= Socket::WriteEvent;
+		// errors are reported by reading or writing
+		s->handleEvents(handled & (s->wanted_events | Socket::ReadEvent));
+	}
+	return rc;
+}
+
+#else
+
+void Server::updateEventSet(Socket *)
+{
+}
+
+int Server::waitEpoll(long long int)
+{
+	return -1;
+}
+
+#endif //Q_OS_LINUX
+
+int Server::waitSelect(long long int timeout_micros)
+{
+	fd_set read_fds, write_fds;
+	FD_ZERO(&read_fds);
+	FD_ZERO(&write_fds);
+	int fd_max = -1;
+	
+	for (SocketList::const_iterator it(socket_list.begin());
+	     it != socket_list.end();
+	     it++)
+	{
+		const SOCKET fd = (*it)->fd;
+		if (IS_INVALID_SOCKET(fd))
+			continue;
+		if ((*it)->wanted_events & Socket::ReadEvent)
+			FD_SET(fd, &read_fds);
+		if ((*it)->wanted_events & Socket::WriteEvent)
+			FD_SET(fd, &write_fds);
+		if (fd_max < (int)fd)
+			fd_max = (int)fd;
+	}
+	
+	struct timeval tv;
+	tv.tv_sec = timeout_micros / 1000000;
+	tv.tv_usec = timeout_micros % 1000000;
+	const int rc = select(fd_max+1, &read_fds, &write_fds, 0, &tv);
+	if (rc > 0)
+	{
+		for (SocketList::const_iterator it(socket_list.begin());
+		     it != socket_list.end();
+		     it++)
+		{
+			const SOCKET fd = (*it)->fd;
+			if (IS_INVALID_SOCKET(fd))
+				continue;
+			int events = 0;
+			if (FD_ISSET(fd, &read_fds))
+				events |= Socket::ReadEvent;
+			if (FD_ISSET(fd, &write_fds))
+				events |= Socket::WriteEvent;
+			if (events)
+				(*it)->handleEvents(events);
+		}
+	}
+	return rc;
+}
+
 void Server::closeAcceptedConnections(void)
 {
 	for (SocketList::iterator it(socket_list.begin());
@@ -105,5 +261,3 @@ void Server::closeAcceptedConnections(void)
 		}
 	}
 }
-
-
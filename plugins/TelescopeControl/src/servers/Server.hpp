@@ -40,14 +40,19 @@ class Socket;
 //! Classes that inherit Server (such as ServerLx200) also have a special
 //! device-specific connection object (such as Lx200Connection) that represents
 //! a serial connection to the device. The step() method calls
-//! Socket::prepareSelectFds() and Socket::handleSelectFds() for each connection
-//! in the list. These methods are reimplemented for each class.
+//! Socket::prepareEvents() for each connection in the list, waits for the events,
+//! and calls Socket::handleEvents() for the connections on which they occurred.
+//! These methods are reimplemented for each class.
+//! On Linux the file descriptors are kept in an epoll set, which is only updated
+//! when the events a connection waits for change, so that the cost of waiting
+//! doesn't grow with the number of idle connections. Elsewhere, or if the epoll
+//! set can't be created, select() is used.
 class Server
 {
 public:
-	Server(void) {}
+	Server(void);
 	Server(int port);
-	virtual ~Server(void) {}
+	virtual ~Server(void);
 	virtual void step(long long int timeout_micros);
 	
 protected:
@@ -78,6 +83,16 @@ private:
 	};
 	//! A list of the connections maintained by the server.
 	SocketList socket_list;
+	
+	void initEventSet(void);
+	//! Adds, modifies or removes the registration of s in the epoll set.
+	void updateEventSet(Socket *s);
+	//! Waits for the events of the sockets and handles them.
+	//! Returns the number of sockets with events, or -1 on error.
+	int waitEpoll(long long int timeout_micros);
+	int waitSelect(long long int timeout_micros);
+	//! The epoll file descriptor, -1 if select() is used.
+	int epoll_fd;
 };
 
 #endif
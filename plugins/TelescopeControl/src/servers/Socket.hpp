@@ -84,10 +84,22 @@ class Server;
 class Socket
 {
 public:
+	//! The events a socket can wait for in Server::step().
+	enum Events
+	{
+		ReadEvent  = 1,
+		WriteEvent = 2
+	};
+	
 	virtual ~Socket() { hangup(); }
 	void hangup();
-	virtual void prepareSelectFds(fd_set &read_fds, fd_set &write_fds, int &fd_max) = 0;
-	virtual void handleSelectFds(const fd_set &read_fds, const fd_set &write_fds) = 0;
+	//! Called by Server::step() before waiting for the sockets.
+	//! Performs the periodic work of the connection, like queueing delayed
+	//! commands or checking timeouts, and returns the combination of Events
+	//! to wait for on the file descriptor, or 0 if there is nothing to wait for.
+	virtual int prepareEvents(void) = 0;
+	//! Called by Server::step() with the Events which occurred.
+	virtual void handleEvents(int events) = 0;
 	virtual bool isClosed() const
 	{
 		return IS_INVALID_SOCKET(fd);
@@ -96,7 +108,9 @@ public:
 	virtual void sendPosition(unsigned int ra_int, int dec_int, int status) {Q_UNUSED(ra_int); Q_UNUSED(dec_int); Q_UNUSED(status);}
 	
 protected:
-	Socket(Server &server, SOCKET fd) : server(server), fd(fd) {}
+	Socket(Server &server, SOCKET fd)
+		: server(server), fd(fd), registered_fd(INVALID_SOCKET), registered_events(0),
+		  wanted_events(0) {}
 	Server & server;
 	
 #ifdef Q_OS_WIN
@@ -122,6 +136,13 @@ protected:
 	SOCKET fd;
 	
 private:
+	//! The file descriptor and the events registered in the epoll set of the server
+	SOCKET registered_fd;
+	int registered_events;
+	//! The result of the last prepareEvents() call
+	int wanted_events;
+	friend class Server;
+	
 	// no copying
 	Socket(const Socket&);
 	const Socket &operator=(const Socket&);
@@ -29,6 +29,7 @@
 #include <QGuiApplication>
 #include <QStandardPaths>
 #include <QDir>
+#include <QSize>
 
 #include <stdio.h>
 
@@ -93,7 +94,16 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 		          << "--projection-type       : Specify projection type, e.g. stereographic\n"
 		          << "--restore-defaults      : Delete existing config.ini and use defaults\n"
 		          << "--multires-image        : With filename / URL argument, specify a\n"
-		          << "                          multi-resolution image to load\n";
+		          << "                          multi-resolution image to load\n"
+		          << "--benchmark <scenario>  : Render a scripted scene with a fixed time step, write\n"
+		          << "                          the frame timings to a JSON file and exit. Scenarios:\n"
+		          << "                          widefield, deepzoom, twilight, satellites\n"
+		          << "--benchmark-frames <n>  : Number of measured frames (default 600)\n"
+		          << "--benchmark-output <file> : JSON file for the results\n"
+		          << "                          (default benchmark-<scenario>.json in the user dir)\n"
+		          << "--benchmark-size <WxH>  : Size of the benchmark viewport (default 1280x720)\n"
+		          << "--benchmark-offscreen   : Render the benchmark frames into an offscreen\n"
+		          << "                          framebuffer instead of the window\n";
 		exit(0);
 	}
 
@@ -173,6 +183,8 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 	float fov;
 	QString landscapeId, homePlanet, longitude, latitude, skyDate, skyTime;
 	QString projectionType, screenshotDir, multiresImage, startupScript;
+	QString benchmark, benchmarkOutput, benchmarkSize;
+	int benchmarkFrames;
 #ifdef ENABLE_SPOUT
 	QString spoutStr, spoutName;
 #endif
@@ -193,6 +205,10 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 		screenshotDir = argsGetOptionWithArg(argList, "", "--screenshot-dir", "").toString();
 		multiresImage = argsGetOptionWithArg(argList, "", "--multires-image", "").toString();
 		startupScript = argsGetOptionWithArg(argList, "", "--startup-script", "").toString();
+		benchmark = argsGetOptionWithArg(argList, "", "--benchmark", "").toString();
+		benchmarkFrames = argsGetOptionWithArg(argList, "", "--benchmark-frames", 600).toInt();
+		benchmarkOutput = argsGetOptionWithArg(argList, "", "--benchmark-output", "").toString();
+		benchmarkSize = argsGetOptionWithArg(argList, "", "--benchmark-size", "1280x720").toString();
 #ifdef ENABLE_SPOUT
 		// For now, we default to spout=sky when no extra option is given. Later, we should also accept "all".
 		// Unfortunately, this still throws an exception when no optarg string is given.
@@ -266,6 +282,22 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 		qApp->setProperty("onetime_startup_script", startupScript);
 	}
 
+	// The benchmark does not change the configuration, it is set up by StelMainView
+	if (!benchmark.isEmpty())
+	{
+		const QStringList size = benchmarkSize.toLower().split('x');
+		if (size.size()!=2 || size.at(0).toInt()<=0 || size.at(1).toInt()<=0)
+		{
+			qCritical() << "ERROR: invalid benchmark size" << benchmarkSize << "- expected e.g. 1280x720";
+			exit(0);
+		}
+		qApp->setProperty("benchmark", benchmark);
+		qApp->setProperty("benchmark_frames", qMax(benchmarkFrames, 1));
+		qApp->setProperty("benchmark_output", benchmarkOutput);
+		qApp->setProperty("benchmark_size", QSize(size.at(0).toInt(), size.at(1).toInt()));
+		qApp->setProperty("benchmark_offscreen", argsGetOption(argList, "", "--benchmark-offscreen"));
+	}
+
 	if (fov>0.0) confSettings->setValue("navigation/init_fov", fov);
 	if (!projectionType.isEmpty()) confSettings->setValue("projection/type", projectionType);
 	if (!screenshotDir.isEmpty())
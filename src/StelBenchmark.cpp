@@ -0,0 +1,312 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelBenchmark.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFileMgr.hpp"
+#include "StelLocation.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelOpenGL.hpp"
+#include "StelProfiler.hpp"
+#include "StelPropertyMgr.hpp"
+#include "StelUtils.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+
+// Frames rendered before the measurement starts, to load textures and fill caches
+static const int WARMUP_FRAMES = 60;
+
+StelBenchmark::StelBenchmark(const QString& scenario, int frames, const QString& outputFile, QObject* parent)
+	: QObject(parent)
+	, scenarios(createScenarios())
+	, scenarioIndex(-1)
+	, measuredFrames(qMax(frames, 1))
+	, warmupFrames(WARMUP_FRAMES)
+	, frame(0)
+	, outputFile(outputFile)
+	, frameStart(0)
+	, previousFrameEnd(0)
+{
+	setObjectName("StelBenchmark");
+	for (int i=0; i<scenarios.size(); ++i)
+	{
+		if (scenario==scenarios.at(i).name)
+			scenarioIndex = i;
+	}
+	if (scenarioIndex>=0 && this->outputFile.isEmpty())
+		this->outputFile = StelFileMgr::getUserDir() + "/benchmark-" + scenario + ".json";
+	cpuTimes.reserve(measuredFrames);
+}
+
+StelBenchmark::~StelBenchmark()
+{
+}
+
+QStringList StelBenchmark::getScenarioNames()
+{
+	QStringList names;
+	foreach (const Scenario& s, createScenarios())
+		names << s.name;
+	return names;
+}
+
+QVector<StelBenchmark::Scenario> StelBenchmark::createScenarios()
+{
+	QVector<Scenario> res;
+
+	// 2017-09-20 22:00 UT, a moonless night
+	Scenario wide = {"widefield", "Full sky panorama with all catalogs, labels and constellations", 2458017.416667, QVariantMap(), QVector<Key>()};
+	wide.properties.insert("LandscapeMgr.atmosphereDisplayed", false);
+	wide.properties.insert("LandscapeMgr.landscapeDisplayed", false);
+	wide.properties.insert("StarMgr.flagStarsDisplayed", true);
+	wide.properties.insert("StarMgr.flagLabelsDisplayed", true);
+	wide.properties.insert("NebulaMgr.flagHintDisplayed", true);
+	wide.properties.insert("MilkyWay.flagMilkyWayDisplayed", true);
+	wide.properties.insert("ConstellationMgr.linesDisplayed", true);
+	wide.properties.insert("ConstellationMgr.namesDisplayed", true);
+	wide.properties.insert("ConstellationMgr.boundariesDisplayed", true);
+	wide.properties.insert("SolarSystem.planetsDisplayed", true);
+	wide.properties.insert("SolarSystem.labelsDisplayed", true);
+	Key w0 = {0.0, 0., 45., 120., 0.};
+	Key w1 = {0.5, 180., 30., 180., 1./48.};
+	Key w2 = {1.0, 360., 45., 120., 1./24.};
+	wide.path << w0 << w1 << w2;
+	res << wide;
+
+	// Zoom from 60 degrees down to 3 arc minutes in Cassiopeia/Andromeda and back out
+	Scenario deep = {"deepzoom", "Zoom into the faintest star catalogs and nebula textures", 2458017.416667, QVariantMap(), QVector<Key>()};
+	deep.properties.insert("LandscapeMgr.atmosphereDisplayed", false);
+	deep.properties.insert("LandscapeMgr.landscapeDisplayed", false);
+	deep.properties.insert("StarMgr.flagStarsDisplayed", true);
+	deep.properties.insert("NebulaMgr.flagHintDisplayed", true);
+	deep.properties.insert("MilkyWay.flagMilkyWayDisplayed", true);
+	Key d0 = {0.0, 60., 55., 60., 0.};
+	Key d1 = {0.6, 62., 56., 0.05, 0.};
+	Key d2 = {0.8, 62.2, 56.1, 0.05, 0.};
+	Key d3 = {1.0, 60., 55., 20., 0.};
+	deep.path << d0 << d1 << d2 << d3;
+	res << deep;
+
+	// From shortly before sunset into the night, looking west
+	Scenario twilight = {"twilight", "Atmosphere and landscape through two hours of twilight", 2458017.2, QVariantMap(), QVector<Key>()};
+	twilight.properties.insert("LandscapeMgr.atmosphereDisplayed", true);
+	twilight.properties.insert("LandscapeMgr.flagAtmosphereAutoEnabling", false);
+	twilight.properties.insert("LandscapeMgr.landscapeDisplayed", true);
+	twilight.properties.insert("LandscapeMgr.fogDisplayed", true);
+	twilight.properties.insert("StarMgr.flagStarsDisplayed", true);
+	twilight.properties.insert("MilkyWay.flagMilkyWayDisplayed", true);
+	twilight.properties.insert("SolarSystem.planetsDisplayed", true);
+	Key t0 = {0.0, 260., 5., 100., 0.};
+	Key t1 = {1.0, 200., 20., 100., 1./12.};
+	twilight.path << t0 << t1;
+	res << twilight;
+
+	// Early in the night, when many satellites are still sunlit
+	Scenario satellites = {"satellites", "All satellites with hints and labels over half an hour", 2458017.35, QVariantMap(), QVector<Key>()};
+	satellites.properties.insert("LandscapeMgr.atmosphereDisplayed", false);
+	satellites.properties.insert("LandscapeMgr.landscapeDisplayed", false);
+	satellites.properties.insert("StarMgr.flagStarsDisplayed", true);
+	satellites.properties.insert("Satellites.hintsVisible", true);
+	satellites.properties.insert("Satellites.labelsVisible", true);
+	Key s0 = {0.0, 0., 70., 160., 0.};
+	Key s1 = {1.0, 90., 70., 160., 1./48.};
+	satellites.path << s0 << s1;
+	res << satellites;
+
+	return res;
+}
+
+void StelBenchmark::setupScene()
+{
+	const Scenario& s = scenarios.at(scenarioIndex);
+	StelCore* core = StelApp::getInstance().getCore();
+
+	StelLocation loc;
+	loc.name = "Benchmark";
+	loc.country = "France";
+	loc.planetName = "Earth";
+	loc.longitude = 2.3488f;
+	loc.latitude = 48.8534f;
+	loc.altitude = 35;
+	loc.ianaTimeZone = "UTC";
+	core->moveObserverTo(loc, 0., 0.);
+	core->setTimeRate(0.);
+	core->setJD(s.startJD);
+
+	StelMovementMgr* mmgr = GETSTELMODULE(StelMovementMgr);
+	mmgr->setFlagTracking(false);
+	mmgr->setMountMode(StelMovementMgr::MountAltAzimuthal);
+
+	StelPropertyMgr* propMgr = StelApp::getInstance().getStelPropertyManager();
+	for (QVariantMap::const_iterator it=s.properties.constBegin(); it!=s.properties.constEnd(); ++it)
+	{
+		if (!propMgr->setStelPropertyValue(it.key(), it.value()))
+			warnings << QString("property %1 not available").arg(it.key());
+	}
+
+	// Only the frames of the benchmark go into the statistics
+	StelProfiler* profiler = StelApp::getInstance().getProfiler();
+	profiler->setWindowSize(measuredFrames);
+	profiler->setEnabled(true);
+
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	glRenderer = QString(reinterpret_cast<const char*>(gl->glGetString(GL_RENDERER)));
+	glVendor = QString(reinterpret_cast<const char*>(gl->glGetString(GL_VENDOR)));
+
+	qDebug() << "Benchmark" << s.name << "-" << s.description << ":" << warmupFrames << "warm-up and" << measuredFrames << "measured frames";
+	foreach (const QString& w, warnings)
+		qWarning() << "Benchmark:" << qPrintable(w);
+	timer.start();
+}
+
+StelBenchmark::Key StelBenchmark::keyAt(double t) const
+{
+	const QVector<Key>& path = scenarios.at(scenarioIndex).path;
+	if (t<=path.first().t)
+		return path.first();
+	for (int i=1; i<path.size(); ++i)
+	{
+		const Key& a = path.at(i-1);
+		const Key& b = path.at(i);
+		if (t>b.t)
+			continue;
+		const double f = (b.t>a.t ? (t-a.t)/(b.t-a.t) : 1.);
+		Key k;
+		k.t = t;
+		k.azimuth = a.azimuth + f*(b.azimuth-a.azimuth);
+		k.altitude = a.altitude + f*(b.altitude-a.altitude);
+		k.fov = std::exp(std::log(a.fov) + f*(std::log(b.fov)-std::log(a.fov)));
+		k.deltaJD = a.deltaJD + f*(b.deltaJD-a.deltaJD);
+		return k;
+	}
+	return path.last();
+}
+
+void StelBenchmark::prepareFrame()
+{
+	if (!isValid())
+		return;
+	if (frame==0)
+		setupScene();
+
+	const int measured = frame-warmupFrames;
+	const Key k = keyAt(measuredFrames>1 ? qMax(measured, 0)/double(measuredFrames-1) : 0.);
+
+	StelCore* core = StelApp::getInstance().getCore();
+	core->setJD(scenarios.at(scenarioIndex).startJD + k.deltaJD);
+
+	StelMovementMgr* mmgr = GETSTELMODULE(StelMovementMgr);
+	Vec3d v;
+	StelUtils::spheToRect(M_PI - k.azimuth*M_PI/180., k.altitude*M_PI/180., v);
+	mmgr->setViewDirectionJ2000(core->altAzToJ2000(v, StelCore::RefractionOff));
+	// A very short zoom reaches the aim within the next update
+	mmgr->zoomTo(k.fov, 0.001f);
+
+	frameStart = timer.nsecsElapsed();
+}
+
+void StelBenchmark::frameFinished()
+{
+	if (!isValid() || frame>=warmupFrames+measuredFrames)
+		return;
+	const qint64 now = timer.nsecsElapsed();
+	const int measured = frame-warmupFrames;
+	if (measured>=0)
+	{
+		const float cpu = (now-frameStart)*1e-6f;
+		cpuTimes.append(cpu);
+		QJsonObject f;
+		f.insert("frame", measured);
+		f.insert("cpu", cpu);
+		// Includes the buffer swap and the wait for the previous frame
+		f.insert("interval", measured>0 ? (now-previousFrameEnd)*1e-6 : 0.);
+		f.insert("zones", QJsonObject::fromVariantMap(StelApp::getInstance().getProfiler()->getLastFrame()));
+		frameResults.append(f);
+	}
+	else if (measured==-1)
+	{
+		// The statistics must not contain the warm-up frames
+		StelApp::getInstance().getProfiler()->reset();
+	}
+	previousFrameEnd = now;
+	++frame;
+
+	if (frame==warmupFrames+measuredFrames)
+	{
+		writeResults();
+		emit finished();
+	}
+}
+
+void StelBenchmark::writeResults()
+{
+	const Scenario& s = scenarios.at(scenarioIndex);
+	StelCore* core = StelApp::getInstance().getCore();
+	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
+
+	QVector<float> sorted(cpuTimes);
+	std::sort(sorted.begin(), sorted.end());
+	double sum = 0.;
+	foreach (float t, sorted)
+		sum += t;
+	const int n = sorted.size();
+	QJsonObject cpu;
+	cpu.insert("mean", sum/n);
+	cpu.insert("p50", sorted.at(qMax(0, (int)std::ceil(0.50*n)-1)));
+	cpu.insert("p95", sorted.at(qMax(0, (int)std::ceil(0.95*n)-1)));
+	cpu.insert("p99", sorted.at(qMax(0, (int)std::ceil(0.99*n)-1)));
+	cpu.insert("max", sorted.last());
+
+	QJsonObject res;
+	res.insert("scenario", QString(s.name));
+	res.insert("description", QString(s.description));
+	res.insert("version", StelUtils::getApplicationVersion());
+	res.insert("os", StelUtils::getOperatingSystemInfo());
+	res.insert("glRenderer", glRenderer);
+	res.insert("glVendor", glVendor);
+	res.insert("viewportWidth", prj->getViewportWidth());
+	res.insert("viewportHeight", prj->getViewportHeight());
+	res.insert("timeStep", getTimeStep());
+	res.insert("warmupFrames", warmupFrames);
+	res.insert("frames", measuredFrames);
+	res.insert("cpu", cpu);
+	res.insert("zones", QJsonObject::fromVariantMap(StelApp::getInstance().getProfiler()->getStatistics()));
+	res.insert("warnings", QJsonArray::fromStringList(warnings));
+	res.insert("perFrame", frameResults);
+
+	QSaveFile file(outputFile);
+	if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(res).toJson())<0 || !file.commit())
+	{
+		qWarning() << "Cannot write benchmark results to" << QDir::toNativeSeparators(outputFile);
+		return;
+	}
+	qDebug() << "Benchmark" << s.name << "finished: CPU time per frame mean" << sum/n << "ms, p95"
+		 << cpu.value("p95").toDouble() << "ms. Results saved to" << QDir::toNativeSeparators(outputFile);
+}
@@ -0,0 +1,115 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELBENCHMARK_HPP_
+#define _STELBENCHMARK_HPP_
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QObject>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+//! @class StelBenchmark
+//! Drives a reproducible benchmark run, started with the --benchmark command line option.
+//! A scenario sets up a fixed location, date and display options, then moves the view and the time along
+//! a scripted path. Each frame advances by a fixed simulated time step, independently of the wall clock,
+//! so that every run renders the same sequence of images. After some warm-up frames, the CPU time of
+//! each frame and the time of each StelProfiler zone are recorded. At the end the results are written
+//! as JSON and the program quits.
+//!
+//! StelMainView calls prepareFrame() before, and frameFinished() after each StelApp update and draw.
+//! In offscreen mode, StelMainView hides its window and renders the frames into a framebuffer object of
+//! the benchmark size, so that the results do not depend on the window system (buffer swaps, compositing).
+class StelBenchmark : public QObject
+{
+	Q_OBJECT
+
+public:
+	//! @param scenario one of getScenarioNames().
+	//! @param frames number of measured frames.
+	//! @param outputFile file for the results, if empty benchmark-<scenario>.json in the user directory.
+	StelBenchmark(const QString& scenario, int frames, const QString& outputFile, QObject* parent=Q_NULLPTR);
+	~StelBenchmark();
+
+	//! Return the names of the available scenarios.
+	static QStringList getScenarioNames();
+	//! Return false if the scenario does not exist.
+	bool isValid() const {return scenarioIndex>=0;}
+	//! Return true once the last frame has been recorded.
+	bool isFinished() const {return frame>=warmupFrames+measuredFrames;}
+	//! Return the simulated time between two frames in seconds.
+	double getTimeStep() const {return 1./60.;}
+
+	//! Set the view and time of the next frame. The scene is set up on the first call.
+	void prepareFrame();
+	//! Record the timing of the frame. Writes the results and emits finished() after the last frame.
+	void frameFinished();
+
+signals:
+	//! Emitted once the results have been written.
+	void finished();
+
+private:
+	//! A point on the scripted path. Values are interpolated linearly between keys, the FOV logarithmically.
+	struct Key
+	{
+		//! Position on the path, 0 for the first and 1 for the last measured frame
+		double t;
+		//! Azimuth (from north over east) and altitude of the view direction in degrees
+		double azimuth;
+		double altitude;
+		//! Field of view in degrees
+		double fov;
+		//! Offset from the start date in days
+		double deltaJD;
+	};
+	struct Scenario
+	{
+		const char* name;
+		const char* description;
+		double startJD;
+		//! Display options as StelProperty id=value pairs
+		QVariantMap properties;
+		QVector<Key> path;
+	};
+
+	static QVector<Scenario> createScenarios();
+	void setupScene();
+	Key keyAt(double t) const;
+	void writeResults();
+
+	QVector<Scenario> scenarios;
+	int scenarioIndex;
+	int measuredFrames;
+	int warmupFrames;
+	int frame;
+	QString outputFile;
+	QString glRenderer;
+	QString glVendor;
+	QStringList warnings;
+	QElapsedTimer timer;
+	qint64 frameStart;
+	qint64 previousFrameEnd;
+	QVector<float> cpuTimes;
+	QJsonArray frameResults;
+};
+
+#endif // _STELBENCHMARK_HPP_
@@ -30,6 +30,7 @@
 #include "StelActionMgr.hpp"
 #include "StelOpenGL.hpp"
 #include "StelOpenGLArray.hpp"
+#include "StelBenchmark.hpp"
 
 #include <QDebug>
 #include <QDir>
@@ -290,6 +291,31 @@ public:
 
 protected:
 
+	bool event(QEvent* event) Q_DECL_OVERRIDE
+	{
+		// The input may change the GUI (hovered buttons, text fields...) even if it is not handled by StelApp
+		switch (event->type())
+		{
+			case QEvent::GraphicsSceneMouseMove:
+			case QEvent::GraphicsSceneMousePress:
+			case QEvent::GraphicsSceneMouseRelease:
+			case QEvent::GraphicsSceneMouseDoubleClick:
+			case QEvent::GraphicsSceneWheel:
+			case QEvent::KeyPress:
+			case QEvent::KeyRelease:
+			case QEvent::InputMethod:
+			case QEvent::TouchBegin:
+			case QEvent::TouchUpdate:
+			case QEvent::TouchEnd:
+			case QEvent::Leave:
+				parent->thereWasAnInputEvent();
+				break;
+			default:
+				break;
+		}
+		return QGraphicsScene::event(event);
+	}
+
 	void keyPressEvent(QKeyEvent* event) Q_DECL_OVERRIDE
 	{
 		// Try to trigger a global shortcut.
@@ -347,6 +373,14 @@ protected:
 		//qDebug()<<"dt"<<dt;
 		previousPaintTime = now;
 
+		// A benchmark advances by a fixed time step, whatever the real frame time
+		StelBenchmark* benchmark = mainView->getBenchmark();
+		if (benchmark)
+		{
+			dt = benchmark->getTimeStep();
+			benchmark->prepareFrame();
+		}
+
 		//important to call this, or Qt may have invalid state after we have drawn (wrong textures, etc...)
 		painter->beginNativePainting();
 
@@ -368,6 +402,9 @@ protected:
 		app.draw();
 		painter->endNativePainting();
 
+		if (benchmark)
+			benchmark->frameFinished();
+
 		mainView->drawEnded();
 	}
 
@@ -548,12 +585,14 @@ StelMainView::StelMainView(QSettings* settings)
 	  guiItem(Q_NULLPTR),
 	  gui(Q_NULLPTR),
 	  stelApp(Q_NULLPTR),
+	  benchmark(Q_NULLPTR),
+	  benchmarkFbo(Q_NULLPTR),
 	  updateQueued(false),
 	  flagInvertScreenShotColors(false),
 	  flagOverwriteScreenshots(false),
 	  screenShotPrefix("stellarium-"),
 	  screenShotDir(""),
-	  cursorTimeout(-1.f), flagCursorTimeout(false), maxfps(10000.f)
+	  cursorTimeout(-1.f), flagCursorTimeout(false), lastInputEventTimeSec(0.), flagSkipStaticFrames(true), maxfps(10000.f)
 {
 	setAttribute(Qt::WA_OpaquePaintEvent);
 	setAttribute(Qt::WA_AcceptTouchEvents);
@@ -600,7 +639,8 @@ StelMainView::StelMainView(QSettings* settings)
 	// Qt: https://bugreports.qt.io/browse/QTBUG-53273
 	vsdef = false; // use vsync=false by default on macOS
 	#endif
-	if (configuration->value("video/vsync", vsdef).toBool())
+	// A benchmark must not wait for the display
+	if (configuration->value("video/vsync", vsdef).toBool() && !qApp->property("benchmark").isValid())
 		glFormat.setSwapInterval(1);
 	else
 		glFormat.setSwapInterval(0);
@@ -665,6 +705,12 @@ StelMainView::~StelMainView()
 {
 	//delete the night view graphic effect here while GL context is still valid
 	rootItem->setGraphicsEffect(Q_NULLPTR);
+	if (benchmarkFbo)
+	{
+		glContextMakeCurrent();
+		delete benchmarkFbo;
+		benchmarkFbo = Q_NULLPTR;
+	}
 	StelApp::deinitStatic();
 }
 
@@ -800,6 +846,27 @@ void StelMainView::init()
 
 	bool fullscreen = conf->value("video/fullscreen", true).toBool();
 
+	if (qApp->property("benchmark").isValid())
+	{
+		const QString scenario = qApp->property("benchmark").toString();
+		benchmark = new StelBenchmark(scenario, qApp->property("benchmark_frames").toInt(),
+					      qApp->property("benchmark_output").toString(), this);
+		if (benchmark->isValid())
+		{
+			// The window size determines the workload, so it is fixed
+			size = qApp->property("benchmark_size").toSize();
+			fullscreen = false;
+			connect(benchmark, SIGNAL(finished()), this, SLOT(close()), Qt::QueuedConnection);
+		}
+		else
+		{
+			qCritical() << "ERROR: unknown benchmark scenario" << scenario << "- available:" << StelBenchmark::getScenarioNames().join(", ");
+			delete benchmark;
+			benchmark = Q_NULLPTR;
+			QMetaObject::invokeMethod(this, "close", Qt::QueuedConnection);
+		}
+	}
+
 	// Without this, the screen is not shown on a Mac + we should use resize() for correct work of fullscreen/windowed mode switch. --AW WTF???
 	resize(size);
 
@@ -826,6 +893,7 @@ void StelMainView::init()
 	setCursorTimeout(conf->value("gui/mouse_cursor_timeout", 10.f).toFloat());
 	setMaxFps(conf->value("video/maximum_fps",10000.f).toFloat());
 	setMinFps(conf->value("video/minimum_fps",10000.f).toFloat());
+	flagSkipStaticFrames = conf->value("video/flag_skip_static_frames", true).toBool();
 	setFlagUseButtonsBackground(conf->value("gui/flag_show_buttons_background", true).toBool());
 
 	// XXX: This should be done in StelApp::init(), unfortunately for the moment we need to init the gui before the
@@ -840,6 +908,11 @@ void StelMainView::init()
 	if (gui!=Q_NULLPTR)
 		setStyleSheet(gui->getStelStyle().qtStyleSheet);
 	connect(stelApp, SIGNAL(visionNightModeChanged(bool)), this, SLOT(updateNightModeProperty(bool)));
+	connect(stelApp, SIGNAL(redrawRequested()), this, SLOT(resumeDrawing()));
+
+	// The window was needed to create the GL context, it can be hidden once everything is initialized
+	if (benchmark && qApp->property("benchmark_offscreen").toBool())
+		QMetaObject::invokeMethod(this, "startOffscreenBenchmark", Qt::QueuedConnection);
 
 	// I doubt this will have any effect on framerate, but may cause problems elsewhere?
 	QThread::currentThread()->setPriority(QThread::HighestPriority);
@@ -1277,6 +1350,11 @@ void StelMainView::drawEnded()
 		minFpsTimer->stop();
 		glWidget->update();
 	}
+	else if (isStatic())
+	{
+		// Nothing changes: sleep until resumeDrawing() is called
+		minFpsTimer->stop();
+	}
 	else
 	{
 		if(!minFpsTimer->isActive())
@@ -1284,6 +1362,15 @@ void StelMainView::drawEnded()
 	}
 }
 
+void StelMainView::resumeDrawing()
+{
+	if (!updateQueued && !minFpsTimer->isActive() && glWidget)
+	{
+		updateQueued = true;
+		glWidget->update();
+	}
+}
+
 void StelMainView::minFPSUpdate()
 {
 	if(!updateQueued)
@@ -1314,6 +1401,20 @@ void StelMainView::thereWasAnEvent()
 {
 	//qDebug()<<"event";
 	lastEventTimeSec = StelApp::getTotalRunTime();
+	resumeDrawing();
+}
+
+void StelMainView::thereWasAnInputEvent()
+{
+	lastInputEventTimeSec = StelApp::getTotalRunTime();
+	resumeDrawing();
+}
+
+bool StelMainView::isStatic() const
+{
+	// The GUI may still be animated after an input event, e.g. the buttons fading in
+	return flagSkipStaticFrames && !benchmark && StelApp::getTotalRunTime() - lastInputEventTimeSec > 2.5
+		&& stelApp->isSceneStatic();
 }
 
 bool StelMainView::needsMaxFPS() const
@@ -1324,8 +1425,9 @@ bool StelMainView::needsMaxFPS() const
 	// The current policy is that after an event, the FPS is maximum for 2.5 seconds
 	// after that, it switches back to the default minfps value to save power.
 	// The fps is also kept to max if the timerate is higher than normal speed.
+	// A benchmark renders frames back to back.
 	const float timeRate = stelApp->getCore()->getTimeRate();
-	return (now - lastEventTimeSec < 2.5) || fabs(timeRate) > StelCore::JD_SECOND;
+	return (now - lastEventTimeSec < 2.5) || fabs(timeRate) > StelCore::JD_SECOND || benchmark;
 }
 
 void StelMainView::moveEvent(QMoveEvent * event)
@@ -1338,6 +1440,44 @@ void StelMainView::moveEvent(QMoveEvent * event)
 		stelApp->setDevicePixelsPerPixel(win->devicePixelRatio());
 }
 
+void StelMainView::startOffscreenBenchmark()
+{
+	Q_ASSERT(benchmark);
+	glContextMakeCurrent();
+	// The framebuffer has the benchmark size in device pixels, like the window would have
+	const QSize size = qApp->property("benchmark_size").toSize();
+	const float dppp = stelApp->getDevicePixelsPerPixel();
+	benchmarkFbo = new QOpenGLFramebufferObject(size*dppp, QOpenGLFramebufferObject::CombinedDepthStencil);
+	// No paint event is sent to the hidden window, the frames are drawn from the event loop instead
+	hide();
+	stelApp->glWindowHasBeenResized(QRectF(QPointF(0, 0), size));
+	qDebug() << "Benchmark frames are rendered offscreen into a" << benchmarkFbo->size() << "framebuffer";
+	QMetaObject::invokeMethod(this, "drawOffscreenBenchmarkFrame", Qt::QueuedConnection);
+}
+
+void StelMainView::drawOffscreenBenchmarkFrame()
+{
+	if (!benchmark || benchmark->isFinished())
+		return;
+
+	glContextMakeCurrent();
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	benchmarkFbo->bind();
+	gl->glClearColor(0,0,0,0);
+	gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+	benchmark->prepareFrame();
+	stelApp->update(benchmark->getTimeStep());
+	stelApp->draw();
+	// Without a buffer swap nothing waits for the GPU, so wait here to include its work in the frame time
+	gl->glFinish();
+	benchmarkFbo->release();
+	benchmark->frameFinished();
+
+	// Queued, so that the events (network replies, loader threads results) are still processed between the frames
+	QMetaObject::invokeMethod(this, "drawOffscreenBenchmarkFrame", Qt::QueuedConnection);
+}
+
 void StelMainView::closeEvent(QCloseEvent* event)
 {
 	Q_UNUSED(event);
@@ -36,6 +36,8 @@ class QResizeEvent;
 class StelGuiBase;
 class QMoveEvent;
 class QSettings;
+class StelBenchmark;
+class QOpenGLFramebufferObject;
 
 //! @class StelMainView
 //! Reimplement a QGraphicsView for Stellarium.
@@ -151,11 +153,23 @@ public slots:
 	//! FPS should be maximized for a couple of seconds.
 	void thereWasAnEvent();
 
+	//! Notify that the graphics scene received an input event, which may change the GUI even if the
+	//! program did not handle it. Frames are drawn for a couple of seconds, at the normal FPS.
+	void thereWasAnInputEvent();
+
+	//! Get whether no frame is drawn while nothing changes, see StelApp::isSceneStatic().
+	bool getFlagSkipStaticFrames() const {return flagSkipStaticFrames;}
+	//! Set whether no frame is drawn while nothing changes.
+	void setFlagSkipStaticFrames(bool b) {flagSkipStaticFrames=b; resumeDrawing();}
+
 	//! Determines if we should render as fast as possible,
 	//! or limit the FPS. This depends on the time the last user event
 	//! happened.
 	bool needsMaxFPS() const;
 
+	//! Return the benchmark run by the --benchmark command line option, or Q_NULLPTR.
+	StelBenchmark* getBenchmark() const {return benchmark;}
+
 	//! Set the state of the flag of usage background for GUI buttons
 	void setFlagUseButtonsBackground(bool b) { flagUseButtonsBackground=b; }
 	//! Get the state of the flag of usage background for GUI buttons
@@ -197,9 +211,19 @@ private slots:
 
 	void reloadShaders();
 
+	//! Queue a frame if the drawing was stopped because the scene was static.
+	void resumeDrawing();
+
+	//! Hide the window and start rendering the benchmark frames offscreen.
+	void startOffscreenBenchmark();
+	//! Render one benchmark frame into benchmarkFbo, and queue the next one.
+	void drawOffscreenBenchmarkFrame();
+
 private:
 	//! The graphics scene notifies us when a draw finished, so that we can queue the next one
 	void drawEnded();
+	//! Return true if no new frame needs to be drawn until something changes.
+	bool isStatic() const;
 	//! Returns the desired OpenGL format settings,
 	//! on desktop this corresponds to a GL 2.1 context,
 	//! with 32bit RGBA buffer and 24/8 depth/stencil buffer
@@ -229,6 +253,9 @@ private:
 
 	StelGuiBase* gui;
 	class StelApp* stelApp;
+	StelBenchmark* benchmark;
+	//! The target of the frames of an offscreen benchmark
+	QOpenGLFramebufferObject* benchmarkFbo;
 
 	bool updateQueued;
 	bool flagInvertScreenShotColors;
@@ -244,6 +271,10 @@ private:
 	bool flagUseButtonsBackground;
 
 	double lastEventTimeSec;
+	double lastInputEventTimeSec;
+
+	//! Whether to stop drawing while nothing changes
+	bool flagSkipStaticFrames;
 
 	//! The minimum desired frame rate in frame per second.
 	float minfps;
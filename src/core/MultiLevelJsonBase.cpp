@@ -23,6 +23,7 @@
 #include "StelProjector.hpp"
 #include "StelCore.hpp"
 #include "StelUtils.hpp"
+#include "StelInflateDevice.hpp"
 
 #include <QDebug>
 #include <QFile>
@@ -270,7 +271,8 @@ QVariantMap MultiLevelJsonBase::loadFromJSON(QIODevice& input, bool qZcompressed
 	}
 	else if (gzCompressed)
 	{
-		QByteArray ar = StelUtils::uncompress(input.readAll());
+		// Files written with StelInflateDevice::compressChunked() are inflated in parallel
+		QByteArray ar = StelInflateDevice::uncompressChunked(input.readAll());
 		input.close();
 		map = StelJsonParser::parse(ar).toMap();
 	}
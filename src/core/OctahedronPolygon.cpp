@@ -455,6 +455,7 @@ void OctahedronPolygon::updateVertexArray()
 	}
 	gluesDeleteTess(tess);
 	computeBoundingCap();
+	fillCachedVertexArray.cacheId = StelVertexArray::newCacheId();
 
 #ifndef NDEBUG
 	// Check that all triangles are properly oriented
@@ -897,6 +898,7 @@ QDataStream& operator>>(QDataStream& in, OctahedronPolygon& p)
 	}
 //	p.updateVertexArray();
 	in >> p.fillCachedVertexArray;
+	p.fillCachedVertexArray.cacheId = StelVertexArray::newCacheId();
 	in >> p.outlineCachedVertexArray;
 	in >> p.capN;
 	in >> p.capD;
@@ -27,6 +27,14 @@ Extinction::Extinction() : ext_coeff(50), undergroundExtinctionMode(UndergroundE
 {
 }
 
+// Airmass for the geometric altitude, following Young 1994
+static inline float youngAirmass(float cosZ)
+{
+	const float nom=(1.002432f*cosZ+0.148386f)*cosZ+0.0096467f;
+	const float denum=((cosZ+0.149864f)*cosZ+0.0102963f)*cosZ+0.000303978f;
+	return nom/denum;
+}
+
 // airmass computation for cosine of zenith angle z
 float Extinction::airmass(float cosZ, const bool apparent_z) const
 {
@@ -51,12 +59,53 @@ float Extinction::airmass(float cosZ, const bool apparent_z) const
 	else
 	{
 		//Young 1994
-		const float nom=(1.002432f*cosZ+0.148386f)*cosZ+0.0096467f;
-		const float denum=((cosZ+0.149864f)*cosZ+0.0102963f)*cosZ+0.000303978f;
-		return nom/denum;
+		return youngAirmass(cosZ);
+	}
+}
+
+// Same computation as airmass(cosZ, false) for each vector, but with the choice of the underground mode
+// out of the loops, which leaves simple loops without calls the compiler can vectorize.
+template <class T>
+static void addGeometricExtinction(int n, const Vector3<T>* altAzPos, float* mag, float k, Extinction::UndergroundExtinctionMode mode)
+{
+	switch (mode)
+	{
+		case Extinction::UndergroundExtinctionZero:
+			for (int i=0; i<n; ++i)
+			{
+				const float cosZ=altAzPos[i][2];
+				mag[i] += (cosZ<-0.035f ? 0.f : youngAirmass(cosZ)) * k;
+			}
+			break;
+		case Extinction::UndergroundExtinctionMax:
+			for (int i=0; i<n; ++i)
+			{
+				const float cosZ=altAzPos[i][2];
+				mag[i] += (cosZ<-0.035f ? 42.f : youngAirmass(cosZ)) * k;
+			}
+			break;
+		case Extinction::UndergroundExtinctionMirror:
+			for (int i=0; i<n; ++i)
+			{
+				float cosZ=altAzPos[i][2];
+				if (cosZ<-0.035f)
+					cosZ = std::min(1.f, -0.035f - (cosZ+0.035f));
+				mag[i] += youngAirmass(cosZ) * k;
+			}
+			break;
 	}
 }
 
+void Extinction::forward(int n, const Vec3d* altAzPos, float* mag) const
+{
+	addGeometricExtinction(n, altAzPos, mag, ext_coeff, undergroundExtinctionMode);
+}
+
+void Extinction::forward(int n, const Vec3f* altAzPos, float* mag) const
+{
+	addGeometricExtinction(n, altAzPos, mag, ext_coeff, undergroundExtinctionMode);
+}
+
 /* ***************************************************************************************************** */
 
 // The following 4 are to be configured, the rest is derived.
@@ -75,6 +124,40 @@ static const float TRANSITION_WIDTH_APP_DEG=1.78217f;
 static const float MIN_GEO_ALTITUDE_SIN=std::sin(MIN_GEO_ALTITUDE_DEG*M_PI/180.f);
 static const float MIN_APP_ALTITUDE_SIN=std::sin(MIN_APP_ALTITUDE_DEG*M_PI/180.f);
 
+// Number of intervals in the three parts of Refraction::refractionTable. With these, the linear interpolation of
+// the refraction is within 0.01 arcsecond of the formulas, the worst case being near the horizon.
+static const int TABLE_TRANSITION_SIZE=256;
+static const int TABLE_SIN_SIZE=8192;
+static const int TABLE_COS_SIZE=1024;
+// Limits of the parts: sin(altitude) at the bottom of the transition zone, at its top, and sin(45deg)=cos(45deg)
+static const double TABLE_SIN_MIN=std::sin((MIN_GEO_ALTITUDE_DEG-TRANSITION_WIDTH_GEO_DEG)*M_PI/180.);
+static const double TABLE_SIN_TRANSITION=std::sin(MIN_GEO_ALTITUDE_DEG*M_PI/180.);
+static const double TABLE_SIN_MAX=std::sqrt(0.5);
+
+// Refraction in degrees from Saemundsson, S&T1986 p70 / in Meeus, Astr.Alg.
+static float saemundssonRefraction(float geom_alt_deg, float press_temp_corr)
+{
+	return press_temp_corr * ( 1.02f / std::tan((geom_alt_deg+10.3f/(geom_alt_deg+5.11f))*M_PI/180.f) + 0.0019279f);
+}
+
+// Refraction in radians applied by innerRefractionForward() for a geometric altitude, without the limit at the zenith
+static float refractionAt(double geom_alt_rad, float press_temp_corr)
+{
+	const float geom_alt_deg = 180./M_PI*geom_alt_rad;
+	if (geom_alt_deg > MIN_GEO_ALTITUDE_DEG)
+		return saemundssonRefraction(geom_alt_deg, press_temp_corr)*M_PI/180.;
+	const float r_m5=saemundssonRefraction(MIN_GEO_ALTITUDE_DEG, press_temp_corr);
+	return qMax(0.f, r_m5*(geom_alt_deg-(MIN_GEO_ALTITUDE_DEG-TRANSITION_WIDTH_GEO_DEG))/TRANSITION_WIDTH_GEO_DEG)*M_PI/180.;
+}
+
+// Linear interpolation in a part of Refraction::refractionTable with n intervals, at u in [0, n]
+static inline double interpolate(const float* table, int n, double u)
+{
+	const int i=qMin(static_cast<int>(u), n-1);
+	const double f=u-i;
+	return table[i]+f*(table[i+1]-table[i]);
+}
+
 Refraction::Refraction() : pressure(1013.f), temperature(10.f),
 	preTransfoMat(Mat4d::identity()), invertPreTransfoMat(Mat4d::identity()), preTransfoMatf(Mat4f::identity()), invertPreTransfoMatf(Mat4f::identity()),
 	postTransfoMat(Mat4d::identity()), invertPostTransfoMat(Mat4d::identity()), postTransfoMatf(Mat4f::identity()), invertPostTransfoMatf(Mat4f::identity())
@@ -107,6 +190,16 @@ void Refraction::setPostTransfoMat(const Mat4d& m)
 void Refraction::updatePrecomputed()
 {
 	press_temp_corr=pressure/1010.f * 283.f/(273.f+temperature) / 60.f;
+
+	// Sample the refraction for tableRefractionForward()
+	refractionTable.resize(TABLE_TRANSITION_SIZE+TABLE_SIN_SIZE+TABLE_COS_SIZE+3);
+	float* t=refractionTable.data();
+	for (int i=0; i<=TABLE_TRANSITION_SIZE; ++i)
+		*t++=refractionAt(std::asin(TABLE_SIN_MIN+(TABLE_SIN_TRANSITION-TABLE_SIN_MIN)*i/TABLE_TRANSITION_SIZE), press_temp_corr);
+	for (int i=0; i<=TABLE_SIN_SIZE; ++i)
+		*t++=refractionAt(std::asin(TABLE_SIN_TRANSITION+(TABLE_SIN_MAX-TABLE_SIN_TRANSITION)*i/TABLE_SIN_SIZE), press_temp_corr);
+	for (int i=0; i<=TABLE_COS_SIZE; ++i)
+		*t++=refractionAt(std::acos(TABLE_SIN_MAX*i/TABLE_COS_SIZE), press_temp_corr);
 }
 
 void Refraction::innerRefractionForward(Vec3d& altAzPos) const
@@ -126,16 +219,14 @@ void Refraction::innerRefractionForward(Vec3d& altAzPos) const
 	float geom_alt_deg = 180./M_PI*geom_alt_rad;
 	if (geom_alt_deg > MIN_GEO_ALTITUDE_DEG)
 	{
-		// refraction from Saemundsson, S&T1986 p70 / in Meeus, Astr.Alg.
-		float r=press_temp_corr * ( 1.02f / std::tan((geom_alt_deg+10.3f/(geom_alt_deg+5.11f))*M_PI/180.f) + 0.0019279f);
-		geom_alt_deg += r;
+		geom_alt_deg += saemundssonRefraction(geom_alt_deg, press_temp_corr);
 		if (geom_alt_deg > 90.f)
 			geom_alt_deg=90.f;
 	}
 	else if(geom_alt_deg>MIN_GEO_ALTITUDE_DEG-TRANSITION_WIDTH_GEO_DEG)
 	{
 		// Avoids the jump below -5 by interpolating linearly between MIN_GEO_ALTITUDE_DEG and bottom of transition zone
-		float r_m5=press_temp_corr * ( 1.02f / std::tan((MIN_GEO_ALTITUDE_DEG+10.3f/(MIN_GEO_ALTITUDE_DEG+5.11f))*M_PI/180.f) + 0.0019279f);
+		float r_m5=saemundssonRefraction(MIN_GEO_ALTITUDE_DEG, press_temp_corr);
 		geom_alt_deg += r_m5*(geom_alt_deg-(MIN_GEO_ALTITUDE_DEG-TRANSITION_WIDTH_GEO_DEG))/TRANSITION_WIDTH_GEO_DEG;
 	}
 	else return;
@@ -153,6 +244,47 @@ void Refraction::innerRefractionForward(Vec3d& altAzPos) const
 	altAzPos[2]=sinRef*length;
 }
 
+void Refraction::tableRefractionForward(Vec3d& altAzPos) const
+{
+	const double lengthXY2 = altAzPos[0]*altAzPos[0]+altAzPos[1]*altAzPos[1];
+	const double length = std::sqrt(lengthXY2+altAzPos[2]*altAzPos[2]);
+	if (length==0.0)
+		return;
+	const double sinGeo = altAzPos[2]/length;
+	if (sinGeo<=TABLE_SIN_MIN)
+		return;
+	const double cosGeo = std::sqrt(lengthXY2)/length;
+
+	const float* table = refractionTable.constData();
+	double r;
+	if (sinGeo<TABLE_SIN_TRANSITION)
+		r = interpolate(table, TABLE_TRANSITION_SIZE,
+				(sinGeo-TABLE_SIN_MIN)*(TABLE_TRANSITION_SIZE/(TABLE_SIN_TRANSITION-TABLE_SIN_MIN)));
+	else if (sinGeo<=TABLE_SIN_MAX)
+		r = interpolate(table+TABLE_TRANSITION_SIZE+1, TABLE_SIN_SIZE,
+				(sinGeo-TABLE_SIN_TRANSITION)*(TABLE_SIN_SIZE/(TABLE_SIN_MAX-TABLE_SIN_TRANSITION)));
+	else
+		r = interpolate(table+TABLE_TRANSITION_SIZE+TABLE_SIN_SIZE+2, TABLE_COS_SIZE,
+				cosGeo*(TABLE_COS_SIZE/TABLE_SIN_MAX));
+
+	// Rotate the vector up by r. The refraction is a small angle, for which these series are exact in double precision.
+	const double r2 = r*r;
+	const double sinR = r*(1.-r2/6.*(1.-r2/20.));
+	const double cosR = 1.-r2/2.*(1.-r2/12.);
+	double sinRef = sinGeo*cosR+cosGeo*sinR;
+	double cosRef = cosGeo*cosR-sinGeo*sinR;
+	if (cosRef<0.)
+	{
+		// Like innerRefractionForward(), don't go beyond the zenith
+		sinRef = 1.;
+		cosRef = 0.;
+	}
+	const double shortenxy = (cosGeo>0. ? cosRef/cosGeo : 1.);
+	altAzPos[0]*=shortenxy;
+	altAzPos[1]*=shortenxy;
+	altAzPos[2]=sinRef*length;
+}
+
 // going from observed position to geometrical position.
 void Refraction::innerRefractionBackward(Vec3d& altAzPos) const
 {
@@ -236,6 +368,59 @@ void Refraction::backward(Vec3f& altAzPos) const
 	altAzPos.transfo4d(invertPreTransfoMatf);
 }
 
+void Refraction::forward(int n, Vec3d* altAzPos) const
+{
+	for (int i=0; i<n; ++i)
+	{
+		altAzPos[i].transfo4d(preTransfoMat);
+		tableRefractionForward(altAzPos[i]);
+		altAzPos[i].transfo4d(postTransfoMat);
+	}
+}
+
+void Refraction::forward(int n, Vec3f* altAzPos) const
+{
+	Vec3d v;
+	for (int i=0; i<n; ++i)
+	{
+		v.set(altAzPos[i][0], altAzPos[i][1], altAzPos[i][2]);
+		v.transfo4d(preTransfoMat);
+		tableRefractionForward(v);
+		v.transfo4d(postTransfoMat);
+		altAzPos[i].set(v[0], v[1], v[2]);
+	}
+}
+
+void Refraction::forwardBlock(int count, const Vec3d* in, double* x, double* y, double* z) const
+{
+	Vec3d v;
+	for (int i=0; i<count; ++i)
+	{
+		v = in[i];
+		v.transfo4d(preTransfoMat);
+		tableRefractionForward(v);
+		v.transfo4d(postTransfoMat);
+		x[i] = v[0];
+		y[i] = v[1];
+		z[i] = v[2];
+	}
+}
+
+void Refraction::forwardBlock(int count, const Vec3f* in, float* x, float* y, float* z) const
+{
+	Vec3d v;
+	for (int i=0; i<count; ++i)
+	{
+		v.set(in[i][0], in[i][1], in[i][2]);
+		v.transfo4d(preTransfoMat);
+		tableRefractionForward(v);
+		v.transfo4d(postTransfoMat);
+		x[i] = v[0];
+		y[i] = v[1];
+		z[i] = v[2];
+	}
+}
+
 void Refraction::setPressure(float p)
 {
 	pressure=p;
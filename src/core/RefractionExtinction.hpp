@@ -31,6 +31,8 @@
 #include "VecMath.hpp"
 #include "StelProjector.hpp"
 
+#include <QVector>
+
 //! @class Extinction
 //! This class performs extinction computations, following literature from atmospheric optics and astronomy.
 //! Airmass computations are limited to meaningful altitudes.
@@ -83,6 +85,11 @@ public:
 		*mag -= airmass(altAzPos[2], false) * ext_coeff;
 	}
 
+	//! Compute extinction effect for n NORMALIZED (geometrical) position vectors, adding it to the n magnitudes.
+	//! The results are the same as with forward() called for each vector, but faster for large arrays like mesh vertices.
+	void forward(int n, const Vec3d* altAzPos, float* mag) const;
+	void forward(int n, const Vec3f* altAzPos, float* mag) const;
+
 	//! Set visual extinction coefficient (mag/airmass), influences extinction computation.
 	//! @param k= 0.1 for highest mountains, 0.2 for very good lowland locations, 0.35 for typical lowland, 0.5 in humid climates.
 	void setExtinctionCoefficient(float k) { ext_coeff=k; }
@@ -143,6 +150,17 @@ public:
 	//! Note that forward/backward are no absolute reverse operations!
 	void backward(Vec3f& altAzPos) const;
 
+	//! Apply refraction to n vectors in place.
+	//! This interpolates the refraction in tables computed when pressure or temperature change, instead of evaluating
+	//! the formulas for each vector. The result is within 0.01 arcsecond of the formulas, and within 0.03 arcsecond
+	//! of forward(), which computes the altitude in single precision.
+	void forward(int n, Vec3d* altAzPos) const;
+	void forward(int n, Vec3f* altAzPos) const;
+
+	//! Same approximation as forward(int, Vec3d*), used by StelProjector to project vertex arrays.
+	void forwardBlock(int count, const Vec3d* in, double* x, double* y, double* z) const;
+	void forwardBlock(int count, const Vec3f* in, float* x, float* y, float* z) const;
+
 	void combine(const Mat4d& m)
 	{
 		setPreTransfoMat(preTransfoMat*m);
@@ -150,7 +168,7 @@ public:
 
 	Mat4d getApproximateLinearTransfo() const {return postTransfoMat*preTransfoMat;}
 
-	StelProjector::ModelViewTranformP clone() const {Refraction* refr = new Refraction(); *refr=*this; return StelProjector::ModelViewTranformP(refr);}
+	StelProjector::ModelViewTranformP clone() const {return StelProjector::ModelViewTranformP(new Refraction(*this));}
 
 	//! Set surface air pressure (mbars), influences refraction computation.
 	void setPressure(float p_mbar);
@@ -170,6 +188,8 @@ private:
 
 	void innerRefractionForward(Vec3d& altAzPos) const;
 	void innerRefractionBackward(Vec3d& altAzPos) const;
+	//! Approximation of innerRefractionForward() using refractionTable.
+	void tableRefractionForward(Vec3d& altAzPos) const;
 	
 	//! These 3 Atmosphere parameters can be controlled by GUI.
 	//! Pressure[mbar] (1013)
@@ -178,6 +198,10 @@ private:
 	float temperature;
 	//! Correction factor for refraction formula, to be cached for speed.
 	float press_temp_corr;
+	//! Refraction in radians as function of the geometric altitude, for tableRefractionForward(). It is sampled in
+	//! three consecutive parts: by sin(altitude) in the transition zone, by sin(altitude) from there to 45 degrees,
+	//! and by cos(altitude) above 45 degrees, where the sine changes too slowly. Shared between copies.
+	QVector<float> refractionTable;
 
 	//! Used to pretransform coordinates into AltAz frame.
 	Mat4d preTransfoMat;
@@ -42,8 +42,11 @@
 #include "ToastMgr.hpp"
 #include "StelActionMgr.hpp"
 #include "StelPropertyMgr.hpp"
+#include "StelProfiler.hpp"
 #include "StelProgressController.hpp"
 #include "StelModuleMgr.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelObserver.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelSkyCultureMgr.hpp"
 #include "StelFileMgr.hpp"
@@ -213,6 +216,7 @@ StelApp::StelApp(StelMainView *parent)
 	, skyCultureMgr(Q_NULLPTR)
 	, actionMgr(Q_NULLPTR)
 	, propMgr(Q_NULLPTR)
+	, profiler(Q_NULLPTR)
 	, textureMgr(Q_NULLPTR)
 	, stelObjectMgr(Q_NULLPTR)
 	, planetLocationMgr(Q_NULLPTR)
@@ -230,6 +234,11 @@ StelApp::StelApp(StelMainView *parent)
 	, fps(0)
 	, frame(0)
 	, frameTimeAccum(0.)
+	, flagRedrawRequested(true)
+	, lastSceneChangeTime(0.)
+	, lastJD(0.)
+	, lastViewDirection(0.)
+	, lastFov(0.)
 	, flagNightVision(false)
 	, confSettings(Q_NULLPTR)
 	, initialized(false)
@@ -243,6 +252,11 @@ StelApp::StelApp(StelMainView *parent)
 	, renderBuffer(Q_NULLPTR)
 	, viewportEffect(Q_NULLPTR)
 	, gl(Q_NULLPTR)
+	, skyCache(Q_NULLPTR)
+	, flagUseSkyCache(true)
+	, flagSkyCacheValid(false)
+	, skyCacheHitCount(0)
+	, drawnFrameCount(0)
 	, flagShowDecimalDegrees(false)
 	, flagUseAzimuthFromSouth(false)
 	, flagUseFormattingOutput(false)
@@ -259,6 +273,7 @@ StelApp::StelApp(StelMainView *parent)
 	singleton = this;
 
 	moduleMgr = new StelModuleMgr();
+	profiler = new StelProfiler(this);
 
 	wheelEventTimer = new QTimer(this);
 	wheelEventTimer->setInterval(25);
@@ -274,6 +289,7 @@ StelApp::StelApp(StelMainView *parent)
 StelApp::~StelApp()
 {
 	qDebug() << qPrintable(QString("Downloaded %1 files (%2 kbytes) in a session of %3 sec (average of %4 kB/s + %5 files from cache (%6 kB)).").arg(nbDownloadedFiles).arg(totalDownloadedSize/1024).arg(getTotalRunTime()).arg((double)(totalDownloadedSize/1024)/getTotalRunTime()).arg(nbUsedCache).arg(totalUsedCacheSize/1024));
+	qDebug() << qPrintable(QString("Drew %1 frames, %2 of them reusing the cached sky image.").arg(drawnFrameCount).arg(skyCacheHitCount));
 
 	stelObjectMgr->unSelect();
 	moduleMgr->unloadModule("StelVideoMgr", false);  // We need to delete it afterward
@@ -379,6 +395,9 @@ void StelApp::setupNetworkProxy()
 void StelApp::initScriptMgr()
 {
 	scriptMgr->addModules();
+	// The scene of a benchmark must not depend on the startup script
+	if (qApp->property("benchmark").isValid())
+		return;
 	QString startupScript;
 	if (qApp->property("onetime_startup_script").isValid())
 		startupScript = qApp->property("onetime_startup_script").toString();
@@ -432,113 +451,115 @@ void StelApp::init(QSettings* conf)
 
 	//create non-StelModule managers
 	propMgr = new StelPropertyMgr();
+	connect(propMgr, SIGNAL(stelPropertyChanged(StelProperty*,QVariant)), this, SLOT(requestRedraw()));
 	localeMgr = new StelLocaleMgr();
 	skyCultureMgr = new StelSkyCultureMgr();
 	propMgr->registerObject(skyCultureMgr);
+	propMgr->registerObject(profiler);
+	propMgr->registerObject(this);
+	profiler->setWindowSize(confSettings->value("devel/profiler_window_size", 300).toInt());
+	profiler->setEnabled(confSettings->value("devel/flag_profiler", false).toBool());
 	planetLocationMgr = new StelLocationMgr();
 	actionMgr = new StelActionMgr();
 
 	// Stel Object Data Base manager
 	stelObjectMgr = new StelObjectMgr();
-	stelObjectMgr->init();
-	getModuleMgr().registerModule(stelObjectMgr);	
+	getModuleMgr().initModule(stelObjectMgr);
 
 	localeMgr->init();
 
-	// Init the solar system first
+	// The star and DSO catalogs are read in worker threads while the other modules are initialized
 	SolarSystem* ssystem = new SolarSystem();
-	ssystem->init();
-	getModuleMgr().registerModule(ssystem);
+	StarMgr* hip_stars = new StarMgr();
+	NebulaMgr* nebulas = new NebulaMgr();
+	getModuleMgr().startLoading(QList<StelModule*>() << hip_stars << nebulas,
+				    confSettings->value("devel/flag_concurrent_module_loading", true).toBool());
+
+	// Init the solar system first
+	getModuleMgr().initModule(ssystem);
 
 	// Load hipparcos stars & names
-	StarMgr* hip_stars = new StarMgr();
-	hip_stars->init();
-	getModuleMgr().registerModule(hip_stars);
+	getModuleMgr().initModule(hip_stars);
 
 	core->init();
 
 	// Init nebulas
-	NebulaMgr* nebulas = new NebulaMgr();
-	nebulas->init();
-	getModuleMgr().registerModule(nebulas);
+	getModuleMgr().initModule(nebulas);
 
 	// Init milky way
 	MilkyWay* milky_way = new MilkyWay();
-	milky_way->init();
-	getModuleMgr().registerModule(milky_way);
+	getModuleMgr().initModule(milky_way);
 
 	// Init zodiacal light
 	ZodiacalLight* zodiacal_light = new ZodiacalLight();
-	zodiacal_light->init();
-	getModuleMgr().registerModule(zodiacal_light);
+	getModuleMgr().initModule(zodiacal_light);
 
 	// Init sky image manager
 	skyImageMgr = new StelSkyLayerMgr();
-	skyImageMgr->init();
-	getModuleMgr().registerModule(skyImageMgr);
+	getModuleMgr().initModule(skyImageMgr);
 
 	// Toast surveys
 	ToastMgr* toasts = new ToastMgr();
-	toasts->init();
-	getModuleMgr().registerModule(toasts);
+	getModuleMgr().initModule(toasts);
 
 	// Init audio manager
 	audioMgr = new StelAudioMgr();
 
 	// Init video manager
 	videoMgr = new StelVideoMgr();
-	videoMgr->init();
-	getModuleMgr().registerModule(videoMgr);
+	getModuleMgr().initModule(videoMgr);
 
 	// Constellations
 	ConstellationMgr* constellations = new ConstellationMgr(hip_stars);
-	constellations->init();
-	getModuleMgr().registerModule(constellations);
+	getModuleMgr().initModule(constellations);
 
 	// Asterisms
 	AsterismMgr* asterisms = new AsterismMgr(hip_stars);
-	asterisms->init();
-	getModuleMgr().registerModule(asterisms);
+	getModuleMgr().initModule(asterisms);
 
 	// Landscape, atmosphere & cardinal points section
 	LandscapeMgr* landscape = new LandscapeMgr();
-	landscape->init();
-	getModuleMgr().registerModule(landscape);
+	getModuleMgr().initModule(landscape);
 
 	GridLinesMgr* gridLines = new GridLinesMgr();
-	gridLines->init();
-	getModuleMgr().registerModule(gridLines);
+	getModuleMgr().initModule(gridLines);
 
 	// Sporadic Meteors
 	SporadicMeteorMgr* meteors = new SporadicMeteorMgr(10, 72);
-	meteors->init();
-	getModuleMgr().registerModule(meteors);
+	getModuleMgr().initModule(meteors);
 
 	// User labels
 	LabelMgr* skyLabels = new LabelMgr();
-	skyLabels->init();
-	getModuleMgr().registerModule(skyLabels);
+	getModuleMgr().initModule(skyLabels);
 
 	skyCultureMgr->init();
 
 	// Init custom objects
 	CustomObjectMgr* custObj = new CustomObjectMgr();
-	custObj->init();
-	getModuleMgr().registerModule(custObj);
+	getModuleMgr().initModule(custObj);
 
 	//Create the script manager here, maybe some modules/plugins may want to connect to it
 	//It has to be initialized later after all modules have been loaded by calling initScriptMgr
 #ifndef DISABLE_SCRIPTING
 	scriptAPIProxy = new StelMainScriptAPIProxy(this);
 	scriptMgr = new StelScriptMgr(this);
+	connect(scriptMgr, SIGNAL(scriptRunning()), this, SLOT(requestRedraw()));
 #endif
 
+	// Wake up the main view for the changes done while it doesn't draw, e.g. from scripts, plugins or remote control.
+	// timeSyncOccurred() is emitted by StelCore::setJD(), setJDE() and setTimeRate().
+	connect(core, SIGNAL(timeSyncOccurred(double)), this, SLOT(requestRedraw()));
+	connect(core, SIGNAL(timeRateChanged(double)), this, SLOT(requestRedraw()));
+	connect(core, SIGNAL(locationChanged(StelLocation)), this, SLOT(requestRedraw()));
+	connect(stelObjectMgr, SIGNAL(selectedObjectChanged(StelModule::StelModuleSelectAction)), this, SLOT(requestRedraw()));
+
 	// Initialisation of the color scheme
 	emit colorSchemeChanged("color");
 	setVisionModeNight(confSettings->value("viewing/flag_night").toBool());
 
 	// Enable viewport effect at startup if he set
 	setViewportEffect(confSettings->value("video/viewport_effect", "none").toString());
+	setFlagUseSkyCache(confSettings->value("video/flag_sky_cache", true).toBool());
 
 	// Proxy Initialisation
 	setupNetworkProxy();
@@ -600,6 +621,8 @@ void StelApp::initPlugIns()
 {
 	// Load dynamically all the modules found in the modules/ directories
 	// which are configured to be loaded at startup
+	QList<StelModule*> plugins;
+	QStringList pluginIds;
 	foreach (StelModuleMgr::PluginDescriptor i, moduleMgr->getPluginsList())
 	{
 		if (i.loadAtStartup==false)
@@ -607,12 +630,23 @@ void StelApp::initPlugIns()
 		StelModule* m = moduleMgr->loadPlugin(i.info.id);
 		if (m!=Q_NULLPTR)
 		{
-			moduleMgr->registerModule(m, true);
-			//load extensions after the module is registered
-			moduleMgr->loadExtensions(i.info.id);
-			m->init();
+			plugins << m;
+			pluginIds << i.info.id;
 		}
 	}
+
+	// Load the data of all plugins concurrently, then initialize them in order
+	moduleMgr->startLoading(plugins, confSettings->value("devel/flag_concurrent_module_loading", true).toBool());
+	for (int i=0; i<plugins.size(); ++i)
+	{
+		// A plugin may already be initialized and registered as a dependency of a previous one
+		if (moduleMgr->getModule(pluginIds.at(i), true)==Q_NULLPTR)
+			moduleMgr->registerModule(plugins.at(i), true);
+		//load extensions after the module is registered
+		moduleMgr->loadExtensions(pluginIds.at(i));
+		moduleMgr->initModule(plugins.at(i), true);
+	}
+	moduleMgr->logStartupTimeline();
 }
 
 void StelApp::deinit()
@@ -653,6 +687,8 @@ void StelApp::update(double deltaTime)
 	if (!initialized)
 		return;
 
+	textureMgr->beginFrame();
+
 	++frame;
 	frameTimeAccum+=deltaTime;
 	if (frameTimeAccum > 1.)
@@ -662,18 +698,118 @@ void StelApp::update(double deltaTime)
 		frame = 0;
 		frameTimeAccum=0.;
 	}
-		
-	core->update(deltaTime);
+
+	// A frame is measured from the update to the end of draw()
+	profiler->beginFrame();
+
+	{
+		STEL_PROFILE_ZONE("StelCore.update");
+		core->update(deltaTime);
+	}
 
 	moduleMgr->update();
 
 	// Send the event to every StelModule
 	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionUpdate))
 	{
+		const bool profiled = profiler->beginZone(profiler->getModuleZone(i, StelProfiler::PhaseUpdate));
 		i->update(deltaTime);
+		if (profiled)
+			profiler->endZone();
 	}
 
 	stelObjectMgr->update(deltaTime);
+
+	updateSceneChanged();
+}
+
+void StelApp::updateSceneChanged()
+{
+	bool changed = flagRedrawRequested;
+	flagRedrawRequested = false;
+
+	const double jd = core->getJD();
+	const StelMovementMgr* mmgr = core->getMovementMgr();
+	const Vec3d viewDirection = mmgr->getViewDirectionJ2000();
+	const double fov = mmgr->getCurrentFov();
+	if (jd!=lastJD || viewDirection!=lastViewDirection || fov!=lastFov)
+	{
+		changed = true;
+		lastJD = jd;
+		lastViewDirection = viewDirection;
+		lastFov = fov;
+	}
+
+	changed = changed || core->getCurrentObserver()->isTraveling() || !progressControllers.isEmpty() || textureMgr->isLoading();
+	// The pointers of the selected objects are animated
+	changed = changed || (stelObjectMgr->getWasSelected() && stelObjectMgr->getFlagSelectedObjectPointer());
+#ifndef DISABLE_SCRIPTING
+	changed = changed || scriptMgr->scriptIsRunning();
+#endif
+	if (!changed)
+	{
+		foreach (const StelModule* m, moduleMgr->getCallOrders(StelModule::ActionUpdate))
+		{
+			if (m->needsRedraw())
+			{
+				changed = true;
+				break;
+			}
+		}
+	}
+
+	if (changed)
+		lastSceneChangeTime = getTotalRunTime();
+}
+
+bool StelApp::isSceneStatic() const
+{
+	// The delay lets the faders and other short animations started by a change finish
+	return !flagRedrawRequested && getTotalRunTime()-lastSceneChangeTime > 3.;
+}
+
+void StelApp::requestRedraw()
+{
+	flagRedrawRequested = true;
+	emit redrawRequested();
+}
+
+void StelApp::setFlagUseSkyCache(bool b)
+{
+	flagSkyCacheValid = false;
+	if (b!=flagUseSkyCache)
+	{
+		flagUseSkyCache = b;
+		emit flagUseSkyCacheChanged(b);
+	}
+}
+
+void StelApp::prepareSkyCache()
+{
+	if (!skyCache)
+	{
+		// The sky cache holds the final image, in device pixels
+		const StelProjectorP prj = core->getProjection2d();
+		const int w = prj->getViewportPosX()+prj->getViewportWidth();
+		const int h = prj->getViewportPosY()+prj->getViewportHeight();
+		skyCache = new QOpenGLFramebufferObject(w, h, QOpenGLFramebufferObject::Depth);
+	}
+	skyCache->bind();
+	GL(gl->glClearColor(0,0,0,0));
+	GL(gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+}
+
+void StelApp::paintSkyCache(quint32 drawFbo)
+{
+	STEL_PROFILE_ZONE("StelApp.paintSkyCache");
+	GL(gl->glBindFramebuffer(GL_FRAMEBUFFER, drawFbo));
+	const StelProjectorP prj = core->getProjection2d();
+	StelPainter sPainter(prj);
+	sPainter.setColor(1,1,1);
+	sPainter.setBlending(false);
+	GL(gl->glBindTexture(GL_TEXTURE_2D, skyCache->texture()));
+	// The painter coordinates start at the viewport corner, the buffer at the corner of the window
+	sPainter.drawRect2d(-prj->getViewportPosX(), -prj->getViewportPosY(), skyCache->width(), skyCache->height());
 }
 
 void StelApp::prepareRenderBuffer()
@@ -707,24 +843,59 @@ void StelApp::draw()
 	GLint drawFbo;
 	GL(gl->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &drawFbo));
 
+	++drawnFrameCount;
+	// While the scene is static, frames are only drawn because of the GUI or of input events not changing the sky.
+	// The sky is then drawn once into the cache, and the next frames paint the cached image under the GUI.
+	const bool useSkyCache = flagUseSkyCache && isSceneStatic();
+	if (useSkyCache && flagSkyCacheValid)
+	{
+		++skyCacheHitCount;
+	}
+	else if (useSkyCache)
+	{
+		prepareSkyCache();
+		drawSky(skyCache->handle());
+		flagSkyCacheValid = true;
+	}
+	else
+	{
+		flagSkyCacheValid = false;
+		drawSky(drawFbo);
+	}
+	if (useSkyCache)
+		paintSkyCache(drawFbo);
+
+	profiler->endFrame();
+}
+
+void StelApp::drawSky(quint32 targetFbo)
+{
 	prepareRenderBuffer();
-	currentFbo = renderBuffer ? renderBuffer->handle() : drawFbo;
+	currentFbo = renderBuffer ? renderBuffer->handle() : targetFbo;
 
-	core->preDraw();
+	{
+		STEL_PROFILE_ZONE("StelCore.preDraw");
+		core->preDraw();
+	}
 
 	const QList<StelModule*> modules = moduleMgr->getCallOrders(StelModule::ActionDraw);
 	foreach(StelModule* module, modules)
 	{
+		const bool profiled = profiler->beginZone(profiler->getModuleZone(module, StelProfiler::PhaseDraw));
 		module->draw(core);
+		if (profiled)
+			profiler->endZone();
+	}
+	{
+		STEL_PROFILE_ZONE("StelCore.postDraw");
+		core->postDraw();
 	}
-	core->postDraw();
 #ifdef ENABLE_SPOUT
 	// At this point, the sky scene has been drawn, but no GUI panels.
 	if(spoutSender)
-		spoutSender->captureAndSendFrame(drawFbo);
+		spoutSender->captureAndSendFrame(targetFbo);
 #endif
-	applyRenderBuffer(drawFbo);
-
+	applyRenderBuffer(targetFbo);
 }
 
 /*************************************************************************
@@ -745,6 +916,13 @@ void StelApp::glWindowHasBeenResized(const QRectF& rect)
 		delete renderBuffer;
 		renderBuffer = Q_NULLPTR;
 	}
+	if (skyCache)
+	{
+		ensureGLContextCurrent();
+		delete skyCache;
+		skyCache = Q_NULLPTR;
+	}
+	flagSkyCacheValid = false;
 #ifdef ENABLE_SPOUT
 	if (spoutSender)
 		spoutSender->resize(rect.width(),rect.height());
@@ -763,6 +941,8 @@ void StelApp::handleClick(QMouseEvent* inputEvent)
 
 	QMouseEvent event(inputEvent->type(), QPoint(x*devicePixelsPerPixel, y*devicePixelsPerPixel), inputEvent->button(), inputEvent->buttons(), inputEvent->modifiers());
 	event.setAccepted(false);
+	// The modules may draw something different in response to the input events
+	flagSkyCacheValid = false;
 	
 	// Send the event to every StelModule
 	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionHandleMouseClicks))
@@ -781,6 +961,7 @@ void StelApp::handleClick(QMouseEvent* inputEvent)
 void StelApp::handleWheel(QWheelEvent* event)
 {
 	event->setAccepted(false);
+	flagSkyCacheValid = false;
 
 	const int deltaIndex = event->orientation() == Qt::Horizontal ? 0 : 1;
 	wheelEventDelta[deltaIndex] += event->delta();
@@ -815,6 +996,7 @@ void StelApp::handleWheel(QWheelEvent* event)
 // Handle mouse move
 bool StelApp::handleMove(float x, float y, Qt::MouseButtons b)
 {
+	flagSkyCacheValid = false;
 	if (viewportEffect)
 		viewportEffect->distortXY(x, y);
 	// Send the event to every StelModule
@@ -830,6 +1012,7 @@ bool StelApp::handleMove(float x, float y, Qt::MouseButtons b)
 void StelApp::handleKeys(QKeyEvent* event)
 {
 	event->setAccepted(false);
+	flagSkyCacheValid = false;
 	// First try to trigger a shortcut.
 	if (event->type() == QEvent::KeyPress)
 	{
@@ -851,6 +1034,7 @@ void StelApp::handleKeys(QKeyEvent* event)
 // Handle pinch on multi touch devices
 void StelApp::handlePinch(qreal scale, bool started)
 {
+	flagSkyCacheValid = false;
 	// Send the event to every StelModule
 	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionHandleMouseMoves))
 	{
@@ -923,6 +1107,8 @@ void StelApp::reportFileDownloadFinished(QNetworkReply* reply)
 		++nbDownloadedFiles;
 		totalDownloadedSize+=reply->bytesAvailable();
 	}
+	// The downloaded data may change the sky
+	requestRedraw();
 }
 
 void StelApp::quit()
@@ -940,6 +1126,13 @@ void StelApp::setDevicePixelsPerPixel(float dppp)
 		StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
 		params.devicePixelsPerPixel = devicePixelsPerPixel;
 		core->setCurrentStelProjectorParams(params);
+		if (skyCache)
+		{
+			ensureGLContextCurrent();
+			delete skyCache;
+			skyCache = Q_NULLPTR;
+		}
+		flagSkyCacheValid = false;
 	}
 }
 
@@ -952,6 +1145,7 @@ void StelApp::setViewportEffect(const QString& name)
 		delete renderBuffer;
 		renderBuffer = Q_NULLPTR;
 	}
+	flagSkyCacheValid = false;
 	if (viewportEffect)
 	{
 		delete viewportEffect;
@@ -23,6 +23,7 @@
 #include <QString>
 #include <QObject>
 #include "StelModule.hpp"
+#include "VecMath.hpp"
 
 // Predeclaration of some classes
 class StelCore;
@@ -48,6 +49,7 @@ class StelMainScriptAPIProxy;
 class StelScriptMgr;
 class StelActionMgr;
 class StelPropertyMgr;
+class StelProfiler;
 class StelProgressController;
 
 #ifdef 	ENABLE_SPOUT
@@ -69,6 +71,10 @@ class StelApp : public QObject
 {
 	Q_OBJECT
 	Q_PROPERTY(bool nightMode READ getVisionModeNight WRITE setVisionModeNight NOTIFY visionNightModeChanged)
+	Q_PROPERTY(bool flagUseSkyCache READ getFlagUseSkyCache NOTIFY flagUseSkyCacheChanged)
+	// The counters change at each frame and have no NOTIFY signal: a property change requests a redraw.
+	Q_PROPERTY(quint64 skyCacheHitCount READ getSkyCacheHitCount)
+	Q_PROPERTY(quint64 drawnFrameCount READ getDrawnFrameCount)
 
 public:
 	friend class StelAppGraphicsWidget;
@@ -139,6 +145,9 @@ public:
 	//! Return the property manager
 	StelPropertyMgr* getStelPropertyManager() {return propMgr;}
 
+	//! Return the frame profiler
+	StelProfiler* getProfiler() {return profiler;}
+
 	//! Get the video manager
 	StelVideoMgr* getStelVideoMgr() {return videoMgr;}
 
@@ -248,6 +257,24 @@ public slots:
 	//! @return the FPS averaged on the last second
 	float getFps() const {return fps;}
 
+	//! Return true if nothing changed in the sky for a few seconds: the time, the view, the properties and
+	//! the modules output (see StelModule::needsRedraw()) are the same, and no data is being loaded.
+	//! The main view then stops drawing frames until there is an event or requestRedraw() is called.
+	bool isSceneStatic() const;
+
+	//! Notify that the sky changed, so that the next frames are drawn even if the scene was static.
+	//! Already called for the changes of the time, location and selection, the movements of the view and the start of scripts.
+	void requestRedraw();
+
+	//! Set whether the sky is kept in an offscreen buffer while the scene is static (see isSceneStatic()).
+	//! The frames drawn meanwhile, e.g. because the GUI changed, reuse this image instead of drawing the sky again.
+	void setFlagUseSkyCache(bool b);
+	bool getFlagUseSkyCache() const {return flagUseSkyCache;}
+	//! Return the number of frames which reused the cached sky image instead of drawing the sky.
+	quint64 getSkyCacheHitCount() const {return skyCacheHitCount;}
+	//! Return the number of frames drawn since the start, including those which reused the cached sky image.
+	quint64 getDrawnFrameCount() const {return drawnFrameCount;}
+
 	//! Returns the default FBO handle, to be used when StelModule instances want to release their own FBOs.
 	//! Note that this is usually not the same as QOpenGLContext::defaultFramebufferObject(),
 	//! so use this call instead of the Qt version!
@@ -282,6 +309,9 @@ signals:
 	void progressBarRemoved(const StelProgressController*);
 	//! Called just before we exit Qt mainloop.
 	void aboutToQuit();
+	//! Emitted by requestRedraw(), so that the main view resumes drawing.
+	void redrawRequested();
+	void flagUseSkyCacheChanged(bool b);
 private:
 
 	//! Handle mouse clics.
@@ -295,6 +325,16 @@ private:
 	//! Handle pinch on multi touch devices.
 	void handlePinch(qreal scale, bool started);
 
+	//! Check whether anything changed in the sky since the last update, see isSceneStatic().
+	void updateSceneChanged();
+
+	//! Draw the sky, i.e. all modules, into the given framebuffer.
+	void drawSky(quint32 targetFbo);
+	//! Create the sky cache buffer if needed, bind it and clear it.
+	void prepareSkyCache();
+	//! Paint the cached sky image into the given framebuffer.
+	void paintSkyCache(quint32 drawFbo);
+
 	//! Used internally to set the viewport effects.
 	void prepareRenderBuffer();
 	//! Used internally to set the viewport effects.
@@ -325,6 +365,9 @@ private:
 	//Property manager for the application
 	StelPropertyMgr* propMgr;
 
+	// Measures the time spent in the modules
+	StelProfiler* profiler;
+
 	// Textures manager for the application
 	StelTextureMgr* textureMgr;
 
@@ -377,6 +420,13 @@ private:
 	int frame;
 	double frameTimeAccum;		// Used for fps counter
 
+	// State of the last update, used to find out whether the sky changed
+	bool flagRedrawRequested;
+	double lastSceneChangeTime;
+	double lastJD;
+	Vec3d lastViewDirection;
+	double lastFov;
+
 	//! Define whether we are in night vision mode
 	bool flagNightVision;
 
@@ -411,6 +461,13 @@ private:
 	QOpenGLFramebufferObject* renderBuffer;
 	StelViewportEffect* viewportEffect;
 	QOpenGLFunctions* gl;
+
+	// Framebuffer object retaining the sky image while the scene is static.
+	QOpenGLFramebufferObject* skyCache;
+	bool flagUseSkyCache;
+	bool flagSkyCacheValid;
+	quint64 skyCacheHitCount;
+	quint64 drawnFrameCount;
 	
 	bool flagShowDecimalDegrees;
 	// flag to indicate we want calculate azimuth from south towards west (as in old astronomical literature)
@@ -49,6 +49,7 @@
 #include <QTimeZone>
 #include <QFile>
 #include <QDir>
+#include <QThread>
 
 #include <iostream>
 #include <fstream>
@@ -97,6 +98,7 @@ StelCore::StelCore()
 	, de431Available(false)
 	, de430Active(false)
 	, de431Active(false)
+	, projectionCacheEnabled(false)
 {
 	setObjectName("StelCore");
 	registerMathMetaTypes();
@@ -391,6 +393,21 @@ StelProjectorP StelCore::getProjection(StelProjector::ModelViewTranformP modelVi
 
 // Get an instance of projector using the current display parameters from Navigation, StelMovementMgr
 StelProjectorP StelCore::getProjection(FrameType frameType, RefractionMode refractionMode) const
+{
+	// While drawing, all modules use the same few projectors. Only the main thread uses the cache.
+	const bool cached = projectionCacheEnabled && frameType>FrameUninitialized && frameType<=FrameSupergalactic
+			    && QThread::currentThread()==thread();
+	if (cached)
+	{
+		StelProjectorP& prj = projectionCache[frameType][refractionMode];
+		if (prj.isNull())
+			prj = createProjection(frameType, refractionMode);
+		return prj;
+	}
+	return createProjection(frameType, refractionMode);
+}
+
+StelProjectorP StelCore::createProjection(FrameType frameType, RefractionMode refractionMode) const
 {
 	switch (frameType)
 	{
@@ -464,6 +481,7 @@ SphericalCap StelCore::getVisibleSkyArea() const
 void StelCore::setClippingPlanes(double znear, double zfar)
 {
 	currentProjectorParams.zNear=znear;currentProjectorParams.zFar=zfar;
+	invalidateProjectionCache();
 }
 
 void StelCore::getClippingPlanes(double* zn, double* zf) const
@@ -479,6 +497,7 @@ void StelCore::windowHasBeenResized(float x, float y, float width, float height)
 	currentProjectorParams.viewportXywh.set(x, y, width, height);
 	currentProjectorParams.viewportCenter.set(x+(0.5+currentProjectorParams.viewportCenterOffset.v[0])*width, y+(0.5+currentProjectorParams.viewportCenterOffset.v[1])*height);
 	currentProjectorParams.viewportFovDiameter = qMin(width,height);
+	invalidateProjectionCache();
 }
 
 /*************************************************************************
@@ -496,6 +515,7 @@ void StelCore::update(double deltaTime)
 	movementMgr->updateMotion(deltaTime);
 
 	currentProjectorParams.fov = movementMgr->getCurrentFov();
+	invalidateProjectionCache();
 
 	skyDrawer->update(deltaTime);
 }
@@ -511,6 +531,10 @@ void StelCore::preDraw()
 	currentProjectorParams.zFar = 500.;
 
 	skyDrawer->preDraw();
+
+	// From now on the view and the projection parameters only change in the setters, which clear the cache
+	invalidateProjectionCache();
+	projectionCacheEnabled = true;
 }
 
 
@@ -521,6 +545,16 @@ void StelCore::postDraw()
 {
 	StelPainter sPainter(getProjection(StelCore::FrameJ2000));
 	sPainter.drawViewportShape();
+
+	projectionCacheEnabled = false;
+	invalidateProjectionCache();
+}
+
+void StelCore::invalidateProjectionCache()
+{
+	for (int f=0; f<=FrameSupergalactic; ++f)
+		for (int r=0; r<=RefractionOff; ++r)
+			projectionCache[f][r].clear();
 }
 
 void StelCore::updateMaximumFov()
@@ -530,6 +564,7 @@ void StelCore::updateMaximumFov()
 	double newMaxFov = getProjection(StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(Mat4d::identity())))->getMaxFov();
 	movementMgr->setMaxFov(newMaxFov);
 	currentProjectorParams.fov = qMin(newMaxFov, savedFov);
+	invalidateProjectionCache();
 }
 
 void StelCore::setCurrentProjectionType(ProjectionType type)
@@ -587,16 +622,27 @@ QStringList StelCore::getAllProjectionTypeKeys() const
 void StelCore::setMaskType(StelProjector::StelProjectorMaskType m)
 {
 	currentProjectorParams.maskType = m;
+	invalidateProjectionCache();
+}
+
+void StelCore::setViewportClip(const StelProjector::ViewportClip& clip)
+{
+	if (currentProjectorParams.viewportClip==clip)
+		return;
+	currentProjectorParams.viewportClip = clip;
+	invalidateProjectionCache();
 }
 
 void StelCore::setFlagGravityLabels(bool gravity)
 {
 	currentProjectorParams.gravityLabels = gravity;
+	invalidateProjectionCache();
 }
 
 void StelCore::setDefaultAngleForGravityText(float a)
 {
 	currentProjectorParams.defaultAngleForGravityText = a;
+	invalidateProjectionCache();
 }
 
 void StelCore::setFlipHorz(bool flip)
@@ -604,6 +650,7 @@ void StelCore::setFlipHorz(bool flip)
 	if (currentProjectorParams.flipHorz != flip)
 	{
 		currentProjectorParams.flipHorz = flip;
+		invalidateProjectionCache();
 		emit flipHorzChanged(flip);
 	}
 }
@@ -613,6 +660,7 @@ void StelCore::setFlipVert(bool flip)
 	if (currentProjectorParams.flipVert != flip)
 	{
 		currentProjectorParams.flipVert = flip;
+		invalidateProjectionCache();
 		emit flipVertChanged(flip);
 	}
 }
@@ -638,6 +686,7 @@ void StelCore::setViewportHorizontalOffset(double newOffsetPct)
 	currentProjectorParams.viewportCenterOffset[0]=0.01f* qBound(-50., newOffsetPct, 50.);
 	currentProjectorParams.viewportCenter.set(currentProjectorParams.viewportXywh[0]+(0.5f+currentProjectorParams.viewportCenterOffset.v[0])*currentProjectorParams.viewportXywh[2],
 						currentProjectorParams.viewportXywh[1]+(0.5f+currentProjectorParams.viewportCenterOffset.v[1])*currentProjectorParams.viewportXywh[3]);
+	invalidateProjectionCache();
 }
 
 // Get current value for vertical viewport offset [-50...50]
@@ -651,6 +700,7 @@ void StelCore::setViewportVerticalOffset(double newOffsetPct)
 	currentProjectorParams.viewportCenterOffset[1]=0.01f* qBound(-50., newOffsetPct, 50.);
 	currentProjectorParams.viewportCenter.set(currentProjectorParams.viewportXywh[0]+(0.5f+currentProjectorParams.viewportCenterOffset.v[0])*currentProjectorParams.viewportXywh[2],
 						currentProjectorParams.viewportXywh[1]+(0.5f+currentProjectorParams.viewportCenterOffset.v[1])*currentProjectorParams.viewportXywh[3]);
+	invalidateProjectionCache();
 }
 
 // Set both viewport offsets. Arguments will be clamped to be inside [-50...50]. I (GZ) hope this will avoid some of the shaking.
@@ -660,11 +710,13 @@ void StelCore::setViewportOffset(double newHorizontalOffsetPct, double newVertic
 	currentProjectorParams.viewportCenterOffset[1]=0.01f* qBound(-50., newVerticalOffsetPct,   50.);
 	currentProjectorParams.viewportCenter.set(currentProjectorParams.viewportXywh[0]+(0.5f+currentProjectorParams.viewportCenterOffset.v[0])*currentProjectorParams.viewportXywh[2],
 						currentProjectorParams.viewportXywh[1]+(0.5f+currentProjectorParams.viewportCenterOffset.v[1])*currentProjectorParams.viewportXywh[3]);
+	invalidateProjectionCache();
 }
 
 void StelCore::setViewportStretch(float stretch)
 {
 	currentProjectorParams.widthStretch=qMax(0.001f, stretch);
+	invalidateProjectionCache();
 }
 
 QString StelCore::getDefaultLocationID() const
@@ -700,6 +752,7 @@ StelProjector::StelProjectorParams StelCore::getCurrentStelProjectorParams() con
 void StelCore::setCurrentStelProjectorParams(const StelProjector::StelProjectorParams& newParams)
 {
 	currentProjectorParams=newParams;
+	invalidateProjectionCache();
 }
 
 void StelCore::lookAtJ2000(const Vec3d& pos, const Vec3d& aup)
@@ -719,6 +772,7 @@ void StelCore::lookAtJ2000(const Vec3d& pos, const Vec3d& aup)
 			      s[2],u[2],-f[2],0.,
 			      0.,0.,0.,1.);
 	invertMatAltAzModelView = matAltAzModelView.inverse();
+	invalidateProjectionCache();
 }
 
 Vec3d StelCore::altAzToEquinoxEqu(const Vec3d& v, RefractionMode refMode) const
@@ -761,6 +815,15 @@ Vec3d StelCore::j2000ToAltAz(const Vec3d& v, RefractionMode refMode) const
 	return r;
 }
 
+void StelCore::j2000ToAltAz(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode) const
+{
+	for (int i=0; i<n; ++i)
+		out[i] = matJ2000ToAltAz*in[i];
+	if (refMode==RefractionOff || skyDrawer==Q_NULLPTR || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
+		return;
+	skyDrawer->getRefraction().forward(n, out);
+}
+
 Vec3d StelCore::galacticToJ2000(const Vec3d& v) const
 {
 	return matGalacticToJ2000*v;
@@ -997,6 +1060,8 @@ void StelCore::updateTransformMatrices()
 		matAltAzToHeliocentricEclipticJ2000 =  Mat4d::translation(position->getCenterVsop87Pos()) * tmp;
 		matHeliocentricEclipticJ2000ToAltAz =  tmp.transpose() * Mat4d::translation(-position->getCenterVsop87Pos());
 	}
+
+	invalidateProjectionCache();
 }
 
 // Return the observer heliocentric position
@@ -216,6 +216,9 @@ public:
 	Vec3d equinoxEquToAltAz(const Vec3d& v, RefractionMode refMode=RefractionAuto) const;
 	Vec3d altAzToJ2000(const Vec3d& v, RefractionMode refMode=RefractionAuto) const;
 	Vec3d j2000ToAltAz(const Vec3d& v, RefractionMode refMode=RefractionAuto) const;
+	//! Transform n vectors from J2000 to altazimuthal frame, e.g. the vertices of a mesh. in and out may be the same array.
+	//! The refraction is applied with the faster approximation of Refraction::forward(int, Vec3d*).
+	void j2000ToAltAz(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode=RefractionAuto) const;
 	void j2000ToAltAzInPlaceNoRefraction(Vec3f* v) const {v->transfo4d(matJ2000ToAltAz);}
 	Vec3d galacticToJ2000(const Vec3d& v) const;
 	Vec3d supergalacticToJ2000(const Vec3d& v) const;
@@ -382,6 +385,13 @@ public slots:
 	//! Set the mask type.
 	void setMaskType(StelProjector::StelProjectorMaskType m);
 
+	//! Set the part of the viewport which is not masked, e.g. by the Oculars plugin.
+	//! The sky modules then only process the objects inside this footprint.
+	//! Use a default constructed ViewportClip to clear it.
+	void setViewportClip(const StelProjector::ViewportClip& clip);
+	//! Get the part of the viewport which is not masked.
+	const StelProjector::ViewportClip& getViewportClip() const {return currentProjectorParams.viewportClip;}
+
 	//! Set the flag with decides whether to arrage labels so that
 	//! they are aligned with the bottom of a 2d screen, or a 3d dome.
 	void setFlagGravityLabels(bool gravity);
@@ -822,6 +832,13 @@ private:
 	bool de431Available; // ephem file found
 	bool de430Active;    // available and user-activated.
 	bool de431Active;    // available and user-activated.
+
+	// Projectors returned by getProjection(FrameType, RefractionMode) during the drawing of a frame.
+	// They are created once per frame and reused, unless the state they depend on changes.
+	StelProjectorP createProjection(FrameType frameType, RefractionMode refractionMode) const;
+	void invalidateProjectionCache();
+	mutable StelProjectorP projectionCache[FrameSupergalactic+1][RefractionOff+1];
+	bool projectionCacheEnabled;
 };
 
 #endif // _STELCORE_HPP_
@@ -0,0 +1,367 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelInflateDevice.hpp"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QVector>
+#include <QtEndian>
+#include <QtConcurrent>
+
+#include <cstring>
+#include <climits>
+#include <zlib.h>
+
+// buffer size 256k, zlib recommended size
+static const int CHUNK = 262144;
+
+// Size of the gzip header written by compressChunked(): 10 bytes fixed header, 2 bytes XLEN,
+// and one extra subfield 'S','C' of 4 bytes holding the compressed size of the member.
+static const int CHUNK_HEADER_SIZE = 20;
+// Minimum size of a gzip member: header and 8 bytes trailer (CRC32, ISIZE)
+static const int CHUNK_MIN_SIZE = CHUNK_HEADER_SIZE + 8;
+
+StelInflateDevice::StelInflateDevice(QIODevice* source, qint64 maxBytes, QObject* parent)
+	: QIODevice(parent)
+	, source(source)
+	, maxBytes(maxBytes)
+	, bytesRead(0)
+	, strm(Q_NULLPTR)
+	, outPos(0)
+	, multiMember(false)
+	, finished(false)
+	, errorOccured(false)
+{
+}
+
+StelInflateDevice::~StelInflateDevice()
+{
+	if (isOpen())
+		close();
+}
+
+bool StelInflateDevice::open(OpenMode mode)
+{
+	if ((mode & WriteOnly) || !source || !source->isReadable())
+	{
+		setErrorString("StelInflateDevice can only be opened read-only on a readable device");
+		return false;
+	}
+
+	strm = new z_stream;
+	std::memset(strm, 0, sizeof(z_stream));
+	// 15 + 32 for gzip automatic header detection.
+	const int ret = inflateInit2(strm, 15 + 32);
+	if (ret != Z_OK)
+	{
+		qWarning()<<"zlib init error ("<<ret<<"), can't uncompress";
+		delete strm;
+		strm = Q_NULLPTR;
+		return false;
+	}
+
+	inBuffer.resize(CHUNK);
+	outBuffer.clear();
+	outPos = 0;
+	bytesRead = 0;
+	finished = false;
+	errorOccured = false;
+	// The inflated data is already buffered in outBuffer
+	return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+void StelInflateDevice::close()
+{
+	if (strm)
+	{
+		inflateEnd(strm);
+		delete strm;
+		strm = Q_NULLPTR;
+	}
+	inBuffer.clear();
+	outBuffer.clear();
+	outPos = 0;
+	QIODevice::close();
+}
+
+bool StelInflateDevice::atEnd() const
+{
+	if (!isOpen())
+		return true;
+	if (QIODevice::bytesAvailable()>0 || outPos<outBuffer.size())
+		return false;
+	if (finished)
+		return true;
+	// Only inflating tells whether more data follows, e.g. QDataStream::atEnd() relies on this.
+	return !const_cast<StelInflateDevice*>(this)->inflateMore();
+}
+
+qint64 StelInflateDevice::bytesAvailable() const
+{
+	return QIODevice::bytesAvailable() + (outBuffer.size()-outPos);
+}
+
+qint64 StelInflateDevice::readData(char* data, qint64 maxSize)
+{
+	qint64 total = 0;
+	while (total<maxSize)
+	{
+		if (outPos>=outBuffer.size() && (finished || !inflateMore()))
+			break;
+		const int n = (int)qMin(maxSize-total, (qint64)(outBuffer.size()-outPos));
+		std::memcpy(data+total, outBuffer.constData()+outPos, n);
+		outPos += n;
+		total += n;
+	}
+	if (total==0 && errorOccured)
+		return -1;
+	return total;
+}
+
+qint64 StelInflateDevice::writeData(const char* data, qint64 maxSize)
+{
+	Q_UNUSED(data);
+	Q_UNUSED(maxSize);
+	return -1;
+}
+
+bool StelInflateDevice::readInput()
+{
+	qint64 bytesToRead = inBuffer.size();
+	if (maxBytes>=0)
+	{
+		//check if we reach the desired limit with the next read
+		bytesToRead = qMin(bytesToRead, maxBytes-bytesRead);
+	}
+	if (bytesToRead<=0)
+		return false;
+
+	const qint64 read = source->read(inBuffer.data(), bytesToRead);
+	if (read<0)
+	{
+		reportError("Error while reading from device");
+		return false;
+	}
+	if (read==0)
+		return false;
+
+	bytesRead += read;
+	strm->next_in = reinterpret_cast<Bytef*>(inBuffer.data());
+	strm->avail_in = (uInt)read;
+	return true;
+}
+
+bool StelInflateDevice::inflateMore()
+{
+	outPos = 0;
+	outBuffer.resize(CHUNK);
+	strm->next_out = reinterpret_cast<Bytef*>(outBuffer.data());
+	strm->avail_out = CHUNK;
+
+	while (strm->avail_out>0 && !finished)
+	{
+		if (strm->avail_in==0 && !readInput())
+		{
+			if (!errorOccured)
+				reportError("Premature end of compressed stream");
+			break;
+		}
+
+		const int ret = inflate(strm, Z_NO_FLUSH);
+		Q_ASSERT(ret != Z_STREAM_ERROR); // must never happen, indicates a programming error
+		if (ret==Z_STREAM_END)
+		{
+			// Concatenated gzip members: continue with the remaining input
+			if (multiMember && (strm->avail_in>0 || readInput()))
+				inflateReset(strm);
+			else
+				finished = true;
+		}
+		else if (ret!=Z_OK && ret!=Z_BUF_ERROR)
+		{
+			reportError(QString("zlib inflate error (%1): %2").arg(ret).arg(strm->msg ? strm->msg : ""));
+			break;
+		}
+	}
+
+	outBuffer.resize(CHUNK - strm->avail_out);
+	return !outBuffer.isEmpty();
+}
+
+void StelInflateDevice::reportError(const QString& message)
+{
+	qWarning() << "StelInflateDevice:" << message;
+	setErrorString(message);
+	errorOccured = true;
+	finished = true;
+}
+
+QByteArray StelInflateDevice::compressChunked(const QByteArray& data, int chunkSize, int level)
+{
+	Q_ASSERT(chunkSize>0);
+	QByteArray out;
+	int pos = 0;
+	do
+	{
+		z_stream strm;
+		std::memset(&strm, 0, sizeof(z_stream));
+		// 15 + 16 for a gzip header
+		if (deflateInit2(&strm, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY)!=Z_OK)
+			return QByteArray();
+
+		// The member size is patched in after compression
+		unsigned char extra[8] = {'S', 'C', 4, 0, 0, 0, 0, 0};
+		gz_header head;
+		std::memset(&head, 0, sizeof(gz_header));
+		head.extra = extra;
+		head.extra_len = sizeof(extra);
+		head.os = 255; // unknown
+		deflateSetHeader(&strm, &head);
+
+		const int len = qMin(chunkSize, data.size()-pos);
+		const int memberStart = out.size();
+		out.resize(memberStart + (int)deflateBound(&strm, len) + CHUNK_HEADER_SIZE);
+		strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()+pos));
+		strm.avail_in = len;
+		strm.next_out = reinterpret_cast<Bytef*>(out.data()+memberStart);
+		strm.avail_out = out.size()-memberStart;
+		const int ret = deflate(&strm, Z_FINISH);
+		const int memberSize = out.size()-memberStart-strm.avail_out;
+		deflateEnd(&strm);
+		if (ret!=Z_STREAM_END)
+		{
+			qWarning() << "zlib deflate error (" << ret << "), can't compress";
+			return QByteArray();
+		}
+
+		out.resize(memberStart+memberSize);
+		qToLittleEndian<quint32>(memberSize, reinterpret_cast<uchar*>(out.data()+memberStart+16));
+		pos += len;
+	} while (pos<data.size());
+	return out;
+}
+
+// A gzip member written by compressChunked() and the slice of the output it inflates to
+struct InflateChunk
+{
+	const char* in;
+	int inSize;
+	char* out;
+	int outSize;
+	bool ok;
+};
+
+static void inflateChunk(InflateChunk& chunk)
+{
+	z_stream strm;
+	std::memset(&strm, 0, sizeof(z_stream));
+	chunk.ok = false;
+	if (inflateInit2(&strm, 15 + 16)!=Z_OK)
+		return;
+	strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(chunk.in));
+	strm.avail_in = chunk.inSize;
+	strm.next_out = reinterpret_cast<Bytef*>(chunk.out);
+	strm.avail_out = chunk.outSize;
+	// A zero sized output buffer would make inflate() fail before reading the trailer
+	char dummy;
+	if (chunk.outSize==0)
+	{
+		strm.next_out = reinterpret_cast<Bytef*>(&dummy);
+		strm.avail_out = 1;
+	}
+	const int ret = inflate(&strm, Z_FINISH);
+	chunk.ok = (ret==Z_STREAM_END && strm.total_out==(uLong)chunk.outSize);
+	inflateEnd(&strm);
+}
+
+//! Return the compressed size of the gzip member at p as stored by compressChunked(), or 0 for any other data.
+static quint32 chunkMemberSize(const uchar* p, int available)
+{
+	if (available<CHUNK_MIN_SIZE)
+		return 0;
+	// gzip magic, deflate method, FEXTRA flag
+	if (p[0]!=0x1f || p[1]!=0x8b || p[2]!=8 || !(p[3] & 4))
+		return 0;
+	const int xlen = p[10] | (p[11]<<8);
+	if (xlen<8 || p[12]!='S' || p[13]!='C' || p[14]!=4 || p[15]!=0)
+		return 0;
+	return qFromLittleEndian<quint32>(p+16);
+}
+
+QByteArray StelInflateDevice::uncompressChunked(const QByteArray& data)
+{
+	const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+	QVector<InflateChunk> chunks;
+	qint64 totalSize = 0;
+	int pos = 0;
+	while (pos<data.size())
+	{
+		const quint32 memberSize = chunkMemberSize(p+pos, data.size()-pos);
+		if (memberSize<(quint32)CHUNK_MIN_SIZE || memberSize>(quint32)(data.size()-pos))
+		{
+			chunks.clear();
+			break;
+		}
+		InflateChunk chunk;
+		chunk.in = data.constData()+pos;
+		chunk.inSize = memberSize;
+		chunk.out = Q_NULLPTR;
+		// ISIZE: uncompressed size of the member, modulo 2^32. Chunks are always smaller.
+		chunk.outSize = qFromLittleEndian<quint32>(p+pos+memberSize-4);
+		chunk.ok = false;
+		chunks.append(chunk);
+		totalSize += chunk.outSize;
+		pos += memberSize;
+	}
+
+	if (chunks.isEmpty() || totalSize>INT_MAX)
+	{
+		// Not written by compressChunked(): inflate sequentially
+		QByteArray dataNonConst(data);
+		QBuffer buf(&dataNonConst);
+		buf.open(QIODevice::ReadOnly);
+		StelInflateDevice inflater(&buf);
+		inflater.setMultiMember(true);
+		if (!inflater.open(QIODevice::ReadOnly))
+			return QByteArray();
+		const QByteArray out = inflater.readAll();
+		if (inflater.hasError())
+			return QByteArray();
+		return out;
+	}
+
+	QByteArray out((int)totalSize, Qt::Uninitialized);
+	int outPos = 0;
+	for (int i=0; i<chunks.size(); ++i)
+	{
+		chunks[i].out = out.data()+outPos;
+		outPos += chunks.at(i).outSize;
+	}
+	QtConcurrent::blockingMap(chunks, inflateChunk);
+	foreach (const InflateChunk& chunk, chunks)
+	{
+		if (!chunk.ok)
+		{
+			qWarning() << "StelInflateDevice: invalid chunk in compressed data";
+			return QByteArray();
+		}
+	}
+	return out;
+}
@@ -0,0 +1,103 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELINFLATEDEVICE_HPP_
+#define _STELINFLATEDEVICE_HPP_
+
+#include <QIODevice>
+#include <QByteArray>
+
+struct z_stream_s;
+
+//! @class StelInflateDevice
+//! A sequential, read-only QIODevice which decompresses gzip or zlib data from another device on the fly.
+//! Unlike StelUtils::uncompress(), the decompressed data is never held in memory as a whole: a QDataStream or
+//! QTextStream working on this device parses each chunk as soon as it has been inflated.
+//! @code
+//! QFile file("catalog.dat");
+//! file.open(QIODevice::ReadOnly);
+//! StelInflateDevice inflater(&file);
+//! inflater.open(QIODevice::ReadOnly);
+//! QDataStream in(&inflater);
+//! @endcode
+//! The class also provides helpers for a chunked gzip layout, where a large file is split into independent
+//! gzip members which carry their compressed size in the header. Such files remain valid gzip files
+//! (@c gunzip decompresses them as usual), but can be decompressed in parallel with uncompressChunked().
+class StelInflateDevice : public QIODevice
+{
+	Q_OBJECT
+public:
+	//! @param source the device to read compressed data from, which must be open and readable.
+	//! It is not owned by the StelInflateDevice and must outlive it.
+	//! @param maxBytes the max. amount of bytes to read from source, or -1 to read until EOF.
+	StelInflateDevice(QIODevice* source, qint64 maxBytes=-1, QObject* parent=Q_NULLPTR);
+	virtual ~StelInflateDevice();
+
+	//! Set whether to continue with the next member when a gzip member ends and more data follows
+	//! (concatenated gzip files, as written by compressChunked()). The default is to stop after
+	//! the first member like StelUtils::uncompress() does. Must be set before open().
+	void setMultiMember(bool b) {multiMember=b;}
+	bool getMultiMember() const {return multiMember;}
+
+	//! Only QIODevice::ReadOnly is supported.
+	virtual bool open(OpenMode mode) Q_DECL_OVERRIDE;
+	virtual void close() Q_DECL_OVERRIDE;
+	virtual bool isSequential() const Q_DECL_OVERRIDE {return true;}
+	virtual bool atEnd() const Q_DECL_OVERRIDE;
+	virtual qint64 bytesAvailable() const Q_DECL_OVERRIDE;
+
+	//! Return true if the compressed data was invalid or truncated. See errorString() for details.
+	bool hasError() const {return errorOccured;}
+
+	//! Compress data as a sequence of independent gzip members of chunkSize uncompressed bytes each.
+	//! Each member header contains its compressed size, so that uncompressChunked() can locate all
+	//! members without inflating them first.
+	//! @param level the zlib compression level (0-9, or -1 for the default).
+	static QByteArray compressChunked(const QByteArray& data, int chunkSize=4*1024*1024, int level=-1);
+
+	//! Uncompress gzip data. If the data has been written by compressChunked(), the members are inflated
+	//! in parallel using the global thread pool directly into the preallocated result.
+	//! Any other gzip or zlib data is inflated sequentially, including all members of concatenated gzip files.
+	//! @return the uncompressed data, or an empty array in case of error.
+	static QByteArray uncompressChunked(const QByteArray& data);
+
+protected:
+	virtual qint64 readData(char* data, qint64 maxSize) Q_DECL_OVERRIDE;
+	virtual qint64 writeData(const char* data, qint64 maxSize) Q_DECL_OVERRIDE;
+
+private:
+	//! Read the next block of compressed data from the source. Return false if there is none.
+	bool readInput();
+	//! Inflate the next block of data into outBuffer. Return false if no data was produced.
+	bool inflateMore();
+	void reportError(const QString& message);
+
+	QIODevice* source;
+	qint64 maxBytes;
+	qint64 bytesRead;
+	z_stream_s* strm;
+	QByteArray inBuffer;
+	QByteArray outBuffer;
+	int outPos;
+	bool multiMember;
+	bool finished;
+	bool errorOccured;
+};
+
+#endif // _STELINFLATEDEVICE_HPP_
@@ -0,0 +1,325 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelIniCache.hpp"
+#include "StelIniParser.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QSaveFile>
+#include <QVector>
+
+// "INIC" in native byte order, so that a file written on another architecture is regenerated
+static const quint32 INI_CACHE_MAGIC = 0x494e4943;
+// Increment each time the layout of the binary file changes
+static const quint32 INI_CACHE_VERSION = 1;
+
+// The binary file is made of a Header, the sorted Sections, the Entries of each section sorted by key,
+// and a pool of UTF-16 strings referenced by offset and size.
+struct StelIniCache::StringRef
+{
+	quint32 offset;
+	quint32 size;
+};
+
+struct StelIniCache::Header
+{
+	quint32 magic;
+	quint32 version;
+	qint64 sourceSize;
+	qint64 sourceModified;
+	quint32 sectionCount;
+	quint32 entryCount;
+	quint32 stringSize;
+	quint32 reserved;
+};
+
+struct StelIniCache::Section
+{
+	StringRef name;
+	quint32 firstEntry;
+	quint32 entryCount;
+};
+
+struct StelIniCache::Entry
+{
+	StringRef key;
+	StringRef value;
+};
+
+StelIniCache::StelIniCache(const QString& iniFilePath, const QString& cacheDir)
+	: fileStatus(QSettings::NoError)
+	, loadedFromCache(false)
+	, header(Q_NULLPTR)
+	, sections(Q_NULLPTR)
+	, entries(Q_NULLPTR)
+	, strings(Q_NULLPTR)
+{
+	const QFileInfo info(iniFilePath);
+	const qint64 sourceSize = info.size();
+	const qint64 sourceModified = info.lastModified().toMSecsSinceEpoch();
+
+	if (!cacheDir.isEmpty())
+	{
+		const QByteArray pathHash = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+		cacheFilePath = cacheDir + "/" + info.completeBaseName() + "-" + pathHash.left(16) + ".bin";
+		cacheFile.setFileName(cacheFilePath);
+		if (info.exists() && cacheFile.open(QIODevice::ReadOnly))
+		{
+			const qint64 size = cacheFile.size();
+			const uchar* mapped = size>0 ? cacheFile.map(0, size) : Q_NULLPTR;
+			if (mapped)
+			{
+				// The mapping stays valid while cacheFile exists
+				if (setData(reinterpret_cast<const char*>(mapped), size, sourceSize, sourceModified))
+				{
+					loadedFromCache = true;
+					return;
+				}
+			}
+			else
+			{
+				data = cacheFile.readAll();
+				if (setData(data.constData(), data.size(), sourceSize, sourceModified))
+				{
+					loadedFromCache = true;
+					cacheFile.close();
+					return;
+				}
+			}
+			cacheFile.close();
+		}
+	}
+
+	QSettings::SettingsMap map;
+	QFile file(iniFilePath);
+	if (file.open(QIODevice::ReadOnly))
+	{
+		readStelIniFile(file, map);
+		file.close();
+	}
+	else
+	{
+		qWarning() << "Cannot read" << QDir::toNativeSeparators(iniFilePath);
+		fileStatus = QSettings::AccessError;
+	}
+
+	data = compile(map, sourceSize, sourceModified);
+	const bool ok = setData(data.constData(), data.size(), sourceSize, sourceModified);
+	Q_ASSERT(ok);
+	Q_UNUSED(ok);
+	if (fileStatus!=QSettings::NoError || cacheFilePath.isEmpty())
+		return;
+
+	QSaveFile out(cacheFilePath);
+	if (!QDir().mkpath(cacheDir) || !out.open(QIODevice::WriteOnly) || out.write(data)!=data.size() || !out.commit())
+		qWarning() << "Cannot write ini cache" << QDir::toNativeSeparators(cacheFilePath);
+}
+
+StelIniCache::~StelIniCache()
+{
+}
+
+QByteArray StelIniCache::compile(const QSettings::SettingsMap& map, qint64 sourceSize, qint64 sourceModified)
+{
+	// Group the keys by section. Keys without section are in the section "".
+	QMap<QString, QMap<QString, QString> > groups;
+	for (QSettings::SettingsMap::const_iterator it=map.constBegin(); it!=map.constEnd(); ++it)
+	{
+		const int slash = it.key().indexOf('/');
+		if (slash<0)
+			groups[QString("")].insert(it.key(), it.value().toString());
+		else
+			groups[it.key().left(slash)].insert(it.key().mid(slash+1), it.value().toString());
+	}
+
+	// Identical strings, like the many repeated values, are stored once
+	QString pool;
+	QHash<QString, StringRef> pooled;
+	auto addString = [&pool, &pooled](const QString& s) -> StringRef
+	{
+		QHash<QString, StringRef>::const_iterator it = pooled.constFind(s);
+		if (it!=pooled.constEnd())
+			return it.value();
+		StringRef r = {(quint32)pool.size(), (quint32)s.size()};
+		pool += s;
+		pooled.insert(s, r);
+		return r;
+	};
+
+	QVector<Section> secs;
+	QVector<Entry> ents;
+	secs.reserve(groups.size());
+	ents.reserve(map.size());
+	for (QMap<QString, QMap<QString, QString> >::const_iterator g=groups.constBegin(); g!=groups.constEnd(); ++g)
+	{
+		Section s = {addString(g.key()), (quint32)ents.size(), (quint32)g.value().size()};
+		secs.append(s);
+		for (QMap<QString, QString>::const_iterator it=g.value().constBegin(); it!=g.value().constEnd(); ++it)
+		{
+			Entry e = {addString(it.key()), addString(it.value())};
+			ents.append(e);
+		}
+	}
+
+	Header h = {INI_CACHE_MAGIC, INI_CACHE_VERSION, sourceSize, sourceModified,
+		    (quint32)secs.size(), (quint32)ents.size(), (quint32)pool.size(), 0};
+	QByteArray res;
+	res.reserve(sizeof(Header) + secs.size()*sizeof(Section) + ents.size()*sizeof(Entry) + pool.size()*sizeof(QChar));
+	res.append(reinterpret_cast<const char*>(&h), sizeof(Header));
+	res.append(reinterpret_cast<const char*>(secs.constData()), secs.size()*sizeof(Section));
+	res.append(reinterpret_cast<const char*>(ents.constData()), ents.size()*sizeof(Entry));
+	res.append(reinterpret_cast<const char*>(pool.constData()), pool.size()*sizeof(QChar));
+	return res;
+}
+
+bool StelIniCache::setData(const char* d, qint64 size, qint64 sourceSize, qint64 sourceModified)
+{
+	if (size<(qint64)sizeof(Header))
+		return false;
+	const Header* h = reinterpret_cast<const Header*>(d);
+	if (h->magic!=INI_CACHE_MAGIC || h->version!=INI_CACHE_VERSION || h->sourceSize!=sourceSize || h->sourceModified!=sourceModified)
+		return false;
+	const quint64 expectedSize = sizeof(Header) + (quint64)h->sectionCount*sizeof(Section) + (quint64)h->entryCount*sizeof(Entry) + (quint64)h->stringSize*sizeof(QChar);
+	if ((quint64)size!=expectedSize)
+		return false;
+
+	const Section* s = reinterpret_cast<const Section*>(d+sizeof(Header));
+	const Entry* e = reinterpret_cast<const Entry*>(s+h->sectionCount);
+
+	// A damaged file must not make us read outside of it
+	for (quint32 i=0; i<h->sectionCount; ++i)
+	{
+		if ((quint64)s[i].name.offset+s[i].name.size>h->stringSize || (quint64)s[i].firstEntry+s[i].entryCount>h->entryCount)
+			return false;
+	}
+	for (quint32 i=0; i<h->entryCount; ++i)
+	{
+		if ((quint64)e[i].key.offset+e[i].key.size>h->stringSize || (quint64)e[i].value.offset+e[i].value.size>h->stringSize)
+			return false;
+	}
+
+	header = h;
+	sections = s;
+	entries = e;
+	strings = reinterpret_cast<const QChar*>(e+h->entryCount);
+	return true;
+}
+
+QString StelIniCache::string(const StringRef& r) const
+{
+	return QString(strings+r.offset, r.size);
+}
+
+// Same order as QString::operator<, which sorted the data
+int StelIniCache::compare(const StringRef& r, const QChar* s, int len) const
+{
+	const QChar* a = strings+r.offset;
+	const int n = qMin((int)r.size, len);
+	for (int i=0; i<n; ++i)
+	{
+		if (a[i]!=s[i])
+			return a[i].unicode()<s[i].unicode() ? -1 : 1;
+	}
+	return (int)r.size-len;
+}
+
+const StelIniCache::Section* StelIniCache::findSection(const QChar* name, int len) const
+{
+	int lo = 0;
+	int hi = header->sectionCount;
+	while (lo<hi)
+	{
+		const int mid = (lo+hi)/2;
+		const int c = compare(sections[mid].name, name, len);
+		if (c==0)
+			return sections+mid;
+		if (c<0)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	return Q_NULLPTR;
+}
+
+const StelIniCache::Entry* StelIniCache::findEntry(const QString& key) const
+{
+	const int slash = key.indexOf('/');
+	const Section* s = slash<0 ? findSection(Q_NULLPTR, 0) : findSection(key.constData(), slash);
+	if (!s)
+		return Q_NULLPTR;
+	const QChar* k = key.constData()+slash+1;
+	const int len = key.size()-slash-1;
+	int lo = s->firstEntry;
+	int hi = s->firstEntry+s->entryCount;
+	while (lo<hi)
+	{
+		const int mid = (lo+hi)/2;
+		const int c = compare(entries[mid].key, k, len);
+		if (c==0)
+			return entries+mid;
+		if (c<0)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	return Q_NULLPTR;
+}
+
+QStringList StelIniCache::childGroups() const
+{
+	QStringList res;
+	res.reserve(header->sectionCount);
+	for (quint32 i=0; i<header->sectionCount; ++i)
+	{
+		if (sections[i].name.size>0)
+			res << string(sections[i].name);
+	}
+	return res;
+}
+
+QStringList StelIniCache::childKeys(const QString& group) const
+{
+	QStringList res;
+	const Section* s = findSection(group.constData(), group.size());
+	if (!s)
+		return res;
+	res.reserve(s->entryCount);
+	for (quint32 i=0; i<s->entryCount; ++i)
+		res << string(entries[s->firstEntry+i].key);
+	return res;
+}
+
+bool StelIniCache::contains(const QString& key) const
+{
+	return findEntry(key)!=Q_NULLPTR;
+}
+
+QVariant StelIniCache::value(const QString& key, const QVariant& defaultValue) const
+{
+	const Entry* e = findEntry(key);
+	if (!e)
+		return defaultValue;
+	return QVariant(string(e->value));
+}
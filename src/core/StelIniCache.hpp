@@ -0,0 +1,96 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELINICACHE_HPP_
+#define _STELINICACHE_HPP_
+
+#include <QByteArray>
+#include <QFile>
+#include <QSettings>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+//! @class StelIniCache
+//! Read-only access to an ini file in StelIniFormat through a compiled binary copy of it.
+//! Parsing a big ini file like ssystem_minor.ini with QSettings takes most of the time spent loading it.
+//! The first time a file is read, StelIniCache parses it with readStelIniFile() and writes its sections and keys,
+//! sorted, into a binary file of the cache directory. Later this file is memory mapped and searched in place, as long
+//! as the size and modification time of the ini file did not change. Otherwise it is regenerated.
+//! The interface is the subset of QSettings used for reading such files:
+//! @code
+//! StelIniCache pd(StelFileMgr::findFile("data/ssystem_minor.ini"), StelFileMgr::getCacheDir()+"/ini");
+//! foreach (const QString& section, pd.childGroups())
+//! 	double e = pd.value(section+"/orbit_Eccentricity", 0.).toDouble();
+//! @endcode
+class StelIniCache
+{
+public:
+	//! @param iniFilePath the ini file to read.
+	//! @param cacheDir the directory of the binary files. If empty, the ini file is parsed each time.
+	StelIniCache(const QString& iniFilePath, const QString& cacheDir);
+	~StelIniCache();
+
+	//! Return QSettings::AccessError if the ini file can't be read, else QSettings::NoError.
+	QSettings::Status status() const {return fileStatus;}
+	//! Return true if the binary file was up to date, i.e. the ini file was not parsed.
+	bool isLoadedFromCache() const {return loadedFromCache;}
+	//! Return the path of the binary file of the ini file, or an empty string if there is no cache directory.
+	QString getCacheFilePath() const {return cacheFilePath;}
+
+	//! Return the names of the sections, sorted.
+	QStringList childGroups() const;
+	//! Return the names of the keys of a section, sorted.
+	QStringList childKeys(const QString& group) const;
+	//! Return true if the key exists. Keys have the form "section/key" like in QSettings.
+	bool contains(const QString& key) const;
+	//! Return the value of a key as a string QVariant, or defaultValue if the key doesn't exist.
+	QVariant value(const QString& key, const QVariant& defaultValue=QVariant()) const;
+
+	//! Build the binary representation of an ini file which was parsed by readStelIniFile().
+	static QByteArray compile(const QSettings::SettingsMap& map, qint64 sourceSize, qint64 sourceModified);
+
+private:
+	struct Header;
+	struct StringRef;
+	struct Section;
+	struct Entry;
+
+	//! Point to the binary data if it is valid for the given source file, return false otherwise
+	bool setData(const char* d, qint64 size, qint64 sourceSize, qint64 sourceModified);
+	const Section* findSection(const QChar* name, int len) const;
+	const Entry* findEntry(const QString& key) const;
+	QString string(const StringRef& r) const;
+	int compare(const StringRef& r, const QChar* s, int len) const;
+
+	QSettings::Status fileStatus;
+	bool loadedFromCache;
+	QString cacheFilePath;
+	//! The mapped binary file
+	QFile cacheFile;
+	//! The binary data when the file could not be mapped or was regenerated
+	QByteArray data;
+
+	const Header* header;
+	const Section* sections;
+	const Entry* entries;
+	const QChar* strings;
+};
+
+#endif // _STELINICACHE_HPP_
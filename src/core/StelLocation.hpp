@@ -22,6 +22,8 @@
 #include <QString>
 #include <QMetaType>
 
+#include <cmath>
+
 //! @class StelLocation
 //! Store the informations for a location on a planet
 class StelLocation
@@ -81,7 +83,14 @@ public:
 	static StelLocation createFromLine(const QString& line);
 
 	//! Compute great-circle distance between two locations
-	static float distanceDegrees(const float long1, const float lat1, const float long2, const float lat2);
+	//! Inline, so that StelLocationDB does not depend on this class's translation unit.
+	static float distanceDegrees(const float long1, const float lat1, const float long2, const float lat2)
+	{
+		const float DEGREES=M_PI/180.0f;
+		return std::acos( std::sin(lat1*DEGREES)*std::sin(lat2*DEGREES) +
+				  std::cos(lat1*DEGREES)*std::cos(lat2*DEGREES) *
+				  std::cos((long1-long2)*DEGREES) ) / DEGREES;
+	}
 
 	//! Used privately by the StelLocationMgr
 	bool isUserLocation;
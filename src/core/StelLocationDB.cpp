@@ -0,0 +1,466 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelLocationDB.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QHash>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const quint32 LOCATION_DB_MAGIC = 0x42444c53; // "SLDB"
+static const quint32 LOCATION_DB_VERSION = 1;
+
+const int StelLocationDB::GRID_ROWS;
+const int StelLocationDB::GRID_COLS;
+
+// All offsets are in bytes from the start of the data, except string offsets which are
+// relative to stringsOffset. All sections are 4 bytes aligned.
+struct StelLocationDB::Header
+{
+	quint32 magic;
+	quint32 version;
+	quint32 count;
+	quint32 signatureOffset;
+	quint32 signatureSize;
+	quint32 recordsOffset;      //!< count Records, sorted by location ID
+	quint32 nameIndexOffset;    //!< count record numbers, sorted by name (case insensitive)
+	quint32 gridOffset;         //!< GRID_ROWS*GRID_COLS+1 start positions in the grid records
+	quint32 gridRecordsOffset;  //!< count record numbers, grouped by grid cell
+	quint32 stringsOffset;      //!< strings: quint32 length in QChars followed by the UTF-16 data, padded to 4 bytes
+	quint32 stringsSize;
+};
+
+struct StelLocationDB::Record
+{
+	float longitude;
+	float latitude;
+	qint32 altitude;
+	qint32 population;
+	float bortleScaleIndex;
+	quint32 id;
+	quint32 name;
+	quint32 state;
+	quint32 country;
+	quint32 planetName;
+	quint32 landscapeKey;
+	quint32 ianaTimeZone;
+	quint16 role;
+	quint16 isUserLocation;
+};
+
+namespace
+{
+	//! Append a string to the string table unless it is already there, return its offset.
+	quint32 addString(QByteArray& strings, QHash<QString, quint32>& offsets, const QString& s)
+	{
+		QHash<QString, quint32>::const_iterator it = offsets.constFind(s);
+		if (it!=offsets.constEnd())
+			return it.value();
+		const quint32 offset = strings.size();
+		const quint32 length = s.size();
+		strings.append(reinterpret_cast<const char*>(&length), sizeof(length));
+		strings.append(reinterpret_cast<const char*>(s.constData()), length*sizeof(QChar));
+		if (length%2)
+			strings.append(2, '\0');
+		offsets.insert(s, offset);
+		return offset;
+	}
+
+	void appendAligned(QByteArray& out, const char* data, int size)
+	{
+		out.append(data, size);
+		while (out.size()%4)
+			out.append('\0');
+	}
+
+	//! Sort order of the name index
+	struct NameLess
+	{
+		const QVector<QString>* names;
+		bool operator()(quint32 a, quint32 b) const
+		{
+			const int c = QString::compare(names->at(a), names->at(b), Qt::CaseInsensitive);
+			return c<0 || (c==0 && a<b);
+		}
+	};
+}
+
+StelLocationDB::StelLocationDB()
+	: data(Q_NULLPTR)
+	, dataSize(0)
+	, header(Q_NULLPTR)
+{
+}
+
+StelLocationDB::~StelLocationDB()
+{
+	close();
+}
+
+int StelLocationDB::gridRow(float latitude)
+{
+	return qBound(0, (int)std::floor(latitude+90.f), GRID_ROWS-1);
+}
+
+int StelLocationDB::gridCol(float longitude)
+{
+	int col = (int)std::floor(longitude+180.f) % GRID_COLS;
+	if (col<0)
+		col += GRID_COLS;
+	return col;
+}
+
+QByteArray StelLocationDB::serialize(const QMap<QString, StelLocation>& locations, const QByteArray& signature)
+{
+	const int count = locations.size();
+	QByteArray strings;
+	QHash<QString, quint32> stringOffsets;
+	QVector<Record> records;
+	QVector<QString> names;
+	QVector<int> cells;
+	records.reserve(count);
+	names.reserve(count);
+	cells.reserve(count);
+
+	// QMap iterates in key order, so the records are sorted by ID
+	for (QMap<QString, StelLocation>::const_iterator it=locations.constBegin(); it!=locations.constEnd(); ++it)
+	{
+		const StelLocation& loc = it.value();
+		Record r;
+		std::memset(&r, 0, sizeof(Record));
+		r.longitude = loc.longitude;
+		r.latitude = loc.latitude;
+		r.altitude = loc.altitude;
+		r.population = loc.population;
+		r.bortleScaleIndex = loc.bortleScaleIndex;
+		r.id = addString(strings, stringOffsets, it.key());
+		r.name = addString(strings, stringOffsets, loc.name);
+		r.state = addString(strings, stringOffsets, loc.state);
+		r.country = addString(strings, stringOffsets, loc.country);
+		r.planetName = addString(strings, stringOffsets, loc.planetName);
+		r.landscapeKey = addString(strings, stringOffsets, loc.landscapeKey);
+		r.ianaTimeZone = addString(strings, stringOffsets, loc.ianaTimeZone);
+		r.role = loc.role.unicode();
+		r.isUserLocation = loc.isUserLocation;
+		records.append(r);
+		names.append(loc.name);
+		cells.append(gridRow(loc.latitude)*GRID_COLS+gridCol(loc.longitude));
+	}
+
+	QVector<quint32> nameIndex(count);
+	for (int i=0; i<count; ++i)
+		nameIndex[i] = i;
+	NameLess nameLess = {&names};
+	std::sort(nameIndex.begin(), nameIndex.end(), nameLess);
+
+	// Counting sort of the record numbers by grid cell
+	QVector<quint32> grid(GRID_ROWS*GRID_COLS+1, 0);
+	for (int i=0; i<count; ++i)
+		++grid[cells.at(i)+1];
+	for (int c=0; c<GRID_ROWS*GRID_COLS; ++c)
+		grid[c+1] += grid[c];
+	QVector<quint32> gridRecords(count);
+	QVector<quint32> fill(grid);
+	for (int i=0; i<count; ++i)
+		gridRecords[fill[cells.at(i)]++] = i;
+
+	Header h;
+	std::memset(&h, 0, sizeof(Header));
+	QByteArray out(sizeof(Header), '\0');
+	h.magic = LOCATION_DB_MAGIC;
+	h.version = LOCATION_DB_VERSION;
+	h.count = count;
+	h.signatureOffset = out.size();
+	h.signatureSize = signature.size();
+	appendAligned(out, signature.constData(), signature.size());
+	h.recordsOffset = out.size();
+	appendAligned(out, reinterpret_cast<const char*>(records.constData()), count*sizeof(Record));
+	h.nameIndexOffset = out.size();
+	appendAligned(out, reinterpret_cast<const char*>(nameIndex.constData()), count*sizeof(quint32));
+	h.gridOffset = out.size();
+	appendAligned(out, reinterpret_cast<const char*>(grid.constData()), grid.size()*sizeof(quint32));
+	h.gridRecordsOffset = out.size();
+	appendAligned(out, reinterpret_cast<const char*>(gridRecords.constData()), count*sizeof(quint32));
+	h.stringsOffset = out.size();
+	h.stringsSize = strings.size();
+	out.append(strings);
+	std::memcpy(out.data(), &h, sizeof(Header));
+	return out;
+}
+
+bool StelLocationDB::open(const QString& fileName, const QByteArray& signature)
+{
+	close();
+	file.setFileName(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	const uchar* mapped = file.map(0, file.size());
+	if (!mapped || !attach(mapped, file.size()))
+	{
+		qWarning() << "Ignoring invalid location database" << QDir::toNativeSeparators(fileName);
+		close();
+		return false;
+	}
+	if (this->signature()!=signature)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool StelLocationDB::setData(const QByteArray& newData)
+{
+	close();
+	memoryData = newData;
+	if (!attach(reinterpret_cast<const uchar*>(memoryData.constData()), memoryData.size()))
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool StelLocationDB::openShared(const StelLocationDB& other)
+{
+	if (&other==this)
+		return isOpen();
+	if (!other.isOpen())
+	{
+		close();
+		return false;
+	}
+	if (other.file.isOpen())
+		return open(other.file.fileName(), other.signature());
+	return setData(other.memoryData);
+}
+
+QByteArray StelLocationDB::signature() const
+{
+	Q_ASSERT(header);
+	return QByteArray(reinterpret_cast<const char*>(data+header->signatureOffset), header->signatureSize);
+}
+
+void StelLocationDB::close()
+{
+	header = Q_NULLPTR;
+	data = Q_NULLPTR;
+	dataSize = 0;
+	if (file.isOpen())
+		file.close(); // also unmaps
+	memoryData.clear();
+}
+
+bool StelLocationDB::attach(const uchar* newData, qint64 size)
+{
+	if (size<(qint64)sizeof(Header))
+		return false;
+	const Header* h = reinterpret_cast<const Header*>(newData);
+	if (h->magic!=LOCATION_DB_MAGIC || h->version!=LOCATION_DB_VERSION)
+		return false;
+	// Check that all sections are within the data
+	const qint64 count = h->count;
+	if (   (qint64)h->signatureOffset+h->signatureSize > size
+	    || (qint64)h->recordsOffset+count*sizeof(Record) > size
+	    || (qint64)h->nameIndexOffset+count*sizeof(quint32) > size
+	    || (qint64)h->gridOffset+(GRID_ROWS*GRID_COLS+1)*sizeof(quint32) > size
+	    || (qint64)h->gridRecordsOffset+count*sizeof(quint32) > size
+	    || (qint64)h->stringsOffset+h->stringsSize > size)
+		return false;
+	data = newData;
+	dataSize = size;
+	header = h;
+	return true;
+}
+
+int StelLocationDB::size() const
+{
+	return header ? (int)header->count : 0;
+}
+
+const StelLocationDB::Record* StelLocationDB::record(int i) const
+{
+	Q_ASSERT(header && i>=0 && i<(int)header->count);
+	return reinterpret_cast<const Record*>(data+header->recordsOffset)+i;
+}
+
+QString StelLocationDB::string(quint32 offset) const
+{
+	const uchar* p = data+header->stringsOffset+offset;
+	const quint32 length = *reinterpret_cast<const quint32*>(p);
+	return QString(reinterpret_cast<const QChar*>(p+sizeof(quint32)), length);
+}
+
+int StelLocationDB::compareString(quint32 offset, const QString& s, Qt::CaseSensitivity cs) const
+{
+	const uchar* p = data+header->stringsOffset+offset;
+	const quint32 length = *reinterpret_cast<const quint32*>(p);
+	// no copy of the string data
+	const QString raw = QString::fromRawData(reinterpret_cast<const QChar*>(p+sizeof(quint32)), length);
+	return QString::compare(raw, s, cs);
+}
+
+StelLocation StelLocationDB::at(int i) const
+{
+	const Record* r = record(i);
+	StelLocation loc;
+	loc.name = string(r->name);
+	loc.state = string(r->state);
+	loc.country = string(r->country);
+	loc.planetName = string(r->planetName);
+	loc.longitude = r->longitude;
+	loc.latitude = r->latitude;
+	loc.altitude = r->altitude;
+	loc.bortleScaleIndex = r->bortleScaleIndex;
+	loc.landscapeKey = string(r->landscapeKey);
+	loc.population = r->population;
+	loc.role = QChar(r->role);
+	loc.ianaTimeZone = string(r->ianaTimeZone);
+	loc.isUserLocation = r->isUserLocation;
+	return loc;
+}
+
+QString StelLocationDB::idAt(int i) const
+{
+	return string(record(i)->id);
+}
+
+QStringList StelLocationDB::allIDs() const
+{
+	QStringList ids;
+	const int n = size();
+	ids.reserve(n);
+	for (int i=0; i<n; ++i)
+		ids.append(idAt(i));
+	return ids;
+}
+
+int StelLocationDB::find(const QString& id) const
+{
+	int low = 0;
+	int high = size()-1;
+	while (low<=high)
+	{
+		const int mid = (low+high)/2;
+		const int c = compareString(record(mid)->id, id, Qt::CaseSensitive);
+		if (c<0)
+			low = mid+1;
+		else if (c>0)
+			high = mid-1;
+		else
+			return mid;
+	}
+	return -1;
+}
+
+QVector<int> StelLocationDB::findByNamePrefix(const QString& prefix, int maxResults) const
+{
+	QVector<int> res;
+	if (!header)
+		return res;
+	const quint32* nameIndex = reinterpret_cast<const quint32*>(data+header->nameIndexOffset);
+	// Names with a common prefix are contiguous in the case insensitive order: find the first one.
+	int low = 0;
+	int high = size();
+	while (low<high)
+	{
+		const int mid = (low+high)/2;
+		if (compareString(record(nameIndex[mid])->name, prefix, Qt::CaseInsensitive)<0)
+			low = mid+1;
+		else
+			high = mid;
+	}
+	for (int i=low; i<size() && (maxResults<0 || res.size()<maxResults); ++i)
+	{
+		const quint32 offset = record(nameIndex[i])->name;
+		const uchar* p = data+header->stringsOffset+offset;
+		const QString name = QString::fromRawData(reinterpret_cast<const QChar*>(p+sizeof(quint32)), *reinterpret_cast<const quint32*>(p));
+		if (!name.startsWith(prefix, Qt::CaseInsensitive))
+			break;
+		res.append(nameIndex[i]);
+	}
+	return res;
+}
+
+QVector<int> StelLocationDB::findNearby(const QString& planetName, float longitude, float latitude, float radiusDegrees) const
+{
+	QVector<int> res;
+	if (!header || radiusDegrees<0.f)
+		return res;
+
+	const quint32* grid = reinterpret_cast<const quint32*>(data+header->gridOffset);
+	const quint32* gridRecords = reinterpret_cast<const quint32*>(data+header->gridRecordsOffset);
+
+	// Longitude half width of the search cap, unless it contains a pole
+	int colSpan = GRID_COLS;
+	if (std::fabs(latitude)+radiusDegrees < 89.f)
+	{
+		const double dLon = std::asin(std::sin(radiusDegrees*M_PI/180.)/std::cos(latitude*M_PI/180.))*180./M_PI;
+		colSpan = (int)std::ceil(dLon)+1;
+	}
+	const bool fullRows = 2*colSpan+1>=GRID_COLS;
+	const int centerCol = gridCol(longitude);
+
+	// Planet names are shared strings, so only compare each offset once
+	QHash<quint32, bool> planetMatch;
+	const int rowMin = gridRow(latitude-radiusDegrees);
+	const int rowMax = gridRow(latitude+radiusDegrees);
+	for (int row=rowMin; row<=rowMax; ++row)
+	{
+		const int colMin = fullRows ? 0 : centerCol-colSpan;
+		const int colMax = fullRows ? GRID_COLS-1 : centerCol+colSpan;
+		for (int c=colMin; c<=colMax; ++c)
+		{
+			const int cell = row*GRID_COLS + (c+GRID_COLS)%GRID_COLS;
+			for (quint32 k=grid[cell]; k<grid[cell+1]; ++k)
+			{
+				const Record* r = record(gridRecords[k]);
+				if (StelLocation::distanceDegrees(longitude, latitude, r->longitude, r->latitude) > radiusDegrees)
+					continue;
+				QHash<quint32, bool>::iterator it = planetMatch.find(r->planetName);
+				if (it==planetMatch.end())
+					it = planetMatch.insert(r->planetName, compareString(r->planetName, planetName, Qt::CaseSensitive)==0);
+				if (it.value())
+					res.append(gridRecords[k]);
+			}
+		}
+	}
+	return res;
+}
+
+QVector<int> StelLocationDB::findInCountry(const QString& country) const
+{
+	QVector<int> res;
+	QHash<quint32, bool> countryMatch;
+	const int n = size();
+	for (int i=0; i<n; ++i)
+	{
+		const Record* r = record(i);
+		QHash<quint32, bool>::iterator it = countryMatch.find(r->country);
+		if (it==countryMatch.end())
+			it = countryMatch.insert(r->country, compareString(r->country, country, Qt::CaseSensitive)==0);
+		if (it.value())
+			res.append(i);
+	}
+	return res;
+}
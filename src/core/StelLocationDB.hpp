@@ -0,0 +1,108 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELLOCATIONDB_HPP_
+#define _STELLOCATIONDB_HPP_
+
+#include "StelLocation.hpp"
+
+#include <QByteArray>
+#include <QFile>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+//! @class StelLocationDB
+//! A read-only, compact binary store of locations which is used directly from a memory mapped file.
+//! Opening it costs almost nothing regardless of the number of locations, and a StelLocation is only
+//! decoded when it is requested. The store contains
+//!  - fixed size records sorted by location ID, so that a location is found by binary search,
+//!  - a table of deduplicated UTF-16 strings referenced by the records,
+//!  - a name index (record numbers sorted case insensitively by name) for prefix searches,
+//!  - a latitude/longitude grid of 1 degree cells for radius queries.
+//! The data is stored in the native byte order and meant to be generated locally in the cache directory,
+//! tagged with a signature of the source it has been built from.
+//! Time zone names are returned as stored. Validation is up to the caller (see StelLocationMgr).
+class StelLocationDB
+{
+public:
+	StelLocationDB();
+	~StelLocationDB();
+
+	//! Serialize locations in the binary format.
+	//! @param locations the locations, the key being the location ID.
+	//! @param signature arbitrary data identifying the source of the locations.
+	static QByteArray serialize(const QMap<QString, StelLocation>& locations, const QByteArray& signature);
+
+	//! Map a file written with the data returned by serialize().
+	//! @return false if the file does not exist, is invalid, or has a different signature.
+	bool open(const QString& fileName, const QByteArray& signature);
+	//! Use data returned by serialize() from memory instead of a file.
+	bool setData(const QByteArray& data);
+	//! Use the same data as another database without copying it: its file is mapped again,
+	//! or its memory data is shared. Each StelLocationDB can then be used from a different thread.
+	bool openShared(const StelLocationDB& other);
+	//! Release the file or data.
+	void close();
+	bool isOpen() const {return header!=Q_NULLPTR;}
+
+	//! Return the number of locations.
+	int size() const;
+	//! Decode the location with the given record number (0..size()-1).
+	StelLocation at(int i) const;
+	//! Return the ID of the location with the given record number without decoding the whole location.
+	QString idAt(int i) const;
+	//! Return the IDs of all locations, in ascending order.
+	QStringList allIDs() const;
+
+	//! Return the record number of the location with the given ID, or -1.
+	int find(const QString& id) const;
+	//! Return the record numbers of all locations whose name starts with prefix (case insensitive), in name order.
+	//! @param maxResults stop after that many results, -1 for no limit.
+	QVector<int> findByNamePrefix(const QString& prefix, int maxResults=-1) const;
+	//! Return the record numbers of the locations on planetName within radiusDegrees of the given coordinates.
+	QVector<int> findNearby(const QString& planetName, float longitude, float latitude, float radiusDegrees) const;
+	//! Return the record numbers of the locations in the given country.
+	QVector<int> findInCountry(const QString& country) const;
+
+	//! Size of the latitude/longitude grid used for radius queries.
+	static const int GRID_ROWS = 180;
+	static const int GRID_COLS = 360;
+
+private:
+	struct Header;
+	struct Record;
+
+	bool attach(const uchar* data, qint64 size);
+	QByteArray signature() const;
+	const Record* record(int i) const;
+	QString string(quint32 offset) const;
+	int compareString(quint32 offset, const QString& s, Qt::CaseSensitivity cs) const;
+	static int gridRow(float latitude);
+	static int gridCol(float longitude);
+
+	QFile file;
+	QByteArray memoryData;
+	const uchar* data;
+	qint64 dataSize;
+	const Header* header;
+};
+
+#endif // _STELLOCATIONDB_HPP_
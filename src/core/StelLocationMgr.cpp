@@ -23,6 +23,7 @@
 #include "StelCore.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
+#include "StelInflateDevice.hpp"
 #include "StelJsonParser.hpp"
 #include "StelLocaleMgr.hpp"
 
@@ -30,6 +31,9 @@
 #include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
 #include <QNetworkInterface>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -39,6 +43,8 @@
 #include <QSettings>
 #include <QTimeZone>
 
+#include <stdexcept>
+
 TimezoneNameMap StelLocationMgr::locationDBToIANAtranslations;
 
 #ifdef ENABLE_GPS
@@ -346,8 +352,8 @@ StelLocationMgr::StelLocationMgr()
 	if (conf->value("devel/convert_locations_list", false).toBool())
 		generateBinaryLocationFile("data/base_locations.txt", false, "data/base_locations.bin");
 
-	locations = loadCitiesBin("data/base_locations.bin.gz");
-	locations.unite(loadCities("data/user_locations.txt", true));
+	loadBaseLocations("data/base_locations.bin.gz");
+	locations = loadCities("data/user_locations.txt", true);
 	
 	// Init to Paris France because it's the center of the world.
 	lastResortLocation = locationForString(conf->value("init_location/last_location", "Paris, France").toString());
@@ -378,6 +384,13 @@ void StelLocationMgr::setLocations(const LocationList &locations)
 	emit locationListChanged();
 }
 
+void StelLocationMgr::copyLocationsFrom(const StelLocationMgr& other)
+{
+	baseLocations.openShared(other.baseLocations);
+	locations = other.locations;
+	emit locationListChanged();
+}
+
 void StelLocationMgr::generateBinaryLocationFile(const QString& fileName, bool isUserLocation, const QString& binFilePath) const
 {
 	qWarning() << "Generating a locations list...";
@@ -408,7 +421,11 @@ LocationMap StelLocationMgr::loadCitiesBin(const QString& fileName)
 
 	if (fileName.endsWith(".gz"))
 	{
-		QDataStream in(StelUtils::uncompress(sourcefile.readAll()));
+		StelInflateDevice inflater(&sourcefile);
+		inflater.setMultiMember(true);
+		if (!inflater.open(QIODevice::ReadOnly))
+			return res;
+		QDataStream in(&inflater);
 		in.setVersion(QDataStream::Qt_5_2);
 		in >> res;
 	}
@@ -418,48 +435,101 @@ LocationMap StelLocationMgr::loadCitiesBin(const QString& fileName)
 		in.setVersion(QDataStream::Qt_5_2);
 		in >> res;
 	}
-	// Now res has all location data. However, some timezone names are not available in various versions of Qt.
-	// Sanity checks: It seems we must translate timezone names. Quite a number on Windows, but also still some on Linux.
-	QList<QByteArray> availableTimeZoneList=QTimeZone::availableTimeZoneIds();
-	QStringList unknownTZlist;
-	QMap<QString, StelLocation>::iterator i=res.begin();
-	while (i!=res.end())
+	// Time zone names are checked when the locations are decoded from the database, see timeZoneFromLocationDB().
+	return res;
+}
+
+void StelLocationMgr::loadBaseLocations(const QString& fileName)
+{
+	const QString cityDataPath = StelFileMgr::findFile(fileName);
+	if (cityDataPath.isEmpty())
+		return;
+
+	// The database is rebuilt when the location file changes
+	const QFileInfo info(cityDataPath);
+	const QByteArray signature = QString("%1:%2:%3").arg(info.absoluteFilePath()).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch()).toUtf8();
+	const QString dbPath = StelFileMgr::getCacheDir() + "/locations/base_locations.db";
+	if (baseLocations.open(dbPath, signature))
+		return;
+
+	qDebug() << "Building location database" << QDir::toNativeSeparators(dbPath);
+	const QByteArray data = StelLocationDB::serialize(loadCitiesBin(fileName), signature);
+	try
 	{
-		StelLocation loc=i.value();
-		if ((loc.ianaTimeZone!="LMST") &&  (loc.ianaTimeZone!="LTST") && ( ! availableTimeZoneList.contains(loc.ianaTimeZone.toUtf8())) )
-		{
-			// TZ name which is currently unknown to Qt detected. See if we can translate it, if not: complain to qDebug().
-			QString fixTZname=sanitizeTimezoneStringFromLocationDB(loc.ianaTimeZone);
-			if (availableTimeZoneList.contains(fixTZname.toUtf8()))
-			{
-				loc.ianaTimeZone=fixTZname;
-				i.value() = loc;
-			}
-			else
-			{
-				qDebug() << "StelLocationMgr::loadCitiesBin(): TimeZone for " << loc.name <<  " not found: " << loc.ianaTimeZone;
-				unknownTZlist.append(loc.ianaTimeZone);
-			}
-		}
-		++i;
+		StelFileMgr::makeSureDirExistsAndIsWritable(StelFileMgr::dirName(dbPath));
+		QSaveFile dbFile(dbPath);
+		if (dbFile.open(QIODevice::WriteOnly) && dbFile.write(data)==data.size() && dbFile.commit() && baseLocations.open(dbPath, signature))
+			return;
+		qWarning() << "Cannot store location database" << QDir::toNativeSeparators(dbPath);
 	}
-	if (unknownTZlist.length()>0)
+	catch (std::runtime_error& e)
 	{
-		unknownTZlist.removeDuplicates();
-		qDebug() << "StelLocationMgr::loadCitiesBin(): Summary of unknown TimeZones:";
-		QStringList::const_iterator t=unknownTZlist.begin();
-		while (t!=unknownTZlist.end())
+		qWarning() << "Cannot store location database:" << e.what();
+	}
+	// Use it from memory then
+	baseLocations.setData(data);
+}
+
+StelLocation StelLocationMgr::baseLocation(int i) const
+{
+	StelLocation loc = baseLocations.at(i);
+	loc.ianaTimeZone = timeZoneFromLocationDB(loc.ianaTimeZone);
+	return loc;
+}
+
+// Some timezone names are not available in various versions of Qt.
+// It seems we must translate timezone names. Quite a number on Windows, but also still some on Linux.
+QString StelLocationMgr::timeZoneFromLocationDB(const QString& tz) const
+{
+	QHash<QString, QString>::const_iterator it = timeZoneNames.constFind(tz);
+	if (it!=timeZoneNames.constEnd())
+		return it.value();
+
+	QString res = tz;
+	if ((tz!="LMST") && (tz!="LTST") && (!QTimeZone::isTimeZoneIdAvailable(tz.toUtf8())))
+	{
+		// TZ name which is currently unknown to Qt detected. See if we can translate it, if not: complain to qDebug().
+		const QString fixTZname=sanitizeTimezoneStringFromLocationDB(tz);
+		if (QTimeZone::isTimeZoneIdAvailable(fixTZname.toUtf8()))
+			res = fixTZname;
+		else
 		{
-			qDebug() << *t;
-			++t;
+			qDebug() << "StelLocationMgr: TimeZone not found:" << tz;
+			qDebug() << "Please report this timezone name (this logfile) to the Stellarium developers.";
+			// Note to developers: Fill those names and replacements to the map above.
 		}
-		qDebug() << "Please report these timezone names (this logfile) to the Stellarium developers.";
-		// Note to developers: Fill those names and replacements to the map above.
 	}
+	timeZoneNames.insert(tz, res);
+	return res;
+}
 
+LocationList StelLocationMgr::getAll() const
+{
+	return getAllMap().values();
+}
+
+LocationMap StelLocationMgr::getAllMap() const
+{
+	LocationMap res;
+	for (int i=0; i<baseLocations.size(); ++i)
+		res.insert(baseLocations.idAt(i), baseLocation(i));
+	for (LocationMap::const_iterator iter=locations.constBegin(); iter!=locations.constEnd(); ++iter)
+		res.insert(iter.key(), iter.value());
 	return res;
 }
 
+QStringList StelLocationMgr::getAllIDs() const
+{
+	QStringList ids = baseLocations.allIDs();
+	if (!locations.isEmpty())
+	{
+		ids.append(locations.keys());
+		ids.sort();
+		ids.removeDuplicates();
+	}
+	return ids;
+}
+
 // Done in the following: TZ name sanitizing also for text file!
 LocationMap StelLocationMgr::loadCities(const QString& fileName, bool isUserLocation)
 {
@@ -546,6 +616,9 @@ const StelLocation StelLocationMgr::locationForString(const QString& s) const
 	{
 		return iter.value();
 	}
+	const int index = baseLocations.find(s);
+	if (index>=0)
+		return baseLocation(index);
 	StelLocation ret;
 	// Maybe it is a coordinate set ? (e.g. GPS 25.107363,121.558807 )
 	QRegExp reg("(?:(.+)\\s+)?(.+),(.+)");
@@ -561,6 +634,23 @@ const StelLocation StelLocationMgr::locationForString(const QString& s) const
 		ret.planetName = "Earth";
 		return ret;
 	}
+	// Maybe it is only a name: take the most populated location with that name.
+	// Exact matches come first in the name index.
+	const QVector<int> candidates = baseLocations.findByNamePrefix(s);
+	int best = -1;
+	foreach (int i, candidates)
+	{
+		const StelLocation loc = baseLocations.at(i);
+		if (loc.name.compare(s, Qt::CaseInsensitive)!=0)
+			break;
+		if (best<0 || loc.population>ret.population)
+		{
+			best = i;
+			ret = loc;
+		}
+	}
+	if (best>=0)
+		return baseLocation(best);
 	ret.role = '!';
 	return ret;
 }
@@ -586,7 +676,7 @@ const StelLocation StelLocationMgr::locationFromCLI() const
 // Get whether a location can be permanently added to the list of user locations
 bool StelLocationMgr::canSaveUserLocation(const StelLocation& loc) const
 {
-	return loc.isValid() && locations.find(loc.getID())==locations.end();
+	return loc.isValid() && locations.find(loc.getID())==locations.end() && baseLocations.find(loc.getID())<0;
 }
 
 // Add permanently a location to the list of user locations
@@ -805,6 +895,8 @@ void StelLocationMgr::changeLocationFromNetworkLookup()
 LocationMap StelLocationMgr::pickLocationsNearby(const QString planetName, const float longitude, const float latitude, const float radiusDegrees)
 {
 	QMap<QString, StelLocation> results;
+	foreach (int i, baseLocations.findNearby(planetName, longitude, latitude, radiusDegrees))
+		results.insert(baseLocations.idAt(i), baseLocation(i));
 	QMapIterator<QString, StelLocation> iter(locations);
 	while (iter.hasNext())
 	{
@@ -822,6 +914,8 @@ LocationMap StelLocationMgr::pickLocationsNearby(const QString planetName, const
 LocationMap StelLocationMgr::pickLocationsInCountry(const QString country)
 {
 	QMap<QString, StelLocation> results;
+	foreach (int i, baseLocations.findInCountry(country))
+		results.insert(baseLocations.idAt(i), baseLocation(i));
 	QMapIterator<QString, StelLocation> iter(locations);
 	while (iter.hasNext())
 	{
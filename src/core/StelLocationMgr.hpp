@@ -20,6 +20,8 @@
 #define _STELLOCATIONMGR_HPP_
 
 #include "StelLocation.hpp"
+#include "StelLocationDB.hpp"
+#include <QHash>
 #include <QString>
 #include <QObject>
 #include <QMetaType>
@@ -45,14 +47,24 @@ public:
 	//! Construct a StelLocationMgr which uses the locations given instead of loading them from the files.
 	StelLocationMgr(const LocationList& locations);
 
-	//! Replaces the loaded location list
+	//! Add locations to the user locations, replacing those which have the same ID.
+	//! The base locations of the location database are not affected and can't be replaced.
 	void setLocations(const LocationList& locations);
 
+	//! Use the base location database of another location manager, without decoding it, and replace
+	//! the user locations by a copy of its own. This allows to query the locations from another thread.
+	void copyLocationsFrom(const StelLocationMgr& other);
+
 	//! Return the list of all loaded locations
-	LocationList getAll() const {return locations.values();}
+	//! @note this decodes all base locations, prefer getAllIDs() or the pick functions where possible.
+	LocationList getAll() const;
 
 	//! Returns a map of all loaded locations. The key is the location ID, suitable for a list view.
-	LocationMap getAllMap() const { return locations; }
+	//! @note this decodes all base locations, prefer getAllIDs() or the pick functions where possible.
+	LocationMap getAllMap() const;
+
+	//! Return the sorted IDs of all loaded locations without decoding the locations.
+	QStringList getAllIDs() const;
 
 	//! Return the StelLocation from a CLI
 	const StelLocation locationFromCLI() const;
@@ -85,7 +97,7 @@ public:
 
 public slots:
 	//! Return the StelLocation for a given string
-	//! Can match location name, or coordinates
+	//! Can match location ID, coordinates, or a location name (the most populated location of that name is used)
 	const StelLocation locationForString(const QString& s) const;
 
 	//! Find location via online lookup of IP address
@@ -133,9 +145,20 @@ private:
 	//! Load cities from a file
 	static LocationMap loadCities(const QString& fileName, bool isUserLocation);
 	static LocationMap loadCitiesBin(const QString& fileName);
-
-	//! The list of all loaded locations
+	//! Open the location database built from the given binary location file in the cache directory,
+	//! (re)building it when the binary file has changed.
+	void loadBaseLocations(const QString& fileName);
+	//! Decode a location from the base location database.
+	StelLocation baseLocation(int i) const;
+	//! Return a time zone name from the location database in the form known to Qt, see sanitizeTimezoneStringFromLocationDB().
+	QString timeZoneFromLocationDB(const QString& tz) const;
+
+	//! The read-only base locations, spatially indexed and decoded on demand
+	StelLocationDB baseLocations;
+	//! The user locations, and the locations given with setLocations()
 	LocationMap locations;
+	//! Already checked time zone names of the base locations
+	mutable QHash<QString, QString> timeZoneNames;
 	//! A Map which has to be used to replace, system- and Qt-version dependent,
 	//! timezone names from our location database to the code names currently used by Qt.
 	//! Required to avoid https://bugs.launchpad.net/stellarium/+bug/1662132,
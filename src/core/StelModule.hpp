@@ -21,6 +21,7 @@
 #define _STELMODULE_HPP_
 
 #include <QString>
+#include <QStringList>
 #include <QObject>
 
 // Predeclaration
@@ -59,10 +60,20 @@ public:
 
 	virtual ~StelModule() {;}
 
-	//! Initialize itself.
+	//! Load the data of the module which does not need the main thread, e.g. read and parse catalog files.
+	//! It is called by StelModuleMgr before init(), from a worker thread and concurrently with the loading
+	//! of other modules. It must therefore not use OpenGL, the settings, signals or other modules.
+	//! The default implementation does nothing.
+	virtual void load() {;}
+
+	//! Initialize itself. This is called in the main thread after load().
 	//! If the initialization takes significant time, the progress should be displayed on the loading bar.
 	virtual void init() = 0;
 
+	//! Get the IDs of the modules which must be initialized before this module is loaded and initialized.
+	//! StelModuleMgr::initModule() initializes the dependencies which are not initialized yet first.
+	virtual QStringList getInitDependencies() const {return QStringList();}
+
 	//! Called before the module will be delete, and before the openGL context is suppressed.
 	//! Deinitialize all openGL texture in this method.
 	virtual void deinit() {;}
@@ -75,6 +86,11 @@ public:
 	//! @param deltaTime the time increment in second since last call.
 	virtual void update(double deltaTime) = 0;
 
+	//! Return true if the output of the module changes although the time, the view and the properties
+	//! don't, e.g. while it plays an animation or waits for data. It is called after update().
+	//! When the scene is static, no new frame is drawn until something changes (see StelApp::isSceneStatic()).
+	virtual bool needsRedraw() const {return false;}
+
 	//! Get the version of the module, default is stellarium main version
 	virtual QString getModuleVersion() const;
 
@@ -21,6 +21,9 @@
 #include <QPluginLoader>
 #include <QSettings>
 #include <QDir>
+#include <QtConcurrent>
+
+#include <stdexcept>
 
 #include "StelModuleMgr.hpp"
 #include "StelApp.hpp"
@@ -45,6 +48,11 @@ StelModuleMgr::StelModuleMgr() : callingListsToRegenerate(true), pluginDescripto
 
 StelModuleMgr::~StelModuleMgr()
 {
+	foreach (ModuleStartup* s, startups)
+	{
+		s->loading.waitForFinished();
+		delete s;
+	}
 }
 
 // Regenerate calling lists if necessary
@@ -76,6 +84,163 @@ void StelModuleMgr::registerModule(StelModule* m, bool fgenerateCallingLists)
 		generateCallingLists();
 }
 
+/*************************************************************************
+ Load and initialize modules
+*************************************************************************/
+StelModuleMgr::ModuleStartup* StelModuleMgr::getStartup(StelModule* m)
+{
+	foreach (ModuleStartup* s, startups)
+	{
+		if (s->module==m)
+			return s;
+	}
+	if (!startupTimer.isValid())
+		startupTimer.start();
+	ModuleStartup* s = new ModuleStartup;
+	s->module = m;
+	s->concurrent = false;
+	s->loadStarted = false;
+	s->initStarted = false;
+	s->initialized = false;
+	s->loadStart = s->loadEnd = s->waitTime = s->initStart = s->initEnd = 0;
+	startups.append(s);
+	return s;
+}
+
+StelModuleMgr::ModuleStartup* StelModuleMgr::findStartup(const QString& moduleID) const
+{
+	foreach (ModuleStartup* s, startups)
+	{
+		if (s->module->objectName()==moduleID)
+			return s;
+	}
+	return Q_NULLPTR;
+}
+
+bool StelModuleMgr::isInitialized(const QString& moduleID) const
+{
+	const ModuleStartup* s = findStartup(moduleID);
+	if (s)
+		return s->initialized;
+	return modules.contains(moduleID);
+}
+
+static void loadModule(StelModule* m)
+{
+	try
+	{
+		m->load();
+	}
+	catch (std::exception& e)
+	{
+		qWarning() << "ERROR while loading module" << m->objectName() << ":" << e.what();
+	}
+}
+
+void StelModuleMgr::startLoading(const QList<StelModule*>& mods, bool concurrently)
+{
+	foreach (StelModule* m, mods)
+		getStartup(m)->concurrent = concurrently;
+	startReadyLoads();
+}
+
+void StelModuleMgr::startReadyLoads()
+{
+	foreach (ModuleStartup* s, startups)
+	{
+		if (!s->concurrent || s->loadStarted)
+			continue;
+		bool ready = true;
+		foreach (const QString& dep, s->module->getInitDependencies())
+			ready = ready && isInitialized(dep);
+		if (!ready)
+			continue;
+		// The worker only writes the load times, which are read once the future has finished
+		s->loadStarted = true;
+		const QElapsedTimer* timer = &startupTimer;
+		s->loading = QtConcurrent::run([s, timer]() {
+			s->loadStart = timer->nsecsElapsed();
+			loadModule(s->module);
+			s->loadEnd = timer->nsecsElapsed();
+		});
+	}
+}
+
+void StelModuleMgr::initModule(StelModule* m, bool fgenerateCallingLists)
+{
+	ModuleStartup* s = getStartup(m);
+	if (s->initialized)
+		return;
+	if (s->initStarted)
+	{
+		qWarning() << "Circular init dependency involving module" << m->objectName();
+		return;
+	}
+	s->initStarted = true;
+
+	foreach (const QString& dep, m->getInitDependencies())
+	{
+		if (isInitialized(dep))
+			continue;
+		ModuleStartup* d = findStartup(dep);
+		if (d)
+			initModule(d->module);
+		else
+			qWarning() << "Module" << m->objectName() << "depends on" << dep << "which is not loaded.";
+	}
+
+	if (s->loadStarted)
+	{
+		const qint64 t = startupTimer.nsecsElapsed();
+		s->loading.waitForFinished();
+		s->waitTime = startupTimer.nsecsElapsed()-t;
+	}
+	else
+	{
+		s->loadStarted = true;
+		s->concurrent = false;
+		s->loadStart = startupTimer.nsecsElapsed();
+		loadModule(m);
+		s->loadEnd = startupTimer.nsecsElapsed();
+	}
+
+	s->initStart = startupTimer.nsecsElapsed();
+	m->init();
+	s->initEnd = startupTimer.nsecsElapsed();
+	s->initialized = true;
+
+	if (!modules.contains(m->objectName()))
+		registerModule(m, fgenerateCallingLists);
+	else if (fgenerateCallingLists)
+		generateCallingLists();
+
+	startReadyLoads();
+}
+
+void StelModuleMgr::logStartupTimeline() const
+{
+	qint64 end = 0;
+	qint64 waitTime = 0;
+	qDebug() << "Module startup timeline (ms):";
+	foreach (const ModuleStartup* s, startups)
+	{
+		if (!s->initialized)
+			continue;
+		qDebug() << qPrintable(QString("%1 load %2 - %3 %4 wait %5 init %6 - %7")
+				       .arg(s->module->objectName(), -24)
+				       .arg(s->loadStart*1e-6, 8, 'f', 1)
+				       .arg(s->loadEnd*1e-6, 8, 'f', 1)
+				       .arg(s->concurrent ? "(worker)" : "(main)  ")
+				       .arg(s->waitTime*1e-6, 7, 'f', 1)
+				       .arg(s->initStart*1e-6, 8, 'f', 1)
+				       .arg(s->initEnd*1e-6, 8, 'f', 1));
+		end = qMax(end, s->initEnd);
+		waitTime += s->waitTime;
+	}
+	qDebug() << "Modules loaded and initialized in" << qRound(end*1e-6) << "ms, of which"
+		 << qRound(waitTime*1e-6) << "ms waiting for worker threads";
+}
+
 /*************************************************************************
  Unregister and delete a StelModule.
 *************************************************************************/
@@ -87,6 +252,14 @@ void StelModuleMgr::unloadModule(const QString& moduleID, bool alsoDelete)
 		qWarning() << "Module" << moduleID << "is not loaded.";
 		return;
 	}
+	for (int i=0; i<startups.size(); ++i)
+	{
+		if (startups.at(i)->module!=m)
+			continue;
+		startups.at(i)->loading.waitForFinished();
+		delete startups.takeAt(i);
+		break;
+	}
 	modules.remove(moduleID);
 	m->setParent(Q_NULLPTR);
 	callingListsToRegenerate = true;
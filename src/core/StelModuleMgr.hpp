@@ -21,6 +21,8 @@
 #define _STELMODULEMGR_HPP_
 
 #include <QObject>
+#include <QElapsedTimer>
+#include <QFuture>
 #include <QMap>
 #include <QList>
 #include "StelModule.hpp"
@@ -33,6 +35,8 @@
 //! @class StelModuleMgr
 //! Manage a collection of StelModules including both core and plugin modules.
 //! The order in which some actions like draw or update are called for each module can be retrieved with the getCallOrders() method.
+//! At startup the modules are loaded in two stages: startLoading() runs their load() method in worker threads,
+//! then initModule() calls their init() method in the main thread, following their init dependencies.
 class StelModuleMgr : public QObject
 {
 	Q_OBJECT
@@ -48,6 +52,20 @@ public:
 	//! The module is later referenced by its QObject name.
 	void registerModule(StelModule* m, bool generateCallingLists=false);
 
+	//! Start loading the data of the given modules by calling their StelModule::load() method in worker threads.
+	//! The loading of a module starts as soon as all its init dependencies are initialized.
+	//! The modules must then be initialized with initModule(), in the main thread.
+	//! @param concurrently if false, the modules are loaded in the main thread by initModule().
+	void startLoading(const QList<StelModule*>& mods, bool concurrently=true);
+
+	//! Initialize a module, and register it if it was not registered yet.
+	//! The dependencies of the module which are not initialized yet are initialized first. Then the method waits
+	//! for the end of the loading started by startLoading(), or loads the module itself, and calls StelModule::init().
+	void initModule(StelModule* m, bool generateCallingLists=false);
+
+	//! Log when each module was loaded and initialized, in ms since the start of the first module.
+	void logStartupTimeline() const;
+
 	//! Unregister and delete a StelModule. The program will hang if other modules depend on the removed one
 	//! @param moduleID the unique ID of the module, by convention equal to the class name
 	//! @param alsoDelete if true also delete the StelModule instance, otherwise it has to be deleted by external code.
@@ -115,6 +133,36 @@ private:
 	//! according to modules orders dependencies
 	void generateCallingLists();
 
+	//! The loading and initialization state of a module passed to startLoading() or initModule()
+	struct ModuleStartup
+	{
+		StelModule* module;
+		//! The loading in a worker thread, if any
+		QFuture<void> loading;
+		bool concurrent;
+		bool loadStarted;
+		bool initStarted;
+		bool initialized;
+		//! Times in ns since startupTimer was started
+		qint64 loadStart;
+		qint64 loadEnd;
+		qint64 waitTime;
+		qint64 initStart;
+		qint64 initEnd;
+	};
+
+	//! Return the startup state of the module, create it if needed
+	ModuleStartup* getStartup(StelModule* m);
+	//! Return the startup state of the module, or Q_NULLPTR
+	ModuleStartup* findStartup(const QString& moduleID) const;
+	//! Return true if the module was initialized, or registered without passing by initModule()
+	bool isInitialized(const QString& moduleID) const;
+	//! Start the loading of the modules whose dependencies are now initialized
+	void startReadyLoads();
+
+	QList<ModuleStartup*> startups;
+	QElapsedTimer startupTimer;
+
 	//! The main module list associating name:pointer
 	QMap<QString, StelModule*> modules;
 
@@ -1219,6 +1219,7 @@ void StelMovementMgr::moveToJ2000(const Vec3d& aim, const Vec3d& aimUp, float mo
 	//move.mountMode=mountMode; // Maybe better to have MountEquinoxEquatorial here? ==> YES, fixed orientation problem.
 	move.mountMode=MountEquinoxEquatorial;
 	flagAutoMove = true;
+	StelApp::getInstance().requestRedraw();
 }
 
 void StelMovementMgr::moveToObject(const StelObjectP& target, float moveDuration, ZoomingMode zooming)
@@ -1239,6 +1240,7 @@ void StelMovementMgr::moveToObject(const StelObjectP& target, float moveDuration
 	//move.mountMode=mountMode;  // Maybe better to have MountEquinoxEquatorial here? ==> YES, fixed orientation problem.
 	move.mountMode=MountEquinoxEquatorial;
 	flagAutoMove = true;
+	StelApp::getInstance().requestRedraw();
 }
 
 // March 2016: This call does nothing when mount frame is not AltAzi! (TODO later: rethink&fix.)
@@ -1267,6 +1269,7 @@ void StelMovementMgr::moveToAltAzi(const Vec3d& aim, const Vec3d &aimUp, float m
 	move.targetObject.clear();
 	move.mountMode=MountAltAzimuthal; // This signals: start and aim are given in AltAz coordinates.
 	flagAutoMove = true;
+	StelApp::getInstance().requestRedraw();
 	//	// debug output if required
 	//	double currAlt, currAzi, newAlt, newAzi;
 	//	StelUtils::rectToSphe(&currAzi, &currAlt, move.start);
@@ -1314,6 +1317,7 @@ void StelMovementMgr::setViewDirectionJ2000(const Vec3d& v)
 	core->lookAtJ2000(v, getViewUpVectorJ2000());
 	viewDirectionJ2000 = v;
 	viewDirectionMountFrame = j2000ToMountFrame(v);
+	StelApp::getInstance().requestRedraw();
 }
 
 void StelMovementMgr::panView(const double deltaAz, const double deltaAlt)
@@ -1322,6 +1326,7 @@ void StelMovementMgr::panView(const double deltaAz, const double deltaAlt)
 	// The function is called in update loops, so make a quick check for exit.
 	if ((deltaAz==0.) && (deltaAlt==0.))
 		return;
+	StelApp::getInstance().requestRedraw();
 
 	double azVision, altVision;
 	StelUtils::rectToSphe(&azVision,&altVision,j2000ToMountFrame(viewDirectionJ2000));
@@ -1506,13 +1511,17 @@ void StelMovementMgr::zoomTo(double aim_fov, float moveDuration)
 	zoomMove.speed=1.f/(moveDuration*1000);
 	zoomMove.coef=0.;
 	flagAutoZoom = true;
+	StelApp::getInstance().requestRedraw();
 }
 
 void StelMovementMgr::changeFov(double deltaFov)
 {
 	// if we are zooming in or out
 	if (deltaFov)
+	{
 		setFov(currentFov + deltaFov);
+		StelApp::getInstance().requestRedraw();
+	}
 }
 
 double StelMovementMgr::getAimFov(void) const
@@ -87,6 +87,12 @@ public:
 		if (dragTimeMode)
 			addTimeDragPoint(QCursor::pos().x(), QCursor::pos().y());
 	}
+	//! Return true during the automatic movements and zooms, and while the time is dragged.
+	virtual bool needsRedraw() const
+	{
+		return flagAutoMove || flagAutoZoom || dragTimeMode
+			|| (viewportOffsetTimeline && viewportOffsetTimeline->state()==QTimeLine::Running);
+	}
 	//! Implement required draw function.  Does nothing.
 	virtual void draw(StelCore*) {;}
 	//! Handle keyboard events.
@@ -22,8 +22,8 @@
 #include "StelOBJ.hpp"
 #include "StelTextureMgr.hpp"
 #include "StelUtils.hpp"
+#include "StelInflateDevice.hpp"
 
-#include <QBuffer>
 #include <QDir>
 #include <QElapsedTimer>
 #include <QFile>
@@ -73,23 +73,24 @@ bool StelOBJ::load(const QString& filename, const VertexOrder vertexOrder)
 	//check if this is a compressed file
 	if(filename.endsWith(".gz"))
 	{
-		//uncompress into memory
-		QByteArray data = StelUtils::uncompress(file);
-		file.close();
-		//check if decompressing was successful
-		if(data.isEmpty())
+		//uncompress while parsing, the whole decompressed file is never kept in memory
+		StelInflateDevice inflater(&file);
+		inflater.setMultiMember(true);
+		if(!inflater.open(QIODevice::ReadOnly))
 		{
 			qCCritical(stelOBJ)<<"Could not decompress file"<<filename;
 			return false;
 		}
-		qCDebug(stelOBJ)<<"Decompressed in"<<timer.elapsed()<<"ms";
-
-		//create and open a QBuffer for reading
-		QBuffer buf(&data);
-		buf.open(QIODevice::ReadOnly);
 
 		//perform actual load
-		return load(buf,fi.canonicalPath(),vertexOrder);
+		const bool ok = load(inflater,fi.canonicalPath(),vertexOrder);
+		//check if decompressing was successful
+		if(inflater.hasError())
+		{
+			qCCritical(stelOBJ)<<"Could not decompress file"<<filename<<inflater.errorString();
+			return false;
+		}
+		return ok;
 	}
 
 	//perform actual load
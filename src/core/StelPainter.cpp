@@ -24,6 +24,7 @@
 #include "StelProjector.hpp"
 #include "StelProjectorClasses.hpp"
 #include "StelUtils.hpp"
+#include "StelSpriteBatch.hpp"
 
 #include <QDebug>
 #include <QString>
@@ -34,11 +35,15 @@
 #include <QVarLengthArray>
 #include <QPaintEngine>
 #include <QCache>
+#include <QHash>
 #include <QOpenGLPaintDevice>
 #include <QOpenGLShader>
 #include <QOpenGLTexture>
 #include <QApplication>
 
+#include <algorithm>
+#include <typeinfo>
+
 static const int TEX_CACHE_LIMIT = 7000000;
 
 #ifndef NDEBUG
@@ -930,6 +935,66 @@ void StelPainter::drawPath(const QVector<Vec3d> &points, const QVector<Vec4f> &c
 	Q_ASSERT(smallCircleColorArray.isEmpty());
 }
 
+// The subdivided triangles of a vertex array drawn with drawSphericalTriangles(), kept on the sphere.
+// How projectSphericalTriangle() splits the triangles depends on the projection type, on the scale and, for non linear
+// projections, on where the triangles are in the viewport. So the result can be reused as long as these change little,
+// and only the projection of the cached triangles is left to do at each frame. All the triangles of the array are kept,
+// including those outside of the viewport when the entry was built, which can come into view while it is reused.
+struct SphericalTrianglesCacheEntry
+{
+	SphericalTrianglesCacheEntry() : size(0), textured(false), colored(false), projectionType(Q_NULLPTR),
+		scaleBucket(0), maxSqDistortion(0.), minViewDirectionCos(2.), lastUse(0) {;}
+
+	// Return whether the entry was built for a similar view. The content of the vertex array is identified by its cacheId.
+	bool matches(const StelVertexArray& va, bool atextured, bool acolored, const std::type_info* aprojectionType,
+		     int ascaleBucket, double amaxSqDistortion, const Vec3d& aviewDirection) const
+	{
+		return size==va.vertex.size()
+			&& textured==atextured && colored==acolored && projectionType==aprojectionType
+			&& scaleBucket==ascaleBucket && maxSqDistortion==amaxSqDistortion
+			&& viewDirection*aviewDirection>=minViewDirectionCos;
+	}
+
+	// Called by projectSphericalTriangle() for each final triangle while the entry is built
+	void record(const Vec3d* v, const Vec2f* t, const Vec3f* c)
+	{
+		vertices.append(v[0]); vertices.append(v[1]); vertices.append(v[2]);
+		if (textured)
+		{
+			texCoords.append(t[0]); texCoords.append(t[1]); texCoords.append(t[2]);
+		}
+		if (colored)
+		{
+			colors.append(c[0]); colors.append(c[1]); colors.append(c[2]);
+		}
+	}
+
+	// Number of vertices of the array, as a sanity check
+	int size;
+	// Drawing parameters and view for which the entry was built
+	bool textured, colored;
+	const std::type_info* projectionType;
+	int scaleBucket;
+	double maxSqDistortion;
+	Vec3d viewDirection;
+	double minViewDirectionCos;
+	quint64 lastUse;
+	// The subdivided triangles
+	QVector<Vec3d> vertices;
+	QVector<Vec2f> texCoords;
+	QVector<Vec3f> colors;
+};
+
+// Entries are keyed by the StelVertexArray::cacheId of the arrays, which is never reused. They are only rebuilt when
+// used again for a different view, and the least recently used ones are removed when there are more than
+// MAX_CACHED_TRIANGLE_VERTICES, which also drops the entries of the arrays which were changed or destroyed.
+static QHash<quint64, SphericalTrianglesCacheEntry> sphericalTrianglesCache;
+static int sphericalTrianglesCacheVertices = 0;
+static quint64 sphericalTrianglesCacheTick = 0;
+static const int MAX_CACHED_TRIANGLE_VERTICES = 1<<20;
+// The entry being built by drawCachedSphericalTriangles(), if any
+static SphericalTrianglesCacheEntry* recordedTriangles = Q_NULLPTR;
+
 // Project the passed triangle on the screen ensuring that it will look smooth, even for non linear distortion
 // by splitting it into subtriangles.
 void StelPainter::projectSphericalTriangle(const SphericalCap* clippingCap, const Vec3d* vertices, QVarLengthArray<Vec3f, 4096>* outVertices,
@@ -958,7 +1023,12 @@ void StelPainter::projectSphericalTriangle(const SphericalCap* clippingCap, cons
 	valid = prj->projectInPlace(e2) || valid;
 	// Clip polygons behind the viewer
 	if (!valid)
+	{
+		// The distortion can't be evaluated, keep the whole triangle in the cached subdivision
+		if (recordedTriangles)
+			recordedTriangles->record(vertices, texturePos, colors);
 		return;
+	}
 
 	if (checkDisc1 && cDiscontinuity1==false)
 	{
@@ -994,6 +1064,8 @@ void StelPainter::projectSphericalTriangle(const SphericalCap* clippingCap, cons
 			outTexturePos->append(texturePos,3);
 		if (outColors)
 			outColors->append(colors,3);
+		if (recordedTriangles)
+			recordedTriangles->record(vertices, texturePos, colors);
 		return;
 	}
 
@@ -1010,6 +1082,8 @@ void StelPainter::projectSphericalTriangle(const SphericalCap* clippingCap, cons
 			outTexturePos->append(texturePos,3);
 		if (outColors)
 			outColors->append(colors,3);
+		if (recordedTriangles)
+			recordedTriangles->record(vertices, texturePos, colors);
 		return;
 	}
 
@@ -1556,6 +1630,7 @@ void StelPainter::drawSphericalTriangles(const StelVertexArray& va, bool texture
 	Q_ASSERT(va.vertex.size()>2);
 	polygonVertexArray.clear();
 	polygonTextureCoordArray.clear();
+	polygonColorArray.clear();
 
 	indexArray.clear();
 
@@ -1566,6 +1641,13 @@ void StelPainter::drawSphericalTriangles(const StelVertexArray& va, bool texture
 		return;
 	}
 
+	if (!clippingCap && !prj->hasDiscontinuity() && va.cacheId!=0)
+	{
+		// The subdivision can be reused from a previous frame
+		drawCachedSphericalTriangles(va, textured, colored, maxSqDistortion);
+		return;
+	}
+
 	// the last case.  It is the slowest, it process the triangles one by one.
 	{
 		// Project all the triangles of the VertexArray into our buffer arrays.
@@ -1575,6 +1657,77 @@ void StelPainter::drawSphericalTriangles(const StelVertexArray& va, bool texture
 	}
 }
 
+void StelPainter::drawCachedSphericalTriangles(const StelVertexArray& va, bool textured, bool colored, double maxSqDistortion)
+{
+	const SphericalCap& viewport = prj->getBoundingCap();
+	const std::type_info* projectionType = &typeid(*prj);
+	// Buckets of a factor sqrt(2) in scale
+	const int scaleBucket = (int)std::floor(2.*std::log(prj->getPixelPerRadAtCenter())/std::log(2.));
+
+	SphericalTrianglesCacheEntry& entry = sphericalTrianglesCache[va.cacheId];
+	entry.lastUse = ++sphericalTrianglesCacheTick;
+	if (!entry.matches(va, textured, colored, projectionType, scaleBucket, maxSqDistortion, viewport.n))
+	{
+		sphericalTrianglesCacheVertices -= entry.vertices.size();
+		entry.size = va.vertex.size();
+		entry.textured = textured;
+		entry.colored = colored;
+		entry.projectionType = projectionType;
+		entry.scaleBucket = scaleBucket;
+		entry.maxSqDistortion = maxSqDistortion;
+		// The distortion varies across the viewport, allow the view to move by a quarter of its radius
+		entry.viewDirection = viewport.n;
+		entry.minViewDirectionCos = std::cos(0.25*viewport.getRadius());
+		entry.vertices.resize(0);
+		entry.texCoords.resize(0);
+		entry.colors.resize(0);
+
+		// Subdivide with half the allowed distortion, which leaves room for the change of scale within a bucket.
+		// The projected triangles are drawn directly.
+		recordedTriangles = &entry;
+		VertexArrayProjector result = va.foreachTriangle(VertexArrayProjector(va, this, Q_NULLPTR, &polygonVertexArray, textured ? &polygonTextureCoordArray : Q_NULLPTR, colored ? &polygonColorArray : Q_NULLPTR, 0.5*maxSqDistortion));
+		recordedTriangles = Q_NULLPTR;
+		sphericalTrianglesCacheVertices += entry.vertices.size();
+		result.drawResult();
+
+		if (sphericalTrianglesCacheVertices>MAX_CACHED_TRIANGLE_VERTICES)
+		{
+			// Remove the least recently used entries until the cache is half full
+			QVector<QPair<quint64, quint64> > uses;
+			uses.reserve(sphericalTrianglesCache.size());
+			for (QHash<quint64, SphericalTrianglesCacheEntry>::ConstIterator it=sphericalTrianglesCache.constBegin(); it!=sphericalTrianglesCache.constEnd(); ++it)
+				uses.append(qMakePair(it.value().lastUse, it.key()));
+			std::sort(uses.begin(), uses.end());
+			for (int i=0; i<uses.size() && sphericalTrianglesCacheVertices>MAX_CACHED_TRIANGLE_VERTICES/2; ++i)
+			{
+				sphericalTrianglesCacheVertices -= sphericalTrianglesCache.value(uses.at(i).second).vertices.size();
+				sphericalTrianglesCache.remove(uses.at(i).second);
+			}
+		}
+		return;
+	}
+
+	// Only project the cached triangles, and clip those behind the viewer like projectSphericalTriangle()
+	const Vec3d* v = entry.vertices.constData();
+	for (int i=0; i<entry.vertices.size(); i+=3)
+	{
+		Vec3d e0=v[i];
+		Vec3d e1=v[i+1];
+		Vec3d e2=v[i+2];
+		bool valid = prj->projectInPlace(e0);
+		valid = prj->projectInPlace(e1) || valid;
+		valid = prj->projectInPlace(e2) || valid;
+		if (!valid)
+			continue;
+		polygonVertexArray.append(Vec3f(e0[0], e0[1], e0[2])); polygonVertexArray.append(Vec3f(e1[0], e1[1], e1[2])); polygonVertexArray.append(Vec3f(e2[0], e2[1], e2[2]));
+		if (textured)
+			polygonTextureCoordArray.append(entry.texCoords.constData()+i, 3);
+		if (colored)
+			polygonColorArray.append(entry.colors.constData()+i, 3);
+	}
+	VertexArrayProjector(va, this, Q_NULLPTR, &polygonVertexArray, textured ? &polygonTextureCoordArray : Q_NULLPTR, colored ? &polygonColorArray : Q_NULLPTR).drawResult();
+}
+
 // Draw the given SphericalPolygon.
 void StelPainter::drawSphericalRegion(const SphericalRegion* poly, SphericalPolygonDrawMode drawMode, const SphericalCap* clippingCap, const bool doSubDivise, const double maxSqDistortion)
 {
@@ -1701,6 +1854,18 @@ void StelPainter::drawSprite2dMode(float x, float y, float radius, float rotatio
 	enableClientStates(false);
 }
 
+void StelPainter::drawSpriteBatch(const StelSpriteBatch& batch)
+{
+	if (batch.isEmpty())
+		return;
+	enableClientStates(true, true, true);
+	setVertexPointer(2, GL_FLOAT, batch.vertices.constData());
+	setTexCoordPointer(2, GL_FLOAT, batch.texCoords.constData());
+	setColorPointer(4, GL_FLOAT, batch.colors.constData());
+	drawFromArray(Triangles, batch.vertices.size(), 0, false);
+	enableClientStates(false);
+}
+
 void StelPainter::drawRect2d(float x, float y, float width, float height, bool textured)
 {
 	static float vertexData[] = {-10.,-10.,10.,-10., 10.,10., -10.,10.};
@@ -150,6 +150,10 @@ public:
 	//! @param rotation rotation angle in degree.
 	void drawSprite2dMode(float x, float y, float radius, float rotation);
 
+	//! Draw all the sprites collected in a StelSpriteBatch using the current texture, in a single call.
+	//! The per-sprite colors of the batch modulate the texture.
+	void drawSpriteBatch(const class StelSpriteBatch& batch);
+
 	//! Draw a GL_POINT at the given position.
 	//! @param x x position in the viewport in pixels.
 	//! @param y y position in the viewport in pixels.
@@ -364,6 +368,11 @@ private:
             double maxSqDistortion=5., int nbI=0,
             bool checkDisc1=true, bool checkDisc2=true, bool checkDisc3=true) const;
 
+	//! Draw the triangles of the vertex array like drawSphericalTriangles(), reusing the subdivision of the triangles
+	//! done for a previous similar view of the same array. Only for projections without discontinuity and without clipping cap,
+	//! and for arrays with a StelVertexArray::cacheId.
+	void drawCachedSphericalTriangles(const StelVertexArray& va, bool textured, bool colored, double maxSqDistortion);
+
 	void drawTextGravity180(float x, float y, const QString& str, float xshift = 0, float yshift = 0);
 
 	// Used by the method below
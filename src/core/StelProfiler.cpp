@@ -0,0 +1,352 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelProfiler.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+
+// Zone id of whole frames
+static const int FRAME_ZONE = 0;
+
+StelProfiler::StelProfiler(QObject* parent)
+	: QObject(parent)
+	, enabled(false)
+	, frameOpen(false)
+	, tracing(false)
+	, windowSize(300)
+	, maxTraceEvents(0)
+	, frameStart(0)
+{
+	setObjectName("StelProfiler");
+	timer.start();
+	registerZone("Frame", "frame");
+}
+
+StelProfiler::~StelProfiler()
+{
+}
+
+int StelProfiler::registerZone(const QString& name, const QString& category)
+{
+	if (QThread::currentThread()!=thread())
+	{
+		qWarning() << "StelProfiler: zone" << name << "must be registered from the main thread";
+		return -1;
+	}
+	QHash<QString, int>::const_iterator it = zoneIds.constFind(name);
+	if (it!=zoneIds.constEnd())
+		return it.value();
+
+	Zone z;
+	z.name = name;
+	z.category = category;
+	z.frameTime = 0;
+	z.nextSample = 0;
+	z.sampleCount = 0;
+	zones.append(z);
+	zoneIds.insert(name, zones.size()-1);
+	return zones.size()-1;
+}
+
+int StelProfiler::getModuleZone(const QObject* module, ModulePhase phase)
+{
+	if (QThread::currentThread()!=thread())
+		return -1;
+	QHash<const QObject*, int>::const_iterator it = moduleZones[phase].constFind(module);
+	if (it!=moduleZones[phase].constEnd())
+		return it.value();
+
+	const QString category = (phase==PhaseUpdate ? "update" : "draw");
+	const int zone = registerZone(module->objectName()+'.'+category, category);
+	moduleZones[phase].insert(module, zone);
+	return zone;
+}
+
+void StelProfiler::beginFrame()
+{
+	if (!enabled)
+		return;
+	if (frameOpen)
+		endFrame();
+	frameOpen = true;
+	frameStart = timer.nsecsElapsed();
+}
+
+void StelProfiler::endFrame()
+{
+	if (!frameOpen)
+		return;
+	// Close zones left open
+	while (!stack.isEmpty())
+		endZone();
+	frameOpen = false;
+
+	const qint64 now = timer.nsecsElapsed();
+	lastFrame.clear();
+	lastFrame.append(qMakePair(FRAME_ZONE, (now-frameStart)*1e-6f));
+	foreach (int zone, frameZones)
+	{
+		Zone& z = zones[zone];
+		lastFrame.append(qMakePair(zone, z.frameTime*1e-6f));
+		z.frameTime = 0;
+	}
+	for (int i=0; i<lastFrame.size(); ++i)
+		addSample(zones[lastFrame.at(i).first], lastFrame.at(i).second);
+	frameZones.clear();
+
+	if (tracing)
+	{
+		TraceEvent e = {FRAME_ZONE, 0, frameStart, now-frameStart};
+		traceEvents.append(e);
+		if (traceEvents.size()>=maxTraceEvents)
+		{
+			qWarning() << "StelProfiler: stop tracing after" << traceEvents.size() << "events";
+			stopTrace();
+		}
+	}
+}
+
+bool StelProfiler::pushZone(int zone)
+{
+	if (QThread::currentThread()!=thread())
+		return false;
+	Q_ASSERT(zone>=0 && zone<zones.size());
+	OpenZone o = {zone, timer.nsecsElapsed()};
+	stack.append(o);
+	return true;
+}
+
+void StelProfiler::endZone()
+{
+	if (stack.isEmpty())
+		return;
+	const OpenZone o = stack.last();
+	stack.removeLast();
+	const qint64 duration = timer.nsecsElapsed()-o.start;
+
+	// A zone nested in itself must not be counted twice
+	bool nested = false;
+	foreach (const OpenZone& outer, stack)
+		nested |= (outer.zone==o.zone);
+	if (!nested)
+	{
+		Zone& z = zones[o.zone];
+		if (z.frameTime==0)
+			frameZones.append(o.zone);
+		z.frameTime += qMax(duration, (qint64)1);
+	}
+
+	if (tracing)
+	{
+		TraceEvent e = {o.zone, stack.size()+1, o.start, duration};
+		traceEvents.append(e);
+	}
+}
+
+void StelProfiler::addSample(Zone& z, float ms)
+{
+	if (z.samples.size()!=windowSize)
+	{
+		z.samples.fill(0.f, windowSize);
+		z.nextSample = 0;
+		z.sampleCount = 0;
+	}
+	z.samples[z.nextSample] = ms;
+	z.nextSample = (z.nextSample+1)%windowSize;
+	z.sampleCount = qMin(z.sampleCount+1, windowSize);
+}
+
+void StelProfiler::clearFrame()
+{
+	stack.clear();
+	foreach (int zone, frameZones)
+		zones[zone].frameTime = 0;
+	frameZones.clear();
+	lastFrame.clear();
+	frameOpen = false;
+}
+
+void StelProfiler::setEnabled(bool b)
+{
+	if (b==enabled)
+		return;
+	if (!b)
+	{
+		stopTrace();
+		clearFrame();
+	}
+	enabled = b;
+	emit enabledChanged(b);
+}
+
+void StelProfiler::setWindowSize(int frames)
+{
+	frames = qMax(frames, 1);
+	if (frames==windowSize)
+		return;
+	windowSize = frames;
+	reset();
+	emit windowSizeChanged(frames);
+}
+
+void StelProfiler::reset()
+{
+	for (int i=0; i<zones.size(); ++i)
+	{
+		zones[i].samples.clear();
+		zones[i].nextSample = 0;
+		zones[i].sampleCount = 0;
+	}
+}
+
+QVariantMap StelProfiler::getStatistics() const
+{
+	QVariantMap res;
+	foreach (const Zone& z, zones)
+	{
+		if (z.sampleCount==0)
+			continue;
+		QVector<float> sorted = z.samples.mid(0, z.sampleCount);
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0.;
+		foreach (float s, sorted)
+			sum += s;
+		// nearest rank
+		const int n = sorted.size();
+		QVariantMap stats;
+		stats.insert("category", z.category);
+		stats.insert("frames", n);
+		stats.insert("mean", sum/n);
+		stats.insert("p50", sorted.at(qMax(0, (int)std::ceil(0.50*n)-1)));
+		stats.insert("p95", sorted.at(qMax(0, (int)std::ceil(0.95*n)-1)));
+		stats.insert("p99", sorted.at(qMax(0, (int)std::ceil(0.99*n)-1)));
+		stats.insert("max", sorted.last());
+		res.insert(z.name, stats);
+	}
+	return res;
+}
+
+QVariantMap StelProfiler::getLastFrame() const
+{
+	QVariantMap res;
+	for (int i=0; i<lastFrame.size(); ++i)
+		res.insert(zones.at(lastFrame.at(i).first).name, lastFrame.at(i).second);
+	return res;
+}
+
+void StelProfiler::logStatistics() const
+{
+	const QVariantMap stats = getStatistics();
+	QList<QPair<double, QString> > lines;
+	for (QVariantMap::const_iterator it=stats.constBegin(); it!=stats.constEnd(); ++it)
+	{
+		const QVariantMap s = it.value().toMap();
+		lines.append(qMakePair(s.value("p95").toDouble(),
+				       QString("%1 mean %2 p50 %3 p95 %4 p99 %5 max %6 ms (%7 frames)")
+				       .arg(it.key(), -32)
+				       .arg(s.value("mean").toDouble(), 0, 'f', 3)
+				       .arg(s.value("p50").toDouble(), 0, 'f', 3)
+				       .arg(s.value("p95").toDouble(), 0, 'f', 3)
+				       .arg(s.value("p99").toDouble(), 0, 'f', 3)
+				       .arg(s.value("max").toDouble(), 0, 'f', 3)
+				       .arg(s.value("frames").toInt())));
+	}
+	std::sort(lines.begin(), lines.end());
+	qDebug() << "Profiler statistics over the last" << windowSize << "frames:";
+	for (int i=lines.size()-1; i>=0; --i)
+		qDebug() << qPrintable(lines.at(i).second);
+}
+
+void StelProfiler::startTrace(int maxEvents)
+{
+	traceEvents.clear();
+	maxTraceEvents = qMax(maxEvents, 1);
+	setEnabled(true);
+	if (!tracing)
+	{
+		tracing = true;
+		emit tracingChanged(true);
+	}
+}
+
+void StelProfiler::stopTrace()
+{
+	if (!tracing)
+		return;
+	tracing = false;
+	emit tracingChanged(false);
+}
+
+static QByteArray jsonString(const QString& s)
+{
+	QString escaped = s;
+	escaped.replace('\\', "\\\\").replace('"', "\\\"");
+	return '"' + escaped.toUtf8() + '"';
+}
+
+QByteArray StelProfiler::getTraceJson() const
+{
+	QByteArray out;
+	out.reserve(100*traceEvents.size()+200);
+	out += "{\"traceEvents\":[\n";
+	out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Main thread\"}}";
+
+	// Chrome needs the events of a thread ordered by start, outer zones first
+	QVector<TraceEvent> events(traceEvents);
+	std::stable_sort(events.begin(), events.end(), traceEventLess);
+	QVector<QByteArray> names(zones.size());
+	QVector<QByteArray> categories(zones.size());
+	for (int i=0; i<zones.size(); ++i)
+	{
+		names[i] = jsonString(zones.at(i).name);
+		categories[i] = jsonString(zones.at(i).category);
+	}
+	foreach (const TraceEvent& e, events)
+	{
+		out += ",\n{\"name\":" + names.at(e.zone) + ",\"cat\":" + categories.at(e.zone)
+		     + ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" + QByteArray::number(e.start*1e-3, 'f', 3)
+		     + ",\"dur\":" + QByteArray::number(e.duration*1e-3, 'f', 3) + "}";
+	}
+	out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return out;
+}
+
+bool StelProfiler::saveTrace(const QString& fileName) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Cannot write profiler trace" << QDir::toNativeSeparators(fileName);
+		return false;
+	}
+	const QByteArray json = getTraceJson();
+	if (file.write(json)!=json.size())
+	{
+		qWarning() << "Cannot write profiler trace" << QDir::toNativeSeparators(fileName);
+		return false;
+	}
+	qDebug() << "Profiler trace with" << traceEvents.size() << "events saved to" << QDir::toNativeSeparators(fileName);
+	return true;
+}
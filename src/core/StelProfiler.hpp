@@ -0,0 +1,208 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELPROFILER_HPP_
+#define _STELPROFILER_HPP_
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+//! @class StelProfiler
+//! Measures where the time of each frame is spent.
+//! StelApp times the update and draw calls of every StelModule, and code can add nested zones for its own hot sections
+//! with the STEL_PROFILE_ZONE macro. For each zone the profiler keeps the time spent per frame over a rolling window
+//! of frames, from which getStatistics() computes percentiles. While tracing, all zones of all frames are recorded and
+//! can be saved in the Chrome trace event format (open with chrome://tracing or https://ui.perfetto.dev).
+//!
+//! Only calls from the main thread are measured. When the profiler is disabled, a zone costs a single test.
+//! The profiler is registered with the StelPropertyMgr as "StelProfiler".
+class StelProfiler : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(bool enabled READ getEnabled WRITE setEnabled NOTIFY enabledChanged)
+	Q_PROPERTY(int windowSize READ getWindowSize WRITE setWindowSize NOTIFY windowSizeChanged)
+	Q_PROPERTY(bool tracing READ isTracing NOTIFY tracingChanged)
+	Q_PROPERTY(QVariantMap statistics READ getStatistics)
+
+public:
+	//! The module calls measured by StelApp
+	enum ModulePhase
+	{
+		PhaseUpdate,
+		PhaseDraw,
+		PhaseCount
+	};
+
+	StelProfiler(QObject* parent=Q_NULLPTR);
+	~StelProfiler();
+
+	//! Return the id of the zone with the given name, registering it first if needed.
+	//! Like the measurements, the zones are not protected by a lock: this returns -1 when called from another
+	//! thread than the one of the profiler (the main thread), and beginZone() ignores that zone.
+	//! @param category a group for the zone, used in the statistics and the trace.
+	int registerZone(const QString& name, const QString& category="zone");
+	//! Return the zone for the given phase of a module, named e.g. "StarMgr.draw".
+	//! Return -1 when called from another thread, like registerZone().
+	int getModuleZone(const QObject* module, ModulePhase phase);
+
+	//! Start measuring a new frame. A frame which is still open is closed first.
+	void beginFrame();
+	//! Close the current frame and add its timings to the statistics.
+	void endFrame();
+
+	//! Start measuring a zone, nested in the zone currently measured if any.
+	//! @return false if nothing is measured, i.e. the profiler is disabled, no frame is open,
+	//! the zone is -1 or the call is not from the main thread. endZone() must only be called if true was returned.
+	bool beginZone(int zone)
+	{
+		if (!enabled || !frameOpen || zone<0)
+			return false;
+		return pushZone(zone);
+	}
+	//! Stop measuring the innermost zone.
+	void endZone();
+
+public slots:
+	//! Enable or disable the profiler. Disabling it stops tracing.
+	void setEnabled(bool b);
+	bool getEnabled() const {return enabled;}
+
+	//! Set the number of frames used for the statistics. Clears the statistics.
+	void setWindowSize(int frames);
+	int getWindowSize() const {return windowSize;}
+
+	//! Clear the statistics.
+	void reset();
+
+	//! Return the statistics of all zones measured during the last frames.
+	//! The key is the zone name ("Frame" for whole frames), the value a map with the category,
+	//! the number of frames in which the zone was measured ("frames") and the "mean", "p50",
+	//! "p95", "p99" and "max" of the time spent in the zone per frame, in milliseconds.
+	QVariantMap getStatistics() const;
+	//! Return the time spent in each zone measured during the last completed frame, in milliseconds.
+	//! The key is the zone name ("Frame" for the whole frame).
+	QVariantMap getLastFrame() const;
+	//! Log the statistics, sorted by 95th percentile.
+	void logStatistics() const;
+
+	//! Start recording a trace of all zones. This enables the profiler.
+	//! @param maxEvents tracing stops automatically after that many events.
+	void startTrace(int maxEvents=2000000);
+	//! Stop recording the trace. The recorded events are kept until the next startTrace().
+	void stopTrace();
+	bool isTracing() const {return tracing;}
+	//! Return the recorded trace in the Chrome trace event JSON format.
+	QByteArray getTraceJson() const;
+	//! Save the recorded trace in the Chrome trace event JSON format.
+	bool saveTrace(const QString& fileName) const;
+
+signals:
+	void enabledChanged(bool b);
+	void windowSizeChanged(int frames);
+	void tracingChanged(bool b);
+
+private:
+	struct Zone
+	{
+		QString name;
+		QString category;
+		//! Time spent in the current frame in ns
+		qint64 frameTime;
+		//! Time per frame in ms, ring buffer of windowSize entries
+		QVector<float> samples;
+		int nextSample;
+		int sampleCount;
+	};
+	struct OpenZone
+	{
+		int zone;
+		qint64 start;
+	};
+	struct TraceEvent
+	{
+		int zone;
+		int depth;
+		qint64 start;
+		qint64 duration;
+	};
+
+	//! Order of the events in the trace: by start time, outer zones first
+	static bool traceEventLess(const TraceEvent& a, const TraceEvent& b)
+	{
+		return a.start<b.start || (a.start==b.start && a.depth<b.depth);
+	}
+
+	bool pushZone(int zone);
+	void addSample(Zone& z, float ms);
+	void clearFrame();
+
+	QElapsedTimer timer;
+	bool enabled;
+	bool frameOpen;
+	bool tracing;
+	int windowSize;
+	int maxTraceEvents;
+	qint64 frameStart;
+	QVector<Zone> zones;
+	QHash<QString, int> zoneIds;
+	QHash<const QObject*, int> moduleZones[PhaseCount];
+	//! Zones measured in the current frame
+	QVector<int> frameZones;
+	//! Zones and times in ms of the last completed frame
+	QVector<QPair<int, float> > lastFrame;
+	QVector<OpenZone> stack;
+	QVector<TraceEvent> traceEvents;
+};
+
+//! @class StelProfileScope
+//! Measures a zone of the StelProfiler until the end of the enclosing block.
+class StelProfileScope
+{
+public:
+	StelProfileScope(StelProfiler* profiler, int zone)
+		: profiler(profiler->beginZone(zone) ? profiler : Q_NULLPTR)
+	{
+	}
+	~StelProfileScope()
+	{
+		if (profiler)
+			profiler->endZone();
+	}
+private:
+	StelProfiler* profiler;
+	Q_DISABLE_COPY(StelProfileScope)
+};
+
+#define STEL_PROFILE_CONCAT_(a, b) a##b
+#define STEL_PROFILE_CONCAT(a, b) STEL_PROFILE_CONCAT_(a, b)
+
+//! Measure the time until the end of the enclosing block as profiler zone name (a string constant),
+//! e.g. STEL_PROFILE_ZONE("StarMgr.drawZones"). Requires StelApp.hpp.
+//! Several zones can be used in the same block, each one is then nested in the previous one.
+//! The zone is registered on first use, which must be from the main thread (see StelProfiler::registerZone()).
+#define STEL_PROFILE_ZONE(name) \
+	static const int STEL_PROFILE_CONCAT(stelProfileZoneId, __LINE__) = StelApp::getInstance().getProfiler()->registerZone(name); \
+	StelProfileScope STEL_PROFILE_CONCAT(stelProfileScope, __LINE__)(StelApp::getInstance().getProfiler(), STEL_PROFILE_CONCAT(stelProfileZoneId, __LINE__))
+
+#endif // _STELPROFILER_HPP_
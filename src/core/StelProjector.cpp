@@ -67,6 +67,35 @@ void StelProjector::Mat4dTransform::backward(Vec3f& v) const
 	v[2] = transfoMatf.r[8]*x + transfoMatf.r[9]*y + transfoMatf.r[10]*z;
 }
 
+void StelProjector::Mat4dTransform::forwardBlock(int count, const Vec3d* in, double* x, double* y, double* z) const
+{
+	// Same operations as Vec3d::transfo4d(), so that the results are identical
+	const double* m = transfoMat.r;
+	for (int i = 0; i < count; ++i)
+	{
+		const double v0 = in[i][0];
+		const double v1 = in[i][1];
+		const double v2 = in[i][2];
+		x[i] = m[0]*v0 + m[4]*v1 + m[8]*v2 + m[12];
+		y[i] = m[1]*v0 + m[5]*v1 + m[9]*v2 + m[13];
+		z[i] = m[2]*v0 + m[6]*v1 + m[10]*v2 + m[14];
+	}
+}
+
+void StelProjector::Mat4dTransform::forwardBlock(int count, const Vec3f* in, float* x, float* y, float* z) const
+{
+	const float* m = transfoMatf.r;
+	for (int i = 0; i < count; ++i)
+	{
+		const float v0 = in[i][0];
+		const float v1 = in[i][1];
+		const float v2 = in[i][2];
+		x[i] = m[0]*v0 + m[4]*v1 + m[8]*v2 + m[12];
+		y[i] = m[1]*v0 + m[5]*v1 + m[9]*v2 + m[13];
+		z[i] = m[2]*v0 + m[6]*v1 + m[10]*v2 + m[14];
+	}
+}
+
 void StelProjector::Mat4dTransform::combine(const Mat4d& m)
 {
 	Mat4f mf(m[0],  m[1] ,  m[2],  m[3],
@@ -123,7 +152,20 @@ void StelProjector::init(const StelProjectorParams& params)
 	viewportFovDiameter = params.viewportFovDiameter * devicePixelsPerPixel;
 	pixelPerRad = 0.5f * viewportFovDiameter / fovToViewScalingFactor(params.fov*(M_PI/360.f));
 	widthStretch = params.widthStretch;
+	viewportClip = params.viewportClip;
+	viewportClip.width *= devicePixelsPerPixel;
+	viewportClip.height *= devicePixelsPerPixel;
 	computeBoundingCap();
+	if (viewportClip.shape!=ViewportClip::ClipNone)
+	{
+		const SphericalRegionP clip = getViewportClipRegion(0.f);
+		if (!clip.isNull())
+		{
+			const SphericalCap clipCap = clip->getBoundingCap();
+			if (clipCap.d>boundingCap.d)
+				boundingCap = clipCap;
+		}
+	}
 }
 
 QString StelProjector::getHtmlSummary() const
@@ -199,6 +241,13 @@ int StelProjector::getViewportHeight() const
 *************************************************************************/
 SphericalRegionP StelProjector::getViewportConvexPolygon(float marginX, float marginY) const
 {
+	if (viewportClip.shape!=ViewportClip::ClipNone)
+	{
+		const SphericalRegionP clip = getViewportClipRegion(qMax(marginX, marginY));
+		if (!clip.isNull())
+			return clip;
+	}
+
 	Vec3d e0, e1, e2, e3;
 	const Vec4i& vp = viewportXywh;
 	bool ok = unProject(vp[0]-marginX,vp[1]-marginY,e0);
@@ -240,6 +289,79 @@ SphericalRegionP StelProjector::getViewportConvexPolygon(float marginX, float ma
 	return SphericalRegionP(new SphericalCap(hp));
 }
 
+SphericalRegionP StelProjector::getViewportClipRegion(float margin) const
+{
+	if (viewportClip.shape==ViewportClip::ClipNone)
+		return SphericalRegionP();
+
+	const Vec4i& vp = viewportXywh;
+	const double cx = vp[0]+0.5*vp[2];
+	const double cy = vp[1]+0.5*vp[3];
+	const double a = viewportClip.angle*M_PI/180.;
+	const double cosa = cos(a);
+	const double sina = sin(a);
+	const bool disk = viewportClip.shape==ViewportClip::ClipDisk;
+	const double hw = 0.5*viewportClip.width+margin;
+	const double hh = disk ? hw : 0.5*viewportClip.height+margin;
+	// Points on the outline of the footprint, counterclockwise in screen coordinates
+	// like the corners used for the whole viewport. The outline of a disk is sampled.
+	static const int DISK_POINTS = 16;
+	const int nbPoints = disk ? DISK_POINTS : 4;
+	Vec3d points[DISK_POINTS];
+	for (int i=0;i<nbPoints;++i)
+	{
+		double x, y;
+		if (disk)
+		{
+			x = hw*cos(2.*M_PI*i/DISK_POINTS);
+			y = hw*sin(2.*M_PI*i/DISK_POINTS);
+		}
+		else
+		{
+			x = (i==1 || i==2) ? hw : -hw;
+			y = i>=2 ? hh : -hh;
+		}
+		const double px = cx + x*cosa - y*sina;
+		const double py = cy + x*sina + y*cosa;
+		// A footprint overflowing the viewport (with its margin) is not worth clipping.
+		if (px<vp[0]-margin || px>vp[0]+vp[2]+margin || py<vp[1]-margin || py>vp[1]+vp[3]+margin)
+			return SphericalRegionP();
+		if (!unProject(px, py, points[i]))
+			return SphericalRegionP();
+		points[i].normalize();
+	}
+
+	if (disk)
+	{
+		Vec3d n;
+		if (!unProject(cx, cy, n))
+			return SphericalRegionP();
+		n.normalize();
+		double d = 1.;
+		for (int i=0;i<nbPoints;++i)
+			d = qMin(d, n*points[i]);
+		// The projection may not be symmetric around the center: leave some room for the outline between the samples.
+		d = cos(acos(qBound(-1., d, 1.))*(1.+M_PI/DISK_POINTS));
+		if (d<=0.)
+			return SphericalRegionP();
+		return SphericalRegionP(new SphericalCap(n, d));
+	}
+
+	if (needGlFrontFaceCW())
+	{
+		qSwap(points[0], points[3]);
+		qSwap(points[1], points[2]);
+	}
+	if (points[3]*((points[2]-points[3])^(points[1]-points[3]))>0)
+	{
+		SphericalConvexPolygon* res = new SphericalConvexPolygon(points[0], points[1], points[2], points[3]);
+		if (res->checkValid())
+			return SphericalRegionP(res);
+		delete res;
+	}
+	return SphericalRegionP();
+}
+
 const SphericalCap& StelProjector::getBoundingCap() const
 {
 	return boundingCap;
@@ -39,6 +39,7 @@ class StelProjector
 public:
 	friend class StelPainter;
 	friend class StelCore;
+	friend class TestStelProjector;
 
 	class ModelViewTranform;
 	//! @typedef ModelViewTranformP
@@ -61,6 +62,33 @@ public:
 		virtual ModelViewTranformP clone() const=0;
 
 		virtual Mat4d getApproximateLinearTransfo() const=0;
+
+		//! Apply forward() to count vectors, writing the results to separate coordinate arrays.
+		//! Used to project large vertex arrays, subclasses can override it with a faster implementation.
+		virtual void forwardBlock(int count, const Vec3d* in, double* x, double* y, double* z) const
+		{
+			Vec3d v;
+			for (int i = 0; i < count; ++i)
+			{
+				v = in[i];
+				forward(v);
+				x[i] = v[0];
+				y[i] = v[1];
+				z[i] = v[2];
+			}
+		}
+		virtual void forwardBlock(int count, const Vec3f* in, float* x, float* y, float* z) const
+		{
+			Vec3f v;
+			for (int i = 0; i < count; ++i)
+			{
+				v = in[i];
+				forward(v);
+				x[i] = v[0];
+				y[i] = v[1];
+				z[i] = v[2];
+			}
+		}
 	};
 
 	class Mat4dTransform: public ModelViewTranform
@@ -74,6 +102,8 @@ public:
         void combine(const Mat4d& m);
         Mat4d getApproximateLinearTransfo() const;
         ModelViewTranformP clone() const;
+		void forwardBlock(int count, const Vec3d* in, double* x, double* y, double* z) const;
+		void forwardBlock(int count, const Vec3f* in, float* x, float* y, float* z) const;
 
 	private:
 		//! transfo matrix and invert
@@ -89,6 +119,31 @@ public:
 		MaskDisk	//!< For disk viewport mode (circular mask to seem like bins/telescope)
 	};
 
+	//! @struct ViewportClip
+	//! The part of the viewport which remains visible when everything around it is masked,
+	//! e.g. the field of an ocular. It is centered on the middle of the viewport.
+	//! When set, getViewportConvexPolygon() and getBoundingCap() only enclose this footprint,
+	//! so that the modules culling with them skip the masked parts of the sky.
+	struct ViewportClip
+	{
+		enum Shape
+		{
+			ClipNone,	//!< The whole viewport is visible
+			ClipDisk,	//!< A disk of diameter width
+			ClipRectangle	//!< A rectangle of size width x height, rotated by angle
+		};
+		ViewportClip() : shape(ClipNone), width(0.f), height(0.f), angle(0.f) {;}
+		bool operator==(const ViewportClip& other) const
+		{
+			return shape==other.shape && width==other.width && height==other.height && angle==other.angle;
+		}
+		bool operator!=(const ViewportClip& other) const {return !(*this==other);}
+
+		Shape shape;
+		float width, height;             //! Size in screen pixels
+		float angle;                     //! Counterclockwise rotation in degrees
+	};
+
 	//! @struct StelProjectorParams
 	//! Contains all the param needed to initialize a StelProjector
 	struct StelProjectorParams
@@ -122,6 +177,7 @@ public:
 		bool flipHorz, flipVert;         //! Whether to flip in horizontal or vertical directions
 		float devicePixelsPerPixel;      //! The number of device pixel per "Device Independent Pixels" (value is usually 1, but 2 for mac retina screens)
 		float widthStretch;              //! A factor to adapt to special installation setups, e.g. multi-projector with edge blending. Allow to stretch/squeeze projected content. Larger than 1 means the image is stretched wider.
+		ViewportClip viewportClip;       //! The visible part of the viewport
 	};
 
 	//! Destructor
@@ -189,11 +245,16 @@ public:
 	//! @param marginY an extra margin in pixel which extends the polygon size in the Y direction.
 	//! @return a SphericalConvexPolygon or the special fullSky region if the viewport cannot be
 	//! represented by a convex polygon (e.g. if aperture > 180 deg).
+	//! If a ViewportClip is set and fits in the viewport, only the clip footprint is included
+	//! (a SphericalCap for a ClipDisk).
 	SphericalRegionP getViewportConvexPolygon(float marginX=0., float marginY=0.) const;
 
-	//! Return a SphericalCap containing the whole viewport
+	//! Return a SphericalCap containing the whole viewport, or only the ViewportClip footprint if it is smaller.
 	const SphericalCap& getBoundingCap() const;
 
+	//! Get the visible part of the viewport, in device pixels.
+	const ViewportClip& getViewportClip() const {return viewportClip;}
+
 	//! Get size of a radian in pixels at the center of the viewport disk
 	float getPixelPerRadAtCenter() const;
 
@@ -314,6 +375,17 @@ protected:
 	//! Initialize the bounding cap.
 	virtual void computeBoundingCap();
 
+	//! Return the region of the sky inside the ViewportClip, extended by a margin in pixels,
+	//! or a null pointer if there is no clip or if it doesn't fit in the viewport.
+	SphericalRegionP getViewportClipRegion(float margin) const;
+
+	//! Implementation of project(int n, ...) for the projection class P, without the two virtual calls per vertex
+	//! of the generic version. The vertices are processed in blocks: ModelViewTranform::forwardBlock() transforms
+	//! a whole block into separate coordinate arrays, then P::forward() (which can be inlined where it is defined)
+	//! and the viewport transformation are applied. The results are the same as with the generic version, except
+	//! with a Refraction, whose forwardBlock() approximates the refraction within 0.03 arcsecond.
+	template <class P, class T> void projectBatch(int n, const Vector3<T>* in, Vec3f* out) const;
+
 	ModelViewTranformP modelViewTransform;	// Operator to apply (if not Q_NULLPTR) before the modelview projection step
 
 	float flipHorz,flipVert;            // Whether to flip in horizontal or vertical directions
@@ -330,9 +402,32 @@ protected:
 	SphericalCap boundingCap;           // Bounding cap of the whole viewport
 	float devicePixelsPerPixel;         // The number of device pixel per "Device Independent Pixels" (value is usually 1, but 2 for mac retina screens)
 	float widthStretch;                 // A factor to adapt to special installation setups, e.g. multi-projector with edge blending. Allow to stretch/squeeze projected content. Larger than 1 means the image is stretched wider.
+	ViewportClip viewportClip;          // The visible part of the viewport, in device pixels
 private:
 	//! Initialise the StelProjector from a param instance.
 	void init(const StelProjectorParams& param);
 };
 
+template <class P, class T>
+void StelProjector::projectBatch(int n, const Vector3<T>* in, Vec3f* out) const
+{
+	static const int BLOCK_SIZE = 64;
+	T x[BLOCK_SIZE], y[BLOCK_SIZE], z[BLOCK_SIZE];
+	const P* prj = static_cast<const P*>(this);
+	for (int start = 0; start < n; start += BLOCK_SIZE)
+	{
+		const int count = qMin(BLOCK_SIZE, n - start);
+		modelViewTransform->forwardBlock(count, in + start, x, y, z);
+		Vec3f* o = out + start;
+		for (int i = 0; i < count; ++i)
+		{
+			o[i].set(x[i], y[i], z[i]);
+			prj->P::forward(o[i]);
+			o[i].set(viewportCenter[0] + flipHorz * pixelPerRad * o[i][0],
+				 viewportCenter[1] + flipVert * pixelPerRad * o[i][1],
+				 (o[i][2] - zNear) * oneOverZNearMinusZFar);
+		}
+	}
+}
+
 #endif // _STELPROJECTOR_HPP_
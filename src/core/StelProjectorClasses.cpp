@@ -53,6 +53,16 @@ bool StelProjectorPerspective::forward(Vec3f &v) const
 	return false;
 }
 
+void StelProjectorPerspective::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorPerspective>(n, in, out);
+}
+
+void StelProjectorPerspective::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorPerspective>(n, in, out);
+}
+
 bool StelProjectorPerspective::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -102,6 +112,16 @@ bool StelProjectorEqualArea::forward(Vec3f &v) const
 	return true;
 }
 
+void StelProjectorEqualArea::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorEqualArea>(n, in, out);
+}
+
+void StelProjectorEqualArea::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorEqualArea>(n, in, out);
+}
+
 bool StelProjectorEqualArea::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -167,6 +187,16 @@ bool StelProjectorStereographic::forward(Vec3f &v) const
 	return true;
 }
 
+void StelProjectorStereographic::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorStereographic>(n, in, out);
+}
+
+void StelProjectorStereographic::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorStereographic>(n, in, out);
+}
+
 bool StelProjectorStereographic::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -228,6 +258,16 @@ bool StelProjectorFisheye::forward(Vec3f &v) const
 	return false;
 }
 
+void StelProjectorFisheye::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorFisheye>(n, in, out);
+}
+
+void StelProjectorFisheye::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorFisheye>(n, in, out);
+}
+
 bool StelProjectorFisheye::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -279,6 +319,16 @@ bool StelProjectorHammer::forward(Vec3f &v) const
 	return true;
 }
 
+void StelProjectorHammer::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorHammer>(n, in, out);
+}
+
+void StelProjectorHammer::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorHammer>(n, in, out);
+}
+
 bool StelProjectorHammer::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -333,6 +383,16 @@ bool StelProjectorCylinder::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorCylinder::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorCylinder>(n, in, out);
+}
+
+void StelProjectorCylinder::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorCylinder>(n, in, out);
+}
+
 bool StelProjectorCylinder::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -381,6 +441,16 @@ bool StelProjectorMercator::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorMercator::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorMercator>(n, in, out);
+}
+
+void StelProjectorMercator::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorMercator>(n, in, out);
+}
+
 
 bool StelProjectorMercator::backward(Vec3d &v) const
 {
@@ -434,6 +504,16 @@ bool StelProjectorOrthographic::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorOrthographic::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorOrthographic>(n, in, out);
+}
+
+void StelProjectorOrthographic::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorOrthographic>(n, in, out);
+}
+
 bool StelProjectorOrthographic::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -487,6 +567,16 @@ bool StelProjectorSinusoidal::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorSinusoidal::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorSinusoidal>(n, in, out);
+}
+
+void StelProjectorSinusoidal::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorSinusoidal>(n, in, out);
+}
+
 bool StelProjectorSinusoidal::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -529,6 +619,16 @@ bool StelProjectorMiller::forward(Vec3f &v) const
 	return rval;
 }
 
+void StelProjectorMiller::project(int n, const Vec3d* in, Vec3f* out)
+{
+	projectBatch<StelProjectorMiller>(n, in, out);
+}
+
+void StelProjectorMiller::project(int n, const Vec3f* in, Vec3f* out)
+{
+	projectBatch<StelProjectorMiller>(n, in, out);
+}
+
 bool StelProjectorMiller::backward(Vec3d &v) const
 {
 	v[0] /= widthStretch;
@@ -29,6 +29,8 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 120.f;}
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &v) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
@@ -47,6 +49,8 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 360.f;}
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &v) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
@@ -65,21 +69,9 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 235.f;}
-	virtual void project(int n, const Vec3d* in, Vec3f* out)
-	{
-		Vec3d v;
-		for (int i = 0; i < n; ++i, ++out)
-		{
-			v = in[i];
-			modelViewTransform->forward(v);
-			out->set(v[0], v[1], v[2]);
-			StelProjectorStereographic::forward(*out);
-			out->set(viewportCenter[0] + flipHorz * pixelPerRad * (*out)[0],
-				viewportCenter[1] + flipVert * pixelPerRad * (*out)[1],
-				((*out)[2] - zNear) * oneOverZNearMinusZFar);
-		}
-	}
 
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &v) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
@@ -98,6 +90,8 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 180.00001f;}
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &v) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
@@ -116,20 +110,8 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 360.f;}
-	virtual void project(int n, const Vec3d* in, Vec3f* out)
-	{
-		Vec3d v;
-		for (int i = 0; i < n; ++i)
-		{
-			v = in[i];
-			modelViewTransform->forward(v);
-			out[i].set(v[0], v[1], v[2]);
-			StelProjectorHammer::forward(out[i]);
-			out[i][0] = viewportCenter[0] + flipHorz * pixelPerRad * out[i][0];
-			out[i][1] = viewportCenter[1] + flipVert * pixelPerRad * out[i][1];
-			out[i][2] = (out[i][2] - zNear) * oneOverZNearMinusZFar;
-		}
-	}
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &v) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
@@ -155,6 +137,8 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 175.f * 4.f/3.f;} // assume aspect ration of 4/3 for getting a full 360 degree horizon
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &win) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
@@ -183,6 +167,8 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 175.f * 4.f/3.f;} // assume aspect ration of 4/3 for getting a full 360 degree horizon
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &win) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
@@ -211,6 +197,8 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 179.9999f;}
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &win) const;
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
@@ -228,6 +216,8 @@ public:
 	StelProjectorSinusoidal(ModelViewTranformP func) : StelProjectorCylinder(func) {;}
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &win) const;
 	bool backward(Vec3d &v) const;
 };
@@ -239,6 +229,8 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 175.f * 4.f/3.f;} // or 180?
+	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	virtual void project(int n, const Vec3f* in, Vec3f* out);
 	bool forward(Vec3f &win) const;
 	bool backward(Vec3d &v) const;
 };
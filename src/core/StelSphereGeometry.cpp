@@ -23,6 +23,7 @@
 
 #include <QDebug>
 #include <QBuffer>
+#include <QtConcurrent>
 #include <stdexcept>
 
 // Definition of static constants.
@@ -698,6 +699,19 @@ QVariantList EmptySphericalRegion::toQVariant() const
 ///////////////////////////////////////////////////////////////////////////////
 // Methods for SphericalPolygon
 ///////////////////////////////////////////////////////////////////////////////
+QVector<SphericalRegionP> SphericalPolygon::createPolygons(const QVector<QVector<QVector<Vec3d> > >& contoursList)
+{
+	QVector<SphericalRegionP> res(contoursList.size());
+	QVector<int> indices(contoursList.size());
+	for (int i=0; i<indices.size(); ++i)
+		indices[i] = i;
+	// The GLUES tesselators used by the OctahedronPolygon constructor don't share any state
+	SphericalRegionP* out = res.data();
+	const QVector<QVector<Vec3d> >* in = contoursList.constData();
+	QtConcurrent::blockingMap(indices, [out, in](int& i) {out[i] = SphericalRegionP(new SphericalPolygon(in[i]));});
+	return res;
+}
+
 SphericalCap SphericalPolygon::getBoundingCap() const
 {
 	SphericalCap res;
@@ -560,6 +560,10 @@ public:
 	SphericalPolygon(const OctahedronPolygon& octContour) : octahedronPolygon(octContour) {;}
 	SphericalPolygon(const QList<OctahedronPolygon>& octContours) : octahedronPolygon(octContours) {;}
 
+	//! Create one polygon for each list of contours.
+	//! The polygons are tesselated in parallel, which is much faster than creating them one by one when loading many polygons.
+	static QVector<SphericalRegionP> createPolygons(const QVector<QVector<QVector<Vec3d> > >& contoursList);
+
 	virtual SphericalRegionType getType() const {return SphericalRegion::Polygon;}
 	virtual OctahedronPolygon getOctahedronPolygon() const {return octahedronPolygon;}
 
@@ -18,22 +18,301 @@
  */
 
 #include "StelSphericalIndex.hpp"
-#include <QVector>
 
-StelSphericalIndex::StelSphericalIndex(int maxObjPerNode, int maxLevel) : maxObjectsPerNode(maxObjPerNode)
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+const int StelSphericalIndex::PartCount;
+
+StelSphericalIndex::StelSphericalIndex(int maxObjPerNode, int amaxLevel)
+	: maxObjectsPerNode(maxObjPerNode)
+	, maxLevel(amaxLevel)
+	, dirty(0)
+{
+	build();
+}
+
+StelSphericalIndex::StelSphericalIndex(const QVector<StelRegionObjectP>& objs, int maxObjPerNode, int amaxLevel)
+	: maxObjectsPerNode(maxObjPerNode)
+	, maxLevel(amaxLevel)
+	, pending(objs)
+	, dirty(0)
 {
-	rootNode = new RootNode(maxObjectsPerNode, maxLevel);
+	build();
 }
 
 StelSphericalIndex::~StelSphericalIndex()
 {
-	delete rootNode;
 }
 
 void StelSphericalIndex::insert(StelRegionObjectP regObj)
 {
-	NodeElem el(regObj);
-	rootNode->insert(el, 0);
+	pending.append(regObj);
+	dirty.storeRelease(1);
+}
+
+void StelSphericalIndex::insert(const QVector<StelRegionObjectP>& objs)
+{
+	pending += objs;
+	build();
+	dirty.storeRelease(0);
+}
+
+void StelSphericalIndex::clear()
+{
+	objects.clear();
+	pending.clear();
+	build();
+	dirty.storeRelease(0);
 }
 
+void StelSphericalIndex::buildLocked()
+{
+	QMutexLocker locker(&buildMutex);
+	if (!dirty.loadAcquire())
+		return;
+	build();
+	dirty.storeRelease(0);
+}
+
+void StelSphericalIndex::build()
+{
+	QVector<StelRegionObjectP> all = objects;
+	all += pending;
+	pending.clear();
+
+	// The regions are needed to place the objects in the tree
+	QVector<SphericalRegionP> allRegions;
+	allRegions.reserve(all.size());
+	QVector<int> order(all.size());
+	for (int i=0; i<all.size(); ++i)
+	{
+		allRegions.append(all.at(i)->getRegion());
+		order[i] = i;
+	}
+
+	nodes.clear();
+	triangles.clear();
+	const Node root = {-1, 0, 0, 0, 0};
+	nodes.append(root);
+	triangles.append(SphericalConvexPolygon());
+	buildNode(0, 0, order, 0, all.size(), allRegions);
+
+	// Store the objects in the order of the nodes
+	objects.resize(all.size());
+	regions.resize(all.size());
+	caps.resize(all.size());
+	points.resize(all.size());
+	for (int i=0; i<all.size(); ++i)
+	{
+		const int j = order.at(i);
+		objects[i] = all.at(j);
+		regions[i] = allRegions.at(j);
+		caps[i] = allRegions.at(j)->getBoundingCap();
+		points[i] = all.at(j)->getPointInRegion();
+	}
+
+	// Bound the points of each subtree for findNearest()
+	pointCaps.resize(nodes.size());
+	for (int node=0; node<nodes.size(); ++node)
+	{
+		const Node& n = nodes.at(node);
+		Vec3d sum(0.);
+		for (int i=n.firstElement; i<n.endElement; ++i)
+		{
+			const double length = points.at(i).length();
+			if (length>0.)
+				sum += points.at(i)/length;
+		}
+		if (sum.lengthSquared()==0.)
+		{
+			// No points, or points all around the sphere
+			pointCaps[node] = SphericalCap(Vec3d(1.,0.,0.), n.firstElement<n.endElement ? -1. : 2.);
+			continue;
+		}
+		sum.normalize();
+		double d = 1.;
+		for (int i=n.firstElement; i<n.endElement; ++i)
+		{
+			const double length = points.at(i).length();
+			if (length>0.)
+				d = qMin(d, sum.dot(points.at(i))/length);
+		}
+		pointCaps[node] = SphericalCap(sum, d);
+	}
+}
+
+void StelSphericalIndex::buildNode(int node, int level, QVector<int>& order, int begin, int end, const QVector<SphericalRegionP>& allRegions)
+{
+	nodes[node].firstElement = begin;
+	nodes[node].nbElements = end-begin;
+	nodes[node].endElement = end;
+	// If we have too many objects in the node, we split it.
+	if (end-begin<=maxObjectsPerNode || level>=maxLevel)
+		return;
+	split(node);
+	const int firstChild = nodes.at(node).firstChild;
+	const int nbChildren = nodes.at(node).nbChildren;
 
+	// Find the child containing each object, or -1 if none does and the object stays in this node
+	QVector<int> childOf(end-begin, -1);
+	QVector<int> offsets(nbChildren+2, 0);
+	for (int i=begin; i<end; ++i)
+	{
+		const SphericalRegion* region = allRegions.at(order.at(i)).data();
+		for (int c=0; c<nbChildren; ++c)
+		{
+			if (static_cast<const SphericalRegion&>(triangles.at(firstChild+c)).contains(region))
+			{
+				childOf[i-begin] = c;
+				break;
+			}
+		}
+		++offsets[childOf.at(i-begin)+2];
+	}
+
+	// Sort the objects by child, keeping their order, with the objects staying in this node first
+	for (int c=2; c<offsets.size(); ++c)
+		offsets[c] += offsets.at(c-1);
+	QVector<int> sorted(end-begin);
+	for (int i=begin; i<end; ++i)
+		sorted[offsets[childOf.at(i-begin)+1]++] = order.at(i);
+	std::copy(sorted.constBegin(), sorted.constEnd(), order.begin()+begin);
+
+	nodes[node].nbElements = offsets.at(0);
+	for (int c=0; c<nbChildren; ++c)
+		buildNode(firstChild+c, level+1, order, begin+offsets.at(c), begin+offsets.at(c+1), allRegions);
+}
+
+void StelSphericalIndex::split(int node)
+{
+	QVector<SphericalConvexPolygon> childTriangles;
+	if (node==0)
+	{
+		// The root is split in the 8 triangles of the octahedron
+		static const Vec3d vertice[6] =
+		{
+			Vec3d(0,0,1), Vec3d(1,0,0), Vec3d(0,1,0), Vec3d(-1,0,0), Vec3d(0,-1,0), Vec3d(0,0,-1)
+		};
+
+		static const int verticeIndice[8][3] =
+		{
+			{0,2,1}, {0,1,4}, {0,4,3}, {0,3,2}, {5,1,2}, {5,4,1}, {5,3,4}, {5,2,3}
+		};
+
+		for (int i=0;i<8;++i)
+		{
+			childTriangles.append(SphericalConvexPolygon(vertice[verticeIndice[i][0]], vertice[verticeIndice[i][1]], vertice[verticeIndice[i][2]]));
+			Q_ASSERT(childTriangles.last().checkValid());
+		}
+	}
+	else
+	{
+		// Split the HTM triangle in 4 subtriangles
+		const SphericalConvexPolygon& triangle = triangles.at(node);
+		Q_ASSERT(triangle.getConvexContour().size() == 3);
+
+		const Vec3d c0 = triangle.getConvexContour().at(0);
+		const Vec3d c1 = triangle.getConvexContour().at(1);
+		const Vec3d c2 = triangle.getConvexContour().at(2);
+
+		Q_ASSERT((c1^c0)*c2 >= 0.0);
+		Vec3d e0(c1[0]+c2[0], c1[1]+c2[1], c1[2]+c2[2]);
+		e0.normalize();
+		Vec3d e1(c2[0]+c0[0], c2[1]+c0[1], c2[2]+c0[2]);
+		e1.normalize();
+		Vec3d e2(c0[0]+c1[0], c0[1]+c1[1], c0[2]+c1[2]);
+		e2.normalize();
+
+		childTriangles.append(SphericalConvexPolygon(e1,c0,e2));
+		childTriangles.append(SphericalConvexPolygon(e0,e2,c1));
+		childTriangles.append(SphericalConvexPolygon(c2,e1,e0));
+		childTriangles.append(SphericalConvexPolygon(e2,e0,e1));
+		for (int i=0; i<4; ++i)
+			Q_ASSERT(childTriangles.at(i).checkValid());
+	}
+
+	nodes[node].firstChild = nodes.size();
+	nodes[node].nbChildren = childTriangles.size();
+	const Node child = {-1, 0, 0, 0, 0};
+	foreach (const SphericalConvexPolygon& t, childTriangles)
+	{
+		nodes.append(child);
+		triangles.append(t);
+	}
+}
+
+void StelSphericalIndex::processPartsParallel(const std::function<void(int)>& query) const
+{
+	ensureBuilt();
+	QVector<int> parts(PartCount);
+	for (int i=0; i<PartCount; ++i)
+		parts[i] = i;
+	QtConcurrent::blockingMap(parts, [&query](int& part) {query(part);});
+}
+
+QVector<StelRegionObjectP> StelSphericalIndex::findNearest(const Vec3d& av, int k, double maxAngle) const
+{
+	ensureBuilt();
+	QVector<StelRegionObjectP> result;
+	if (k<=0)
+		return result;
+	Vec3d v(av);
+	v.normalize();
+
+	// Pairs of angular distance and object or node index
+	typedef std::pair<double, int> Candidate;
+	// The nearest objects found so far, the farthest on top
+	std::priority_queue<Candidate> nearest;
+	// The nodes to visit, by increasing lower bound of the distance of their points
+	std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > toVisit;
+	double limit = maxAngle;
+	toVisit.push(Candidate(0., 0));
+	while (!toVisit.empty())
+	{
+		const Candidate next = toVisit.top();
+		toVisit.pop();
+		if (next.first>limit)
+			break;
+
+		const Node& n = nodes.at(next.second);
+		for (int i=n.firstElement; i<n.firstElement+n.nbElements; ++i)
+		{
+			const double length = points.at(i).length();
+			if (length==0.)
+				continue;
+			const double angle = std::acos(qBound(-1., v.dot(points.at(i))/length, 1.));
+			if (angle>limit)
+				continue;
+			nearest.push(Candidate(angle, i));
+			if (static_cast<int>(nearest.size())>k)
+				nearest.pop();
+			if (static_cast<int>(nearest.size())==k)
+				limit = qMin(limit, nearest.top().first);
+		}
+
+		for (int child=n.firstChild; child<n.firstChild+n.nbChildren; ++child)
+		{
+			const SphericalCap& cap = pointCaps.at(child);
+			if (cap.d>1.)
+				continue;
+			const double bound = std::acos(qBound(-1., v.dot(cap.n), 1.)) - std::acos(cap.d);
+			if (bound<=limit)
+				toVisit.push(Candidate(qMax(0., bound), child));
+		}
+	}
+
+	result.resize(static_cast<int>(nearest.size()));
+	for (int i=result.size()-1; i>=0; --i)
+	{
+		result[i] = objects.at(nearest.top().second);
+		nearest.pop();
+	}
+	return result;
+}
@@ -22,320 +22,249 @@
 
 #include "StelRegionObject.hpp"
 
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+
+#include <functional>
+
 //! @class StelSphericalIndex
 //! Container allowing to store and query SphericalRegion.
+//! The sphere is divided in the 8 triangles of an octahedron, which are recursively split into 4 sub-triangles
+//! (HTM) where they contain more than maxObjectsPerNode objects. Each object is stored in the smallest triangle
+//! containing its region. The nodes and the objects are stored in contiguous arrays, the objects in depth first
+//! order so that the objects of a whole subtree are a single range.
+//!
+//! The index is built at once from all objects, either by the constructor taking the objects or on the first
+//! query after insertions. Objects must not change their region once inserted.
+//! All the queries are const and can be run concurrently, e.g. one per part of the index with processPartsParallel().
 class StelSphericalIndex
 {
 public:
+	//! Number of parts of the index: the objects spanning several octants (part 0), and the 8 octants.
+	//! Queries taking a part argument only process the objects of that part.
+	static const int PartCount = 9;
+
 	StelSphericalIndex(int maxObjectsPerNode = 100, int maxLevel=7);
+	//! Create the index of the given objects. This is faster than inserting them one by one.
+	StelSphericalIndex(const QVector<StelRegionObjectP>& objects, int maxObjectsPerNode = 100, int maxLevel=7);
 	virtual ~StelSphericalIndex();
 
 	//! Insert the given object in the StelSphericalIndex.
+	//! The index is rebuilt on the next query, so prefer inserting many objects at once.
 	void insert(StelRegionObjectP obj);
+	//! Insert the given objects in the StelSphericalIndex and rebuild the index.
+	void insert(const QVector<StelRegionObjectP>& objs);
 
 	//! Process all the objects intersecting the given region using the passed function object.
 	template<class FuncObject> void processIntersectingRegions(const SphericalRegion* region, FuncObject& func) const
 	{
-		rootNode->processIntersectingRegions(region, func);
+		ensureBuilt();
+		for (int part=0; part<PartCount; ++part)
+			processIntersectingRegions(region, func, part);
+	}
+	template<class FuncObject> void processIntersectingRegions(const SphericalRegion* region, FuncObject& func, int part) const
+	{
+		ensureBuilt();
+		if (part==0)
+			processElements(0, region, func, IntersectingRegion());
+		else if (nodes.at(0).nbChildren>0)
+			processChild(nodes.at(0).firstChild+part-1, region, func, IntersectingRegion());
 	}
 
-	//! Process all the objects intersecting the given region using the passed function object.
+	//! Process all the objects whose point (see StelRegionObject::getPointInRegion()) is in the given region using the passed function object.
 	template<class FuncObject> void processIntersectingPointInRegions(const SphericalRegion* region, FuncObject& func) const
 	{
-		rootNode->processIntersectingPointInRegions(region, func);
+		ensureBuilt();
+		for (int part=0; part<PartCount; ++part)
+			processIntersectingPointInRegions(region, func, part);
+	}
+	template<class FuncObject> void processIntersectingPointInRegions(const SphericalRegion* region, FuncObject& func, int part) const
+	{
+		ensureBuilt();
+		if (part==0)
+			processElements(0, region, func, PointInRegion());
+		else if (nodes.at(0).nbChildren>0)
+			processChild(nodes.at(0).firstChild+part-1, region, func, PointInRegion());
 	}
 	
-	//! Process all the objects intersecting the given region using the passed function object.
+	//! Process all the objects whose bounding cap intersects the given cap using the passed function object.
 	template<class FuncObject> void processBoundingCapIntersectingRegions(const SphericalCap& cap, FuncObject& func) const
 	{
-		rootNode->processBoundingCapIntersectingRegions(cap, func);
+		ensureBuilt();
+		for (int part=0; part<PartCount; ++part)
+			processBoundingCapIntersectingRegions(cap, func, part);
+	}
+	template<class FuncObject> void processBoundingCapIntersectingRegions(const SphericalCap& cap, FuncObject& func, int part) const
+	{
+		ensureBuilt();
+		if (part==0)
+			processElements(0, &cap, func, BoundingCapIntersecting());
+		else if (nodes.at(0).nbChildren>0)
+			processChild(nodes.at(0).firstChild+part-1, &cap, func, BoundingCapIntersecting());
 	}
 	
 	//! Process all the objects contained in the given region using the passed function object.
 	template<class FuncObject> void processContainedRegions(const SphericalRegion* region, FuncObject& func) const
 	{
-		rootNode->processContainedRegions(region, func);
+		ensureBuilt();
+		for (int part=0; part<PartCount; ++part)
+			processContainedRegions(region, func, part);
+	}
+	template<class FuncObject> void processContainedRegions(const SphericalRegion* region, FuncObject& func, int part) const
+	{
+		ensureBuilt();
+		if (part==0)
+			processElements(0, region, func, ContainedRegion());
+		else if (nodes.at(0).nbChildren>0)
+			processChild(nodes.at(0).firstChild+part-1, region, func, ContainedRegion());
 	}
 
-	//! Process all the objects intersecting the given region using the passed function object.
+	//! Process all the objects using the passed function object.
 	template<class FuncObject> void processAll(FuncObject& func) const
 	{
-		rootNode->processAll(func);
+		ensureBuilt();
+		processRange(0, objects.size(), func);
 	}
 
+	//! Call query(part) for all the parts of the index in parallel, using the global thread pool. The query is typically
+	//! a lambda calling one of the functions above with the part argument, and a separate function object for each part.
+	//! Returns when all the parts have been processed.
+	void processPartsParallel(const std::function<void(int)>& query) const;
+
+	//! Return the objects whose point (see StelRegionObject::getPointInRegion()) is nearest to the given direction,
+	//! sorted by increasing angular distance. Used to find the object under the mouse.
+	//! @param v the direction, in the frame of the objects.
+	//! @param k the maximum number of objects returned.
+	//! @param maxAngle the maximum angular distance from v in radians.
+	QVector<StelRegionObjectP> findNearest(const Vec3d& v, int k, double maxAngle=M_PI) const;
+
 	//! Remove all the elements in the container.
-	void clear()
-	{
-		rootNode->clear();
-	}
+	void clear();
 
 	//! Return the total number of elements in the container.
-	unsigned int count()
+	unsigned int count() const
 	{
-		CountFunc func;
-		processAll<CountFunc>(func);
-		return func.nb;
+		return objects.size()+pending.size();
 	}
 
 private:
-	struct CountFunc
+	Q_DISABLE_COPY(StelSphericalIndex)
+
+	//! A triangle of the HTM, or the root covering the whole sphere.
+	struct Node
+	{
+		//! Index of the first of the consecutive children in nodes, and their number (0, 4, or 8 for the root).
+		int firstChild;
+		int nbChildren;
+		//! The objects of this node are [firstElement, firstElement+nbElements), those of the whole subtree [firstElement, endElement).
+		int firstElement;
+		int nbElements;
+		int endElement;
+	};
+
+	// Tests applied by the queries to the objects of the nodes partially covered by the region.
+	// The objects of nodes whose triangle is contained in the region are processed without test.
+	struct IntersectingRegion
 	{
-		CountFunc() : nb(0) {;}
-		void operator()(const StelRegionObject*)
+		bool operator()(const SphericalRegion* region, const StelSphericalIndex& index, int i) const
 		{
-			++nb;
+			return region->intersects(index.regions.at(i).data());
 		}
-		unsigned int nb;
 	};
-
-	//! The elements stored in the container.
-	struct NodeElem
+	struct PointInRegion
 	{
-		NodeElem() {;}
-		NodeElem(StelRegionObjectP aobj) : obj(aobj), cap(obj->getRegion()->getBoundingCap()) {;}
-		StelRegionObjectP obj;
-		SphericalCap cap;
+		bool operator()(const SphericalRegion* region, const StelSphericalIndex& index, int i) const
+		{
+			return region->contains(index.points.at(i));
+		}
 	};
-
-	//! @class Node
-	//! The base node class. Final nodes contain a list of NodeElem, other
-	//! nodes link to child nodes subdivising it spatially.
-	struct Node
+	struct BoundingCapIntersecting
 	{
-		virtual ~Node() {;}
-		QVector<NodeElem> elements;
-		QVector<Node> children;
-		SphericalConvexPolygon triangle;
-		//! Split each triangles in to 4 subtriangles.
-		virtual void split()
+		bool operator()(const SphericalCap* cap, const StelSphericalIndex& index, int i) const
 		{
-			// Default implementation for HTM triangle more than level 0
-			Q_ASSERT(children.empty());
-			Q_ASSERT(triangle.getConvexContour().size() == 3);
-
-			const Vec3d& c0 = triangle.getConvexContour().at(0);
-			const Vec3d& c1 = triangle.getConvexContour().at(1);
-			const Vec3d& c2 = triangle.getConvexContour().at(2);
-
-			Q_ASSERT((c1^c0)*c2 >= 0.0);
-			Vec3d e0(c1[0]+c2[0], c1[1]+c2[1], c1[2]+c2[2]);
-			e0.normalize();
-			Vec3d e1(c2[0]+c0[0], c2[1]+c0[1], c2[2]+c0[2]);
-			e1.normalize();
-			Vec3d e2(c0[0]+c1[0], c0[1]+c1[1], c0[2]+c1[2]);
-			e2.normalize();
-
-			children.resize(4);
-			children[0].triangle = SphericalConvexPolygon(e1,c0,e2);
-			Q_ASSERT(children[0].triangle.checkValid());
-			children[1].triangle = SphericalConvexPolygon(e0,e2,c1);
-			Q_ASSERT(children[1].triangle.checkValid());
-			children[2].triangle = SphericalConvexPolygon(c2,e1,e0);
-			Q_ASSERT(children[2].triangle.checkValid());
-			children[3].triangle = SphericalConvexPolygon(e2,e0,e1);
-			Q_ASSERT(children[3].triangle.checkValid());
+			return cap->intersects(index.caps.at(i));
 		}
-
-		//! Suppress everything
-		void clear()
+	};
+	struct ContainedRegion
+	{
+		bool operator()(const SphericalRegion* region, const StelSphericalIndex& index, int i) const
 		{
-			elements.clear();
-			children.clear();
+			return region->contains(index.regions.at(i).data());
 		}
 	};
 
-	//! @class RootNode
-	//! The first Node of a tree. It has a special subdivision of the sphere in an octahedron.
-	class RootNode : public Node
+	//! Process the objects of the node itself which pass the test.
+	template<class Region, class FuncObject, class Test> void processElements(int node, const Region* region, FuncObject& func, const Test& test) const
 	{
-		public:
-			RootNode(int amaxObjectsPerNode, int amaxLevel) : maxObjectsPerNode(amaxObjectsPerNode), maxLevel(amaxLevel)
-			{
-			}
-
-			virtual ~RootNode() {}
-			
-			//! Create the 8 triangles of the octahedron.
-			virtual void split()
-			{
-				static const Vec3d vertice[6] =
-				{
-					Vec3d(0,0,1), Vec3d(1,0,0), Vec3d(0,1,0), Vec3d(-1,0,0), Vec3d(0,-1,0), Vec3d(0,0,-1)
-				};
-
-				static const int verticeIndice[8][3] =
-				{
-					{0,2,1}, {0,1,4}, {0,4,3}, {0,3,2}, {5,1,2}, {5,4,1}, {5,3,4}, {5,2,3}
-				};
-
-				// Create the 8 base triangles
-				Node node;
-				for (int i=0;i<8;++i)
-				{
-					node.triangle = SphericalConvexPolygon(vertice[verticeIndice[i][0]], vertice[verticeIndice[i][1]], vertice[verticeIndice[i][2]]);
-					Q_ASSERT(node.triangle.checkValid());
-					children.append(node);
-				}
-			}
-
-			//! Insert the given element in the StelSphericalIndex.
-			void insert(const NodeElem& el, int level)
-			{
-				insert(*this, el, level);
-			}
-
-			//! Process all the objects intersecting the given region using the passed function object.
-			template<class FuncObject> void processIntersectingRegions(const SphericalRegion* region, FuncObject& func) const
-			{
-				processIntersectingRegions(*this, region, func);
-			}
-			
-			//! Process all the objects intersecting the given region using the passed function object.
-			template<class FuncObject> void processIntersectingPointInRegions(const SphericalRegion* region, FuncObject& func) const
-			{
-				processIntersectingPointInRegions(*this, region, func);
-			}
-			
-			template<class FuncObject> void processBoundingCapIntersectingRegions(const SphericalCap& cap, FuncObject& func) const
-			{
-				processBoundingCapIntersectingRegions(*this, cap, func);
-			}
-
-			//! Process all the objects contained the given region using the passed function object.
-			template<class FuncObject> void processContainedRegions(const SphericalRegion* region, FuncObject& func) const
-			{
-				processContainedRegions(*this, region, func);
-			}
-
-			//! Process all the objects intersecting the given region using the passed function object.
-			template<class FuncObject> void processAll(FuncObject& func) const
-			{
-				processAll(*this, func);
-			}
-
-		private:
-			//! Insert the given element in the given node.
-			void insert(Node& node, const NodeElem& el, int level)
-			{
-				if (node.children.isEmpty())
-				{
-					node.elements.append(el);
-					// If we have too many objects in the node, we split it.
-					if (level<maxLevel && node.elements.size() > maxObjectsPerNode)
-					{
-						node.split();
-						const QVector<NodeElem> nodeElems = node.elements;
-						node.elements.clear();
-						// Re-insert the elements
-						for (QVector<NodeElem>::ConstIterator iter = nodeElems.constBegin();iter != nodeElems.constEnd(); ++iter)
-						{
-							insert(node, *iter, level);
-						}
-					}
-					return;
-				}
-
-				// If we have children and one of them contains the element, store it in a sub-level
-				for (QVector<Node>::iterator iter = node.children.begin(); iter!=node.children.end(); ++iter)
-				{
-					if (((SphericalRegion*)&(iter->triangle))->contains(el.obj->getRegion().data()))
-					{
-						insert(*iter, el, level+1);
-						return;
-					}
-				}
-				// Else store it here
-				node.elements.append(el);
-			}
+		const Node& n = nodes.at(node);
+		for (int i=n.firstElement; i<n.firstElement+n.nbElements; ++i)
+		{
+			if (test(region, *this, i))
+				func(objects.at(i).data());
+		}
+	}
 
-			//! Process all the objects intersecting the given region using the passed function object.
-			template<class FuncObject> void processIntersectingRegions(const Node& node, const SphericalRegion* region, FuncObject& func) const
-			{
-				foreach (const NodeElem& el, node.elements)
-				{
-					if (region->intersects(el.obj->getRegion().data()))
-						func(&(*el.obj));
-				}
-				foreach (const Node& child, node.children)
-				{
-					if (region->contains(child.triangle))
-						processAll(child, func);
-					else if (region->intersects(child.triangle))
-						processIntersectingRegions(child, region, func);
-				}
-			}
-			
-			//! Process all the objects with point intersecting the given region using the passed function object.
-			template<class FuncObject> void processIntersectingPointInRegions(const Node& node, const SphericalRegion* region, FuncObject& func) const
-			{
-				foreach (const NodeElem& el, node.elements)
-				{
-					if (region->contains(el.obj->getPointInRegion()))
-						func(&(*el.obj));
-				}
-				foreach (const Node& child, node.children)
-				{
-					if (region->contains(child.triangle))
-						processAll(child, func);
-					else if (region->intersects(child.triangle))
-						processIntersectingPointInRegions(child, region, func);
-				}
-			}
-			
-			template<class FuncObject> void processBoundingCapIntersectingRegions(const Node& node, const SphericalCap& cap, FuncObject& func) const
-			{
-				foreach (const NodeElem& el, node.elements)
-				{
-					if (cap.intersects(el.cap))
-						func(&(*el.obj));
-				}
-				foreach (const Node& child, node.children)
-				{
-					if (cap.contains(child.triangle))
-						processAll(child, func);
-					else if (cap.intersects(child.triangle))
-						processBoundingCapIntersectingRegions(child, cap, func);
-				}
-			}
+	//! Process a child node and its subtree.
+	template<class Region, class FuncObject, class Test> void processChild(int child, const Region* region, FuncObject& func, const Test& test) const
+	{
+		if (region->contains(triangles.at(child)))
+			processRange(nodes.at(child).firstElement, nodes.at(child).endElement, func);
+		else if (region->intersects(triangles.at(child)))
+			processNode(child, region, func, test);
+	}
 
-			//! Process all the objects contained the given region using the passed function object.
-			template<class FuncObject> void processContainedRegions(const Node& node, const SphericalRegion* region, FuncObject& func) const
-			{
-				foreach (const NodeElem& el, node.elements)
-				{
-					if (region->contains(el.obj->getRegion().data()))
-						func(&(*el.obj));
-				}
-				foreach (const Node& child, node.children)
-				{
-					if (region->contains(child.triangle))
-						processAll(child, func);
-					else if (region->intersects(child.triangle))
-						processContainedRegions(child, region, func);
-				}
-			}
+	template<class Region, class FuncObject, class Test> void processNode(int node, const Region* region, FuncObject& func, const Test& test) const
+	{
+		processElements(node, region, func, test);
+		const Node& n = nodes.at(node);
+		for (int child=n.firstChild; child<n.firstChild+n.nbChildren; ++child)
+			processChild(child, region, func, test);
+	}
 
-			//! Process all the objects intersecting the given region using the passed function object.
-			template<class FuncObject> void processAll(const Node& node, FuncObject& func) const
-			{
-				foreach (const NodeElem& el, node.elements)
-					func(&(*el.obj));
-				foreach (const Node& child, node.children)
-					processAll(child, func);
-			}
+	template<class FuncObject> void processRange(int begin, int end, FuncObject& func) const
+	{
+		for (int i=begin; i<end; ++i)
+			func(objects.at(i).data());
+	}
 
-			//! The maximum number of objects per node.
-			int maxObjectsPerNode;
-			//! The maximum level of the grid. Prevents grid split into too small triangles if unecessary.
-			int maxLevel;
-	};
+	//! Build the index if objects were inserted since the last build. Called by all the queries.
+	void ensureBuilt() const
+	{
+		if (dirty.loadAcquire())
+			const_cast<StelSphericalIndex*>(this)->buildLocked();
+	}
+	void buildLocked();
+	//! Build the index from all the objects, including the pending ones.
+	void build();
+	//! Create the subtree of node from the objects order[begin, end), which are ordered in place.
+	void buildNode(int node, int level, QVector<int>& order, int begin, int end, const QVector<SphericalRegionP>& allRegions);
+	//! Create the children of node, covering its triangle.
+	void split(int node);
 
 	//! The maximum allowed number of object per node.
 	int maxObjectsPerNode;
-
-	RootNode* rootNode;
+	//! The maximum level of the grid. Prevents grid split into too small triangles if unecessary.
+	int maxLevel;
+
+	//! The nodes, the root first. The children of a node are consecutive.
+	QVector<Node> nodes;
+	//! The triangle of each node, empty for the root.
+	QVector<SphericalConvexPolygon> triangles;
+	//! For each node, a cap containing the normalized points of all the objects of its subtree, used by findNearest().
+	//! d is larger than 1 if there are no points.
+	QVector<SphericalCap> pointCaps;
+
+	//! The objects, their region, bounding cap and point, ordered by node.
+	QVector<StelRegionObjectP> objects;
+	QVector<SphericalRegionP> regions;
+	QVector<SphericalCap> caps;
+	QVector<Vec3d> points;
+
+	//! Objects inserted since the last build.
+	QVector<StelRegionObjectP> pending;
+	QAtomicInt dirty;
+	QMutex buildMutex;
 };
 
 #endif // _STELSPHERICALINDEX_HPP_
-
-
@@ -0,0 +1,67 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelSpriteBatch.hpp"
+
+#include <cmath>
+
+// Corners of a sprite in the same order as the triangle strip used by StelPainter::drawSprite2dMode,
+// unrolled into two triangles.
+static const float cornerX[6] = {-1.f,  1.f, -1.f, -1.f,  1.f, 1.f};
+static const float cornerY[6] = {-1.f, -1.f,  1.f,  1.f, -1.f, 1.f};
+static const Vec2f cornerTex[6] = {Vec2f(0.f,0.f), Vec2f(1.f,0.f), Vec2f(0.f,1.f), Vec2f(0.f,1.f), Vec2f(1.f,0.f), Vec2f(1.f,1.f)};
+
+void StelSpriteBatch::reserve(int n)
+{
+	vertices.reserve(n*6);
+	texCoords.reserve(n*6);
+	colors.reserve(n*6);
+}
+
+void StelSpriteBatch::clear()
+{
+	// QVector::resize(0) keeps the capacity, unlike clear()
+	vertices.resize(0);
+	texCoords.resize(0);
+	colors.resize(0);
+}
+
+void StelSpriteBatch::add(float x, float y, float radius, const Vec4f& color)
+{
+	radius *= scale;
+	for (int i=0;i<6;++i)
+	{
+		vertices.append(Vec2f(x+radius*cornerX[i], y+radius*cornerY[i]));
+		texCoords.append(cornerTex[i]);
+		colors.append(color);
+	}
+}
+
+void StelSpriteBatch::add(float x, float y, float radius, float rotation, const Vec4f& color)
+{
+	radius *= scale;
+	const float cosr = std::cos(rotation / 180 * M_PI) * radius;
+	const float sinr = std::sin(rotation / 180 * M_PI) * radius;
+	for (int i=0;i<6;++i)
+	{
+		vertices.append(Vec2f(x + cornerX[i]*cosr - cornerY[i]*sinr, y + cornerX[i]*sinr + cornerY[i]*cosr));
+		texCoords.append(cornerTex[i]);
+		colors.append(color);
+	}
+}
@@ -0,0 +1,76 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELSPRITEBATCH_HPP_
+#define _STELSPRITEBATCH_HPP_
+
+#include "VecMath.hpp"
+
+#include <QVector>
+
+//! @class StelSpriteBatch
+//! Collects textured 2D sprites (screen position, half size, rotation and color) which all use
+//! the same texture, so that they can be submitted with a single draw call using
+//! StelPainter::drawSpriteBatch() instead of one StelPainter::drawSprite2dMode() call per sprite.
+//! The batch only holds CPU-side vertex data and does not require an OpenGL context, which
+//! means that the collection stage can be benchmarked on its own.
+class StelSpriteBatch
+{
+public:
+	StelSpriteBatch() : scale(1.f) {;}
+
+	//! Set the factor applied to all radii added from now on.
+	//! This is typically the device pixel ratio times the global GUI scaling ratio, so that
+	//! sprites have the same size as the ones drawn by StelPainter::drawSprite2dMode().
+	void setScale(float s) {scale=s;}
+	float getScale() const {return scale;}
+
+	//! Reserve room for n sprites to avoid reallocations while collecting.
+	void reserve(int n);
+
+	//! Remove all sprites but keep the allocated memory for the next frame.
+	void clear();
+
+	//! Add an axis aligned sprite.
+	//! @param x x position in the viewport in pixel.
+	//! @param y y position in the viewport in pixel.
+	//! @param radius the half size of a square side in pixel (before scaling).
+	//! @param color the RGBA color modulating the texture.
+	void add(float x, float y, float radius, const Vec4f& color);
+
+	//! Add a rotated sprite.
+	//! @param rotation rotation angle in degree.
+	void add(float x, float y, float radius, float rotation, const Vec4f& color);
+
+	//! Return the number of sprites in the batch.
+	int size() const {return vertices.size()/6;}
+	bool isEmpty() const {return vertices.isEmpty();}
+
+	//! 2D vertex positions, 6 per sprite (2 triangles).
+	QVector<Vec2f> vertices;
+	//! Texture coordinates matching vertices.
+	QVector<Vec2f> texCoords;
+	//! Per vertex colors matching vertices.
+	QVector<Vec4f> colors;
+
+private:
+	float scale;
+};
+
+#endif // _STELSPRITEBATCH_HPP_
@@ -34,7 +34,7 @@
 #include <QFuture>
 #include <QtConcurrent>
 
-StelTexture::StelTexture(StelTextureMgr *mgr) : textureMgr(mgr), gl(Q_NULLPTR), networkReply(Q_NULLPTR), loader(Q_NULLPTR), errorOccured(false), alphaChannel(false), id(0),
+StelTexture::StelTexture(StelTextureMgr *mgr) : textureMgr(mgr), gl(Q_NULLPTR), networkReply(Q_NULLPTR), loader(Q_NULLPTR), errorOccured(false), alphaChannel(false), flagUploadNow(false), id(0),
 	width(-1), height(-1), glSize(0)
 {
 }
@@ -73,6 +73,7 @@ StelTexture::~StelTexture()
 		//networkReply->deleteLater();
 		delete networkReply;
 		networkReply = Q_NULLPTR;
+		textureMgr->downloadCount.deref();
 	}
 	if (loader != Q_NULLPTR) {
 		delete loader;
@@ -109,48 +110,12 @@ void StelTexture::reportError(const QString& aerrorMessage)
 	emit(loadingProcessFinished(true));
 }
 
-StelTexture::GLData StelTexture::imageToGLData(const QImage &image)
+StelTexture::LoaderParams StelTexture::getLoaderParams() const
 {
-	GLData ret = GLData();
-	if (image.isNull())
-		return ret;
-	ret.width = image.width();
-	ret.height = image.height();
-	ret.data = convertToGLFormat(image, &ret.format, &ret.type);
-	return ret;
-}
-
-/*************************************************************************
- Defined to be passed to QtConcurrent::run
- *************************************************************************/
-StelTexture::GLData StelTexture::loadFromPath(const QString &path)
-{
-	try
-	{
-		return imageToGLData(QImage(path));
-	}
-	catch(std::exception& ex) //this catches out-of-memory errors from file conversion
-	{
-		qCritical()<<"Failed loading texture from"<<path<<"error:"<<ex.what();
-		GLData ret;
-		ret.loaderError = ex.what();
-		return ret;
-	}
-}
-
-StelTexture::GLData StelTexture::loadFromData(const QByteArray& data)
-{
-	try
-	{
-		return imageToGLData(QImage::fromData(data));
-	}
-	catch(std::exception& ex)  //this catches out-of-memory errors from file conversion
-	{
-		qCritical()<<"Failed loading texture"<<ex.what();
-		GLData ret;
-		ret.loaderError = ex.what();
-		return ret;
-	}
+	LoaderParams params;
+	params.generateMipmaps = loadParams.generateMipmaps;
+	params.compressedFormats = textureMgr->compressedFormats;
+	return params;
 }
 
 /*************************************************************************
@@ -171,8 +136,11 @@ bool StelTexture::bind(int slot)
 
 	if(load())
 	{
-		// Finally load the data in the main thread.
-		glLoad(loader->result());
+		// Finally load the data in the main thread, unless the uploads of this frame already used the budget.
+		const GLData data = loader->result();
+		if (!flagUploadNow && !textureMgr->reserveUpload(data.getSize()))
+			return false;
+		glLoad(data);
 		delete loader;
 		loader = Q_NULLPTR;
 		if (id != 0)
@@ -195,21 +163,22 @@ void StelTexture::waitForLoaded()
 		qWarning()<<"StelTexture::waitForLoaded called for a network-loaded texture"<<fullPath;
 		Q_ASSERT(0);
 	}
+	flagUploadNow = true;
 	if(loader)
 		loader->waitForFinished();
 }
 
-template <typename T, typename Param, typename Arg>
-void StelTexture::startAsyncLoader(T (*functionPointer)(Param), const Arg &arg)
+template <typename T, typename Param1, typename Arg1, typename Param2, typename Arg2>
+void StelTexture::startAsyncLoader(T (*functionPointer)(Param1, Param2), const Arg1 &arg1, const Arg2 &arg2)
 {
 	Q_ASSERT(loader==Q_NULLPTR);
 #if (QT_VERSION >= QT_VERSION_CHECK(5,4,0))
 	//own thread pool only supported with Qt 5.4+
-	loader = new QFuture<GLData>(QtConcurrent::run(textureMgr->loaderThreadPool, functionPointer, arg));
+	loader = new QFuture<GLData>(QtConcurrent::run(textureMgr->loaderThreadPool, functionPointer, arg1, arg2));
 #else
 	//this restores compatibility with Qt 5.3, with the drawback of potentially using
 	//more memory while loading textures (because more than one can be loaded at a time)
-	loader = new QFuture<GLData>(QtConcurrent::run(functionPointer, arg));
+	loader = new QFuture<GLData>(QtConcurrent::run(functionPointer, arg1, arg2));
 #endif
 }
 
@@ -223,6 +192,7 @@ bool StelTexture::load()
 		req.setRawHeader("User-Agent", StelUtils::getUserAgentString().toLatin1());
 		networkReply = StelApp::getInstance().getNetworkAccessManager()->get(req);
 		connect(networkReply, SIGNAL(finished()), this, SLOT(onNetworkReply()));
+		textureMgr->downloadCount.ref();
 		return false;
 	}
 	// The network connection is still running.
@@ -231,7 +201,7 @@ bool StelTexture::load()
 	// Not a remote file, start a loader from local file.
 	if (loader == Q_NULLPTR)
 	{
-		startAsyncLoader(loadFromPath,fullPath);
+		startAsyncLoader(StelTextureLoader::loadFromPath, fullPath, getLoaderParams());
 		return false;
 	}
 	// Wait until the loader finish.
@@ -247,13 +217,14 @@ void StelTexture::onNetworkReply()
 		if(data.isEmpty()) //prevent starting the loader when there is nothing to load
 			reportError(QString("Empty result received for URL: %1").arg(networkReply->url().toString()));
 		else
-			startAsyncLoader(loadFromData, data);
+			startAsyncLoader(StelTextureLoader::loadFromData, data, getLoaderParams());
 	}
 	else
 		reportError(networkReply->errorString());
 
 	networkReply->deleteLater();
 	networkReply = Q_NULLPTR;
+	textureMgr->downloadCount.deref();
 }
 
 /*************************************************************************
@@ -278,76 +249,9 @@ bool StelTexture::getDimensions(int &awidth, int &aheight)
 	return true;
 }
 
-QByteArray StelTexture::convertToGLFormat(const QImage& image, GLint *format, GLint *type)
-{
-	QByteArray ret;
-	const int width = image.width();
-	const int height = image.height();
-	if (image.isGrayscale())
-	{
-		*format = image.hasAlphaChannel() ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
-	}
-	else if (image.hasAlphaChannel())
-	{
-		*format = GL_RGBA;
-	}
-	else
-		*format = GL_RGB;
-	*type = GL_UNSIGNED_BYTE;
-	int bpp = *format == GL_LUMINANCE_ALPHA ? 2 :
-						  *format == GL_LUMINANCE ? 1 :
-									    *format == GL_RGBA ? 4 :
-												 3;
-
-	ret.reserve(width * height * bpp);
-	QImage tmp = image.convertToFormat(QImage::Format_ARGB32);
-
-	// flips bits over y
-	int ipl = tmp.bytesPerLine() / 4;
-	for (int y = 0; y < height / 2; ++y)
-	{
-		int *a = (int *) tmp.scanLine(y);
-		int *b = (int *) tmp.scanLine(height - y - 1);
-		for (int x = 0; x < ipl; ++x)
-			qSwap(a[x], b[x]);
-	}
-
-	// convert data
-	// we always use a tightly packed format, with 1-4 bpp
-	for (int i = 0; i < height; ++i)
-	{
-		uint *p = (uint *) tmp.scanLine(i);
-		for (int x = 0; x < width; ++x)
-		{
-			uint c = qToBigEndian(p[x]);
-			const char* ptr = (const char*)&c;
-			switch (*format)
-			{
-				case GL_RGBA:
-					ret.append(ptr + 1, 3);
-					ret.append(ptr, 1);
-					break;
-				case GL_RGB:
-					ret.append(ptr + 1, 3);
-					break;
-				case GL_LUMINANCE:
-					ret.append(ptr + 1, 1);
-					break;
-				case GL_LUMINANCE_ALPHA:
-					ret.append(ptr + 1, 1);
-					ret.append(ptr, 1);
-					break;
-				default:
-					Q_ASSERT(false);
-			}
-		}
-	}
-	return ret;
-}
-
 bool StelTexture::glLoad(const GLData& data)
 {
-	if (data.data.isEmpty())
+	if (data.levels.isEmpty())
 	{
 		reportError(data.loaderError.isEmpty()?"Unknown error":data.loaderError);
 		return false;
@@ -384,6 +288,18 @@ bool StelTexture::glLoad(const GLData& data)
 
 	switch(data.format)
 	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGB8_ETC2:
+			alphaChannel = false;
+			break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+		case GL_COMPRESSED_RGBA8_ETC2_EAC:
+			alphaChannel = true;
+			break;
 		case GL_RGBA:
 			//RGBA pixels are always in 4 byte aligned rows
 			gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
@@ -400,12 +316,20 @@ bool StelTexture::glLoad(const GLData& data)
 			alphaChannel = false;
 	}
 
-	//do pixel transfer
-	gl->glTexImage2D(GL_TEXTURE_2D, 0, data.format, width, height, 0, data.format,
-			 data.type, data.data.constData());
-
-	//for now, assume full sized 8 bit GL formats used internally
-	glSize = data.data.size();
+	//do pixel transfer, the mipmaps were prepared by the loader
+	glSize = 0;
+	for (int i=0; i<data.levels.size(); ++i)
+	{
+		const QByteArray& level = data.levels.at(i);
+		const GLsizei w = qMax(1, width>>i);
+		const GLsizei h = qMax(1, height>>i);
+		if (data.compressed)
+			gl->glCompressedTexImage2D(GL_TEXTURE_2D, i, data.format, w, h, 0, level.size(), level.constData());
+		else
+			gl->glTexImage2D(GL_TEXTURE_2D, i, data.format, w, h, 0, data.format, data.type, level.constData());
+		//for now, assume full sized 8 bit GL formats used internally
+		glSize += level.size();
+	}
 
 #ifndef NDEBUG
 	qDebug()<<"StelTexture"<<id<<"uploaded, total memory usage "<<textureMgr->glMemoryUsage / (1024.0 * 1024.0)<<"MB";
@@ -416,12 +340,8 @@ bool StelTexture::glLoad(const GLData& data)
 
 	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, loadParams.wrapMode);
 	gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, loadParams.wrapMode);
-	if (loadParams.generateMipmaps)
-	{
+	if (data.levels.size()>1)
 		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, loadParams.filterMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST);
-		gl->glGenerateMipmap(GL_TEXTURE_2D);
-		glSize = glSize + glSize/3; //mipmaps require 1/3 more mem
-	}
 
 	//register ID with textureMgr and increment size
 	textureMgr->glMemoryUsage += glSize;
@@ -433,8 +353,3 @@ bool StelTexture::glLoad(const GLData& data)
 	return true;
 }
 
-// Actually load the texture to openGL memory
-bool StelTexture::glLoad(const QImage& image)
-{
-	return glLoad(imageToGLData(image));
-}
@@ -22,9 +22,11 @@
 
 #include "StelTextureTypes.hpp"
 #include "StelOpenGL.hpp"
+#include "StelTextureLoader.hpp"
 
 #include <QObject>
 #include <QImage>
+#include <QVector>
 
 class QFile;
 class StelTextureMgr;
@@ -37,6 +39,10 @@ template <class T> class QFuture;
 
 //! @class StelTexture
 //! Base texture class. For creating an instance, use StelTextureMgr::createTexture() and StelTextureMgr::createTextureThread()
+//! The image is decoded, converted and its mipmaps are generated in a loader thread, so that only the upload
+//! is done in the main thread. If a file with the same name and the .ktx or .dds extension is found next to the
+//! image, and its compressed format is supported by the GL context, it is uploaded instead of the image.
+//! Like the textures made from images, the compressed files must be stored with their first row at the bottom.
 //! @sa StelTextureSP
 class StelTexture: public QObject, public QEnableSharedFromThis<StelTexture>
 {
@@ -74,6 +80,7 @@ public:
 	inline void release() const { gl->glBindTexture(GL_TEXTURE_2D, 0 ); }
 
 	//! Waits until the texture data is ready for usage (i.e. bind will return true after this).
+	//! The upload of the texture is then not delayed by the upload budget of the frame.
 	//! Do not use this for potentially network loaded textures.
 	void waitForLoaded();
 
@@ -117,22 +124,10 @@ private slots:
 private:
 	friend class StelTextureMgr;
 
-	//! structure returned by the loader threads, containing all the
-	//! data and information to create the OpenGL texture.
-	struct GLData
-	{
-		GLData() : width(0), height(0), format(0), type(0) {}
-		QString loaderError; //! can contain an error message if data is null
-		QByteArray data;
-		int width;
-		int height;
-		GLint format;
-		GLint type;
-	};
-	//! Those static methods can be called by QtConcurrent::run
-	static GLData imageToGLData(const QImage &image);
-	static GLData loadFromPath(const QString &path);
-	static GLData loadFromData(const QByteArray& data);
+	typedef StelTextureLoader::GLData GLData;
+	typedef StelTextureLoader::LoaderParams LoaderParams;
+
+	LoaderParams getLoaderParams() const;
 
 	//! Private constructor
 	StelTexture(StelTextureMgr* mgr);
@@ -140,9 +135,6 @@ private:
 	//! Wrap an existing GL texture with this object
 	void wrapGLTexture(GLuint texId);
 
-	//! Convert a QImage into opengl compatible format.
-	static QByteArray convertToGLFormat(const QImage& image, GLint* format, GLint* type);
-
 	//! This method should be called if the texture loading failed for any reasons
 	//! @param errorMessage the human friendly error message
 	void reportError(const QString& errorMessage);
@@ -150,16 +142,14 @@ private:
 	//! Load the texture already in the RAM to the openGL memory
 	//! This function uses openGL routines and must be called in the main thread
 	//! @return false if an error occured
-	bool glLoad(const QImage& image);
-	//! Same as glLoad(QImage), but with an image already in OpenGl format
 	bool glLoad(const GLData& data);
 
 	//! Starts the loading process if it has not already started.
 	//! Returns true if the data was loaded, false if not yet ready.
 	bool load();
 
-	template <typename T, typename Param1, typename Arg1>
-	void startAsyncLoader(T (*functionPointer)(Param1), const Arg1 &arg1);
+	template <typename T, typename Param1, typename Arg1, typename Param2, typename Arg2>
+	void startAsyncLoader(T (*functionPointer)(Param1, Param2), const Arg1 &arg1, const Arg2 &arg2);
 
 	//! The parent texture manager
 	StelTextureMgr* textureMgr;
@@ -182,6 +172,9 @@ private:
 	//! True if this texture contains an alpha channel
 	bool alphaChannel;
 
+	//! True if the upload must not wait for the upload budget of the frame
+	bool flagUploadNow;
+
 	//! Human friendly error message if loading failed
 	QString errorMessage;
 
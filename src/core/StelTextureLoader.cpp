@@ -0,0 +1,335 @@
+/*
+ * Stellarium
+ * Copyright (C) 2006 Fabien Chereau
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelTextureLoader.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <cstring>
+#include <exception>
+
+int StelTextureLoader::GLData::getSize() const
+{
+	int size = 0;
+	for (int i=0; i<levels.size(); ++i)
+		size += levels.at(i).size();
+	return size;
+}
+
+StelTextureLoader::GLData StelTextureLoader::imageToGLData(const QImage &image, const LoaderParams& params)
+{
+	GLData ret = GLData();
+	if (image.isNull())
+	{
+		ret.loaderError = "Cannot decode image";
+		return ret;
+	}
+	ret.width = image.width();
+	ret.height = image.height();
+	int bytesPerPixel;
+	ret.levels.append(convertToGLFormat(image, &ret.format, &ret.type, &bytesPerPixel));
+	// The mipmaps are computed here rather than with glGenerateMipmap(), which would stall the main thread
+	if (params.generateMipmaps)
+		generateMipmaps(ret, bytesPerPixel);
+	return ret;
+}
+
+void StelTextureLoader::generateMipmaps(GLData& data, int bytesPerPixel)
+{
+	int w = data.width;
+	int h = data.height;
+	while (w>1 || h>1)
+	{
+		const QByteArray& src = data.levels.last();
+		const uchar* in = reinterpret_cast<const uchar*>(src.constData());
+		const int nw = qMax(1, w/2);
+		const int nh = qMax(1, h/2);
+		QByteArray level(nw*nh*bytesPerPixel, Qt::Uninitialized);
+		uchar* out = reinterpret_cast<uchar*>(level.data());
+		for (int y=0; y<nh; ++y)
+		{
+			// With an odd size, the last row or column of the larger level is dropped like in glGenerateMipmap()
+			const uchar* row0 = in + qMin(2*y, h-1)*w*bytesPerPixel;
+			const uchar* row1 = in + qMin(2*y+1, h-1)*w*bytesPerPixel;
+			for (int x=0; x<nw; ++x)
+			{
+				const int x0 = qMin(2*x, w-1)*bytesPerPixel;
+				const int x1 = qMin(2*x+1, w-1)*bytesPerPixel;
+				for (int c=0; c<bytesPerPixel; ++c)
+					*out++ = (uchar)((row0[x0+c] + row0[x1+c] + row1[x0+c] + row1[x1+c] + 2) / 4);
+			}
+		}
+		data.levels.append(level);
+		w = nw;
+		h = nh;
+	}
+}
+
+QString StelTextureLoader::findCompressedFile(const QString& path)
+{
+	const QFileInfo info(path);
+	const QString suffix = info.suffix().toLower();
+	if (suffix=="ktx" || suffix=="dds")
+		return path;
+	const QString base = info.absolutePath() + "/" + info.completeBaseName();
+	if (QFileInfo(base + ".ktx").exists())
+		return base + ".ktx";
+	if (QFileInfo(base + ".dds").exists())
+		return base + ".dds";
+	return QString();
+}
+
+static inline quint32 readUInt32(const QByteArray& data, int offset)
+{
+	return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data.constData()) + offset);
+}
+
+bool StelTextureLoader::readKTX(const QByteArray& data, GLData& ret)
+{
+	// See https://www.khronos.org/opengles/sdk/tools/KTX/file_format_spec/
+	static const char identifier[12] = {'\xAB', 'K', 'T', 'X', ' ', '1', '1', '\xBB', '\r', '\n', '\x1A', '\n'};
+	if (data.size()<64 || std::memcmp(data.constData(), identifier, sizeof(identifier)))
+		return false;
+	if (readUInt32(data, 12)!=0x04030201)
+	{
+		ret.loaderError = "KTX file with a different endianness";
+		return true;
+	}
+	// glType is 0 for compressed data. Cube maps, arrays and 3D textures are not supported.
+	if (readUInt32(data, 16)!=0 || readUInt32(data, 44)!=0 || readUInt32(data, 48)!=0 || readUInt32(data, 52)!=1)
+	{
+		ret.loaderError = "KTX file is not a compressed 2D texture";
+		return true;
+	}
+	ret.format = readUInt32(data, 28);
+	ret.width = readUInt32(data, 36);
+	ret.height = readUInt32(data, 40);
+	const int levelCount = qMax(1u, readUInt32(data, 56));
+	qint64 offset = 64 + (qint64)readUInt32(data, 60);
+	for (int i=0; i<levelCount; ++i)
+	{
+		if (offset+4>data.size())
+			break;
+		const quint32 imageSize = readUInt32(data, offset);
+		offset += 4;
+		if (offset+(qint64)imageSize>data.size())
+			break;
+		ret.levels.append(data.mid((int)offset, (int)imageSize));
+		offset += (imageSize+3) & ~3u;
+	}
+	if (ret.levels.isEmpty())
+		ret.loaderError = "Truncated KTX file";
+	return true;
+}
+
+bool StelTextureLoader::readDDS(const QByteArray& data, GLData& ret)
+{
+	// See https://msdn.microsoft.com/en-us/library/windows/desktop/bb943982.aspx
+	if (data.size()<128 || std::memcmp(data.constData(), "DDS ", 4) || readUInt32(data, 4)!=124)
+		return false;
+	ret.height = readUInt32(data, 12);
+	ret.width = readUInt32(data, 16);
+	const int levelCount = (readUInt32(data, 8) & 0x20000) ? qMax(1u, readUInt32(data, 28)) : 1;
+	qint64 offset = 128;
+	if (!(readUInt32(data, 80) & 0x4))
+	{
+		ret.loaderError = "DDS file is not compressed";
+		return true;
+	}
+	const QByteArray fourCC = data.mid(84, 4);
+	if (fourCC=="DXT1")
+		ret.format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	else if (fourCC=="DXT3")
+		ret.format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	else if (fourCC=="DXT5")
+		ret.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	else if (fourCC=="DX10" && data.size()>=148)
+	{
+		// The DXGI format of the extended header
+		switch (readUInt32(data, 128))
+		{
+			case 71: case 72: ret.format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+			case 74: case 75: ret.format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+			case 77: case 78: ret.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+			case 98: case 99: ret.format = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+			default: break;
+		}
+		offset = 148;
+	}
+	if (ret.format==0)
+	{
+		ret.loaderError = QString("Unsupported DDS format %1").arg(QString(fourCC));
+		return true;
+	}
+	const int blockSize = ret.format==GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ? 8 : 16;
+	// The sizes of the header are unsigned 32 bits, the size of a level may not fit in an int
+	qint64 w = readUInt32(data, 16);
+	qint64 h = readUInt32(data, 12);
+	for (int i=0; i<levelCount; ++i)
+	{
+		const qint64 blockCount = qMax<qint64>(1, (w+3)/4) * qMax<qint64>(1, (h+3)/4);
+		// Compared before multiplying by the block size, which could overflow even a qint64
+		if (blockCount>(data.size()-offset)/blockSize)
+			break;
+		const qint64 size = blockCount*blockSize;
+		ret.levels.append(data.mid((int)offset, (int)size));
+		offset += size;
+		w = qMax<qint64>(1, w/2);
+		h = qMax<qint64>(1, h/2);
+	}
+	if (ret.levels.isEmpty())
+		ret.loaderError = "Truncated DDS file";
+	return true;
+}
+
+StelTextureLoader::GLData StelTextureLoader::compressedToGLData(const QByteArray& data, const LoaderParams& params)
+{
+	GLData ret;
+	ret.compressed = true;
+	if (!readKTX(data, ret) && !readDDS(data, ret))
+	{
+		ret.loaderError = "Not a KTX or DDS file";
+		return ret;
+	}
+	if (!ret.levels.isEmpty() && !params.compressedFormats.contains(ret.format))
+	{
+		ret.loaderError = QString("Compressed format 0x%1 is not supported").arg(ret.format, 0, 16);
+		ret.levels.clear();
+	}
+	// The mipmaps can't be generated for compressed data, they are used only if the file contains all of them
+	int fullLevelCount = 1;
+	for (int size=qMax(ret.width, ret.height); size>1; size/=2)
+		++fullLevelCount;
+	if (!params.generateMipmaps || ret.levels.size()!=fullLevelCount)
+		ret.levels.resize(qMin(ret.levels.size(), 1));
+	return ret;
+}
+
+/*************************************************************************
+ Defined to be passed to QtConcurrent::run
+ *************************************************************************/
+StelTextureLoader::GLData StelTextureLoader::loadFromPath(const QString &path, const LoaderParams& params)
+{
+	try
+	{
+		// Use the compressed copy of the image if there is one in a supported format
+		const QString compressedPath = params.compressedFormats.isEmpty() ? QString() : findCompressedFile(path);
+		if (!compressedPath.isEmpty())
+		{
+			QFile file(compressedPath);
+			if (file.open(QIODevice::ReadOnly))
+			{
+				GLData ret = compressedToGLData(file.readAll(), params);
+				if (!ret.levels.isEmpty() || compressedPath==path)
+					return ret;
+				qWarning() << "Cannot use compressed texture" << QDir::toNativeSeparators(compressedPath) << ":" << ret.loaderError;
+			}
+		}
+		return imageToGLData(QImage(path), params);
+	}
+	catch(std::exception& ex) //this catches out-of-memory errors from file conversion
+	{
+		qCritical()<<"Failed loading texture from"<<path<<"error:"<<ex.what();
+		GLData ret;
+		ret.loaderError = ex.what();
+		return ret;
+	}
+}
+
+StelTextureLoader::GLData StelTextureLoader::loadFromData(const QByteArray& data, const LoaderParams& params)
+{
+	try
+	{
+		if (!params.compressedFormats.isEmpty() && (data.startsWith("DDS ") || data.startsWith("\xABKTX")))
+			return compressedToGLData(data, params);
+		return imageToGLData(QImage::fromData(data), params);
+	}
+	catch(std::exception& ex)  //this catches out-of-memory errors from file conversion
+	{
+		qCritical()<<"Failed loading texture"<<ex.what();
+		GLData ret;
+		ret.loaderError = ex.what();
+		return ret;
+	}
+}
+
+QByteArray StelTextureLoader::convertToGLFormat(const QImage& image, GLint *format, GLint *type, int* bytesPerPixel)
+{
+	const int width = image.width();
+	const int height = image.height();
+	if (image.isGrayscale())
+	{
+		*format = image.hasAlphaChannel() ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
+	}
+	else if (image.hasAlphaChannel())
+	{
+		*format = GL_RGBA;
+	}
+	else
+		*format = GL_RGB;
+	*type = GL_UNSIGNED_BYTE;
+	int bpp = *format == GL_LUMINANCE_ALPHA ? 2 :
+						  *format == GL_LUMINANCE ? 1 :
+									    *format == GL_RGBA ? 4 :
+												 3;
+	*bytesPerPixel = bpp;
+
+	QByteArray ret(width * height * bpp, Qt::Uninitialized);
+	uchar* out = reinterpret_cast<uchar*>(ret.data());
+	const QImage tmp = image.convertToFormat(QImage::Format_ARGB32);
+
+	// convert data
+	// we always use a tightly packed format, with 1-4 bpp, and the rows flipped over y
+	for (int y = height - 1; y >= 0; --y)
+	{
+		const QRgb *p = reinterpret_cast<const QRgb*>(tmp.constScanLine(y));
+		for (int x = 0; x < width; ++x)
+		{
+			const QRgb c = p[x];
+			switch (*format)
+			{
+				case GL_RGBA:
+					*out++ = qRed(c);
+					*out++ = qGreen(c);
+					*out++ = qBlue(c);
+					*out++ = qAlpha(c);
+					break;
+				case GL_RGB:
+					*out++ = qRed(c);
+					*out++ = qGreen(c);
+					*out++ = qBlue(c);
+					break;
+				case GL_LUMINANCE:
+					*out++ = qRed(c);
+					break;
+				case GL_LUMINANCE_ALPHA:
+					*out++ = qRed(c);
+					*out++ = qAlpha(c);
+					break;
+				default:
+					Q_ASSERT(false);
+			}
+		}
+	}
+	return ret;
+}
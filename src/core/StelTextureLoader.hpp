@@ -0,0 +1,101 @@
+/*
+ * Stellarium
+ * Copyright (C) 2006 Fabien Chereau
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELTEXTURELOADER_HPP_
+#define _STELTEXTURELOADER_HPP_
+
+#include "StelOpenGL.hpp"
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+// Compressed formats which can be read from KTX and DDS files
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9276
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+//! @class StelTextureLoader
+//! What the loader threads of StelTexture do: decode an image or read a KTX or DDS file, and prepare
+//! the levels to upload. It makes no GL call and does not use the StelApp, so it can run in any thread.
+class StelTextureLoader
+{
+public:
+	//! structure returned by the loader threads, containing all the
+	//! data and information to create the OpenGL texture.
+	struct GLData
+	{
+		GLData() : width(0), height(0), format(0), type(0), compressed(false) {}
+		//! Return the number of bytes of all the levels
+		int getSize() const;
+		QString loaderError; //! can contain an error message if levels is empty
+		//! The pixels of the full size image, followed by its mipmaps if they are used
+		QVector<QByteArray> levels;
+		int width;
+		int height;
+		//! The internal format if the data is compressed
+		GLint format;
+		GLint type;
+		bool compressed;
+	};
+	//! What the loader threads need to know to prepare the GLData
+	struct LoaderParams
+	{
+		LoaderParams() : generateMipmaps(false) {}
+		bool generateMipmaps;
+		//! The compressed formats supported by the GL context, empty if compressed files are not used
+		QVector<GLint> compressedFormats;
+	};
+
+	//! Those static methods can be called by QtConcurrent::run
+	static GLData imageToGLData(const QImage &image, const LoaderParams& params);
+	//! Use the compressed copy of the image file if there is one in a supported format, else decode the image.
+	static GLData loadFromPath(const QString &path, const LoaderParams& params);
+	static GLData loadFromData(const QByteArray& data, const LoaderParams& params);
+	//! Read a KTX or DDS file
+	static GLData compressedToGLData(const QByteArray& data, const LoaderParams& params);
+	//! Read a KTX file.
+	//! @return false if the data is not a KTX file, else true with the levels which could be read or an error.
+	static bool readKTX(const QByteArray& data, GLData& ret);
+	//! Read a DDS file.
+	//! @return false if the data is not a DDS file, else true with the levels which could be read or an error.
+	static bool readDDS(const QByteArray& data, GLData& ret);
+	//! Return the path of the compressed copy of an image file, or an empty string if there is none
+	static QString findCompressedFile(const QString& path);
+	//! Compute the mipmaps of a tightly packed image by averaging blocks of 2x2 pixels
+	static void generateMipmaps(GLData& data, int bytesPerPixel);
+
+private:
+	//! Convert a QImage into opengl compatible format.
+	static QByteArray convertToGLFormat(const QImage& image, GLint* format, GLint* type, int* bytesPerPixel);
+};
+
+#endif // _STELTEXTURELOADER_HPP_
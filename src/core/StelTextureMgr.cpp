@@ -34,7 +34,8 @@
 #include <QThreadPool>
 
 StelTextureMgr::StelTextureMgr(QObject *parent)
-	: QObject(parent), glMemoryUsage(0), loaderThreadPool(new QThreadPool(this))
+	: QObject(parent), glMemoryUsage(0), uploadBudget(0), uploadedBytes(0), flagUploadsDeferred(false), flagUploadsPending(false),
+	  loaderThreadPool(new QThreadPool(this))
 {
 #ifdef Q_PROCESSOR_X86_64
 	//allow up to 4 textures to be loaded in parallel on 64 bit
@@ -44,6 +45,33 @@ StelTextureMgr::StelTextureMgr(QObject *parent)
 	//otherwise, for large textures loaded in parallel (some scenery3d scenes), the risk of an out-of-memory error is greater on 32bit systems
 	loaderThreadPool->setMaxThreadCount(1);
 #endif
+
+	QSettings* conf = StelApp::getInstance().getSettings();
+	Q_ASSERT(conf);
+	// Uploading a large texture with its mipmaps can take several ms, limit what is uploaded per frame (in MB)
+	setUploadBudget(conf->value("video/texture_upload_budget", 16).toInt() * 1024 * 1024);
+
+	// Find which formats of the compressed copies of the textures can be used
+	QOpenGLContext* context = QOpenGLContext::currentContext();
+	if (context && conf->value("video/flag_compressed_textures", true).toBool())
+	{
+		if (context->hasExtension("GL_EXT_texture_compression_s3tc"))
+		{
+			compressedFormats << GL_COMPRESSED_RGB_S3TC_DXT1_EXT << GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+					  << GL_COMPRESSED_RGBA_S3TC_DXT3_EXT << GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		}
+		if (context->hasExtension("GL_ARB_texture_compression_bptc") || context->hasExtension("GL_EXT_texture_compression_bptc"))
+			compressedFormats << GL_COMPRESSED_RGBA_BPTC_UNORM;
+		// ETC2 is part of OpenGL ES 3.0 and OpenGL 4.3
+		const QSurfaceFormat format = context->format();
+		if ((context->isOpenGLES() && format.majorVersion()>=3) || format.version()>=qMakePair(4,3) || context->hasExtension("GL_ARB_ES3_compatibility"))
+		{
+			compressedFormats << GL_COMPRESSED_RGB8_ETC2 << GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+					  << GL_COMPRESSED_RGBA8_ETC2_EAC;
+		}
+		if (!compressedFormats.isEmpty())
+			qDebug() << "Compressed textures in KTX or DDS files can be used, with" << compressedFormats.size() << "formats";
+	}
 }
 
 StelTextureSP StelTextureMgr::createTexture(const QString& afilename, const StelTexture::StelTextureParams& params)
@@ -69,13 +97,8 @@ StelTextureSP StelTextureMgr::createTexture(const QString& afilename, const Stel
 
 	StelTextureSP tex = StelTextureSP(new StelTexture(this));
 	tex->fullPath = canPath;
-
-	QImage image(tex->fullPath);
-	if (image.isNull())
-		return StelTextureSP();
-
 	tex->loadParams = params;
-	if (tex->glLoad(image))
+	if (tex->glLoad(StelTextureLoader::loadFromPath(canPath, tex->getLoaderParams())))
 	{
 		textureCache.insert(canPath,tex);
 		return tex;
@@ -180,3 +203,27 @@ StelTextureSP StelTextureMgr::lookupCache(const QString &file)
 	}
 	return StelTextureSP();
 }
+
+bool StelTextureMgr::isLoading() const
+{
+	return downloadCount.load()>0 || loaderThreadPool->activeThreadCount()>0 || flagUploadsPending || flagUploadsDeferred;
+}
+
+void StelTextureMgr::beginFrame()
+{
+	// The textures which could not be uploaded in the last frame need another frame
+	flagUploadsPending = flagUploadsDeferred;
+	flagUploadsDeferred = false;
+	uploadedBytes = 0;
+}
+
+bool StelTextureMgr::reserveUpload(int bytes)
+{
+	if (uploadBudget>0 && uploadedBytes>0 && uploadedBytes+bytes>uploadBudget)
+	{
+		flagUploadsDeferred = true;
+		return false;
+	}
+	uploadedBytes += bytes;
+	return true;
+}
@@ -25,6 +25,8 @@
 #include <QMap>
 #include <QWeakPointer>
 #include <QMutex>
+#include <QAtomicInt>
+#include <QVector>
 
 class QNetworkReply;
 class QThread;
@@ -60,6 +62,17 @@ public:
 	//! Returns the estimated memory usage of all textures currently loaded through StelTexture
 	int getGLMemoryUsage();
 
+	//! Returns true while textures are downloaded or decoded in the background,
+	//! or while their upload is delayed to the next frames by the upload budget.
+	//! Their data is loaded into GL memory the next time they are bound.
+	bool isLoading() const;
+
+	//! Return the number of bytes which can be uploaded to GL memory per frame, 0 if it is not limited.
+	int getUploadBudget() const {return uploadBudget;}
+	//! Set the number of bytes which can be uploaded to GL memory per frame, 0 to not limit it.
+	//! At least one texture is uploaded in each frame, even if it is larger.
+	void setUploadBudget(int bytes) {uploadBudget = bytes;}
+
 private:
 	friend class StelTexture;
 	friend class ImageLoader;
@@ -68,7 +81,22 @@ private:
 	//! Private constructor, use StelApp::getTextureManager for the correct instance
 	StelTextureMgr(QObject* parent = Q_NULLPTR);
 
+	//! Called by StelApp at the beginning of each frame to reset the upload budget
+	void beginFrame();
+	//! Return true if data of the given size can still be uploaded in this frame, and count it
+	bool reserveUpload(int bytes);
+
 	unsigned int glMemoryUsage;
+	//! The compressed formats of KTX and DDS files which are supported by the GL context
+	QVector<GLint> compressedFormats;
+	//! Maximum number of bytes uploaded per frame
+	int uploadBudget;
+	int uploadedBytes;
+	//! Set when an upload was delayed in this frame, and kept for the next one
+	bool flagUploadsDeferred;
+	bool flagUploadsPending;
+	//! Number of textures being downloaded
+	QAtomicInt downloadCount;
 
 	//! We use our own thread pool to ensure only 1 texture is being loaded at a time
 	QThreadPool* loaderThreadPool;
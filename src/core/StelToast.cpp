@@ -101,16 +101,37 @@ bool ToastTile::isCovered(const SphericalCap& viewportShape) const
 }
 
 
+void ToastTile::loadTexture()
+{
+	//qDebug() << "load texture" << imagePath;
+	StelTextureMgr& texMgr=StelApp::getInstance().getTextureManager();
+	texture = texMgr.createTextureThread(imagePath, StelTexture::StelTextureParams(true));
+}
+
+
+void ToastTile::createSubTiles()
+{
+	//qDebug() << "Create children";
+	for (int i = 0; i < 2; ++i)
+		for (int j = 0; j < 2; ++j)
+		{
+			int newLvl = level+1;
+			int newX = 2 * this->x + i;
+			int newY = 2 * this->y + j;
+			ToastTile* tile = survey->getCachedTile(newLvl,newX,newY);
+			subTiles.append( tile ? tile : new ToastTile(survey, newLvl, newX, newY) );
+		}
+
+	Q_ASSERT(subTiles.size() == 4);
+}
+
+
 void ToastTile::prepareDraw()
 {
 	Q_ASSERT(!empty);
 
 	if (texture.isNull())
-	{
-		//qDebug() << "load texture" << imagePath;
-		StelTextureMgr& texMgr=StelApp::getInstance().getTextureManager();
-		texture = texMgr.createTextureThread(imagePath, StelTexture::StelTextureParams(true));
-	}
+		loadTexture();
 	if (texture.isNull() || (!texture->isLoading() && !texture->canBind() && !texture->getErrorMessage().isEmpty()))
 	{
 		if (!texture.isNull())
@@ -130,23 +151,7 @@ void ToastTile::prepareDraw()
 	}
 
 	if (subTiles.isEmpty() && level < getSurvey()->getMaxLevel())
-	{
-		//qDebug() << "Create children";
-		// Create the children
-		for (int i = 0; i < 2; ++i)
-			for (int j = 0; j < 2; ++j)
-			{
-				int newLvl = level+1;
-				int newX = 2 * this->x + i;
-				int newY = 2 * this->y + j;
-				ToastTile* tile = survey->getCachedTile(newLvl,newX,newY);
-				//if(tile)
-				//	qDebug()<<"Cache hit";
-				subTiles.append( tile ? tile : new ToastTile(survey, newLvl, newX, newY) );
-			}
-
-		Q_ASSERT(subTiles.size() == 4);
-	}
+		createSubTiles();
 	prepared = true;
 }
 
@@ -191,7 +196,7 @@ void ToastTile::drawTile(StelPainter* sPainter)
 }
 
 
-void ToastTile::draw(StelPainter* sPainter, const SphericalCap& viewportShape, int maxVisibleLevel)
+int ToastTile::draw(StelPainter* sPainter, const SphericalCap& viewportShape, int maxVisibleLevel)
 {
 	if (!isVisible(viewportShape, maxVisibleLevel))
 	{
@@ -206,21 +211,64 @@ void ToastTile::draw(StelPainter* sPainter, const SphericalCap& viewportShape, i
 		prepared = false;
 		//dont reset the fader
 		//readyDraw = false;
-		return;
+		return 0;
 	}
+	int drawn = 0;
 	if (level==maxVisibleLevel || !isCovered(viewportShape))
+	{
 		drawTile(sPainter);
+		drawn++;
+	}
 
 	// Draw all the children
 	foreach (ToastTile* child, subTiles)
 	{
-		child->draw(sPainter, viewportShape, maxVisibleLevel);
+		drawn += child->draw(sPainter, viewportShape, maxVisibleLevel);
+	}
+	return drawn;
+}
+
+
+int ToastTile::prefetch(const SphericalCap& region, int maxVisibleLevel, int& budget)
+{
+	if (budget <= 0 || !isVisible(region, maxVisibleLevel))
+		return 0;
+	int requested = 0;
+	if (texture.isNull())
+	{
+		loadTexture();
+		budget--;
+		requested++;
+	}
+	// The children can only be requested once the texture of their parent is there, as in prepareDraw().
+	if (!texture.isNull() && texture->canBind() && subTiles.isEmpty()
+	    && level < maxVisibleLevel && level < getSurvey()->getMaxLevel())
+		createSubTiles();
+	foreach (ToastTile* child, subTiles)
+	{
+		requested += child->prefetch(region, maxVisibleLevel, budget);
 	}
+	return requested;
+}
+
+
+int ToastTile::getMemoryUsage() const
+{
+	int size = sizeof(ToastTile) + vertexArray.capacity()*sizeof(Vec3d);
+	if (!texture.isNull())
+		size += texture->getGlSize();
+	foreach (const ToastTile* child, subTiles)
+	{
+		size += child->getMemoryUsage();
+	}
+	return size;
 }
 
 /////// ToastSurvey methods ////////////
 ToastSurvey::ToastSurvey(const QString& path, int amaxLevel)
-	: grid(amaxLevel), path(path), maxLevel(amaxLevel), toastCache(200)
+	: grid(amaxLevel), path(path), maxLevel(amaxLevel), toastCache(64*1024)
+	, lastViewDirection(0.), lastMaxVisibleLevel(-1)
+	, drawnTiles(0), cacheHits(0), cacheMisses(0), prefetchedTiles(0)
 {
 	rootTile = new ToastTile(this, 0, 0, 0);
 }
@@ -253,19 +301,70 @@ void ToastSurvey::draw(StelPainter* sPainter)
 
 	// We also get the viewport shape to discard invisibly tiles.
 	const SphericalCap& viewportRegion = sPainter->getProjector()->getBoundingCap();
-	rootTile->draw(sPainter, viewportRegion, maxVisibleLevel);
+	drawnTiles = rootTile->draw(sPainter, viewportRegion, maxVisibleLevel);
+
+	prefetch(viewportRegion, maxVisibleLevel);
+}
+
+
+void ToastSurvey::prefetch(const SphericalCap& viewportRegion, int maxVisibleLevel)
+{
+	// Number of frames the movement of the view is extrapolated
+	static const double PREFETCH_FRAMES = 10.;
+	// Maximum number of textures requested per frame, to leave the loading threads to the visible tiles
+	static const int PREFETCH_BUDGET = 4;
+
+	const Vec3d motion = viewportRegion.n - lastViewDirection;
+	const bool zoomingIn = lastMaxVisibleLevel>=0 && maxVisibleLevel>lastMaxVisibleLevel;
+	const bool moving = lastMaxVisibleLevel>=0 && motion.lengthSquared()>1e-12;
+	lastViewDirection = viewportRegion.n;
+	lastMaxVisibleLevel = maxVisibleLevel;
+	if (!moving && !zoomingIn)
+		return;
+
+	Vec3d n = viewportRegion.n + motion*PREFETCH_FRAMES;
+	n.normalize();
+	const SphericalCap predictedRegion(n, viewportRegion.d);
+	const int predictedLevel = zoomingIn ? qMin(maxVisibleLevel+1, maxLevel) : maxVisibleLevel;
+	int budget = PREFETCH_BUDGET;
+	prefetchedTiles += rootTile->prefetch(predictedRegion, predictedLevel, budget);
 }
 
 
 ToastTile* ToastSurvey::getCachedTile(int level, int x, int y)
 {
 	ToastTile::Coord c = {level, x, y};
-	return toastCache.take(c);
+	ToastTile* tile = toastCache.take(c);
+	if (tile)
+		cacheHits++;
+	else
+		cacheMisses++;
+	return tile;
 }
 
 
 void ToastSurvey::putIntoCache(ToastTile *tile)
 {
-	//TODO: calculate varying cost depending on tile level and/or loaded subtiles?
-	toastCache.insert(tile->getCoord(),tile);
+	// The cost is the memory of the tile and of the children it still owns, in kilobytes
+	toastCache.insert(tile->getCoord(), tile, qMax(1, tile->getMemoryUsage()/1024));
+}
+
+
+void ToastSurvey::setCacheBudget(int kilobytes)
+{
+	toastCache.setMaxCost(qMax(1, kilobytes));
+}
+
+
+ToastSurvey::Statistics ToastSurvey::getStatistics() const
+{
+	Statistics s;
+	s.drawnTiles = drawnTiles;
+	s.cachedTiles = toastCache.count();
+	s.cacheCost = toastCache.totalCost();
+	s.cacheBudget = toastCache.maxCost();
+	s.cacheHits = cacheHits;
+	s.cacheMisses = cacheMisses;
+	s.prefetchedTiles = prefetchedTiles;
+	return s;
 }
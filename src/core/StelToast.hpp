@@ -61,7 +61,17 @@ public:
 	ToastTile(ToastSurvey *survey, int level, int x, int y);
 	virtual ~ToastTile();
 	Coord getCoord() const { Coord c = { level, x, y }; return c; }
-	void draw(StelPainter* painter, const SphericalCap& viewportShape, int maxVisibleLevel);
+	//! Draw the tile and its visible children.
+	//! @return the number of tiles drawn.
+	int draw(StelPainter* painter, const SphericalCap& viewportShape, int maxVisibleLevel);
+	//! Start loading the textures of the tile and of its existing children which intersect a region
+	//! where the view is expected to be soon, without drawing them.
+	//! @param budget the maximum number of textures to request, decreased by the number requested.
+	//! @return the number of textures requested.
+	int prefetch(const SphericalCap& region, int maxVisibleLevel, int& budget);
+	//! Return the memory used by the tile and its children in bytes, including the loaded textures.
+	//! The texture coordinates and indices shared with other tiles are not counted.
+	int getMemoryUsage() const;
 	bool isTransparent();
 
 protected:
@@ -75,6 +85,10 @@ protected:
 	//! return whether the tile is covered by its children tiles
 	//! This is used to avoid drawing tiles that will be covered anyway
 	bool isCovered(const SphericalCap& viewportShape) const;
+	//! Start loading the texture of the tile.
+	void loadTexture();
+	//! Create the 4 children of the tile, or get them back from the survey cache.
+	void createSubTiles();
 	void prepareDraw();
 
 private:
@@ -104,7 +118,7 @@ private:
 	QList<ToastTile*> subTiles;
 
 	// QList<SphericalRegionP> skyConvexPolygons;
-	//! OpenGL arrays
+	//! OpenGL arrays, the texture and index arrays are shared with the other tiles
 	QVector<Vec3d> vertexArray;
 	QVector<Vec2f> textureArray;
 	QVector<unsigned short> indexArray;
@@ -126,11 +140,33 @@ inline uint qHash(const ToastTile::Coord& key, uint seed = 0)
 
 //! @class ToastSurvey
 //! Represents a full Toast survey.
+//! Tiles which are no longer visible are kept in a cache, whose cost is the memory used by
+//! the tiles in kilobytes, up to a budget set with setCacheBudget().
+//! While the view moves, the tiles where the view is expected to be a few frames later
+//! are requested in advance.
 class ToastSurvey : public QObject
 {
 	Q_OBJECT
 
 public:
+	//! Counters for monitoring the survey.
+	struct Statistics
+	{
+		//! Number of tiles drawn in the last frame
+		int drawnTiles;
+		//! Number of tiles in the cache
+		int cachedTiles;
+		//! Memory used by the cached tiles in kilobytes
+		int cacheCost;
+		//! Maximum memory used by the cached tiles in kilobytes
+		int cacheBudget;
+		//! Number of tiles found or not found in the cache since the survey was created
+		int cacheHits;
+		int cacheMisses;
+		//! Number of textures requested in advance since the survey was created
+		int prefetchedTiles;
+	};
+
 	ToastSurvey(const QString& path, int maxLevel);
 	virtual ~ToastSurvey();
 	QString getTilePath(int level, int x, int y) const;
@@ -145,7 +181,15 @@ public:
 	//! Puts the given tile into the tile cache. The ownership of the tile will be taken.
 	void putIntoCache(ToastTile* tile);
 
+	//! Set the maximum memory used by the cached tiles in kilobytes. Tiles beyond it are deleted, least recently used first.
+	void setCacheBudget(int kilobytes);
+	int getCacheBudget() const {return toastCache.maxCost();}
+	Statistics getStatistics() const;
+
 private:
+	//! Request the tiles visible in the view expected after the current movement of the view.
+	void prefetch(const SphericalCap& viewportRegion, int maxVisibleLevel);
+
 	ToastGrid grid;
 	QString path;
 	ToastTile* rootTile;
@@ -153,6 +197,15 @@ private:
 
 	typedef QCache<ToastTile::Coord, ToastTile> ToastCache;
 	ToastCache toastCache;
+
+	//! View direction and level of the previous frame, to extrapolate the movement of the view
+	Vec3d lastViewDirection;
+	int lastMaxVisibleLevel;
+
+	int drawnTiles;
+	int cacheHits;
+	int cacheMisses;
+	int prefetchedTiles;
 };
 
 #endif // _STELTOAST_HPP_
@@ -121,6 +121,15 @@ QVector<Vec2f> ToastGrid::getTextureArray(int level, int x, int y, int resolutio
 	Q_ASSERT(resolution <= maxLevel);
 	// The size of the returned array
 	int size = pow2(resolution - level) + 1;
+	QVector<Vec2f>& ret = textureArrays[size];
+	if (ret.isEmpty())
+		ret = createTextureArray(size);
+	return ret;
+}
+
+
+QVector<Vec2f> ToastGrid::createTextureArray(int size) const
+{
 	QVector<Vec2f> ret;
 	ret.reserve(size * size);
 	for (int i = size-1; i >= 0; i--)
@@ -140,10 +149,19 @@ QVector<unsigned short> ToastGrid::getTrianglesIndex(int level, int x, int y, in
 	Q_ASSERT(resolution >= level);
 	Q_ASSERT(resolution <= maxLevel);
 	int size = pow2(resolution - level) + 1;
-	int nbTiles = (size - 1) * (size - 1);
 	// If we are in the top right or the bottom left quadrant we invert the diagonal of the triangles.
 	int middleIndex = pow2(level) / 2;
 	bool invert = (x >= middleIndex) == (y >= middleIndex);
+	QVector<unsigned short>& ret = trianglesIndices[size * 2 + (invert ? 1 : 0)];
+	if (ret.isEmpty())
+		ret = createTrianglesIndex(size, invert);
+	return ret;
+}
+
+
+QVector<unsigned short> ToastGrid::createTrianglesIndex(int size, bool invert) const
+{
+	int nbTiles = (size - 1) * (size - 1);
 	QVector<unsigned short> ret;
 	ret.reserve(nbTiles * 6);
 	for (int i = 0; i < size - 1; ++i)
@@ -20,6 +20,7 @@
 #ifndef STELTOASTGRID_HPP
 #define STELTOASTGRID_HPP
 
+#include <QHash>
 #include <QVector>
 #include "VecMath.hpp"
 
@@ -31,6 +32,9 @@ inline int pow2(int x) {return 1 << x;}
 //! The ToastGrid class allows to compute the vertex arrays associated
 //! with TOAST tiles. Each method refers to a tile by its level and x
 //! and y coordinates.
+//! The texture and index arrays only depend on the number of subdivisions of the tile
+//! (and for the indices on the quadrant), so they are computed once and then shared
+//! by all tiles through the implicit sharing of QVector. The grid is not thread safe.
 class ToastGrid
 {
 public:
@@ -64,6 +68,9 @@ public:
 	int getMaxLevel() const {return maxLevel;}
 
 private:
+	QVector<Vec2f> createTextureArray(int size) const;
+	QVector<unsigned short> createTrianglesIndex(int size, bool invert) const;
+
 	//! Get the vector at a given point in the grid
 	const Vec3d& at(int x, int y) const {return grid[y * size + x];}
 	//! Get the vector at a given point in the grid
@@ -85,6 +92,10 @@ private:
 	int size;
 	//! The actual grid data
 	QVector<Vec3d> grid;
+	//! The texture arrays, by size of the array side
+	mutable QHash<int, QVector<Vec2f> > textureArrays;
+	//! The index arrays, by size of the array side times 2, plus 1 if the diagonals are inverted
+	mutable QHash<int, QVector<unsigned short> > trianglesIndices;
 };
 
 #endif // STELTOASTGRID_HPP
@@ -20,9 +20,21 @@
 #include "StelVertexArray.hpp"
 #include "StelProjector.hpp"
 
+#include <QMutex>
+
+quint64 StelVertexArray::newCacheId()
+{
+	// Polygons can be created in several threads
+	static QMutex mutex;
+	static quint64 lastCacheId = 0;
+	QMutexLocker locker(&mutex);
+	return ++lastCacheId;
+}
+
 StelVertexArray StelVertexArray::removeDiscontinuousTriangles(const StelProjector* prj) const
 {
 	StelVertexArray ret = *this;
+	ret.cacheId = 0;
 
 	if (isIndexed())
 	{
@@ -126,6 +138,7 @@ QDataStream& operator>>(QDataStream& in, StelVertexArray& p)
 	in >> p.texCoords;
 	in >> p.colors; // GZ NEW
 	in >> p.indices;
+	p.cacheId = 0;
 	unsigned int t;
 	in >> t;
 	p.primitiveType=(StelVertexArray::StelPrimitiveType)t;
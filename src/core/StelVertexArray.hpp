@@ -39,9 +39,9 @@ struct StelVertexArray
 		TriangleFan                 = 0x0006  // GL_TRIANGLE_FAN
 	};
 
-	StelVertexArray(StelPrimitiveType pType=StelVertexArray::Triangles) : primitiveType(pType) {;}
+	StelVertexArray(StelPrimitiveType pType=StelVertexArray::Triangles) : primitiveType(pType), cacheId(0) {;}
 	StelVertexArray(const QVector<Vec3d>& v, StelPrimitiveType pType=StelVertexArray::Triangles,const QVector<Vec2f>& t=QVector<Vec2f>(), const QVector<unsigned short> i=QVector<unsigned short>()) :
-		vertex(v), texCoords(t), indices(i), primitiveType(pType) {;}
+		vertex(v), texCoords(t), indices(i), primitiveType(pType), cacheId(0) {;}
 
 	//! OpenGL compatible array of 3D vertex to be displayed using vertex arrays.
 	//! TODO, move to float? Most of the vectors are normalized, thus the precision is around 1E-45 using float
@@ -57,6 +57,14 @@ struct StelVertexArray
 
 	StelPrimitiveType primitiveType;
 
+	//! Identifies the content of the array for the drawing caches of StelPainter, 0 if the array must not be cached.
+	//! An owner keeping the array across frames sets it with newCacheId() each time it changes the content,
+	//! the copies of the array then share the identifier.
+	quint64 cacheId;
+
+	//! Return a new cacheId, never returned before.
+	static quint64 newCacheId();
+
 	bool isIndexed() const {return !indices.isEmpty();}
 
 	bool isTextured() const {return !texCoords.isEmpty();}
@@ -589,6 +589,16 @@ int StelVideoMgr::getVideoVolume(const QString& id)
 	return volume;
 }
 
+bool StelVideoMgr::needsRedraw() const
+{
+	foreach (const VideoPlayer* vo, videoObjects)
+	{
+		if (vo->player!=Q_NULLPTR && vo->player->state()==QMediaPlayer::PlayingState)
+			return true;
+	}
+	return false;
+}
+
 bool StelVideoMgr::isVideoPlaying(const QString& id)
 {
 	bool playing=false;
@@ -985,6 +995,8 @@ bool StelVideoMgr::isVideoPlaying(const QString& id)
 	return false;
 }
 
+bool StelVideoMgr::needsRedraw() const {return false;}
+
 #endif // ENABLE_MEDIA
 
 
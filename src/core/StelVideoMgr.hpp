@@ -109,6 +109,8 @@ public slots:
 	//! Update the module with respect to the time. This allows the special effects in playVideoPopout(), and may evaluate things like video resolution when they become available.
 	//! @param deltaTime the time increment in second since last call.
 	virtual void update(double deltaTime);
+	//! Return true while a video is playing.
+	virtual bool needsRedraw() const;
 
 	//! load a video from filename, assign an id for it for later reference.
 	//! If id is already in use, replace it.
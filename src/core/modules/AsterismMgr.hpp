@@ -80,6 +80,9 @@ public:
 	//! as constellation objects are loaded for the required sky culture.
 	virtual void init();
 
+	//! The asterism lines are defined with the stars of the StarMgr.
+	virtual QStringList getInitDependencies() const {return QStringList("StarMgr");}
+
 	//! Draw constellation lines, art, names and boundaries.
 	virtual void draw(StelCore* core);
 
@@ -449,28 +449,26 @@ void Comet::update(int deltaTime)
 		const float brightnessDecreasePerVertexFromHead=1.0f/(COMET_TAIL_SLICES*COMET_TAIL_STACKS)  * avgAtmLum;
 		float brightnessPerVertexFromHead=1.0f;
 
-		gastailColorArr.clear();
-		dusttailColorArr.clear();
-		for (int i=0; i<gastailVertexArr.size(); ++i)
+		// Extinction of all vertices at once. A drop of one magnitude is a factor 2.5 or 40%.
+		const int n=gastailVertexArr.size();
+		QVector<Vec3d> vertAltAz(n);
+		QVector<float> gasMag(n, 0.f);
+		QVector<float> dustMag(n, 0.f);
+		core->j2000ToAltAz(n, gastailVertexArr.constData(), vertAltAz.data(), StelCore::RefractionOn);
+		for (int i=0; i<n; ++i)
+			vertAltAz[i].normalize();
+		extinction.forward(n, vertAltAz.constData(), gasMag.data());
+		core->j2000ToAltAz(n, dusttailVertexArr.constData(), vertAltAz.data(), StelCore::RefractionOn);
+		for (int i=0; i<n; ++i)
+			vertAltAz[i].normalize();
+		extinction.forward(n, vertAltAz.constData(), dustMag.data());
+
+		gastailColorArr.resize(n);
+		dusttailColorArr.resize(n);
+		for (int i=0; i<n; ++i)
 		{
-			// Gastail extinction:
-			Vec3d vertAltAz=core->j2000ToAltAz(gastailVertexArr.at(i), StelCore::RefractionOn);
-			vertAltAz.normalize();
-			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
-			float oneMag=0.0f;
-			extinction.forward(vertAltAz, &oneMag);
-			float extinctionFactor=std::pow(0.4f, oneMag); // drop of one magnitude: factor 2.5 or 40%
-			gastailColorArr.append(gasColor*extinctionFactor* brightnessPerVertexFromHead*intensityFovScale);
-
-			// dusttail extinction:
-			vertAltAz=core->j2000ToAltAz(dusttailVertexArr.at(i), StelCore::RefractionOn);
-			vertAltAz.normalize();
-			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
-			oneMag=0.0f;
-			extinction.forward(vertAltAz, &oneMag);
-			extinctionFactor=std::pow(0.4f, oneMag); // drop of one magnitude: factor 2.5 or 40%
-			dusttailColorArr.append(dustColor*extinctionFactor * brightnessPerVertexFromHead*intensityFovScale);
-
+			gastailColorArr[i]=gasColor*std::pow(0.4f, gasMag.at(i))*brightnessPerVertexFromHead*intensityFovScale;
+			dusttailColorArr[i]=dustColor*std::pow(0.4f, dustMag.at(i))*brightnessPerVertexFromHead*intensityFovScale;
 			brightnessPerVertexFromHead-=brightnessDecreasePerVertexFromHead;
 		}
 	}
@@ -31,6 +31,7 @@
 #include "ConstellationMgr.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <QString>
 #include <QTextStream>
 #include <QDebug>
@@ -44,12 +45,14 @@ Vec3f Constellation::boundaryColor = Vec3f(0.8,0.3,0.3);
 bool Constellation::singleSelected = false;
 bool Constellation::seasonalRuleEnabled = false;
 float Constellation::artIntensityFovScale = 1.0f;
+const double Constellation::Arcs::SAMPLE_STEP = M_PI/180.;
 
 Constellation::Constellation()
 	: numberOfSegments(0)
 	, beginSeason(0)
 	, endSeason(0)
 	, constellation(Q_NULLPTR)
+	, lineArcsJDE(0.)
 {
 }
 
@@ -59,7 +62,7 @@ Constellation::~Constellation()
 	constellation = Q_NULLPTR;
 }
 
-bool Constellation::read(const QString& record, StarMgr *starMgr)
+bool Constellation::read(const QString& record, StarMgr *starMgr, double jde)
 {
 	unsigned int HP;
 
@@ -102,32 +105,89 @@ bool Constellation::read(const QString& record, StarMgr *starMgr)
 	XYZname.set(0.,0.,0.);
 	for(unsigned int ii=0;ii<numberOfSegments*2;++ii)
 	{
-		XYZname+= constellation[ii]->getJ2000EquatorialPos(StelApp::getInstance().getCore());
+		XYZname+= StarMgr::getJ2000EquatorialPosAt(constellation[ii], jde);
 	}
 	XYZname.normalize();
 
 	return true;
 }
 
-void Constellation::drawOptim(StelPainter& sPainter, const StelCore* core, const SphericalCap& viewportHalfspace) const
+void Constellation::Arcs::addArc(const Vec3d& start, const Vec3d& stop)
 {
-	if (lineFader.getInterstate()<=0.0001f)
+	// The points are spread evenly along the great circle, by rotating start toward stop by a constant angle
+	const double angle = std::acos(qBound(-1., start*stop, 1.));
+	const int nbSegments = qMax(1, (int)std::ceil(angle/SAMPLE_STEP));
+	Vec3d previous = start;
+	if (nbSegments>1)
+	{
+		// Unit vector orthogonal to start in the plane of the great circle, toward stop
+		Vec3d ortho = stop - start*(start*stop);
+		ortho.normalize();
+		const double step = angle/nbSegments;
+		for (int i=1; i<nbSegments; ++i)
+		{
+			const Vec3d p = start*std::cos(i*step) + ortho*std::sin(i*step);
+			points << previous << p;
+			previous = p;
+		}
+	}
+	points << previous << stop;
+}
+
+void Constellation::Arcs::updateBoundingCap()
+{
+	Vec3d center(0.);
+	foreach (const Vec3d& p, points)
+		center+=p;
+	if (center.lengthSquared()<1e-12)
+	{
+		// The points surround a whole hemisphere
+		boundingCap = SphericalCap(Vec3d(1.,0.,0.), -1.);
 		return;
+	}
+	center.normalize();
+	double d = 1.;
+	foreach (const Vec3d& p, points)
+		d = qMin(d, center*p);
+	boundingCap = SphericalCap(center, d-1e-9);
+}
 
-	if (checkVisibility())
+void Constellation::buildLineArcs(double jde)
+{
+	lineArcs.clear();
+	for (unsigned int i=0;i<numberOfSegments;++i)
 	{
-		sPainter.setColor(lineColor[0], lineColor[1], lineColor[2], lineFader.getInterstate());
+		Vec3d star1=StarMgr::getJ2000EquatorialPosAt(constellation[2*i], jde);
+		Vec3d star2=StarMgr::getJ2000EquatorialPosAt(constellation[2*i+1], jde);
+		star1.normalize();
+		star2.normalize();
+		lineArcs.addArc(star1, star2);
+	}
+	lineArcs.updateBoundingCap();
+	lineArcsJDE = jde;
+}
 
-		Vec3d star1;
-		Vec3d star2;
-		for (unsigned int i=0;i<numberOfSegments;++i)
+void Constellation::buildBoundaryArcs()
+{
+	isolatedBoundaryArcs.clear();
+	sharedBoundaryArcs.clear();
+	for (int k=0; k<2; ++k)
+	{
+		const std::vector<std::vector<Vec3f> *>& segments = k==0 ? isolatedBoundarySegments : sharedBoundarySegments;
+		Arcs& arcs = k==0 ? isolatedBoundaryArcs : sharedBoundaryArcs;
+		for (size_t i=0;i<segments.size();i++)
 		{
-			star1=constellation[2*i]->getJ2000EquatorialPos(core);
-			star2=constellation[2*i+1]->getJ2000EquatorialPos(core);
-			star1.normalize();
-			star2.normalize();			
-			sPainter.drawGreatCircleArc(star1, star2, &viewportHalfspace);			
+			const std::vector<Vec3f>& points = *segments[i];
+			for (size_t j=0;j+1<points.size();j++)
+			{
+				const Vec3f& pt1 = points[j];
+				const Vec3f& pt2 = points[j+1];
+				if (pt1*pt2>0.9999999f)
+					continue;
+				arcs.addArc(Vec3d(pt1[0], pt1[1], pt1[2]), Vec3d(pt2[0], pt2[1], pt2[2]));
+			}
 		}
+		arcs.updateBoundingCap();
 	}
 }
 
@@ -211,43 +271,6 @@ void Constellation::update(int deltaTime)
 	boundaryFader.update(deltaTime);
 }
 
-void Constellation::drawBoundaryOptim(StelPainter& sPainter) const
-{
-	if (!boundaryFader.getInterstate())
-		return;
-
-	sPainter.setBlending(true);
-	sPainter.setColor(boundaryColor[0], boundaryColor[1], boundaryColor[2], boundaryFader.getInterstate());
-
-	unsigned int i, j;
-	size_t size;
-	Vec3f pt1, pt2;
-	Vec3d ptd1, ptd2;
-	std::vector<Vec3f> *points;
-
-	if (singleSelected) size = isolatedBoundarySegments.size();
-	else size = sharedBoundarySegments.size();
-
-	const SphericalCap& viewportHalfspace = sPainter.getProjector()->getBoundingCap();
-
-	for (i=0;i<size;i++)
-	{
-		if (singleSelected) points = isolatedBoundarySegments[i];
-		else points = sharedBoundarySegments[i];
-
-		for (j=0;j<points->size()-1;j++)
-		{
-			pt1 = points->at(j);
-			pt2 = points->at(j+1);
-			if (pt1*pt2>0.9999999f)
-				continue;
-			ptd1.set(pt1[0], pt1[1], pt1[2]);
-			ptd2.set(pt2[0], pt2[1], pt2[2]);
-			sPainter.drawGreatCircleArc(ptd1, ptd2, &viewportHalfspace);
-		}
-	}
-}
-
 bool Constellation::checkVisibility() const
 {
 	// Is supported seasonal rules by current starlore?
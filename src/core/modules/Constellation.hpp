@@ -32,6 +32,7 @@
 #include <vector>
 #include <QString>
 #include <QFont>
+#include <QVector>
 
 class StarMgr;
 class StelPainter;
@@ -80,15 +81,14 @@ private:
 	//! catalogue numbers which, when connected pairwise, form the lines of the
 	//! constellation.
 	//! @param starMgr a pointer to the StarManager object.
+	//! @param jde the date of the star positions used to place the name.
 	//! @return false if can't parse record, else true.
-	bool read(const QString& record, StarMgr *starMgr);
+	bool read(const QString& record, StarMgr *starMgr, double jde);
 
 	//! Draw the constellation name
 	void drawName(StelPainter& sPainter, ConstellationMgr::ConstellationDisplayStyle style) const;
 	//! Draw the constellation art
 	void drawArt(StelPainter& sPainter) const;
-	//! Draw the constellation boundary
-	void drawBoundaryOptim(StelPainter& sPainter) const;
 
 	//! Test if a star is part of a Constellation.
 	//! This member tests to see if a star is one of those which make up
@@ -109,10 +109,6 @@ private:
 	QString getEnglishName() const {return englishName;}
 	//! Get the short name for the Constellation (returns the abbreviation).
 	QString getShortName() const {return abbreviation;}
-	//! Draw the lines for the Constellation.
-	//! This method uses the coords of the stars (optimized for use through
-	//! the class ConstellationMgr only).
-	void drawOptim(StelPainter& sPainter, const StelCore* core, const SphericalCap& viewportHalfspace) const;
 	//! Draw the art texture, optimized function to be called through a constellation manager only.
 	void drawArtOptim(StelPainter& sPainter, const SphericalRegion& region) const;
 	//! Update fade levels according to time since various events.
@@ -142,6 +138,32 @@ private:
 	//! @return true if Constellation art rendering it turned on, else false.
 	bool getFlagArt() const {return artFader;}
 
+	//! The great circle arcs of the lines or of the boundaries, sampled when they are loaded.
+	//! ConstellationMgr only projects the points at each frame and draws the arcs of all constellations at once.
+	struct Arcs
+	{
+		//! Add the great circle arc from start to stop, which must be shorter than 180 deg.
+		//! The arc is split in segments of equal angle, none longer than SAMPLE_STEP.
+		void addArc(const Vec3d& start, const Vec3d& stop);
+		//! Compute the bounding cap once all arcs are added.
+		void updateBoundingCap();
+		void clear() {points.clear(); boundingCap = SphericalCap(Vec3d(1.,0.,0.), 1.);}
+
+		//! End points of the segments, by pairs
+		QVector<Vec3d> points;
+		//! Cap containing all the points, used to cull the constellation
+		SphericalCap boundingCap;
+		//! Maximum angle between the end points of a segment in radian.
+		//! The projected great circles are nearly straight at this scale, even with a fisheye projection.
+		static const double SAMPLE_STEP;
+	};
+
+	//! Sample the lines between the stars, at their positions for the given date.
+	//! It does not use the StelCore, so that the sky culture can be loaded in a worker thread.
+	void buildLineArcs(double jde);
+	//! Sample the boundaries, once they are loaded.
+	void buildBoundaryArcs();
+
 	//! Check visibility of starlore elements (using for seasonal rules)
 	//! @return true if starlore elements rendering it turned on, else false.
 	bool checkVisibility() const;
@@ -180,6 +202,13 @@ private:
 	std::vector<std::vector<Vec3f> *> isolatedBoundarySegments;
 	std::vector<std::vector<Vec3f> *> sharedBoundarySegments;
 
+	//! The sampled lines, and the JDE of the star positions used
+	Arcs lineArcs;
+	double lineArcsJDE;
+	//! The sampled boundaries, drawn when a single constellation is selected or not (see singleSelected)
+	Arcs isolatedBoundaryArcs;
+	Arcs sharedBoundaryArcs;
+
 	//! Currently we only need one color for all constellations, this may change at some point
 	static Vec3f lineColor;
 	static Vec3f labelColor;
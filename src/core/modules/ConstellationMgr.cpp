@@ -25,6 +25,7 @@
 #include "StelUtils.hpp"
 #include "StelApp.hpp"
 #include "StelTextureMgr.hpp"
+#include "StelTexture.hpp"
 #include "StelProjector.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelLocaleMgr.hpp"
@@ -36,8 +37,12 @@
 #include "StelPainter.hpp"
 #include "StelSkyDrawer.hpp"
 #include "SolarSystem.hpp"
+#ifndef DISABLE_SCRIPTING
+#include "StelScriptMgr.hpp"
+#endif
 
 #include <vector>
+#include <cmath>
 #include <QDebug>
 #include <QFile>
 #include <QSettings>
@@ -45,9 +50,127 @@
 #include <QString>
 #include <QStringList>
 #include <QDir>
+#include <QImageReader>
+#include <QtConcurrent>
 
 using namespace std;
 
+struct ConstellationMgr::SkyCultureData
+{
+	SkyCultureData() : jde(0.), seasonalRulesEnabled(false) {}
+	~SkyCultureData()
+	{
+		for (vector<Constellation*>::iterator iter = constellations.begin(); iter != constellations.end(); ++iter)
+			delete (*iter);
+		for (vector<vector<Vec3f> *>::iterator iter = boundarySegments.begin(); iter != boundarySegments.end(); ++iter)
+			delete (*iter);
+	}
+
+	QString cultureName;
+	QString linesFile;
+	QString artFile;
+	QString namesFile;
+	QString seasonalRulesFile;
+	QString boundariesFile;
+	//! The date of the star positions, read in the main thread: the worker must not use the StelCore
+	double jde;
+
+	vector<Constellation*> constellations;
+	vector<vector<Vec3f> *> boundarySegments;
+	//! The art texture file of the constellations, the textures are created in the main thread
+	QList<QPair<Constellation*, QString> > artTextureFiles;
+	bool seasonalRulesEnabled;
+};
+
+//! @struct ConstellationLinesBatch
+//! The projected segments of the lines or boundaries of all constellations, drawn with a single call.
+struct ConstellationLinesBatch
+{
+	//! Prepare to add the arcs sampled with the given step for the viewport of the projector.
+	void setViewport(const StelProjector& prj, double sampleStep);
+	//! Project the sampled arcs of a constellation (see Constellation::Arcs) and add the segments near the viewport.
+	//! The segments must not be longer than the sample step given to setViewport().
+	void add(const StelProjector& prj, const QVector<Vec3d>& points, const Vec4f& color);
+	//! Draw the content of the batch and clear it.
+	void flush(StelPainter& sPainter);
+	//! Project the end of the part of the segment from p1 to p2 which can be projected, when p1 can be and p2 can't.
+	static void clipSegment(const StelProjector& prj, Vec3d p1, Vec3d p2, Vec3d& win);
+
+	//! Minimum scalar product between the center of the viewport and the first point of a segment near the viewport
+	double minViewportDistance;
+	//! End points of the segments in screen coordinates, by pairs
+	QVector<Vec2f> vertices;
+	QVector<Vec4f> colors;
+};
+
+// Kept between frames to reuse the allocated memory
+static ConstellationLinesBatch constellationLinesBatch;
+
+void ConstellationLinesBatch::setViewport(const StelProjector& prj, double sampleStep)
+{
+	const double radius = prj.getBoundingCap().getRadius() + sampleStep;
+	minViewportDistance = radius<M_PI ? std::cos(radius) : -2.;
+}
+
+void ConstellationLinesBatch::add(const StelProjector& prj, const QVector<Vec3d>& points, const Vec4f& color)
+{
+	const Vec3d& viewportCenter = prj.getBoundingCap().n;
+	const Vec3d* p = points.constData();
+	Vec3d win1, win2;
+	for (int i=0; i<points.size(); i+=2)
+	{
+		// The segment is not longer than the sample step (see Constellation::Arcs::addArc), check its first point only
+		if (viewportCenter*p[i]<minViewportDistance)
+			continue;
+		const bool valid1 = prj.project(p[i], win1);
+		const bool valid2 = prj.project(p[i+1], win2);
+		if (!valid1 && !valid2)
+			continue;
+		// Keep the part of the segment which can be projected, e.g. in front of the observer
+		if (!valid1)
+			clipSegment(prj, p[i+1], p[i], win1);
+		else if (!valid2)
+			clipSegment(prj, p[i], p[i+1], win2);
+		if (prj.intersectViewportDiscontinuity(p[i], p[i+1]))
+			continue;
+		vertices << Vec2f(win1[0], win1[1]) << Vec2f(win2[0], win2[1]);
+		colors << color << color;
+	}
+}
+
+void ConstellationLinesBatch::clipSegment(const StelProjector& prj, Vec3d p1, Vec3d p2, Vec3d& win)
+{
+	// Bisect the segment, a few steps are enough for a segment of about one degree
+	prj.project(p1, win);
+	for (int i=0; i<12; ++i)
+	{
+		Vec3d middle = p1 + p2;
+		middle.normalize();
+		Vec3d middleWin;
+		if (prj.project(middle, middleWin))
+		{
+			p1 = middle;
+			win = middleWin;
+		}
+		else
+			p2 = middle;
+	}
+}
+
+void ConstellationLinesBatch::flush(StelPainter& sPainter)
+{
+	if (!vertices.isEmpty())
+	{
+		sPainter.enableClientStates(true, false, true);
+		sPainter.setVertexPointer(2, GL_FLOAT, vertices.constData());
+		sPainter.setColorPointer(4, GL_FLOAT, colors.constData());
+		sPainter.drawFromArray(StelPainter::Lines, vertices.size(), 0, false);
+		sPainter.enableClientStates(false);
+	}
+	vertices.resize(0);
+	colors.resize(0);
+}
+
 // constructor which loads all data from appropriate files
 ConstellationMgr::ConstellationMgr(StarMgr *_hip_stars)
 	: hipStarMgr(_hip_stars),
@@ -62,7 +185,10 @@ ConstellationMgr::ConstellationMgr(StarMgr *_hip_stars)
 	  boundariesDisplayed(0),
 	  linesDisplayed(0),
 	  namesDisplayed(0),
-	  constellationLineThickness(1.)
+	  constellationLineThickness(1.),
+	  flagAsyncLoading(true),
+	  flagSkyCultureLoading(false),
+	  pendingSkyCulture(Q_NULLPTR)
 {
 	setObjectName("ConstellationMgr");
 	Q_ASSERT(hipStarMgr);
@@ -70,6 +196,8 @@ ConstellationMgr::ConstellationMgr(StarMgr *_hip_stars)
 
 ConstellationMgr::~ConstellationMgr()
 {
+	cancelSkyCultureLoader();
+
 	std::vector<Constellation *>::iterator iter;
 
 	for (iter = constellations.begin(); iter != constellations.end(); iter++)
@@ -91,6 +219,7 @@ void ConstellationMgr::init()
 	Q_ASSERT(conf);
 
 	lastLoadedSkyCulture = "dummy";
+	flagAsyncLoading = conf->value("viewing/flag_async_skyculture_loading", true).toBool();
 	asterFont.setPixelSize(conf->value("viewing/constellation_font_size", 14).toInt());
 	setFlagLines(conf->value("viewing/flag_constellation_drawing").toBool());
 	setFlagLabels(conf->value("viewing/flag_constellation_name").toBool());
@@ -161,41 +290,50 @@ double ConstellationMgr::getCallOrder(StelModuleActionName actionName) const
 
 void ConstellationMgr::updateSkyCulture(const QString& skyCultureDir)
 {
+	requestedSkyCulture = skyCultureDir;
+
+	// The first sky culture is read synchronously, so that the constellations are available at startup
+	bool async = flagAsyncLoading && !constellations.empty();
+#ifndef DISABLE_SCRIPTING
+	// Scripts use the constellations right after core.setSkyCulture(), so they are read synchronously for them
+	async = async && !StelApp::getInstance().getScriptMgr().scriptIsRunning();
+#endif
+	if (async)
+	{
+		// If another sky culture is being read, update() starts reading this one afterwards
+		if (!flagSkyCultureLoading)
+			startSkyCultureLoader(skyCultureDir);
+		return;
+	}
+
+	cancelSkyCultureLoader();
 	// Check if the sky culture changed since last load, if not don't load anything
 	if (lastLoadedSkyCulture == skyCultureDir)
 		return;
 
+	SkyCultureData* data = readSkyCulture(createSkyCultureData(skyCultureDir));
+	createArtTextures(*data, artDisplayed);
+	activateSkyCulture(data);
+}
+
+ConstellationMgr::SkyCultureData* ConstellationMgr::createSkyCultureData(const QString& skyCultureDir) const
+{
+	SkyCultureData* data = new SkyCultureData;
+	data->cultureName = skyCultureDir;
+	data->jde = StelApp::getInstance().getCore()->getJDE();
+
 	// Find constellation art.  If this doesn't exist, warn, but continue using ""
 	// the loadLinesAndArt function knows how to handle this (just loads lines).
-	QString conArtFile = StelFileMgr::findFile("skycultures/"+skyCultureDir+"/constellationsart.fab");
-	if (conArtFile.isEmpty())
+	data->artFile = StelFileMgr::findFile("skycultures/"+skyCultureDir+"/constellationsart.fab");
+	if (data->artFile.isEmpty())
 	{
 		qDebug() << "No constellationsart.fab file found for sky culture dir" << QDir::toNativeSeparators(skyCultureDir);
 	}
 
-	// first of all, remove constellations from the list of selected objects in StelObjectMgr, since we are going to delete them
-	deselectConstellations();
-
-	QString fic = StelFileMgr::findFile("skycultures/"+skyCultureDir+"/constellationship.fab");
-	if (fic.isEmpty())
-		qWarning() << "ERROR loading constellation lines and art from file: " << fic;
-	else
-		loadLinesAndArt(fic, conArtFile, skyCultureDir);
+	data->linesFile = StelFileMgr::findFile("skycultures/"+skyCultureDir+"/constellationship.fab");
+	data->namesFile = StelFileMgr::findFile("skycultures/" + skyCultureDir + "/constellation_names.eng.fab");
+	data->seasonalRulesFile = StelFileMgr::findFile("skycultures/" + skyCultureDir + "/seasonal_rules.fab");
 
-	// load constellation names
-	fic = StelFileMgr::findFile("skycultures/" + skyCultureDir + "/constellation_names.eng.fab");
-	if (fic.isEmpty())
-		qWarning() << "ERROR loading constellation names from file: " << fic;
-	else
-		loadNames(fic);
-
-	// load seasonal rules
-	loadSeasonalRules(StelFileMgr::findFile("skycultures/" + skyCultureDir + "/seasonal_rules.fab"));
-
-	// Translate constellation names for the new sky culture
-	updateI18n();
-
-	// load constellation boundaries
 	StelApp *app = &StelApp::getInstance();
 	int idx = app->getSkyCultureMgr().getCurrentSkyCultureBoundariesIdx();
 	if (idx>=0)
@@ -204,22 +342,163 @@ void ConstellationMgr::updateSkyCulture(const QString& skyCultureDir)
 		if (idx==1)
 		{
 			// boundaries = own
-			fic = StelFileMgr::findFile("skycultures/" + skyCultureDir + "/constellations_boundaries.dat");
+			data->boundariesFile = StelFileMgr::findFile("skycultures/" + skyCultureDir + "/constellations_boundaries.dat");
 		}
 		else
 		{
 			// boundaries = generic
-			fic = StelFileMgr::findFile("data/constellations_boundaries.dat");
+			data->boundariesFile = StelFileMgr::findFile("data/constellations_boundaries.dat");
 		}
 
-		if (fic.isEmpty())
-			qWarning() << "ERROR loading constellation boundaries file: " << fic;
+		if (data->boundariesFile.isEmpty())
+			qWarning() << "ERROR loading constellation boundaries file: " << data->boundariesFile;
+	}
+	return data;
+}
+
+ConstellationMgr::SkyCultureData* ConstellationMgr::readSkyCulture(SkyCultureData* data) const
+{
+	if (data->linesFile.isEmpty())
+		qWarning() << "ERROR loading constellation lines and art from file: " << data->linesFile;
+	else
+		loadLinesAndArt(*data, data->linesFile, data->artFile, data->cultureName);
+
+	// load constellation names
+	if (data->namesFile.isEmpty())
+		qWarning() << "ERROR loading constellation names from file: " << data->namesFile;
+	else
+		loadNames(*data, data->namesFile);
+
+	// load seasonal rules
+	loadSeasonalRules(*data, data->seasonalRulesFile);
+
+	// load constellation boundaries
+	if (!data->boundariesFile.isEmpty())
+		loadBoundaries(*data, data->boundariesFile);
+
+	// Sample the arcs once, they are only projected when drawn
+	for (vector<Constellation*>::const_iterator iter = data->constellations.begin(); iter != data->constellations.end(); ++iter)
+	{
+		(*iter)->buildLineArcs(data->jde);
+		(*iter)->buildBoundaryArcs();
+	}
+	return data;
+}
+
+void ConstellationMgr::createArtTextures(SkyCultureData& data, bool preload) const
+{
+	StelTextureMgr& texMgr = StelApp::getInstance().getTextureManager();
+	for (int i=0; i<data.artTextureFiles.size(); ++i)
+	{
+		data.artTextureFiles.at(i).first->artTexture =
+			texMgr.createTextureThread(data.artTextureFiles.at(i).second, StelTexture::StelTextureParams(), !preload);
+	}
+}
+
+void ConstellationMgr::activateSkyCulture(SkyCultureData* data)
+{
+	// first of all, remove constellations from the list of selected objects in StelObjectMgr, since we are going to delete them
+	deselectConstellations();
+
+	constellations.swap(data->constellations);
+	allBoundarySegments.swap(data->boundarySegments);
+	Constellation::seasonalRuleEnabled = data->seasonalRulesEnabled;
+	lastLoadedSkyCulture = data->cultureName;
+	// The previous constellations are deleted with the data
+	delete data;
+
+	vector < Constellation * >::const_iterator iter;
+	for (iter = constellations.begin(); iter != constellations.end(); ++iter)
+	{
+		(*iter)->artFader.setMaxValue(artIntensity);
+		(*iter)->artFader.setDuration((int) (artFadeDuration * 1000.f));
+		(*iter)->setFlagArt(artDisplayed);
+		(*iter)->setFlagBoundaries(boundariesDisplayed);
+		(*iter)->setFlagLines(linesDisplayed);
+		(*iter)->setFlagLabels(namesDisplayed);
+	}
+
+	// Set current states
+	setFlagArt(artDisplayed);
+	setFlagLines(linesDisplayed);
+	setFlagLabels(namesDisplayed);
+	setFlagBoundaries(boundariesDisplayed);
+
+	// Translate constellation names for the new sky culture
+	updateI18n();
+
+	emit skyCultureActivated(lastLoadedSkyCulture);
+}
+
+void ConstellationMgr::startSkyCultureLoader(const QString& skyCultureDir)
+{
+	Q_ASSERT(!flagSkyCultureLoading);
+	if (skyCultureDir==lastLoadedSkyCulture || (pendingSkyCulture && pendingSkyCulture->cultureName==skyCultureDir))
+		return;
+	// The files are found in the main thread, they are read and the arcs are sampled in the worker
+	skyCultureLoader = QtConcurrent::run(this, &ConstellationMgr::readSkyCulture, createSkyCultureData(skyCultureDir));
+	flagSkyCultureLoading = true;
+}
+
+void ConstellationMgr::updateSkyCultureLoader()
+{
+	if (flagSkyCultureLoading && skyCultureLoader.isFinished())
+	{
+		flagSkyCultureLoading = false;
+		SkyCultureData* data = skyCultureLoader.result();
+		if (data->cultureName==requestedSkyCulture)
+		{
+			// Start decoding the art now, so that it is shown as soon as the new constellations are
+			createArtTextures(*data, artDisplayed);
+			delete pendingSkyCulture;
+			pendingSkyCulture = data;
+		}
 		else
-			loadBoundaries(fic);
+			delete data;
+	}
 
+	if (pendingSkyCulture && pendingSkyCulture->cultureName!=requestedSkyCulture)
+	{
+		delete pendingSkyCulture;
+		pendingSkyCulture = Q_NULLPTR;
 	}
+	if (!flagSkyCultureLoading && !requestedSkyCulture.isEmpty())
+		startSkyCultureLoader(requestedSkyCulture);
 
-	lastLoadedSkyCulture = skyCultureDir;
+	if (!pendingSkyCulture)
+		return;
+
+	// Upload a few art textures per frame as they are decoded, and switch when all are ready
+	static const int maxUploadsPerFrame = 4;
+	int uploads = 0;
+	bool ready = true;
+	for (int i=0; i<pendingSkyCulture->artTextureFiles.size(); ++i)
+	{
+		const StelTextureSP& tex = pendingSkyCulture->artTextureFiles.at(i).first->artTexture;
+		if (!tex || tex->canBind() || tex->hasError() || !artDisplayed)
+			continue;
+		// bind() does the upload as soon as the loader thread has finished decoding
+		if (uploads<maxUploadsPerFrame && tex->bind())
+			++uploads;
+		else
+			ready = false;
+	}
+	if (ready)
+	{
+		activateSkyCulture(pendingSkyCulture);
+		pendingSkyCulture = Q_NULLPTR;
+	}
+}
+
+void ConstellationMgr::cancelSkyCultureLoader()
+{
+	if (flagSkyCultureLoading)
+	{
+		delete skyCultureLoader.result(); // blocks until the worker has finished
+		flagSkyCultureLoading = false;
+	}
+	delete pendingSkyCulture;
+	pendingSkyCulture = Q_NULLPTR;
 }
 
 void ConstellationMgr::selectedObjectChange(StelModule::StelModuleSelectAction action)
@@ -382,7 +661,7 @@ void ConstellationMgr::setConstellationLineThickness(const float thickness)
 	}
 }
 
-void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &artfileName, const QString& cultureName)
+void ConstellationMgr::loadLinesAndArt(SkyCultureData& data, const QString &fileName, const QString &artfileName, const QString& cultureName) const
 {
 	QFile in(fileName);
 	if (!in.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -402,12 +681,6 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 	}
 	in.seek(0);
 
-	// delete existing data, if any
-	vector < Constellation * >::iterator iter;
-	for (iter = constellations.begin(); iter != constellations.end(); ++iter)
-		delete(*iter);
-
-	constellations.clear();
 	Constellation *cons = Q_NULLPTR;
 
 	// read the file of line patterns, adding a record per non-comment line
@@ -421,15 +694,9 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 			continue;
 
 		cons = new Constellation;
-		if(cons->read(record, hipStarMgr))
+		if(cons->read(record, hipStarMgr, data.jde))
 		{
-			cons->artFader.setMaxValue(artIntensity);
-			cons->artFader.setDuration((int) (artFadeDuration * 1000.f));
-			cons->setFlagArt(artDisplayed);
-			cons->setFlagBoundaries(boundariesDisplayed);
-			cons->setFlagLines(linesDisplayed);
-			cons->setFlagLabels(namesDisplayed);
-			constellations.push_back(cons);
+			data.constellations.push_back(cons);
 			++readOk;
 		}
 		else
@@ -441,12 +708,6 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 	in.close();
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "constellation records successfully for culture" << cultureName;
 
-	// Set current states
-	setFlagArt(artDisplayed);
-	setFlagLines(linesDisplayed);
-	setFlagLabels(namesDisplayed);
-	setFlagBoundaries(boundariesDisplayed);
-
 	// It's possible to have no art - just constellations
 	if (artfileName.isNull() || artfileName.isEmpty())
 		return;
@@ -503,7 +764,7 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 // 		lb.Draw((float)(currentLineNumber)/totalRecords);
 
 		cons = Q_NULLPTR;
-		cons = findFromAbbreviation(shortname);
+		cons = findFromAbbreviation(data.constellations, shortname);
 		if (!cons)
 		{
 			qWarning() << "ERROR in constellation art file at line" << currentLineNumber << "for culture" << cultureName
@@ -517,18 +778,25 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 				qWarning() << "ERROR: could not find texture, " << QDir::toNativeSeparators(texfile);
 			}
 
-			cons->artTexture = StelApp::getInstance().getTextureManager().createTextureThread(texturePath);
+			else
+				data.artTextureFiles << qMakePair(cons, texturePath);
 
+			// The texture is created later in the main thread, only read the size of the image here
 			int texSizeX = 0, texSizeY = 0;
-			if (cons->artTexture==Q_NULLPTR || !cons->artTexture->getDimensions(texSizeX, texSizeY))
+			const QSize texSize = QImageReader(texturePath).size();
+			if (texturePath.isEmpty() || !texSize.isValid())
 			{
 				qWarning() << "Texture dimension not available";
 			}
+			else
+			{
+				texSizeX = texSize.width();
+				texSizeY = texSize.height();
+			}
 
-			StelCore* core = StelApp::getInstance().getCore();
-			Vec3d s1 = hipStarMgr->searchHP(hp1)->getJ2000EquatorialPos(core);
-			Vec3d s2 = hipStarMgr->searchHP(hp2)->getJ2000EquatorialPos(core);
-			Vec3d s3 = hipStarMgr->searchHP(hp3)->getJ2000EquatorialPos(core);
+			Vec3d s1 = StarMgr::getJ2000EquatorialPosAt(hipStarMgr->searchHP(hp1), data.jde);
+			Vec3d s2 = StarMgr::getJ2000EquatorialPosAt(hipStarMgr->searchHP(hp2), data.jde);
+			Vec3d s3 = StarMgr::getJ2000EquatorialPosAt(hipStarMgr->searchHP(hp3), data.jde);
 
 			// To transform from texture coordinate to 2d coordinate we need to find X with XA = B
 			// A formed of 4 points in texture coordinate, B formed with 4 points in 3d coordinate
@@ -584,7 +852,7 @@ void ConstellationMgr::draw(StelCore* core)
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter sPainter(prj);
 	sPainter.setFont(asterFont);
-	drawLines(sPainter, core);
+	drawLines(sPainter);
 	drawNames(sPainter);
 	drawArt(sPainter);
 	drawBoundaries(sPainter);
@@ -607,19 +875,27 @@ void ConstellationMgr::drawArt(StelPainter& sPainter) const
 }
 
 // Draw constellations lines
-void ConstellationMgr::drawLines(StelPainter& sPainter, const StelCore* core) const
+void ConstellationMgr::drawLines(StelPainter& sPainter) const
 {
-	sPainter.setBlending(true);
-	if (constellationLineThickness>1.f)
-		sPainter.setLineWidth(constellationLineThickness); // set line thickness
-	sPainter.setLineSmooth(true);
-
-	const SphericalCap& viewportHalfspace = sPainter.getProjector()->getBoundingCap();
+	const StelProjector& prj = *sPainter.getProjector();
+	const SphericalCap& viewportHalfspace = prj.getBoundingCap();
+	constellationLinesBatch.setViewport(prj, Constellation::Arcs::SAMPLE_STEP);
 	vector < Constellation * >::const_iterator iter;
 	for (iter = constellations.begin(); iter != constellations.end(); ++iter)
 	{
-		(*iter)->drawOptim(sPainter, core, viewportHalfspace);
+		const Constellation* cons = *iter;
+		const float intensity = cons->lineFader.getInterstate();
+		if (intensity<=0.0001f || !viewportHalfspace.intersects(cons->lineArcs.boundingCap) || !cons->checkVisibility())
+			continue;
+		const Vec3f& c = Constellation::lineColor;
+		constellationLinesBatch.add(prj, cons->lineArcs.points, Vec4f(c[0], c[1], c[2], intensity));
 	}
+
+	sPainter.setBlending(true);
+	if (constellationLineThickness>1.f)
+		sPainter.setLineWidth(constellationLineThickness); // set line thickness
+	sPainter.setLineSmooth(true);
+	constellationLinesBatch.flush(sPainter);
 	if (constellationLineThickness>1.f)
 		sPainter.setLineWidth(1.f); // restore line thickness
 	sPainter.setLineSmooth(false);
@@ -653,6 +929,11 @@ Constellation *ConstellationMgr::isStarIn(const StelObject* s) const
 }
 
 Constellation* ConstellationMgr::findFromAbbreviation(const QString& abbreviation) const
+{
+	return findFromAbbreviation(constellations, abbreviation);
+}
+
+Constellation* ConstellationMgr::findFromAbbreviation(const vector<Constellation*>& constellations, const QString& abbreviation)
 {
 	// search in uppercase only
 	//QString tname = abbreviation.toUpper();
@@ -678,14 +959,14 @@ QList<StelObjectP> ConstellationMgr::searchAround(const Vec3d&, double, const St
 	return QList<StelObjectP>();
 }
 
-void ConstellationMgr::loadNames(const QString& namesFile)
+void ConstellationMgr::loadNames(SkyCultureData& data, const QString& namesFile) const
 {
 	// Constellation not loaded yet
-	if (constellations.empty()) return;
+	if (data.constellations.empty()) return;
 
 	// clear previous names
 	vector < Constellation * >::const_iterator iter;
-	for (iter = constellations.begin(); iter != constellations.end(); ++iter)
+	for (iter = data.constellations.begin(); iter != data.constellations.end(); ++iter)
 	{
 		(*iter)->englishName.clear();
 	}
@@ -734,7 +1015,7 @@ void ConstellationMgr::loadNames(const QString& namesFile)
 		else
 		{
 			shortName = recRx.capturedTexts().at(1);
-			aster = findFromAbbreviation(shortName);
+			aster = findFromAbbreviation(data.constellations, shortName);
 			// If the constellation exists, set the English name
 			if (aster != Q_NULLPTR)
 			{
@@ -765,10 +1046,10 @@ void ConstellationMgr::loadNames(const QString& namesFile)
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "constellation names";
 }
 
-void ConstellationMgr::loadSeasonalRules(const QString& rulesFile)
+void ConstellationMgr::loadSeasonalRules(SkyCultureData& data, const QString& rulesFile) const
 {
 	// Constellation not loaded yet
-	if (constellations.empty()) return;
+	if (data.constellations.empty()) return;
 
 	bool flag = true;
 	if (rulesFile.isEmpty())
@@ -776,12 +1057,13 @@ void ConstellationMgr::loadSeasonalRules(const QString& rulesFile)
 
 	// clear previous names
 	vector < Constellation * >::const_iterator iter;
-	for (iter = constellations.begin(); iter != constellations.end(); ++iter)
+	for (iter = data.constellations.begin(); iter != data.constellations.end(); ++iter)
 	{
 		(*iter)->beginSeason = 1;
 		(*iter)->endSeason = 12;
-		(*iter)->seasonalRuleEnabled = flag;
 	}
+	// Constellation::seasonalRuleEnabled is set when the sky culture is activated
+	data.seasonalRulesEnabled = flag;
 
 	// Current starlore didn't support the seasonal rules
 	if (!flag)
@@ -829,7 +1111,7 @@ void ConstellationMgr::loadSeasonalRules(const QString& rulesFile)
 		else
 		{
 			shortName = recRx.capturedTexts().at(1);
-			aster = findFromAbbreviation(shortName);
+			aster = findFromAbbreviation(data.constellations, shortName);
 			// If the constellation exists, set the English name
 			if (aster != Q_NULLPTR)
 			{
@@ -860,15 +1142,22 @@ void ConstellationMgr::updateI18n()
 // update faders
 void ConstellationMgr::update(double deltaTime)
 {
+	updateSkyCultureLoader();
+
+	const StelCore* core = StelApp::getInstance().getCore();
 	//calculate FOV fade value, linear fade between artIntensityMaximumFov and artIntensityMinimumFov
-	double fov = StelApp::getInstance().getCore()->getMovementMgr()->getCurrentFov();
+	double fov = core->getMovementMgr()->getCurrentFov();
 	Constellation::artIntensityFovScale = qBound(0.0,(fov - artIntensityMinimumFov) / (artIntensityMaximumFov - artIntensityMinimumFov),1.0);
 
 	vector < Constellation * >::const_iterator iter;
 	const int delta = (int)(deltaTime*1000);
+	const double jde = core->getJDE();
 	for (iter = constellations.begin(); iter != constellations.end(); ++iter)
 	{
 		(*iter)->update(delta);
+		// The stars move by a few arcseconds per year at most, sample the lines again after a year
+		if (std::fabs(jde-(*iter)->lineArcsJDE)>365.25)
+			(*iter)->buildLineArcs(jde);
 	}
 }
 
@@ -1240,19 +1529,11 @@ void ConstellationMgr::unsetSelectedConst(Constellation * c)
 	}
 }
 
-bool ConstellationMgr::loadBoundaries(const QString& boundaryFile)
+bool ConstellationMgr::loadBoundaries(SkyCultureData& data, const QString& boundaryFile) const
 {
 	Constellation *cons = Q_NULLPTR;
 	unsigned int i, j;
 
-	// delete existing boundaries if any exist
-	vector<vector<Vec3f> *>::iterator iter;
-	for (iter = allBoundarySegments.begin(); iter != allBoundarySegments.end(); ++iter)
-	{
-		delete (*iter);
-	}
-	allBoundarySegments.clear();
-
 	qDebug() << "Loading constellation boundary data ... ";
 
 	// Modified boundary file by Torsten Bronger with permission
@@ -1292,7 +1573,7 @@ bool ConstellationMgr::loadBoundaries(const QString& boundaryFile)
 		}
 
 		// this list is for the de-allocation
-		allBoundarySegments.push_back(points);
+		data.boundarySegments.push_back(points);
 
 		istr >> numc;
 		// there are 2 constellations per boundary
@@ -1303,7 +1584,7 @@ bool ConstellationMgr::loadBoundaries(const QString& boundaryFile)
 			// not used?
 			if (consname == "SER1" || consname == "SER2") consname = "SER";
 
-			cons = findFromAbbreviation(consname);
+			cons = findFromAbbreviation(data.constellations, consname);
 			if (!cons)
 				qWarning() << "ERROR while processing boundary file - cannot find constellation: " << consname;
 			else
@@ -1330,12 +1611,23 @@ bool ConstellationMgr::loadBoundaries(const QString& boundaryFile)
 
 void ConstellationMgr::drawBoundaries(StelPainter& sPainter) const
 {
-	sPainter.setBlending(false);
+	const StelProjector& prj = *sPainter.getProjector();
+	const SphericalCap& viewportHalfspace = prj.getBoundingCap();
+	constellationLinesBatch.setViewport(prj, Constellation::Arcs::SAMPLE_STEP);
 	vector < Constellation * >::const_iterator iter;
 	for (iter = constellations.begin(); iter != constellations.end(); ++iter)
 	{
-		(*iter)->drawBoundaryOptim(sPainter);
-	}	
+		const Constellation* cons = *iter;
+		const float intensity = cons->boundaryFader.getInterstate();
+		const Constellation::Arcs& arcs = Constellation::singleSelected ? cons->isolatedBoundaryArcs : cons->sharedBoundaryArcs;
+		if (!intensity || !viewportHalfspace.intersects(arcs.boundingCap))
+			continue;
+		const Vec3f& c = Constellation::boundaryColor;
+		constellationLinesBatch.add(prj, arcs.points, Vec4f(c[0], c[1], c[2], intensity));
+	}
+
+	sPainter.setBlending(true);
+	constellationLinesBatch.flush(sPainter);
 }
 
 StelObjectP ConstellationMgr::searchByNameI18n(const QString& nameI18n) const
@@ -29,6 +29,7 @@
 #include <QString>
 #include <QStringList>
 #include <QFont>
+#include <QFuture>
 
 class StelToneReproducer;
 class StarMgr;
@@ -112,12 +113,19 @@ public:
 	//! as constellation objects are loaded for the required sky culture.
 	virtual void init();
 
+	//! The constellation lines are defined with the stars of the StarMgr.
+	virtual QStringList getInitDependencies() const {return QStringList("StarMgr");}
+
 	//! Draw constellation lines, art, names and boundaries.
 	virtual void draw(StelCore* core);
 
 	//! Updates time-varying state for each Constellation.
+	//! Also activates a sky culture loaded in the background once it is ready.
 	virtual void update(double deltaTime);
 
+	//! A sky culture is being loaded in the background, and replaces the constellations when ready.
+	virtual bool needsRedraw() const {return flagSkyCultureLoading || pendingSkyCulture;}
+
 	//! Return the value defining the order of call for the given action
 	//! @param actionName the name of the action for which we want the call order
 	//! @return the value defining the order. The closer to 0 the earlier the module's action will be called
@@ -284,6 +292,13 @@ signals:
 	void namesDisplayedChanged(const bool displayed) const;
 	void constellationsDisplayStyleChanged(const ConstellationMgr::ConstellationDisplayStyle style) const;
 	void constellationLineThicknessChanged(float thickness) const;
+	//! Emitted when the constellations of a sky culture replace the previous ones.
+	//! When the sky cultures are read in a worker thread (see [viewing/flag_async_skyculture_loading]),
+	//! this happens a few frames after StelSkyCultureMgr::currentSkyCultureChanged(), while the star names
+	//! and asterisms already use the new sky culture. Until then, the previous constellations are shown and selected.
+	//! While a script runs, the sky culture is read synchronously and this is emitted before setSkyCulture() returns.
+	//! @param skyCultureDir the directory name of the sky culture.
+	void skyCultureActivated(const QString& skyCultureDir);
 
 private slots:
 	//! Limit the number of constellations to draw based on selected stars.
@@ -306,18 +321,39 @@ private slots:
 	void deselectConstellations(void);
 
 private:
+	//! The constellations of a sky culture, read from its files before they replace the current ones.
+	struct SkyCultureData;
+
+	//! Find the files of a sky culture.
+	SkyCultureData* createSkyCultureData(const QString& skyCultureDir) const;
+	//! Read the files of a sky culture and sample the lines and boundaries.
+	//! This does not call OpenGL nor change the state of the manager, and can run in a worker thread.
+	//! @return data
+	SkyCultureData* readSkyCulture(SkyCultureData* data) const;
+	//! Create the art textures of a sky culture. If preload is true, they are decoded now by the texture loader
+	//! threads instead of when they are first drawn.
+	void createArtTextures(SkyCultureData& data, bool preload) const;
+	//! Replace the constellations by the ones of a sky culture, and delete data.
+	void activateSkyCulture(SkyCultureData* data);
+	//! Start reading a sky culture in a worker thread.
+	void startSkyCultureLoader(const QString& skyCultureDir);
+	//! Poll the worker thread, upload the preloaded art textures and activate the loaded sky culture when ready.
+	void updateSkyCultureLoader();
+	//! Wait for the worker thread and drop the sky culture being loaded.
+	void cancelSkyCultureLoader();
+
 	//! Read constellation names from the given file.
 	//! @param namesFile Name of the file containing the constellation names
 	//!        in a format consisting of abbreviation, native name and translatable english name.
 	//! @note The abbreviation must occur in the lines file loaded first in @name loadLinesAndArt()!
-	void loadNames(const QString& namesFile);
+	void loadNames(SkyCultureData& data, const QString& namesFile) const;
 
 	//! Load constellation line shapes, art textures and boundaries shapes from data files.
 	//! @param fileName The name of the constellation data file
 	//! @param artFileName The name of the constellation art data file
 	//! @param cultureName A string ID of the current skyculture
 	//! @note The abbreviation used in @param filename is required for cross-identifying translatable names in @name loadNames():
-	void loadLinesAndArt(const QString& fileName, const QString& artfileName, const QString& cultureName);
+	void loadLinesAndArt(SkyCultureData& data, const QString& fileName, const QString& artfileName, const QString& cultureName) const;
 
 	//! Load the constellation boundary file.
 	//! This function deletes any currently loaded constellation boundaries
@@ -332,14 +368,14 @@ private:
 	//!  - Two constellation abbreviations representing the constellations which
 	//!    the boundary separates.
 	//! @param conCatFile the path to the file which contains the constellation boundary data.
-	bool loadBoundaries(const QString& conCatFile);
+	bool loadBoundaries(SkyCultureData& data, const QString& conCatFile) const;
 
 	//! Read seasonal rules for displaying constellations from the given file.
 	//! @param rulesFile Name of the file containing the seasonal rules
-	void loadSeasonalRules(const QString& rulesFile);
+	void loadSeasonalRules(SkyCultureData& data, const QString& rulesFile) const;
 
-	//! Draw the constellation lines at the epoch given by the StelCore.
-	void drawLines(StelPainter& sPainter, const StelCore* core) const;
+	//! Draw the constellation lines, with the positions of the stars sampled by update().
+	void drawLines(StelPainter& sPainter) const;
 	//! Draw the constellation art.
 	void drawArt(StelPainter& sPainter) const;
 	//! Draw the constellation name labels.
@@ -368,6 +404,7 @@ private:
 	Constellation* isStarIn(const StelObject *s) const;
 	Constellation* isObjectIn(const StelObject *s) const;
 	Constellation* findFromAbbreviation(const QString& abbreviation) const;
+	static Constellation* findFromAbbreviation(const std::vector<Constellation*>& constellations, const QString& abbreviation);
 	std::vector<Constellation*> constellations;
 	QFont asterFont;
 	StarMgr* hipStarMgr;
@@ -378,6 +415,15 @@ private:
 
 	QString lastLoadedSkyCulture;	// Store the last loaded sky culture directory name
 
+	//! Read the sky cultures in a worker thread, except the first one. Configured as [viewing/flag_async_skyculture_loading].
+	bool flagAsyncLoading;
+	//! The sky culture to show, which may still be loading
+	QString requestedSkyCulture;
+	QFuture<SkyCultureData*> skyCultureLoader;
+	bool flagSkyCultureLoading;
+	//! A sky culture which has been read and waits for its art textures
+	SkyCultureData* pendingSkyCulture;
+
 	//! this controls how constellations (and also star names) are printed: Abbreviated/as-given/translated
 	ConstellationDisplayStyle constellationDisplayStyle;
 
@@ -38,6 +38,113 @@
 #include <QSettings>
 #include <QDebug>
 #include <QFontMetrics>
+#include <QVarLengthArray>
+
+//! @struct GridLinesBatch
+//! The projected line segments and the edge labels of all grids and lines, drawn at once at the end of GridLinesMgr::draw().
+struct GridLinesBatch
+{
+	struct Label
+	{
+		Vec3d pos;
+		QString text;
+		float angleDeg;
+		float xshift;
+		Vec4f color;
+		QFont font;
+	};
+
+	//! Draw the content of the batch and clear it.
+	void flush(StelCore* core);
+
+	//! End points of the segments in screen coordinates, by pairs
+	QVector<Vec2f> vertices;
+	QVector<Vec4f> colors;
+	QVector<Label> labels;
+};
+
+// Kept between frames to reuse the allocated memory, like the arrays of StelPainter
+static GridLinesBatch gridLinesBatch;
+
+struct ViewportEdgeIntersectCallbackData
+{
+	//! What is written where a line leaves the viewport
+	enum LabelType
+	{
+		FixedLabel,	//!< the text member
+		MeridianLabel,	//!< the longitude of the meridian raAngle
+		ParallelLabel	//!< the latitude of the parallel latAngle
+	};
+
+	ViewportEdgeIntersectCallbackData(const StelProjector* p)
+		: prj(p)
+		, labelType(FixedLabel)
+		, raAngle(0.0)
+		, latAngle(0.0)
+		, frameType(StelCore::FrameUninitialized) {;}
+	const StelProjector* prj;
+	Vec4f textColor;
+	QFont font;
+	LabelType labelType;
+	QString text;		// Label to display at the intersection of the lines and screen side
+	double raAngle;		// Used for meridians
+	double latAngle;	// Used for parallels
+	StelCore::FrameType frameType;
+};
+
+//! @class GridArcCache
+//! The arcs of a grid or line, sampled in the frame of the grid and kept between frames.
+//! The arcs are clipped to a cap larger than the viewport and sampled finely enough for the current scale.
+//! They can be reused as long as the viewport stays inside that cap and the scale doesn't change much,
+//! e.g. while only the time changes in a rotating frame. Only the projection is done at each frame.
+class GridArcCache
+{
+public:
+	GridArcCache() : sampleStep(0.) {;}
+
+	//! Return the distance in radian between the points of the arcs which fits the scale of the projector.
+	static double getSampleStep(const StelProjector& prj);
+
+	//! Return true if the arcs cover the viewport and their sample step is close to the given one.
+	bool isValid(const SphericalCap& viewport, double step) const;
+	//! Remove all arcs and prepare to add the arcs for the given viewport and sample step.
+	void reset(const SphericalCap& viewport, double step);
+	//! Return the cap in which arcs are added.
+	const SphericalCap& getCoverage() const {return coverage;}
+
+	//! Add the arc from start to stop around rotCenter, the null vector for great circles.
+	//! The arc must be shorter than 180 deg.
+	void addArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter,
+		    ViewportEdgeIntersectCallbackData::LabelType labelType=ViewportEdgeIntersectCallbackData::FixedLabel, double labelAngle=0.);
+	//! Add the part of the circle inside the coverage cap in 2 or 3 arcs.
+	//! @param fpt a point of the circle.
+	//! @return false if the circle doesn't intersect the coverage cap.
+	bool addCircle(const SphericalCap& circle, const Vec3d& fpt,
+		       ViewportEdgeIntersectCallbackData::LabelType labelType=ViewportEdgeIntersectCallbackData::FixedLabel, double labelAngle=0.);
+
+	//! Project the arcs intersecting the viewport and add the segments and edge labels to gridLinesBatch.
+	void draw(const StelProjector& prj, const Vec4f& color, ViewportEdgeIntersectCallbackData& labelData) const;
+
+private:
+	//! A piece of an arc with its bounding cap, the unit of culling
+	struct Chunk
+	{
+		SphericalCap cap;
+		int first;
+		int count;
+		ViewportEdgeIntersectCallbackData::LabelType labelType;
+		double labelAngle;
+	};
+	//! Maximum number of segments in a chunk
+	static const int CHUNK_SIZE = 32;
+
+	void subdivide(const Vec3d& p1, const Vec3d& p2, const Vec3d& center, double radius, int level);
+
+	QVector<Vec3d> points;
+	QVector<Chunk> chunks;
+	SphericalCap coverage;
+	double sampleStep;
+};
 
 //! @class SkyGrid
 //! Class which manages a grid to display in the sky.
@@ -56,10 +163,15 @@ public:
 	void setDisplayed(const bool displayed){fader = displayed;}
 	bool isDisplayed(void) const {return fader;}
 private:
+	//! Add the meridians and parallels around firstPoint to the arcs
+	void buildArcs(const Vec3d& firstPoint, double gridStepMeridianRad, double gridStepParallelRad) const;
+
 	Vec3f color;
 	StelCore::FrameType frameType;
 	QFont font;
 	LinearFader fader;
+	mutable GridArcCache arcs;
+	mutable double arcsStepMeridianRad, arcsStepParallelRad;
 };
 
 //! @class SkyPoint
@@ -150,10 +262,13 @@ private:
 	LinearFader fader;
 	QFont font;
 	QString label;
+	mutable GridArcCache arcs;
+	//! The circle of the cached arcs
+	mutable SphericalCap arcsCircle;
 };
 
 // rms added color as parameter
-SkyGrid::SkyGrid(StelCore::FrameType frame) : color(0.2,0.2,0.2), frameType(frame)
+SkyGrid::SkyGrid(StelCore::FrameType frame) : color(0.2,0.2,0.2), frameType(frame), arcsStepMeridianRad(0.), arcsStepParallelRad(0.)
 {
 	// Font size is 12
 	font.setPixelSize(StelApp::getInstance().getBaseFontSize()-1);
@@ -202,36 +317,20 @@ static double getClosestResolutionHMS(double pixelPerRad)
 	return 15.;
 }
 
-struct ViewportEdgeIntersectCallbackData
-{
-	ViewportEdgeIntersectCallbackData(StelPainter* p)
-		: sPainter(p)
-		, raAngle(0.0)
-		, frameType(StelCore::FrameUninitialized) {;}
-	StelPainter* sPainter;
-	Vec4f textColor;
-	QString text;		// Label to display at the intersection of the lines and screen side
-	double raAngle;		// Used for meridians
-	StelCore::FrameType frameType;
-};
-
-// Callback which draws the label of the grid
-void viewportEdgeIntersectCallback(const Vec3d& screenPos, const Vec3d& direction, void* userData)
+// Callback which adds the label of the grid to the batch
+static void viewportEdgeIntersectCallback(const Vec3d& screenPos, const Vec3d& direction, const ViewportEdgeIntersectCallbackData* d)
 {
-	ViewportEdgeIntersectCallbackData* d = static_cast<ViewportEdgeIntersectCallbackData*>(userData);
 	Vec3d direc(direction);
 	direc.normalize();
-	const Vec4f tmpColor = d->sPainter->getColor();
-	d->sPainter->setColor(d->textColor[0], d->textColor[1], d->textColor[2], d->textColor[3]);
 	bool withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();
 	bool useOldAzimuth = StelApp::getInstance().getFlagSouthAzimuthUsage();
 
 	QString text;
-	if (d->text.isEmpty())
+	if (d->labelType==ViewportEdgeIntersectCallbackData::MeridianLabel)
 	{
 		// We are in the case of meridians, we need to determine which of the 2 labels (3h or 15h to use)
 		Vec3d tmpV;
-		d->sPainter->getProjector()->unProject(screenPos, tmpV);
+		d->prj->unProject(screenPos, tmpV);
 		double lon, lat, textAngle;
 		StelUtils::rectToSphe(&lon, &lat, tmpV);
 		switch (d->frameType)
@@ -344,6 +443,13 @@ void viewportEdgeIntersectCallback(const Vec3d& screenPos, const Vec3d& directio
 			}
 		}
 	}
+	else if (d->labelType==ViewportEdgeIntersectCallbackData::ParallelLabel)
+	{
+		if (withDecimalDegree)
+			text = StelUtils::radToDecDegStr(d->latAngle);
+		else
+			text = StelUtils::radToDmsStrAdapt(d->latAngle);
+	}
 	else
 		text = d->text;
 
@@ -352,12 +458,210 @@ void viewportEdgeIntersectCallback(const Vec3d& screenPos, const Vec3d& directio
 	if (angleDeg>90. || angleDeg<-90.)
 	{
 		angleDeg+=180.;
-		xshift=-d->sPainter->getFontMetrics().width(text)-6.f;
+		xshift=-QFontMetrics(d->font).width(text)-6.f;
 	}
 
-	d->sPainter->drawText(screenPos[0], screenPos[1], text, angleDeg, xshift, 3);
-	d->sPainter->setColor(tmpColor[0], tmpColor[1], tmpColor[2], tmpColor[3]);
-	d->sPainter->setBlending(true);
+	GridLinesBatch::Label label;
+	label.pos = screenPos;
+	label.text = text;
+	label.angleDeg = angleDeg;
+	label.xshift = xshift;
+	label.color = d->textColor;
+	label.font = d->font;
+	gridLinesBatch.labels.append(label);
+}
+
+void GridLinesBatch::flush(StelCore* core)
+{
+	if (!vertices.isEmpty() || !labels.isEmpty())
+	{
+		// The vertices are already projected, any projector of the current viewport will do.
+		StelPainter sPainter(core->getProjection(StelCore::FrameJ2000));
+		sPainter.setBlending(true);
+		if (!vertices.isEmpty())
+		{
+			sPainter.setLineSmooth(true);
+			sPainter.enableClientStates(true, false, true);
+			sPainter.setVertexPointer(2, GL_FLOAT, vertices.constData());
+			sPainter.setColorPointer(4, GL_FLOAT, colors.constData());
+			sPainter.drawFromArray(StelPainter::Lines, vertices.size(), 0, false);
+			sPainter.enableClientStates(false);
+			sPainter.setLineSmooth(false);
+		}
+		foreach (const Label& l, labels)
+		{
+			sPainter.setFont(l.font);
+			sPainter.setColor(l.color[0], l.color[1], l.color[2], l.color[3]);
+			sPainter.drawText(l.pos[0], l.pos[1], l.text, l.angleDeg, l.xshift, 3);
+			sPainter.setBlending(true);
+		}
+	}
+	vertices.resize(0);
+	colors.resize(0);
+	labels.resize(0);
+}
+
+double GridArcCache::getSampleStep(const StelProjector& prj)
+{
+	// About 16 pixels per segment at the center of the viewport, at most 1 deg
+	return qMin(16./prj.getPixelPerRadAtCenter(), M_PI/180.);
+}
+
+bool GridArcCache::isValid(const SphericalCap& viewport, double step) const
+{
+	if (step<0.7*sampleStep || step>1.5*sampleStep)
+		return false;
+	if (coverage.d<=-1.)
+		return true;
+	const double dist = std::acos(qBound(-1., coverage.n*viewport.n, 1.));
+	return dist+viewport.getRadius()<=coverage.getRadius();
+}
+
+void GridArcCache::reset(const SphericalCap& viewport, double step)
+{
+	points.resize(0);
+	chunks.resize(0);
+	sampleStep = step;
+	// Leave a margin around the viewport so that the arcs stay valid while it moves a bit
+	const double radius = 1.5*viewport.getRadius();
+	coverage.n = viewport.n;
+	coverage.d = radius<M_PI ? std::cos(radius) : -1.;
+}
+
+void GridArcCache::subdivide(const Vec3d& p1, const Vec3d& p2, const Vec3d& center, double radius, int level)
+{
+	if (level==0)
+		return;
+	Vec3d middle(p1);
+	middle+=p2;
+	middle.normalize();
+	middle*=radius;
+	subdivide(p1, middle, center, radius, level-1);
+	points.append(middle+center);
+	subdivide(middle, p2, center, radius, level-1);
+}
+
+void GridArcCache::addArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter,
+			  ViewportEdgeIntersectCallbackData::LabelType labelType, double labelAngle)
+{
+	const Vec3d u = start-rotCenter;
+	const Vec3d w = stop-rotCenter;
+	const double radius = u.length();
+	const double arcLength = 2.*radius*std::asin(qMin(1., (w-u).length()/(2.*radius)));
+	// Halve the arc until its pieces are shorter than the sample step, with the same limit as StelPainter
+	int level = 0;
+	while (level<10 && arcLength>(1<<level)*sampleStep)
+		++level;
+
+	const int first = points.size();
+	points.append(start);
+	subdivide(u, w, rotCenter, radius, level);
+	points.append(stop);
+
+	// Split the arc in chunks, so that only the ones near the viewport are projected
+	for (int i=first; i<points.size()-1; i+=CHUNK_SIZE)
+	{
+		const int nbSegments = points.size()-1-i;
+		Chunk c;
+		c.first = i;
+		c.count = (nbSegments<CHUNK_SIZE ? nbSegments : CHUNK_SIZE)+1;
+		c.labelType = labelType;
+		c.labelAngle = labelAngle;
+		c.cap.n = points.at(i)+points.at(i+c.count/2)+points.at(i+c.count-1);
+		c.cap.n.normalize();
+		c.cap.d = 1.;
+		for (int j=i; j<i+c.count; ++j)
+			c.cap.d = qMin(c.cap.d, c.cap.n*points.at(j));
+		c.cap.d -= 1e-9;
+		chunks.append(c);
+	}
+}
+
+bool GridArcCache::addCircle(const SphericalCap& circle, const Vec3d& fpt,
+			     ViewportEdgeIntersectCallbackData::LabelType labelType, double labelAngle)
+{
+	const Vec3d rotCenter = circle.n*circle.d;
+	Vec3d p1, p2;
+	if (!SphericalCap::intersectionPoints(coverage, circle, p1, p2))
+	{
+		if ((coverage.d<circle.d && coverage.contains(circle.n))
+			|| (coverage.d<-circle.d && coverage.contains(-circle.n)))
+		{
+			// The circle is fully included in the coverage, add it in 3 sub-arcs to avoid lengths >= 180 deg
+			const Mat4d& rotLon120 = Mat4d::rotation(circle.n, 120.*M_PI/180.);
+			Vec3d rotFpt=fpt;
+			rotFpt.transfo4d(rotLon120);
+			Vec3d rotFpt2=rotFpt;
+			rotFpt2.transfo4d(rotLon120);
+			addArc(fpt, rotFpt, rotCenter, labelType, labelAngle);
+			addArc(rotFpt, rotFpt2, rotCenter, labelType, labelAngle);
+			addArc(rotFpt2, fpt, rotCenter, labelType, labelAngle);
+			return true;
+		}
+		return false;
+	}
+
+	// Add the arc in 2 sub-arcs to avoid lengths > 180 deg
+	Vec3d middlePoint = p1-rotCenter+p2-rotCenter;
+	middlePoint.normalize();
+	middlePoint*=(p1-rotCenter).length();
+	middlePoint+=rotCenter;
+	if (!coverage.contains(middlePoint))
+	{
+		middlePoint-=rotCenter;
+		middlePoint*=-1.;
+		middlePoint+=rotCenter;
+	}
+
+	addArc(p1, middlePoint, rotCenter, labelType, labelAngle);
+	addArc(p2, middlePoint, rotCenter, labelType, labelAngle);
+	return true;
+}
+
+void GridArcCache::draw(const StelProjector& prj, const Vec4f& color, ViewportEdgeIntersectCallbackData& labelData) const
+{
+	const SphericalCap& viewport = prj.getBoundingCap();
+	QVarLengthArray<Vec3d, CHUNK_SIZE+1> win(CHUNK_SIZE+1);
+	foreach (const Chunk& c, chunks)
+	{
+		if (!viewport.intersects(c.cap))
+			continue;
+
+		const Vec3d* p = points.constData()+c.first;
+		for (int i=0; i<c.count; ++i)
+		{
+			// Use the 3rd component of the vector to store whether the vertex is valid
+			win[i][2] = prj.project(p[i], win[i]) ? 1.0 : -1.;
+		}
+		labelData.labelType = c.labelType;
+		labelData.raAngle = c.labelAngle;
+		labelData.latAngle = c.labelAngle;
+
+		for (int i=0; i<c.count-1; ++i)
+		{
+			const Vec3d& p1 = win[i];
+			const Vec3d& p2 = win[i+1];
+			const bool p1InViewport = prj.checkInViewport(p1);
+			const bool p2InViewport = prj.checkInViewport(p2);
+			if (!((p1[2]>0 && p1InViewport) || (p2[2]>0 && p2InViewport)))
+				continue;
+			if (prj.intersectViewportDiscontinuity(p[i], p[i+1]))
+				continue;
+
+			gridLinesBatch.vertices.append(Vec2f(p1[0], p1[1]));
+			gridLinesBatch.vertices.append(Vec2f(p2[0], p2[1]));
+			gridLinesBatch.colors.append(color);
+			gridLinesBatch.colors.append(color);
+			if (p1InViewport!=p2InViewport)
+			{
+				// We crossed the edge of the view port
+				if (p1InViewport)
+					viewportEdgeIntersectCallback(prj.viewPortIntersect(p1, p2), p2-p1, &labelData);
+				else
+					viewportEdgeIntersectCallback(prj.viewPortIntersect(p2, p1), p1-p2, &labelData);
+			}
+		}
+	}
 }
 
 //! Draw the sky grid in the current frame
@@ -367,8 +671,6 @@ void SkyGrid::draw(const StelCore* core) const
 	if (!fader.getInterstate())
 		return;
 
-	bool withDecimalDegree = StelApp::getInstance().getFlagShowDecimalDegrees();;
-
 	// Look for all meridians and parallels intersecting with the disk bounding the viewport
 	// Check whether the pole are in the viewport
 	bool northPoleInViewport = false;
@@ -394,77 +696,53 @@ void SkyGrid::draw(const StelCore* core) const
 		gridStepMeridianRad = M_PI/180.* ((northPoleInViewport || southPoleInViewport) ? 15. : closestResLon);
 	}
 
-	// Get the bounding halfspace
-	const SphericalCap& viewPortSphericalCap = prj->getBoundingCap();
-
-	// Compute the first grid starting point. This point is close to the center of the screen
-	// and lies at the intersection of a meridian and a parallel
-	lon2 = gridStepMeridianRad*((int)(lon2/gridStepMeridianRad+0.5));
-	lat2 = gridStepParallelRad*((int)(lat2/gridStepParallelRad+0.5));
-	Vec3d firstPoint;
-	StelUtils::spheToRect(lon2, lat2, firstPoint);
-	firstPoint.normalize();
-
-	// Q_ASSERT(viewPortSphericalCap.contains(firstPoint));
+	// The arcs computed for a previous frame can be reused if the grid steps didn't change
+	// and the viewport is still covered by them, which is the case when only the time changes.
+	const double sampleStep = GridArcCache::getSampleStep(*prj);
+	if (gridStepMeridianRad!=arcsStepMeridianRad || gridStepParallelRad!=arcsStepParallelRad || !arcs.isValid(prj->getBoundingCap(), sampleStep))
+	{
+		// Compute the first grid starting point. This point is close to the center of the screen
+		// and lies at the intersection of a meridian and a parallel
+		lon2 = gridStepMeridianRad*((int)(lon2/gridStepMeridianRad+0.5));
+		lat2 = gridStepParallelRad*((int)(lat2/gridStepParallelRad+0.5));
+		Vec3d firstPoint;
+		StelUtils::spheToRect(lon2, lat2, firstPoint);
+		firstPoint.normalize();
 
-	// Initialize a painter and set OpenGL state
-	StelPainter sPainter(prj);
-	sPainter.setBlending(true);
-	sPainter.setLineSmooth(true);
+		arcs.reset(prj->getBoundingCap(), sampleStep);
+		buildArcs(firstPoint, gridStepMeridianRad, gridStepParallelRad);
+		arcsStepMeridianRad = gridStepMeridianRad;
+		arcsStepParallelRad = gridStepParallelRad;
+	}
 
 	// make text colors just a bit brighter. (But if >1, QColor::setRgb fails and makes text invisible.)
 	Vec4f textColor(qMin(1.0f, 1.25f*color[0]), qMin(1.0f, 1.25f*color[1]), qMin(1.0f, 1.25f*color[2]), fader.getInterstate());
-	sPainter.setColor(color[0],color[1],color[2], fader.getInterstate());
 
-	sPainter.setFont(font);
-	ViewportEdgeIntersectCallbackData userData(&sPainter);
+	ViewportEdgeIntersectCallbackData userData(prj.data());
 	userData.textColor = textColor;
 	userData.frameType = frameType;
+	userData.font = font;
+	arcs.draw(*prj, Vec4f(color[0], color[1], color[2], fader.getInterstate()), userData);
+}
+
+void SkyGrid::buildArcs(const Vec3d& firstPoint, double gridStepMeridianRad, double gridStepParallelRad) const
+{
+	double lon2, lat2;
 
 	/////////////////////////////////////////////////
-	// Draw all the meridians (great circles)
+	// Add all the meridians (great circles)
 	SphericalCap meridianSphericalCap(Vec3d(1,0,0), 0);
 	Mat4d rotLon = Mat4d::zrotation(gridStepMeridianRad);
 	Vec3d fpt = firstPoint;
-	Vec3d p1, p2;
 	int maxNbIter = (int)(M_PI/gridStepMeridianRad);
 	int i;
 	for (i=0; i<maxNbIter; ++i)
 	{
 		StelUtils::rectToSphe(&lon2, &lat2, fpt);
-		userData.raAngle = lon2;
-
 		meridianSphericalCap.n = fpt^Vec3d(0,0,1);
 		meridianSphericalCap.n.normalize();
-		if (!SphericalCap::intersectionPoints(viewPortSphericalCap, meridianSphericalCap, p1, p2))
-		{
-			if (viewPortSphericalCap.d<meridianSphericalCap.d && viewPortSphericalCap.contains(meridianSphericalCap.n))
-			{
-				// The meridian is fully included in the viewport, draw it in 3 sub-arcs to avoid length > 180.
-				const Mat4d& rotLon120 = Mat4d::rotation(meridianSphericalCap.n, 120.*M_PI/180.);
-				Vec3d rotFpt=fpt;
-				rotFpt.transfo4d(rotLon120);
-				Vec3d rotFpt2=rotFpt;
-				rotFpt2.transfo4d(rotLon120);
-				sPainter.drawGreatCircleArc(fpt, rotFpt, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawGreatCircleArc(rotFpt, rotFpt2, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawGreatCircleArc(rotFpt2, fpt, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-				fpt.transfo4d(rotLon);
-				continue;
-			}
-			else
-				break;
-		}
-
-		Vec3d middlePoint = p1+p2;
-		middlePoint.normalize();
-		if (!viewPortSphericalCap.contains(middlePoint))
-			middlePoint*=-1.;
-
-		// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
-		sPainter.drawGreatCircleArc(p1, middlePoint, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-		sPainter.drawGreatCircleArc(p2, middlePoint, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-
+		if (!arcs.addCircle(meridianSphericalCap, fpt, ViewportEdgeIntersectCallbackData::MeridianLabel, lon2))
+			break;
 		fpt.transfo4d(rotLon);
 	}
 
@@ -476,27 +754,16 @@ void SkyGrid::draw(const StelCore* core) const
 		for (int j=0; j<maxNbIter-i; ++j)
 		{
 			StelUtils::rectToSphe(&lon2, &lat2, fpt);
-			userData.raAngle = lon2;
-
 			meridianSphericalCap.n = fpt^Vec3d(0,0,1);
 			meridianSphericalCap.n.normalize();
-			if (!SphericalCap::intersectionPoints(viewPortSphericalCap, meridianSphericalCap, p1, p2))
+			if (!arcs.addCircle(meridianSphericalCap, fpt, ViewportEdgeIntersectCallbackData::MeridianLabel, lon2))
 				break;
-
-			Vec3d middlePoint = p1+p2;
-			middlePoint.normalize();
-			if (!viewPortSphericalCap.contains(middlePoint))
-				middlePoint*=-1;
-
-			sPainter.drawGreatCircleArc(p1, middlePoint, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-			sPainter.drawGreatCircleArc(p2, middlePoint, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-
 			fpt.transfo4d(rotLon);
 		}
 	}
 
 	/////////////////////////////////////////////////
-	// Draw all the parallels (small circles)
+	// Add all the parallels (small circles)
 	SphericalCap parallelSphericalCap(Vec3d(0,0,1), 0);
 	rotLon = Mat4d::rotation(firstPoint^Vec3d(0,0,1), gridStepParallelRad);
 	fpt = firstPoint;
@@ -504,52 +771,11 @@ void SkyGrid::draw(const StelCore* core) const
 	for (i=0; i<maxNbIter; ++i)
 	{
 		StelUtils::rectToSphe(&lon2, &lat2, fpt);
-		if (withDecimalDegree)
-			userData.text = StelUtils::radToDecDegStr(lat2);
-		else
-			userData.text = StelUtils::radToDmsStrAdapt(lat2);
-
 		parallelSphericalCap.d = fpt[2];
 		if (parallelSphericalCap.d>0.9999999)
 			break;
-
-		const Vec3d rotCenter(0,0,parallelSphericalCap.d);
-		if (!SphericalCap::intersectionPoints(viewPortSphericalCap, parallelSphericalCap, p1, p2))
-		{
-			if ((viewPortSphericalCap.d<parallelSphericalCap.d && viewPortSphericalCap.contains(parallelSphericalCap.n))
-				|| (viewPortSphericalCap.d<-parallelSphericalCap.d && viewPortSphericalCap.contains(-parallelSphericalCap.n)))
-			{
-				// The parallel is fully included in the viewport, draw it in 3 sub-arcs to avoid lengths >= 180 deg
-				static const Mat4d rotLon120 = Mat4d::zrotation(120.*M_PI/180.);
-				Vec3d rotFpt=fpt;
-				rotFpt.transfo4d(rotLon120);
-				Vec3d rotFpt2=rotFpt;
-				rotFpt2.transfo4d(rotLon120);
-				sPainter.drawSmallCircleArc(fpt, rotFpt, rotCenter, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawSmallCircleArc(rotFpt, rotFpt2, rotCenter, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawSmallCircleArc(rotFpt2, fpt, rotCenter, viewportEdgeIntersectCallback, &userData);
-				fpt.transfo4d(rotLon);
-				continue;
-			}
-			else
-				break;
-		}
-
-		// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
-		Vec3d middlePoint = p1-rotCenter+p2-rotCenter;
-		middlePoint.normalize();
-		middlePoint*=(p1-rotCenter).length();
-		middlePoint+=rotCenter;
-		if (!viewPortSphericalCap.contains(middlePoint))
-		{
-			middlePoint-=rotCenter;
-			middlePoint*=-1.;
-			middlePoint+=rotCenter;
-		}
-
-		sPainter.drawSmallCircleArc(p1, middlePoint, rotCenter, viewportEdgeIntersectCallback, &userData);
-		sPainter.drawSmallCircleArc(p2, middlePoint, rotCenter, viewportEdgeIntersectCallback, &userData);
-
+		if (!arcs.addCircle(parallelSphericalCap, fpt, ViewportEdgeIntersectCallbackData::ParallelLabel, lat2))
+			break;
 		fpt.transfo4d(rotLon);
 	}
 
@@ -561,58 +787,16 @@ void SkyGrid::draw(const StelCore* core) const
 		for (int j=0; j<maxNbIter-i; ++j)
 		{
 			StelUtils::rectToSphe(&lon2, &lat2, fpt);
-			if (withDecimalDegree)
-				userData.text = StelUtils::radToDecDegStr(lat2);
-			else
-				userData.text = StelUtils::radToDmsStrAdapt(lat2);
-
 			parallelSphericalCap.d = fpt[2];
-			const Vec3d rotCenter(0,0,parallelSphericalCap.d);
-			if (!SphericalCap::intersectionPoints(viewPortSphericalCap, parallelSphericalCap, p1, p2))
-			{
-				if ((viewPortSphericalCap.d<parallelSphericalCap.d && viewPortSphericalCap.contains(parallelSphericalCap.n))
-					 || (viewPortSphericalCap.d<-parallelSphericalCap.d && viewPortSphericalCap.contains(-parallelSphericalCap.n)))
-				{
-					// The parallel is fully included in the viewport, draw it in 3 sub-arcs to avoid lengths >= 180 deg
-					static const Mat4d rotLon120 = Mat4d::zrotation(120.*M_PI/180.);
-					Vec3d rotFpt=fpt;
-					rotFpt.transfo4d(rotLon120);
-					Vec3d rotFpt2=rotFpt;
-					rotFpt2.transfo4d(rotLon120);
-					sPainter.drawSmallCircleArc(fpt, rotFpt, rotCenter, viewportEdgeIntersectCallback, &userData);
-					sPainter.drawSmallCircleArc(rotFpt, rotFpt2, rotCenter, viewportEdgeIntersectCallback, &userData);
-					sPainter.drawSmallCircleArc(rotFpt2, fpt, rotCenter, viewportEdgeIntersectCallback, &userData);
-					fpt.transfo4d(rotLon);
-					continue;
-				}
-				else
-					break;
-			}
-
-			// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
-			Vec3d middlePoint = p1-rotCenter+p2-rotCenter;
-			middlePoint.normalize();
-			middlePoint*=(p1-rotCenter).length();
-			middlePoint+=rotCenter;
-			if (!viewPortSphericalCap.contains(middlePoint))
-			{
-				middlePoint-=rotCenter;
-				middlePoint*=-1.;
-				middlePoint+=rotCenter;
-			}
-
-			sPainter.drawSmallCircleArc(p1, middlePoint, rotCenter, viewportEdgeIntersectCallback, &userData);
-			sPainter.drawSmallCircleArc(p2, middlePoint, rotCenter, viewportEdgeIntersectCallback, &userData);
-
+			if (!arcs.addCircle(parallelSphericalCap, fpt, ViewportEdgeIntersectCallbackData::ParallelLabel, lat2))
+				break;
 			fpt.transfo4d(rotLon);
 		}
 	}
-
-	sPainter.setLineSmooth(false);
 }
 
 
-SkyLine::SkyLine(SKY_LINE_TYPE _line_type) : line_type(_line_type), color(0.f, 0.f, 1.f)
+SkyLine::SkyLine(SKY_LINE_TYPE _line_type) : line_type(_line_type), color(0.f, 0.f, 1.f), arcsCircle(Vec3d(0,0,1), 0)
 {
 	// Font size is 14
 	font.setPixelSize(StelApp::getInstance().getBaseFontSize()+1);
@@ -707,26 +891,12 @@ void SkyLine::draw(StelCore *core) const
 
 	StelProjectorP prj = core->getProjection(frameType, frameType!=StelCore::FrameAltAz ? StelCore::RefractionAuto : StelCore::RefractionOff);
 
-	// Get the bounding halfspace
-	const SphericalCap& viewPortSphericalCap = prj->getBoundingCap();
-
-	// Initialize a painter and set openGL state
-	StelPainter sPainter(prj);
-	sPainter.setColor(color[0], color[1], color[2], fader.getInterstate());
-	sPainter.setBlending(true);
-	sPainter.setLineSmooth(true);
-
-	Vec4f textColor(color[0], color[1], color[2], 0);		
-	textColor[3]=fader.getInterstate();
-
-	ViewportEdgeIntersectCallbackData userData(&sPainter);	
-	sPainter.setFont(font);
-	userData.textColor = textColor;	
-	userData.text = label;
 	/////////////////////////////////////////////////
-	// Draw the line
+	// Find the circle of the line and a point on it
 
 	// Precession and Circumpolar circles are Small Circles, all others are Great Circles.
+	SphericalCap circle(Vec3d(0,0,1), 0);
+	Vec3d fpt(1,0,0);
 	if (line_type==PRECESSIONCIRCLE_N || line_type==PRECESSIONCIRCLE_S || line_type==CIRCUMPOLARCIRCLE_N || line_type==CIRCUMPOLARCIRCLE_S)
 	{
 		double lat;
@@ -746,66 +916,17 @@ void SkyLine::draw(StelCore *core) const
 				lat=(obsLatRad>0 ? +1.0 : -1.0) * obsLatRad - (M_PI/2.0);
 
 		}
-		SphericalCap declinationCap(Vec3d(0,0,1), std::sin(lat));
-		const Vec3d rotCenter(0,0,declinationCap.d);
-
-		Vec3d p1, p2;
-		if (!SphericalCap::intersectionPoints(viewPortSphericalCap, declinationCap, p1, p2))
-		{
-			if ((viewPortSphericalCap.d<declinationCap.d && viewPortSphericalCap.contains(declinationCap.n))
-				|| (viewPortSphericalCap.d<-declinationCap.d && viewPortSphericalCap.contains(-declinationCap.n)))
-			{
-				// The line is fully included in the viewport, draw it in 3 sub-arcs to avoid length > 180.
-				Vec3d pt1;
-				Vec3d pt2;
-				Vec3d pt3;
-				const double lon1=0.0;
-				const double lon2=120.0*M_PI/180.0;
-				const double lon3=240.0*M_PI/180.0;
-				StelUtils::spheToRect(lon1, lat, pt1); pt1.normalize();
-				StelUtils::spheToRect(lon2, lat, pt2); pt2.normalize();
-				StelUtils::spheToRect(lon3, lat, pt3); pt3.normalize();
-
-				sPainter.drawSmallCircleArc(pt1, pt2, rotCenter, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawSmallCircleArc(pt2, pt3, rotCenter, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawSmallCircleArc(pt3, pt1, rotCenter, viewportEdgeIntersectCallback, &userData);
-			}
-
-			sPainter.setLineSmooth(false);
-			sPainter.setBlending(false);
-			return;
-		}
-		// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
-		Vec3d middlePoint = p1-rotCenter+p2-rotCenter;
-		middlePoint.normalize();
-		middlePoint*=(p1-rotCenter).length();
-		middlePoint+=rotCenter;
-		if (!viewPortSphericalCap.contains(middlePoint))
-		{
-			middlePoint-=rotCenter;
-			middlePoint*=-1.;
-			middlePoint+=rotCenter;
-		}
-
-		sPainter.drawSmallCircleArc(p1, middlePoint, rotCenter,viewportEdgeIntersectCallback, &userData);
-		sPainter.drawSmallCircleArc(p2, middlePoint, rotCenter, viewportEdgeIntersectCallback, &userData);
-
-		sPainter.setLineSmooth(false);
-		sPainter.setBlending(false);
-
-		return;
+		circle.d = std::sin(lat);
+		StelUtils::spheToRect(0., lat, fpt);
+		fpt.normalize();
 	}
-
-	// All the other "lines" are Great Circles
-	SphericalCap meridianSphericalCap(Vec3d(0,0,1), 0);	
-	Vec3d fpt(1,0,0);
 	if ((line_type==MERIDIAN) || (line_type==COLURE_1))
 	{
-		meridianSphericalCap.n.set(0,1,0);
+		circle.n.set(0,1,0);
 	}
 	if ((line_type==PRIME_VERTICAL) || (line_type==COLURE_2))
 	{
-		meridianSphericalCap.n.set(1,0,0);
+		circle.n.set(1,0,0);
 		fpt.set(0,0,1);
 	}
 	if (line_type==LONGITUDE)
@@ -819,43 +940,27 @@ void SkyLine::draw(StelCore *core) const
 		if (lambdaJDE<0) lambdaJDE+=2.0*M_PI;
 
 		StelUtils::spheToRect(lambdaJDE + M_PI/2., 0., coord);
-		meridianSphericalCap.n.set(coord[0],coord[1],coord[2]);
+		circle.n.set(coord[0],coord[1],coord[2]);
 		fpt.set(0,0,1);
 	}
 
-	Vec3d p1, p2;
-	if (!SphericalCap::intersectionPoints(viewPortSphericalCap, meridianSphericalCap, p1, p2))
+	// Reuse the arcs of a previous frame as long as they cover the viewport and the circle
+	// moved by less than about half a pixel, e.g. with the slow drift of the precession circles.
+	const double sampleStep = GridArcCache::getSampleStep(*prj);
+	const double tolerance = sampleStep/32.;
+	if (!arcs.isValid(prj->getBoundingCap(), sampleStep) || (circle.n-arcsCircle.n).lengthSquared()>tolerance*tolerance
+		|| std::fabs(circle.d-arcsCircle.d)>tolerance)
 	{
-		if ((viewPortSphericalCap.d<meridianSphericalCap.d && viewPortSphericalCap.contains(meridianSphericalCap.n))
-			|| (viewPortSphericalCap.d<-meridianSphericalCap.d && viewPortSphericalCap.contains(-meridianSphericalCap.n)))
-		{
-			// The meridian is fully included in the viewport, draw it in 3 sub-arcs to avoid length > 180.
-			const Mat4d& rotLon120 = Mat4d::rotation(meridianSphericalCap.n, 120.*M_PI/180.);
-			Vec3d rotFpt=fpt;
-			rotFpt.transfo4d(rotLon120);
-			Vec3d rotFpt2=rotFpt;
-			rotFpt2.transfo4d(rotLon120);
-			sPainter.drawGreatCircleArc(fpt, rotFpt, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-			sPainter.drawGreatCircleArc(rotFpt, rotFpt2, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-			sPainter.drawGreatCircleArc(rotFpt2, fpt, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-			return;
-		}
-		else
-			return;
+		arcs.reset(prj->getBoundingCap(), sampleStep);
+		arcs.addCircle(circle, fpt);
+		arcsCircle = circle;
 	}
 
-
-	Vec3d middlePoint = p1+p2;
-	middlePoint.normalize();
-	if (!viewPortSphericalCap.contains(middlePoint))
-		middlePoint*=-1.;
-
-	// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
-	sPainter.drawGreatCircleArc(p1, middlePoint, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-	sPainter.drawGreatCircleArc(p2, middlePoint, Q_NULLPTR, viewportEdgeIntersectCallback, &userData);
-
-	sPainter.setLineSmooth(false);
-	sPainter.setBlending(false);
+	ViewportEdgeIntersectCallbackData userData(prj.data());
+	userData.textColor = Vec4f(color[0], color[1], color[2], fader.getInterstate());
+	userData.font = font;
+	userData.text = label;
+	arcs.draw(*prj, Vec4f(color[0], color[1], color[2], fader.getInterstate()), userData);
 
 // 	// Johannes: use a big radius as a dirty workaround for the bug that the
 // 	// ecliptic line is not drawn around the observer, but around the sun:
@@ -1311,13 +1416,15 @@ void GridLinesMgr::draw(StelCore* core)
 	if (!gridlinesDisplayed)
 		return;
 
+	// The grids and lines only add their segments and labels to a batch, drawn at once before the points
 	galacticGrid->draw(core);
 	supergalacticGrid->draw(core);
 	eclJ2000Grid->draw(core);
 	// While ecliptic of J2000 may be helpful to get a feeling of the Z=0 plane of VSOP87,
 	// ecliptic of date is related to Earth and does not make much sense for the other planets.
 	// Of course, orbital plane of respective planet would be better, but is not implemented.
-	if (core->getCurrentPlanet()==earth)
+	const bool onEarth = core->getCurrentPlanet()==earth;
+	if (onEarth)
 	{
 		eclGrid->draw(core);
 		eclipticLine->draw(core);
@@ -1325,9 +1432,6 @@ void GridLinesMgr::draw(StelCore* core)
 		precessionCircleS->draw(core);
 		colureLine_1->draw(core);
 		colureLine_2->draw(core);
-		eclipticPoles->draw(core);
-		equinoxPoints->draw(core);
-		solsticePoints->draw(core);
 		longitudeLine->draw(core);
 	}
 
@@ -1345,6 +1449,14 @@ void GridLinesMgr::draw(StelCore* core)
 	primeVerticalLine->draw(core);
 	circumpolarCircleN->draw(core);
 	circumpolarCircleS->draw(core);
+	gridLinesBatch.flush(core);
+
+	if (onEarth)
+	{
+		eclipticPoles->draw(core);
+		equinoxPoints->draw(core);
+		solsticePoints->draw(core);
+	}
 	celestialJ2000Poles->draw(core);
 	celestialPoles->draw(core);
 	zenithNadir->draw(core);
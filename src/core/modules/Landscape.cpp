@@ -34,6 +34,9 @@
 #include <QVarLengthArray>
 #include <QFile>
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCoreApplication>
 #include <QtAlgorithms>
 
 Landscape::Landscape(float _radius)
@@ -54,7 +57,8 @@ Landscape::Landscape(float _radius)
 	, defaultTemperature(-1000.)
 	, defaultPressure(-2.)
 	, horizonPolygon(Q_NULLPTR)
-	, fontSize(18)
+	, fontSize(15)
+	, labelColor(0.2f, 0.8f, 0.2f)
 {
 }
 
@@ -139,13 +143,17 @@ void Landscape::loadCommon(const QSettings& landscapeIni, const QString& landsca
 		// This line can then be drawn in all classes with the color specified here. If not specified, don't draw it! (flagged by negative red)
 		horizonPolygonLineColor=StelUtils::strToVec3f(landscapeIni.value("landscape/horizon_line_color", "-1,0,0" ).toString());
 	}
-	// we must get label color, this is global. (No sense to make that per-landscape!)
-	QSettings *config = StelApp::getInstance().getSettings();
-	labelColor=StelUtils::strToVec3f(config->value("landscape/label_color", "0.2,0.8,0.2").toString());
-	fontSize=config->value("landscape/label_font_size", 18).toInt();
+	// The label color and font size are global and were given by setLabelSettings(). (No sense to make that per-landscape!)
 	loadLabels(landscapeId);
 }
 
+void Landscape::setLabelSettings(const LabelSettings& settings)
+{
+	labelColor = settings.color;
+	fontSize = settings.fontSize;
+	labelLanguage = settings.language;
+}
+
 void Landscape::createPolygonalHorizon(const QString& lineFileName, const float polyAngleRotateZ, const QString &listMode , const bool polygonInverted)
 {
 	// qDebug() << _name << " " << _fullpath << " " << _lineFileName ;
@@ -249,6 +257,70 @@ const QString Landscape::getTexturePath(const QString& basename, const QString&
 	return path;
 }
 
+QByteArray Landscape::getHorizonProfileSignature(const QStringList& sourceFiles, const QString& parameters) const
+{
+	QByteArray signature=parameters.toUtf8();
+	foreach (const QString& path, sourceFiles)
+	{
+		QFileInfo info(path);
+		signature += "|" + path.toUtf8() + ":" + QByteArray::number(info.size()) + ":" + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+	}
+	return signature;
+}
+
+StelTextureSP Landscape::createLandscapeTexture(const QString& path, const StelTexture::StelTextureParams& params)
+{
+	StelTextureSP tex = StelApp::getInstance().getTextureManager().createTextureThread(path, params, false);
+	if (tex)
+	{
+		// The landscape may be loaded in a worker thread. The texture is used by the main thread only from now on.
+		if (tex->thread()!=QCoreApplication::instance()->thread())
+			tex->moveToThread(QCoreApplication::instance()->thread());
+		landscapeTextures.append(tex);
+	}
+	return tex;
+}
+
+unsigned int Landscape::getTextureMemorySize() const
+{
+	unsigned int size=0;
+	foreach (const StelTextureSP& tex, landscapeTextures)
+		size+=tex->getGlSize();
+	return size;
+}
+
+int Landscape::uploadTextures(int maxUploads)
+{
+	int uploads=0;
+	foreach (const StelTextureSP& tex, landscapeTextures)
+	{
+		if (maxUploads>=0 && uploads>=maxUploads)
+			break;
+		if (tex->canBind() || tex->hasError())
+			continue;
+		// bind() does the upload as soon as the loader thread has finished decoding
+		if (tex->bind())
+			++uploads;
+	}
+	return uploads;
+}
+
+void Landscape::waitForTextures() const
+{
+	foreach (const StelTextureSP& tex, landscapeTextures)
+		tex->waitForLoaded();
+}
+
+bool Landscape::isReady() const
+{
+	foreach (const StelTextureSP& tex, landscapeTextures)
+	{
+		if (!tex->canBind() && !tex->hasError())
+			return false;
+	}
+	return true;
+}
+
 // find optional file and fill landscapeLabels list.
 void Landscape::loadLabels(const QString& landscapeId)
 {
@@ -257,7 +329,7 @@ void Landscape::loadLabels(const QString& landscapeId)
 
 	QString lang, descFileName, locLabelFileName, engLabelFileName;
 
-	lang = StelApp::getInstance().getLocaleMgr().getAppLanguage();
+	lang = labelLanguage;
 	locLabelFileName = StelFileMgr::findFile("landscapes/" + landscapeId, StelFileMgr::Directory) + "/gazetteer." + lang + ".utf8";
 	engLabelFileName = StelFileMgr::findFile("landscapes/" + landscapeId, StelFileMgr::Directory) + "/gazetteer.en.utf8";
 
@@ -375,11 +447,6 @@ LandscapeOldStyle::~LandscapeOldStyle()
 	}
 
 	if (sides) delete [] sides;
-	if (sidesImages.size()>0)
-	{
-		qDeleteAll(sidesImages);
-		sidesImages.clear();
-	}
 	landscapeLabels.clear();
 }
 
@@ -415,36 +482,25 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 	// Load sides textures
 	nbSideTexs = landscapeIni.value("landscape/nbsidetex", 0).toInt();
 	sideTexs = new StelTextureSP[2*nbSideTexs]; // 0.14: allow upper half for light textures!
+	QStringList sideTexturePaths;
 	for (int i=0; i<nbSideTexs; ++i)
 	{
 		QString textureKey = QString("landscape/tex%1").arg(i);
 		QString textureName = landscapeIni.value(textureKey).toString();
 		const QString texturePath = getTexturePath(textureName, landscapeId);
-		sideTexs[i] = StelApp::getInstance().getTextureManager().createTexture(texturePath);
-		// GZ: To query the textures, also keep an array of QImage*, but only
-		// if that query is not going to be prevented by the polygon that already has been loaded at that point...
-		if ( (!horizonPolygon) && calibrated ) { // for uncalibrated landscapes the texture is currently never queried, so no need to store.
-			QImage *image = new QImage(texturePath);
-			sidesImages.append(image); // indices identical to those in sideTexs
-			memorySize+=image->byteCount();
-		}
+		sideTexs[i] = createLandscapeTexture(texturePath);
+		sideTexturePaths.append(texturePath); // indices identical to those in sideTexs
 		// Also allow light textures. The light textures must cover the same geometry as the sides. It is allowed that not all or even any light textures are present!
 		textureKey = QString("landscape/light%1").arg(i);
 		textureName = landscapeIni.value(textureKey).toString();
 		if (textureName.length())
 		{
 			const QString lightTexturePath = getTexturePath(textureName, landscapeId);
-			sideTexs[nbSideTexs+i] = StelApp::getInstance().getTextureManager().createTexture(lightTexturePath);
-			if(sideTexs[nbSideTexs+i])
-				memorySize+=sideTexs[nbSideTexs+i].data()->getGlSize();
+			sideTexs[nbSideTexs+i] = createLandscapeTexture(lightTexturePath);
 		}
 		else
 			sideTexs[nbSideTexs+i].clear();
 	}
-	if ( (!horizonPolygon) && calibrated )
-	{
-		Q_ASSERT(sidesImages.size()==nbSideTexs);
-	}
 	QMap<int, int> texToSide;
 	// Init sides parameters
 	nbSide = landscapeIni.value("landscape/nbside", 0).toInt();
@@ -476,17 +532,42 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 		// Maybe this can be again simplified?
 		texToSide[i] = texnum;
 	}
+
+	// To query opacity, derive the horizon profile from the side textures, but only
+	// if that query is not going to be prevented by the polygon that already has been loaded at that point...
+	// For uncalibrated landscapes the texture is currently never queried, so no need to sample.
+	if ( (!horizonPolygon) && calibrated )
+	{
+		const QByteArray signature=getHorizonProfileSignature(sideTexturePaths,
+			QString("old_style:%1:%2:%3:%4:%5:%6").arg(nbSide).arg(nbDecorRepeat).arg(decorAltAngle).arg(decorAngleShift).arg(angleRotateZ).arg(tanMode));
+		if (!horizonProfile.loadFromCache(landscapeId, signature))
+		{
+			QVector<QImage> sidesImages;
+			bool imagesLoaded = true;
+			foreach (const QString& path, sideTexturePaths)
+			{
+				sidesImages.append(QImage(path));
+				imagesLoaded = imagesLoaded && !sidesImages.last().isNull();
+			}
+			// A missing side would make the profile transparent there, and it would be cached as valid
+			if (imagesLoaded)
+			{
+				ImageSampler sampler = {this, &sidesImages};
+				horizonProfile.build(sampler);
+				horizonProfile.saveToCache(landscapeId, signature);
+			}
+			else
+				qWarning() << "Cannot decode the side textures of landscape" << landscapeId << ", its opacity is not available";
+		}
+		memorySize+=horizonProfile.getMemorySize();
+	}
 	QString groundTexName = landscapeIni.value("landscape/groundtex").toString();
 	QString groundTexPath = getTexturePath(groundTexName, landscapeId);
-	groundTex = StelApp::getInstance().getTextureManager().createTexture(groundTexPath, StelTexture::StelTextureParams(true));
-	if (groundTex)
-		memorySize+=groundTex.data()->getGlSize();
+	groundTex = createLandscapeTexture(groundTexPath, StelTexture::StelTextureParams(true));
 
 	QString fogTexName = landscapeIni.value("landscape/fogtex").toString();
 	QString fogTexPath = getTexturePath(fogTexName, landscapeId);
-	fogTex = StelApp::getInstance().getTextureManager().createTexture(fogTexPath, StelTexture::StelTextureParams(true, GL_LINEAR, GL_REPEAT));
-	if (fogTex)
-		memorySize+=fogTex.data()->getGlSize();
+	fogTex = createLandscapeTexture(fogTexPath, StelTexture::StelTextureParams(true, GL_LINEAR, GL_REPEAT));
 
 	// Precompute the vertex arrays for ground display
 	// Make slices_per_side=(3<<K) so that the innermost polygon of the fandisk becomes a triangle:
@@ -744,12 +825,16 @@ float LandscapeOldStyle::getOpacity(Vec3d azalt) const
 	{
 		if (horizonPolygon->contains(azalt)) return 1.0f; else return 0.0f;
 	}
-	// Else, sample the images...
 	float az, alt_rad;
 	StelUtils::rectToSphe(&az, &alt_rad, azalt);
 
 	if (alt_rad < decorAngleShift*M_PI/180.0f) return 1.0f; // below decor, i.e. certainly opaque ground.
 	if (alt_rad > (decorAltAngle+decorAngleShift)*M_PI/180.0f) return 0.0f; // above decor, i.e. certainly free sky.
+
+	// Else, use the horizon profile sampled from the images at load time.
+	if (horizonProfile.isValid())
+		return horizonProfile.getOpacity(azalt);
+
 	if (!calibrated) // the result of this function has no real use here: just complain and return result for math. horizon.
 	{
 		static QString lastLandscapeName;
@@ -758,8 +843,18 @@ float LandscapeOldStyle::getOpacity(Vec3d azalt) const
 			qWarning() << "Dubious result: Landscape " << name << " not calibrated. Opacity test represents mathematical horizon only.";
 			lastLandscapeName=name;
 		}
-		return (azalt[2] > 0 ? 0.0f : 1.0f);
 	}
+	return (azalt[2] > 0 ? 0.0f : 1.0f);
+}
+
+float LandscapeOldStyle::sampleImageOpacity(const QVector<QImage>& sidesImages, Vec3d azalt) const
+{
+	Q_ASSERT(calibrated);
+	float az, alt_rad;
+	StelUtils::rectToSphe(&az, &alt_rad, azalt);
+
+	if (alt_rad < decorAngleShift*M_PI/180.0f) return 1.0f; // below decor, i.e. certainly opaque ground.
+	if (alt_rad > (decorAltAngle+decorAngleShift)*M_PI/180.0f) return 0.0f; // above decor, i.e. certainly free sky.
 	az = (M_PI-az) / M_PI;                             //  0..2 = N.E.S.W.N
 	// we go to 0..1 domain, it's easier to think.
 	const float xShift=angleRotateZ /(2.0f*M_PI); // shift value in -1..1 domain
@@ -774,7 +869,7 @@ float LandscapeOldStyle::getOpacity(Vec3d azalt) const
 	Q_ASSERT(currentSide>=0);
 	Q_ASSERT(currentSide<nbSideTexs);
 	int x= (sides[currentSide].texCoords[0] + x_in_panel*(sides[currentSide].texCoords[2]-sides[currentSide].texCoords[0]))
-			* sidesImages[currentSide]->width(); // pixel X from left.
+			* sidesImages[currentSide].width(); // pixel X from left.
 
 	// QImage has pixel 0/0 in top left corner. We must find image Y for optionally cropped images.
 	// It should no longer be possible that sample position is outside cropped texture. in this case, assert(0) but again assume full transparency and exit early.
@@ -801,15 +896,16 @@ float LandscapeOldStyle::getOpacity(Vec3d azalt) const
 	}
 	// x0/y0 is lower left, x1/y1 upper right corner.
 	float y_baseImg_1 = sides[currentSide].texCoords[1]+ y_img_1*(sides[currentSide].texCoords[3]-sides[currentSide].texCoords[1]);
-	int y=(1.0-y_baseImg_1)*sidesImages[currentSide]->height();           // pixel Y from top.
-	QRgb pixVal=sidesImages[currentSide]->pixel(x, y);
+	int y=(1.0-y_baseImg_1)*sidesImages[currentSide].height();           // pixel Y from top.
+	const QImage& sideImage=sidesImages.at(currentSide);
+	QRgb pixVal=sideImage.pixel(qBound(0, x, sideImage.width()-1), qBound(0, y, sideImage.height()-1));
 /*
 #ifndef NDEBUG
 	// GZ: please leave the comment available for further development!
 	qDebug() << "Oldstyle Landscape sampling: az=" << az*180.0 << "° alt=" << alt_rad*180.0f/M_PI
 			 << "°, xShift[-1..+1]=" << xShift << " az_phot[0..1]=" << az_phot
 			 << " --> current side panel " << currentSide
-			 << ", w=" << sidesImages[currentSide]->width() << " h=" << sidesImages[currentSide]->height()
+			 << ", w=" << sidesImages[currentSide].width() << " h=" << sidesImages[currentSide].height()
 			 << " --> x:" << x << " y:" << y << " alpha:" << qAlpha(pixVal)/255.0f;
 #endif
 */
@@ -893,14 +989,12 @@ LandscapeFisheye::LandscapeFisheye(float _radius)
 	, mapTex(StelTextureSP())
 	, mapTexFog(StelTextureSP())
 	, mapTexIllum(StelTextureSP())
-	, mapImage(Q_NULLPTR)
 	, texFov(360.)
 	, memorySize(0)
 {}
 
 LandscapeFisheye::~LandscapeFisheye()
 {
-	if (mapImage) delete mapImage;
 	landscapeLabels.clear();
 }
 
@@ -935,23 +1029,29 @@ void LandscapeFisheye::create(const QString _name, float _texturefov, const QStr
 
 	if (!horizonPolygon)
 	{
-		mapImage = new QImage(_maptex);
-		memorySize+=mapImage->byteCount();
+		// The image is only needed to derive the horizon profile, which then answers all opacity queries.
+		const QByteArray signature=getHorizonProfileSignature(QStringList(_maptex), QString("fisheye:%1:%2").arg(texFov).arg(angleRotateZ));
+		if (!horizonProfile.loadFromCache(id, signature))
+		{
+			const QImage mapImage(_maptex);
+			if (!mapImage.isNull())
+			{
+				ImageSampler sampler = {this, &mapImage};
+				horizonProfile.build(sampler);
+				horizonProfile.saveToCache(id, signature);
+			}
+		}
+		memorySize+=horizonProfile.getMemorySize();
 	}
-	mapTex = StelApp::getInstance().getTextureManager().createTexture(_maptex, StelTexture::StelTextureParams(true));
-	memorySize+=mapTex.data()->getGlSize();
+	mapTex = createLandscapeTexture(_maptex, StelTexture::StelTextureParams(true));
 
 	if (_maptexIllum.length() && (!_maptexIllum.endsWith("/")))
 	{
-		mapTexIllum = StelApp::getInstance().getTextureManager().createTexture(_maptexIllum, StelTexture::StelTextureParams(true));
-		if (mapTexIllum)
-			memorySize+=mapTexIllum.data()->getGlSize();
+		mapTexIllum = createLandscapeTexture(_maptexIllum, StelTexture::StelTextureParams(true));
 	}
 	if (_maptexFog.length() && (!_maptexFog.endsWith("/")))
 	{
-		mapTexFog = StelApp::getInstance().getTextureManager().createTexture(_maptexFog, StelTexture::StelTextureParams(true));
-		if (mapTexFog)
-			memorySize+=mapTexFog.data()->getGlSize();
+		mapTexFog = createLandscapeTexture(_maptexFog, StelTexture::StelTextureParams(true));
 	}
 }
 
@@ -1008,7 +1108,14 @@ float LandscapeFisheye::getOpacity(Vec3d azalt) const
 	{
 		if (horizonPolygon->contains(azalt)) return 1.0f; else return 0.0f;
 	}
-	// Else, sample the image...
+	// Else, use the horizon profile sampled from the image at load time.
+	if (horizonProfile.isValid())
+		return horizonProfile.getOpacity(azalt);
+	return (azalt[2] > 0 ? 0.0f : 1.0f);
+}
+
+float LandscapeFisheye::sampleImageOpacity(const QImage& mapImage, Vec3d azalt) const
+{
 	float az, alt_rad;
 	StelUtils::rectToSphe(&az, &alt_rad, azalt);
 
@@ -1021,15 +1128,15 @@ float LandscapeFisheye::getOpacity(Vec3d azalt) const
 
 	az = (M_PI-az) - angleRotateZ; // 0..+2pi -angleRotateZ, real azimuth. NESW
 	//  The texture map has south on top, east at right (if anglerotateZ=0)
-	int x= mapImage->height()/2*(1 + radius*std::sin(az));
-	int y= mapImage->height()/2*(1 + radius*std::cos(az));
+	int x= mapImage.height()/2*(1 + radius*std::sin(az));
+	int y= mapImage.height()/2*(1 + radius*std::cos(az));
 
-	QRgb pixVal=mapImage->pixel(x, y);
+	QRgb pixVal=mapImage.pixel(qBound(0, x, mapImage.width()-1), qBound(0, y, mapImage.height()-1));
 /*
 #ifndef NDEBUG
 	// GZ: please leave the comment available for further development!
 	qDebug() << "Landscape sampling: az=" << (az+angleRotateZ)/M_PI*180.0f << "° alt=" << alt_rad/M_PI*180.f
-			 << "°, w=" << mapImage->width() << " h=" << mapImage->height()
+			 << "°, w=" << mapImage.width() << " h=" << mapImage.height()
 			 << " --> x:" << x << " y:" << y << " alpha:" << qAlpha(pixVal)/255.0f;
 #endif
 */
@@ -1051,13 +1158,11 @@ LandscapeSpherical::LandscapeSpherical(float _radius)
 	, fogTexBottom(0.)
 	, illumTexTop(0.)
 	, illumTexBottom(0.)
-	, mapImage(Q_NULLPTR)
 	, memorySize(sizeof(LandscapeSpherical))
 {}
 
 LandscapeSpherical::~LandscapeSpherical()
 {
-	if (mapImage) delete mapImage;
 	landscapeLabels.clear();
 }
 
@@ -1112,23 +1217,30 @@ void LandscapeSpherical::create(const QString _name, const QString& _maptex, con
 	illumTexBottom= (90.f-_illumTexBottom)*M_PI/180.f;
 	if (!horizonPolygon)
 	{
-		mapImage = new QImage(_maptex);
-		memorySize+=mapImage->byteCount();
+		// The image is only needed to derive the horizon profile, which then answers all opacity queries.
+		const QByteArray signature=getHorizonProfileSignature(QStringList(_maptex),
+			QString("spherical:%1:%2:%3").arg(angleRotateZ).arg(mapTexTop).arg(mapTexBottom));
+		if (!horizonProfile.loadFromCache(id, signature))
+		{
+			const QImage mapImage(_maptex);
+			if (!mapImage.isNull())
+			{
+				ImageSampler sampler = {this, &mapImage};
+				horizonProfile.build(sampler);
+				horizonProfile.saveToCache(id, signature);
+			}
+		}
+		memorySize+=horizonProfile.getMemorySize();
 	}
-	mapTex = StelApp::getInstance().getTextureManager().createTexture(_maptex, StelTexture::StelTextureParams(true));
-	memorySize+=mapTex.data()->getGlSize();
+	mapTex = createLandscapeTexture(_maptex, StelTexture::StelTextureParams(true));
 
 	if (_maptexIllum.length() && (!_maptexIllum.endsWith("/")))
 	{
-		mapTexIllum = StelApp::getInstance().getTextureManager().createTexture(_maptexIllum, StelTexture::StelTextureParams(true));
-		if (mapTexIllum)
-			memorySize+=mapTexIllum.data()->getGlSize();
+		mapTexIllum = createLandscapeTexture(_maptexIllum, StelTexture::StelTextureParams(true));
 	}
 	if (_maptexFog.length() && (!_maptexFog.endsWith("/")))
 	{
-		mapTexFog = StelApp::getInstance().getTextureManager().createTexture(_maptexFog, StelTexture::StelTextureParams(true));
-		if (mapTexFog)
-			memorySize+=mapTexFog.data()->getGlSize();
+		mapTexFog = createLandscapeTexture(_maptexFog, StelTexture::StelTextureParams(true));
 	}
 }
 
@@ -1205,7 +1317,14 @@ float LandscapeSpherical::getOpacity(Vec3d azalt) const
 	{
 		if (horizonPolygon->contains(azalt)) return 1.0f; else return 0.0f;
 	}
-	// Else, sample the image...
+	// Else, use the horizon profile sampled from the image at load time.
+	if (horizonProfile.isValid())
+		return horizonProfile.getOpacity(azalt);
+	return (azalt[2] > 0 ? 0.0f : 1.0f);
+}
+
+float LandscapeSpherical::sampleImageOpacity(const QImage& mapImage, Vec3d azalt) const
+{
 	float az, alt_rad;
 	StelUtils::rectToSphe(&az, &alt_rad, azalt);
 
@@ -1222,7 +1341,7 @@ float LandscapeSpherical::getOpacity(Vec3d azalt) const
 	Q_ASSERT(y_img_1<=1.f);
 	Q_ASSERT(y_img_1>=0.f);
 
-	int y=(1.0-y_img_1)*mapImage->height();           // pixel Y from top.
+	int y=(1.0-y_img_1)*mapImage.height();           // pixel Y from top.
 
 	az = (M_PI-az) / M_PI;                            //  0..2 = N.E.S.W.N
 
@@ -1231,15 +1350,15 @@ float LandscapeSpherical::getOpacity(Vec3d azalt) const
 	az_phot=fmodf(az_phot, 2.0f);
 	if (az_phot<0) az_phot+=2.0f;                                //  0..2 = image-X
 
-	int x=(az_phot/2.0f) * mapImage->width(); // pixel X from left.
+	int x=(az_phot/2.0f) * mapImage.width(); // pixel X from left.
 
-	QRgb pixVal=mapImage->pixel(x, y);
+	QRgb pixVal=mapImage.pixel(qBound(0, x, mapImage.width()-1), qBound(0, y, mapImage.height()-1));
 /*
 #ifndef NDEBUG
 	// GZ: please leave the comment available for further development!
 	qDebug() << "Landscape sampling: az=" << az*180.0 << "° alt=" << alt_pm1*90.0f
 			 << "°, xShift[-2..+2]=" << xShift << " az_phot[0..2]=" << az_phot
-			 << ", w=" << mapImage->width() << " h=" << mapImage->height()
+			 << ", w=" << mapImage.width() << " h=" << mapImage.height()
 			 << " --> x:" << x << " y:" << y << " alpha:" << qAlpha(pixVal)/255.0f;
 #endif
 */
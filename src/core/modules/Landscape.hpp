@@ -27,7 +27,9 @@
 #include "StelFader.hpp"
 #include "StelUtils.hpp"
 #include "StelTextureTypes.hpp"
+#include "StelTexture.hpp"
 #include "StelLocation.hpp"
+#include "LandscapeHorizonProfile.hpp"
 
 #include <QMap>
 #include <QImage>
@@ -82,6 +84,15 @@ public:
 	//! The value returned is a sum of RAM and texture memory requirements.
 	virtual unsigned int getMemorySize() const {return sizeof(Landscape);}
 
+	//! Upload textures which have been decoded in the background to OpenGL. Must be called from the main thread.
+	//! @param maxUploads the maximum number of textures to upload in this call, or -1 for no limit.
+	//! @return the number of textures uploaded.
+	int uploadTextures(int maxUploads=-1);
+	//! Block until all textures of the landscape have been decoded.
+	void waitForTextures() const;
+	//! Return true when all textures have been uploaded (or failed to load), i.e. the landscape can be drawn without stalls.
+	bool isReady() const;
+
 	virtual void draw(StelCore* core) = 0;
 	void update(double deltaTime)
 	{
@@ -125,6 +136,19 @@ public:
 	//! change font and fontsize for landscape labels
 	void setLabelFontSize(const int size){fontSize=size;}
 
+	//! The application settings used by the labels. They are read in the main thread and given to the
+	//! landscape before load(), which can run in a worker thread and must not access the StelApp settings.
+	struct LabelSettings
+	{
+		LabelSettings() : color(0.2f, 0.8f, 0.2f), fontSize(15) {}
+		Vec3f color;
+		int fontSize;
+		//! The application language, for the gazetteer files
+		QString language;
+	};
+	//! Set the settings of the labels, used by load() and loadLabels().
+	void setLabelSettings(const LabelSettings& settings);
+
 	//! Get landscape name
 	QString getName() const {return name;}
 	//! Get landscape author name
@@ -171,6 +195,9 @@ public:
 	//! Default implementation indicates the horizon equals math horizon.
 	// TBD: Maybe change this to azalt[2]<sinMinAltitudeLimit ? (But never called in practice, reimplemented by the subclasses...)
 	virtual float getOpacity(Vec3d azalt) const { Q_ASSERT(0); return (azalt[2]<0 ? 1.0f : 0.0f); }
+	//! Return whether the given direction is above the landscape horizon, i.e. not covered by the opaque part of the landscape.
+	//! @param azalt normalized direction in alt-az frame
+	bool isAboveHorizon(const Vec3d& azalt) const { return getOpacity(azalt)<0.5f; }
 	//! The list of azimuths (counted from True North towards East) and altitudes can come in various formats. We read the first two elements, which can be of formats:
 	enum horizonListMode {
 		azDeg_altDeg   = 0, //! azimuth[degrees] altitude[degrees]
@@ -181,7 +208,7 @@ public:
 		azGrad_zdGrad  = 5  //! azimuth[new_degrees] zenithDistance[new_degrees] (may be found on theodolites)
 	};
 	
-	//! Load descriptive labels from optional file gazetteer.LANG.utf8.
+	//! Load descriptive labels from optional file gazetteer.LANG.utf8, LANG being the language of the label settings.
 	void loadLabels(const QString& landscapeId);
 
 protected:
@@ -207,6 +234,20 @@ protected:
 	//! @param landscapeId The landscape ID (directory name) to which the texture belongs
 	//! @exception misc possibility of throwing "file not found" exceptions
 	const QString getTexturePath(const QString& basename, const QString& landscapeId) const;
+
+	//! Create the signature identifying a horizon profile in the disk cache.
+	//! @param sourceFiles the image files the profile is sampled from. Their size and modification time are part of the signature.
+	//! @param parameters the geometry parameters which change the mapping of the images to the horizon.
+	QByteArray getHorizonProfileSignature(const QStringList& sourceFiles, const QString& parameters) const;
+
+	//! Start decoding a landscape texture in a background thread. The OpenGL upload is done later by uploadTextures().
+	//! This can be called from the thread loading the landscape.
+	//! @param path the full path of the texture file
+	//! @param params the texture parameters
+	StelTextureSP createLandscapeTexture(const QString& path, const StelTexture::StelTextureParams& params=StelTexture::StelTextureParams());
+	//! Return the OpenGL memory used by the textures created with createLandscapeTexture(), in bytes.
+	unsigned int getTextureMemorySize() const;
+
 	float radius;
 	QString name;          //! Read from landscape.ini:[landscape]name
 	QString author;        //! Read from landscape.ini:[landscape]author
@@ -242,10 +283,16 @@ protected:
 					   //! For LandscapePolygonal, this is the only horizon data item.
 	Vec3f horizonPolygonLineColor;     //! for all horizon types, the horizonPolygon line, if specified, will be drawn in this color
 					   //! specified in landscape.ini[landscape]horizon_line_color. Negative red (default) indicated "don't draw".
+	//! Horizon altitude profile and opacity mask sampled from the panorama of photo landscapes without horizon polygon.
+	//! Answers getOpacity() so that the images need not be kept in memory.
+	LandscapeHorizonProfile horizonProfile;
+	//! All textures created with createLandscapeTexture(), used to track the loading state.
+	QList<StelTextureSP> landscapeTextures;
 	// Optional element: labels for landscape features.
 	QList<LandscapeLabel> landscapeLabels;
 	int fontSize;     //! Used for landscape labels (optionally indicating landscape features)
 	Vec3f labelColor; //! Color for the landscape labels.
+	QString labelLanguage; //! Language of the labels, see loadLabels()
 };
 
 //! @class LandscapeOldStyle
@@ -269,7 +316,7 @@ public:
 	LandscapeOldStyle(float radius = 2.f);
 	virtual ~LandscapeOldStyle();
 	virtual void load(const QSettings& landscapeIni, const QString& landscapeId);
-	virtual unsigned int getMemorySize() const {return memorySize;}
+	virtual unsigned int getMemorySize() const {return memorySize+getTextureMemorySize();}
 	virtual void draw(StelCore* core);
 	//void create(bool _fullpath, QMap<QString, QString> param); // still not implemented
 	virtual float getOpacity(Vec3d azalt) const;
@@ -286,6 +333,14 @@ private:
 	// drawLight==true for illumination layer, it then selects only the self-illuminating panels.
 	void drawDecor(StelCore* core, StelPainter&, const bool drawLight=false) const;
 	void drawGround(StelCore* core, StelPainter&) const;
+	//! Sample the side images for opacity. Used to build the horizon profile.
+	float sampleImageOpacity(const QVector<QImage>& sidesImages, Vec3d azalt) const;
+	struct ImageSampler
+	{
+		const LandscapeOldStyle* landscape;
+		const QVector<QImage>* images;
+		float operator()(const Vec3d& azalt) const { return landscape->sampleImageOpacity(*images, azalt); }
+	};
 	QVector<double> groundVertexArr;
 	QVector<float> groundTexCoordArr;
 	StelTextureSP* sideTexs;
@@ -294,7 +349,6 @@ private:
 	landscapeTexCoord* sides;
 	StelTextureSP fogTex;
 	StelTextureSP groundTex;
-	QVector<QImage*> sidesImages; // Required for opacity lookup
 	int nbDecorRepeat;
 	float fogAltAngle;
 	float fogAngleShift;
@@ -351,7 +405,7 @@ public:
 	LandscapeFisheye(float radius = 1.f);
 	virtual ~LandscapeFisheye();
 	virtual void load(const QSettings& landscapeIni, const QString& landscapeId);
-	virtual unsigned int getMemorySize() const {return memorySize;}
+	virtual unsigned int getMemorySize() const {return memorySize+getTextureMemorySize();}
 	virtual void draw(StelCore* core);
 	//! Sample landscape texture for transparency/opacity. May be used for visibility, sunrise etc.
 	//! @param azalt normalized direction in alt-az frame
@@ -365,13 +419,20 @@ public:
 	void create(const QString name, const QString& maptex, float texturefov, float angleRotateZ);
 	void create(const QString name, float texturefov, const QString& maptex, const QString &_maptexFog="", const QString& _maptexIllum="", const float angleRotateZ=0.0f);
 private:
+	//! Sample the fisheye image for opacity. Used to build the horizon profile.
+	float sampleImageOpacity(const QImage& mapImage, Vec3d azalt) const;
+	struct ImageSampler
+	{
+		const LandscapeFisheye* landscape;
+		const QImage* image;
+		float operator()(const Vec3d& azalt) const { return landscape->sampleImageOpacity(*image, azalt); }
+	};
 
 	StelTextureSP mapTex;      //!< The fisheye image, centered on the zenith.
 	StelTextureSP mapTexFog;   //!< Optional panorama of identical size (create as layer over the mapTex image in your favorite image processor).
 				   //!< can also be smaller, just the texture is again mapped onto the same geometry.
 	StelTextureSP mapTexIllum; //!< Optional fisheye image of identical size (create as layer in your favorite image processor) or at least, proportions.
 				   //!< To simulate light pollution (skyglow), street lights, light in windows, ... at night
-	QImage *mapImage;          //!< The same image as mapTex, but stored in-mem for sampling.
 
 	float texFov;
 	unsigned int memorySize;
@@ -393,7 +454,7 @@ public:
 	LandscapeSpherical(float radius = 1.f);
 	virtual ~LandscapeSpherical();
 	virtual void load(const QSettings& landscapeIni, const QString& landscapeId);
-	virtual unsigned int getMemorySize() const {return memorySize;}
+	virtual unsigned int getMemorySize() const {return memorySize+getTextureMemorySize();}
 	virtual void draw(StelCore* core);
 	//! Sample landscape texture for transparency/opacity. May be used for visibility, sunrise etc.
 	//! @param azalt normalized direction in alt-az frame
@@ -415,6 +476,14 @@ public:
 				const float _fogTexTop=90.0f, const float _fogTexBottom=-90.0f,
 				const float _illumTexTop=90.0f, const float _illumTexBottom=-90.0f);
 private:
+	//! Sample the panorama image for opacity. Used to build the horizon profile.
+	float sampleImageOpacity(const QImage& mapImage, Vec3d azalt) const;
+	struct ImageSampler
+	{
+		const LandscapeSpherical* landscape;
+		const QImage* image;
+		float operator()(const Vec3d& azalt) const { return landscape->sampleImageOpacity(*image, azalt); }
+	};
 
 	StelTextureSP mapTex;      //!< The equirectangular panorama texture
 	StelTextureSP mapTexFog;   //!< Optional panorama of identical size (create as layer over the mapTex image in your favorite image processor).
@@ -429,7 +498,6 @@ private:
 	float fogTexBottom;	   //!< zenithal bottom angle of the fog texture, radians
 	float illumTexTop;	   //!< zenithal top angle of the illumination texture, radians
 	float illumTexBottom;	   //!< zenithal bottom angle of the illumination texture, radians
-	QImage *mapImage;          //!< The same image as mapTex, but stored in-mem for opacity sampling.
 	unsigned int memorySize;   //!< holds an approximate value of memory consumption (for cache cost estimate)
 };
 
@@ -0,0 +1,127 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "LandscapeHorizonProfile.hpp"
+#include "StelFileMgr.hpp"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#include <stdexcept>
+
+// Magic number and version of the cache file format
+static const quint32 HORIZON_PROFILE_MAGIC = 0x53484f52; // "SHOR"
+static const quint32 HORIZON_PROFILE_VERSION = 1;
+
+const int LandscapeHorizonProfile::AZIMUTH_BINS;
+const int LandscapeHorizonProfile::MASK_WIDTH;
+const int LandscapeHorizonProfile::MASK_HEIGHT;
+
+LandscapeHorizonProfile::LandscapeHorizonProfile()
+{
+}
+
+void LandscapeHorizonProfile::clear()
+{
+	horizonAltitudes.clear();
+	mask.clear();
+}
+
+QString LandscapeHorizonProfile::getCacheFilePath(const QString& landscapeId)
+{
+	return StelFileMgr::getCacheDir() + "/landscapes/" + landscapeId + ".horizon";
+}
+
+bool LandscapeHorizonProfile::loadFromCache(const QString& landscapeId, const QByteArray& signature)
+{
+	QFile file(getCacheFilePath(landscapeId));
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_2);
+	quint32 magic, version;
+	QByteArray fileSignature;
+	in >> magic >> version >> fileSignature;
+	if (magic!=HORIZON_PROFILE_MAGIC || version!=HORIZON_PROFILE_VERSION || fileSignature!=signature)
+		return false;
+
+	QVector<float> altitudes;
+	QByteArray fileMask;
+	in >> altitudes >> fileMask;
+	if (in.status()!=QDataStream::Ok || altitudes.size()!=AZIMUTH_BINS || (!fileMask.isEmpty() && fileMask.size()!=MASK_WIDTH*MASK_HEIGHT))
+	{
+		qWarning() << "Ignoring invalid horizon profile cache" << QDir::toNativeSeparators(file.fileName());
+		return false;
+	}
+	horizonAltitudes=altitudes;
+	mask=fileMask;
+	return true;
+}
+
+bool LandscapeHorizonProfile::saveToCache(const QString& landscapeId, const QByteArray& signature) const
+{
+	if (!isValid())
+		return false;
+
+	const QString path=getCacheFilePath(landscapeId);
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(StelFileMgr::dirName(path));
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot store horizon profile for landscape" << landscapeId << ":" << e.what();
+		return false;
+	}
+
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Cannot store horizon profile" << QDir::toNativeSeparators(path);
+		return false;
+	}
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_2);
+	out << HORIZON_PROFILE_MAGIC << HORIZON_PROFILE_VERSION << signature << horizonAltitudes << mask;
+	return out.status()==QDataStream::Ok;
+}
+
+float LandscapeHorizonProfile::getOpacity(const Vec3d& azalt) const
+{
+	Q_ASSERT(isValid());
+	double az, alt;
+	StelUtils::rectToSphe(&az, &alt, azalt);
+	const float horizon=horizonAltitudes.at(azimuthBin(az));
+
+	if (!mask.isEmpty())
+	{
+		const int y=qBound(0, (int)std::floor((alt+M_PI_2)*(MASK_HEIGHT/M_PI)), MASK_HEIGHT-1);
+		const double altLow=-M_PI_2+y*M_PI/MASK_HEIGHT;
+		// Away from the horizon line the mask knows better than the profile.
+		if (horizon<=altLow || horizon>=altLow+M_PI/MASK_HEIGHT)
+		{
+			const int x=qBound(0, (int)std::floor((az+M_PI)*(MASK_WIDTH/(2.*M_PI))), MASK_WIDTH-1);
+			return ((unsigned char)mask.at(y*MASK_WIDTH+x))/255.0f;
+		}
+	}
+	return (alt<horizon ? 1.0f : 0.0f);
+}
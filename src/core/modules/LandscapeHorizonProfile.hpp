@@ -0,0 +1,163 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _LANDSCAPEHORIZONPROFILE_HPP_
+#define _LANDSCAPEHORIZONPROFILE_HPP_
+
+#include "VecMath.hpp"
+#include "StelUtils.hpp"
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+//! @class LandscapeHorizonProfile
+//! A compact description of a photo landscape horizon, derived once from the full resolution panorama.
+//! It consists of
+//!  - the horizon altitude for each azimuth bin, i.e. the highest altitude where the landscape is opaque,
+//!  - an optional low resolution opacity mask (azimuth x altitude), which is only kept if the landscape
+//!    cannot be described by the altitude profile alone (semi-transparent trees, holes in the ground,
+//!    overhanging structures...).
+//! Opacity queries cost one rectToSphe() and a table lookup, so that the full size QImage which was
+//! previously kept in RAM only for sampling can be released after the profile has been built.
+//! Profiles are stored in the cache directory and are rebuilt when the signature (source image files
+//! and geometry parameters of the landscape) changes.
+//! All azimuths are given in the internal (mathematical) sense as returned by StelUtils::rectToSphe().
+class LandscapeHorizonProfile
+{
+public:
+	LandscapeHorizonProfile();
+
+	//! Number of azimuth bins of the altitude profile (0.25 degrees resolution).
+	static const int AZIMUTH_BINS = 1440;
+	//! Size of the opacity mask, which covers all azimuths and altitudes -90..+90 degrees at 0.5 degrees resolution.
+	static const int MASK_WIDTH = 720;
+	static const int MASK_HEIGHT = 360;
+
+	//! Return true if the profile has been built or loaded.
+	bool isValid() const {return !horizonAltitudes.isEmpty();}
+	//! Return true if the optional opacity mask is in use.
+	bool hasMask() const {return !mask.isEmpty();}
+	//! Drop all data.
+	void clear();
+
+	//! Build the profile by sampling the original landscape.
+	//! @param sampler a functor returning the opacity (0..1) for a normalized direction in the landscape's alt-az frame:
+	//!        float operator()(const Vec3d& azalt) const
+	template<class Sampler> void build(const Sampler& sampler);
+
+	//! Try to load a profile with the given signature from the disk cache.
+	//! @return false if there is no cached profile or it was built from different sources.
+	bool loadFromCache(const QString& landscapeId, const QByteArray& signature);
+	//! Store the profile in the disk cache, tagged with the given signature.
+	bool saveToCache(const QString& landscapeId, const QByteArray& signature) const;
+
+	//! Return the opacity (0=free sky, 1=fully opaque) in the given direction.
+	//! @param azalt normalized direction in the landscape's alt-az frame.
+	float getOpacity(const Vec3d& azalt) const;
+	//! Return whether the given direction is above the landscape horizon.
+	bool isAboveHorizon(const Vec3d& azalt) const {return getOpacity(azalt)<0.5f;}
+	//! Return the altitude of the horizon (radians) for the given internal azimuth (radians).
+	float getHorizonAltitude(float az) const {return horizonAltitudes.at(azimuthBin(az));}
+
+	//! Return approximate memory footprint in bytes
+	unsigned int getMemorySize() const {return sizeof(LandscapeHorizonProfile)+horizonAltitudes.size()*sizeof(float)+mask.size();}
+
+private:
+	static int azimuthBin(float az)
+	{
+		// az is in -pi..pi
+		int bin=(int)std::floor((az+M_PI)*(AZIMUTH_BINS/(2.*M_PI)));
+		return qBound(0, bin, AZIMUTH_BINS-1);
+	}
+	static QString getCacheFilePath(const QString& landscapeId);
+
+	//! Horizon altitude per azimuth bin, radians
+	QVector<float> horizonAltitudes;
+	//! Optional opacity mask, MASK_WIDTH*MASK_HEIGHT bytes (0..255), row 0 at altitude -90 degrees.
+	QByteArray mask;
+};
+
+template<class Sampler> void LandscapeHorizonProfile::build(const Sampler& sampler)
+{
+	clear();
+	horizonAltitudes.resize(AZIMUTH_BINS);
+	Vec3d dir;
+
+	// Altitude profile: walk down from the zenith in coarse steps until the first opaque sample,
+	// then refine between the last transparent and the first opaque altitude by bisection.
+	const double coarseStep=0.5*M_PI/180.;
+	for (int i=0; i<AZIMUTH_BINS; ++i)
+	{
+		const double az=-M_PI+(i+0.5)*2.*M_PI/AZIMUTH_BINS;
+		double upper=M_PI_2;
+		double lower=-M_PI_2;
+		for (double alt=M_PI_2-coarseStep; alt>-M_PI_2; alt-=coarseStep)
+		{
+			StelUtils::spheToRect(az, alt, dir);
+			if (sampler(dir)>=0.5f)
+			{
+				lower=alt;
+				break;
+			}
+			upper=alt;
+		}
+		for (int j=0; j<10; ++j)
+		{
+			const double mid=0.5*(upper+lower);
+			StelUtils::spheToRect(az, mid, dir);
+			if (sampler(dir)>=0.5f)
+				lower=mid;
+			else
+				upper=mid;
+		}
+		horizonAltitudes[i]=(float)(0.5*(upper+lower));
+	}
+
+	// Opacity mask: only needed where the samples disagree with the binary altitude profile.
+	QByteArray grid(MASK_WIDTH*MASK_HEIGHT, 0);
+	bool needMask=false;
+	for (int y=0; y<MASK_HEIGHT; ++y)
+	{
+		const double alt=-M_PI_2+(y+0.5)*M_PI/MASK_HEIGHT;
+		const double altLow=-M_PI_2+y*M_PI/MASK_HEIGHT;
+		const double altHigh=altLow+M_PI/MASK_HEIGHT;
+		for (int x=0; x<MASK_WIDTH; ++x)
+		{
+			const double az=-M_PI+(x+0.5)*2.*M_PI/MASK_WIDTH;
+			StelUtils::spheToRect(az, alt, dir);
+			const float opacity=qBound(0.f, sampler(dir), 1.f);
+			const unsigned char value=(unsigned char)(opacity*255.f+0.5f);
+			grid[y*MASK_WIDTH+x]=(char)value;
+			if (needMask)
+				continue;
+			// Cells crossed by the horizon line are decided by the altitude profile.
+			const float horizon=horizonAltitudes.at(azimuthBin(az));
+			if (horizon>altLow && horizon<altHigh)
+				continue;
+			const unsigned char expected=(alt<horizon) ? 255 : 0;
+			if (qAbs((int)value-(int)expected)>12)
+				needMask=true;
+		}
+	}
+	if (needMask)
+		mask=grid;
+}
+
+#endif // _LANDSCAPEHORIZONPROFILE_HPP_
@@ -34,6 +34,7 @@
 #include "StelIniParser.hpp"
 #include "StelSkyDrawer.hpp"
 #include "StelPainter.hpp"
+#include "StelProfiler.hpp"
 #include "qzipreader.h"
 
 #include <QDebug>
@@ -44,6 +45,7 @@
 #include <QFile>
 #include <QTemporaryFile>
 #include <QMouseEvent>
+#include <QtConcurrent>
 
 #include <stdexcept>
 
@@ -154,6 +156,9 @@ LandscapeMgr::LandscapeMgr()
 	, defaultMinimalBrightness(0.01)
 	, flagLandscapeSetsMinimalBrightness(false)
 	, flagAtmosphereAutoEnabling(false)
+	, flagAsyncLoading(true)
+	, textureUploadsPerFrame(1)
+	, pendingChangeLocationDuration(1.0)
 {
 	setObjectName("LandscapeMgr"); // should be done by StelModule's constructor.
 
@@ -180,6 +185,14 @@ LandscapeMgr::~LandscapeMgr()
 	}
 	delete landscape;
 	landscape = Q_NULLPTR;
+	foreach (QFuture<Landscape*> loader, landscapeLoaders)
+	{
+		loader.waitForFinished();
+		delete loader.result();
+	}
+	landscapeLoaders.clear();
+	qDeleteAll(landscapeUploads);
+	landscapeUploads.clear();
 	qDebug() << "LandscapeMgr: Clearing cache of" << landscapeCache.size() << "landscapes totalling about " << landscapeCache.totalCost() << "MB.";
 	landscapeCache.clear(); // deletes all objects within.
 }
@@ -203,6 +216,9 @@ void LandscapeMgr::update(double deltaTime)
 {
 	atmosphere->update(deltaTime);
 
+	if (isLandscapeLoading())
+		updateLandscapeLoaders();
+
 	if (oldLandscape)
 	{
 		// This is only when transitioning to newly loaded landscape. We must draw the old one until the new one is faded in completely.
@@ -241,6 +257,7 @@ void LandscapeMgr::update(double deltaTime)
 		lunarPhaseAngle=0.0f;
 	}
 	// GZ: First parameter in next call is used for particularly earth-bound computations in Schaefer's sky brightness model. Difference DeltaT makes no difference here.
+	STEL_PROFILE_ZONE("Atmosphere.computeColor");
 	atmosphere->computeColor(core->getJDE(), sunPos, moonPos, lunarPhaseAngle, lunarMagnitude,
 		core, core->getCurrentLocation().latitude, core->getCurrentLocation().altitude,
 		15.f, 40.f);	// Temperature = 15c, relative humidity = 40%
@@ -367,7 +384,10 @@ void LandscapeMgr::update(double deltaTime)
 void LandscapeMgr::draw(StelCore* core)
 {
 	// Draw the atmosphere
-	atmosphere->draw(core);
+	{
+		STEL_PROFILE_ZONE("Atmosphere.draw");
+		atmosphere->draw(core);
+	}
 
 	// Draw the landscape
 	if (oldLandscape)
@@ -385,6 +405,8 @@ void LandscapeMgr::init()
 
 	landscapeCache.setMaxCost(conf->value("landscape/cache_size_mb", 100).toInt());
 	qDebug() << "LandscapeMgr: initialized Cache for" << landscapeCache.maxCost() << "MB.";
+	flagAsyncLoading = conf->value("landscape/flag_async_loading", true).toBool();
+	textureUploadsPerFrame = qMax(1, conf->value("landscape/texture_uploads_per_frame", 1).toInt());
 
 	atmosphere = new Atmosphere();
 	defaultLandscapeID = conf->value("init_location/landscape_name").toString();
@@ -436,7 +458,11 @@ bool LandscapeMgr::setCurrentLandscapeID(const QString& id, const double changeL
 
 	//prevent unnecessary changes/file access
 	if(id==currentLandscapeID)
+	{
+		// switching back while another landscape is still loading: keep the current one
+		pendingLandscapeID.clear();
 		return false;
+	}
 
 	Landscape* newLandscape;
 
@@ -458,12 +484,25 @@ bool LandscapeMgr::setCurrentLandscapeID(const QString& id, const double changeL
 			qDebug() << ".-->LandscapeMgr::setCurrentLandscapeID(): cache contains " << landscapeCache.size() << "landscapes totalling about " << landscapeCache.totalCost() << "MB.";
 #endif
 		}
+		else if (flagAsyncLoading && landscape)
+		{
+			// Load in the background and keep showing the current landscape until the new one is ready.
+			// At startup (no landscape yet) we must load synchronously.
+			if (!landscapeLoaders.contains(id) && !landscapeUploads.contains(id) && !startLandscapeLoader(id))
+				return false;
+#ifndef NDEBUG
+			qDebug() << "LandscapeMgr::setCurrentLandscapeID: Loading in background:" << id ;
+#endif
+			pendingLandscapeID = id;
+			pendingChangeLocationDuration = changeLocationDuration;
+			return true;
+		}
 		else
 		{
 #ifndef NDEBUG
 			qDebug() << "LandscapeMgr::setCurrentLandscapeID: Loading from file:" << id ;
 #endif
-			newLandscape = createFromFile(StelFileMgr::findFile("landscapes/" + id + "/landscape.ini"), id);
+			newLandscape = loadLandscapeNow(id);
 		}
 
 		if (!newLandscape)
@@ -473,6 +512,13 @@ bool LandscapeMgr::setCurrentLandscapeID(const QString& id, const double changeL
 		}
 	}
 
+	pendingLandscapeID.clear();
+	activateLandscape(newLandscape, changeLocationDuration);
+	return true;
+}
+
+void LandscapeMgr::activateLandscape(Landscape* newLandscape, const double changeLocationDuration)
+{
 	// Keep current landscape for a while, while new landscape fades in!
 	// This prevents subhorizon sun or grid becoming briefly visible.
 	if (landscape)
@@ -497,7 +543,7 @@ bool LandscapeMgr::setCurrentLandscapeID(const QString& id, const double changeL
 		oldLandscape = landscape; // keep old while transitioning!
 	}
 	landscape=newLandscape;
-	currentLandscapeID = id;
+	currentLandscapeID = newLandscape->getId();
 
 	if (getFlagLandscapeSetsLocation() && landscape->hasLocation())
 	{
@@ -539,7 +585,6 @@ bool LandscapeMgr::setCurrentLandscapeID(const QString& id, const double changeL
 	emit currentLandscapeChanged(currentLandscapeID,getCurrentLandscapeName());
 
 	// else qDebug() << "Will not set new location; Landscape location: planet: " << landscape->getLocation().planetName << "name: " << landscape->getLocation().name;
-	return true;
 }
 
 bool LandscapeMgr::setCurrentLandscapeName(const QString& name, const double changeLocationDuration)
@@ -568,7 +613,7 @@ bool LandscapeMgr::precacheLandscape(const QString& id, const bool replace)
 	if (landscapeCache.contains(id) && (!replace))
 		return false;
 
-	Landscape* newLandscape = createFromFile(StelFileMgr::findFile("landscapes/" + id + "/landscape.ini"), id);
+	Landscape* newLandscape = loadLandscapeNow(id);
 	if (!newLandscape)
 	{
 		qWarning() << "ERROR while preloading landscape " << "landscapes/" + id + "/landscape.ini";
@@ -586,6 +631,113 @@ bool LandscapeMgr::precacheLandscape(const QString& id, const bool replace)
 	return res;
 }
 
+bool LandscapeMgr::preloadLandscape(const QString& id)
+{
+	if (id.isEmpty() || id==currentLandscapeID || landscapeCache.contains(id) || landscapeLoaders.contains(id) || landscapeUploads.contains(id))
+		return false;
+	if (oldLandscape && oldLandscape->getId()==id)
+		return false;
+
+	if (!flagAsyncLoading)
+		return precacheLandscape(id, false);
+	return startLandscapeLoader(id);
+}
+
+bool LandscapeMgr::isLandscapeReady(const QString& id) const
+{
+	return id==currentLandscapeID || landscapeCache.contains(id) || (oldLandscape && oldLandscape->getId()==id);
+}
+
+bool LandscapeMgr::startLandscapeLoader(const QString& id)
+{
+	const QString landscapeFile = StelFileMgr::findFile("landscapes/" + id + "/landscape.ini");
+	if (landscapeFile.isEmpty())
+	{
+		qWarning() << "ERROR while loading landscape " << "landscapes/" + id + "/landscape.ini";
+		return false;
+	}
+	// Parsing, horizon sampling and texture decoding run in the worker, the GL upload is done in updateLandscapeLoaders().
+	// The worker must not read the application settings, they are read now.
+	landscapeLoaders.insert(id, QtConcurrent::run(this, &LandscapeMgr::createFromFile, landscapeFile, id, getLabelSettings()));
+	return true;
+}
+
+Landscape::LabelSettings LandscapeMgr::getLabelSettings() const
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	Landscape::LabelSettings settings;
+	settings.color = StelUtils::strToVec3f(conf->value("landscape/label_color", "0.2,0.8,0.2").toString());
+	settings.fontSize = conf->value("landscape/label_font_size", 15).toInt();
+	settings.language = StelApp::getInstance().getLocaleMgr().getAppLanguage();
+	return settings;
+}
+
+Landscape* LandscapeMgr::loadLandscapeNow(const QString& id)
+{
+	Landscape* newLandscape;
+	if (landscapeLoaders.contains(id))
+		newLandscape = landscapeLoaders.take(id).result(); // blocks until the worker has finished
+	else if (landscapeUploads.contains(id))
+		newLandscape = landscapeUploads.take(id);
+	else
+		newLandscape = createFromFile(StelFileMgr::findFile("landscapes/" + id + "/landscape.ini"), id, getLabelSettings());
+
+	if (newLandscape)
+	{
+		newLandscape->waitForTextures();
+		newLandscape->uploadTextures();
+	}
+	return newLandscape;
+}
+
+void LandscapeMgr::updateLandscapeLoaders()
+{
+	QMutableMapIterator<QString, QFuture<Landscape*> > it(landscapeLoaders);
+	while (it.hasNext())
+	{
+		it.next();
+		if (!it.value().isFinished())
+			continue;
+		Landscape* newLandscape = it.value().result();
+		if (newLandscape)
+			landscapeUploads.insert(it.key(), newLandscape);
+		else if (it.key()==pendingLandscapeID)
+			pendingLandscapeID.clear();
+		it.remove();
+	}
+	if (landscapeUploads.isEmpty())
+		return;
+
+	// Upload only a few textures per frame to avoid stalls. The landscape which has been requested goes first.
+	StelApp::getInstance().ensureGLContextCurrent();
+	QStringList ids = landscapeUploads.keys();
+	if (ids.removeOne(pendingLandscapeID))
+		ids.prepend(pendingLandscapeID);
+	int uploads = textureUploadsPerFrame;
+	foreach (const QString& id, ids)
+	{
+		Landscape* newLandscape = landscapeUploads.value(id);
+		if (uploads>0)
+			uploads -= newLandscape->uploadTextures(uploads);
+		if (!newLandscape->isReady())
+			continue;
+
+		landscapeUploads.remove(id);
+		if (id==pendingLandscapeID)
+		{
+			pendingLandscapeID.clear();
+			activateLandscape(newLandscape, pendingChangeLocationDuration);
+		}
+		else
+		{
+			landscapeCache.insert(id, newLandscape, newLandscape->getMemorySize()/(1024*1024)+1);
+#ifndef NDEBUG
+			qDebug() << "LandscapeMgr::updateLandscapeLoaders(): cache contains " << landscapeCache.size() << "landscapes totalling about " << landscapeCache.totalCost() << "MB.";
+#endif
+		}
+	}
+}
+
 // Remove a landscape from the cache of loaded landscapes.
 // @param id the ID of a landscape
 // @return false if landscape could not be found
@@ -615,6 +767,7 @@ void LandscapeMgr::updateI18n()
 {
 	// Translate all labels with the new language
 	if (cardinalsPoints) cardinalsPoints->updateI18n();
+	landscape->setLabelSettings(getLabelSettings());
 	landscape->loadLabels(getCurrentLandscapeID());
 }
 
@@ -949,7 +1102,7 @@ void LandscapeMgr::setAtmosphereAverageLuminance(const float overrideLum)
 	atmosphere->setAverageLuminance(overrideLum);
 }
 
-Landscape* LandscapeMgr::createFromFile(const QString& landscapeFile, const QString& landscapeId)
+Landscape* LandscapeMgr::createFromFile(const QString& landscapeFile, const QString& landscapeId, const Landscape::LabelSettings& labelSettings)
 {
 	QSettings landscapeIni(landscapeFile, StelIniFormat);
 	QString s;
@@ -979,9 +1132,8 @@ Landscape* LandscapeMgr::createFromFile(const QString& landscapeFile, const QStr
 		landscape = new LandscapeFisheye();
 	}
 
+	landscape->setLabelSettings(labelSettings);
 	landscape->load(landscapeIni, landscapeId);
-	QSettings *conf=StelApp::getInstance().getSettings();
-	landscape->setLabelFontSize(conf->value("landscape/label_font_size", 15).toInt());
 	return landscape;
 }
 
@@ -29,6 +29,7 @@
 #include <QMap>
 #include <QStringList>
 #include <QCache>
+#include <QFuture>
 
 class Atmosphere;
 class Cardinals;
@@ -154,8 +155,12 @@ public:
 	//! @param landscapeFile This is the path to a landscape.ini file.
 	//! @param landscapeId This is the landscape ID, which is also the name of the
 	//! directory in which the files (textures and so on) for the landscape reside.
+	//! @param labelSettings The settings of the labels, see getLabelSettings().
 	//! @return A pointer to the newly created landscape object.
-	Landscape* createFromFile(const QString& landscapeFile, const QString& landscapeId);
+	//! @note This does not call OpenGL nor read the application settings and can run in a worker thread.
+	//! The textures are only decoded, Landscape::uploadTextures() must be called from the main thread
+	//! before the landscape is drawn.
+	Landscape* createFromFile(const QString& landscapeFile, const QString& landscapeId, const Landscape::LabelSettings& labelSettings);
 
 	// GZ: implement StelModule's method. For test purposes only, we implement a manual transparency sampler.
 	// TODO: comment this away for final builds. Please leave it in until this feature is finished.
@@ -204,6 +209,9 @@ public slots:
 	//! @param id the ID of the new landscape
 	//! @param changeLocationDuration the duration of the transition animation
 	//! @return false if the new landscape could not be set (e.g. no landscape of that ID was found).
+	//! @note If the landscape is neither current nor cached and asynchronous loading is enabled ([landscape/flag_async_loading]),
+	//! it is loaded in the background and the transition only starts when it is ready. In this case, true is returned
+	//! immediately and currentLandscapeChanged() is emitted later.
 	bool setCurrentLandscapeID(const QString& id, const double changeLocationDuration = 1.0);
 	
 	//! Get the current landscape name.
@@ -223,6 +231,16 @@ public slots:
 	//! @param replace true if existing landscape entry should be replaced (useful during development to reload after edit)
 	//! @return false if landscape could not be found, or if it already existed in cache and replace was false.
 	bool precacheLandscape(const QString& id, const bool replace=true);
+	//! Start loading a landscape into cache in the background, without blocking the program.
+	//! Use this (e.g. from a script or the RemoteControl plugin) ahead of a landscape change during a show.
+	//! Falls back to precacheLandscape() if asynchronous loading is disabled.
+	//! @param id the ID of a landscape
+	//! @return false if landscape could not be found, or is current, already cached or already loading.
+	bool preloadLandscape(const QString& id);
+	//! Return true while landscapes are being loaded in the background.
+	bool isLandscapeLoading() const {return !landscapeLoaders.isEmpty() || !landscapeUploads.isEmpty();}
+	//! Return true if the landscape with the given ID can be shown without loading, i.e. it is current or cached.
+	bool isLandscapeReady(const QString& id) const;
 	//! Remove a landscape from the cache of landscapes.
 	//! @param id the ID of a landscape
 	//! @return false if landscape could not be found
@@ -515,6 +533,20 @@ private:
 	//! @returns an empty string, if no such landscape was found.
 	QString getLandscapePath(const QString landscapeID) const;
 
+	//! Read the settings of the landscape labels from the application settings, in the main thread.
+	Landscape::LabelSettings getLabelSettings() const;
+	//! Start creating the landscape with the given ID in a worker thread.
+	//! @return false if there is no landscape with that ID.
+	bool startLandscapeLoader(const QString& id);
+	//! Poll the background loaders, upload a limited number of decoded textures per frame, and
+	//! activate or cache the landscapes which are ready. Called from update().
+	void updateLandscapeLoaders();
+	//! Return the landscape with the given ID, finishing its background loading or loading it synchronously.
+	//! All textures are uploaded on return.
+	Landscape* loadLandscapeNow(const QString& id);
+	//! Make a fully loaded landscape the current one and start the transition from the previous one.
+	void activateLandscape(Landscape* newLandscape, const double changeLocationDuration);
+
 	Atmosphere* atmosphere;			// Atmosphere
 	Cardinals* cardinalsPoints;		// Cardinals points
 	Landscape* landscape;			// The landscape i.e. the fog, the ground and "decor"
@@ -554,6 +586,21 @@ private:
 	//! at system start (e.g. in the startup.ssc script) and then retrieved while script is running.
 	//! The key is just the LandscapeID.
 	QCache<QString,Landscape> landscapeCache;
+
+	//! Load landscapes which are not cached in worker threads instead of blocking the main thread.
+	//! Configured as [landscape/flag_async_loading].
+	bool flagAsyncLoading;
+	//! Maximum number of landscape textures uploaded to OpenGL per frame while loading in the background.
+	//! Configured as [landscape/texture_uploads_per_frame].
+	int textureUploadsPerFrame;
+	//! Landscapes being created in worker threads. The key is the LandscapeID.
+	QMap<QString, QFuture<Landscape*> > landscapeLoaders;
+	//! Landscapes which have been created and wait for their textures to be decoded and uploaded. The key is the LandscapeID.
+	QMap<QString, Landscape*> landscapeUploads;
+	//! ID of a landscape which is being loaded and becomes current when ready. Empty if there is none.
+	QString pendingLandscapeID;
+	//! Transition duration passed to setCurrentLandscapeID() for pendingLandscapeID.
+	double pendingChangeLocationDuration;
 };
 
 #endif // _LANDSCAPEMGR_HPP_
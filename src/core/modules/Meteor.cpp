@@ -19,14 +19,12 @@
 
 #include "Meteor.hpp"
 #include "StelCore.hpp"
-#include "StelMovementMgr.hpp"
-#include "StelPainter.hpp"
-#include "StelTexture.hpp"
+#include "StelSkyDrawer.hpp"
 #include "StelUtils.hpp"
 
 #include <QtMath>
 
-Meteor::Meteor(const StelCore* core, const StelTextureSP& bolideTexture)
+Meteor::Meteor(const StelCore* core)
 	: m_core(core)
 	, m_alive(false)
 	, m_speed(72.)
@@ -35,16 +33,11 @@ Meteor::Meteor(const StelCore* core, const StelTextureSP& bolideTexture)
 	, m_minDist(1.)
 	, m_absMag(.5)
 	, m_aptMag(.5)
-	, m_bolideTexture(bolideTexture)
-	, m_segments(10)
 {
 }
 
 Meteor::~Meteor()
 {
-	m_bolideTexture.clear();
-	m_lineColorVector.clear();
-	m_trainColorVector.clear();
 }
 
 void Meteor::init(const float& radiantAlpha, const float& radiantDelta,
@@ -158,63 +151,6 @@ void Meteor::init(const float& radiantAlpha, const float& radiantDelta,
 	m_alive = true;
 }
 
-bool Meteor::update(double deltaTime)
-{
-	if (!m_alive)
-	{
-		return false;
-	}
-
-	if (!m_core->getRealTimeSpeed() || m_position[2] < m_finalZ)
-	{
-		// burning has stopped so magnitude fades out
-		// assume linear fade out
-		m_absMag -= deltaTime * 2.f;
-	}
-
-	// no longer visible
-	if(m_absMag <= 0.f)
-	{
-		m_alive = false;
-		return false;
-	}
-
-	m_position[2] -= m_speed * deltaTime;
-
-	// train doesn't extend beyond start of burn
-	if (m_position[2] + m_speed * 0.5f > m_initialZ)
-	{
-		m_posTrain[2] = m_initialZ;
-	}
-	else
-	{
-		m_posTrain[2] -= m_speed * deltaTime;
-	}
-
-	// update apparent magnitude based on distance to observer
-	float scale = qPow(m_minDist / m_position.length(), 2);
-	m_aptMag = m_absMag * qMin(scale, 1.f);
-	m_aptMag = qMax(m_aptMag, 0.f);
-
-	return true;
-}
-
-void Meteor::draw(const StelCore* core, StelPainter& sPainter)
-{
-	if (!m_alive)
-	{
-		return;
-	}
-
-	float thickness;
-	float bolideSize;
-	calculateThickness(core, thickness, bolideSize);
-
-	drawTrain(sPainter, thickness);
-
-	drawBolide(sPainter, bolideSize);
-}
-
 Vec4f Meteor::getColorFromName(QString colorName)
 {
 	int R, G, B; // 0-255
@@ -260,38 +196,31 @@ Vec4f Meteor::getColorFromName(QString colorName)
 
 void Meteor::buildColorVectors(const QList<ColorPair> colors)
 {
-	// building color arrays (line and prism)
+	// building color array
 	QList<Vec4f> lineColor;
-	QList<Vec4f> trainColor;
 	foreach (ColorPair color, colors)
 	{
 		// segments to be painted with the current color
-		int segs = qRound(m_segments * (color.second / 100.f)); // rounds to nearest integer
+		int segs = qRound(SEGMENTS * (color.second / 100.f)); // rounds to nearest integer
 		for (int s = 0; s < segs; ++s)
 		{
 			Vec4f rgba = getColorFromName(color.first);
 			lineColor.append(rgba);
-			trainColor.append(rgba);
-			trainColor.append(rgba);
 		}
 	}
 
 	// make sure that all segments have been painted!
 	const int segs = lineColor.size();
-	if (segs < m_segments) {
+	if (segs < SEGMENTS) {
 		// use the last color to paint the last segments
 		Vec4f rgba = getColorFromName(colors.last().first);
-		for (int s = segs; s < m_segments; ++s) {
+		for (int s = segs; s < SEGMENTS; ++s) {
 			lineColor.append(rgba);
-			trainColor.append(rgba);
-			trainColor.append(rgba);
 		}
-	} else if (segs > m_segments) {
+	} else if (segs > SEGMENTS) {
 		// remove the extra segments
-		for (int s = segs; s > m_segments; --s) {
+		for (int s = segs; s > SEGMENTS; --s) {
 			lineColor.removeLast();
-			trainColor.removeLast();
-			trainColor.removeLast();
 		}
 	}
 
@@ -304,17 +233,9 @@ void Meteor::buildColorVectors(const QList<ColorPair> colors)
 		lineColor.clear();
 		lineColor.append(lineColor1);
 		lineColor.append(lineColor2);
-
-		firstSegment *= 2;
-		QList<Vec4f> trainColor2 = trainColor.mid(0, firstSegment);
-		QList<Vec4f> trainColor1 = trainColor.mid(firstSegment);
-		trainColor.clear();
-		trainColor.append(trainColor1);
-		trainColor.append(trainColor2);
 	}
 
 	m_lineColorVector = lineColor.toVector();
-	m_trainColorVector = trainColor.toVector();
 }
 
 float Meteor::meteorZ(float zenithAngle, float altitude)
@@ -337,156 +258,3 @@ float Meteor::meteorZ(float zenithAngle, float altitude)
 
 	return distance;
 }
-
-Vec3d Meteor::altAzToRadiant(Vec3d position)
-{
-	position.transfo4d(m_matAltAzToRadiant.transpose());
-	position *= 1242;
-	return position;
-}
-
-Vec3d Meteor::radiantToAltAz(Vec3d position)
-{
-	position /= 1242.0; // 1242 to scale down under 1
-	position.transfo4d(m_matAltAzToRadiant);
-	return position;
-}
-
-void Meteor::calculateThickness(const StelCore* core, float& thickness, float& bolideSize)
-{
-	float maxFOV = core->getMovementMgr()->getMaxFov();
-	float FOV = core->getMovementMgr()->getCurrentFov();
-	thickness = 2*log(FOV + 0.25)/(1.2*maxFOV - (FOV + 0.25)) + 0.01;
-	if (FOV <= 0.5)
-	{
-		thickness = 0.013 * FOV; // decreasing faster
-	}
-	else if (FOV > 100.0)
-	{
-		thickness = 0; // remove prism
-	}
-
-	bolideSize = thickness*3;
-}
-
-void Meteor::drawBolide(StelPainter& sPainter, const float& bolideSize)
-{
-	if (!bolideSize || !m_bolideTexture)
-	{
-		return;
-	}
-
-	// bolide
-	//
-	QVector<Vec3d> vertexArrayBolide;
-	QVector<Vec4f> colorArrayBolide;
-	Vec4f bolideColor = Vec4f(1, 1, 1, m_aptMag);
-
-	Vec3d topLeft = m_position;
-	topLeft[1] -= bolideSize;
-	vertexArrayBolide.push_back(radiantToAltAz(topLeft));
-	colorArrayBolide.push_back(bolideColor);
-
-	Vec3d topRight = m_position;
-	topRight[0] -= bolideSize;
-	vertexArrayBolide.push_back(radiantToAltAz(topRight));
-	colorArrayBolide.push_back(bolideColor);
-
-	Vec3d bottomRight = m_position;
-	bottomRight[1] += bolideSize;
-	vertexArrayBolide.push_back(radiantToAltAz(bottomRight));
-	colorArrayBolide.push_back(bolideColor);
-
-	Vec3d bottomLeft = m_position;
-	bottomLeft[0] += bolideSize;
-	vertexArrayBolide.push_back(radiantToAltAz(bottomLeft));
-	colorArrayBolide.push_back(bolideColor);
-
-	sPainter.setBlending(true, GL_ONE, GL_ONE);
-	sPainter.enableClientStates(true, true, true);
-	m_bolideTexture->bind();
-	static const float texCoordData[] = {1.,0., 0.,0., 0.,1., 1.,1.};
-	sPainter.setTexCoordPointer(2, GL_FLOAT, texCoordData);
-	sPainter.setColorPointer(4, GL_FLOAT, colorArrayBolide.constData());
-	sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayBolide.constData());
-	sPainter.drawFromArray(StelPainter::TriangleFan, vertexArrayBolide.size(), 0, true);
-
-	sPainter.setBlending(false);
-	sPainter.enableClientStates(false);
-}
-
-void Meteor::drawTrain(StelPainter& sPainter, const float& thickness)
-{
-	if (m_segments != m_lineColorVector.size() || 2*m_segments != m_trainColorVector.size())
-	{
-		qWarning() << "Meteor: color arrays have an inconsistent size!";
-		return;
-	}
-
-	// train (triangular prism)
-	//
-	QVector<Vec3d> vertexArrayLine;
-	QVector<Vec3d> vertexArrayL;
-	QVector<Vec3d> vertexArrayR;
-	QVector<Vec3d> vertexArrayTop;
-
-	Vec3d posTrainB = m_posTrain;
-	posTrainB[0] += thickness*0.7;
-	posTrainB[1] += thickness*0.7;
-	Vec3d posTrainL = m_posTrain;
-	posTrainL[1] -= thickness;
-	Vec3d posTrainR = m_posTrain;
-	posTrainR[0] -= thickness;
-
-	for (int i = 0; i < m_segments; ++i)
-	{
-		double height = m_posTrain[2] + i*(m_position[2] - m_posTrain[2])/(m_segments-1);
-		Vec3d posi;
-
-		posi = m_posTrain;
-		posi[2] = height;
-		vertexArrayLine.push_back(radiantToAltAz(posi));
-
-		posi = posTrainB;
-		posi[2] = height;
-		vertexArrayL.push_back(radiantToAltAz(posi));
-		vertexArrayR.push_back(radiantToAltAz(posi));
-
-		posi = posTrainL;
-		posi[2] = height;
-		vertexArrayL.push_back(radiantToAltAz(posi));
-		vertexArrayTop.push_back(radiantToAltAz(posi));
-
-		posi = posTrainR;
-		posi[2] = height;
-		vertexArrayR.push_back(radiantToAltAz(posi));
-		vertexArrayTop.push_back(radiantToAltAz(posi));
-
-		float mag = m_aptMag * ((float) i / (float) (m_segments-1));
-		m_lineColorVector[i][3] = mag;
-		m_trainColorVector[i*2][3] = mag;
-		m_trainColorVector[i*2+1][3] = mag;
-	}
-
-	sPainter.setBlending(true);
-	sPainter.enableClientStates(true, false, true);
-	if (thickness)
-	{
-		sPainter.setColorPointer(4, GL_FLOAT, m_trainColorVector.constData());
-
-		sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayL.constData());
-		sPainter.drawFromArray(StelPainter::TriangleStrip, vertexArrayL.size(), 0, true);
-
-		sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayR.constData());
-		sPainter.drawFromArray(StelPainter::TriangleStrip, vertexArrayR.size(), 0, true);
-
-		sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayTop.constData());
-		sPainter.drawFromArray(StelPainter::TriangleStrip, vertexArrayTop.size(), 0, true);
-	}
-	sPainter.setColorPointer(4, GL_FLOAT, m_lineColorVector.constData());
-	sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayLine.constData());
-	sPainter.drawFromArray(StelPainter::LineStrip, vertexArrayLine.size(), 0, true);
-
-	sPainter.setBlending(false);
-	sPainter.enableClientStates(false);
-}
@@ -20,14 +20,13 @@
 #ifndef _METEOR_HPP_
 #define _METEOR_HPP_
 
-#include "StelTextureTypes.hpp"
 #include "VecMath.hpp"
 
 #include <QList>
 #include <QPair>
+#include <QVector>
 
 class StelCore;
-class StelPainter;
 
 #define EARTH_RADIUS 6378.f          //! earth_radius in km
 #define EARTH_RADIUS2 40678884.f     //! earth_radius^2 in km
@@ -35,9 +34,9 @@ class StelPainter;
 #define MIN_ALTITUDE 80.f            //! min meteor altitude in km
 
 //! @class Meteor 
-//! Models a single meteor.
-//! Once created, a meteor object only lasts for some amount of time,
-//! and then "dies", after which, the update() member returns false.
+//! Models the creation of a single meteor: its trajectory, magnitude and colors.
+//! A meteor which is alive once created is added to a MeteorPool,
+//! which moves it, draws it, and removes it when it "dies".
 //! @author Marcos Cardinot <mcardinot@gmail.com>
 class Meteor
 {
@@ -45,54 +44,36 @@ public:
 	//! <colorName, intensity>
 	typedef QPair<QString, int> ColorPair;
 
+	//! Number of segments along the train (useful to curve along projection distortions)
+	static const int SEGMENTS = 10;
+
 	//! Create a Meteor object.
-	Meteor(const StelCore* core, const StelTextureSP &bolideTexture);
+	Meteor(const StelCore* core);
 	virtual ~Meteor();
 
 	//! Initialize meteor
 	void init(const float& radiantAlpha, const float& radiantDelta,
 		  const float& speed, const QList<ColorPair> colors);
 
-	//! Updates the position of the meteor, and expires it if necessary.
-	//! @param deltaTime the time increment in seconds since the last call.
-	//! @return true of the meteor is still alive, else false.
-	virtual bool update(double deltaTime);
-	
-	//! Draws the meteor.
-	virtual void draw(const StelCore* core, StelPainter& sPainter);
-
 	//! Indicate if the meteor still visible.
-	bool isAlive() { return m_alive; }
+	bool isAlive() const { return m_alive; }
 	//! Set meteor absolute magnitude.
 	void setAbsMag(float mag) { m_absMag = mag; }
 	//! Get meteor absolute magnitude.
-	float absMag() { return m_absMag; }
+	float absMag() const { return m_absMag; }
 
 private:
-	//! Determine color vectors of line and prism used to draw meteor train.
+	friend class MeteorPool;
+
+	//! Determine the color of each segment of the meteor train.
 	void buildColorVectors(const QList<ColorPair> colors);
 
 	//! get RGB from color name
 	Vec4f getColorFromName(QString colorName);
 
-	//! Calculates the train thickness and bolide size.
-	void calculateThickness(const StelCore* core, float &thickness, float &bolideSize);
-
-	//! Draws the meteor bolide.
-	void drawBolide(StelPainter &sPainter, const float &bolideSize);
-
-	//! Draws the meteor train.
-	void drawTrain(StelPainter& sPainter, const float &thickness);
-
 	//! Calculates the z-component of a meteor as a function of meteor zenith angle
 	float meteorZ(float zenithAngle, float altitude);
 
-	//! find meteor position in horizontal coordinate system
-	Vec3d radiantToAltAz(Vec3d position);
-
-	//! find meteor position in radiant coordinate system
-	Vec3d altAzToRadiant(Vec3d position);
-
 	const StelCore* m_core;         //! The associated StelCore instance.
 
 	bool m_alive;                   //! Indicates if the meteor it still visible.
@@ -106,10 +87,7 @@ private:
 	float m_absMag;                 //! Absolute magnitude [0, 1]
 	float m_aptMag;                 //! Apparent magnitude [0, 1]
 
-	StelTextureSP m_bolideTexture;  //! Meteor bolide texture
-	const int m_segments;           //! Number of segments along the train (useful to curve along projection distortions)
-	QVector<Vec4f> m_trainColorVector;
-	QVector<Vec4f> m_lineColorVector;
+	QVector<Vec4f> m_lineColorVector; //! Color of each segment of the train
 };
 
 #endif // _METEOR_HPP_
@@ -0,0 +1,341 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MeteorPool.hpp"
+#include "Meteor.hpp"
+#include "StelCore.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelPainter.hpp"
+#include "StelTexture.hpp"
+
+#include <QDebug>
+#include <QtMath>
+
+namespace
+{
+	//! Scales the radiant coordinates (in km) down under 1
+	const double RADIANT_SCALE = 1242.;
+}
+
+MeteorPool::MeteorPool(int capacity)
+	: capacity(capacity)
+{
+}
+
+bool MeteorPool::add(const Meteor& meteor)
+{
+	if (!meteor.isAlive() || size() >= capacity)
+	{
+		return false;
+	}
+	if (meteor.m_lineColorVector.size() != Meteor::SEGMENTS)
+	{
+		qWarning() << "Meteor: color arrays have an inconsistent size!";
+		return false;
+	}
+
+	if (speed.capacity() < capacity)
+	{
+		// allocate the whole pool once
+		speed.reserve(capacity);
+		posX.reserve(capacity);
+		posY.reserve(capacity);
+		posZ.reserve(capacity);
+		trainZ.reserve(capacity);
+		initialZ.reserve(capacity);
+		finalZ.reserve(capacity);
+		minDist2.reserve(capacity);
+		absMag.reserve(capacity);
+		aptMag.reserve(capacity);
+		axisX.reserve(capacity);
+		axisY.reserve(capacity);
+		axisZ.reserve(capacity);
+		colors.reserve(capacity*Meteor::SEGMENTS);
+	}
+
+	speed.append(meteor.m_speed);
+	posX.append(meteor.m_position[0]);
+	posY.append(meteor.m_position[1]);
+	posZ.append(meteor.m_position[2]);
+	trainZ.append(meteor.m_posTrain[2]);
+	initialZ.append(meteor.m_initialZ);
+	finalZ.append(meteor.m_finalZ);
+	minDist2.append(meteor.m_minDist*meteor.m_minDist);
+	absMag.append(meteor.m_absMag);
+	aptMag.append(meteor.m_aptMag);
+
+	// columns of the rotation matrix, i.e. what Vec3d::transfo4d() multiplies x, y and z with
+	const Mat4d& m = meteor.m_matAltAzToRadiant;
+	axisX.append(Vec3d(m.r[0], m.r[1], m.r[2]) / RADIANT_SCALE);
+	axisY.append(Vec3d(m.r[4], m.r[5], m.r[6]) / RADIANT_SCALE);
+	axisZ.append(Vec3d(m.r[8], m.r[9], m.r[10]) / RADIANT_SCALE);
+
+	for (int s = 0; s < Meteor::SEGMENTS; ++s)
+	{
+		const Vec4f& c = meteor.m_lineColorVector.at(s);
+		colors.append(Vec3f(c[0], c[1], c[2]));
+	}
+	return true;
+}
+
+void MeteorPool::clear()
+{
+	speed.clear();
+	posX.clear();
+	posY.clear();
+	posZ.clear();
+	trainZ.clear();
+	initialZ.clear();
+	finalZ.clear();
+	minDist2.clear();
+	absMag.clear();
+	aptMag.clear();
+	axisX.clear();
+	axisY.clear();
+	axisZ.clear();
+	colors.clear();
+}
+
+void MeteorPool::move(int from, int to)
+{
+	speed[to] = speed.at(from);
+	posX[to] = posX.at(from);
+	posY[to] = posY.at(from);
+	posZ[to] = posZ.at(from);
+	trainZ[to] = trainZ.at(from);
+	initialZ[to] = initialZ.at(from);
+	finalZ[to] = finalZ.at(from);
+	minDist2[to] = minDist2.at(from);
+	absMag[to] = absMag.at(from);
+	aptMag[to] = aptMag.at(from);
+	axisX[to] = axisX.at(from);
+	axisY[to] = axisY.at(from);
+	axisZ[to] = axisZ.at(from);
+	for (int s = 0; s < Meteor::SEGMENTS; ++s)
+	{
+		colors[to*Meteor::SEGMENTS+s] = colors.at(from*Meteor::SEGMENTS+s);
+	}
+}
+
+void MeteorPool::removeLast()
+{
+	speed.removeLast();
+	posX.removeLast();
+	posY.removeLast();
+	posZ.removeLast();
+	trainZ.removeLast();
+	initialZ.removeLast();
+	finalZ.removeLast();
+	minDist2.removeLast();
+	absMag.removeLast();
+	aptMag.removeLast();
+	axisX.removeLast();
+	axisY.removeLast();
+	axisZ.removeLast();
+	colors.resize(colors.size()-Meteor::SEGMENTS);
+}
+
+void MeteorPool::update(const StelCore* core, double deltaTime)
+{
+	const int n = size();
+	if (n == 0)
+	{
+		return;
+	}
+
+	// burning stops when going forward/backward in time
+	const bool realTime = core->getRealTimeSpeed();
+	const float dt = deltaTime;
+	const float fade = dt * 2.f;
+
+	// no branches and no calls in this loop, so that the compiler can vectorize it
+	float* const z = posZ.data();
+	float* const tz = trainZ.data();
+	float* const absM = absMag.data();
+	float* const aptM = aptMag.data();
+	const float* const v = speed.constData();
+	const float* const x = posX.constData();
+	const float* const y = posY.constData();
+	const float* const z0 = initialZ.constData();
+	const float* const z1 = finalZ.constData();
+	const float* const d2 = minDist2.constData();
+	for (int i = 0; i < n; ++i)
+	{
+		// burning has stopped so magnitude fades out
+		// assume linear fade out
+		const bool burning = realTime && z[i] >= z1[i];
+		absM[i] -= burning ? 0.f : fade;
+
+		z[i] -= v[i] * dt;
+
+		// train doesn't extend beyond start of burn
+		tz[i] = (z[i] + v[i] * 0.5f > z0[i]) ? z0[i] : tz[i] - v[i] * dt;
+
+		// update apparent magnitude based on distance to observer
+		const float scale = d2[i] / (x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+		const float mag = absM[i] * (scale < 1.f ? scale : 1.f);
+		aptM[i] = mag > 0.f ? mag : 0.f;
+	}
+
+	// remove the meteors which are no longer visible
+	for (int i = 0; i < size();)
+	{
+		if (absMag.at(i) <= 0.f)
+		{
+			const int last = size() - 1;
+			if (i != last)
+			{
+				move(last, i);
+			}
+			removeLast();
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void MeteorPool::draw(const StelCore* core, StelPainter& sPainter, const StelTextureSP& bolideTexture)
+{
+	const int n = size();
+	if (n == 0)
+	{
+		return;
+	}
+
+	// train thickness and bolide size
+	float maxFOV = core->getMovementMgr()->getMaxFov();
+	float FOV = core->getMovementMgr()->getCurrentFov();
+	float thickness = 2*log(FOV + 0.25)/(1.2*maxFOV - (FOV + 0.25)) + 0.01;
+	if (FOV <= 0.5)
+	{
+		thickness = 0.013 * FOV; // decreasing faster
+	}
+	else if (FOV > 100.0)
+	{
+		thickness = 0; // remove prism
+	}
+	const float bolideSize = thickness*3;
+	const bool drawBolides = bolideSize && bolideTexture;
+
+	const int segs = Meteor::SEGMENTS;
+	trainVertices.clear();
+	trainColors.clear();
+	lineVertices.clear();
+	lineColors.clear();
+	bolideVertices.clear();
+	bolideColors.clear();
+	bolideTexCoords.clear();
+
+	// points of the train along the meteor path, in horizontal coordinates
+	Vec3d line[segs], trainB[segs], trainL[segs], trainR[segs];
+	Vec4f segColors[segs];
+	for (int i = 0; i < n; ++i)
+	{
+		const Vec3d& ax = axisX.at(i);
+		const Vec3d& ay = axisY.at(i);
+		const Vec3d& az = axisZ.at(i);
+
+		// the train is a triangular prism around the line, along the z axis
+		const Vec3d center = ax*posX.at(i) + ay*posY.at(i);
+		const Vec3d offsetB = (ax+ay)*(thickness*0.7);
+		const Vec3d offsetL = -ay*thickness;
+		const Vec3d offsetR = -ax*thickness;
+		const double z = posZ.at(i);
+		const double tz = trainZ.at(i);
+		const float mag = aptMag.at(i);
+		for (int s = 0; s < segs; ++s)
+		{
+			const Vec3d p = center + az*(tz + s*(z - tz)/(segs-1));
+			line[s] = p;
+			trainB[s] = p + offsetB;
+			trainL[s] = p + offsetL;
+			trainR[s] = p + offsetR;
+			const Vec3f& c = colors.at(i*segs+s);
+			segColors[s].set(c[0], c[1], c[2], mag * ((float) s / (float) (segs-1)));
+		}
+
+		for (int s = 0; s < segs-1; ++s)
+		{
+			lineVertices << line[s] << line[s+1];
+			lineColors << segColors[s] << segColors[s+1];
+		}
+
+		if (thickness)
+		{
+			// the three faces of the prism, each made of two triangles per segment
+			const Vec3d* faces[3][2] = {{trainB, trainL}, {trainB, trainR}, {trainL, trainR}};
+			for (int f = 0; f < 3; ++f)
+			{
+				const Vec3d* a = faces[f][0];
+				const Vec3d* b = faces[f][1];
+				for (int s = 0; s < segs-1; ++s)
+				{
+					trainVertices << a[s] << b[s] << a[s+1] << b[s] << a[s+1] << b[s+1];
+					trainColors << segColors[s] << segColors[s] << segColors[s+1]
+						    << segColors[s] << segColors[s+1] << segColors[s+1];
+				}
+			}
+		}
+
+		if (drawBolides)
+		{
+			const Vec3d pos = center + az*z;
+			const Vec3d topLeft = pos - ay*bolideSize;
+			const Vec3d topRight = pos - ax*bolideSize;
+			const Vec3d bottomRight = pos + ay*bolideSize;
+			const Vec3d bottomLeft = pos + ax*bolideSize;
+			bolideVertices << topLeft << topRight << bottomRight << topLeft << bottomRight << bottomLeft;
+			bolideTexCoords << Vec2f(1.f,0.f) << Vec2f(0.f,0.f) << Vec2f(0.f,1.f)
+					<< Vec2f(1.f,0.f) << Vec2f(0.f,1.f) << Vec2f(1.f,1.f);
+			const Vec4f bolideColor(1.f, 1.f, 1.f, mag);
+			for (int k = 0; k < 6; ++k)
+			{
+				bolideColors << bolideColor;
+			}
+		}
+	}
+
+	sPainter.setBlending(true);
+	sPainter.enableClientStates(true, false, true);
+	if (!trainVertices.isEmpty())
+	{
+		sPainter.setColorPointer(4, GL_FLOAT, trainColors.constData());
+		sPainter.setVertexPointer(3, GL_DOUBLE, trainVertices.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, trainVertices.size(), 0, true);
+	}
+	sPainter.setColorPointer(4, GL_FLOAT, lineColors.constData());
+	sPainter.setVertexPointer(3, GL_DOUBLE, lineVertices.constData());
+	sPainter.drawFromArray(StelPainter::Lines, lineVertices.size(), 0, true);
+
+	if (!bolideVertices.isEmpty())
+	{
+		sPainter.setBlending(true, GL_ONE, GL_ONE);
+		sPainter.enableClientStates(true, true, true);
+		bolideTexture->bind();
+		sPainter.setTexCoordPointer(2, GL_FLOAT, bolideTexCoords.constData());
+		sPainter.setColorPointer(4, GL_FLOAT, bolideColors.constData());
+		sPainter.setVertexPointer(3, GL_DOUBLE, bolideVertices.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, bolideVertices.size(), 0, true);
+	}
+
+	sPainter.setBlending(false);
+	sPainter.enableClientStates(false);
+}
@@ -0,0 +1,95 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _METEORPOOL_HPP_
+#define _METEORPOOL_HPP_
+
+#include "StelTextureTypes.hpp"
+#include "VecMath.hpp"
+
+#include <QVector>
+
+class Meteor;
+class StelCore;
+class StelPainter;
+
+//! @class MeteorPool
+//! Stores the active meteors of a meteor source, moves them and draws them.
+//! The state of the meteors is stored field by field in arrays of fixed capacity, so that
+//! update() runs simple loops over contiguous data, and a dead meteor is removed by moving
+//! the last one into its place. draw() collects the trains, lines and bolides of all the
+//! meteors in three vertex arrays, which are drawn with one call each.
+class MeteorPool
+{
+public:
+	//! @param capacity the maximum number of meteors. Meteors added beyond it are ignored.
+	MeteorPool(int capacity=4096);
+
+	//! Add a meteor created alive. The meteor object is not needed afterwards.
+	//! @return false if the meteor is dead or the pool is full.
+	bool add(const Meteor& meteor);
+	//! Remove all meteors.
+	void clear();
+	//! Number of active meteors.
+	int size() const {return speed.size();}
+	int getCapacity() const {return capacity;}
+
+	//! Move the meteors, fade out the ones which stopped burning and remove the dead ones.
+	//! @param deltaTime the time increment in seconds since the last call.
+	void update(const StelCore* core, double deltaTime);
+	//! Draw all the meteors. The painter must use the FrameAltAz projection.
+	void draw(const StelCore* core, StelPainter& sPainter, const StelTextureSP& bolideTexture);
+
+private:
+	//! Move the meteor at index from to index to.
+	void move(int from, int to);
+	void removeLast();
+
+	int capacity;
+
+	// Meteor state in the radiant coordinate system. The x and y positions are constant.
+	QVector<float> speed;
+	QVector<float> posX;
+	QVector<float> posY;
+	QVector<float> posZ;
+	QVector<float> trainZ;
+	QVector<float> initialZ;
+	QVector<float> finalZ;
+	//! Square of the shortest distance between meteor and observer
+	QVector<float> minDist2;
+	QVector<float> absMag;
+	QVector<float> aptMag;
+	//! Axes of the radiant coordinate system in horizontal coordinates, scaled down under 1
+	QVector<Vec3d> axisX;
+	QVector<Vec3d> axisY;
+	QVector<Vec3d> axisZ;
+	//! Meteor::SEGMENTS colors for each meteor
+	QVector<Vec3f> colors;
+
+	// Vertex arrays of draw(), kept to avoid reallocating them each frame
+	QVector<Vec3d> trainVertices;
+	QVector<Vec4f> trainColors;
+	QVector<Vec3d> lineVertices;
+	QVector<Vec4f> lineColors;
+	QVector<Vec3d> bolideVertices;
+	QVector<Vec4f> bolideColors;
+	QVector<Vec2f> bolideTexCoords;
+};
+
+#endif // _METEORPOOL_HPP_
@@ -170,18 +170,18 @@ void MilkyWay::draw(StelCore* core)
 		// We must process the vertices to find geometric altitudes in order to compute vertex colors.
 		// Note that there is a visible boost of extinction for higher Bortle indices. I must reflect that as well.
 		const Extinction& extinction=drawer->getExtinction();
-		vertexArray->colors.clear();
-
-		for (int i=0; i<vertexArray->vertex.size(); ++i)
+		const int n=vertexArray->vertex.size();
+		QVector<Vec3d> vertAltAz(n);
+		QVector<float> extinctionMag(n, 0.f);
+		core->j2000ToAltAz(n, vertexArray->vertex.constData(), vertAltAz.data(), StelCore::RefractionOn);
+		extinction.forward(n, vertAltAz.constData(), extinctionMag.data());
+
+		vertexArray->colors.resize(n);
+		for (int i=0; i<n; ++i)
 		{
-			Vec3d vertAltAz=core->j2000ToAltAz(vertexArray->vertex.at(i), StelCore::RefractionOn);
-			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
-
-			float oneMag=0.0f;
-			extinction.forward(vertAltAz, &oneMag);
-			float extinctionFactor=std::pow(0.3f , oneMag) * (1.1f-bortle*0.1f); // drop of one magnitude: should be factor 2.5 or 40%. We take 30%, it looks more realistic.
-			Vec3f thisColor=Vec3f(c[0]*extinctionFactor, c[1]*extinctionFactor, c[2]*extinctionFactor);
-			vertexArray->colors.append(thisColor);
+			Q_ASSERT(fabs(vertAltAz.at(i).lengthSquared()-1.0) < 0.001);
+			float extinctionFactor=std::pow(0.3f , extinctionMag.at(i)) * (1.1f-bortle*0.1f); // drop of one magnitude: should be factor 2.5 or 40%. We take 30%, it looks more realistic.
+			vertexArray->colors[i]=Vec3f(c[0]*extinctionFactor, c[1]*extinctionFactor, c[2]*extinctionFactor);
 		}
 	}
 	else
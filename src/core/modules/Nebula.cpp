@@ -29,6 +29,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelCore.hpp"
 #include "StelPainter.hpp"
+#include "StelSpriteBatch.hpp"
 
 #include <QTextStream>
 #include <QFile>
@@ -528,7 +529,30 @@ float Nebula::getSurfaceArea(void) const
 		return M_PI*(majorAxisSize/2.f)*(minorAxisSize/2.f); // S = pi*a*b
 }
 
-void Nebula::drawHints(StelPainter& sPainter, float maxMagHints) const
+StelTextureSP Nebula::getHintTexture(HintTexture hintTexture)
+{
+	switch (hintTexture)
+	{
+		case HintGalaxy:
+			return texGalaxy;
+		case HintOpenCluster:
+			return texOpenCluster;
+		case HintGlobularCluster:
+			return texGlobularCluster;
+		case HintPlanetaryNebula:
+			return texPlanetaryNebula;
+		case HintDiffuseNebula:
+			return texDiffuseNebula;
+		case HintDarkNebula:
+			return texDarkNebula;
+		case HintOpenClusterWithNebulosity:
+			return texOpenClusterWithNebulosity;
+		default:
+			return texCircle;
+	}
+}
+
+void Nebula::drawHints(StelPainter& sPainter, float maxMagHints, StelSpriteBatch* hintBatches) const
 {
 	StelCore* core = StelApp::getInstance().getCore();
 
@@ -575,143 +599,144 @@ void Nebula::drawHints(StelPainter& sPainter, float maxMagHints) const
 	// tune limits for outlines
 	float oLim = lim - 3.f;
 
+	HintTexture hintTexture=HintCircle;
 	Vec3f color=circleColor;
 	switch (nType)
 	{
 		case NebGx:
-			Nebula::texGalaxy->bind();
+			hintTexture=HintGalaxy;
 			color=galaxyColor;
 			break;
 		case NebIGx:
-			Nebula::texGalaxy->bind();
+			hintTexture=HintGalaxy;
 			color=interactingGalaxyColor;
 			break;
 		case NebAGx:
-			Nebula::texGalaxy->bind();
+			hintTexture=HintGalaxy;
 			color=activeGalaxyColor;
 			break;
 		case NebQSO:
-			Nebula::texGalaxy->bind();
+			hintTexture=HintGalaxy;
 			color=quasarColor;
 			break;
 		case NebPossQSO:
-			Nebula::texGalaxy->bind();
+			hintTexture=HintGalaxy;
 			color=possibleQuasarColor;
 			break;
 		case NebBLL:
-			Nebula::texGalaxy->bind();
+			hintTexture=HintGalaxy;
 			color=blLacObjectColor;
 			break;
 		case NebBLA:
-			Nebula::texGalaxy->bind();
+			hintTexture=HintGalaxy;
 			color=blazarColor;
 			break;
 		case NebRGx:
-			Nebula::texGalaxy->bind();
+			hintTexture=HintGalaxy;
 			color=radioGalaxyColor;
 			break;
 		case NebOc:
-			Nebula::texOpenCluster->bind();
+			hintTexture=HintOpenCluster;
 			color=openClusterColor;
 			break;
 		case NebSA:
-			Nebula::texOpenCluster->bind();
+			hintTexture=HintOpenCluster;
 			color=stellarAssociationColor;
 			break;
 		case NebSC:
-			Nebula::texOpenCluster->bind();
+			hintTexture=HintOpenCluster;
 			color=starCloudColor;
 			break;
 		case NebCl:
-			Nebula::texOpenCluster->bind();
+			hintTexture=HintOpenCluster;
 			color=clusterColor;
 			break;
 		case NebGc:
-			Nebula::texGlobularCluster->bind();
+			hintTexture=HintGlobularCluster;
 			color=globularClusterColor;
 			break;
 		case NebN:
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=nebulaColor;
 			break;
 		case NebHII:
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=hydrogenRegionColor;
 			break;
 		case NebMolCld:
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=molecularCloudColor;
 			break;
 		case NebYSO:
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=youngStellarObjectColor;
 			break;
 		case NebRn:		
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=reflectionNebulaColor;
 			break;
 		case NebSNR:
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=supernovaRemnantColor;
 			break;
 		case NebBn:
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=bipolarNebulaColor;
 			break;
 		case NebEn:
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=emissionNebulaColor;
 			break;
 		case NebPn:
-			Nebula::texPlanetaryNebula->bind();
+			hintTexture=HintPlanetaryNebula;
 			color=planetaryNebulaColor;
 			break;
 		case NebPossPN:
-			Nebula::texPlanetaryNebula->bind();
+			hintTexture=HintPlanetaryNebula;
 			color=possiblePlanetaryNebulaColor;
 			break;
 		case NebPPN:
-			Nebula::texPlanetaryNebula->bind();
+			hintTexture=HintPlanetaryNebula;
 			color=protoplanetaryNebulaColor;
 			break;
 		case NebDn:		
-			Nebula::texDarkNebula->bind();
+			hintTexture=HintDarkNebula;
 			color=darkNebulaColor;
 			break;
 		case NebCn:
-			Nebula::texOpenClusterWithNebulosity->bind();
+			hintTexture=HintOpenClusterWithNebulosity;
 			color=clusterWithNebulosityColor;
 			break;
 		case NebEMO:
-			Nebula::texCircle->bind();
+			hintTexture=HintCircle;
 			color=emissionObjectColor;
 			break;
 		case NebStar:
-			Nebula::texCircle->bind();
+			hintTexture=HintCircle;
 			color=starColor;
 			break;
 		case NebSymbioticStar:
-			Nebula::texCircle->bind();
+			hintTexture=HintCircle;
 			color=symbioticStarColor;
 			break;
 		case NebEmissionLineStar:
-			Nebula::texCircle->bind();
+			hintTexture=HintCircle;
 			color=emissionLineStarColor;
 			break;
 		case NebSNC:
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=supernovaCandidateColor;
 			break;
 		case NebSNRC:
-			Nebula::texDiffuseNebula->bind();
+			hintTexture=HintDiffuseNebula;
 			color=supernovaRemnantCandidateColor;
 			break;
 		case NebGxCl:
-			Nebula::texGalaxy->bind();
+			hintTexture=HintGalaxy;
 			color=galaxyClusterColor;
 			break;
 		default:
-			Nebula::texCircle->bind();
+			hintTexture=HintCircle;
 	}
 
 	float lum = 1.f;
@@ -761,7 +786,9 @@ void Nebula::drawHints(StelPainter& sPainter, float maxMagHints) const
 			scaledSize = minorAxisSize *0.5 *M_PI/180.*sPainter.getProjector()->getPixelPerRadAtCenter();
 	}
 
-	sPainter.setBlending(true, GL_ONE, GL_ONE);
+	// The sprite itself is only collected here, NebulaMgr::draw() submits one batch per hint texture.
+	StelSpriteBatch& batch = hintBatches[hintTexture];
+	const Vec4f batchColor(col[0], col[1], col[2], 1.f);
 
 	// Rotation looks good only for galaxies.
 	if ((nType <=NebQSO) || (nType==NebBLA) || (nType==NebBLL) )
@@ -773,10 +800,10 @@ void Nebula::drawHints(StelPainter& sPainter, float maxMagHints) const
 		Vec3d XYrel;
 		sPainter.getProjector()->project(XYZrel, XYrel);
 		float screenAngle=atan2(XYrel[1]-XY[1], XYrel[0]-XY[0]);
-		sPainter.drawSprite2dMode(XY[0], XY[1], qMax(size, scaledSize), screenAngle*180./M_PI + orientationAngle);
+		batch.add(XY[0], XY[1], qMax(size, scaledSize), screenAngle*180./M_PI + orientationAngle, batchColor);
 	}
 	else	// no galaxy
-		sPainter.drawSprite2dMode(XY[0], XY[1], qMax(size, scaledSize));
+		batch.add(XY[0], XY[1], qMax(size, scaledSize), batchColor);
 
 }
 
@@ -29,6 +29,7 @@
 #include <QString>
 
 class StelPainter;
+class StelSpriteBatch;
 class QDataStream;
 
 // This only draws nebula icons. For the DSO images, see StelSkylayerMgr and StelSkyImageTile.
@@ -216,8 +217,25 @@ private:
 
 	void readDSO(QDataStream& in);
 
+	//! Textures used for the DSO hints. Hints are collected per texture and drawn in batches.
+	enum HintTexture
+	{
+		HintCircle = 0,
+		HintGalaxy,
+		HintOpenCluster,
+		HintGlobularCluster,
+		HintPlanetaryNebula,
+		HintDiffuseNebula,
+		HintDarkNebula,
+		HintOpenClusterWithNebulosity,
+		HintTextureCount
+	};
+	static StelTextureSP getHintTexture(HintTexture hintTexture);
+
 	void drawLabel(StelPainter& sPainter, float maxMagLabel) const;
-	void drawHints(StelPainter& sPainter, float maxMagHints) const;
+	//! Draw the outlines and add the hint sprite to the batch of its texture.
+	//! @param hintBatches array of HintTextureCount batches, indexed by HintTexture.
+	void drawHints(StelPainter& sPainter, float maxMagHints, StelSpriteBatch* hintBatches) const;
 
 	bool objectInDisplayedType() const;
 
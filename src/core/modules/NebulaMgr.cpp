@@ -26,6 +26,7 @@
 #include "Nebula.hpp"
 #include "StelTexture.hpp"
 #include "StelUtils.hpp"
+#include "StelInflateDevice.hpp"
 #include "StelSkyDrawer.hpp"
 #include "StelTranslator.hpp"
 #include "StelTextureMgr.hpp"
@@ -37,6 +38,7 @@
 #include "StelCore.hpp"
 #include "StelSkyImageTile.hpp"
 #include "StelPainter.hpp"
+#include "StelProfiler.hpp"
 #include "RefractionExtinction.hpp"
 #include "StelActionMgr.hpp"
 
@@ -143,6 +145,12 @@ NebulaMgr::NebulaMgr(void)
 	, flagDecimalCoordinates(true)
 {
 	setObjectName("NebulaMgr");
+
+	// for DSO convertor (for developers!)
+	// Read here because the catalog is converted by load(), which can't use the settings
+	QSettings* conf = StelApp::getInstance().getSettings();
+	flagConverter = conf->value("devel/convert_dso_catalog", false).toBool();
+	flagDecimalCoordinates = conf->value("devel/convert_dso_decimal_coord", true).toBool();
 }
 
 NebulaMgr::~NebulaMgr()
@@ -168,6 +176,18 @@ double NebulaMgr::getCallOrder(StelModuleActionName actionName) const
 }
 
 // read from stream
+void NebulaMgr::load()
+{
+	// TODO: mechanism to specify which sets get loaded at start time.
+	// candidate methods:
+	// 1. config file option (list of sets to load at startup)
+	// 2. load all
+	// 3. flag in nebula_textures.fab (yuk)
+	// 4. info.ini file in each set containing a "load at startup" item
+	// For now (0.9.0), just load the default set
+	loadNebulaSet("default");
+}
+
 void NebulaMgr::init()
 {
 	QSettings* conf = StelApp::getInstance().getSettings();
@@ -299,10 +319,6 @@ void NebulaMgr::init()
 	setEmissionObjectColor(StelUtils::strToVec3f(conf->value("color/dso_emission_object_color", defaultStellarColor).toString()));
 	setYoungStellarObjectColor(StelUtils::strToVec3f(conf->value("color/dso_young_stellar_object_color", defaultStellarColor).toString()));
 
-	// for DSO convertor (for developers!)
-	flagConverter = conf->value("devel/convert_dso_catalog", false).toBool();
-	flagDecimalCoordinates = conf->value("devel/convert_dso_decimal_coord", true).toBool();
-
 	setFlagUseTypeFilters(conf->value("astro/flag_use_type_filter", false).toBool());
 
 	Nebula::CatalogGroup catalogFilters = Nebula::CatalogGroup(0);
@@ -384,15 +400,6 @@ void NebulaMgr::init()
 
 	setTypeFilters(typeFilters);
 
-	// TODO: mechanism to specify which sets get loaded at start time.
-	// candidate methods:
-	// 1. config file option (list of sets to load at startup)
-	// 2. load all
-	// 3. flag in nebula_textures.fab (yuk)
-	// 4. info.ini file in each set containing a "load at startup" item
-	// For now (0.9.0), just load the default set
-	loadNebulaSet("default");
-
 	updateI18n();
 
 	StelApp *app = &StelApp::getInstance();
@@ -406,12 +413,15 @@ void NebulaMgr::init()
 
 struct DrawNebulaFuncObject
 {
-	DrawNebulaFuncObject(float amaxMagHints, float amaxMagLabels, StelPainter* p, StelCore* aCore, bool acheckMaxMagHints)
+	DrawNebulaFuncObject(float amaxMagHints, float amaxMagLabels, StelPainter* p, StelCore* aCore, bool acheckMaxMagHints,
+			     StelSpriteBatch* aHintBatches, QVector<const Nebula*>* aLabelQueue)
 		: maxMagHints(amaxMagHints)
 		, maxMagLabels(amaxMagLabels)
 		, sPainter(p)
 		, core(aCore)
 		, checkMaxMagHints(acheckMaxMagHints)
+		, hintBatches(aHintBatches)
+		, labelQueue(aLabelQueue)
 	{
 		angularSizeLimit = 5.f/sPainter->getProjector()->getPixelPerRadAtCenter()*180.f/M_PI;
 	}
@@ -434,8 +444,9 @@ struct DrawNebulaFuncObject
 		if (n->majorAxisSize>angularSizeLimit || n->majorAxisSize==0.f || mag <= maxMagHints)
 		{
 			sPainter->getProjector()->project(n->XYZ,n->XY);
-			n->drawLabel(*sPainter, maxMagLabels);
-			n->drawHints(*sPainter, maxMagHints);
+			// Labels are drawn after all the hint batches, so that the text state is only set up once.
+			labelQueue->append(n);
+			n->drawHints(*sPainter, maxMagHints, hintBatches);
 		}
 	}
 	float maxMagHints;
@@ -444,6 +455,8 @@ struct DrawNebulaFuncObject
 	StelCore* core;
 	float angularSizeLimit;
 	bool checkMaxMagHints;
+	StelSpriteBatch* hintBatches;
+	QVector<const Nebula*>* labelQueue;
 };
 
 void NebulaMgr::setCatalogFilters(Nebula::CatalogGroup cflags)
@@ -489,8 +502,39 @@ void NebulaMgr::draw(StelCore* core)
 	float maxMagHints  = computeMaxMagHint(skyDrawer);
 	float maxMagLabels = skyDrawer->getLimitMagnitude()-2.f+(labelsAmount*1.2f)-2.f;
 	sPainter.setFont(nebulaFont);
-	DrawNebulaFuncObject func(maxMagHints, maxMagLabels, &sPainter, core, hintsFader.getInterstate()<=0.f);
-	nebGrid.processIntersectingPointInRegions(p.data(), func);
+
+	const float spriteScale = prj->getDevicePixelsPerPixel()*StelApp::getInstance().getGlobalScalingRatio();
+	for (int i=0; i<Nebula::HintTextureCount; ++i)
+	{
+		hintBatches[i].clear();
+		hintBatches[i].setScale(spriteScale);
+	}
+	labelQueue.resize(0);
+
+	{
+		STEL_PROFILE_ZONE("NebulaMgr.collectHints");
+		DrawNebulaFuncObject func(maxMagHints, maxMagLabels, &sPainter, core, hintsFader.getInterstate()<=0.f, hintBatches, &labelQueue);
+		nebGrid.processIntersectingPointInRegions(p.data(), func);
+	}
+
+	// Submit the collected hints with one draw call per hint texture
+	{
+		STEL_PROFILE_ZONE("NebulaMgr.drawHints");
+		sPainter.setBlending(true, GL_ONE, GL_ONE);
+		for (int i=0; i<Nebula::HintTextureCount; ++i)
+		{
+			if (hintBatches[i].isEmpty())
+				continue;
+			StelTextureSP tex = Nebula::getHintTexture(static_cast<Nebula::HintTexture>(i));
+			if (tex.isNull())
+				continue;
+			tex->bind();
+			sPainter.drawSpriteBatch(hintBatches[i]);
+		}
+	}
+
+	foreach (const Nebula* n, labelQueue)
+		n->drawLabel(sPainter, maxMagLabels);
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, sPainter);
@@ -629,45 +673,20 @@ void NebulaMgr::loadNebulaSet(const QString& setName)
 // Look for a nebulae by XYZ coords
 NebulaP NebulaMgr::search(const Vec3d& apos)
 {
-	Vec3d pos = apos;
-	pos.normalize();
-	NebulaP plusProche;
-	float anglePlusProche=0.0f;
-	foreach (const NebulaP& n, dsoArray)
-	{
-		if (n->XYZ*pos>anglePlusProche)
-		{
-			anglePlusProche=n->XYZ*pos;
-			plusProche=n;
-		}
-	}
-	if (anglePlusProche>0.999f)
-	{
-		return plusProche;
-	}
-	else return NebulaP();
+	const QVector<StelRegionObjectP> nearest = nebGrid.findNearest(apos, 1, std::acos(0.999));
+	if (nearest.isEmpty())
+		return NebulaP();
+	return qSharedPointerCast<Nebula>(nearest.first());
 }
 
-
 QList<StelObjectP> NebulaMgr::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
 {
 	QList<StelObjectP> result;
 	if (!getFlagShow())
 		return result;
 
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-	foreach (const NebulaP& n, dsoArray)
-	{
-		equPos = n->XYZ;
-		equPos.normalize();
-		if (equPos*v>=cosLimFov)
-		{
-			result.push_back(qSharedPointerCast<StelObject>(n));
-		}
-	}
+	foreach (const StelRegionObjectP& obj, nebGrid.findNearest(av, dsoArray.size(), limitFov*M_PI/180.))
+		result.push_back(qSharedPointerCast<StelObject>(qSharedPointerCast<Nebula>(obj)));
 	return result;
 }
 
@@ -1190,12 +1209,17 @@ bool NebulaMgr::loadDSOCatalog(const QString &filename)
 
 	qDebug() << "Loading DSO data ...";
 
-	// Let's begin use gzipped data
-	QDataStream ins(StelUtils::uncompress(in.readAll()));
+	// Let's begin use gzipped data. Records are parsed while the catalog is being inflated.
+	StelInflateDevice inflater(&in);
+	inflater.setMultiMember(true);
+	if (!inflater.open(QIODevice::ReadOnly))
+		return false;
+	QDataStream ins(&inflater);
 	ins.setVersion(QDataStream::Qt_5_2);
 
 	QString version = "", edition= "";
 	int totalRecords=0;
+	QVector<StelRegionObjectP> gridObjects;
 	while (!ins.atEnd())
 	{
 		if (totalRecords==0) // Read the version of catalog
@@ -1220,13 +1244,15 @@ bool NebulaMgr::loadDSOCatalog(const QString &filename)
 			e->readDSO(ins);
 
 			dsoArray.append(e);
-			nebGrid.insert(qSharedPointerCast<StelRegionObject>(e));
+			gridObjects.append(qSharedPointerCast<StelRegionObject>(e));
 			if (e->DSO_nb!=0)
 				dsoIndex.insert(e->DSO_nb, e);
 		}
 		++totalRecords;
 	}
 	in.close();
+	// Build the index at once
+	nebGrid.insert(gridObjects);
 	qDebug() << "Loaded" << --totalRecords << "DSO records";
 	return true;
 }
@@ -27,6 +27,7 @@
 #include "StelSphericalIndex.hpp"
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
+#include "StelSpriteBatch.hpp"
 #include "Nebula.hpp"
 
 #include <QString>
@@ -296,6 +297,10 @@ public:
 
 	///////////////////////////////////////////////////////////////////////////
 	// Methods defined in the StelModule class
+	//! Load the default DSO catalog and outlines.
+	//! This doesn't use the settings, OpenGL or other modules and can run in a worker thread.
+	virtual void load();
+
 	//! Initialize the NebulaMgr object.
 	//!  - Load the font into the Nebula class, which is used to draw Nebula labels.
 	//!  - Load the texture used to draw nebula locations into the Nebula class (for
@@ -305,6 +310,9 @@ public:
 	//!  - call updateI18n() to translate names.
 	virtual void init();
 
+	//! The nebulae are registered in the StelObjectMgr.
+	virtual QStringList getInitDependencies() const {return QStringList("StelObjectMgr");}
+
 	//! Draws all nebula objects.
 	virtual void draw(StelCore* core);
 
@@ -939,6 +947,11 @@ private:
 
 	//! The selection pointer texture
 	StelTextureSP texPointer;
+
+	//! Hint sprites collected during draw(), one batch per Nebula::HintTexture
+	StelSpriteBatch hintBatches[Nebula::HintTextureCount];
+	//! DSOs whose label is drawn after the hint batches
+	QVector<const Nebula*> labelQueue;
 	
 	QFont nebulaFont;      // Font used for names printing
 
@@ -205,6 +205,7 @@ Planet::Planet(const QString& englishName,
 	  outgas_falloff(0.f),
 	  rotLocalToParent(Mat4d::identity()),
 	  axisRotation(0.),
+	  texMapLookedUp(false),
 	  objModel(Q_NULLPTR),
 	  objModelLoader(Q_NULLPTR),
 	  rings(Q_NULLPTR),
@@ -234,17 +235,8 @@ Planet::Planet(const QString& englishName,
 	}
 	Q_ASSERT(pType != Planet::isUNDEFINED);
 
-	//only try loading textures when there is actually something to load!
-	//prevents some overhead when starting
-	if(!texMapName.isEmpty())
-	{
-		// TODO: use StelFileMgr::findFileInAllPaths() after introducing an Add-On Manager
-		QString texMapFile = StelFileMgr::findFile("textures/"+texMapName, StelFileMgr::File);
-		if (!texMapFile.isEmpty())
-			texMap = StelApp::getInstance().getTextureManager().createTextureThread(texMapFile, StelTexture::StelTextureParams(true, GL_LINEAR, GL_REPEAT));
-		else
-			qWarning()<<"Cannot resolve path to texture file"<<texMapName<<"of object"<<englishName;
-	}
+	// The texture map is looked up when the planet is first drawn as a sphere: most minor bodies never are,
+	// and resolving the file of each of them would slow down the startup.
 
 	if(!normalMapName.isEmpty())
 	{
@@ -2387,6 +2379,17 @@ Planet::RenderData Planet::setCommonShaderUniforms(const StelPainter& painter, Q
 
 void Planet::drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing)
 {
+	if (!texMapLookedUp && !texMapName.isEmpty())
+	{
+		texMapLookedUp = true;
+		// TODO: use StelFileMgr::findFileInAllPaths() after introducing an Add-On Manager
+		QString texMapFile = StelFileMgr::findFile("textures/"+texMapName, StelFileMgr::File);
+		if (!texMapFile.isEmpty())
+			texMap = StelApp::getInstance().getTextureManager().createTextureThread(texMapFile, StelTexture::StelTextureParams(true, GL_LINEAR, GL_REPEAT));
+		else
+			qWarning()<<"Cannot resolve path to texture file"<<texMapName<<"of object"<<englishName;
+	}
+
 	if (texMap)
 	{
 		// For lazy loading, return if texture not yet loaded
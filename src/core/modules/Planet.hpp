@@ -516,6 +516,7 @@ protected:
 	float axisRotation;              // Rotation angle of the Planet on its axis.
 	// For Earth, this should be Greenwich Mean Sidereal Time GMST.
 	StelTextureSP texMap;            // Planet map texture
+	bool texMapLookedUp;             // True once texMap was looked up from texMapName (on first draw)
 	StelTextureSP normalMap;         // Planet normal map texture
 
 	PlanetOBJModel* objModel;               // Planet model (when it has been loaded)
@@ -33,7 +33,7 @@
 #include "StelSkyCultureMgr.hpp"
 #include "StelFileMgr.hpp"
 #include "StelModuleMgr.hpp"
-#include "StelIniParser.hpp"
+#include "StelIniCache.hpp"
 #include "Planet.hpp"
 #include "MinorPlanet.hpp"
 #include "Comet.hpp"
@@ -495,12 +495,15 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	StelSkyDrawer* skyDrawer = StelApp::getInstance().getCore()->getSkyDrawer();
 	qDebug() << "Loading from :"  << filePath;
 	int readOk = 0;
-	QSettings pd(filePath, StelIniFormat);
+	// The file is read through a binary copy in the cache, which is regenerated when the file changes
+	StelIniCache pd(filePath, StelFileMgr::getCacheDir()+"/ini");
 	if (pd.status() != QSettings::NoError)
 	{
 		qWarning() << "ERROR while parsing" << QDir::toNativeSeparators(filePath);
 		return false;
 	}
+	if (!pd.isLoadedFromCache())
+		qDebug() << "Compiled" << QDir::toNativeSeparators(filePath) << "to" << QDir::toNativeSeparators(pd.getCacheFilePath());
 
 	// QSettings does not allow us to say that the sections of the file
 	// will be listed in the same order  as in the file like the old
@@ -532,7 +535,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	//     i.e. [sun, earth, moon] is fine, but not [sun, moon, earth]
 	//
 	// Stage 3: iterate over the ordered sections decided in stage 2,
-	// creating the planet objects from the QSettings data.
+	// creating the planet objects from the ini data.
 
 	// Stage 1 (as described above).
 	QMap<QString, QString> secNameMap;
@@ -1287,10 +1290,12 @@ void SolarSystem::draw(StelCore* core)
 	float maxMagLabel = (core->getSkyDrawer()->getLimitMagnitude()<5.f ? core->getSkyDrawer()->getLimitMagnitude() :
 			5.f+(core->getSkyDrawer()->getLimitMagnitude()-5.f)*1.2f) +(labelsAmount-3.f)*1.2f;
 
-	// Draw the elements
-	foreach (const PlanetP& p, systemPlanets)
+	// Draw the elements. Faint point-like minor bodies are culled and drawn first in a single batch.
+	const QVector<bool>& batched = drawMinorBodyBatch(core, maxMagLabel);
+	for (int i=0; i<systemPlanets.size(); ++i)
 	{
-		p->draw(core, maxMagLabel, planetNameFont);
+		if (!batched.at(i))
+			systemPlanets.at(i)->draw(core, maxMagLabel, planetNameFont);
 	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer() && getFlagPointer())
@@ -1352,6 +1357,147 @@ void SolarSystem::draw(StelCore* core)
 	}
 }
 
+// The minor bodies which may be drawn as a point source only, as structure of arrays.
+// The arrays keep their capacity between frames.
+struct MinorBodyBatch
+{
+	//! For each of systemPlanets, whether it was culled or drawn in the batch
+	QVector<bool> batched;
+	//! Index in systemPlanets of the candidates
+	QVector<int> indices;
+	QVector<Vec3d> positions;
+	QVector<Vec3d> altAzPositions;
+	QVector<float> magnitudes;
+	QVector<float> extinctedMagnitudes;
+
+	void clear()
+	{
+		indices.resize(0);
+		positions.resize(0);
+		magnitudes.resize(0);
+	}
+};
+static MinorBodyBatch minorBodyBatch;
+
+const QVector<bool>& SolarSystem::drawMinorBodyBatch(StelCore* core, float maxMagLabel)
+{
+	MinorBodyBatch& b = minorBodyBatch;
+	b.clear();
+	b.batched.fill(false, systemPlanets.size());
+
+	StelSkyDrawer* drawer = core->getSkyDrawer();
+	const QString& observerPlanet = core->getCurrentLocation().planetName;
+	const QList<StelObjectP> selected = GETSTELMODULE(StelObjectMgr)->getSelectedObject();
+
+	// Select the minor bodies which Planet::draw() draws with nothing but a halo. Comets have tails,
+	// selected bodies a pointer, the others can have a visible orbit or label.
+	for (int i=0; i<systemPlanets.size(); ++i)
+	{
+		const Planet* p = systemPlanets.at(i).data();
+		if (p->pType<Planet::isAsteroid || p->pType==Planet::isComet || p->hidden || p->englishName==observerPlanet
+		    || p->orbitFader.getInterstate()>0.f || p->labelsFader || p->labelsFader.getInterstate()>0.f)
+			continue;
+		bool isSelected = false;
+		foreach (const StelObjectP& obj, selected)
+			isSelected = isSelected || obj.data()==p;
+		if (isSelected)
+			continue;
+		b.indices.append(i);
+		b.positions.append(p->getJ2000EquatorialPos(core));
+		b.magnitudes.append(p->getVMagnitude(core));
+	}
+
+	// Cull by magnitude like Planet::draw(), keep the remaining ones which don't need a label or a disk
+	const float limitMag = drawer->getLimitMagnitude();
+	const bool cullFaint = !observerPlanet.contains("Observer", Qt::CaseInsensitive);
+	const float pixPerRad = core->getProjection(StelCore::FrameJ2000)->getPixelPerRadAtCenter();
+	double eclipseFactor = -1.;
+	int n = 0;
+	for (int k=0; k<b.indices.size(); ++k)
+	{
+		const int i = b.indices.at(k);
+		const Planet* p = systemPlanets.at(i).data();
+		const float mag = b.magnitudes.at(k);
+		if (drawer->getFlagPlanetMagnitudeLimit() && mag>drawer->getCustomPlanetMagnitudeLimit())
+		{
+			if (eclipseFactor<0.)
+				eclipseFactor = getEclipseFactor(core);
+			if (eclipseFactor==1.0)
+			{
+				b.batched[i] = true;
+				continue;
+			}
+		}
+		if (cullFaint && mag-5.f>limitMag)
+		{
+			b.batched[i] = true;
+			continue;
+		}
+		if ((p->flagLabels && maxMagLabel>mag) || p->getAngularSize(core)*M_PI/180.*pixPerRad>1.)
+			continue;
+		b.indices[n] = i;
+		b.positions[n] = b.positions.at(k);
+		b.magnitudes[n] = mag;
+		++n;
+	}
+
+	b.extinctedMagnitudes = b.magnitudes.mid(0, n);
+	if (drawer->getFlagHasAtmosphere() && n>0)
+	{
+		b.altAzPositions.resize(n);
+		core->j2000ToAltAz(n, b.positions.constData(), b.altAzPositions.data(), StelCore::RefractionOff);
+		for (int k=0; k<n; ++k)
+			b.altAzPositions[k].normalize();
+		drawer->getExtinction().forward(n, b.altAzPositions.constData(), b.extinctedMagnitudes.data());
+	}
+
+	// Draw the halos as in Planet::draw3dModel() and StelSkyDrawer::postDrawSky3dModel().
+	// Bright bodies which would change the eye adaptation or fade the halo out are left to Planet::draw().
+	StelPainter sPainter(core->getProjection(StelCore::FrameJ2000));
+	const bool hideBehindParent = observerPlanet=="Earth";
+	const Vec3d sunPos = sun->getJ2000EquatorialPos(core);
+	const double sunSize = sun->getSpheroidAngularSize(core);
+	drawer->preDrawPointSource(&sPainter);
+	for (int k=0; k<n; ++k)
+	{
+		const int i = b.indices.at(k);
+		const Planet* p = systemPlanets.at(i).data();
+		const Vec3d& pos = b.positions.at(k);
+		const float mag = b.magnitudes.at(k);
+		const float extMag = b.extinctedMagnitudes.at(k);
+
+		bool allowDrawHalo = p->halo;
+		if (allowDrawHalo && hideBehindParent)
+		{
+			const bool sunParent = p->parent==sun;
+			const Vec3d par = sunParent ? sunPos : p->parent->getJ2000EquatorialPos(core);
+			const double parentSize = sunParent ? sunSize : p->parent->getSpheroidAngularSize(core);
+			allowDrawHalo = pos.angle(par)*180./M_PI>parentSize;
+		}
+		if (!allowDrawHalo)
+		{
+			b.batched[i] = true;
+			continue;
+		}
+
+		float surfArcMin2 = p->getSpheroidAngularSize(core)*60;
+		surfArcMin2 = surfArcMin2*surfArcMin2*M_PI;
+		const float pixRadius = std::sqrt(surfArcMin2/(60.*60.)*M_PI/180.*M_PI/180.*(pixPerRad*pixPerRad))/M_PI;
+		RCMag rcm;
+		drawer->computeRCMag(extMag, &rcm);
+		if (extMag<-15.f || pixRadius>3.f || rcm.radius>qMax(9.f, pixRadius*3.f))
+			continue;
+
+		b.batched[i] = true;
+		const float extinctedMag = extMag-mag;
+		const Vec3f color(p->haloColor[0], std::pow(0.85f, 0.6f*extinctedMag)*p->haloColor[1], std::pow(0.6f, 0.5f*extinctedMag)*p->haloColor[2]);
+		// Planets don't twinkle
+		drawer->drawPointSource(&sPainter, Vec3f(pos[0], pos[1], pos[2]), rcm, color, true, 0.f);
+	}
+	drawer->postDrawPointSource(&sPainter);
+	return b.batched;
+}
+
 PlanetP SolarSystem::searchByEnglishName(QString planetEnglishName) const
 {
 	foreach (const PlanetP& p, systemPlanets)
@@ -916,6 +916,10 @@ private:
 	//! Draw a nice animated pointer around the object.
 	void drawPointer(const StelCore* core);
 
+	//! Cull the minor bodies which Planet::draw() would draw only as a faint point source, and draw them in one batch.
+	//! @return for each of systemPlanets whether it was handled, the other ones need Planet::draw().
+	const QVector<bool>& drawMinorBodyBatch(StelCore* core, float maxMagLabel);
+
 	//! Load planet data from the Solar System configuration files.
 	//! This function attempts to load every possible instance of the
 	//! Solar System configuration files in the file paths, falling back if a
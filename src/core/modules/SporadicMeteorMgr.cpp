@@ -19,6 +19,7 @@
 
 #include "LandscapeMgr.hpp"
 #include "SolarSystem.hpp"
+#include "SporadicMeteor.hpp"
 #include "SporadicMeteorMgr.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
@@ -40,7 +41,6 @@ SporadicMeteorMgr::SporadicMeteorMgr(int zhr, int maxv)
 
 SporadicMeteorMgr::~SporadicMeteorMgr()
 {
-	qDeleteAll(activeMeteors);
 	activeMeteors.clear();
 	m_bolideTexture.clear();
 }
@@ -72,19 +72,11 @@ void SporadicMeteorMgr::update(double deltaTime)
 		return;
 	}
 
-	// step through and update all active meteors
-	foreach (SporadicMeteor* m, activeMeteors)
-	{
-		if (!m->update(deltaTime))
-		{
-			//important to delete when no longer active
-			delete m;
-			activeMeteors.removeOne(m);
-		}
-	}
-
 	StelCore* core = StelApp::getInstance().getCore();
 
+	// update all active meteors, removing the dead ones
+	activeMeteors.update(core, deltaTime);
+
 	// going forward/backward OR current ZHR is zero ?
 	// don't create new meteors
 	if(!core->getRealTimeSpeed() || m_zhr < 1)
@@ -105,15 +97,8 @@ void SporadicMeteorMgr::update(double deltaTime)
 		float prob = (float) qrand() / (float) RAND_MAX;
 		if (prob < rate)
 		{
-			SporadicMeteor* m = new SporadicMeteor(core, m_maxVelocity, m_bolideTexture);
-			if (m->isAlive())
-			{
-				activeMeteors.append(m);
-			}
-			else
-			{
-				delete m;
-			}
+			SporadicMeteor m(core, m_maxVelocity);
+			activeMeteors.add(m);
 		}
 	}
 }
@@ -131,12 +116,9 @@ void SporadicMeteorMgr::draw(StelCore* core)
 		return;
 	}
 
-	// step through and draw all active meteors
+	// draw all active meteors at once
 	StelPainter sPainter(core->getProjection(StelCore::FrameAltAz));
-	foreach (SporadicMeteor* m, activeMeteors)
-	{
-		m->draw(core, sPainter);
-	}
+	activeMeteors.draw(core, sPainter, m_bolideTexture);
 }
 
 void SporadicMeteorMgr::setZHR(int zhr)
@@ -20,8 +20,9 @@
 #ifndef _SPORADICMETEORMGR_HPP_
 #define _SPORADICMETEORMGR_HPP_
 
-#include "SporadicMeteor.hpp"
+#include "MeteorPool.hpp"
 #include "StelModule.hpp"
+#include "StelTextureTypes.hpp"
 
 //! @class SporadicMeteorMgr
 //! Simulates a sporadic meteor shower, with a random color and a random radiant.
@@ -69,7 +70,7 @@ signals:
 	void zhrChanged(int);
 
 private:
-	QList<SporadicMeteor*> activeMeteors;
+	MeteorPool activeMeteors;
 	StelTextureSP m_bolideTexture;
 	int m_zhr;
 	int m_maxVelocity;
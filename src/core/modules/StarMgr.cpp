@@ -40,8 +40,10 @@
 #include "StelCore.hpp"
 #include "StelIniParser.hpp"
 #include "StelPainter.hpp"
+#include "StelProfiler.hpp"
 #include "StelJsonParser.hpp"
 #include "ZoneArray.hpp"
+#include "StarWrapper.hpp"
 #include "StelSkyDrawer.hpp"
 #include "RefractionExtinction.hpp"
 #include "StelModuleMgr.hpp"
@@ -387,11 +389,8 @@ void StarMgr::copyDefaultConfigFile()
 	}
 }
 
-void StarMgr::init()
+void StarMgr::load()
 {
-	QSettings* conf = StelApp::getInstance().getSettings();
-	Q_ASSERT(conf);
-
 	starConfigFileFullPath = StelFileMgr::findFile("stars/default/starsConfig.json", StelFileMgr::Flags(StelFileMgr::Writable|StelFileMgr::File));
 	if (starConfigFileFullPath.isEmpty())
 	{
@@ -424,6 +423,12 @@ void StarMgr::init()
 
 	populateStarsDesignations();
 	populateHipparcosLists();
+}
+
+void StarMgr::init()
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	Q_ASSERT(conf);
 
 	starFont.setPixelSize(StelApp::getInstance().getBaseFontSize());
 
@@ -1169,6 +1174,7 @@ void StarMgr::draw(StelCore* core)
 		}
 		int zone;
 		
+		STEL_PROFILE_ZONE("StarMgr.drawZones");
 		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
 			z->draw(&sPainter, zone, true, rcmag_table, limitMagIndex, core, maxMagStarName, names_brightness, viewportCaps);
 		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
@@ -1306,6 +1312,12 @@ StelObjectP StarMgr::searchHP(int hp) const
 	return StelObjectP();
 }
 
+Vec3d StarMgr::getJ2000EquatorialPosAt(const StelObjectP& star, double jde)
+{
+	Q_ASSERT(star->getType()==STAR_TYPE);
+	return static_cast<const StarWrapperBase*>(star.data())->getJ2000EquatorialPosAt(jde);
+}
+
 StelObjectP StarMgr::searchByNameI18n(const QString& nameI18n) const
 {
 	QString objw = nameI18n.toUpper();
@@ -109,8 +109,11 @@ public:
 
 	///////////////////////////////////////////////////////////////////////////
 	// Methods defined in the StelModule class
+	//! Load the star catalogue data into memory, with the star designations.
+	//! This doesn't use the settings, OpenGL or other modules and can run in a worker thread.
+	virtual void load();
+
 	//! Initialize the StarMgr.
-	//! - Loads the star catalogue data into memory
 	//! - Sets up the star color table
 	//! - Loads the star texture
 	//! - Loads the star font (for labels on named stars)
@@ -118,6 +121,9 @@ public:
 	//! - Sets various display flags from the ini parser object
 	virtual void init();
 
+	//! The stars are registered in the StelObjectMgr.
+	virtual QStringList getInitDependencies() const {return QStringList("StelObjectMgr");}
+
 	//! Draw the stars and the star selection indicator if necessary.
 	virtual void draw(StelCore* core);
 
@@ -203,6 +209,12 @@ public:
 	//! one was not found.
 	StelObjectP searchHP(int hip) const;
 
+	//! Get the J2000 equatorial position of a star returned by searchHP() at the given date.
+	//! It does not use the StelCore, so it can be called from a worker thread.
+	//! @param star a star returned by searchHP().
+	//! @param jde the Julian Ephemeris Date of the position, for the proper motion.
+	static Vec3d getJ2000EquatorialPosAt(const StelObjectP& star, double jde);
+
 	//! Get the (translated) common name for a star with a specified
 	//! Hipparcos catalogue number.
 	//! @param hip The Hipparcos number of star
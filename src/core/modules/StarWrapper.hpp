@@ -42,6 +42,12 @@ template <class Star> struct SpecialZoneData;
 //! Another reason for having the StarWrapper is to encapsulate the differences between the different kinds of Stars (Star1,Star2,Star3).
 class StarWrapperBase : public StelObject
 {
+public:
+	//! Get the J2000 equatorial position of the star at the given date, with its proper motion.
+	//! Unlike getJ2000EquatorialPos(), it does not need the StelCore and can be called from any thread.
+	//! @param jde the Julian Ephemeris Date.
+	virtual Vec3d getJ2000EquatorialPosAt(double jde) const = 0;
+
 protected:
 	StarWrapperBase(void) : ref_count(0) {;}
 	virtual ~StarWrapperBase(void) {;}
@@ -75,10 +81,14 @@ protected:
 		const SpecialZoneData<Star> *z,
 		const Star *s) : a(a), z(z), s(s) {;}
 	Vec3d getJ2000EquatorialPos(const StelCore* core) const
+	{
+		return getJ2000EquatorialPosAt(core->getJDE());
+	}
+	Vec3d getJ2000EquatorialPosAt(double jde) const
 	{
 		static const double d2000 = 2451545.0;
 		Vec3f v;
-		s->getJ2000Pos(z, (M_PI/180.)*(0.0001/3600.) * ((core->getJDE()-d2000)/365.25) / a->star_position_scale, v);
+		s->getJ2000Pos(z, (M_PI/180.)*(0.0001/3600.) * ((jde-d2000)/365.25) / a->star_position_scale, v);
 		return Vec3d(v[0], v[1], v[2]);
 	}
 	Vec3f getInfoColor(void) const
@@ -53,6 +53,7 @@ void ToastMgr::init()
 	int toastLevel = conf->value("astro/toast_survey_levels", 11).toInt();	
 	survey = new ToastSurvey(toastHost+"/" + toastDir + "/{level}/{x}_{y}.jpg", toastLevel);
 	survey->setParent(this);
+	survey->setCacheBudget(conf->value("astro/toast_cache_size_mb", 64).toInt()*1024);
 
 	// Hide deep-sky survey by default
 	setFlagSurveyShow(conf->value("astro/flag_toast_survey", false).toBool());
@@ -73,6 +74,13 @@ void ToastMgr::draw(StelCore* core)
 
 	StelPainter sPainter(core->getProjection(StelCore::FrameJ2000));
 	survey->draw(&sPainter);
+
+	const QVariantMap statistics = getSurveyStatistics();
+	if (statistics!=lastStatistics)
+	{
+		lastStatistics = statistics;
+		emit surveyStatisticsChanged(statistics);
+	}
 }
 
 void ToastMgr::update(double deltaTime)
@@ -104,3 +112,19 @@ bool ToastMgr::getFlagSurveyShow() const
 {
 	return *fader;
 }
+
+QVariantMap ToastMgr::getSurveyStatistics() const
+{
+	QVariantMap map;
+	if (!survey)
+		return map;
+	const ToastSurvey::Statistics s = survey->getStatistics();
+	map["drawnTiles"] = s.drawnTiles;
+	map["cachedTiles"] = s.cachedTiles;
+	map["cacheCost"] = s.cacheCost;
+	map["cacheBudget"] = s.cacheBudget;
+	map["cacheHits"] = s.cacheHits;
+	map["cacheMisses"] = s.cacheMisses;
+	map["prefetchedTiles"] = s.prefetchedTiles;
+	return map;
+}
@@ -22,6 +22,8 @@
 
 #include "StelModule.hpp"
 
+#include <QVariantMap>
+
 class ToastMgr : public StelModule
 {
 	Q_OBJECT
@@ -29,6 +31,9 @@ class ToastMgr : public StelModule
 			READ getFlagSurveyShow
 			WRITE setFlagSurveyShow
 			NOTIFY surveyDisplayedChanged)
+	Q_PROPERTY(QVariantMap surveyStatistics
+			READ getSurveyStatistics
+			NOTIFY surveyStatisticsChanged)
 public:
 	ToastMgr();
 	virtual ~ToastMgr();
@@ -42,13 +47,20 @@ public:
 public slots:
 	void setFlagSurveyShow(bool displayed);
 	bool getFlagSurveyShow(void) const;
+	//! Return the tile cache counters of the survey: drawnTiles, cachedTiles, cacheCost and cacheBudget
+	//! (in kilobytes), cacheHits, cacheMisses and prefetchedTiles.
+	QVariantMap getSurveyStatistics() const;
 
 signals:
 	void surveyDisplayedChanged(const bool displayed) const;
+	//! Emitted after the survey was drawn, when its statistics changed since the last emission.
+	void surveyStatisticsChanged(const QVariantMap& statistics);
 
 private:
 	class ToastSurvey* survey;
 	class LinearFader* fader;
+	//! The statistics of the last surveyStatisticsChanged()
+	QVariantMap lastStatistics;
 };
 
 #endif // _TOASTMGR_HPP_
@@ -484,63 +484,92 @@ void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsid
 	}
 	Q_ASSERT(cutoffMagStep<RCMAG_TABLE_SIZE);
     
-	// Go through all stars, which are sorted by magnitude (bright stars first)
+	// Go through all stars, which are sorted by magnitude (bright stars first).
+	// They are processed in blocks, so that the extinction of a whole block is computed at once.
+	static const int BLOCK_SIZE = 64;
+	const Star* blockStars[BLOCK_SIZE];
+	Vec3f blockPos[BLOCK_SIZE];
+	Vec3f blockAltAz[BLOCK_SIZE];
+	float blockExtMag[BLOCK_SIZE];
 	const SpecialZoneData<Star>* zoneToDraw = getZones() + index;
 	const Star* lastStar = zoneToDraw->getStars() + zoneToDraw->size;
-	for (const Star* s=zoneToDraw->getStars();s<lastStar;++s)
+	const Star* s = zoneToDraw->getStars();
+	while (s<lastStar)
 	{
-		// Artifical cutoff per magnitude
-		if (s->getMag() > cutoffMagStep)
-			break;
-    
-		// Because of the test above, the star should always be visible from this point.
-		
-		// Array of 2 numbers containing radius and magnitude
-		const RCMag* tmpRcmag = &rcmag_table[s->getMag()];
-		
-		// Get the star position from the array
-		s->getJ2000Pos(zoneToDraw, movementFactor, vf);
-		
-		// If the star zone is not strictly contained inside the viewport, eliminate from the 
-		// beginning the stars actually outside viewport.
-		if (!isInsideViewport)
+		int count = 0;
+		for (; s<lastStar && count<BLOCK_SIZE; ++s)
 		{
-			vf.normalize();
-			bool isVisible = true;
-			foreach (const SphericalCap& cap, boundingCaps)
+			// Artifical cutoff per magnitude
+			if (s->getMag() > cutoffMagStep)
+			{
+				lastStar = s;
+				break;
+			}
+
+			// Because of the test above, the star should always be visible from this point.
+
+			// Get the star position from the array
+			s->getJ2000Pos(zoneToDraw, movementFactor, vf);
+
+			// If the star zone is not strictly contained inside the viewport, eliminate from the
+			// beginning the stars actually outside viewport.
+			if (!isInsideViewport)
 			{
-				if (!cap.contains(vf))
+				vf.normalize();
+				bool isVisible = true;
+				foreach (const SphericalCap& cap, boundingCaps)
 				{
-					isVisible = false;
-					continue;
+					if (!cap.contains(vf))
+					{
+						isVisible = false;
+						continue;
+					}
 				}
+				if (!isVisible)
+					continue;
 			}
-			if (!isVisible)
-				continue;
+			blockStars[count] = s;
+			blockPos[count] = vf;
+			++count;
 		}
 
-		int extinctedMagIndex = s->getMag();
-		float twinkleFactor=1.0f; // allow height-dependent twinkle.
 		if (withExtinction)
 		{
-			Vec3f altAz(vf);
-			altAz.normalize();
-			core->j2000ToAltAzInPlaceNoRefraction(&altAz);
-			float extMagShift=0.0f;
-			extinction.forward(altAz, &extMagShift);
-			extinctedMagIndex = s->getMag() + (int)(extMagShift/k);
-			if (extinctedMagIndex >= cutoffMagStep || extinctedMagIndex<0) // i.e., if extincted it is dimmer than cutoff or extinctedMagIndex is negative (missing star catalog), so remove
-				continue;
-			tmpRcmag = &rcmag_table[extinctedMagIndex];
-			twinkleFactor=qMin(1.0f, 1.0f-0.9f*altAz[2]); // suppress twinkling in higher altitudes. Keep 0.1 twinkle amount in zenith.
+			for (int i=0; i<count; ++i)
+			{
+				blockAltAz[i] = blockPos[i];
+				blockAltAz[i].normalize();
+				core->j2000ToAltAzInPlaceNoRefraction(&blockAltAz[i]);
+				blockExtMag[i] = 0.0f;
+			}
+			extinction.forward(count, blockAltAz, blockExtMag);
 		}
 
-		if (drawer->drawPointSource(sPainter, vf, *tmpRcmag, s->getBVIndex(), !isInsideViewport, twinkleFactor) && s->hasName() && extinctedMagIndex < maxMagStarName && s->hasComponentID()<=1)
+		for (int i=0; i<count; ++i)
 		{
-			const float offset = tmpRcmag->radius*0.7f;
-			const Vec3f colorr = StelSkyDrawer::indexToColor(s->getBVIndex())*0.75f;
-			sPainter->setColor(colorr[0], colorr[1], colorr[2],names_brightness);
-			sPainter->drawText(Vec3d(vf[0], vf[1], vf[2]), s->getNameI18n(), 0, offset, offset, false);
+			const Star* star = blockStars[i];
+			const Vec3f& pos = blockPos[i];
+
+			// Array of 2 numbers containing radius and magnitude
+			const RCMag* tmpRcmag = &rcmag_table[star->getMag()];
+			int extinctedMagIndex = star->getMag();
+			float twinkleFactor=1.0f; // allow height-dependent twinkle.
+			if (withExtinction)
+			{
+				extinctedMagIndex = star->getMag() + (int)(blockExtMag[i]/k);
+				if (extinctedMagIndex >= cutoffMagStep || extinctedMagIndex<0) // i.e., if extincted it is dimmer than cutoff or extinctedMagIndex is negative (missing star catalog), so remove
+					continue;
+				tmpRcmag = &rcmag_table[extinctedMagIndex];
+				twinkleFactor=qMin(1.0f, 1.0f-0.9f*blockAltAz[i][2]); // suppress twinkling in higher altitudes. Keep 0.1 twinkle amount in zenith.
+			}
+
+			if (drawer->drawPointSource(sPainter, pos, *tmpRcmag, star->getBVIndex(), !isInsideViewport, twinkleFactor) && star->hasName() && extinctedMagIndex < maxMagStarName && star->hasComponentID()<=1)
+			{
+				const float offset = tmpRcmag->radius*0.7f;
+				const Vec3f colorr = StelSkyDrawer::indexToColor(star->getBVIndex())*0.75f;
+				sPainter->setColor(colorr[0], colorr[1], colorr[2],names_brightness);
+				sPainter->drawText(Vec3d(pos[0], pos[1], pos[2]), star->getNameI18n(), 0, offset, offset, false);
+			}
 		}
 	}
 }
@@ -43,6 +43,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelMovementMgr.hpp"
 #include "StelPropertyMgr.hpp"
+#include "StelProfiler.hpp"
 
 #include "StelObject.hpp"
 #include "StelObjectMgr.hpp"
@@ -317,6 +318,28 @@ float StelMainScriptAPI::getMaxFps()
 	return StelMainView::getInstance().getMaxFps();
 }
 
+void StelMainScriptAPI::setProfilerEnabled(bool b)
+{
+	StelApp::getInstance().getProfiler()->setEnabled(b);
+}
+
+QVariantMap StelMainScriptAPI::getProfilerStatistics()
+{
+	return StelApp::getInstance().getProfiler()->getStatistics();
+}
+
+void StelMainScriptAPI::startProfilerTrace()
+{
+	StelApp::getInstance().getProfiler()->startTrace();
+}
+
+void StelMainScriptAPI::stopProfilerTrace(const QString& filename)
+{
+	StelProfiler* profiler = StelApp::getInstance().getProfiler();
+	profiler->stopTrace();
+	profiler->saveTrace(StelFileMgr::getUserDir() + "/" + filename);
+}
+
 QString StelMainScriptAPI::getMountMode()
 {
 	if (GETSTELMODULE(StelMovementMgr)->getMountMode() == StelMovementMgr::MountEquinoxEquatorial)
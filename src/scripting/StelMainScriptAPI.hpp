@@ -336,6 +336,30 @@ public slots:
 	//! @return The current maximum frames per second setting.
 	float getMaxFps();
 
+	//! Enable or disable the frame profiler, which measures the time spent in each module.
+	//! @param b if true, measure the frames.
+	void setProfilerEnabled(bool b);
+
+	//! Get the timings measured by the frame profiler during the last frames.
+	//! @return a map with an entry per module phase ("StarMgr.draw") or profiler zone, each being a map
+	//! with the "mean", "p50", "p95", "p99" and "max" time per frame in milliseconds.
+	//! @code
+	//! core.setProfilerEnabled(true);
+	//! core.wait(10);
+	//! var stats = core.getProfilerStatistics();
+	//! core.output("StarMgr.draw p95: " + stats["StarMgr.draw"]["p95"] + " ms");
+	//! @endcode
+	QVariantMap getProfilerStatistics();
+
+	//! Start recording a trace of the timings of all modules and profiler zones for each frame.
+	//! This enables the frame profiler.
+	void startProfilerTrace();
+
+	//! Stop recording the trace and save it in the Chrome trace event format.
+	//! The file can be viewed with chrome://tracing or https://ui.perfetto.dev
+	//! @param filename the name of the file in the user data directory.
+	void stopProfilerTrace(const QString& filename="trace.json");
+
 	//! Get the mount mode as a string
 	//! @return "equatorial" or "azimuthal"
 	QString getMountMode();
@@ -407,6 +431,7 @@ public slots:
 	QString getSkyCulture();
 
 	//! Set the current sky culture
+	//! The constellations of the new sky culture are loaded before the function returns.
 	//! @param id the ID of the sky culture to set, e.g. western or inuit etc.
 	void setSkyCulture(const QString& id);
 
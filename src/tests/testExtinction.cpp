@@ -43,3 +43,76 @@ void TestExtinction::testBase()
 	extCls.forward(vert, &mag);
 	QVERIFY(mag==2.25);
 }
+
+void TestExtinction::testBatch_data()
+{
+	QTest::addColumn<int>("mode");
+	QTest::newRow("zero") << (int)Extinction::UndergroundExtinctionZero;
+	QTest::newRow("max") << (int)Extinction::UndergroundExtinctionMax;
+	QTest::newRow("mirror") << (int)Extinction::UndergroundExtinctionMirror;
+}
+
+void TestExtinction::testBatch()
+{
+	QFETCH(int, mode);
+	Extinction extCls;
+	extCls.setExtinctionCoefficient(0.2f);
+	extCls.setUndergroundExtinctionMode((Extinction::UndergroundExtinctionMode)mode);
+
+	// From nadir to zenith, the batch must give exactly the same magnitudes
+	const int n = 10001;
+	QVector<Vec3d> pos(n);
+	QVector<Vec3f> posf(n);
+	QVector<float> mags(n), magsf(n);
+	for (int i=0; i<n; ++i)
+	{
+		const double alt = (-90.+180.*i/(n-1))*M_PI/180.;
+		pos[i].set(std::cos(alt), 0., std::sin(alt));
+		posf[i].set(std::cos(alt), 0.f, std::sin(alt));
+		mags[i] = magsf[i] = 0.01f*i;
+	}
+	extCls.forward(n, pos.constData(), mags.data());
+	extCls.forward(n, posf.constData(), magsf.data());
+	for (int i=0; i<n; ++i)
+	{
+		float mag = 0.01f*i;
+		extCls.forward(pos.at(i), &mag);
+		QCOMPARE(mags.at(i), mag);
+		mag = 0.01f*i;
+		extCls.forward(posf.at(i), &mag);
+		QCOMPARE(magsf.at(i), mag);
+	}
+}
+
+void TestExtinction::benchmarkForward_data()
+{
+	QTest::addColumn<bool>("batch");
+	QTest::newRow("forward") << false;
+	QTest::newRow("batch") << true;
+}
+
+void TestExtinction::benchmarkForward()
+{
+	QFETCH(bool, batch);
+	Extinction extCls;
+	extCls.setExtinctionCoefficient(0.2f);
+	const int n = 10000;
+	QVector<Vec3f> pos(n);
+	for (int i=0; i<n; ++i)
+	{
+		const float alt = (-10.f+100.f*i/n)*M_PI/180.f;
+		pos[i].set(std::cos(alt), 0.f, std::sin(alt));
+	}
+	QVector<float> mags(n, 0.f);
+
+	QBENCHMARK
+	{
+		if (batch)
+			extCls.forward(n, pos.constData(), mags.data());
+		else
+		{
+			for (int i=0; i<n; ++i)
+				extCls.forward(pos.at(i), &mags[i]);
+		}
+	}
+}
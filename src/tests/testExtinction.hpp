@@ -30,6 +30,10 @@ class TestExtinction : public QObject
 private slots:
 	void initTestCase();
 	void testBase();	
+	void testBatch_data();
+	void testBatch();
+	void benchmarkForward_data();
+	void benchmarkForward();
 };
 
 #endif // _TESTEXTINCTION_HPP_
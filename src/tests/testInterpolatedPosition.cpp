@@ -0,0 +1,167 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testInterpolatedPosition.hpp"
+#include "InterpolatedPosition.hpp"
+#include "LatencyHistogram.hpp"
+
+#include <QAtomicInt>
+#include <QThread>
+
+QTEST_GUILESS_MAIN(TestInterpolatedPosition)
+
+void TestInterpolatedPosition::testUnknown()
+{
+	InterpolatedPosition ip;
+	QVERIFY(!ip.isKnown());
+	QCOMPARE(ip.get(1000), Vec3d(0,0,0));
+}
+
+void TestInterpolatedPosition::testInterpolation()
+{
+	InterpolatedPosition ip;
+	Vec3d a(1,0,0);
+	Vec3d b(0,1,0);
+	ip.add(a, 1000, 1000);
+	ip.add(b, 2000, 2000);
+	QVERIFY(ip.isKnown());
+
+	const Vec3d mid = ip.get(1500);
+	QVERIFY(qAbs(mid[0]-std::sqrt(0.5))<1e-12);
+	QVERIFY(qAbs(mid[1]-std::sqrt(0.5))<1e-12);
+	QVERIFY(qAbs(mid[2])<1e-12);
+	// Outside of the received times, the last position
+	QCOMPARE(ip.get(3000), b);
+}
+
+void TestInterpolatedPosition::testReset()
+{
+	InterpolatedPosition ip;
+	Vec3d a(1,0,0);
+	ip.add(a, 1000, 1000);
+	ip.reset();
+	QVERIFY(!ip.isKnown());
+}
+
+void TestInterpolatedPosition::testChangesAfter()
+{
+	InterpolatedPosition ip;
+	QVERIFY(!ip.changesAfter(0));
+	Vec3d a(1,0,0);
+	Vec3d b(0,1,0);
+	// the first position makes the telescope appear
+	ip.add(a, 1000, 1000);
+	QVERIFY(ip.changesAfter(999));
+	QVERIFY(!ip.changesAfter(1000));
+	// the same position again changes nothing
+	ip.add(a, 2000, 2000);
+	QVERIFY(!ip.changesAfter(1500));
+	// a new position is interpolated from the previous one
+	ip.add(b, 3000, 3000);
+	QVERIFY(ip.changesAfter(1500));
+	QVERIFY(ip.changesAfter(2999));
+	QVERIFY(!ip.changesAfter(3000));
+	// until the pair holding different positions is older than the time
+	for (int i=0; i<20; ++i)
+		ip.add(b, 4000+i, 4000+i);
+	QVERIFY(!ip.changesAfter(0));
+}
+
+namespace
+{
+	const double GENERATION_ANGLE = M_PI/6.;
+
+	//! Fills the positions again and again as fast as possible, like a client thread flooded by a
+	//! server. All the positions of a generation are the same.
+	class Writer : public QThread
+	{
+	public:
+		Writer(InterpolatedPosition& ip) : ip(ip), generations(0) {}
+		InterpolatedPosition& ip;
+		QAtomicInt stop;
+		int generations;
+	protected:
+		void run()
+		{
+			while (!stop.load())
+			{
+				const double a = GENERATION_ANGLE*(generations%12);
+				Vec3d pos(std::cos(a), std::sin(a), 0.);
+				ip.reset();
+				for (int i=0; i<16; ++i)
+					ip.add(pos, 1000+i, 1000+i);
+				++generations;
+			}
+		}
+	};
+}
+
+void TestInterpolatedPosition::testConcurrentWriter()
+{
+	InterpolatedPosition ip;
+	Writer writer(ip);
+	writer.start();
+	// A torn copy would interpolate between positions of different generations
+	for (int i=0; i<200000; ++i)
+	{
+		const Vec3d pos = ip.get(1000+i%16);
+		if (pos==Vec3d(0,0,0))
+			continue;
+		const double a = std::atan2(pos[1], pos[0])/GENERATION_ANGLE;
+		QVERIFY(qAbs(a-qRound(a))<1e-9);
+		QVERIFY(qAbs(pos[2])<1e-12);
+	}
+	writer.stop.store(1);
+	writer.wait();
+	QVERIFY(writer.generations>0);
+}
+
+void TestInterpolatedPosition::testHistogramBuckets()
+{
+	QCOMPARE(LatencyHistogram::bucketOf(-5), 0);
+	QCOMPARE(LatencyHistogram::bucketOf(1), 0);
+	QCOMPARE(LatencyHistogram::bucketOf(2), 1);
+	QCOMPARE(LatencyHistogram::bucketOf(3), 1);
+	QCOMPARE(LatencyHistogram::bucketOf(4), 2);
+	QCOMPARE(LatencyHistogram::bucketOf(1000), 9);
+	QCOMPARE(LatencyHistogram::bucketOf(Q_INT64_C(1)<<40), int(LatencyHistogram::BucketCount)-1);
+	QCOMPARE(LatencyHistogram::bucketLimit(9), Q_INT64_C(1024));
+}
+
+void TestInterpolatedPosition::testHistogramPercentile()
+{
+	LatencyHistogram h;
+	QCOMPARE(h.count(), 0);
+	QCOMPARE(h.percentile(0.5), Q_INT64_C(0));
+	QCOMPARE(h.toString(), QString("n=0"));
+
+	for (int i=0; i<90; ++i)
+		h.record(1000);
+	for (int i=0; i<10; ++i)
+		h.record(100000);
+	QCOMPARE(h.count(), 100);
+	QCOMPARE(h.bucketCount(9), 90);
+	QCOMPARE(h.percentile(0.5), Q_INT64_C(1024));
+	QCOMPARE(h.percentile(0.9), Q_INT64_C(1024));
+	QCOMPARE(h.percentile(0.99), Q_INT64_C(131072));
+	QCOMPARE(h.toString(), QString("n=100 p50<1024us p90<1024us p99<131ms max<131ms"));
+
+	h.reset();
+	QCOMPARE(h.count(), 0);
+}
@@ -0,0 +1,191 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testLandscapeHorizonProfile.hpp"
+#include "StelFileMgr.hpp"
+
+#include <QFile>
+#include <QStandardPaths>
+
+QTEST_GUILESS_MAIN(TestLandscapeHorizonProfile)
+
+static const QString LANDSCAPE_ID = "testLandscapeHorizonProfile";
+
+//! The horizon of the test landscapes, a smooth hill
+static double horizonAltitude(double az)
+{
+	return 0.1 + 0.2*std::sin(az);
+}
+
+//! Opaque below the horizon, transparent above
+struct HillSampler
+{
+	float operator()(const Vec3d& azalt) const
+	{
+		double az, alt;
+		StelUtils::rectToSphe(&az, &alt, azalt);
+		return alt<horizonAltitude(az) ? 1.f : 0.f;
+	}
+};
+
+//! Like HillSampler, with a semi-transparent cloud of foliage above the horizon
+struct TreeSampler
+{
+	float operator()(const Vec3d& azalt) const
+	{
+		double az, alt;
+		StelUtils::rectToSphe(&az, &alt, azalt);
+		if (alt<horizonAltitude(az))
+			return 1.f;
+		if (az>0.5 && az<1.0 && alt>0.6 && alt<0.9)
+			return 0.3f;
+		return 0.f;
+	}
+};
+
+QString TestLandscapeHorizonProfile::cacheFilePath()
+{
+	return StelFileMgr::getCacheDir() + "/landscapes/" + LANDSCAPE_ID + ".horizon";
+}
+
+void TestLandscapeHorizonProfile::initTestCase()
+{
+	// Don't write in the cache of the user
+	QStandardPaths::setTestModeEnabled(true);
+	QFile::remove(cacheFilePath());
+}
+
+void TestLandscapeHorizonProfile::cleanupTestCase()
+{
+	QFile::remove(cacheFilePath());
+}
+
+void TestLandscapeHorizonProfile::testAltitudeProfile()
+{
+	LandscapeHorizonProfile profile;
+	QVERIFY(!profile.isValid());
+	profile.build(HillSampler());
+	QVERIFY(profile.isValid());
+	// The landscape is described by its altitudes alone
+	QVERIFY(!profile.hasMask());
+
+	for (double az=-3.1; az<3.1; az+=0.1)
+	{
+		QVERIFY(qAbs(profile.getHorizonAltitude(az)-horizonAltitude(az))<0.002);
+		Vec3d dir;
+		StelUtils::spheToRect(az, horizonAltitude(az)+0.01, dir);
+		QCOMPARE(profile.getOpacity(dir), 0.f);
+		QVERIFY(profile.isAboveHorizon(dir));
+		StelUtils::spheToRect(az, horizonAltitude(az)-0.01, dir);
+		QCOMPARE(profile.getOpacity(dir), 1.f);
+		QVERIFY(!profile.isAboveHorizon(dir));
+	}
+	// Straight up and down
+	QCOMPARE(profile.getOpacity(Vec3d(0., 0., 1.)), 0.f);
+	QCOMPARE(profile.getOpacity(Vec3d(0., 0., -1.)), 1.f);
+}
+
+void TestLandscapeHorizonProfile::testMask()
+{
+	LandscapeHorizonProfile profile;
+	profile.build(TreeSampler());
+	QVERIFY(profile.isValid());
+	QVERIFY(profile.hasMask());
+
+	Vec3d dir;
+	// In the foliage
+	StelUtils::spheToRect(0.75, 0.75, dir);
+	QVERIFY(qAbs(profile.getOpacity(dir)-0.3f)<0.01f);
+	QVERIFY(profile.isAboveHorizon(dir));
+	// Free sky and ground elsewhere
+	StelUtils::spheToRect(-2., 1., dir);
+	QCOMPARE(profile.getOpacity(dir), 0.f);
+	StelUtils::spheToRect(-2., horizonAltitude(-2.)-0.05, dir);
+	QCOMPARE(profile.getOpacity(dir), 1.f);
+	QVERIFY(profile.getMemorySize()>(unsigned int)(LandscapeHorizonProfile::MASK_WIDTH*LandscapeHorizonProfile::MASK_HEIGHT));
+}
+
+void TestLandscapeHorizonProfile::testCacheRoundTrip()
+{
+	const QByteArray signature("tree:1");
+	LandscapeHorizonProfile profile;
+	profile.build(TreeSampler());
+	QVERIFY(profile.saveToCache(LANDSCAPE_ID, signature));
+	QVERIFY(QFile::exists(cacheFilePath()));
+
+	LandscapeHorizonProfile loaded;
+	QVERIFY(loaded.loadFromCache(LANDSCAPE_ID, signature));
+	QVERIFY(loaded.isValid());
+	QCOMPARE(loaded.hasMask(), profile.hasMask());
+	QCOMPARE(loaded.getMemorySize(), profile.getMemorySize());
+	Vec3d dir;
+	for (double az=-3.1; az<3.1; az+=0.05)
+	{
+		QCOMPARE(loaded.getHorizonAltitude(az), profile.getHorizonAltitude(az));
+		for (double alt=-1.5; alt<1.5; alt+=0.05)
+		{
+			StelUtils::spheToRect(az, alt, dir);
+			QCOMPARE(loaded.getOpacity(dir), profile.getOpacity(dir));
+		}
+	}
+}
+
+void TestLandscapeHorizonProfile::testCacheSignature()
+{
+	LandscapeHorizonProfile profile;
+	profile.build(HillSampler());
+	QVERIFY(profile.saveToCache(LANDSCAPE_ID, "hill:1"));
+
+	// The sources of the landscape changed
+	LandscapeHorizonProfile loaded;
+	QVERIFY(!loaded.loadFromCache(LANDSCAPE_ID, "hill:2"));
+	QVERIFY(!loaded.isValid());
+	QVERIFY(!loaded.loadFromCache("noSuchLandscape", "hill:1"));
+	QVERIFY(loaded.loadFromCache(LANDSCAPE_ID, "hill:1"));
+	QVERIFY(!loaded.hasMask());
+}
+
+void TestLandscapeHorizonProfile::testDamagedCache()
+{
+	LandscapeHorizonProfile profile;
+	profile.build(HillSampler());
+	QVERIFY(profile.saveToCache(LANDSCAPE_ID, "hill:1"));
+
+	QFile file(cacheFilePath());
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.resize(file.size()/2));
+	file.close();
+
+	LandscapeHorizonProfile loaded;
+	QVERIFY(!loaded.loadFromCache(LANDSCAPE_ID, "hill:1"));
+	QVERIFY(!loaded.isValid());
+}
+
+void TestLandscapeHorizonProfile::testInvalidNotCached()
+{
+	QFile::remove(cacheFilePath());
+	LandscapeHorizonProfile profile;
+	QVERIFY(!profile.saveToCache(LANDSCAPE_ID, "empty"));
+	QVERIFY(!QFile::exists(cacheFilePath()));
+
+	profile.build(HillSampler());
+	profile.clear();
+	QVERIFY(!profile.isValid());
+	QVERIFY(!profile.saveToCache(LANDSCAPE_ID, "empty"));
+}
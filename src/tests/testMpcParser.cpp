@@ -0,0 +1,289 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+#include "tests/testMpcParser.hpp"
+#include "MpcParser.hpp"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThreadPool>
+
+QTEST_GUILESS_MAIN(TestMpcParser)
+
+// About 2 MB, so that the parse is split in several chunks
+static const int MPCORB_LINES = 10000;
+
+QByteArray TestMpcParser::minorPlanetLine(int number, double absoluteMagnitude, double semiMajorAxis, double eccentricity)
+{
+	char line[256];
+	// Columns 1-103 of the format, then the fields which are not read
+	int length = qsnprintf(line, sizeof(line), "%05d   %5.2f  0.15 K205V %9.5f  %9.5f  %9.5f  %9.5f  %9.7f %11.8f %11.7f"
+			       "  0 MPO492748  6751 115 1801-2019 0.60 M-v 30h Williams   0000",
+			       number, absoluteMagnitude, (number*7)%360+0.5, (number*11)%360+0.25, (number*13)%360+0.125,
+			       (number%40)+0.5, eccentricity, 0.21406009, semiMajorAxis);
+	QByteArray result(line, length);
+	result = result.leftJustified(166, ' ');
+	result += QString("(%1) Body %1").arg(number).toLatin1().leftJustified(28, ' ');
+	result += "20190915";
+	return result;
+}
+
+void TestMpcParser::initTestCase()
+{
+	mpcorb = "MINOR PLANET CENTER ORBIT DATABASE (MPCORB)\n\n"
+		 "Des'n     H     G   Epoch     M        Peri.      Node       Incl.       e            n           a"
+		 "        Reference #Obs #Opp    Arc    rms  Perts   Computer\n"
+		 "----------------------------------------------------------------------------------------------------\n";
+	for (int i=1; i<=MPCORB_LINES; ++i)
+	{
+		mpcorb += minorPlanetLine(i, 3.+(i%190)*0.1, 1.5+(i%50), 0.01*(i%90));
+		mpcorb += (i%2 ? "\r\n" : "\n");
+	}
+}
+
+void TestMpcParser::testComets()
+{
+	// Lines of Soft00Cmt.txt, some with less decimals than the specification
+	MpcParser::Elements e;
+	const QByteArray haleBopp("    CJ95O010  1997 03 31.4141  0.906507  0.994945  130.5321  282.6820   89.3193  20100723  -2.0  4.0  C/1995 O1 (Hale-Bopp)                                    MPC 61436");
+	QVERIFY(MpcParser::parseLine(haleBopp.constData(), haleBopp.size(), MpcParser::CometFormat, e));
+	QCOMPARE(e.name, QString("C/1995 O1 (Hale-Bopp)"));
+	QCOMPARE(e.orbitClass, MpcParser::Comet);
+	QCOMPARE(e.minorPlanetNumber, 0);
+	QCOMPARE(e.absoluteMagnitude, -2.0);
+	QCOMPARE(e.slopeParameter, 4.0);
+	QCOMPARE(e.pericenterDistance, 0.906507);
+	QCOMPARE(e.eccentricity, 0.994945);
+	QCOMPARE(e.argumentOfPericenter, 130.5321);
+	QCOMPARE(e.ascendingNode, 282.6820);
+	QCOMPARE(e.inclination, 89.3193);
+	// 1997-03-31 09:56:18 UTC
+	QVERIFY(qAbs(e.timeAtPericenter - 2450538.9141) < 1./86400.);
+
+	const QByteArray beshore("    CK09K030  2011 01  9.266   3.90156   1.00000   251.413     0.032   146.680              8.5  4.0  C/2009 K3 (Beshore)                                      MPC 66205");
+	QVERIFY(MpcParser::parseLine(beshore.constData(), beshore.size(), MpcParser::CometFormat, e));
+	QCOMPARE(e.name, QString("C/2009 K3 (Beshore)"));
+	QCOMPARE(e.eccentricity, 1.0);
+	QCOMPARE(e.ascendingNode, 0.032);
+
+	// Fragments
+	const QByteArray machholz("0141P      d  2010 05 29.7106  0.757809  0.749215  149.3298  246.0849   12.8032  20100723  12.0 12.0  141P/Machholz                                            MPC 59599");
+	QVERIFY(MpcParser::parseLine(machholz.constData(), machholz.size(), MpcParser::CometFormat, e));
+	QCOMPARE(e.name, QString("141P/Machholz D"));
+	QCOMPARE(e.slopeParameter, 12.0);
+}
+
+void TestMpcParser::testMinorPlanets()
+{
+	MpcParser::Elements e;
+	const QByteArray ceres("00001    3.34  0.12 K205V 162.68631   73.73161   80.28698   10.58862  0.0775571  0.21406009   2.7676569  0 MPO492748  6751 115 1801-2019 0.60 M-v 30h Williams   0000      (1) Ceres              20190915");
+	QVERIFY(MpcParser::parseLine(ceres.constData(), ceres.size(), MpcParser::MinorPlanetFormat, e));
+	QCOMPARE(e.name, QString("Ceres"));
+	QCOMPARE(e.minorPlanetNumber, 1);
+	QVERIFY(e.hasReadableName);
+	QCOMPARE(e.orbitClass, MpcParser::Asteroid);
+	QCOMPARE(e.absoluteMagnitude, 3.34);
+	QCOMPARE(e.slopeParameter, 0.12);
+	QCOMPARE(e.meanAnomaly, 162.68631);
+	QCOMPARE(e.argumentOfPericenter, 73.73161);
+	QCOMPARE(e.ascendingNode, 80.28698);
+	QCOMPARE(e.inclination, 10.58862);
+	QCOMPARE(e.eccentricity, 0.0775571);
+	QCOMPARE(e.meanMotion, 0.21406009);
+	QCOMPARE(e.semiMajorAxis, 2.7676569);
+	// K205V is 2020-05-31.0 TT
+	QCOMPARE(e.epoch, 2459000.5);
+
+	// Short format, without the readable designation
+	const QByteArray provisional = ceres.left(160).replace(0, 7, "K07Tf8A");
+	QVERIFY(MpcParser::parseLine(provisional.constData(), provisional.size(), MpcParser::MinorPlanetFormat, e));
+	QCOMPARE(e.name, QString("2007 TA418"));
+	QCOMPARE(e.minorPlanetNumber, 0);
+	QVERIFY(!e.hasReadableName);
+
+	// Packed numbers
+	QByteArray packed = minorPlanetLine(1, 15., 2.5, 0.1).replace(0, 7, "A0345  ");
+	QVERIFY(MpcParser::parseLine(packed.constData(), packed.size(), MpcParser::MinorPlanetFormat, e));
+	QCOMPARE(e.minorPlanetNumber, 100345);
+	packed.replace(0, 7, "~0001  ");
+	QVERIFY(MpcParser::parseLine(packed.constData(), packed.size(), MpcParser::MinorPlanetFormat, e));
+	QCOMPARE(e.minorPlanetNumber, 620001);
+
+	// Orbit classes
+	const QByteArray plutino = minorPlanetLine(2, 7., 39.5, 0.25);
+	QVERIFY(MpcParser::parseLine(plutino.constData(), plutino.size(), MpcParser::MinorPlanetFormat, e));
+	QCOMPARE(e.orbitClass, MpcParser::Plutino);
+	const QByteArray cubewano = minorPlanetLine(3, 7., 44., 0.25);
+	QVERIFY(MpcParser::parseLine(cubewano.constData(), cubewano.size(), MpcParser::MinorPlanetFormat, e));
+	QCOMPARE(e.orbitClass, MpcParser::Cubewano);
+	const QByteArray sednoid = minorPlanetLine(4, 1.5, 506., 0.85);
+	QVERIFY(MpcParser::parseLine(sednoid.constData(), sednoid.size(), MpcParser::MinorPlanetFormat, e));
+	QCOMPARE(e.orbitClass, MpcParser::Sednoid);
+	QCOMPARE(MpcParser::getOrbitClassName(e.orbitClass), QString("sednoid"));
+}
+
+void TestMpcParser::testInvalidLines()
+{
+	MpcParser::Elements e;
+	const QByteArray valid = minorPlanetLine(1, 15., 2.5, 0.1);
+	QVERIFY(MpcParser::parseLine(valid.constData(), valid.size(), MpcParser::MinorPlanetFormat, e));
+
+	const QByteArray tooShort = valid.left(120);
+	QVERIFY(!MpcParser::parseLine(tooShort.constData(), tooShort.size(), MpcParser::MinorPlanetFormat, e));
+	const QByteArray noMagnitude = QByteArray(valid).replace(8, 5, "     ");
+	QVERIFY(!MpcParser::parseLine(noMagnitude.constData(), noMagnitude.size(), MpcParser::MinorPlanetFormat, e));
+	const QByteArray badNumber = QByteArray(valid).replace(37, 9, " 73.7x161");
+	QVERIFY(!MpcParser::parseLine(badNumber.constData(), badNumber.size(), MpcParser::MinorPlanetFormat, e));
+	const QByteArray badEpoch = QByteArray(valid).replace(20, 5, "K202U");
+	QVERIFY(!MpcParser::parseLine(badEpoch.constData(), badEpoch.size(), MpcParser::MinorPlanetFormat, e));
+	const QByteArray badDesignation = QByteArray(valid).replace(0, 7, "X07Tf8A");
+	QVERIFY(!MpcParser::parseLine(badDesignation.constData(), badDesignation.size(), MpcParser::MinorPlanetFormat, e));
+
+	// A comet line is not a minor planet line and vice versa
+	const QByteArray comet("    CK10R010  2011 11 28.457   6.66247   1.00000    96.009   345.949   157.437              6.0  4.0  C/2010 R1 (LINEAR)                                       MPEC 2010-R99");
+	QVERIFY(MpcParser::parseLine(comet.constData(), comet.size(), MpcParser::CometFormat, e));
+	QVERIFY(!MpcParser::parseLine(comet.constData(), comet.size(), MpcParser::MinorPlanetFormat, e));
+	QVERIFY(!MpcParser::parseLine(valid.constData(), valid.size(), MpcParser::CometFormat, e));
+	const QByteArray noDesignation = QByteArray(comet).replace(5, 7, "       ");
+	QVERIFY(!MpcParser::parseLine(noDesignation.constData(), noDesignation.size(), MpcParser::CometFormat, e));
+}
+
+void TestMpcParser::testProvisionalDesignations()
+{
+	// Examples of http://www.minorplanetcenter.org/iau/info/PackedDes.html
+	const char* packed[] = {"J95X00A", "J95X01L", "J95F13B", "J98SA8Q", "J98SC7V", "J98SG2S", "K99AJ3Z", "K08Aa0A", "K07Tf8A",
+				"PLS2040", "T1S3138", "T2S1010", "T3S4101", "J95X0AL", "J9XX01L", "PL2040"};
+	const char* unpacked[] = {"1995 XA", "1995 XL1", "1995 FB13", "1998 SQ108", "1998 SV127", "1998 SS162", "2099 AZ193", "2008 AA360", "2007 TA418",
+				  "2040 P-L", "3138 T-1", "1010 T-2", "4101 T-3", "", "", ""};
+	for (unsigned int i=0; i<sizeof(packed)/sizeof(packed[0]); ++i)
+	{
+		QCOMPARE(MpcParser::unpackMinorPlanetProvisionalDesignation(packed[i], qstrlen(packed[i])), QString(unpacked[i]));
+	}
+}
+
+void TestMpcParser::testParallelParse()
+{
+	QVector<MpcParser::Elements> elements;
+	MpcParser::Statistics statistics;
+	MpcParser::parse(mpcorb.constData(), mpcorb.size(), MpcParser::MinorPlanetFormat, MpcParser::Filter(), elements, &statistics);
+	QCOMPARE(statistics.lineCount, MPCORB_LINES+3);
+	QCOMPARE(statistics.invalidCount, 3);
+	QCOMPARE(statistics.filteredCount, 0);
+	QCOMPARE(elements.size(), MPCORB_LINES);
+	// The order of the lines is kept across the chunks
+	for (int i=0; i<elements.size(); ++i)
+	{
+		QCOMPARE(elements.at(i).minorPlanetNumber, i+1);
+		QCOMPARE(elements.at(i).name, QString("Body %1").arg(i+1));
+	}
+
+	// The same as parsing the lines one at a time
+	const QList<QByteArray> lines = mpcorb.split('\n');
+	int n = 0;
+	foreach (QByteArray line, lines)
+	{
+		if (line.endsWith('\r'))
+			line.chop(1);
+		MpcParser::Elements e;
+		if (!MpcParser::parseLine(line.constData(), line.size(), MpcParser::MinorPlanetFormat, e))
+			continue;
+		QVERIFY(n<elements.size());
+		QCOMPARE(elements.at(n).absoluteMagnitude, e.absoluteMagnitude);
+		QCOMPARE(elements.at(n).semiMajorAxis, e.semiMajorAxis);
+		QCOMPARE(elements.at(n).epoch, e.epoch);
+		++n;
+	}
+	QCOMPARE(n, elements.size());
+
+	// Appended to the existing elements
+	MpcParser::parse(mpcorb.constData(), mpcorb.size(), MpcParser::MinorPlanetFormat, MpcParser::Filter(), elements);
+	QCOMPARE(elements.size(), 2*MPCORB_LINES);
+}
+
+void TestMpcParser::testFilter()
+{
+	MpcParser::Filter filter;
+	filter.maxAbsoluteMagnitude = 10.;
+	QVector<MpcParser::Elements> elements;
+	MpcParser::Statistics statistics;
+	MpcParser::parse(mpcorb.constData(), mpcorb.size(), MpcParser::MinorPlanetFormat, filter, elements, &statistics);
+	QVERIFY(!elements.isEmpty());
+	QCOMPARE(elements.size() + statistics.filteredCount + statistics.invalidCount, statistics.lineCount);
+	foreach (const MpcParser::Elements& e, elements)
+		QVERIFY(e.absoluteMagnitude<=10.);
+
+	filter = MpcParser::Filter();
+	filter.orbitClasses = MpcParser::Plutino | MpcParser::Cubewano;
+	elements.clear();
+	MpcParser::parse(mpcorb.constData(), mpcorb.size(), MpcParser::MinorPlanetFormat, filter, elements, &statistics);
+	int expected = 0;
+	for (int i=1; i<=MPCORB_LINES; ++i)
+	{
+		const QByteArray line = minorPlanetLine(i, 3.+(i%190)*0.1, 1.5+(i%50), 0.01*(i%90));
+		MpcParser::Elements e;
+		QVERIFY(MpcParser::parseLine(line.constData(), line.size(), MpcParser::MinorPlanetFormat, e));
+		if (e.orbitClass==MpcParser::Plutino || e.orbitClass==MpcParser::Cubewano)
+			++expected;
+	}
+	QVERIFY(expected>0);
+	QCOMPARE(elements.size(), expected);
+	foreach (const MpcParser::Elements& e, elements)
+		QVERIFY(e.orbitClass==MpcParser::Plutino || e.orbitClass==MpcParser::Cubewano);
+}
+
+void TestMpcParser::testParseFile()
+{
+	QTemporaryDir tempDir;
+	QVERIFY(tempDir.isValid());
+	const QString path = tempDir.path()+"/MPCORB.DAT";
+	QFile file(path);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write(mpcorb);
+	file.close();
+
+	QVector<MpcParser::Elements> elements;
+	MpcParser::Statistics statistics;
+	QVERIFY(MpcParser::parseFile(path, MpcParser::MinorPlanetFormat, MpcParser::Filter(), elements, &statistics));
+	QCOMPARE(elements.size(), MPCORB_LINES);
+	QCOMPARE(statistics.lineCount, MPCORB_LINES+3);
+
+	QVERIFY(!MpcParser::parseFile(tempDir.path()+"/missing.dat", MpcParser::MinorPlanetFormat, MpcParser::Filter(), elements));
+}
+
+void TestMpcParser::benchmarkParse()
+{
+	QBENCHMARK
+	{
+		QVector<MpcParser::Elements> elements;
+		MpcParser::parse(mpcorb.constData(), mpcorb.size(), MpcParser::MinorPlanetFormat, MpcParser::Filter(), elements);
+		QCOMPARE(elements.size(), MPCORB_LINES);
+	}
+}
+
+void TestMpcParser::benchmarkParseOneThread()
+{
+	const int threads = QThreadPool::globalInstance()->maxThreadCount();
+	QThreadPool::globalInstance()->setMaxThreadCount(1);
+	QBENCHMARK
+	{
+		QVector<MpcParser::Elements> elements;
+		MpcParser::parse(mpcorb.constData(), mpcorb.size(), MpcParser::MinorPlanetFormat, MpcParser::Filter(), elements);
+		QCOMPARE(elements.size(), MPCORB_LINES);
+	}
+	QThreadPool::globalInstance()->setMaxThreadCount(threads);
+}
@@ -0,0 +1,49 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+#ifndef _TESTMPCPARSER_HPP_
+#define _TESTMPCPARSER_HPP_
+
+#include <QByteArray>
+#include <QObject>
+#include <QTest>
+
+//! Tests and throughput benchmarks of the MPC one-line format parser of the Solar System Editor
+class TestMpcParser : public QObject
+{
+Q_OBJECT
+private slots:
+	void initTestCase();
+	void testComets();
+	void testMinorPlanets();
+	void testInvalidLines();
+	void testProvisionalDesignations();
+	void testParallelParse();
+	void testFilter();
+	void testParseFile();
+	void benchmarkParse();
+	void benchmarkParseOneThread();
+private:
+	//! Build a line in the minor planet format, with the name in the readable designation column
+	static QByteArray minorPlanetLine(int number, double absoluteMagnitude, double semiMajorAxis, double eccentricity);
+
+	//! Lines similar to MPCORB.DAT, with its header
+	QByteArray mpcorb;
+};
+
+#endif // _TESTMPCPARSER_HPP_
@@ -196,3 +196,120 @@ void TestRefraction::testComplexRefraction()
 							.toUtf8());
 	}
 }
+
+// Angle between two vectors in arcseconds
+static double angleArcsec(const Vec3d& a, const Vec3d& b)
+{
+	return std::atan2((a^b).length(), a.dot(b))*180./M_PI*3600.;
+}
+
+void TestRefraction::testBatchForward()
+{
+	// The tables must follow the atmosphere parameters
+	const float pressures[] = {1013.f, 1050.f, 800.f};
+	const float temperatures[] = {10.f, -30.f, 35.f};
+	const double acceptableError = 0.03; // arcseconds
+	for (int p=0; p<3; ++p)
+	{
+		Refraction refCls;
+		refCls.setPressure(pressures[p]);
+		refCls.setTemperature(temperatures[p]);
+
+		// Altitudes from below the transition zone to the zenith, over all azimuths, with various vector lengths
+		const int n = 100000;
+		QVector<Vec3d> in(n), batch(n);
+		QVector<Vec3f> batchf(n);
+		for (int i=0; i<n; ++i)
+		{
+			const double alt = (-6.+96.*i/(n-1))*M_PI/180.;
+			StelUtils::spheToRect(0.001*i, alt, in[i]);
+			in[i] *= 1.+(i%7);
+			batch[i] = in[i];
+			batchf[i].set(in[i][0], in[i][1], in[i][2]);
+		}
+		refCls.forward(n, batch.data());
+		refCls.forward(n, batchf.data());
+
+		double maxError = 0., maxErrorf = 0.;
+		for (int i=0; i<n; ++i)
+		{
+			Vec3d v(in.at(i));
+			refCls.forward(v);
+			QVERIFY(qAbs(batch.at(i).length()-in.at(i).length()) < 1e-12*in.at(i).length());
+			maxError = qMax(maxError, angleArcsec(v, batch.at(i)));
+			maxErrorf = qMax(maxErrorf, angleArcsec(v, Vec3d(batchf.at(i)[0], batchf.at(i)[1], batchf.at(i)[2])));
+			// Nothing happens below the transition zone
+			if (i < n/100)
+				QVERIFY(batch.at(i) == in.at(i));
+		}
+		QVERIFY2(maxError <= acceptableError, QString("pressure=%1 temperature=%2 error=%3\"")
+				.arg(pressures[p]).arg(temperatures[p]).arg(maxError).toUtf8());
+		// Vec3f has less than 0.1 arcsecond precision
+		QVERIFY2(maxErrorf <= 0.1, QString("pressure=%1 temperature=%2 float error=%3\"")
+				.arg(pressures[p]).arg(temperatures[p]).arg(maxErrorf).toUtf8());
+	}
+
+	// Zero vectors are left alone
+	Refraction refCls;
+	Vec3d zero(0., 0., 0.);
+	refCls.forward(1, &zero);
+	QVERIFY(zero == Vec3d(0., 0., 0.));
+}
+
+void TestRefraction::testBatchForwardBlock()
+{
+	// With transformations before and after, like in the model view transformation of a projector
+	Refraction refCls;
+	refCls.setPreTransfoMat(Mat4d::xrotation(0.7)*Mat4d::zrotation(1.9));
+	refCls.setPostTransfoMat(Mat4d::yrotation(-0.4));
+	StelProjector::ModelViewTranformP clone = refCls.clone();
+
+	const int n = 1000;
+	QVector<Vec3d> in(n);
+	QVector<Vec3f> inf(n);
+	for (int i=0; i<n; ++i)
+	{
+		StelUtils::spheToRect(0.37*i, std::asin(2.*i/(n-1)-1.), in[i]);
+		inf[i].set(in[i][0], in[i][1], in[i][2]);
+	}
+	QVector<double> x(n), y(n), z(n);
+	QVector<float> xf(n), yf(n), zf(n);
+	clone->forwardBlock(n, in.constData(), x.data(), y.data(), z.data());
+	clone->forwardBlock(n, inf.constData(), xf.data(), yf.data(), zf.data());
+	for (int i=0; i<n; ++i)
+	{
+		Vec3d v(in.at(i));
+		refCls.forward(v);
+		QVERIFY(angleArcsec(v, Vec3d(x.at(i), y.at(i), z.at(i))) <= 0.03);
+		QVERIFY(angleArcsec(v, Vec3d(xf.at(i), yf.at(i), zf.at(i))) <= 0.1);
+	}
+}
+
+void TestRefraction::benchmarkForward_data()
+{
+	QTest::addColumn<bool>("batch");
+	QTest::newRow("forward") << false;
+	QTest::newRow("batch") << true;
+}
+
+void TestRefraction::benchmarkForward()
+{
+	QFETCH(bool, batch);
+	Refraction refCls;
+	const int n = 10000;
+	QVector<Vec3d> in(n), out(n);
+	for (int i=0; i<n; ++i)
+		StelUtils::spheToRect(0.001*i, (-5.+95.*i/n)*M_PI/180., in[i]);
+
+	QBENCHMARK
+	{
+		out = in;
+		if (batch)
+			refCls.forward(n, out.data());
+		else
+		{
+			for (int i=0; i<n; ++i)
+				refCls.forward(out[i]);
+		}
+	}
+}
@@ -32,6 +32,10 @@ private slots:
 	void testSaemundssonEquation();
 	void testBennettEquation();
 	void testComplexRefraction();
+	void testBatchForward();
+	void testBatchForwardBlock();
+	void benchmarkForward_data();
+	void benchmarkForward();
 };
 
 #endif // _TESTREFRACTION_HPP_
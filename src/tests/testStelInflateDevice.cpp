@@ -0,0 +1,235 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "tests/testStelInflateDevice.hpp"
+#include "StelUtils.hpp"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+
+QTEST_GUILESS_MAIN(TestStelInflateDevice)
+
+static const int RECORD_COUNT = 500000;
+
+void TestStelInflateDevice::initTestCase()
+{
+	QDataStream out(&data, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_5_2);
+	for (int i = 0; i < RECORD_COUNT; ++i)
+		out << (quint32)i << (double)(i%3600)*0.1 << (double)(i%1800)*0.1-90. << (float)(i%200)*0.1f << QString("NGC %1").arg(i%7840);
+
+	// a single gzip member is what compressChunked() writes for a big enough chunk size
+	gzipped = StelInflateDevice::compressChunked(data, data.size()+1);
+	chunked = StelInflateDevice::compressChunked(data, 1024*1024);
+	QVERIFY(!gzipped.isEmpty());
+	QVERIFY(chunked.size()>gzipped.size());
+	qDebug() << "Test data:" << data.size() << "bytes," << gzipped.size() << "gzipped," << chunked.size() << "chunked";
+}
+
+int TestStelInflateDevice::parseRecords(QDataStream& in)
+{
+	int count = 0;
+	quint32 id;
+	double ra, dec;
+	float mag;
+	QString name;
+	while (!in.atEnd())
+	{
+		in >> id >> ra >> dec >> mag >> name;
+		if (in.status()!=QDataStream::Ok)
+			return -1;
+		++count;
+	}
+	return count;
+}
+
+qint64 TestStelInflateDevice::readProcStatus(const QByteArray& key)
+{
+	QFile status("/proc/self/status");
+	if (!status.open(QIODevice::ReadOnly))
+		return -1;
+	// QFile::readLine() doesn't work on /proc files, which report a size of 0
+	const QList<QByteArray> lines = status.readAll().split('\n');
+	for (const auto& line : lines)
+	{
+		if (line.startsWith(key))
+		{
+			// e.g. "VmHWM:	  123456 kB"
+			bool ok;
+			const qint64 kb = line.mid(key.size()).trimmed().split(' ').first().toLongLong(&ok);
+			return ok ? kb : -1;
+		}
+	}
+	return -1;
+}
+
+qint64 TestStelInflateDevice::startMemoryMeasurement()
+{
+	// Writing 5 to clear_refs resets the VmHWM high-water mark to the current resident size (Linux 4.0+)
+	QFile clearRefs("/proc/self/clear_refs");
+	if (!clearRefs.open(QIODevice::WriteOnly) || clearRefs.write("5")!=1)
+		return -1;
+	clearRefs.close();
+	return readProcStatus("VmRSS:");
+}
+
+void TestStelInflateDevice::reportPeakMemory(qint64 baseline)
+{
+	const qint64 peak = readProcStatus("VmHWM:");
+	if (baseline<0 || peak<0)
+	{
+		qDebug() << "Peak memory: not measurable on this system";
+		return;
+	}
+	// The test data is already resident in the baseline, so this is what the benchmark added
+	qDebug() << "Peak memory:" << peak-baseline << "kB above the" << baseline << "kB resident before the benchmark";
+}
+
+void TestStelInflateDevice::testStreaming()
+{
+	QBuffer buf(&gzipped);
+	buf.open(QIODevice::ReadOnly);
+	StelInflateDevice inflater(&buf);
+	QVERIFY(inflater.open(QIODevice::ReadOnly));
+	QVERIFY(inflater.isSequential());
+
+	// read in odd sized pieces to cross the internal buffer boundaries
+	QByteArray result;
+	while (!inflater.atEnd())
+		result.append(inflater.read(12345));
+	QVERIFY(!inflater.hasError());
+	QCOMPARE(result.size(), data.size());
+	QVERIFY(result==data);
+	QCOMPARE(inflater.read(10).size(), 0);
+
+	// same result as the in-memory version
+	QVERIFY(StelUtils::uncompress(gzipped)==data);
+}
+
+void TestStelInflateDevice::testZlibFormat()
+{
+	// qCompress() prepends the uncompressed size to a zlib stream
+	QByteArray zlibData = qCompress(data).mid(4);
+	QBuffer buf(&zlibData);
+	buf.open(QIODevice::ReadOnly);
+	StelInflateDevice inflater(&buf);
+	QVERIFY(inflater.open(QIODevice::ReadOnly));
+	QDataStream in(&inflater);
+	in.setVersion(QDataStream::Qt_5_2);
+	QCOMPARE(parseRecords(in), RECORD_COUNT);
+	QVERIFY(!inflater.hasError());
+}
+
+void TestStelInflateDevice::testMultiMember()
+{
+	// by default, stop after the first member like StelUtils::uncompress()
+	QBuffer buf(&chunked);
+	buf.open(QIODevice::ReadOnly);
+	StelInflateDevice first(&buf);
+	QVERIFY(first.open(QIODevice::ReadOnly));
+	QCOMPARE(first.readAll().size(), 1024*1024);
+
+	buf.seek(0);
+	StelInflateDevice all(&buf);
+	all.setMultiMember(true);
+	QVERIFY(all.open(QIODevice::ReadOnly));
+	QDataStream in(&all);
+	in.setVersion(QDataStream::Qt_5_2);
+	QCOMPARE(parseRecords(in), RECORD_COUNT);
+	QVERIFY(!all.hasError());
+}
+
+void TestStelInflateDevice::testChunked()
+{
+	QVERIFY(StelInflateDevice::uncompressChunked(chunked)==data);
+	// a raw zlib stream (qCompress() without its size prefix) falls back to sequential inflation
+	QVERIFY(StelInflateDevice::uncompressChunked(qCompress(data).mid(4))==data);
+	// so does a single gzip member, which has no chunk table
+	QVERIFY(StelInflateDevice::uncompressChunked(gzipped)==data);
+	// empty input still gives a valid member
+	QByteArray empty = StelInflateDevice::compressChunked(QByteArray());
+	QVERIFY(!empty.isEmpty());
+	QVERIFY(StelInflateDevice::uncompressChunked(empty).isEmpty());
+	// corrupted member
+	QByteArray corrupted = chunked;
+	corrupted[corrupted.size()/2] = corrupted.at(corrupted.size()/2)^0x55;
+	QVERIFY(StelInflateDevice::uncompressChunked(corrupted).isEmpty());
+}
+
+void TestStelInflateDevice::testTruncated()
+{
+	QByteArray truncated = gzipped.left(gzipped.size()/2);
+	QBuffer buf(&truncated);
+	buf.open(QIODevice::ReadOnly);
+	StelInflateDevice inflater(&buf);
+	QVERIFY(inflater.open(QIODevice::ReadOnly));
+	inflater.readAll();
+	QVERIFY(inflater.hasError());
+	QVERIFY(inflater.atEnd());
+}
+
+void TestStelInflateDevice::benchmarkUncompress()
+{
+	// the previous way: inflate everything, then parse
+	int count = 0;
+	const qint64 baseline = startMemoryMeasurement();
+	QBENCHMARK {
+		QByteArray result = StelUtils::uncompress(gzipped);
+		QDataStream in(result);
+		in.setVersion(QDataStream::Qt_5_2);
+		count = parseRecords(in);
+	}
+	QCOMPARE(count, RECORD_COUNT);
+	reportPeakMemory(baseline);
+}
+
+void TestStelInflateDevice::benchmarkStreaming()
+{
+	// parsing overlaps inflation, only the compressed file and a few buffers are held
+	int count = 0;
+	const qint64 baseline = startMemoryMeasurement();
+	QBENCHMARK {
+		QBuffer buf(&gzipped);
+		buf.open(QIODevice::ReadOnly);
+		StelInflateDevice inflater(&buf);
+		inflater.open(QIODevice::ReadOnly);
+		QDataStream in(&inflater);
+		in.setVersion(QDataStream::Qt_5_2);
+		count = parseRecords(in);
+	}
+	QCOMPARE(count, RECORD_COUNT);
+	reportPeakMemory(baseline);
+}
+
+void TestStelInflateDevice::benchmarkChunkedParallel()
+{
+	int count = 0;
+	const qint64 baseline = startMemoryMeasurement();
+	QBENCHMARK {
+		QByteArray result = StelInflateDevice::uncompressChunked(chunked);
+		QDataStream in(result);
+		in.setVersion(QDataStream::Qt_5_2);
+		count = parseRecords(in);
+	}
+	QCOMPARE(count, RECORD_COUNT);
+	reportPeakMemory(baseline);
+}
@@ -0,0 +1,62 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef _TESTSTELINFLATEDEVICE_HPP_
+#define _TESTSTELINFLATEDEVICE_HPP_
+
+#include <QObject>
+#include <QTest>
+
+#include "StelInflateDevice.hpp"
+
+class TestStelInflateDevice : public QObject
+{
+Q_OBJECT
+private slots:
+	void initTestCase();
+	void testStreaming();
+	void testZlibFormat();
+	void testMultiMember();
+	void testChunked();
+	void testTruncated();
+	void benchmarkUncompress();
+	void benchmarkStreaming();
+	void benchmarkChunkedParallel();
+private:
+	//! Parse the simulated catalog records from the stream, return the number of records
+	static int parseRecords(QDataStream& in);
+
+	//! Reset the peak resident memory of the process (Linux only).
+	//! @return the current resident memory in kB, or -1 if the peak can't be measured.
+	static qint64 startMemoryMeasurement();
+	//! Print the peak resident memory since startMemoryMeasurement() above the then current memory.
+	static void reportPeakMemory(qint64 baseline);
+	//! Read a value in kB from /proc/self/status, or return -1.
+	static qint64 readProcStatus(const QByteArray& key);
+
+	//! Uncompressed test data, similar to a binary catalog file
+	QByteArray data;
+	//! data as single gzip member
+	QByteArray gzipped;
+	//! data compressed with StelInflateDevice::compressChunked()
+	QByteArray chunked;
+};
+
+#endif // _TESTSTELINFLATEDEVICE_HPP_
@@ -0,0 +1,199 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelIniCache.hpp"
+#include "StelIniParser.hpp"
+
+#include <QFile>
+#include <QTextStream>
+
+QTEST_GUILESS_MAIN(TestStelIniCache)
+
+static const int BODY_COUNT = 5000;
+
+void TestStelIniCache::writeIniFile(const QString& path, int bodies)
+{
+	QFile file(path);
+	QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text));
+	QTextStream out(&file);
+	out << "# Test data\nversion = 1\n";
+	for (int i=0; i<bodies; ++i)
+	{
+		out << "\n[" << QString("(%1) body").arg(i+1).toLower().remove(' ') << "]\n";
+		out << "name = Body " << i+1 << "\n";
+		out << "parent = Sun\n";
+		out << "type = " << (i%10 ? "asteroid" : "comet") << "  # comment\n";
+		out << "coord_func = comet_orbit\n";
+		out << "orbit_Eccentricity = 0." << i << "\n";
+		out << "orbit_Inclination = " << (i%180)*0.5 << "\n";
+		out << "orbit_SemiMajorAxis = " << 1.+i*0.001 << "\n";
+		out << "color = 1.0, 0.5, 0.2\n";
+		out << "tex_map = nomap.png\n";
+		if (i%3==0)
+			out << "absolute_magnitude = " << 10.+i%7 << "\n";
+	}
+}
+
+void TestStelIniCache::compareWithQSettings(const StelIniCache& cache, const QString& path)
+{
+	QSettings ref(path, StelIniFormat);
+	QCOMPARE(cache.childGroups(), ref.childGroups());
+	foreach (const QString& key, ref.allKeys())
+	{
+		QVERIFY(cache.contains(key));
+		QCOMPARE(cache.value(key).toString(), ref.value(key).toString());
+	}
+	foreach (const QString& group, ref.childGroups())
+	{
+		ref.beginGroup(group);
+		QStringList keys = ref.childKeys();
+		ref.endGroup();
+		keys.sort();
+		QCOMPARE(cache.childKeys(group), keys);
+	}
+}
+
+void TestStelIniCache::initTestCase()
+{
+	QVERIFY(tempDir.isValid());
+	iniPath = tempDir.path()+"/ssystem_test.ini";
+	cacheDir = tempDir.path()+"/cache";
+	writeIniFile(iniPath, BODY_COUNT);
+}
+
+void TestStelIniCache::testSameAsQSettings()
+{
+	StelIniCache cache(iniPath, cacheDir);
+	QCOMPARE(cache.status(), QSettings::NoError);
+	QCOMPARE(cache.childGroups().size(), BODY_COUNT);
+	compareWithQSettings(cache, iniPath);
+
+	QCOMPARE(cache.value("version").toString(), QString("1"));
+	QCOMPARE(cache.value("(1)body/type").toString(), QString("comet"));
+	QCOMPARE(cache.value("(2)body/color").toString(), QString("1.0, 0.5, 0.2"));
+	QVERIFY(!cache.contains("(2)body/absolute_magnitude"));
+	QCOMPARE(cache.value("(2)body/absolute_magnitude", -99).toDouble(), -99.);
+	QVERIFY(!cache.contains("nobody/name"));
+	QVERIFY(!cache.value("nobody/name").isValid());
+	QVERIFY(cache.childKeys("nobody").isEmpty());
+}
+
+void TestStelIniCache::testLoadedFromCache()
+{
+	StelIniCache first(iniPath, cacheDir);
+	QVERIFY(QFile::exists(first.getCacheFilePath()));
+	StelIniCache second(iniPath, cacheDir);
+	QVERIFY(second.isLoadedFromCache());
+	QCOMPARE(second.getCacheFilePath(), first.getCacheFilePath());
+	compareWithQSettings(second, iniPath);
+}
+
+void TestStelIniCache::testModifiedFile()
+{
+	const QString path = tempDir.path()+"/modified.ini";
+	writeIniFile(path, 10);
+	{
+		StelIniCache cache(path, cacheDir);
+		QCOMPARE(cache.childGroups().size(), 10);
+	}
+	writeIniFile(path, 11);
+	StelIniCache cache(path, cacheDir);
+	QVERIFY(!cache.isLoadedFromCache());
+	QCOMPARE(cache.childGroups().size(), 11);
+	QCOMPARE(cache.value("(11)body/name").toString(), QString("Body 11"));
+	StelIniCache again(path, cacheDir);
+	QVERIFY(again.isLoadedFromCache());
+	compareWithQSettings(again, path);
+}
+
+void TestStelIniCache::testDamagedCache()
+{
+	const QString path = tempDir.path()+"/damaged.ini";
+	writeIniFile(path, 100);
+	QString cachePath;
+	{
+		StelIniCache cache(path, cacheDir);
+		cachePath = cache.getCacheFilePath();
+	}
+
+	// Truncated file
+	QFile file(cachePath);
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.resize(file.size()/2));
+	file.close();
+	{
+		StelIniCache cache(path, cacheDir);
+		QVERIFY(!cache.isLoadedFromCache());
+		compareWithQSettings(cache, path);
+	}
+
+	// String references out of the file, right after the header
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.seek(40));
+	const QByteArray garbage(16, '\xff');
+	QCOMPARE(file.write(garbage), (qint64)garbage.size());
+	file.close();
+	StelIniCache cache(path, cacheDir);
+	QVERIFY(!cache.isLoadedFromCache());
+	compareWithQSettings(cache, path);
+}
+
+void TestStelIniCache::testNoCacheDir()
+{
+	StelIniCache cache(iniPath, QString());
+	QVERIFY(cache.getCacheFilePath().isEmpty());
+	QVERIFY(!cache.isLoadedFromCache());
+	compareWithQSettings(cache, iniPath);
+}
+
+void TestStelIniCache::testMissingFile()
+{
+	StelIniCache cache(tempDir.path()+"/missing.ini", cacheDir);
+	QCOMPARE(cache.status(), QSettings::AccessError);
+	QVERIFY(cache.childGroups().isEmpty());
+	QCOMPARE(cache.value("a/b", 1).toInt(), 1);
+	QVERIFY(!QFile::exists(cache.getCacheFilePath()));
+}
+
+void TestStelIniCache::benchmarkQSettings()
+{
+	QBENCHMARK
+	{
+		QSettings pd(iniPath, StelIniFormat);
+		double sum = 0.;
+		foreach (const QString& section, pd.childGroups())
+			sum += pd.value(section+"/orbit_Eccentricity").toDouble();
+		QVERIFY(sum>0.);
+	}
+}
+
+void TestStelIniCache::benchmarkCache()
+{
+	// Make sure the binary file is up to date
+	StelIniCache warmup(iniPath, cacheDir);
+	QVERIFY(warmup.status()==QSettings::NoError);
+	QBENCHMARK
+	{
+		StelIniCache pd(iniPath, cacheDir);
+		double sum = 0.;
+		foreach (const QString& section, pd.childGroups())
+			sum += pd.value(section+"/orbit_Eccentricity").toDouble();
+		QVERIFY(sum>0.);
+	}
+}
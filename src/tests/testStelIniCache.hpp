@@ -0,0 +1,53 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTSTELINICACHE_HPP_
+#define _TESTSTELINICACHE_HPP_
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+
+#include "StelIniCache.hpp"
+
+class TestStelIniCache : public QObject
+{
+Q_OBJECT
+private slots:
+	void initTestCase();
+	void testSameAsQSettings();
+	void testLoadedFromCache();
+	void testModifiedFile();
+	void testDamagedCache();
+	void testNoCacheDir();
+	void testMissingFile();
+	void benchmarkQSettings();
+	void benchmarkCache();
+private:
+	//! Write an ini file similar to ssystem_minor.ini with the given number of bodies
+	static void writeIniFile(const QString& path, int bodies);
+	//! Compare all the keys with the ones read by QSettings
+	static void compareWithQSettings(const StelIniCache& cache, const QString& path);
+
+	QTemporaryDir tempDir;
+	QString iniPath;
+	QString cacheDir;
+};
+
+#endif // _TESTSTELINICACHE_HPP_
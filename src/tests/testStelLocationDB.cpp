@@ -0,0 +1,391 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelLocationDB.hpp"
+
+#include <QFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+QTEST_GUILESS_MAIN(TestStelLocationDB)
+
+static const QByteArray SIGNATURE("testStelLocationDB 1");
+// The header is a sequence of quint32: magic, version, count, ..., stringsOffset, stringsSize
+static const int HEADER_FIELDS = 11;
+static const int HEADER_COUNT_FIELD = 2;
+static const int HEADER_STRINGS_OFFSET_FIELD = 9;
+// StelLocation::distanceDegrees() works in float, whose acos() is inaccurate for small angles
+static const double DISTANCE_TOLERANCE = 0.05;
+
+namespace
+{
+	//! Deterministic pseudo random numbers in [0, 1)
+	double randomUniform()
+	{
+		static quint32 seed = 12345;
+		seed = seed*1664525u + 1013904223u;
+		return (seed>>8)/16777216.0;
+	}
+
+	//! Reference great-circle distance in degrees, accurate for small angles
+	double angularDistance(double lon1, double lat1, double lon2, double lat2)
+	{
+		const double d2r = M_PI/180.;
+		const double x1 = std::cos(lat1*d2r)*std::cos(lon1*d2r), y1 = std::cos(lat1*d2r)*std::sin(lon1*d2r), z1 = std::sin(lat1*d2r);
+		const double x2 = std::cos(lat2*d2r)*std::cos(lon2*d2r), y2 = std::cos(lat2*d2r)*std::sin(lon2*d2r), z2 = std::sin(lat2*d2r);
+		const double cx = y1*z2-z1*y2, cy = z1*x2-x1*z2, cz = x1*y2-y1*x2;
+		return std::atan2(std::sqrt(cx*cx+cy*cy+cz*cz), x1*x2+y1*y2+z1*z2)/d2r;
+	}
+
+	void addLocation(QMap<QString, StelLocation>& locations, const QString& name, const QString& country,
+			 const QString& planetName, float longitude, float latitude)
+	{
+		StelLocation loc;
+		loc.name = name;
+		loc.country = country;
+		loc.state = (locations.size()%3) ? QString() : QString("State %1").arg(locations.size()%17);
+		loc.planetName = planetName;
+		loc.longitude = longitude;
+		loc.latitude = latitude;
+		loc.altitude = locations.size()%4000-200;
+		loc.population = locations.size()*7;
+		loc.bortleScaleIndex = 1+locations.size()%9;
+		loc.landscapeKey = (locations.size()%5) ? QString() : QString("landscape%1").arg(locations.size()%3);
+		loc.role = QLatin1Char("CBRNOLIAX"[locations.size()%9]);
+		loc.ianaTimeZone = (locations.size()%2) ? QString("Europe/Paris") : QString("UTC");
+		loc.isUserLocation = (locations.size()%11==0);
+		locations.insert(QString("%1, %2").arg(name, country), loc);
+	}
+
+	//! Overwrite one quint32 field of the header
+	void setHeaderField(QByteArray& data, int field, quint32 value)
+	{
+		std::memcpy(data.data()+field*sizeof(quint32), &value, sizeof(quint32));
+	}
+}
+
+void TestStelLocationDB::initTestCase()
+{
+	QVERIFY(tempDir.isValid());
+
+	addLocation(locations, "Paris", "France", "Earth", 2.35f, 48.85f);
+	addLocation(locations, "Parma", "Italy", "Earth", 10.33f, 44.8f);
+	addLocation(locations, "Paramaribo", "Suriname", "Earth", -55.2f, 5.85f);
+	addLocation(locations, "paradise", "United States", "Earth", -121.6f, 39.76f);
+	addLocation(locations, "Berlin", "Germany", "Earth", 13.4f, 52.52f);
+	addLocation(locations, "Bern", "Switzerland", "Earth", 7.45f, 46.95f);
+	addLocation(locations, "Bergen", "Norway", "Earth", 5.32f, 60.39f);
+
+	int n = 0;
+	// uniformly distributed over the sphere
+	for (int i=0; i<20000; ++i)
+		addLocation(locations, QString("Loc%1").arg(n++), "Testland", "Earth",
+			    (float)(randomUniform()*360.-180.), (float)(std::asin(2.*randomUniform()-1.)*180./M_PI));
+	// clusters at the poles
+	for (int i=0; i<300; ++i)
+	{
+		addLocation(locations, QString("Loc%1").arg(n++), "Testland", "Earth", (float)(randomUniform()*360.-180.), (float)(90.-randomUniform()*1.5));
+		addLocation(locations, QString("Loc%1").arg(n++), "Testland", "Earth", (float)(randomUniform()*360.-180.), (float)(randomUniform()*1.5-90.));
+	}
+	addLocation(locations, "NorthPole", "Testland", "Earth", 0.f, 90.f);
+	addLocation(locations, "SouthPole", "Testland", "Earth", 123.f, -90.f);
+	// clusters on both sides of the 180 degrees meridian
+	for (int i=0; i<300; ++i)
+	{
+		addLocation(locations, QString("Loc%1").arg(n++), "Testland", "Earth", (float)(180.-randomUniform()), (float)(randomUniform()*40.-20.));
+		addLocation(locations, QString("Loc%1").arg(n++), "Testland", "Earth", (float)(randomUniform()-180.), (float)(randomUniform()*40.-20.));
+	}
+	addLocation(locations, "SeamEast", "Testland", "Earth", 180.f, 0.f);
+	addLocation(locations, "SeamWest", "Testland", "Earth", -180.f, 0.5f);
+	// another planet, which findNearby() must ignore when searching on Earth
+	for (int i=0; i<1000; ++i)
+		addLocation(locations, QString("Loc%1").arg(n++), "Testland", "Mars",
+			    (float)(randomUniform()*360.-180.), (float)(std::asin(2.*randomUniform()-1.)*180./M_PI));
+
+	serialized = StelLocationDB::serialize(locations, SIGNATURE);
+	QVERIFY(!serialized.isEmpty());
+	dbPath = writeFile("locations.db", serialized);
+}
+
+QString TestStelLocationDB::writeFile(const QString& name, const QByteArray& data)
+{
+	const QString path = tempDir.path() + "/" + name;
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(data)!=data.size())
+		qWarning() << "Cannot write" << path;
+	return path;
+}
+
+void TestStelLocationDB::testSerializeOpen()
+{
+	StelLocationDB db;
+	QVERIFY(!db.isOpen());
+	QVERIFY(db.open(dbPath, SIGNATURE));
+	QVERIFY(db.isOpen());
+	QCOMPARE(db.size(), locations.size());
+	QCOMPARE(db.allIDs(), QStringList(locations.keys()));
+
+	int i = 0;
+	for (QMap<QString, StelLocation>::const_iterator it=locations.constBegin(); it!=locations.constEnd(); ++it, ++i)
+	{
+		QCOMPARE(db.idAt(i), it.key());
+		const StelLocation loc = db.at(i);
+		const StelLocation& ref = it.value();
+		QCOMPARE(loc.name, ref.name);
+		QCOMPARE(loc.state, ref.state);
+		QCOMPARE(loc.country, ref.country);
+		QCOMPARE(loc.planetName, ref.planetName);
+		QCOMPARE(loc.longitude, ref.longitude);
+		QCOMPARE(loc.latitude, ref.latitude);
+		QCOMPARE(loc.altitude, ref.altitude);
+		QCOMPARE(loc.population, ref.population);
+		QCOMPARE(loc.bortleScaleIndex, ref.bortleScaleIndex);
+		QCOMPARE(loc.landscapeKey, ref.landscapeKey);
+		QCOMPARE(loc.role, ref.role);
+		QCOMPARE(loc.ianaTimeZone, ref.ianaTimeZone);
+		QCOMPARE(loc.isUserLocation, ref.isUserLocation);
+	}
+
+	// the same data from memory, and shared by another database
+	StelLocationDB memoryDb;
+	QVERIFY(memoryDb.setData(serialized));
+	QCOMPARE(memoryDb.allIDs(), QStringList(locations.keys()));
+	StelLocationDB shared;
+	QVERIFY(shared.openShared(db));
+	QCOMPARE(shared.allIDs(), QStringList(locations.keys()));
+
+	db.close();
+	QVERIFY(!db.isOpen());
+	QCOMPARE(db.size(), 0);
+
+	// no locations at all
+	StelLocationDB emptyDb;
+	QVERIFY(emptyDb.setData(StelLocationDB::serialize(QMap<QString, StelLocation>(), SIGNATURE)));
+	QCOMPARE(emptyDb.size(), 0);
+	QCOMPARE(emptyDb.find("Paris, France"), -1);
+	QVERIFY(emptyDb.findByNamePrefix("Par").isEmpty());
+	QVERIFY(emptyDb.findNearby("Earth", 0.f, 0.f, 180.f).isEmpty());
+}
+
+void TestStelLocationDB::testWrongSignature()
+{
+	StelLocationDB db;
+	QVERIFY(!db.open(dbPath, "testStelLocationDB 2"));
+	QVERIFY(!db.isOpen());
+	QVERIFY(!db.open(dbPath, QByteArray()));
+	QVERIFY(!db.open(tempDir.path() + "/missing.db", SIGNATURE));
+	QVERIFY(!db.isOpen());
+}
+
+void TestStelLocationDB::testDamagedFile()
+{
+	QList<QByteArray> damaged;
+	damaged << QByteArray();
+	damaged << serialized.left(HEADER_FIELDS*sizeof(quint32)-1);
+	damaged << serialized.left(serialized.size()/2);
+	damaged << serialized.left(serialized.size()-1);
+	QByteArray badMagic = serialized;
+	badMagic[0] = badMagic.at(0)^0x20;
+	damaged << badMagic;
+	QByteArray badCount = serialized;
+	setHeaderField(badCount, HEADER_COUNT_FIELD, 0x7fffffff);
+	damaged << badCount;
+	QByteArray badOffset = serialized;
+	setHeaderField(badOffset, HEADER_STRINGS_OFFSET_FIELD, serialized.size());
+	damaged << badOffset;
+
+	for (int i=0; i<damaged.size(); ++i)
+	{
+		StelLocationDB db;
+		QVERIFY2(!db.open(writeFile(QString("damaged%1.db").arg(i), damaged.at(i)), SIGNATURE), qPrintable(QString("damaged file %1").arg(i)));
+		QVERIFY(!db.isOpen());
+		QVERIFY(!db.setData(damaged.at(i)));
+		QCOMPARE(db.size(), 0);
+	}
+}
+
+void TestStelLocationDB::testWrongByteOrder()
+{
+	// A file generated on a machine with the other byte order: all the header fields are swapped
+	QByteArray swapped = serialized;
+	for (int field=0; field<HEADER_FIELDS; ++field)
+	{
+		quint32 value;
+		std::memcpy(&value, swapped.constData()+field*sizeof(quint32), sizeof(quint32));
+		setHeaderField(swapped, field, qbswap(value));
+	}
+	StelLocationDB db;
+	QVERIFY(!db.open(writeFile("swapped.db", swapped), SIGNATURE));
+	QVERIFY(!db.isOpen());
+	QVERIFY(!db.setData(swapped));
+}
+
+void TestStelLocationDB::testFind()
+{
+	StelLocationDB db;
+	QVERIFY(db.open(dbPath, SIGNATURE));
+	int expected = 0;
+	foreach (const QString& id, locations.keys())
+	{
+		QCOMPARE(db.find(id), expected++);
+	}
+	QCOMPARE(db.find("Nowhere, Testland"), -1);
+	QCOMPARE(db.find(QString()), -1);
+	// IDs are case sensitive
+	QCOMPARE(db.find("paris, france"), -1);
+	QCOMPARE(db.find("Paris, France "), -1);
+	QCOMPARE(db.find("Paris, Franc"), -1);
+}
+
+void TestStelLocationDB::testFindByNamePrefix()
+{
+	StelLocationDB db;
+	QVERIFY(db.open(dbPath, SIGNATURE));
+
+	QStringList names;
+	foreach (int i, db.findByNamePrefix("par"))
+		names << db.at(i).name;
+	QCOMPARE(names, QStringList() << "paradise" << "Paramaribo" << "Paris" << "Parma");
+
+	names.clear();
+	foreach (int i, db.findByNamePrefix("PAR", 2))
+		names << db.at(i).name;
+	QCOMPARE(names, QStringList() << "paradise" << "Paramaribo");
+
+	names.clear();
+	foreach (int i, db.findByNamePrefix("Ber"))
+		names << db.at(i).name;
+	QCOMPARE(names, QStringList() << "Bergen" << "Berlin" << "Bern");
+
+	QCOMPARE(db.findByNamePrefix("Bern").size(), 1);
+	QCOMPARE(db.at(db.findByNamePrefix("PARIS").first()).country, QString("France"));
+	QVERIFY(db.findByNamePrefix("Parisx").isEmpty());
+	QVERIFY(db.findByNamePrefix("zzz").isEmpty());
+	QVERIFY(db.findByNamePrefix("Par", 0).isEmpty());
+	QCOMPARE(db.findByNamePrefix(QString()).size(), locations.size());
+
+	// same as a scan of all the names
+	QStringList expected;
+	foreach (const StelLocation& loc, locations)
+	{
+		if (loc.name.startsWith("loc12", Qt::CaseInsensitive))
+			expected << loc.name;
+	}
+	std::sort(expected.begin(), expected.end(), [](const QString& a, const QString& b) {return QString::compare(a, b, Qt::CaseInsensitive)<0;});
+	names.clear();
+	foreach (int i, db.findByNamePrefix("loc12"))
+		names << db.at(i).name;
+	QVERIFY(!expected.isEmpty());
+	QCOMPARE(names, expected);
+}
+
+QVector<int> TestStelLocationDB::bruteForceNearby(const QString& planetName, float longitude, float latitude, float radius) const
+{
+	// The record numbers follow the order of the IDs
+	QVector<int> res;
+	int i = 0;
+	for (QMap<QString, StelLocation>::const_iterator it=locations.constBegin(); it!=locations.constEnd(); ++it, ++i)
+	{
+		const StelLocation& loc = it.value();
+		if (loc.planetName==planetName && angularDistance(longitude, latitude, loc.longitude, loc.latitude)<=radius)
+			res.append(i);
+	}
+	return res;
+}
+
+void TestStelLocationDB::testFindNearby()
+{
+	StelLocationDB db;
+	QVERIFY(db.open(dbPath, SIGNATURE));
+
+	QVector<QPair<float, float> > centers;
+	centers << qMakePair(0.f, 0.f) << qMakePair(2.35f, 48.85f) << qMakePair(100.f, 60.f)
+		// the poles
+		<< qMakePair(0.f, 90.f) << qMakePair(45.f, 89.5f) << qMakePair(0.f, -90.f) << qMakePair(-120.f, -89.2f) << qMakePair(179.5f, 85.f)
+		// the 180 degrees meridian
+		<< qMakePair(180.f, 0.f) << qMakePair(-180.f, 0.f) << qMakePair(179.9f, 10.f) << qMakePair(-179.9f, -10.f) << qMakePair(179.f, -19.f);
+	for (int i=0; i<20; ++i)
+		centers << qMakePair((float)(randomUniform()*360.-180.), (float)(randomUniform()*180.-90.));
+	const QVector<float> radii = QVector<float>() << 0.f << 0.5f << 2.f << 10.f << 45.f << 180.f;
+	const QStringList planets = QStringList() << "Earth" << "Mars" << "Moon";
+
+	for (const auto& center : centers)
+	{
+		for (float radius : radii)
+		{
+			for (const auto& planet : planets)
+			{
+				QVector<int> found = db.findNearby(planet, center.first, center.second, radius);
+				QVector<int> expected = bruteForceNearby(planet, center.first, center.second, radius);
+				std::sort(found.begin(), found.end());
+				const QString where = QString("%1 within %2 of %3/%4").arg(planet).arg(radius).arg(center.first).arg(center.second);
+				QVERIFY2(std::adjacent_find(found.begin(), found.end())==found.end(), qPrintable("duplicates: " + where));
+
+				// Locations found by only one of both methods must lie on the circle, within the float precision
+				QVector<int> difference;
+				std::set_symmetric_difference(found.begin(), found.end(), expected.begin(), expected.end(), std::back_inserter(difference));
+				foreach (int i, difference)
+				{
+					const StelLocation loc = db.at(i);
+					QVERIFY2(loc.planetName==planet, qPrintable("wrong planet: " + where));
+					const double distance = angularDistance(center.first, center.second, loc.longitude, loc.latitude);
+					QVERIFY2(std::fabs(distance-radius)<DISTANCE_TOLERANCE,
+						 qPrintable(QString("%1 at %2 degrees: %3").arg(loc.name).arg(distance).arg(where)));
+				}
+				if (planet=="Moon")
+					QVERIFY(found.isEmpty());
+			}
+		}
+	}
+
+	// the seam and the poles themselves
+	const int seamEast = db.find("SeamEast, Testland");
+	const int seamWest = db.find("SeamWest, Testland");
+	QVERIFY(seamEast>=0 && seamWest>=0);
+	QVector<int> found = db.findNearby("Earth", 179.99f, 0.25f, 0.5f);
+	QVERIFY(found.contains(seamEast) && found.contains(seamWest));
+	found = db.findNearby("Earth", -179.99f, 0.25f, 0.5f);
+	QVERIFY(found.contains(seamEast) && found.contains(seamWest));
+	QVERIFY(db.findNearby("Earth", 12.f, 90.f, 0.1f).contains(db.find("NorthPole, Testland")));
+	QVERIFY(db.findNearby("Earth", -12.f, -89.95f, 0.1f).contains(db.find("SouthPole, Testland")));
+	QVERIFY(db.findNearby("Earth", 0.f, 0.f, -1.f).isEmpty());
+}
+
+void TestStelLocationDB::testFindInCountry()
+{
+	StelLocationDB db;
+	QVERIFY(db.open(dbPath, SIGNATURE));
+	QVector<int> found = db.findInCountry("France");
+	QCOMPARE(found.size(), 1);
+	QCOMPARE(db.at(found.first()).name, QString("Paris"));
+
+	int expected = 0;
+	foreach (const StelLocation& loc, locations)
+	{
+		if (loc.country=="Testland")
+			++expected;
+	}
+	QCOMPARE(db.findInCountry("Testland").size(), expected);
+	QVERIFY(db.findInCountry("testland").isEmpty());
+	QVERIFY(db.findInCountry("Atlantis").isEmpty());
+}
@@ -0,0 +1,58 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTSTELLOCATIONDB_HPP_
+#define _TESTSTELLOCATIONDB_HPP_
+
+#include <QObject>
+#include <QTest>
+#include <QTemporaryDir>
+#include <QMap>
+
+#include "StelLocationDB.hpp"
+
+class TestStelLocationDB : public QObject
+{
+Q_OBJECT
+private slots:
+	void initTestCase();
+	void testSerializeOpen();
+	void testWrongSignature();
+	void testDamagedFile();
+	void testWrongByteOrder();
+	void testFind();
+	void testFindByNamePrefix();
+	void testFindNearby();
+	void testFindInCountry();
+private:
+	//! Write data to a file in the temporary directory, return its path
+	QString writeFile(const QString& name, const QByteArray& data);
+	//! Return the record numbers of the locations within radius, checking all the locations
+	QVector<int> bruteForceNearby(const QString& planetName, float longitude, float latitude, float radius) const;
+
+	QTemporaryDir tempDir;
+	//! Test locations, the key being the location ID
+	QMap<QString, StelLocation> locations;
+	//! The serialized locations
+	QByteArray serialized;
+	//! The path of a file containing serialized
+	QString dbPath;
+};
+
+#endif // _TESTSTELLOCATIONDB_HPP_
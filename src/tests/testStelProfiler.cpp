@@ -0,0 +1,223 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelProfiler.hpp"
+#include "StelProfiler.hpp"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+QTEST_GUILESS_MAIN(TestStelProfiler)
+
+namespace
+{
+	//! Uses a profiler from a worker thread
+	class ProfilerThread : public QThread
+	{
+	public:
+		ProfilerThread(StelProfiler* profiler, QObject* module, int existingZone)
+			: profiler(profiler), module(module), existingZone(existingZone), zone(0), moduleZone(0), began(true) {}
+		void run() Q_DECL_OVERRIDE
+		{
+			zone = profiler->registerZone("worker");
+			moduleZone = profiler->getModuleZone(module, StelProfiler::PhaseUpdate);
+			began = profiler->beginZone(existingZone);
+		}
+		StelProfiler* profiler;
+		QObject* module;
+		int existingZone;
+		int zone;
+		int moduleZone;
+		bool began;
+	};
+}
+
+void TestStelProfiler::testDisabled()
+{
+	StelProfiler profiler;
+	const int zone = profiler.registerZone("test");
+	profiler.beginFrame();
+	QVERIFY(!profiler.beginZone(zone));
+	profiler.endFrame();
+	QVERIFY(profiler.getStatistics().isEmpty());
+}
+
+void TestStelProfiler::testZones()
+{
+	StelProfiler profiler;
+	profiler.setEnabled(true);
+	QObject module;
+	module.setObjectName("TestMgr");
+	const int zone = profiler.getModuleZone(&module, StelProfiler::PhaseDraw);
+	QCOMPARE(profiler.getModuleZone(&module, StelProfiler::PhaseDraw), zone);
+	QVERIFY(profiler.getModuleZone(&module, StelProfiler::PhaseUpdate)!=zone);
+	QCOMPARE(profiler.registerZone("TestMgr.draw"), zone);
+
+	for (int i=0; i<10; ++i)
+	{
+		profiler.beginFrame();
+		QVERIFY(profiler.beginZone(zone));
+		QTest::qSleep(2);
+		profiler.endZone();
+		profiler.endFrame();
+	}
+	const QVariantMap stats = profiler.getStatistics();
+	QVERIFY(stats.contains("Frame"));
+	QVERIFY(stats.contains("TestMgr.draw"));
+	QVERIFY(!stats.contains("TestMgr.update"));
+	const QVariantMap draw = stats.value("TestMgr.draw").toMap();
+	QCOMPARE(draw.value("category").toString(), QString("draw"));
+	QCOMPARE(draw.value("frames").toInt(), 10);
+	QVERIFY(draw.value("p50").toDouble()>=1.5);
+	QVERIFY(draw.value("p50").toDouble()<=draw.value("p95").toDouble());
+	QVERIFY(draw.value("p95").toDouble()<=draw.value("p99").toDouble());
+	QVERIFY(draw.value("p99").toDouble()<=draw.value("max").toDouble());
+	// The frame contains the zone
+	QVERIFY(stats.value("Frame").toMap().value("max").toDouble()>=draw.value("max").toDouble());
+
+	const QVariantMap last = profiler.getLastFrame();
+	QCOMPARE(last.size(), 2);
+	QVERIFY(last.value("TestMgr.draw").toDouble()>=1.5);
+	QVERIFY(last.value("Frame").toDouble()>=last.value("TestMgr.draw").toDouble());
+}
+
+void TestStelProfiler::testNesting()
+{
+	StelProfiler profiler;
+	profiler.setEnabled(true);
+	const int outer = profiler.registerZone("outer");
+	const int inner = profiler.registerZone("inner");
+	profiler.beginFrame();
+	QVERIFY(profiler.beginZone(outer));
+	QVERIFY(profiler.beginZone(inner));
+	QTest::qSleep(2);
+	// recursion into the same zone is counted once
+	QVERIFY(profiler.beginZone(inner));
+	QTest::qSleep(2);
+	profiler.endZone();
+	profiler.endZone();
+	// left open, closed by endFrame()
+	QVERIFY(profiler.beginZone(inner));
+	profiler.endFrame();
+
+	const QVariantMap stats = profiler.getStatistics();
+	const double outerTime = stats.value("outer").toMap().value("max").toDouble();
+	const double innerTime = stats.value("inner").toMap().value("max").toDouble();
+	QCOMPARE(stats.value("inner").toMap().value("frames").toInt(), 1);
+	QVERIFY(innerTime>=3.5);
+	QVERIFY(outerTime>=innerTime);
+}
+
+void TestStelProfiler::testWindow()
+{
+	StelProfiler profiler;
+	profiler.setEnabled(true);
+	profiler.setWindowSize(5);
+	const int zone = profiler.registerZone("zone");
+	for (int i=0; i<20; ++i)
+	{
+		profiler.beginFrame();
+		if (i%2)
+		{
+			profiler.beginZone(zone);
+			profiler.endZone();
+		}
+		profiler.endFrame();
+	}
+	QVariantMap stats = profiler.getStatistics();
+	QCOMPARE(stats.value("Frame").toMap().value("frames").toInt(), 5);
+	QCOMPARE(stats.value("zone").toMap().value("frames").toInt(), 5);
+	profiler.reset();
+	QVERIFY(profiler.getStatistics().isEmpty());
+}
+
+void TestStelProfiler::testTrace()
+{
+	StelProfiler profiler;
+	const int zone = profiler.registerZone("zone \"quoted\"");
+	profiler.startTrace();
+	QVERIFY(profiler.getEnabled());
+	QVERIFY(profiler.isTracing());
+	for (int i=0; i<3; ++i)
+	{
+		profiler.beginFrame();
+		profiler.beginZone(zone);
+		profiler.endZone();
+		profiler.endFrame();
+	}
+	profiler.stopTrace();
+	QVERIFY(!profiler.isTracing());
+
+	QJsonParseError error;
+	const QJsonDocument doc = QJsonDocument::fromJson(profiler.getTraceJson(), &error);
+	QCOMPARE(error.error, QJsonParseError::NoError);
+	const QJsonArray events = doc.object().value("traceEvents").toArray();
+	// metadata + 3 frames + 3 zones
+	QCOMPARE(events.size(), 7);
+	double lastStart = -1.;
+	for (int i=1; i<events.size(); ++i)
+	{
+		const QJsonObject e = events.at(i).toObject();
+		QCOMPARE(e.value("ph").toString(), QString("X"));
+		QVERIFY(e.value("ts").toDouble()>=lastStart);
+		lastStart = e.value("ts").toDouble();
+		// a frame comes before its zones
+		QCOMPARE(e.value("name").toString(), QString(i%2 ? "Frame" : "zone \"quoted\""));
+	}
+
+	// tracing stops when the limit is reached
+	profiler.startTrace(4);
+	for (int i=0; i<3; ++i)
+	{
+		profiler.beginFrame();
+		profiler.beginZone(zone);
+		profiler.endZone();
+		profiler.endFrame();
+	}
+	QVERIFY(!profiler.isTracing());
+}
+
+void TestStelProfiler::testOtherThread()
+{
+	StelProfiler profiler;
+	profiler.setEnabled(true);
+	QObject module;
+	module.setObjectName("WorkerMgr");
+	const int zone = profiler.registerZone("main");
+	profiler.beginFrame();
+
+	// zones are neither registered nor measured outside the main thread
+	QTest::ignoreMessage(QtWarningMsg, "StelProfiler: zone \"worker\" must be registered from the main thread");
+	ProfilerThread worker(&profiler, &module, zone);
+	worker.start();
+	QVERIFY(worker.wait(10000));
+	QCOMPARE(worker.zone, -1);
+	QCOMPARE(worker.moduleZone, -1);
+	QVERIFY(!worker.began);
+	QVERIFY(!profiler.beginZone(-1));
+	profiler.endFrame();
+
+	const QVariantMap stats = profiler.getStatistics();
+	QVERIFY(!stats.contains("worker"));
+	QVERIFY(!stats.contains("WorkerMgr.update"));
+	QVERIFY(profiler.registerZone("worker")>zone);
+	QVERIFY(profiler.getModuleZone(&module, StelProfiler::PhaseUpdate)>zone);
+}
@@ -0,0 +1,243 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelProjector.hpp"
+#include "StelProjectorClasses.hpp"
+
+#include <cmath>
+#include <cstring>
+
+QTEST_GUILESS_MAIN(TestStelProjector)
+
+namespace
+{
+	// Same as StelProjector::Mat4dTransform, but not recognized by the batched projection,
+	// which has to use the virtual forward() like for refraction.
+	class VirtualMatrixTransform : public StelProjector::ModelViewTranform
+	{
+	public:
+		VirtualMatrixTransform(const Mat4d& m) : transfoMat(m),
+			transfoMatf(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]) {}
+		void forward(Vec3d& v) const {v.transfo4d(transfoMat);}
+		void backward(Vec3d& v) const {v.transfo4d(transfoMat.transpose());}
+		void forward(Vec3f& v) const {v.transfo4d(transfoMatf);}
+		void backward(Vec3f& v) const {v.transfo4d(transfoMat.transpose());}
+		void combine(const Mat4d& m) {transfoMat = transfoMat*m;}
+		StelProjector::ModelViewTranformP clone() const {return StelProjector::ModelViewTranformP(new VirtualMatrixTransform(transfoMat));}
+		Mat4d getApproximateLinearTransfo() const {return transfoMat;}
+	private:
+		Mat4d transfoMat;
+		Mat4f transfoMatf;
+	};
+
+	const char* projectionTypes[] = {"perspective", "equalarea", "stereographic", "fisheye", "hammer",
+					 "cylinder", "mercator", "orthographic", "sinusoidal", "miller"};
+	const int projectionCount = sizeof(projectionTypes)/sizeof(projectionTypes[0]);
+}
+
+void TestStelProjector::initTestCase()
+{
+	// Random directions, and a few on the axes where several projections have special cases
+	qsrand(42);
+	points << Vec3d(0., 0., 1.) << Vec3d(0., 0., -1.) << Vec3d(1., 0., 0.) << Vec3d(0., 1., 0.) << Vec3d(0., -1., 0.);
+	while (points.size() < 100000)
+	{
+		Vec3d v(2.*qrand()/RAND_MAX-1., 2.*qrand()/RAND_MAX-1., 2.*qrand()/RAND_MAX-1.);
+		const double l = v.length();
+		if (l < 0.01 || l > 1.)
+			continue;
+		points << v/l;
+	}
+	foreach (const Vec3d& v, points)
+		pointsf << v.toVec3f();
+}
+
+StelProjectorP TestStelProjector::createProjector(const QString& type, bool linear, float fov, const StelProjector::ViewportClip& clip) const
+{
+	const Mat4d m = Mat4d::xrotation(-0.7) * Mat4d::zrotation(0.3);
+	StelProjector::ModelViewTranformP transform(linear ? static_cast<StelProjector::ModelViewTranform*>(new StelProjector::Mat4dTransform(m))
+							   : new VirtualMatrixTransform(m));
+	StelProjectorP prj;
+	if (type=="perspective") prj = StelProjectorP(new StelProjectorPerspective(transform));
+	else if (type=="equalarea") prj = StelProjectorP(new StelProjectorEqualArea(transform));
+	else if (type=="stereographic") prj = StelProjectorP(new StelProjectorStereographic(transform));
+	else if (type=="fisheye") prj = StelProjectorP(new StelProjectorFisheye(transform));
+	else if (type=="hammer") prj = StelProjectorP(new StelProjectorHammer(transform));
+	else if (type=="cylinder") prj = StelProjectorP(new StelProjectorCylinder(transform));
+	else if (type=="mercator") prj = StelProjectorP(new StelProjectorMercator(transform));
+	else if (type=="orthographic") prj = StelProjectorP(new StelProjectorOrthographic(transform));
+	else if (type=="sinusoidal") prj = StelProjectorP(new StelProjectorSinusoidal(transform));
+	else if (type=="miller") prj = StelProjectorP(new StelProjectorMiller(transform));
+	Q_ASSERT(!prj.isNull());
+
+	StelProjector::StelProjectorParams params;
+	params.viewportXywh.set(0, 0, 1280, 720);
+	params.viewportCenter.set(640.f, 360.f);
+	params.viewportFovDiameter = 720.f;
+	params.fov = fov;
+	params.zNear = 0.000001f;
+	params.zFar = 500.f;
+	params.widthStretch = 1.1f;
+	params.viewportClip = clip;
+	prj->init(params);
+	return prj;
+}
+
+void TestStelProjector::testBatchAccuracy_data()
+{
+	QTest::addColumn<QString>("type");
+	QTest::addColumn<bool>("linear");
+	for (int i=0; i<projectionCount; ++i)
+	{
+		QTest::newRow(qPrintable(QString("%1 matrix").arg(projectionTypes[i]))) << QString(projectionTypes[i]) << true;
+		QTest::newRow(qPrintable(QString("%1 virtual transform").arg(projectionTypes[i]))) << QString(projectionTypes[i]) << false;
+	}
+}
+
+void TestStelProjector::testBatchAccuracy()
+{
+	QFETCH(QString, type);
+	QFETCH(bool, linear);
+	StelProjectorP prj = createProjector(type, linear);
+	const int n = points.size();
+
+	// The batched kernel must give exactly the same results as the generic implementation
+	QVector<Vec3f> expected(n), actual(n);
+	prj->StelProjector::project(n, points.constData(), expected.data());
+	prj->project(n, points.constData(), actual.data());
+	for (int i=0; i<n; ++i)
+	{
+		if (std::memcmp(&expected[i], &actual[i], sizeof(Vec3f))!=0)
+			QFAIL(qPrintable(QString("double input %1: expected %2, got %3").arg(points.at(i).toString(), expected.at(i).toString(), actual.at(i).toString())));
+	}
+
+	prj->StelProjector::project(n, pointsf.constData(), expected.data());
+	prj->project(n, pointsf.constData(), actual.data());
+	for (int i=0; i<n; ++i)
+	{
+		if (std::memcmp(&expected[i], &actual[i], sizeof(Vec3f))!=0)
+			QFAIL(qPrintable(QString("float input %1: expected %2, got %3").arg(pointsf.at(i).toString(), expected.at(i).toString(), actual.at(i).toString())));
+	}
+
+	// and the same as projecting the points one by one
+	for (int i=0; i<n; i+=97)
+	{
+		Vec3d win;
+		prj->project(points.at(i), win);
+		const Vec3f winf(win[0], win[1], win[2]);
+		prj->project(1, points.constData()+i, actual.data());
+		QVERIFY(std::memcmp(&winf, &actual[0], sizeof(Vec3f))==0);
+	}
+}
+
+void TestStelProjector::benchmarkProjection_data()
+{
+	QTest::addColumn<QString>("type");
+	QTest::addColumn<bool>("batched");
+	for (int i=0; i<projectionCount; ++i)
+	{
+		QTest::newRow(qPrintable(QString("%1 generic").arg(projectionTypes[i]))) << QString(projectionTypes[i]) << false;
+		QTest::newRow(qPrintable(QString("%1 batched").arg(projectionTypes[i]))) << QString(projectionTypes[i]) << true;
+	}
+}
+
+void TestStelProjector::benchmarkProjection()
+{
+	QFETCH(QString, type);
+	QFETCH(bool, batched);
+	StelProjectorP prj = createProjector(type, true);
+	const int n = points.size();
+	QVector<Vec3f> out(n);
+	if (batched)
+	{
+		QBENCHMARK
+		{
+			prj->project(n, points.constData(), out.data());
+		}
+	}
+	else
+	{
+		QBENCHMARK
+		{
+			prj->StelProjector::project(n, points.constData(), out.data());
+		}
+	}
+}
+
+void TestStelProjector::testViewportClip_data()
+{
+	QTest::addColumn<QString>("type");
+	QTest::addColumn<bool>("disk");
+	for (int i=0; i<projectionCount; ++i)
+	{
+		QTest::newRow(qPrintable(QString("%1 disk").arg(projectionTypes[i]))) << QString(projectionTypes[i]) << true;
+		QTest::newRow(qPrintable(QString("%1 rectangle").arg(projectionTypes[i]))) << QString(projectionTypes[i]) << false;
+	}
+}
+
+void TestStelProjector::testViewportClip()
+{
+	QFETCH(QString, type);
+	QFETCH(bool, disk);
+	StelProjector::ViewportClip clip;
+	clip.shape = disk ? StelProjector::ViewportClip::ClipDisk : StelProjector::ViewportClip::ClipRectangle;
+	clip.width = disk ? 600.f : 500.f;
+	clip.height = disk ? 600.f : 300.f;
+	clip.angle = disk ? 0.f : 30.f;
+	const StelProjectorP prj = createProjector(type, true, 10.f, clip);
+	const StelProjectorP unclipped = createProjector(type, true, 10.f);
+
+	// The clipped regions are smaller than the viewport
+	const SphericalRegionP region = prj->getViewportConvexPolygon();
+	const SphericalCap& cap = prj->getBoundingCap();
+	QVERIFY(cap.d > unclipped->getBoundingCap().d);
+	Vec3d corner;
+	QVERIFY(prj->unProject(2., 2., corner));
+	corner.normalize();
+	QVERIFY(!region->contains(corner));
+	QVERIFY(!cap.contains(corner));
+
+	// but they contain every direction visible in the footprint
+	Vec3d center;
+	QVERIFY(prj->unProject(640., 360., center));
+	center.normalize();
+	const double a = clip.angle*M_PI/180.;
+	int inside = 0;
+	for (int i=0; i<points.size(); ++i)
+	{
+		// Directions around the center of the view
+		Vec3d v = center + points.at(i)*0.1;
+		v.normalize();
+		Vec3d win;
+		if (!prj->project(v, win))
+			continue;
+		const double dx = win[0]-640.;
+		const double dy = win[1]-360.;
+		// Keep away from the edges, where the outline of the region is approximated
+		const double u = dx*cos(a) + dy*sin(a);
+		const double w = -dx*sin(a) + dy*cos(a);
+		const bool visible = disk ? u*u+w*w < 295.*295. : (std::fabs(u) < 245. && std::fabs(w) < 145.);
+		if (!visible)
+			continue;
+		++inside;
+		if (!region->contains(v) || !cap.contains(v))
+			QFAIL(qPrintable(QString("%1 at %2, %3 is not in the clip region").arg(v.toString()).arg(win[0]).arg(win[1])));
+	}
+	QVERIFY(inside > 1000);
+}
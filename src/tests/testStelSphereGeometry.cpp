@@ -544,3 +544,39 @@ void TestStelSphericalGeometry::benchmarkCreatePolygon()
 		SphericalPolygon holySquare(contours);
 	}
 }
+
+void TestStelSphericalGeometry::testCreatePolygons()
+{
+	// Squares with a hole, spread over the whole sphere so that many cross the octahedron sides
+	QVector<QVector<QVector<Vec3d> > > contoursList;
+	for (int i=0; i<500; ++i)
+	{
+		const double ra = i*0.37;
+		const double dec = std::asin(-0.95+1.9*(i%97)/96.);
+		QVector<QVector<Vec3d> > contours;
+		QVector<Vec3d> c1(4);
+		StelUtils::spheToRect(ra-0.1, dec-0.1, c1[3]);
+		StelUtils::spheToRect(ra+0.1, dec-0.1, c1[2]);
+		StelUtils::spheToRect(ra+0.1, dec+0.1, c1[1]);
+		StelUtils::spheToRect(ra-0.1, dec+0.1, c1[0]);
+		contours.append(c1);
+		QVector<Vec3d> c2(4);
+		StelUtils::spheToRect(ra-0.05, dec+0.05, c2[3]);
+		StelUtils::spheToRect(ra+0.05, dec+0.05, c2[2]);
+		StelUtils::spheToRect(ra+0.05, dec-0.05, c2[1]);
+		StelUtils::spheToRect(ra-0.05, dec-0.05, c2[0]);
+		contours.append(c2);
+		contoursList.append(contours);
+	}
+
+	const QVector<SphericalRegionP> polygons = SphericalPolygon::createPolygons(contoursList);
+	QCOMPARE(polygons.size(), contoursList.size());
+	for (int i=0; i<polygons.size(); ++i)
+	{
+		const SphericalPolygon reference(contoursList.at(i));
+		QVERIFY(polygons.at(i)->getType()==SphericalRegion::Polygon);
+		QCOMPARE(polygons.at(i)->getFillVertexArray().vertex, reference.getFillVertexArray().vertex);
+		QCOMPARE(polygons.at(i)->getOutlineVertexArray().vertex, reference.getOutlineVertexArray().vertex);
+		QVERIFY(std::fabs(polygons.at(i)->getArea()-reference.getArea())<1e-12);
+	}
+}
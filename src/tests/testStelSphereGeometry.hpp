@@ -44,6 +44,7 @@ private slots:
 	void benchmarkGetIntersection();
 	void testSerialize();
 	void benchmarkCreatePolygon();
+	void testCreatePolygons();
 private:
 	SphericalPolygon holySquare;
 	SphericalPolygon bigSquare;
@@ -21,8 +21,10 @@
 
 #include <QObject>
 #include <QDebug>
+#include <QSet>
 #include <QTest>
 
+#include <algorithm>
 #include <stdexcept>
 
 #include "StelSphereGeometry.hpp"
@@ -40,6 +42,47 @@ class TestRegionObject : public StelRegionObject
 		SphericalRegionP region;
 };
 
+class TestPointObject : public StelRegionObject
+{
+	public:
+		TestPointObject(const Vec3d& p, SphericalRegionP reg) : point(p), region(reg) {;}
+		virtual SphericalRegionP getRegion() const { return region; }
+		virtual Vec3d getPointInRegion() const { return point; }
+		Vec3d point;
+		SphericalRegionP region;
+};
+
+static Vec3d randomDirection()
+{
+	Vec3d v;
+	StelUtils::spheToRect(2.*M_PI*qrand()/RAND_MAX, std::asin(2.*qrand()/RAND_MAX-1.), v);
+	return v;
+}
+
+// Points, and for one object in 4 a small cap around the point
+static QVector<StelRegionObjectP> createObjects(int n)
+{
+	QVector<StelRegionObjectP> objects;
+	objects.reserve(n);
+	for (int i=0; i<n; ++i)
+	{
+		const Vec3d p = randomDirection();
+		SphericalRegionP region(i%4==0 ? static_cast<SphericalRegion*>(new SphericalCap(p, std::cos(0.01*(1+i%7))))
+					       : static_cast<SphericalRegion*>(new SphericalPoint(p)));
+		objects.append(StelRegionObjectP(new TestPointObject(p, region)));
+	}
+	return objects;
+}
+
+struct CollectFuncObject
+{
+	void operator()(const StelRegionObject* obj)
+	{
+		objects.append(obj);
+	}
+	QVector<const StelRegionObject*> objects;
+};
+
 void TestStelSphericalIndex::initTestCase()
 {
 }
@@ -102,3 +145,189 @@ void TestStelSphericalIndex::testBase()
 	QVERIFY(countFunc.count==30000);
 }
 
+void TestStelSphericalIndex::testBulkBuild()
+{
+	qsrand(1);
+	const QVector<StelRegionObjectP> objects = createObjects(20000);
+	StelSphericalIndex bulk(objects, 50);
+	StelSphericalIndex incremental(50);
+	foreach (const StelRegionObjectP& obj, objects)
+		incremental.insert(obj);
+	QCOMPARE(bulk.count(), 20000u);
+	QCOMPARE(incremental.count(), 20000u);
+
+	for (int q=0; q<50; ++q)
+	{
+		const SphericalCap cap(randomDirection(), std::cos(0.02*(q+1)));
+		CollectFuncObject b, i, p, c;
+		bulk.processIntersectingRegions(&cap, b);
+		incremental.processIntersectingRegions(&cap, i);
+		bulk.processIntersectingPointInRegions(&cap, p);
+		bulk.processBoundingCapIntersectingRegions(cap, c);
+
+		// Compare with all the objects
+		QSet<const StelRegionObject*> expected, expectedPoints;
+		foreach (const StelRegionObjectP& obj, objects)
+		{
+			if (cap.intersects(obj->getRegion().data()))
+				expected.insert(obj.data());
+			if (cap.contains(obj->getPointInRegion()))
+				expectedPoints.insert(obj.data());
+		}
+		QCOMPARE(b.objects.size(), expected.size());
+		QCOMPARE(b.objects.toList().toSet(), expected);
+		QCOMPARE(i.objects.toList().toSet(), expected);
+		QCOMPARE(c.objects.toList().toSet(), expected);
+		QCOMPARE(p.objects.toList().toSet(), expectedPoints);
+	}
+
+	// Bulk insertion in an index with objects
+	StelSphericalIndex mixed(50);
+	mixed.insert(objects.mid(0, 100));
+	mixed.insert(objects.mid(100));
+	CollectFuncObject all;
+	mixed.processAll(all);
+	QCOMPARE(all.objects.size(), objects.size());
+}
+
+void TestStelSphericalIndex::testParts()
+{
+	qsrand(2);
+	const StelSphericalIndex index(createObjects(20000), 50);
+	const SphericalCap cap(Vec3d(1,0,0), std::cos(1.));
+	CollectFuncObject whole;
+	index.processIntersectingRegions(&cap, whole);
+
+	QVector<CollectFuncObject> funcs(StelSphericalIndex::PartCount);
+	CollectFuncObject* partFuncs = funcs.data();
+	index.processPartsParallel([&](int part) {index.processIntersectingRegions(&cap, partFuncs[part], part);});
+	QVector<const StelRegionObject*> merged;
+	foreach (const CollectFuncObject& f, funcs)
+		merged += f.objects;
+	// Same objects in the same order
+	QCOMPARE(merged, whole.objects);
+}
+
+void TestStelSphericalIndex::testFindNearest()
+{
+	qsrand(3);
+	const QVector<StelRegionObjectP> objects = createObjects(20000);
+	const StelSphericalIndex index(objects, 50);
+
+	const int ks[] = {1, 5, 50};
+	const double maxAngles[] = {M_PI, 0.05, 0.002};
+	for (int q=0; q<30; ++q)
+	{
+		const Vec3d v = randomDirection();
+		// Brute force distances of all the objects
+		QVector<QPair<double, const StelRegionObject*> > distances;
+		foreach (const StelRegionObjectP& obj, objects)
+		{
+			const Vec3d p = obj->getPointInRegion();
+			distances.append(qMakePair(std::acos(qBound(-1., v.dot(p)/p.length(), 1.)), static_cast<const StelRegionObject*>(obj.data())));
+		}
+		std::sort(distances.begin(), distances.end());
+
+		for (int k=0; k<3; ++k)
+		{
+			for (int a=0; a<3; ++a)
+			{
+				const QVector<StelRegionObjectP> nearest = index.findNearest(v, ks[k], maxAngles[a]);
+				int expectedCount = 0;
+				while (expectedCount<ks[k] && expectedCount<distances.size() && distances.at(expectedCount).first<=maxAngles[a])
+					++expectedCount;
+				QCOMPARE(nearest.size(), expectedCount);
+				for (int i=0; i<nearest.size(); ++i)
+					QCOMPARE(static_cast<const StelRegionObject*>(nearest.at(i).data()), distances.at(i).second);
+			}
+		}
+	}
+	QVERIFY(index.findNearest(Vec3d(1,0,0), 0).isEmpty());
+	QVERIFY(StelSphericalIndex().findNearest(Vec3d(1,0,0), 3).isEmpty());
+}
+
+void TestStelSphericalIndex::benchmarkBuild_data()
+{
+	QTest::addColumn<int>("count");
+	QTest::addColumn<bool>("bulk");
+	// 10^7 objects need several GB, too much for the test suite
+	QTest::newRow("100000 insert") << 100000 << false;
+	QTest::newRow("100000 bulk") << 100000 << true;
+	QTest::newRow("1000000 insert") << 1000000 << false;
+	QTest::newRow("1000000 bulk") << 1000000 << true;
+}
+
+void TestStelSphericalIndex::benchmarkBuild()
+{
+	QFETCH(int, count);
+	QFETCH(bool, bulk);
+	qsrand(4);
+	const QVector<StelRegionObjectP> objects = createObjects(count);
+	QBENCHMARK_ONCE
+	{
+		if (bulk)
+		{
+			StelSphericalIndex index(objects);
+			QCOMPARE(index.count(), (unsigned int)count);
+		}
+		else
+		{
+			StelSphericalIndex index;
+			foreach (const StelRegionObjectP& obj, objects)
+				index.insert(obj);
+			CountFuncObject func;
+			index.processAll(func);
+			QCOMPARE(func.count, count);
+		}
+	}
+}
+
+void TestStelSphericalIndex::benchmarkQuery_data()
+{
+	QTest::addColumn<int>("count");
+	QTest::addColumn<QString>("query");
+	QTest::newRow("100000 cap") << 100000 << "cap";
+	QTest::newRow("100000 cap parallel") << 100000 << "parallel";
+	QTest::newRow("100000 nearest") << 100000 << "nearest";
+	QTest::newRow("1000000 cap") << 1000000 << "cap";
+	QTest::newRow("1000000 cap parallel") << 1000000 << "parallel";
+	QTest::newRow("1000000 nearest") << 1000000 << "nearest";
+}
+
+void TestStelSphericalIndex::benchmarkQuery()
+{
+	QFETCH(int, count);
+	QFETCH(QString, query);
+	qsrand(5);
+	const StelSphericalIndex index(createObjects(count));
+	QVector<Vec3d> directions(100);
+	for (int i=0; i<directions.size(); ++i)
+		directions[i] = randomDirection();
+
+	// 100 queries of a field of 10 degrees
+	int found = 0;
+	QBENCHMARK
+	{
+		foreach (const Vec3d& v, directions)
+		{
+			const SphericalCap cap(v, std::cos(5.*M_PI/180.));
+			if (query=="cap")
+			{
+				CountFuncObject func;
+				index.processIntersectingPointInRegions(&cap, func);
+				found += func.count;
+			}
+			else if (query=="parallel")
+			{
+				QVector<CountFuncObject> funcs(StelSphericalIndex::PartCount);
+				CountFuncObject* partFuncs = funcs.data();
+				index.processPartsParallel([&](int part) {index.processIntersectingPointInRegions(&cap, partFuncs[part], part);});
+				foreach (const CountFuncObject& f, funcs)
+					found += f.count;
+			}
+			else
+				found += index.findNearest(v, 10).size();
+		}
+	}
+	QVERIFY(found>0);
+}
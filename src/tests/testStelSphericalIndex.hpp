@@ -31,6 +31,13 @@ Q_OBJECT
 private slots:
 	void initTestCase();
 	void testBase();
+	void testBulkBuild();
+	void testParts();
+	void testFindNearest();
+	void benchmarkBuild_data();
+	void benchmarkBuild();
+	void benchmarkQuery_data();
+	void benchmarkQuery();
 private:
 };
 
@@ -0,0 +1,91 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelSpriteBatch.hpp"
+
+#include <cmath>
+
+QTEST_GUILESS_MAIN(TestStelSpriteBatch)
+
+void TestStelSpriteBatch::initTestCase()
+{
+	for (int i = 0; i < 90000; ++i)
+		positions.append(Vec2f((i*37)%1920, (i*53)%1080));
+}
+
+void TestStelSpriteBatch::testGeometry()
+{
+	StelSpriteBatch batch;
+	batch.setScale(2.f);
+	const Vec4f color(0.5f, 0.25f, 1.f, 1.f);
+	batch.add(100.f, 200.f, 6.f, color);
+	batch.add(100.f, 200.f, 6.f, 90.f, color);
+
+	QCOMPARE(batch.size(), 2);
+	QCOMPARE(batch.vertices.size(), 12);
+	QCOMPARE(batch.texCoords.size(), 12);
+	QCOMPARE(batch.colors.size(), 12);
+
+	// Axis aligned: the first triangle starts at the lower left corner, scaled radius is 12 pixels
+	QVERIFY(std::fabs(batch.vertices.at(0)[0]-88.f)<1e-4f);
+	QVERIFY(std::fabs(batch.vertices.at(0)[1]-188.f)<1e-4f);
+	QVERIFY(std::fabs(batch.vertices.at(5)[0]-112.f)<1e-4f);
+	QVERIFY(std::fabs(batch.vertices.at(5)[1]-212.f)<1e-4f);
+	QVERIFY(batch.texCoords.at(5)==Vec2f(1.f, 1.f));
+	QVERIFY(batch.colors.at(3)==color);
+
+	// Rotated by 90 degrees the lower left corner ends up at the lower right
+	QVERIFY(std::fabs(batch.vertices.at(6)[0]-112.f)<1e-4f);
+	QVERIFY(std::fabs(batch.vertices.at(6)[1]-188.f)<1e-4f);
+}
+
+void TestStelSpriteBatch::testClear()
+{
+	StelSpriteBatch batch;
+	batch.reserve(10);
+	batch.add(0.f, 0.f, 1.f, Vec4f(1.f, 1.f, 1.f, 1.f));
+	QVERIFY(!batch.isEmpty());
+	batch.clear();
+	QVERIFY(batch.isEmpty());
+	QCOMPARE(batch.size(), 0);
+}
+
+void TestStelSpriteBatch::benchmarkCollect()
+{
+	StelSpriteBatch batch;
+	const Vec4f color(1.f, 0.5f, 0.2f, 1.f);
+	QBENCHMARK {
+		batch.clear();
+		for (int i = 0; i < positions.size(); ++i)
+			batch.add(positions.at(i)[0], positions.at(i)[1], 6.f, color);
+	}
+	QCOMPARE(batch.size(), positions.size());
+}
+
+void TestStelSpriteBatch::benchmarkCollectRotated()
+{
+	StelSpriteBatch batch;
+	const Vec4f color(1.f, 0.5f, 0.2f, 1.f);
+	QBENCHMARK {
+		batch.clear();
+		for (int i = 0; i < positions.size(); ++i)
+			batch.add(positions.at(i)[0], positions.at(i)[1], 6.f, (float)(i%360), color);
+	}
+	QCOMPARE(batch.size(), positions.size());
+}
@@ -0,0 +1,311 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelTextureLoader.hpp"
+
+#include <QDataStream>
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+
+QTEST_GUILESS_MAIN(TestStelTextureLoader)
+
+QByteArray TestStelTextureLoader::makeKTX(GLint format, int width, int height, const QVector<QByteArray>& levels)
+{
+	static const char identifier[12] = {'\xAB', 'K', 'T', 'X', ' ', '1', '1', '\xBB', '\r', '\n', '\x1A', '\n'};
+	QByteArray ret(identifier, sizeof(identifier));
+	QDataStream out(&ret, QIODevice::WriteOnly | QIODevice::Append);
+	out.setByteOrder(QDataStream::LittleEndian);
+	// endianness, glType, glTypeSize, glFormat, glInternalFormat, glBaseInternalFormat
+	out << (quint32)0x04030201 << (quint32)0 << (quint32)1 << (quint32)0 << (quint32)format << (quint32)GL_RGBA;
+	// pixelWidth, pixelHeight, pixelDepth, numberOfArrayElements, numberOfFaces, numberOfMipmapLevels, bytesOfKeyValueData
+	out << (quint32)width << (quint32)height << (quint32)0 << (quint32)0 << (quint32)1 << (quint32)levels.size() << (quint32)0;
+	foreach (const QByteArray& level, levels)
+	{
+		out << (quint32)level.size();
+		out.writeRawData(level.constData(), level.size());
+		for (int i=level.size(); i%4; ++i)
+			out << (quint8)0;
+	}
+	return ret;
+}
+
+QByteArray TestStelTextureLoader::makeDDS(const char* fourCC, quint32 width, quint32 height, const QVector<QByteArray>& levels, quint32 dxgiFormat)
+{
+	QByteArray ret("DDS ");
+	QDataStream out(&ret, QIODevice::WriteOnly | QIODevice::Append);
+	out.setByteOrder(QDataStream::LittleEndian);
+	// size, flags (with DDSD_MIPMAPCOUNT), height, width, pitchOrLinearSize, depth, mipMapCount, reserved
+	out << (quint32)124 << (quint32)(0x1007 | 0x20000) << height << width << (quint32)0 << (quint32)0 << (quint32)levels.size();
+	for (int i=0; i<11; ++i)
+		out << (quint32)0;
+	// pixel format: size, flags (DDPF_FOURCC), fourCC, then unused bit masks
+	out << (quint32)32 << (quint32)0x4;
+	out.writeRawData(fourCC, 4);
+	for (int i=0; i<5; ++i)
+		out << (quint32)0;
+	// caps and reserved
+	for (int i=0; i<5; ++i)
+		out << (quint32)0;
+	if (dxgiFormat)
+	{
+		// dxgiFormat, resourceDimension (2D), miscFlag, arraySize, miscFlags2
+		out << dxgiFormat << (quint32)3 << (quint32)0 << (quint32)1 << (quint32)0;
+	}
+	foreach (const QByteArray& level, levels)
+		out.writeRawData(level.constData(), level.size());
+	return ret;
+}
+
+QVector<QByteArray> TestStelTextureLoader::makeLevels(int width, int height, int blockSize)
+{
+	QVector<QByteArray> levels;
+	while (true)
+	{
+		levels << QByteArray(qMax(1, (width+3)/4) * qMax(1, (height+3)/4) * blockSize, (char)levels.size());
+		if (width==1 && height==1)
+			break;
+		width = qMax(1, width/2);
+		height = qMax(1, height/2);
+	}
+	return levels;
+}
+
+void TestStelTextureLoader::testKTXFullMipChain()
+{
+	// 8x4 DXT1: 8 bytes per block of 4x4 pixels, the levels are 8x4, 4x2, 2x1 and 1x1
+	const QVector<QByteArray> levels = makeLevels(8, 4, 8);
+	QCOMPARE(levels.size(), 4);
+	const QByteArray file = makeKTX(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 8, 4, levels);
+
+	StelTextureLoader::GLData data;
+	QVERIFY(StelTextureLoader::readKTX(file, data));
+	QVERIFY(data.loaderError.isEmpty());
+	QCOMPARE(data.width, 8);
+	QCOMPARE(data.height, 4);
+	QCOMPARE(data.format, (GLint)GL_COMPRESSED_RGBA_S3TC_DXT1_EXT);
+	QCOMPARE(data.levels, levels);
+	// A DDS file is not a KTX file
+	StelTextureLoader::GLData other;
+	QVERIFY(!StelTextureLoader::readKTX(makeDDS("DXT1", 8, 4, levels), other));
+
+	// The full chain is used for a mipmapped texture
+	StelTextureLoader::LoaderParams params;
+	params.generateMipmaps = true;
+	params.compressedFormats << GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	data = StelTextureLoader::compressedToGLData(file, params);
+	QVERIFY(data.compressed);
+	QCOMPARE(data.levels, levels);
+	QCOMPARE(data.getSize(), 16+8+8+8);
+
+	// Only the first level is kept without mipmaps
+	params.generateMipmaps = false;
+	data = StelTextureLoader::compressedToGLData(file, params);
+	QCOMPARE(data.levels.size(), 1);
+	QCOMPARE(data.levels.first(), levels.first());
+}
+
+void TestStelTextureLoader::testKTXTruncated()
+{
+	const QVector<QByteArray> levels = makeLevels(8, 8, 16);
+	const QByteArray file = makeKTX(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 8, 8, levels);
+
+	// The last level is missing, the mipmaps can't be used
+	StelTextureLoader::GLData data;
+	QVERIFY(StelTextureLoader::readKTX(file.left(file.size()-4), data));
+	QCOMPARE(data.levels.size(), levels.size()-1);
+	StelTextureLoader::LoaderParams params;
+	params.generateMipmaps = true;
+	params.compressedFormats << GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	data = StelTextureLoader::compressedToGLData(file.left(file.size()-4), params);
+	QCOMPARE(data.levels.size(), 1);
+
+	// Not even the first level
+	data = StelTextureLoader::GLData();
+	QVERIFY(StelTextureLoader::readKTX(file.left(64+4+10), data));
+	QVERIFY(data.levels.isEmpty());
+	QVERIFY(!data.loaderError.isEmpty());
+
+	// Not even the header
+	data = StelTextureLoader::GLData();
+	QVERIFY(!StelTextureLoader::readKTX(file.left(40), data));
+	data = StelTextureLoader::compressedToGLData(file.left(40), params);
+	QVERIFY(data.levels.isEmpty());
+	QVERIFY(!data.loaderError.isEmpty());
+}
+
+void TestStelTextureLoader::testKTXEndianness()
+{
+	QByteArray file = makeKTX(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 4, 4, makeLevels(4, 4, 8));
+	// Written by a big endian machine
+	file[12] = 0x04;
+	file[13] = 0x03;
+	file[14] = 0x02;
+	file[15] = 0x01;
+	StelTextureLoader::GLData data;
+	QVERIFY(StelTextureLoader::readKTX(file, data));
+	QVERIFY(data.levels.isEmpty());
+	QVERIFY(!data.loaderError.isEmpty());
+}
+
+void TestStelTextureLoader::testDDSFullMipChain()
+{
+	// 12x8 DXT5: 16 bytes per block, the levels are 12x8, 6x4, 3x2, 1x1 (3x2 and 1x1 use a single block)
+	const QVector<QByteArray> levels = makeLevels(12, 8, 16);
+	QCOMPARE(levels.size(), 4);
+	QCOMPARE(levels.first().size(), 3*2*16);
+	const QByteArray file = makeDDS("DXT5", 12, 8, levels);
+
+	StelTextureLoader::GLData data;
+	QVERIFY(StelTextureLoader::readDDS(file, data));
+	QVERIFY(data.loaderError.isEmpty());
+	QCOMPARE(data.width, 12);
+	QCOMPARE(data.height, 8);
+	QCOMPARE(data.format, (GLint)GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+	QCOMPARE(data.levels, levels);
+
+	StelTextureLoader::LoaderParams params;
+	params.generateMipmaps = true;
+	params.compressedFormats << GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	data = StelTextureLoader::compressedToGLData(file, params);
+	QVERIFY(data.compressed);
+	QCOMPARE(data.levels, levels);
+}
+
+void TestStelTextureLoader::testDDSTruncated()
+{
+	const QVector<QByteArray> levels = makeLevels(8, 8, 8);
+	const QByteArray file = makeDDS("DXT1", 8, 8, levels);
+
+	StelTextureLoader::GLData data;
+	QVERIFY(StelTextureLoader::readDDS(file.left(file.size()-1), data));
+	QCOMPARE(data.levels.size(), levels.size()-1);
+
+	data = StelTextureLoader::GLData();
+	QVERIFY(StelTextureLoader::readDDS(file.left(128+10), data));
+	QVERIFY(data.levels.isEmpty());
+	QVERIFY(!data.loaderError.isEmpty());
+}
+
+void TestStelTextureLoader::testDDSHugeSize()
+{
+	// The size of the first level overflows an int, it must be reported as truncated
+	const QByteArray file = makeDDS("DXT5", 0xFFFFFFF0u, 0xFFFFFFF0u, makeLevels(4, 4, 16));
+	StelTextureLoader::GLData data;
+	QVERIFY(StelTextureLoader::readDDS(file, data));
+	QVERIFY(data.levels.isEmpty());
+	QVERIFY(!data.loaderError.isEmpty());
+}
+
+void TestStelTextureLoader::testDDSDX10()
+{
+	// BC7 is only available with the DX10 header
+	const QVector<QByteArray> levels = makeLevels(4, 4, 16);
+	StelTextureLoader::GLData data;
+	QVERIFY(StelTextureLoader::readDDS(makeDDS("DX10", 4, 4, levels, 98), data));
+	QVERIFY(data.loaderError.isEmpty());
+	QCOMPARE(data.format, (GLint)GL_COMPRESSED_RGBA_BPTC_UNORM);
+	QCOMPARE(data.levels, levels);
+
+	// BC1 in a DX10 header
+	data = StelTextureLoader::GLData();
+	QVERIFY(StelTextureLoader::readDDS(makeDDS("DX10", 4, 4, makeLevels(4, 4, 8), 71), data));
+	QCOMPARE(data.format, (GLint)GL_COMPRESSED_RGBA_S3TC_DXT1_EXT);
+	QCOMPARE(data.levels.size(), 3);
+
+	// Unknown DXGI format
+	data = StelTextureLoader::GLData();
+	QVERIFY(StelTextureLoader::readDDS(makeDDS("DX10", 4, 4, levels, 2), data));
+	QVERIFY(data.levels.isEmpty());
+	QVERIFY(!data.loaderError.isEmpty());
+}
+
+void TestStelTextureLoader::testUnsupportedFormat()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	const QString imagePath = dir.path() + "/texture.png";
+	QImage image(4, 4, QImage::Format_RGB32);
+	image.fill(qRgb(10, 20, 30));
+	QVERIFY(image.save(imagePath));
+	QFile dds(dir.path() + "/texture.dds");
+	QVERIFY(dds.open(QIODevice::WriteOnly));
+	dds.write(makeDDS("DX10", 4, 4, makeLevels(4, 4, 16), 98));
+	dds.close();
+	QCOMPARE(StelTextureLoader::findCompressedFile(imagePath), dds.fileName());
+
+	// The compressed copy is used when its format is supported
+	StelTextureLoader::LoaderParams params;
+	params.compressedFormats << GL_COMPRESSED_RGBA_BPTC_UNORM;
+	StelTextureLoader::GLData data = StelTextureLoader::loadFromPath(imagePath, params);
+	QVERIFY(data.compressed);
+	QCOMPARE(data.format, (GLint)GL_COMPRESSED_RGBA_BPTC_UNORM);
+
+	// Else the image is decoded
+	params.compressedFormats.clear();
+	params.compressedFormats << GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	data = StelTextureLoader::loadFromPath(imagePath, params);
+	QVERIFY(!data.compressed);
+	QCOMPARE(data.format, (GLint)GL_RGB);
+	QCOMPARE(data.levels.size(), 1);
+	QCOMPARE(data.levels.first().size(), 4*4*3);
+	QCOMPARE((uchar)data.levels.first().at(0), (uchar)10);
+
+	// An unsupported compressed file opened directly is an error
+	data = StelTextureLoader::loadFromPath(dds.fileName(), params);
+	QVERIFY(data.levels.isEmpty());
+	QVERIFY(!data.loaderError.isEmpty());
+}
+
+void TestStelTextureLoader::testGenerateMipmapsOddSize()
+{
+	// 5x3 pixels with one byte each: the levels are 2x1 and 1x1, the last row and column are dropped
+	StelTextureLoader::GLData data;
+	data.width = 5;
+	data.height = 3;
+	QByteArray pixels;
+	for (int y=0; y<3; ++y)
+		for (int x=0; x<5; ++x)
+			pixels.append((char)(x + 10*y));
+	data.levels << pixels;
+	StelTextureLoader::generateMipmaps(data, 1);
+	QCOMPARE(data.levels.size(), 3);
+	QCOMPARE(data.levels.at(1).size(), 2);
+	QCOMPARE(data.levels.at(2).size(), 1);
+	QCOMPARE((int)data.levels.at(1).at(0), (0+1+10+11+2)/4);
+	QCOMPARE((int)data.levels.at(1).at(1), (2+3+12+13+2)/4);
+	QCOMPARE((int)data.levels.at(2).at(0), (6+8+6+8+2)/4);
+}
+
+void TestStelTextureLoader::testGenerateMipmapsNonPowerOfTwo()
+{
+	// 6x10 RGB pixels: the levels are 3x5, 1x2 and 1x1
+	StelTextureLoader::GLData data;
+	data.width = 6;
+	data.height = 10;
+	data.levels << QByteArray(6*10*3, (char)100);
+	StelTextureLoader::generateMipmaps(data, 3);
+	QCOMPARE(data.levels.size(), 4);
+	QCOMPARE(data.levels.at(1).size(), 3*5*3);
+	QCOMPARE(data.levels.at(2).size(), 1*2*3);
+	QCOMPARE(data.levels.at(3).size(), 1*1*3);
+	// A uniform image stays uniform
+	for (int i=1; i<data.levels.size(); ++i)
+		QCOMPARE(data.levels.at(i), QByteArray(data.levels.at(i).size(), (char)100));
+}
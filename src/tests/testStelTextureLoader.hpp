@@ -0,0 +1,52 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTSTELTEXTURELOADER_HPP_
+#define _TESTSTELTEXTURELOADER_HPP_
+
+#include <QObject>
+#include <QTest>
+
+#include "StelTextureLoader.hpp"
+
+class TestStelTextureLoader : public QObject
+{
+Q_OBJECT
+private slots:
+	void testKTXFullMipChain();
+	void testKTXTruncated();
+	void testKTXEndianness();
+	void testDDSFullMipChain();
+	void testDDSTruncated();
+	void testDDSHugeSize();
+	void testDDSDX10();
+	void testUnsupportedFormat();
+	void testGenerateMipmapsOddSize();
+	void testGenerateMipmapsNonPowerOfTwo();
+private:
+	//! Build a KTX file with the given levels of compressed data
+	static QByteArray makeKTX(GLint format, int width, int height, const QVector<QByteArray>& levels);
+	//! Build a DDS file with the given four character code and levels of compressed data.
+	//! If dxgiFormat is not 0, the DX10 extended header is added.
+	static QByteArray makeDDS(const char* fourCC, quint32 width, quint32 height, const QVector<QByteArray>& levels, quint32 dxgiFormat=0);
+	//! Levels of blocks for the full mip chain of a compressed image, filled with the index of the level
+	static QVector<QByteArray> makeLevels(int width, int height, int blockSize);
+};
+
+#endif // _TESTSTELTEXTURELOADER_HPP_
@@ -0,0 +1,222 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "tests/testTelescopeServer.hpp"
+#include "Server.hpp"
+#include "Connection.hpp"
+#include "SerialPort.hpp"
+#include "LogFile.hpp"
+
+#include <QTextStream>
+#include <QVector>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+QTEST_GUILESS_MAIN(TestTelescopeServer)
+
+namespace
+{
+	//! Hundreds of clients, within the default limit of 1024 open files
+	const int CLIENTS = 400;
+
+	//! A server which counts the goto commands, standing for the telescope
+	class CountingServer : public Server
+	{
+	public:
+		CountingServer() : gotos(0), lastRa(0), lastDec(0) {}
+		void add(Socket* s) {addConnection(s);}
+		void broadcastPosition(unsigned int ra, int dec) {sendPosition(ra, dec, 0);}
+		int gotos;
+		unsigned int lastRa;
+		int lastDec;
+	private:
+		void gotoReceived(unsigned int ra, int dec)
+		{
+			gotos++;
+			lastRa = ra;
+			lastDec = dec;
+		}
+	};
+
+	//! Writes a "MessageGoto" packet of the Stellarium telescope protocol
+	bool writeGoto(int fd, unsigned int ra, int dec)
+	{
+		unsigned char packet[20];
+		packet[0] = 20; packet[1] = 0;
+		packet[2] = 0;  packet[3] = 0;
+		long long int now = GetNow();
+		for (int i=4; i<12; ++i, now>>=8)
+			packet[i] = (unsigned char)now;
+		for (int i=12; i<16; ++i, ra>>=8)
+			packet[i] = (unsigned char)ra;
+		unsigned int d = (unsigned int)dec;
+		for (int i=16; i<20; ++i, d>>=8)
+			packet[i] = (unsigned char)d;
+		return write(fd, packet, sizeof(packet))==sizeof(packet);
+	}
+
+	//! Reads a "MessageCurrentPosition" packet and returns its right ascension, or -1
+	qint64 readPositionRa(int fd)
+	{
+		unsigned char packet[24];
+		int got = 0;
+		for (int tries=0; got<24 && tries<1000; ++tries)
+		{
+			const int rc = read(fd, packet+got, 24-got);
+			if (rc>0)
+				got += rc;
+			else if (rc==0)
+				return -1;
+			else
+				usleep(100);
+		}
+		if (got<24 || packet[0]!=24 || packet[2]!=0)
+			return -1;
+		return packet[12] | (packet[13]<<8) | (packet[14]<<16) | ((qint64)packet[15]<<24);
+	}
+
+	//! Runs steps until the condition is true or a second has passed
+	template<class Condition> bool stepUntil(Server& server, Condition done)
+	{
+		const long long int end = GetNow() + 1000000;
+		while (!done())
+		{
+			if (GetNow() > end)
+				return false;
+			server.step(10000);
+		}
+		return true;
+	}
+
+	//! Creates the socket pairs of the clients. The server side is added to the server.
+	QVector<int> connectClients(CountingServer& server, int count)
+	{
+		QVector<int> clients;
+		for (int i=0; i<count; ++i)
+		{
+			int fds[2];
+			if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds)<0)
+				break;
+			SETNONBLOCK(fds[0]);
+			SETNONBLOCK(fds[1]);
+			server.add(new Connection(server, fds[0]));
+			clients << fds[1];
+		}
+		return clients;
+	}
+}
+
+void TestTelescopeServer::initTestCase()
+{
+	logStream = new QTextStream(&logText);
+	log_file = logStream;
+}
+
+void TestTelescopeServer::cleanupTestCase()
+{
+	log_file = Q_NULLPTR;
+	delete logStream;
+}
+
+void TestTelescopeServer::testManyClients()
+{
+	CountingServer server;
+	QVector<int> clients = connectClients(server, CLIENTS);
+	QCOMPARE(clients.size(), CLIENTS);
+
+	for (int i=0; i<clients.size(); ++i)
+		QVERIFY(writeGoto(clients.at(i), 1000u+i, -i));
+	QVERIFY(stepUntil(server, [&]{return server.gotos==CLIENTS;}));
+	QCOMPARE(server.lastRa, 1000u+CLIENTS-1);
+	QCOMPARE(server.lastDec, -(CLIENTS-1));
+
+	server.broadcastPosition(0x12345678u, 0);
+	for (int i=0; i<10; ++i)
+		server.step(1000);
+	for (int i=0; i<clients.size(); ++i)
+		QCOMPARE(readPositionRa(clients.at(i)), Q_INT64_C(0x12345678));
+
+	for (int i=0; i<clients.size(); ++i)
+		close(clients.at(i));
+}
+
+void TestTelescopeServer::testClosedClients()
+{
+	CountingServer server;
+	QVector<int> clients = connectClients(server, CLIENTS);
+	QCOMPARE(clients.size(), CLIENTS);
+
+	// every second client goes away, the server notices it when reading
+	logText.clear();
+	for (int i=0; i<clients.size(); i+=2)
+		close(clients.at(i));
+	QVERIFY(stepUntil(server, [&]{return logText.count("client has closed the connection")==CLIENTS/2;}));
+
+	// the others are still served
+	for (int i=1; i<clients.size(); i+=2)
+		QVERIFY(writeGoto(clients.at(i), i, i));
+	QVERIFY(stepUntil(server, [&]{return server.gotos==CLIENTS/2;}));
+	server.broadcastPosition(42u, 0);
+	for (int i=0; i<10; ++i)
+		server.step(1000);
+	for (int i=1; i<clients.size(); i+=2)
+	{
+		QCOMPARE(readPositionRa(clients.at(i)), Q_INT64_C(42));
+		close(clients.at(i));
+	}
+}
+
+void TestTelescopeServer::testSerialDevice()
+{
+	// the master side of a pseudo terminal simulates the device
+	const int device = posix_openpt(O_RDWR|O_NOCTTY);
+	if (device<0 || grantpt(device)<0 || unlockpt(device)<0)
+		QSKIP("No pseudo terminals available");
+	SETNONBLOCK(device);
+
+	CountingServer server;
+	server.add(new SerialPort(server, ptsname(device)));
+	QVERIFY(writeGoto(device, 0xABCDu, 7));
+	QVERIFY(stepUntil(server, [&]{return server.gotos==1;}));
+	QCOMPARE(server.lastRa, 0xABCDu);
+	QCOMPARE(server.lastDec, 7);
+
+	server.broadcastPosition(0x10203u, 0);
+	for (int i=0; i<10; ++i)
+		server.step(1000);
+	QCOMPARE(readPositionRa(device), Q_INT64_C(0x10203));
+	close(device);
+}
+
+void TestTelescopeServer::benchmarkIdleStep()
+{
+	// a step with many idle clients, which is what the clients do most of the time
+	CountingServer server;
+	QVector<int> clients = connectClients(server, CLIENTS);
+	QBENCHMARK
+	{
+		server.step(0);
+	}
+	for (int i=0; i<clients.size(); ++i)
+		close(clients.at(i));
+}
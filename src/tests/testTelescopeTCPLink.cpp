@@ -0,0 +1,179 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testTelescopeTCPLink.hpp"
+#include "TelescopeTCPLink.hpp"
+#include "InterpolatedPosition.hpp"
+#include "LatencyHistogram.hpp"
+
+#include <cmath>
+
+#include <QDataStream>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+
+QTEST_GUILESS_MAIN(TestTelescopeTCPLink)
+
+namespace
+{
+	//! Services the link like TelescopeClientThread does, and deletes it at the end
+	class LinkThread : public QThread
+	{
+	public:
+		LinkThread(TelescopeTCPLink* link) : link(link) {}
+	protected:
+		void run()
+		{
+			QTimer timer;
+			timer.setInterval(10);
+			connect(&timer, &QTimer::timeout, [this]() {
+				if (link->prepareCommunication())
+					link->performCommunication();
+			});
+			timer.start();
+			exec();
+			delete link;
+		}
+	private:
+		TelescopeTCPLink* link;
+	};
+
+	//! A position message of the server, type 0 of the protocol
+	QByteArray positionPacket(unsigned int raInt, int decInt, qint64 serverMicros)
+	{
+		QByteArray packet;
+		QDataStream out(&packet, QIODevice::WriteOnly);
+		out.setByteOrder(QDataStream::LittleEndian);
+		out << (quint16)24 << (quint16)0 << serverMicros << (quint32)raInt << (qint32)decInt << (qint32)0;
+		return packet;
+	}
+
+	bool isClose(const Vec3d& a, const Vec3d& b)
+	{
+		return (a-b).length()<1e-9;
+	}
+}
+
+void TestTelescopeTCPLink::init()
+{
+	server = new QTcpServer();
+	QVERIFY(server->listen(QHostAddress::LocalHost));
+	positions = new InterpolatedPosition();
+	positionLatency = new LatencyHistogram();
+	gotoLatency = new LatencyHistogram();
+	link = new TelescopeTCPLink("Test", *positions, *positionLatency, *gotoLatency);
+	link->setServer(QHostAddress::LocalHost, server->serverPort());
+	linkThread = new LinkThread(link);
+	link->moveToThread(linkThread);
+	linkThread->start();
+
+	QVERIFY(server->waitForNewConnection(5000));
+	serverSocket = server->nextPendingConnection();
+	QVERIFY(serverSocket);
+	QTRY_VERIFY(link->isConnected());
+}
+
+void TestTelescopeTCPLink::cleanup()
+{
+	linkThread->quit();
+	linkThread->wait();
+	delete linkThread;
+	delete server;
+	delete positions;
+	delete positionLatency;
+	delete gotoLatency;
+}
+
+void TestTelescopeTCPLink::testPositionUpdates()
+{
+	QVERIFY(!positions->isKnown());
+	serverSocket->write(positionPacket(0, 0, getNow()));
+	serverSocket->write(positionPacket(0x40000000, 0, getNow()));
+	QTRY_COMPARE(positionLatency->count(), 2);
+	QVERIFY(positions->isKnown());
+	// After the last received position
+	QVERIFY(isClose(positions->get(getNow()), Vec3d(0., 1., 0.)));
+
+	// South celestial pole
+	serverSocket->write(positionPacket(0, (int)0xC0000000, getNow()));
+	QTRY_COMPARE(positionLatency->count(), 3);
+	QVERIFY(isClose(positions->get(getNow()), Vec3d(0., 0., -1.)));
+	QVERIFY(link->isConnected());
+}
+
+void TestTelescopeTCPLink::testSplitPacket()
+{
+	const QByteArray packet = positionPacket(0x40000000, 0, getNow());
+	serverSocket->write(packet.left(10));
+	QVERIFY(serverSocket->waitForBytesWritten(5000));
+	QTest::qWait(50);
+	QVERIFY(!positions->isKnown());
+	QVERIFY(link->isConnected());
+
+	serverSocket->write(packet.mid(10));
+	QTRY_VERIFY(positions->isKnown());
+	QVERIFY(isClose(positions->get(getNow()), Vec3d(0., 1., 0.)));
+}
+
+void TestTelescopeTCPLink::testGoto()
+{
+	const qint64 before = getNow();
+	// RA 6h, Dec +30°, sent from this thread
+	link->sendGoto(Vec3d(0., std::cos(M_PI/6.), std::sin(M_PI/6.)));
+
+	while (serverSocket->bytesAvailable()<20)
+		QVERIFY(serverSocket->waitForReadyRead(5000));
+	QDataStream in(serverSocket);
+	in.setByteOrder(QDataStream::LittleEndian);
+	quint16 size, type;
+	qint64 clientMicros;
+	quint32 raInt;
+	qint32 decInt;
+	in >> size >> type >> clientMicros >> raInt >> decInt;
+	QCOMPARE(size, (quint16)20);
+	QCOMPARE(type, (quint16)0);
+	QVERIFY(clientMicros>=before && clientMicros<=getNow());
+	QCOMPARE(raInt, (quint32)0x40000000);
+	QVERIFY(qAbs(decInt-357913941)<=1);
+	QTRY_COMPARE(gotoLatency->count(), 1);
+	QCOMPARE(serverSocket->bytesAvailable(), (qint64)0);
+}
+
+void TestTelescopeTCPLink::testBadPacket()
+{
+	serverSocket->write(positionPacket(0, 0, getNow()));
+	QTRY_VERIFY(positions->isKnown());
+	// A packet can't be shorter than its header
+	serverSocket->write(QByteArray("\x02\x00\x00\x00", 4));
+	QTRY_VERIFY(!link->isConnected());
+	QVERIFY(!positions->isKnown());
+	QVERIFY(serverSocket->waitForDisconnected(5000) || serverSocket->state()==QAbstractSocket::UnconnectedState);
+}
+
+void TestTelescopeTCPLink::testServerHangup()
+{
+	serverSocket->disconnectFromHost();
+	QTRY_VERIFY(!link->isConnected());
+	// The goto is dropped while the link is not connected
+	link->sendGoto(Vec3d(1., 0., 0.));
+	QTest::qWait(50);
+	QCOMPARE(gotoLatency->count(), 0);
+}
@@ -0,0 +1,57 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTTELESCOPETCPLINK_HPP_
+#define _TESTTELESCOPETCPLINK_HPP_
+
+#include <QObject>
+#include <QTest>
+
+class QTcpServer;
+class QTcpSocket;
+class QThread;
+class InterpolatedPosition;
+class LatencyHistogram;
+class TelescopeTCPLink;
+
+//! Tests of the telescope TCP client against a local server speaking the Stellarium telescope control protocol.
+//! The link runs in its own thread, like in the TelescopeClientThread.
+class TestTelescopeTCPLink : public QObject
+{
+Q_OBJECT
+private slots:
+	void init();
+	void cleanup();
+	void testPositionUpdates();
+	void testSplitPacket();
+	void testGoto();
+	void testBadPacket();
+	void testServerHangup();
+
+private:
+	QTcpServer* server;
+	QTcpSocket* serverSocket;
+	InterpolatedPosition* positions;
+	LatencyHistogram* positionLatency;
+	LatencyHistogram* gotoLatency;
+	TelescopeTCPLink* link;
+	QThread* linkThread;
+};
+
+#endif // _TESTTELESCOPETCPLINK_HPP_